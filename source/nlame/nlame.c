@@ -678,6 +678,11 @@ void nlame_write_vbr_infotag_offset(nlame_instance_t* inst, FILE* fd)
       fwrite(buffer, length, 1, fd);
 }
 
+size_t nlame_get_vbr_infotag(nlame_instance_t* inst, unsigned char* buffer, size_t size)
+{
+   return lame_get_lametag_frame(inst->lgf, buffer, size);
+}
+
 #pragma warning( push )
 #pragma warning( disable: 4047 4024 )
 
@@ -74,6 +74,9 @@
     Version 7: introduced on 2023-09-28
       Added nlame_write_vbr_infotag_offset()
 
+    Version 8: introduced on 2026-10-17
+      Added nlame_get_vbr_infotag()
+
 */
 /*! \defgroup nlame nlame Documentation
 
@@ -613,6 +616,15 @@ void nlame_write_vbr_infotag( nlame_instance_t* inst, FILE* fd );
 */
 void nlame_write_vbr_infotag_offset(nlame_instance_t* inst, FILE* fd);
 
+/*! copies the VBR info tag frame to the buffer */
+/*! Use this instead of nlame_write_vbr_infotag_offset() when the output isn't
+    written to a file, e.g. when it is collected in memory. Make sure
+    nlame_encode_flush has been called before calling this function.
+    Returns the length of the frame, or 0 when VBR tags are turned off, or
+    when the buffer is too small.
+*/
+size_t nlame_get_vbr_infotag(nlame_instance_t* inst, unsigned char* buffer, size_t size);
+
 
 /*! type of histogram to get in call to nlame_histogram_get */
 typedef enum
@@ -696,7 +708,7 @@ int nlame_get_api_version();
     actually using is new enough to support the features you need. See
     the version history at the beginning of this file.
 */
-#define NLAME_CURRENT_API_VERSION 6
+#define NLAME_CURRENT_API_VERSION 8
 
 
 
@@ -29,6 +29,7 @@
 #include "preset/PresetManagerImpl.hpp"
 #include "encoder/ModuleManagerImpl.hpp"
 #include "encoder/LameNogapInstanceManager.hpp"
+#include "encoder/TranscodeCache.hpp"
 #include "TaskManager.hpp"
 #include <ulib/CrashReporter.hpp>
 #include "CrashSaveResultsDlg.hpp"
@@ -152,6 +153,26 @@ void App::InitCrashReporter()
    CrashReporter::Init(_T("winLAME"), folder, &App::ShowCrashErrorDialog);
 }
 
+std::shared_ptr<Encoder::TranscodeCache> App::GetTranscodeCache()
+{
+   if (m_spTranscodeCache == nullptr)
+   {
+      // local app-data, non-roaming, since the index contains local paths
+      CString folder = Path::Combine(Path::SpecialFolder(CSIDL_LOCAL_APPDATA), _T("winLAME"));
+
+      if (!Path::FolderExists(folder))
+         CreateDirectory(folder, nullptr);
+
+      m_spTranscodeCache = std::make_shared<Encoder::TranscodeCache>(
+         Path::Combine(folder, _T("transcode-cache.txt")));
+
+      // an unreadable index is replaced when the first output file is added
+      m_spTranscodeCache->Load();
+   }
+
+   return m_spTranscodeCache;
+}
+
 void App::ShowCrashErrorDialog(LPCTSTR crashDumpFilename)
 {
    std::vector<CString> resultFilenamesList;
@@ -31,6 +31,7 @@ namespace Encoder
 {
    class ModuleManager;
    class LameNogapInstanceManager;
+   class TranscodeCache;
 }
 namespace UI
 {
@@ -74,6 +75,9 @@ public:
    /// resets flag to start Input CD dialog
    void ResetStartInputCD() { m_startInputCD = false; }
 
+   /// returns the transcode cache; the index is loaded on the first call
+   std::shared_ptr<Encoder::TranscodeCache> GetTranscodeCache();
+
    /// runs application
    int Run(LPTSTR /*lpstrCmdLine*/ = NULL, int nCmdShow = SW_SHOWDEFAULT);
 
@@ -136,6 +140,9 @@ private:
    /// module manager
    std::shared_ptr<Encoder::ModuleManager> m_spModuleManager;
 
+   /// transcode cache; created when first used
+   std::shared_ptr<Encoder::TranscodeCache> m_spTranscodeCache;
+
    /// indicates if help file is available
    bool m_helpAvailable;
 
@@ -22,56 +22,237 @@
 #include "stdafx.h"
 #include "InputFilesParser.hpp"
 #include <fstream>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <io.h>
+#include <deque>
+#include <condition_variable>
 
-void InputFilesParser::Parse(const std::vector<CString>& vecFilenames)
+/// number of threads scanning folders
+const unsigned int c_numScanThreads = 8;
+
+/// \brief scans folders on worker threads and collects the files found
+/// \details Sub folders found while scanning are added to the queue of pending
+/// folders, so that all threads stay busy when the folder tree is deep.
+class InputFilesParser::FolderScanner
 {
-   std::for_each(vecFilenames.begin(), vecFilenames.end(), [&](const CString& cszFilename)
+public:
+   /// ctor; the function may be empty
+   explicit FolderScanner(T_fnOnFile fnOnFile)
+      :m_fnOnFile(fnOnFile),
+      m_numBusyThreads(0)
    {
-      Insert(cszFilename);
-   });
-}
+   }
 
-void InputFilesParser::Insert(LPCTSTR filename)
-{
-   // check if given filename is a directory
-   DWORD dwAttr = ::GetFileAttributes(filename);
-   if (dwAttr != INVALID_FILE_ATTRIBUTES && (dwAttr & FILE_ATTRIBUTE_DIRECTORY) != 0)
+   /// adds a folder to scan; the entries of the folder are stored in the listing
+   void AddFolder(const CString& folder, std::shared_ptr<FolderListing> spListing)
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      m_deqPendingFolders.push_back(std::make_pair(folder, spListing));
+
+      m_condition.notify_all();
+   }
+
+   /// scans all folders, passing found files to the function, and returns when done
+   void Run()
+   {
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         if (m_deqPendingFolders.empty())
+            return;
+      }
+
+      std::vector<std::thread> vecThreads;
+      for (unsigned int i = 0; i < c_numScanThreads; i++)
+         vecThreads.emplace_back(&FolderScanner::WorkerThread, this);
+
+      for (;;)
+      {
+         std::vector<CString> vecFoundFiles;
+         bool finished = false;
+         {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_condition.wait(lock, [&]() { return !m_vecFoundFiles.empty() || IsFinished(); });
+
+            vecFoundFiles.swap(m_vecFoundFiles);
+            finished = IsFinished();
+         }
+
+         if (m_fnOnFile)
+         {
+            for (const CString& filename : vecFoundFiles)
+               m_fnOnFile(filename);
+         }
+
+         if (finished)
+            break;
+      }
+
+      for (auto& thread : vecThreads)
+         thread.join();
+   }
+
+private:
+   /// returns if all folders were scanned; must be called with the mutex locked
+   bool IsFinished() const
+   {
+      return m_deqPendingFolders.empty() && m_numBusyThreads == 0;
+   }
+
+   /// scans folders until all folders were scanned
+   void WorkerThread()
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      for (;;)
+      {
+         m_condition.wait(lock, [&]() { return !m_deqPendingFolders.empty() || m_numBusyThreads == 0; });
+
+         if (m_deqPendingFolders.empty())
+            break;
+
+         auto pendingFolder = m_deqPendingFolders.front();
+         m_deqPendingFolders.pop_front();
+
+         m_numBusyThreads++;
+         lock.unlock();
+
+         std::vector<CString> vecFoundFiles;
+         ScanFolder(pendingFolder.first, *pendingFolder.second, vecFoundFiles);
+
+         lock.lock();
+         m_numBusyThreads--;
+
+         if (m_fnOnFile)
+            m_vecFoundFiles.insert(m_vecFoundFiles.end(), vecFoundFiles.begin(), vecFoundFiles.end());
+
+         m_condition.notify_all();
+      }
+   }
+
+   /// lists a single folder, adding sub folders to the pending folders
+   void ScanFolder(const CString& folder, FolderListing& listing, std::vector<CString>& vecFoundFiles)
    {
-      CString cszPathStr(filename);
+      CString cszPathStr(folder);
       cszPathStr += _T("\\*.*");
 
-      _tfinddata_t fdata;
-      long ffhnd;
+      // the find data already contains the attributes, so no file needs to be queried;
+      // basic info and large fetch reduce the number of requests on network shares
+      WIN32_FIND_DATA findData = { 0 };
+      HANDLE hFind = ::FindFirstFileEx(cszPathStr, FindExInfoBasic, &findData,
+         FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+
+      if (hFind == INVALID_HANDLE_VALUE)
+         return;
+
+      do
+      {
+         if (findData.cFileName[0] == '.')
+            continue;
+
+         CString fname(folder);
+         fname += _T('\\');
+         fname += findData.cFileName;
 
-      m_bRecursive = true;
+         ListingEntry entry;
 
-      if (-1 != (ffhnd = _tfindfirst(cszPathStr, &fdata)))
-         do
+         if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
          {
-         if (fdata.name[0] != '.')
+            entry.m_spSubFolder = std::make_shared<FolderListing>();
+            AddFolder(fname, entry.m_spSubFolder);
+         }
+         else
          {
-            CString fname(filename);
-            fname += _T('\\');
-            fname += fdata.name;
+            InsertFilename(fname, entry);
 
-            Insert(fname);
+            vecFoundFiles.insert(vecFoundFiles.end(), entry.m_vecFilenames.begin(), entry.m_vecFilenames.end());
          }
-         } while (0 == _tfindnext(ffhnd, &fdata));
 
-      _findclose(ffhnd);
+         listing.m_vecEntries.push_back(entry);
 
-      m_bRecursive = false;
+      } while (::FindNextFile(hFind, &findData));
 
-      return;
+      ::FindClose(hFind);
    }
 
-   InsertFilename(filename);
+private:
+   /// function to call for found files
+   T_fnOnFile m_fnOnFile;
+
+   /// mutex protecting the pending folders and the found files
+   std::mutex m_mutex;
+
+   /// condition that is signaled when folders were added or scanned
+   std::condition_variable m_condition;
+
+   /// folders to scan, with the listing to fill
+   std::deque<std::pair<CString, std::shared_ptr<FolderListing>>> m_deqPendingFolders;
+
+   /// number of threads currently scanning a folder
+   unsigned int m_numBusyThreads;
+
+   /// files found that weren't passed to the function yet
+   std::vector<CString> m_vecFoundFiles;
+};
+
+void InputFilesParser::Parse(const std::vector<CString>& vecFilenames)
+{
+   Parse(vecFilenames, T_fnOnFile());
+}
+
+void InputFilesParser::Parse(const std::vector<CString>& vecFilenames, T_fnOnFile fnOnFile)
+{
+   std::vector<ListingEntry> vecEntries(vecFilenames.size());
+
+   FolderScanner scanner(fnOnFile);
+
+   for (size_t i = 0, iMax = vecFilenames.size(); i < iMax; i++)
+   {
+      // check if given filename is a directory
+      DWORD dwAttr = ::GetFileAttributes(vecFilenames[i]);
+      if (dwAttr != INVALID_FILE_ATTRIBUTES && (dwAttr & FILE_ATTRIBUTE_DIRECTORY) != 0)
+      {
+         CString cszFolder(vecFilenames[i]);
+         cszFolder.TrimRight(_T('\\'));
+
+         vecEntries[i].m_spSubFolder = std::make_shared<FolderListing>();
+         scanner.AddFolder(cszFolder, vecEntries[i].m_spSubFolder);
+         continue;
+      }
+
+      InsertFilename(vecFilenames[i], vecEntries[i]);
+
+      if (fnOnFile)
+      {
+         for (const CString& filename : vecEntries[i].m_vecFilenames)
+            fnOnFile(filename);
+      }
+   }
+
+   scanner.Run();
+
+   AppendEntries(vecEntries);
+}
+
+void InputFilesParser::Insert(LPCTSTR filename)
+{
+   Parse(std::vector<CString>{ filename });
+}
+
+void InputFilesParser::AppendEntries(const std::vector<ListingEntry>& vecEntries)
+{
+   for (const ListingEntry& entry : vecEntries)
+   {
+      m_vecFileList.insert(m_vecFileList.end(), entry.m_vecFilenames.begin(), entry.m_vecFilenames.end());
+
+      if (!entry.m_cszPlaylistName.IsEmpty())
+         m_cszPlaylistName = entry.m_cszPlaylistName;
+
+      if (entry.m_spSubFolder != nullptr)
+         AppendEntries(entry.m_spSubFolder->m_vecEntries);
+   }
 }
 
-void InputFilesParser::InsertFilename(LPCTSTR filename)
+void InputFilesParser::InsertFilename(LPCTSTR filename, ListingEntry& entry)
 {
    bool bFoundPlaylist = false;
 
@@ -80,33 +261,33 @@ void InputFilesParser::InsertFilename(LPCTSTR filename)
    if (pos == NULL)
    {
       // just a filename
-      m_vecFileList.push_back(filename);
+      entry.m_vecFilenames.push_back(filename);
    }
    else
    if (0 == _tcsicmp(pos + 1, _T("m3u")))
    {
       // import m3u playlist
-      ImportM3uPlaylist(filename);
+      ImportM3uPlaylist(filename, entry);
       bFoundPlaylist = true;
    }
    else
    if (0 == _tcsicmp(pos + 1, _T("pls")))
    {
       // import pls playlist
-      ImportPlsPlaylist(filename);
+      ImportPlsPlaylist(filename, entry);
       bFoundPlaylist = true;
    }
    else
    if (0 == _tcsicmp(pos + 1, _T("cue")))
    {
       // import cue sheet
-      ImportCueSheet(filename);
+      ImportCueSheet(filename, entry);
       bFoundPlaylist = true;
    }
    else
    {
       // just a filename
-      m_vecFileList.push_back(filename);
+      entry.m_vecFilenames.push_back(filename);
    }
 
    if (bFoundPlaylist)
@@ -117,11 +298,11 @@ void InputFilesParser::InsertFilename(LPCTSTR filename)
 
       plname.TrimRight(_T('\\'));
 
-      m_cszPlaylistName = plname;
+      entry.m_cszPlaylistName = plname;
    }
 }
 
-void InputFilesParser::ImportM3uPlaylist(LPCTSTR filename)
+void InputFilesParser::ImportM3uPlaylist(LPCTSTR filename, ListingEntry& entry)
 {
    // open playlist
    std::ifstream plist(CStringA(filename), std::ios::in);
@@ -167,13 +348,13 @@ void InputFilesParser::ImportM3uPlaylist(LPCTSTR filename)
       }
 
       // insert filename
-      InsertFilename(line.c_str());
+      InsertFilename(line.c_str(), entry);
    }
 
    plist.close();
 }
 
-void InputFilesParser::ImportPlsPlaylist(LPCTSTR filename)
+void InputFilesParser::ImportPlsPlaylist(LPCTSTR filename, ListingEntry& entry)
 {
    // open playlist
    std::ifstream plist(CStringA(filename), std::ios::in);
@@ -222,13 +403,13 @@ void InputFilesParser::ImportPlsPlaylist(LPCTSTR filename)
       }
 
       // insert filename
-      InsertFilename(line.c_str());
+      InsertFilename(line.c_str(), entry);
    }
 
    plist.close();
 }
 
-void InputFilesParser::ImportCueSheet(LPCTSTR filename)
+void InputFilesParser::ImportCueSheet(LPCTSTR filename, ListingEntry& entry)
 {
    // open cue sheet
    std::ifstream sheet(CStringA(filename), std::ios::in);
@@ -280,7 +461,7 @@ void InputFilesParser::ImportCueSheet(LPCTSTR filename)
             pos2 - (endchar == ' ' ? 0 : 1));
 
          // insert filename
-         InsertFilename(fname.c_str());
+         InsertFilename(fname.c_str(), entry);
       }
    }
 
@@ -22,17 +22,23 @@
 #pragma once
 
 #include <vector>
+#include <functional>
 
 /// \brief parses input files
 /// \details When input is folder name, the parser adds all files recursively.
 /// When input is playlists (.m3u, .pls) or cue sheets (.cue), it adds the the referenced files.
 /// When input is a normal existing file, it adds it to the file list.
+/// Folders are scanned by a pool of worker threads, one folder at a time per thread,
+/// since listing folders on network shares mostly waits for the server. The file list
+/// has the same order as when scanning the folders one after another.
 class InputFilesParser
 {
 public:
+   /// function type that is called for every file found
+   typedef std::function<void(const CString& filename)> T_fnOnFile;
+
    /// ctor
    InputFilesParser()
-      :m_bRecursive(false)
    {
    }
 
@@ -47,26 +53,55 @@ public:
    /// parses list of filenames
    void Parse(const std::vector<CString>& vecFilenames);
 
+   /// \brief parses list of filenames and passes every file to the function as soon as it is found
+   /// \details The function is called on the calling thread, while the folders are still
+   /// scanned. Files of the same folder are passed in folder order, but files of different
+   /// folders may be passed in any order; FileList() has the ordered list after returning.
+   void Parse(const std::vector<CString>& vecFilenames, T_fnOnFile fnOnFile);
+
    /// inserts a single file
    void Insert(LPCTSTR filename);
 
 private:
-   /// inserts filename; no parsing or recursing
-   void InsertFilename(LPCTSTR filename);
+   struct FolderListing;
+   class FolderScanner;
+
+   /// entry of a folder listing, or a parsed input filename
+   struct ListingEntry
+   {
+      /// files of the entry; more than one when the entry is a playlist
+      std::vector<CString> m_vecFilenames;
+
+      /// playlist name, when the entry is a playlist
+      CString m_cszPlaylistName;
+
+      /// listing of the sub folder, when the entry is a folder
+      std::shared_ptr<FolderListing> m_spSubFolder;
+   };
+
+   /// entries of a folder, in the order they were found
+   struct FolderListing
+   {
+      /// all entries
+      std::vector<ListingEntry> m_vecEntries;
+   };
+
+   /// appends all files of the entries to the file list, in order, recursing into sub folders
+   void AppendEntries(const std::vector<ListingEntry>& vecEntries);
+
+   /// inserts filename into list; no recursing, but playlists are imported
+   static void InsertFilename(LPCTSTR filename, ListingEntry& entry);
 
    /// imports .m3u playlist
-   void ImportM3uPlaylist(LPCTSTR filename);
+   static void ImportM3uPlaylist(LPCTSTR filename, ListingEntry& entry);
 
    /// imports .pls playlist
-   void ImportPlsPlaylist(LPCTSTR filename);
+   static void ImportPlsPlaylist(LPCTSTR filename, ListingEntry& entry);
 
    /// imports .cue cue sheet
-   void ImportCueSheet(LPCTSTR filename);
+   static void ImportCueSheet(LPCTSTR filename, ListingEntry& entry);
 
 private:
-   /// indicates if Insert() currently operates recursively
-   bool m_bRecursive;
-
    /// file list
    std::vector<CString> m_vecFileList;
 
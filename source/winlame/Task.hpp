@@ -22,7 +22,10 @@
 #pragma once
 
 #include "TaskInfo.hpp"
+#include "TaskStatusFeed.hpp"
 #include <atomic>
+#include <functional>
+#include <set>
 
 /// task interface
 class Task
@@ -31,9 +34,10 @@ public:
    /// ctor
    explicit Task(unsigned int dependentTaskId = 0)
       :m_id(0),
-      m_dependentTaskId(dependentTaskId),
-      m_isStarted(false)
+      m_isStarted(false),
+      m_statusFeed(nullptr)
    {
+      AddDependentTaskId(dependentTaskId);
    }
    /// dtor
    virtual ~Task() {}
@@ -50,9 +54,24 @@ public:
    /// task should be aborted, e.g. when program is closed
    virtual void Stop() = 0;
 
+   /// returns the CD drive the task accesses, or -1 when it doesn't access a CD drive;
+   /// the task manager only runs one task per CD drive at a time, until the task has
+   /// finished or has called ReleaseCDDrive()
+   virtual int CDDrive() const { return -1; }
+
    /// returns if task was already started
    bool IsStarted() const { return m_isStarted; }
 
+   /// adds id of a task that must be finished before this task can run; 0 is ignored;
+   /// must be called before the task is added to the task manager
+   void AddDependentTaskId(unsigned int dependentTaskId)
+   {
+      ATLASSERT(m_id == 0); // must not be added to task manager yet
+
+      if (dependentTaskId != 0)
+         m_dependentTaskIds.insert(dependentTaskId);
+   }
+
 protected:
    friend class TaskManager;
 
@@ -62,6 +81,28 @@ protected:
    /// sets the "is started" flag
    void IsStarted(bool isStarted) { m_isStarted = isStarted; }
 
+   /// sets the status feed the task publishes its task info to
+   void StatusFeed(TaskStatusFeed* statusFeed) { m_statusFeed = statusFeed; }
+
+   /// sets the function that is called when the task releases its CD drive
+   void CDDriveReleasedHandler(std::function<void()> fnCDDriveReleased) { m_fnCDDriveReleased = fnCDDriveReleased; }
+
+   /// tells the task manager that the task doesn't access its CD drive anymore, so that
+   /// the next task for the drive can start while this task is still running
+   void ReleaseCDDrive()
+   {
+      if (m_fnCDDriveReleased)
+         m_fnCDDriveReleased();
+   }
+
+   /// publishes the current task info to the status feed; tasks call this when their
+   /// status, or their progress in full percent, has changed
+   void PublishTaskInfo()
+   {
+      if (m_statusFeed != nullptr)
+         m_statusFeed->Publish(GetTaskInfo());
+   }
+
    /// sets task error text
    void SetTaskError(UINT stringResourceId)
    {
@@ -80,8 +121,8 @@ protected:
       ATLASSERT(!m_errorText.IsEmpty());
    }
 
-   /// returns dependent task id
-   unsigned int DependentTaskId() const { return m_dependentTaskId; }
+   /// returns ids of all tasks this task depends on
+   const std::set<unsigned int>& DependentTaskIds() const { return m_dependentTaskIds; }
 
    /// returns error text, if any
    const CString& ErrorText() const { return m_errorText; }
@@ -90,12 +131,18 @@ private:
    /// task id
    unsigned int m_id;
 
-   /// task id this task depends on; may be 0 for no task
-   unsigned int m_dependentTaskId;
+   /// ids of tasks this task depends on; may be empty
+   std::set<unsigned int> m_dependentTaskIds;
 
    /// flag that indicates if the task already has been started
    std::atomic<bool> m_isStarted;
 
    /// error text, or empty when not set yet
    CString m_errorText;
+
+   /// status feed to publish task infos to; set by the task manager
+   TaskStatusFeed* m_statusFeed;
+
+   /// function to call when the task releases its CD drive; set by the task manager
+   std::function<void()> m_fnCDDriveReleased;
 };
@@ -24,15 +24,24 @@
 #include "TaskManager.hpp"
 #include "EncoderTask.hpp"
 #include "CreatePlaylistTask.hpp"
+#include "WriteAlbumGainTask.hpp"
+#include "LoudnessAnalyzer.hpp"
 #include "CDExtractTask.hpp"
+#include "CDReadInputModule.hpp"
 #include "EjectCDTask.hpp"
 #include "CDRipTitleFormatManager.hpp"
 #include "LameNogapInstanceManager.hpp"
+#include "TranscodeCache.hpp"
+#include "App.hpp"
 #include <sndfile.h>
 
+/// number of sample blocks that reading a track from CD may run ahead of encoding; a
+/// block holds about 0.75 seconds of audio, so the drive is released for the next
+/// track well before encoding the track has finished
+const size_t c_numCDReadAheadSampleBlocks = 64;
+
 TaskCreationHelper::TaskCreationHelper()
-   :m_uiSettings(IoCContainer::Current().Resolve<UISettings>()),
-   m_lastTaskId(0)
+   :m_uiSettings(IoCContainer::Current().Resolve<UISettings>())
 {
 }
 
@@ -110,6 +119,15 @@ bool TaskCreationHelper::IsOverwritingOriginalFiles() const
 
 void TaskCreationHelper::AddTasks()
 {
+   // the album gain is calculated from the loudness of all tracks in this batch
+   bool storeAlbumGain =
+      m_uiSettings.settings_manager.QueryValueInt(GeneralReplayGain) == 1 &&
+      m_uiSettings.settings_manager.QueryValueInt(GeneralAlbumGain) == 1;
+
+   m_loudnessAlbum.reset();
+   if (storeAlbumGain)
+      m_loudnessAlbum = std::make_shared<Encoder::LoudnessAlbum>();
+
    if (m_uiSettings.m_bFromInputFilesPage)
       AddInputFilesTasks();
    else
@@ -118,6 +136,9 @@ void TaskCreationHelper::AddTasks()
    if (m_uiSettings.create_playlist)
       AddPlaylistTask();
 
+   if (storeAlbumGain)
+      AddAlbumGainTask();
+
    m_uiSettings.encoderjoblist.clear();
    m_uiSettings.cdreadjoblist.clear();
 }
@@ -126,7 +147,9 @@ void TaskCreationHelper::AddInputFilesTasks()
 {
    TaskManager& taskMgr = IoCContainer::Current().Resolve<TaskManager>();
 
-   m_lastTaskId = 0;
+   m_outputTaskIds.clear();
+
+   unsigned int lastTaskId = 0;
 
    Encoder::ModuleManager& moduleManager = IoCContainer::Current().Resolve<Encoder::ModuleManager>();
 
@@ -166,12 +189,18 @@ void TaskCreationHelper::AddInputFilesTasks()
       taskSettings.m_trackInfo = job.GetTrackInfo();
       taskSettings.m_overwriteExisting = m_uiSettings.m_defaultSettings.overwrite_existing;
       taskSettings.m_deleteInputAfterEncode = m_uiSettings.m_defaultSettings.delete_after_encode;
+      taskSettings.m_pipelinedEncoding = m_uiSettings.m_defaultSettings.pipelined_encoding;
+      taskSettings.m_loudnessAlbum = m_loudnessAlbum;
+      taskSettings.m_workerPool = &taskMgr;
+
+      if (m_uiSettings.m_defaultSettings.use_transcode_cache)
+         taskSettings.m_transcodeCache = App::Current().GetTranscodeCache();
 
       // set previous task id when encoding with LAME and using nogap encoding
       unsigned int dependentTaskId = 0;
       if (lameNogapEncoding)
       {
-         dependentTaskId = m_lastTaskId;
+         dependentTaskId = lastTaskId;
 
          taskSettings.m_settingsManager.setValue(LameNoGapInstanceId, nogapInstanceId);
 
@@ -186,7 +215,8 @@ void TaskCreationHelper::AddInputFilesTasks()
       CString inputTitle = Path::FilenameOnly(job.InputFilename());
       job.OutputFilename(spTask->GenerateOutputFilename(inputTitle));
 
-      m_lastTaskId = spTask->Id();
+      m_outputTaskIds.push_back(spTask->Id());
+      lastTaskId = spTask->Id();
    }
 }
 
@@ -212,9 +242,19 @@ void TaskCreationHelper::AddCDExtractTasks()
       nogapInstanceId = nogapInstanceManager.NextNogapInstanceId();
    }
 
+   // when not outputting to CD format, tracks are read directly into the encoder, unless
+   // extracting to a temporary wave file first is configured. The encoder task releases
+   // the drive as soon as the track was read, so the next track is read while the
+   // previous one is still being encoded.
+   bool readDirectFromCD = !outputWaveFile16bit &&
+      !m_uiSettings.cdrip_use_temp_file;
+
    TaskManager& taskMgr = IoCContainer::Current().Resolve<TaskManager>();
 
+   m_outputTaskIds.clear();
+
    unsigned int lastCDReadTaskId = 0;
+   unsigned int lastEncoderTaskId = 0;
 
    unsigned int maxJobIndex = m_uiSettings.cdreadjoblist.size();
    for (unsigned int jobIndex = 0; jobIndex < maxJobIndex; jobIndex++)
@@ -227,6 +267,35 @@ void TaskCreationHelper::AddCDExtractTasks()
       if (!trackInfo.m_isActive)
          continue;
 
+      bool isLastTrack = jobIndex == maxJobIndex - 1;
+
+      if (readDirectFromCD)
+      {
+         cdReadJob.Title(CDRipTitleFormatManager::FormatTitle(m_uiSettings, discInfo, trackInfo));
+
+         // the task manager reads the tracks one after another; nogap encoding must also
+         // wait for the previous track to be encoded
+         std::shared_ptr<Encoder::EncoderTask> spEncoderTask =
+            CreateEncoderTaskForCDReadJob(lameNogapEncoding ? lastEncoderTaskId : 0,
+               cdReadJob, nogapInstanceId, isLastTrack, true);
+
+         CString titleFilename = CDRipTitleFormatManager::GetFilenameByTitle(cdReadJob.Title());
+
+         cdReadJob.OutputFilename(spEncoderTask->GenerateOutputFilename(titleFilename));
+
+         taskMgr.AddTask(spEncoderTask);
+
+         m_outputTaskIds.push_back(spEncoderTask->Id());
+         lastCDReadTaskId = spEncoderTask->Id();
+         lastEncoderTaskId = spEncoderTask->Id();
+
+         if (isLastTrack &&
+            m_uiSettings.m_ejectDiscAfterReading)
+            AddCDEjectTask(discInfo, lastCDReadTaskId);
+
+         continue;
+      }
+
       if (outputWaveFile16bit)
       {
          // when outputting to CD format, we can store the wave file directly without writing
@@ -243,25 +312,27 @@ void TaskCreationHelper::AddCDExtractTasks()
       std::shared_ptr<Encoder::CDExtractTask> spCDExtractTask(new Encoder::CDExtractTask(lastCDReadTaskId, discInfo, trackInfo));
       taskMgr.AddTask(spCDExtractTask);
 
-      m_lastTaskId = spCDExtractTask->Id();
-
       cdReadJob.OutputFilename(spCDExtractTask->OutputFilename());
       cdReadJob.Title(spCDExtractTask->Title());
 
       unsigned int cdReadTaskId = spCDExtractTask->Id();
       lastCDReadTaskId = cdReadTaskId;
 
-      bool isLastTrack = jobIndex == maxJobIndex - 1;
-
       if (isLastTrack &&
          m_uiSettings.m_ejectDiscAfterReading)
-         AddCDEjectTask(discInfo);
+         AddCDEjectTask(discInfo, lastCDReadTaskId);
 
-      if (!outputWaveFile16bit)
+      if (outputWaveFile16bit)
+         m_outputTaskIds.push_back(cdReadTaskId);
+      else
       {
          // also add encode task
          std::shared_ptr<Encoder::EncoderTask> spEncoderTask =
-            CreateEncoderTaskForCDReadJob(cdReadTaskId, cdReadJob, nogapInstanceId, isLastTrack);
+            CreateEncoderTaskForCDReadJob(cdReadTaskId, cdReadJob, nogapInstanceId, isLastTrack, false);
+
+         // nogap encoding must also wait for the previous track to be encoded
+         if (lameNogapEncoding)
+            spEncoderTask->AddDependentTaskId(lastEncoderTaskId);
 
          CString titleFilename = CDRipTitleFormatManager::GetFilenameByTitle(cdReadJob.Title());
 
@@ -269,18 +340,27 @@ void TaskCreationHelper::AddCDExtractTasks()
 
          taskMgr.AddTask(spEncoderTask);
 
-         m_lastTaskId = spEncoderTask->Id();
+         m_outputTaskIds.push_back(spEncoderTask->Id());
+         lastEncoderTaskId = spEncoderTask->Id();
       }
    }
 }
 
 std::shared_ptr<Encoder::EncoderTask> TaskCreationHelper::CreateEncoderTaskForCDReadJob(
    unsigned int cdReadTaskId, const Encoder::CDReadJob& cdReadJob,
-   int nogapInstanceId, bool isLastTrack)
+   int nogapInstanceId, bool isLastTrack, bool readDirectFromCD)
 {
    Encoder::EncoderTaskSettings taskSettings;
 
-   taskSettings.m_inputFilename = cdReadJob.OutputFilename();
+   if (readDirectFromCD)
+   {
+      // there's no input file; the title is shown in error messages
+      taskSettings.m_inputFilename = cdReadJob.Title();
+      taskSettings.m_inputModulePrototype = std::make_shared<Encoder::CDReadInputModule>(cdReadJob);
+   }
+   else
+      taskSettings.m_inputFilename = cdReadJob.OutputFilename();
+
    taskSettings.m_outputFolder = m_uiSettings.m_defaultSettings.outputdir;
 
    taskSettings.m_title = cdReadJob.Title();
@@ -299,11 +379,22 @@ std::shared_ptr<Encoder::EncoderTask> TaskCreationHelper::CreateEncoderTaskForCD
    taskSettings.m_trackInfo = encodeTrackInfo;
    taskSettings.m_useTrackInfo = true;
    taskSettings.m_overwriteExisting = m_uiSettings.m_defaultSettings.overwrite_existing;
-   taskSettings.m_deleteInputAfterEncode = true; // temporary file created by CDExtractTask
+   taskSettings.m_deleteInputAfterEncode = !readDirectFromCD; // temporary file created by CDExtractTask
+
+   // when reading from CD, always read ahead of encoding, so that the drive keeps spinning
+   // and is released early
+   taskSettings.m_pipelinedEncoding = readDirectFromCD || m_uiSettings.m_defaultSettings.pipelined_encoding;
+
+   if (readDirectFromCD)
+      taskSettings.m_numPipelineSampleBlocks = c_numCDReadAheadSampleBlocks;
+
+   taskSettings.m_workerPool = &IoCContainer::Current().Resolve<TaskManager>();
 
    if (isLastTrack)
       taskSettings.m_settingsManager.setValue(GeneralIsLastFile, 1);
 
+   taskSettings.m_loudnessAlbum = m_loudnessAlbum;
+
    return std::make_shared<Encoder::EncoderTask>(cdReadTaskId, taskSettings);
 }
 
@@ -340,12 +431,12 @@ CString TaskCreationHelper::FindCommonPlaylistOutputFolder() const
    return playlistOutputFolder;
 }
 
-void TaskCreationHelper::AddCDEjectTask(const CDRipDiscInfo& discInfo)
+void TaskCreationHelper::AddCDEjectTask(const CDRipDiscInfo& discInfo, unsigned int lastCDReadTaskId)
 {
    TaskManager& taskMgr = IoCContainer::Current().Resolve<TaskManager>();
 
    std::shared_ptr<Task> spTask =
-      std::make_shared<Encoder::EjectCDTask>(m_lastTaskId, discInfo.m_discDrive);
+      std::make_shared<Encoder::EjectCDTask>(lastCDReadTaskId, discInfo.m_discDrive);
    taskMgr.AddTask(spTask);
 }
 
@@ -360,9 +451,26 @@ void TaskCreationHelper::AddPlaylistTask()
 
    std::shared_ptr<Task> spTask;
    if (m_uiSettings.m_bFromInputFilesPage)
-      spTask.reset(new Encoder::CreatePlaylistTask(m_lastTaskId, playlistFilename, m_uiSettings.encoderjoblist));
+      spTask.reset(new Encoder::CreatePlaylistTask(0, playlistFilename, m_uiSettings.encoderjoblist));
    else
-      spTask.reset(new Encoder::CreatePlaylistTask(m_lastTaskId, playlistFilename, m_uiSettings.cdreadjoblist));
+      spTask.reset(new Encoder::CreatePlaylistTask(0, playlistFilename, m_uiSettings.cdreadjoblist));
+
+   // the playlist only needs all output files, not e.g. the CD eject task
+   for (unsigned int outputTaskId : m_outputTaskIds)
+      spTask->AddDependentTaskId(outputTaskId);
+
+   taskMgr.AddTask(spTask);
+}
+
+void TaskCreationHelper::AddAlbumGainTask()
+{
+   TaskManager& taskMgr = IoCContainer::Current().Resolve<TaskManager>();
+
+   std::shared_ptr<Task> spTask = std::make_shared<Encoder::WriteAlbumGainTask>(m_loudnessAlbum);
+
+   // the album gain needs the loudness of all encoded tracks
+   for (unsigned int outputTaskId : m_outputTaskIds)
+      spTask->AddDependentTaskId(outputTaskId);
 
    taskMgr.AddTask(spTask);
 }
@@ -28,6 +28,7 @@ namespace Encoder
 {
    class EncoderTask;
    class CDReadJob;
+   class LoudnessAlbum;
 }
 
 /// helper class to help with creating tasks for encoding, CD readout and playlist writing
@@ -53,24 +54,32 @@ private:
    /// adds tasks for CD extraction to task manager
    void AddCDExtractTasks();
 
-   /// creates encoder task for a CD Extract task
+   /// creates encoder task for a CD read job; the task either encodes the temporary
+   /// file of a CD Extract task, or reads the track directly from CD
    std::shared_ptr<Encoder::EncoderTask> CreateEncoderTaskForCDReadJob(
       unsigned int cdReadTaskId, const Encoder::CDReadJob& cdReadJob,
-      int nogapInstanceId, bool isLastTrack);
+      int nogapInstanceId, bool isLastTrack, bool readDirectFromCD);
 
    /// finds playlist output folder that is common to all files on the playlist
    CString FindCommonPlaylistOutputFolder() const;
 
-   /// adds task to eject the CD after reading
-   void AddCDEjectTask(const CDRipDiscInfo& discInfo);
+   /// adds task to eject the CD after the last CD reading task
+   void AddCDEjectTask(const CDRipDiscInfo& discInfo, unsigned int lastCDReadTaskId);
 
    /// adds task to create a playlist to task manager
    void AddPlaylistTask();
 
+   /// adds task to store the album gain in all output files to task manager
+   void AddAlbumGainTask();
+
 private:
    /// settings
    UISettings& m_uiSettings;
 
-   /// last task id used for an encoding task or a CD extract task
-   unsigned int m_lastTaskId;
+   /// ids of all tasks that write an output file; the playlist task depends on them
+   std::vector<unsigned int> m_outputTaskIds;
+
+   /// album that all encoder tasks add their loudness to, when the album gain is
+   /// stored; else nullptr
+   std::shared_ptr<Encoder::LoudnessAlbum> m_loudnessAlbum;
 };
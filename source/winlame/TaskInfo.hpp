@@ -22,6 +22,8 @@
 // include guard
 #pragma once
 
+#include "EncoderStatistics.hpp"
+
 /// task info
 class TaskInfo
 {
@@ -42,6 +44,7 @@ public:
       taskCdExtraction,
       taskWritePlaylist,
       taskEjectCD,
+      taskWriteAlbumGain,
       taskUnknown
    };
 
@@ -74,6 +77,9 @@ public:
    /// returns progress in percent; [0; 100]
    unsigned int Progress() const { return m_progressInPercent; }
 
+   /// returns timing and throughput counters; only set for encoding tasks
+   const Encoder::EncoderStatistics& Statistics() const { return m_statistics; }
+
    // set methods
 
    /// sets name of file, track, etc.
@@ -88,6 +94,9 @@ public:
    /// sets progress in percent; [0; 100]
    void Progress(unsigned int uiProgress) { m_progressInPercent = uiProgress; }
 
+   /// sets timing and throughput counters
+   void Statistics(const Encoder::EncoderStatistics& statistics) { m_statistics = statistics; }
+
 private:
    unsigned int m_uiId;       ///< task id
    CString m_cszName;         ///< task name
@@ -95,4 +104,5 @@ private:
    TaskStatus m_taskStatus;   ///< status
    TaskType m_taskType;       ///< task type
    unsigned int m_progressInPercent; ///< progress in percent
+   Encoder::EncoderStatistics m_statistics; ///< timing and throughput counters
 };
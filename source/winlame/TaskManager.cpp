@@ -22,14 +22,34 @@
 #include "stdafx.h"
 #include "TaskManager.hpp"
 #include "CDExtractTask.hpp"
+#include "EncoderTask.hpp"
 #include "Task.hpp"
 #include <ulib/thread/Thread.hpp>
 #include <algorithm>
 #include <set>
 
+/// task types, in order of scheduling priority; CD access is never queued behind encoding
+static const std::array<TaskInfo::TaskType, 6> c_taskTypesByPriority =
+{
+   TaskInfo::taskCdExtraction,
+   TaskInfo::taskEjectCD,
+   TaskInfo::taskWritePlaylist,
+   TaskInfo::taskWriteAlbumGain,
+   TaskInfo::taskUnknown,
+   TaskInfo::taskEncoding,
+};
+
+/// number of threads in addition to the encoding threads; they run CD access and
+/// other tasks that mostly wait for I/O while all cores are busy encoding
+const unsigned int c_numAdditionalThreads = 2;
+
 TaskManager::TaskManager(const TaskManagerConfig& config)
    :m_nextTaskId(1),
    m_config(config),
+   m_numRunningTasks(0),
+   m_numRunningEncodingTasks(0),
+   m_maxEncodingTasks(0),
+   m_numThreads(0),
    m_defaultWork(boost::asio::make_work_guard(m_ioContext))
 {
    // find out number of threads to start
@@ -44,8 +64,12 @@ TaskManager::TaskManager(const TaskManagerConfig& config)
    if (uiNumThreads == 0)
       uiNumThreads = 2; // set to a sane value
 
+   // encoding tasks are CPU bound and get one thread per core
+   m_maxEncodingTasks = uiNumThreads;
+   m_numThreads = uiNumThreads + c_numAdditionalThreads;
+
    // start up threads
-   for (unsigned int i = 0; i < uiNumThreads; i++)
+   for (unsigned int i = 0; i < m_numThreads; i++)
    {
       std::shared_ptr<std::thread> spThread = std::make_shared<std::thread>(
          std::bind(&TaskManager::RunThread, std::ref(m_ioContext), i));
@@ -109,45 +133,30 @@ void TaskManager::AddTask(std::shared_ptr<Task> spTask)
    unsigned int taskId = m_nextTaskId++;
    spTask->Id(taskId);
 
-   {
-      std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
-      m_deqTaskQueue.push_back(spTask);
-   }
-
    ATLASSERT(spTask->IsStarted() == false); // must not be already started
 
-   if (IsTaskRunnable(spTask))
-   {
-      spTask->IsStarted(true);
-
-      boost::asio::post(
-         m_ioContext.get_executor(),
-         std::bind(&TaskManager::RunTask, this, spTask));
-   }
-}
+   spTask->StatusFeed(&m_statusFeed);
+   m_statusFeed.Add(spTask->GetTaskInfo());
 
-void TaskManager::CheckRunnableTasks()
-{
    std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
 
-   std::for_each(m_deqTaskQueue.begin(), m_deqTaskQueue.end(),
-      [&](std::shared_ptr<Task>& spTask)
+   m_deqTaskQueue.push_back(spTask);
+
+   // register task as waiting for all dependent tasks that aren't finished yet
+   unsigned int numUnfinishedDependencies = 0;
+   for (unsigned int dependentTaskId : spTask->DependentTaskIds())
    {
-      auto iter = m_mapCompletedTaskInfos.find(spTask->Id());
-      if (iter != m_mapCompletedTaskInfos.end())
-         return; // already completed
+      if (m_setFinishedTaskIds.find(dependentTaskId) != m_setFinishedTaskIds.end())
+         continue;
 
-      if (m_mapCompletedTaskInfos.find(spTask->Id()) == m_mapCompletedTaskInfos.end() &&
-         !spTask->IsStarted() &&
-         IsTaskRunnable(spTask))
-      {
-         spTask->IsStarted(true);
+      m_mapWaitingTasks[dependentTaskId].push_back(spTask);
+      numUnfinishedDependencies++;
+   }
 
-         boost::asio::post(
-            m_ioContext.get_executor(),
-            std::bind(&TaskManager::RunTask, this, spTask));
-      }
-   });
+   if (numUnfinishedDependencies > 0)
+      m_mapNumUnfinishedDependencies[taskId] = numUnfinishedDependencies;
+   else
+      StartTask(spTask);
 }
 
 bool TaskManager::IsQueueEmpty() const
@@ -175,6 +184,14 @@ bool TaskManager::AreRunningTasksAvail() const
    return m_mapCompletedTaskInfos.size() < m_deqTaskQueue.size();
 }
 
+bool TaskManager::WaitAllCompleted(std::chrono::milliseconds timeout)
+{
+   std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
+
+   return m_conditionTaskCompleted.wait_for(lock, timeout,
+      [this]() { return m_mapCompletedTaskInfos.size() >= m_deqTaskQueue.size(); });
+}
+
 bool TaskManager::AreCompletedTasksAvail() const
 {
    std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
@@ -190,8 +207,11 @@ bool TaskManager::AreCDExtractTasksRunning() const
    std::for_each(m_deqTaskQueue.begin(), m_deqTaskQueue.end(),
       [&](const std::shared_ptr<Task>& spTask)
    {
-      if (std::dynamic_pointer_cast<Encoder::CDExtractTask>(spTask) == nullptr)
-         return; // no CD extract task
+      std::shared_ptr<Encoder::EncoderTask> spEncoderTask = std::dynamic_pointer_cast<Encoder::EncoderTask>(spTask);
+
+      if (std::dynamic_pointer_cast<Encoder::CDExtractTask>(spTask) == nullptr &&
+         (spEncoderTask == nullptr || !spEncoderTask->IsReadingCD()))
+         return; // no CD extract task, and no encoder task reading from CD
 
       if (m_mapCompletedTaskInfos.find(spTask->Id()) != m_mapCompletedTaskInfos.end())
          return; // already completed
@@ -210,62 +230,54 @@ bool TaskManager::AreCDExtractTasksRunning() const
 
 void TaskManager::GetTaskListState(bool& hasActiveTasks, bool& hasErrorTasks, unsigned int& percentComplete) const
 {
-   std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
+   // the status feed keeps the state up to date, so no task has to be queried here
+   TaskListState state = m_statusFeed.GetTaskListState();
 
-   if (m_deqTaskQueue.empty())
-   {
-      hasActiveTasks = hasErrorTasks = false;
-      percentComplete = 100;
+   hasActiveTasks = state.m_numRunningTasks > 0;
+   hasErrorTasks = state.m_numErrorTasks > 0;
+   percentComplete = state.PercentComplete();
+}
 
-      return;
-   }
+unsigned int TaskManager::RegisterTaskChangesConsumer()
+{
+   return m_statusFeed.RegisterConsumer();
+}
 
-   hasActiveTasks = false;
-   hasErrorTasks = false;
+void TaskManager::UnregisterTaskChangesConsumer(unsigned int consumerId)
+{
+   m_statusFeed.UnregisterConsumer(consumerId);
+}
 
-   unsigned int numTasks = 0;
-   unsigned int taskPercentageSum = 0;
+unsigned long long TaskManager::GetTaskChanges(unsigned int consumerId, unsigned long long sinceVersion,
+   std::vector<TaskInfo>& changedTaskInfos, std::vector<unsigned int>& removedTaskIds)
+{
+   return m_statusFeed.GetChangesSince(consumerId, sinceVersion, changedTaskInfos, removedTaskIds);
+}
 
-   std::for_each(m_deqTaskQueue.begin(), m_deqTaskQueue.end(),
-      [&](const std::shared_ptr<Task>& spTask)
-   {
-      TaskInfo info = spTask->GetTaskInfo();
+Encoder::EncoderStatistics TaskManager::GetStatistics()
+{
+   Encoder::EncoderStatistics statistics;
 
-      switch (info.Status())
-      {
-      case TaskInfo::statusWaiting:
-         numTasks++;
-         break;
-
-      case TaskInfo::statusRunning:
-         taskPercentageSum += info.Progress();
-         hasActiveTasks = true;
-         numTasks++;
-         break;
-
-      case TaskInfo::statusError:
-         hasErrorTasks = true;
-         [[fallthrough]];
-      case TaskInfo::statusCompleted:
-         numTasks++;
-         taskPercentageSum += 100;
-         break;
-
-      default:
-         ATLASSERT(false);
-         break;
-      }
-   });
+   for (const TaskInfo& info : CurrentTasks())
+      statistics.Add(info.Statistics());
 
-   percentComplete = numTasks == 0 ? 0 : (taskPercentageSum / numTasks);
+   return statistics;
 }
 
 void TaskManager::StopAll()
 {
    std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
 
+   // waiting and ready tasks must not be started anymore
+   m_mapWaitingTasks.clear();
+   m_mapNumUnfinishedDependencies.clear();
+   m_mapReadyTasks.clear();
+
    for (std::shared_ptr<Task> spTask : m_deqTaskQueue)
    {
+      if (m_mapCompletedTaskInfos.find(spTask->Id()) != m_mapCompletedTaskInfos.end())
+         continue; // already completed and published
+
       spTask->Stop();
 
       CString errorText;
@@ -318,26 +330,105 @@ void TaskManager::RunThread(boost::asio::io_context& ioContext, unsigned int thr
    }
 }
 
-bool TaskManager::IsTaskRunnable(std::shared_ptr<Task> spTask) const
+void TaskManager::StartTask(std::shared_ptr<Task> spTask)
 {
-   std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
+   // tasks accessing a CD drive are scheduled like CD extraction tasks, e.g. encoder
+   // tasks reading directly from CD
+   TaskInfo::TaskType schedulingType =
+      spTask->CDDrive() >= 0 ? TaskInfo::taskCdExtraction : spTask->GetTaskInfo().Type();
+
+   m_mapReadyTasks[schedulingType].push_back(spTask);
 
-   // check dependent task ID
-   unsigned int dependentTaskId = spTask->DependentTaskId();
+   DispatchReadyTasks();
+}
+
+void TaskManager::StartWaitingTasks(unsigned int finishedTaskId)
+{
+   auto iterWaitingTasks = m_mapWaitingTasks.find(finishedTaskId);
+   if (iterWaitingTasks == m_mapWaitingTasks.end())
+      return;
 
-   if (dependentTaskId == 0)
-      return true;
+   std::vector<std::shared_ptr<Task>> waitingTasks = std::move(iterWaitingTasks->second);
+   m_mapWaitingTasks.erase(iterWaitingTasks);
 
-   if (m_setFinishedTaskIds.find(dependentTaskId) == m_setFinishedTaskIds.end())
+   for (std::shared_ptr<Task> spTask : waitingTasks)
    {
-      // task id wasn't reported as finished yet
-      return false;
+      auto iterNumDependencies = m_mapNumUnfinishedDependencies.find(spTask->Id());
+      if (iterNumDependencies == m_mapNumUnfinishedDependencies.end())
+         continue; // already removed
+
+      if (--iterNumDependencies->second > 0)
+         continue; // still waiting for other tasks
+
+      m_mapNumUnfinishedDependencies.erase(iterNumDependencies);
+
+      if (m_mapCompletedTaskInfos.find(spTask->Id()) == m_mapCompletedTaskInfos.end())
+         StartTask(spTask);
+   }
+}
+
+void TaskManager::DispatchReadyTasks()
+{
+   // only post tasks when a thread is free, so that the thread pool's queue never
+   // holds tasks that could be overtaken by tasks with higher priority
+   for (TaskInfo::TaskType schedulingType : c_taskTypesByPriority)
+   {
+      auto iterReadyTasks = m_mapReadyTasks.find(schedulingType);
+      if (iterReadyTasks == m_mapReadyTasks.end())
+         continue;
+
+      std::deque<std::shared_ptr<Task>>& readyTasks = iterReadyTasks->second;
+
+      for (auto iter = readyTasks.begin(); iter != readyTasks.end() && m_numRunningTasks < m_numThreads;)
+      {
+         std::shared_ptr<Task> spTask = *iter;
+         int cdDrive = spTask->CDDrive();
+
+         // a task for a busy CD drive doesn't block tasks for other drives
+         if (!CanRunTask(schedulingType, cdDrive))
+         {
+            ++iter;
+            continue;
+         }
+
+         iter = readyTasks.erase(iter);
+
+         m_numRunningTasks++;
+
+         if (schedulingType == TaskInfo::taskEncoding)
+            m_numRunningEncodingTasks++;
+
+         if (cdDrive >= 0)
+         {
+            m_mapBusyCDDrives[cdDrive] = spTask->Id();
+
+            spTask->CDDriveReleasedHandler(
+               std::bind(&TaskManager::ReleaseCDDrive, this, cdDrive, spTask->Id()));
+         }
+
+         spTask->IsStarted(true);
+
+         boost::asio::post(
+            m_ioContext.get_executor(),
+            std::bind(&TaskManager::RunTask, this, spTask, schedulingType, cdDrive));
+      }
    }
+}
+
+bool TaskManager::CanRunTask(TaskInfo::TaskType schedulingType, int cdDrive) const
+{
+   if (cdDrive >= 0 &&
+      m_mapBusyCDDrives.find(cdDrive) != m_mapBusyCDDrives.end())
+      return false;
+
+   if (schedulingType == TaskInfo::taskEncoding &&
+      m_numRunningEncodingTasks >= m_maxEncodingTasks)
+      return false;
 
    return true;
 }
 
-void TaskManager::RunTask(std::shared_ptr<Task> spTask)
+void TaskManager::RunTask(std::shared_ptr<Task> spTask, TaskInfo::TaskType schedulingType, int cdDrive)
 {
    SetBusyFlag(GetCurrentThreadId(), true);
 
@@ -359,6 +450,69 @@ void TaskManager::RunTask(std::shared_ptr<Task> spTask)
    SetBusyFlag(GetCurrentThreadId(), false);
 
    StoreCompletedTaskInfo(spTask, errorText);
+
+   std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
+
+   m_numRunningTasks--;
+
+   if (schedulingType == TaskInfo::taskEncoding)
+      m_numRunningEncodingTasks--;
+
+   // the drive may already have been released, and be accessed by the next task
+   auto iterBusyCDDrive = m_mapBusyCDDrives.find(cdDrive);
+   if (iterBusyCDDrive != m_mapBusyCDDrives.end() &&
+      iterBusyCDDrive->second == spTask->Id())
+      m_mapBusyCDDrives.erase(iterBusyCDDrive);
+
+   DispatchReadyTasks();
+}
+
+void TaskManager::ReleaseCDDrive(int cdDrive, unsigned int taskId)
+{
+   std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
+
+   auto iterBusyCDDrive = m_mapBusyCDDrives.find(cdDrive);
+   if (iterBusyCDDrive == m_mapBusyCDDrives.end() ||
+      iterBusyCDDrive->second != taskId)
+      return; // already released
+
+   m_mapBusyCDDrives.erase(iterBusyCDDrive);
+
+   DispatchReadyTasks();
+}
+
+bool TaskManager::TryRun(std::function<void()> work)
+{
+   std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
+
+   if (m_numRunningTasks >= m_numThreads ||
+      !CanRunTask(TaskInfo::taskEncoding, -1))
+      return false;
+
+   m_numRunningTasks++;
+   m_numRunningEncodingTasks++;
+
+   boost::asio::post(
+      m_ioContext.get_executor(),
+      std::bind(&TaskManager::RunWork, this, std::move(work)));
+
+   return true;
+}
+
+void TaskManager::RunWork(std::function<void()> work)
+{
+   SetBusyFlag(GetCurrentThreadId(), true);
+
+   work();
+
+   SetBusyFlag(GetCurrentThreadId(), false);
+
+   std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
+
+   m_numRunningTasks--;
+   m_numRunningEncodingTasks--;
+
+   DispatchReadyTasks();
 }
 
 void TaskManager::StoreCompletedTaskInfo(std::shared_ptr<Task> spTask, CString& errorText)
@@ -388,9 +542,17 @@ void TaskManager::StoreCompletedTaskInfo(std::shared_ptr<Task> spTask, CString&
    {
       std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
 
-      m_mapCompletedTaskInfos.insert(std::make_pair(spTask->Id(), info));
+      // a task stopped by StopAll() is stored again when it returns from Run()
+      if (!m_mapCompletedTaskInfos.insert(std::make_pair(spTask->Id(), info)).second)
+         return;
+
+      m_statusFeed.PublishCompleted(info);
 
       m_setFinishedTaskIds.insert(spTask->Id());
+
+      StartWaitingTasks(spTask->Id());
+
+      m_conditionTaskCompleted.notify_all();
    }
 }
 
@@ -408,10 +570,14 @@ void TaskManager::RemoveTask(std::shared_ptr<Task> spTask)
 
          m_deqTaskQueue.erase(iterTaskQueue);
 
+         m_mapNumUnfinishedDependencies.erase(spTask->Id());
+
          auto iterTaskInfos = m_mapCompletedTaskInfos.find(spTask->Id());
          if (iterTaskInfos != m_mapCompletedTaskInfos.end())
             m_mapCompletedTaskInfos.erase(iterTaskInfos);
 
+         m_statusFeed.Remove(spTask->Id());
+
          return;
       }
    }
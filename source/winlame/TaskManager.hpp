@@ -27,15 +27,19 @@
 #include <memory>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <thread>
 #include <boost/asio.hpp>
 #include "TaskInfo.hpp"
+#include "TaskStatusFeed.hpp"
 #include "TaskManagerConfig.hpp"
+#include "WorkerPool.hpp"
 
 class Task;
 
 /// manages all background tasks
-class TaskManager
+class TaskManager : public Encoder::WorkerPool
 {
 public:
    /// ctor
@@ -46,42 +50,83 @@ public:
    /// returns a snapshot of current tasks
    std::vector<TaskInfo> CurrentTasks();
 
-   /// adds a task to the queue
+   /// adds a task to the queue; the task is started as soon as all tasks it depends on are finished
    void AddTask(std::shared_ptr<Task> spTask);
 
-   /// checks if there are tasks that are now runnable and starts them
-   void CheckRunnableTasks();
-
    /// returns if task queue is empty
    bool IsQueueEmpty() const;
 
    /// returns if there are running tasks
    bool AreRunningTasksAvail() const;
 
+   /// waits until all tasks in the queue are completed, or the timeout has elapsed;
+   /// returns false when there still are running tasks
+   bool WaitAllCompleted(std::chrono::milliseconds timeout);
+
    /// returns if there are completed tasks
    bool AreCompletedTasksAvail() const;
 
-   /// returns if there are CD Extract tasks running
+   /// returns if there are CD Extract tasks running, or encoder tasks reading from CD
    bool AreCDExtractTasksRunning() const;
 
    /// returns task list state infos
    void GetTaskListState(bool& hasActiveTasks, bool& hasErrorTasks, unsigned int& percentComplete) const;
 
+   /// registers a consumer of task changes; returns consumer id to pass to GetTaskChanges()
+   unsigned int RegisterTaskChangesConsumer();
+
+   /// unregisters a consumer of task changes
+   void UnregisterTaskChangesConsumer(unsigned int consumerId);
+
+   /// \brief returns task infos of all tasks that changed after given version, and the ids of
+   /// all removed tasks; returns the current version to pass on the next call
+   /// \details task infos are sorted by task id; pass version 0 to get all tasks
+   unsigned long long GetTaskChanges(unsigned int consumerId, unsigned long long sinceVersion,
+      std::vector<TaskInfo>& changedTaskInfos, std::vector<unsigned int>& removedTaskIds);
+
+   /// returns timing and throughput counters of all tasks in the queue, added up
+   Encoder::EncoderStatistics GetStatistics();
+
    /// stops all tasks
    void StopAll();
 
    /// removes all completed tasks from queue
    void RemoveCompletedTasks();
 
+   /// \brief runs work of a running encoding task on a free thread of the thread pool;
+   /// returns false when no thread is free or all encoding slots are used
+   /// \details the work counts as encoding task while it runs, so that all encoding
+   /// tasks together never use more threads than there are encoding slots
+   virtual bool TryRun(std::function<void()> work) override;
+
 private:
    /// thread function
    static void RunThread(boost::asio::io_context& ioContext, unsigned int threadNumber);
 
-   /// returns if a task is runnable
-   bool IsTaskRunnable(std::shared_ptr<Task> spTask) const;
+   /// queues task as ready to run, and runs it when a thread is available;
+   /// queue mutex must be locked
+   void StartTask(std::shared_ptr<Task> spTask);
+
+   /// starts all waiting tasks that only depended on the given finished task;
+   /// queue mutex must be locked
+   void StartWaitingTasks(unsigned int finishedTaskId);
+
+   /// posts ready tasks to the thread pool, in order of priority, as long as threads are
+   /// available and the limits of the task types allow; queue mutex must be locked
+   void DispatchReadyTasks();
+
+   /// returns if a task with given scheduling type and CD drive may run now; queue mutex must be locked
+   bool CanRunTask(TaskInfo::TaskType schedulingType, int cdDrive) const;
 
    /// runs single task
-   void RunTask(std::shared_ptr<Task> spTask);
+   void RunTask(std::shared_ptr<Task> spTask, TaskInfo::TaskType schedulingType, int cdDrive);
+
+   /// releases the CD drive when it's still accessed by the given task, and starts the
+   /// next task for the drive
+   void ReleaseCDDrive(int cdDrive, unsigned int taskId);
+
+   /// runs work passed to TryRun()
+   void RunWork(std::function<void()> work);
 
    /// stores task info for completed (or stopped) task
    void StoreCompletedTaskInfo(std::shared_ptr<Task> spTask, CString& errorText);
@@ -117,9 +162,43 @@ private:
    /// task infos of all completed tasks, protected by queue mutex
    std::map<unsigned int, TaskInfo> m_mapCompletedTaskInfos;
 
+   /// condition that is signaled when a task has completed; used with queue mutex
+   std::condition_variable_any m_conditionTaskCompleted;
+
+   /// latest task infos published by all tasks
+   TaskStatusFeed m_statusFeed;
+
    /// set with all finished task ids
    std::set<unsigned int> m_setFinishedTaskIds;
 
+   /// number of unfinished tasks each waiting task depends on, by waiting task id; protected by queue mutex
+   std::map<unsigned int, unsigned int> m_mapNumUnfinishedDependencies;
+
+   /// tasks waiting for a task, by id of the task they wait for; protected by queue mutex
+   std::map<unsigned int, std::vector<std::shared_ptr<Task>>> m_mapWaitingTasks;
+
+
+   // scheduling
+
+   /// tasks ready to run, by scheduling type; protected by queue mutex
+   std::map<TaskInfo::TaskType, std::deque<std::shared_ptr<Task>>> m_mapReadyTasks;
+
+   /// number of tasks posted to the thread pool and not finished yet; protected by queue mutex
+   unsigned int m_numRunningTasks;
+
+   /// number of running encoding tasks; protected by queue mutex
+   unsigned int m_numRunningEncodingTasks;
+
+   /// maximum number of encoding tasks running at the same time
+   unsigned int m_maxEncodingTasks;
+
+   /// number of threads in the thread pool
+   unsigned int m_numThreads;
+
+   /// CD drives that are accessed by a running task, with the id of the task; protected
+   /// by queue mutex
+   std::map<int, unsigned int> m_mapBusyCDDrives;
+
 
    // thread pool
 
@@ -0,0 +1,218 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TaskStatusFeed.cpp
+/// \brief Versioned feed of task status changes
+//
+#include "stdafx.h"
+#include "TaskStatusFeed.hpp"
+#include <algorithm>
+#include <limits>
+
+void TaskStatusFeed::Add(const TaskInfo& info)
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   ATLASSERT(m_mapEntries.find(info.Id()) == m_mapEntries.end());
+
+   Store(info, false);
+}
+
+void TaskStatusFeed::Publish(const TaskInfo& info)
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   // removed tasks aren't in the feed anymore, but stopped tasks may still report while finishing
+   auto iter = m_mapEntries.find(info.Id());
+   if (iter == m_mapEntries.end() || iter->second.m_isCompleted)
+      return;
+
+   Store(info, false);
+}
+
+void TaskStatusFeed::PublishCompleted(const TaskInfo& info)
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   auto iter = m_mapEntries.find(info.Id());
+   if (iter == m_mapEntries.end())
+      return; // task was already removed
+
+   if (iter->second.m_isCompleted)
+      return; // the first completed info is kept, as the task manager does
+
+   Store(info, true);
+}
+
+void TaskStatusFeed::Remove(unsigned int taskId)
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   auto iter = m_mapEntries.find(taskId);
+   if (iter == m_mapEntries.end())
+      return;
+
+   UpdateTaskListState(iter->second.m_info, false);
+
+   m_mapTaskIdByVersion.erase(iter->second.m_version);
+   m_mapEntries.erase(iter);
+
+   m_mapRemovedTaskIdByVersion[++m_version] = taskId;
+
+   PruneRemovedTaskIds();
+}
+
+TaskListState TaskStatusFeed::GetTaskListState() const
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   return m_taskListState;
+}
+
+unsigned int TaskStatusFeed::RegisterConsumer()
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   unsigned int consumerId = m_nextConsumerId++;
+
+   // a new consumer starts with version 0 and gets all tasks, so it doesn't need any
+   // removed task ids yet
+   m_mapConsumerVersions[consumerId] = std::numeric_limits<unsigned long long>::max();
+
+   return consumerId;
+}
+
+void TaskStatusFeed::UnregisterConsumer(unsigned int consumerId)
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   m_mapConsumerVersions.erase(consumerId);
+
+   PruneRemovedTaskIds();
+}
+
+unsigned long long TaskStatusFeed::GetChangesSince(unsigned int consumerId, unsigned long long version,
+   std::vector<TaskInfo>& changedTaskInfos, std::vector<unsigned int>& removedTaskIds)
+{
+   changedTaskInfos.clear();
+   removedTaskIds.clear();
+
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   for (auto iter = m_mapTaskIdByVersion.upper_bound(version); iter != m_mapTaskIdByVersion.end(); ++iter)
+      changedTaskInfos.push_back(m_mapEntries.find(iter->second)->second.m_info);
+
+   for (auto iter = m_mapRemovedTaskIdByVersion.upper_bound(version); iter != m_mapRemovedTaskIdByVersion.end(); ++iter)
+      removedTaskIds.push_back(iter->second);
+
+   unsigned long long currentVersion = m_version;
+
+   ATLASSERT(m_mapConsumerVersions.find(consumerId) != m_mapConsumerVersions.end());
+   m_mapConsumerVersions[consumerId] = currentVersion;
+
+   PruneRemovedTaskIds();
+
+   lock.unlock();
+
+   std::sort(changedTaskInfos.begin(), changedTaskInfos.end(),
+      [](const TaskInfo& lhs, const TaskInfo& rhs) { return lhs.Id() < rhs.Id(); });
+
+   return currentVersion;
+}
+
+void TaskStatusFeed::Store(const TaskInfo& info, bool isCompleted)
+{
+   unsigned long long version = ++m_version;
+
+   auto iter = m_mapEntries.find(info.Id());
+   if (iter == m_mapEntries.end())
+   {
+      m_mapEntries.emplace(info.Id(), Entry(info, version, isCompleted));
+   }
+   else
+   {
+      UpdateTaskListState(iter->second.m_info, false);
+
+      m_mapTaskIdByVersion.erase(iter->second.m_version);
+
+      iter->second.m_info = info;
+      iter->second.m_version = version;
+      iter->second.m_isCompleted = isCompleted;
+   }
+
+   UpdateTaskListState(info, true);
+
+   m_mapTaskIdByVersion[version] = info.Id();
+}
+
+void TaskStatusFeed::PruneRemovedTaskIds()
+{
+   unsigned long long seenVersion = m_version;
+   for (const auto& consumerVersion : m_mapConsumerVersions)
+      seenVersion = std::min(seenVersion, consumerVersion.second);
+
+   m_mapRemovedTaskIdByVersion.erase(
+      m_mapRemovedTaskIdByVersion.begin(),
+      m_mapRemovedTaskIdByVersion.upper_bound(seenVersion));
+}
+
+void TaskStatusFeed::UpdateTaskListState(const TaskInfo& info, bool add)
+{
+   unsigned int numRunningTasks = 0;
+   unsigned int numErrorTasks = 0;
+   unsigned int progress = 0;
+
+   switch (info.Status())
+   {
+   case TaskInfo::statusWaiting:
+      break;
+
+   case TaskInfo::statusRunning:
+      numRunningTasks = 1;
+      progress = std::min(info.Progress(), 100U);
+      break;
+
+   case TaskInfo::statusError:
+      numErrorTasks = 1;
+      progress = 100;
+      break;
+
+   case TaskInfo::statusCompleted:
+      progress = 100;
+      break;
+
+   default:
+      ATLASSERT(false);
+      break;
+   }
+
+   if (add)
+   {
+      m_taskListState.m_numTasks++;
+      m_taskListState.m_numRunningTasks += numRunningTasks;
+      m_taskListState.m_numErrorTasks += numErrorTasks;
+      m_taskListState.m_progressSum += progress;
+   }
+   else
+   {
+      m_taskListState.m_numTasks--;
+      m_taskListState.m_numRunningTasks -= numRunningTasks;
+      m_taskListState.m_numErrorTasks -= numErrorTasks;
+      m_taskListState.m_progressSum -= progress;
+   }
+}
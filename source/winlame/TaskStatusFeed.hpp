@@ -0,0 +1,145 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TaskStatusFeed.hpp
+/// \brief Versioned feed of task status changes
+//
+#pragma once
+
+#include "TaskInfo.hpp"
+#include <map>
+#include <mutex>
+#include <vector>
+
+/// aggregated state of all tasks in the task status feed
+struct TaskListState
+{
+   /// number of tasks
+   unsigned int m_numTasks = 0;
+
+   /// number of running tasks
+   unsigned int m_numRunningTasks = 0;
+
+   /// number of tasks with errors
+   unsigned int m_numErrorTasks = 0;
+
+   /// sum of the progress of all tasks, in percent; completed tasks and tasks with errors count as 100
+   unsigned int m_progressSum = 0;
+
+   /// returns progress of all tasks, in percent; 100 when there are no tasks
+   unsigned int PercentComplete() const
+   {
+      return m_numTasks == 0 ? 100 : m_progressSum / m_numTasks;
+   }
+};
+
+/// \brief collects task infos published by tasks, with a version number for every change
+/// \details Every published task info gets the next version number. Consumers register
+/// with the feed, remember the version returned by GetChangesSince() and on the next call
+/// only get the task infos that changed since then, plus the ids of removed tasks. Removed
+/// task ids are only kept until all registered consumers have seen the removal. The task
+/// list state is updated with every change, so it can be queried without visiting all
+/// tasks. The feed has its own mutex and never calls out while holding it.
+class TaskStatusFeed
+{
+public:
+   /// adds a new task to the feed, with its initial task info
+   void Add(const TaskInfo& info);
+
+   /// publishes the current task info of a task; ignored when the task already is completed or removed
+   void Publish(const TaskInfo& info);
+
+   /// publishes the final task info of a completed task; later task infos are ignored
+   void PublishCompleted(const TaskInfo& info);
+
+   /// removes task from the feed
+   void Remove(unsigned int taskId);
+
+   /// returns the task list state
+   TaskListState GetTaskListState() const;
+
+   /// registers a consumer of the feed; returns consumer id to pass to GetChangesSince()
+   unsigned int RegisterConsumer();
+
+   /// unregisters a consumer of the feed
+   void UnregisterConsumer(unsigned int consumerId);
+
+   /// \brief returns all changes after given version, and the current version
+   /// \details the task infos are sorted by task id; version 0 returns all tasks. Removed
+   /// task ids may contain tasks the caller never saw. The consumer must pass the returned
+   /// version on the next call, so removed task ids up to that version aren't needed anymore.
+   unsigned long long GetChangesSince(unsigned int consumerId, unsigned long long version,
+      std::vector<TaskInfo>& changedTaskInfos, std::vector<unsigned int>& removedTaskIds);
+
+private:
+   /// stores task info as new version; mutex must be locked
+   void Store(const TaskInfo& info, bool isCompleted);
+
+   /// removes the ids of removed tasks that all consumers have seen; mutex must be locked
+   void PruneRemovedTaskIds();
+
+   /// adds or subtracts the task info from the task list state; mutex must be locked
+   void UpdateTaskListState(const TaskInfo& info, bool add);
+
+private:
+   /// latest task info of a task
+   struct Entry
+   {
+      /// ctor
+      Entry(const TaskInfo& info, unsigned long long version, bool isCompleted)
+         :m_info(info),
+         m_version(version),
+         m_isCompleted(isCompleted)
+      {
+      }
+
+      /// task info
+      TaskInfo m_info;
+
+      /// version when the task info was published
+      unsigned long long m_version;
+
+      /// indicates if this is the final task info of a completed task
+      bool m_isCompleted;
+   };
+
+   /// mutex protecting all members
+   mutable std::mutex m_mutex;
+
+   /// current version; incremented with every change
+   unsigned long long m_version = 0;
+
+   /// latest entries of all tasks, by task id
+   std::map<unsigned int, Entry> m_mapEntries;
+
+   /// task id of the latest change of every task in m_mapEntries, by version
+   std::map<unsigned long long, unsigned int> m_mapTaskIdByVersion;
+
+   /// ids of removed tasks, by the version they were removed with; only contains
+   /// removals that not all consumers have seen yet
+   std::map<unsigned long long, unsigned int> m_mapRemovedTaskIdByVersion;
+
+   /// version up to which each consumer has got all changes, by consumer id
+   std::map<unsigned int, unsigned long long> m_mapConsumerVersions;
+
+   /// id of the next registered consumer
+   unsigned int m_nextConsumerId = 1;
+
+   /// task list state of all entries
+   TaskListState m_taskListState;
+};
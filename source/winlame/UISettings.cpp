@@ -36,10 +36,13 @@ LPCTSTR g_pszInputOutputSameFolder = _T("InputOutputSameFolder");
 LPCTSTR g_pszLastInputPath = _T("LastInputPath");
 LPCTSTR g_pszDeleteAfterEncode = _T("DeleteAfterEncode");
 LPCTSTR g_pszOverwriteExisting = _T("OverwriteExisting");
+LPCTSTR g_pszPipelinedEncoding = _T("PipelinedEncoding");
+LPCTSTR g_pszUseTranscodeCache = _T("UseTranscodeCache");
 LPCTSTR g_pszActionAfterEncoding = _T("ActionAfterEncoding");
 LPCTSTR g_pszEjectDiscAfterReading = _T("EjectDiscAfterReading");
 LPCTSTR g_pszLastSelectedPresetIndex = _T("LastSelectedPresetIndex");
 LPCTSTR g_pszCdripTempFolder = _T("CDExtractTempFolder");
+LPCTSTR g_pszCdripUseTempFile = _T("CDExtractUseTempFile");
 LPCTSTR g_pszOutputPathHistory = _T("OutputPathHistory%02zu");
 LPCTSTR g_pszFreedbServer = _T("FreedbServer");
 LPCTSTR g_pszDiscInfosCdplayerIni = _T("StoreDiscInfosInCdplayerIni");
@@ -55,7 +58,9 @@ LPCTSTR g_pszUseNumTasks = _T("TaskManagerUseNumTasks");
 
 EncodingSettings::EncodingSettings()
    :delete_after_encode(false),
-   overwrite_existing(true)
+   overwrite_existing(true),
+   pipelined_encoding(false),
+   use_transcode_cache(false)
 {
 }
 
@@ -73,6 +78,7 @@ UISettings::UISettings()
    m_iLastSelectedPresetIndex(1), // first preset is the "best practice" preset
    last_page_was_cdrip_page(false),
    cdrip_temp_folder(Path::TempFolder()),
+   cdrip_use_temp_file(false),
    freedb_server(_T("gnudb.gnudb.org")),
    store_disc_infos_cdplayer_ini(true),
    cdrip_format_various_track(_T("%track% - %album% - %artist% - %title%")),
@@ -149,6 +155,12 @@ void UISettings::ReadSettings()
    // read "overwrite existing" value
    ReadBooleanValue(regRoot, g_pszOverwriteExisting, m_defaultSettings.overwrite_existing);
 
+   // read "pipelined encoding" value
+   ReadBooleanValue(regRoot, g_pszPipelinedEncoding, m_defaultSettings.pipelined_encoding);
+
+   // read "use transcode cache" value
+   ReadBooleanValue(regRoot, g_pszUseTranscodeCache, m_defaultSettings.use_transcode_cache);
+
    // read "action after encoding" value
    ReadIntValue(regRoot, g_pszActionAfterEncoding, after_encoding_action);
 
@@ -158,6 +170,9 @@ void UISettings::ReadSettings()
    // read "cd extraction temp folder"
    ReadStringValue(regRoot, g_pszCdripTempFolder, MAX_PATH, cdrip_temp_folder);
 
+   // read "cd extraction uses temp file" value
+   ReadBooleanValue(regRoot, g_pszCdripUseTempFile, cdrip_use_temp_file);
+
    // read "freedb server"
    ReadStringValue(regRoot, g_pszFreedbServer, MAX_PATH, freedb_server);
 
@@ -253,6 +268,14 @@ void UISettings::StoreSettings()
    value = m_defaultSettings.overwrite_existing ? 1 : 0;
    regRoot.SetValue(value, g_pszOverwriteExisting);
 
+   // write "pipelined encoding" value
+   value = m_defaultSettings.pipelined_encoding ? 1 : 0;
+   regRoot.SetValue(value, g_pszPipelinedEncoding);
+
+   // write "use transcode cache" value
+   value = m_defaultSettings.use_transcode_cache ? 1 : 0;
+   regRoot.SetValue(value, g_pszUseTranscodeCache);
+
    // write "action after encoding" value
    value = after_encoding_action;
    regRoot.SetValue(value, g_pszActionAfterEncoding);
@@ -267,6 +290,10 @@ void UISettings::StoreSettings()
    // write cd extraction temp folder
    regRoot.SetValue(cdrip_temp_folder, g_pszCdripTempFolder);
 
+   // write "cd extraction uses temp file" value
+   value = cdrip_use_temp_file ? 1 : 0;
+   regRoot.SetValue(value, g_pszCdripUseTempFile);
+
    // write freedb server
    regRoot.SetValue(freedb_server, g_pszFreedbServer);
 
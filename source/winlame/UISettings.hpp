@@ -51,6 +51,12 @@ struct EncodingSettings
 
    /// indicates if existing files will be overwritten
    bool overwrite_existing;
+
+   /// indicates if files are decoded on a separate thread, ahead of encoding
+   bool pipelined_encoding;
+
+   /// indicates if output files of unchanged input files are reused from the transcode cache
+   bool use_transcode_cache;
 };
 
 /// general UI settings
@@ -114,6 +120,10 @@ struct UISettings
    /// temporary folder for cd ripping
    CString cdrip_temp_folder;
 
+   /// indicates if CD tracks are extracted to a temporary wave file before encoding,
+   /// instead of being read directly into the encoder
+   bool cdrip_use_temp_file;
+
    /// freedb servername
    CString freedb_server;
 
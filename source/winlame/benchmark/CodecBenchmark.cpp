@@ -0,0 +1,735 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file CodecBenchmark.cpp
+/// \brief codec throughput benchmark
+//
+#include "stdafx.h"
+#include "CodecBenchmark.hpp"
+#include "ModuleManagerImpl.hpp"
+#include "ChannelMatrix.hpp"
+#include "EncoderStatistics.hpp"
+#include "App.hpp"
+#include "JsonString.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using Benchmark::BenchmarkResult;
+using Benchmark::CodecBenchmark;
+using Encoder::NanosecondsSince;
+using Encoder::JsonString;
+
+/// sample rate of the PCM signal
+const unsigned int c_signalSamplerate = 44100;
+
+/// number of channels of the PCM signal
+const unsigned int c_signalChannels = 2;
+
+/// sample rate the PCM signal is resampled to; the Opus coding rate
+const unsigned int c_resampleSamplerate = 48000;
+
+/// number of samples per channel passed to modules in one call
+const unsigned int c_blockSize = 4096;
+
+/// returns size of a file, or 0 when the file doesn't exist
+static unsigned long long FileSize(const CString& filename)
+{
+   WIN32_FILE_ATTRIBUTE_DATA data = { 0 };
+   if (!GetFileAttributesEx(filename, GetFileExInfoStandard, &data))
+      return 0;
+
+   return (static_cast<unsigned long long>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+}
+
+/// stores nanoseconds in the result when it's the fastest run so far
+static void StoreFastestRun(BenchmarkResult& result, unsigned long long nanoseconds)
+{
+   if (result.m_nanoseconds == 0 || nanoseconds < result.m_nanoseconds)
+      result.m_nanoseconds = std::max(nanoseconds, 1ULL);
+}
+
+/// returns the name of an instruction set
+static LPCTSTR InstructionSetName(Encoder::SampleConverterInstructionSet instructionSet)
+{
+   switch (instructionSet)
+   {
+   case Encoder::instructionSetScalar: return _T("scalar");
+   case Encoder::instructionSetSSE2: return _T("sse2");
+   case Encoder::instructionSetAVX2: return _T("avx2");
+   default:
+      ATLASSERT(false);
+      return _T("unknown");
+   }
+}
+
+/// returns the name of a resampler quality
+static LPCTSTR ResamplerQualityName(Encoder::ResamplerQuality quality)
+{
+   switch (quality)
+   {
+   case Encoder::resamplerQualityOff: return _T("off");
+   case Encoder::resamplerQualityFast: return _T("fast");
+   case Encoder::resamplerQualityMedium: return _T("medium");
+   case Encoder::resamplerQualityBest: return _T("best");
+   default:
+      ATLASSERT(false);
+      return _T("unknown");
+   }
+}
+
+double BenchmarkResult::MegabytesPerSecond() const
+{
+   return m_nanoseconds == 0 ? 0.0 : (m_numBytes / 1e6) / (m_nanoseconds / 1e9);
+}
+
+double BenchmarkResult::SamplesPerSecond() const
+{
+   return m_nanoseconds == 0 ? 0.0 : m_numSamples / (m_nanoseconds / 1e9);
+}
+
+double BenchmarkResult::RealtimeFactor() const
+{
+   return m_samplerateInHz == 0 ? 0.0 : SamplesPerSecond() / m_samplerateInHz;
+}
+
+CodecBenchmark::CodecBenchmark(Encoder::ModuleManagerImpl& moduleManager, unsigned int numIterations,
+   unsigned int lengthInSeconds)
+   :m_moduleManager(moduleManager),
+   m_numIterations(std::max(numIterations, 1U))
+{
+   // two sine tones with some noise, so that encoders have to do actual work
+   size_t numSamples = size_t(lengthInSeconds) * c_signalSamplerate;
+   m_signal.resize(numSamples * c_signalChannels);
+
+   const double pi = 3.14159265358979323846;
+   unsigned int noise = 12345;
+   for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+   {
+      double time = double(sampleIndex) / c_signalSamplerate;
+      for (unsigned int channel = 0; channel < c_signalChannels; channel++)
+      {
+         noise = noise * 1103515245 + 12345;
+         double value =
+            0.4 * std::sin(2.0 * pi * (440.0 + 220.0 * channel) * time) +
+            0.05 * ((noise >> 16) / 32768.0 - 1.0);
+
+         m_signal[sampleIndex * c_signalChannels + channel] = static_cast<short>(value * 32767.0);
+      }
+   }
+}
+
+void CodecBenchmark::RunDecoders(const CString& corpusFolder)
+{
+   std::vector<CString> filenames;
+
+   WIN32_FIND_DATA findData = { 0 };
+   HANDLE hFind = ::FindFirstFile(Path::Combine(corpusFolder, _T("*.*")), &findData);
+   if (hFind != INVALID_HANDLE_VALUE)
+   {
+      do
+      {
+         if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+            filenames.push_back(Path::Combine(corpusFolder, findData.cFileName));
+      } while (TRUE == ::FindNextFile(hFind, &findData));
+
+      ::FindClose(hFind);
+   }
+
+   std::sort(filenames.begin(), filenames.end());
+
+   for (size_t moduleIndex = 0, maxModuleIndex = m_moduleManager.GetInputModuleCount(); moduleIndex < maxModuleIndex; moduleIndex++)
+   {
+      Encoder::InputModule& inputModule = *m_moduleManager.GetInputModuleInstance(moduleIndex);
+      CString filterString = inputModule.GetFilterString();
+
+      for (const CString& filename : filenames)
+      {
+         if (!IsFilterMatching(filterString, filename))
+            continue;
+
+         BenchmarkResult result;
+         result.m_category = _T("decode");
+         result.m_name = inputModule.GetModuleName();
+         result.m_configuration = Path::FilenameAndExt(filename);
+
+         for (unsigned int iteration = 0; iteration < m_numIterations; iteration++)
+         {
+            if (!DecodeFile(inputModule, filename, result))
+               break;
+         }
+
+         m_results.push_back(result);
+      }
+   }
+}
+
+bool CodecBenchmark::DecodeFile(Encoder::InputModule& inputModulePrototype, const CString& filename,
+   BenchmarkResult& result)
+{
+   std::unique_ptr<Encoder::InputModule> inputModule(inputModulePrototype.CloneModule());
+
+   Encoder::TrackInfo trackInfo;
+   Encoder::SampleContainer samples;
+   SettingsManager settingsManager;
+
+   auto startTime = std::chrono::steady_clock::now();
+
+   int ret = inputModule->InitInput(filename, settingsManager, trackInfo, samples);
+
+   unsigned long long numSamples = 0;
+   if (ret >= 0)
+   {
+      // decode to the input format, so that as little conversion as possible is done
+      if (samples.IsInputModuleFloat())
+         samples.SetOutputModuleFloatTraits(Encoder::SamplesInterleaved);
+      else
+         samples.SetOutputModuleTraits(samples.GetInputModuleBitsPerSample(), Encoder::SamplesInterleaved);
+
+      while ((ret = inputModule->DecodeSamples(samples)) > 0)
+         numSamples += ret;
+   }
+
+   // conversion is measured separately
+   unsigned long long nanoseconds = NanosecondsSince(startTime) - samples.GetConversionNanoseconds();
+
+   if (ret < 0)
+      result.m_errorText = inputModule->GetLastError();
+
+   inputModule->DoneInput();
+
+   if (ret < 0)
+      return false;
+
+   result.m_numChannels = static_cast<unsigned int>(samples.GetInputModuleChannels());
+   result.m_samplerateInHz = static_cast<unsigned int>(samples.GetInputModuleSampleRate());
+   result.m_numSamples = numSamples;
+   result.m_numBytes = FileSize(filename);
+
+   StoreFastestRun(result, nanoseconds);
+
+   return true;
+}
+
+void CodecBenchmark::RunEncoders(const CString& outputFolder, SettingsManager& settingsManager)
+{
+   for (size_t moduleIndex = 0, maxModuleIndex = m_moduleManager.GetOutputModuleCount(); moduleIndex < maxModuleIndex; moduleIndex++)
+   {
+      BenchmarkResult result;
+      result.m_category = _T("encode");
+      result.m_name = m_moduleManager.GetOutputModuleName(moduleIndex);
+      result.m_configuration.Format(_T("int16 interleaved, %u channels, %u Hz"), c_signalChannels, c_signalSamplerate);
+
+      for (unsigned int iteration = 0; iteration < m_numIterations; iteration++)
+      {
+         if (!EncodeSignal(m_moduleManager.GetOutputModuleID(moduleIndex), outputFolder, settingsManager, result))
+            break;
+      }
+
+      m_results.push_back(result);
+   }
+}
+
+bool CodecBenchmark::EncodeSignal(int outputModuleID, const CString& outputFolder,
+   SettingsManager& settingsManager, BenchmarkResult& result,
+   bool includeConversion)
+{
+   std::unique_ptr<Encoder::OutputModule> outputModule(m_moduleManager.GetOutputModule(outputModuleID));
+   if (outputModule == nullptr)
+   {
+      result.m_errorText = _T("output module is not available");
+      return false;
+   }
+
+   outputModule->PrepareOutput(settingsManager);
+
+   CString outputFilename = Path::Combine(outputFolder, _T("benchmark.") + outputModule->GetOutputExtension());
+
+   // encode to memory, so that the disk doesn't affect the encoding time
+   std::shared_ptr<Encoder::MemoryOutputSink> memoryOutputSink;
+   if (outputModule->SupportsOutputSink())
+   {
+      memoryOutputSink = std::make_shared<Encoder::MemoryOutputSink>();
+      outputModule->SetOutputSink(memoryOutputSink);
+   }
+
+   Encoder::TrackInfo trackInfo;
+   Encoder::SampleContainer samples;
+   samples.SetInputModuleTraits(16, Encoder::SamplesInterleaved, c_signalSamplerate, c_signalChannels);
+   samples.SetResamplerQuality(
+      static_cast<Encoder::ResamplerQuality>(settingsManager.QueryValueInt(GeneralResamplerQuality)));
+
+   size_t numSamples = m_signal.size() / c_signalChannels;
+
+   auto startTime = std::chrono::steady_clock::now();
+
+   int ret = outputModule->InitOutput(outputFilename, settingsManager, trackInfo, samples);
+
+   // deliver blocks of the size the output module prefers, as input modules do
+   size_t blockSize = static_cast<size_t>(samples.GetPreferredBlockSize());
+
+   for (size_t offset = 0; ret >= 0 && offset < numSamples; offset += blockSize)
+   {
+      int numBlockSamples = static_cast<int>(std::min<size_t>(blockSize, numSamples - offset));
+
+      samples.PutSamplesInterleaved(m_signal.data() + offset * c_signalChannels, numBlockSamples);
+
+      ret = outputModule->EncodeSamples(samples);
+   }
+
+   // encode the samples the resampler held back
+   if (ret >= 0 && samples.FlushSamples() > 0)
+      ret = outputModule->EncodeSamples(samples);
+
+   if (ret < 0)
+      result.m_errorText = outputModule->GetLastError();
+
+   outputModule->DoneOutput();
+
+   // conversion is measured separately, unless it replaces work the output module would do
+   unsigned long long nanoseconds = NanosecondsSince(startTime);
+   if (!includeConversion)
+      nanoseconds -= samples.GetConversionNanoseconds();
+
+   if (memoryOutputSink != nullptr)
+      result.m_numOutputBytes = memoryOutputSink->GetData().size();
+   else
+   {
+      result.m_numOutputBytes = FileSize(outputFilename);
+      DeleteFile(outputFilename);
+   }
+
+   if (ret < 0)
+      return false;
+
+   result.m_numChannels = c_signalChannels;
+   result.m_samplerateInHz = c_signalSamplerate;
+   result.m_numSamples = numSamples;
+   result.m_numBytes = m_signal.size() * sizeof(short);
+
+   StoreFastestRun(result, nanoseconds);
+
+   return true;
+}
+
+void CodecBenchmark::RunSampleConversions()
+{
+   /// sample conversion configuration
+   struct ConversionConfig
+   {
+      Encoder::SampleType m_sourceType;                ///< source sample type
+      Encoder::SampleFormatType m_sourceFormat;        ///< source sample format
+      Encoder::SampleType m_targetType;                ///< target sample type
+      Encoder::SampleFormatType m_targetFormat;        ///< target sample format
+   };
+
+   // conversions that occur between the available input and output modules
+   const ConversionConfig configs[] =
+   {
+      { Encoder::SampleTypeInt16, Encoder::SamplesInterleaved, Encoder::SampleTypeInt16, Encoder::SamplesInterleaved },
+      { Encoder::SampleTypeInt16, Encoder::SamplesInterleaved, Encoder::SampleTypeInt32, Encoder::SamplesChannelArray },
+      { Encoder::SampleTypeInt16, Encoder::SamplesInterleaved, Encoder::SampleTypeFloat32, Encoder::SamplesChannelArray },
+      { Encoder::SampleTypeInt24, Encoder::SamplesInterleaved, Encoder::SampleTypeInt16, Encoder::SamplesInterleaved },
+      { Encoder::SampleTypeInt24, Encoder::SamplesInterleaved, Encoder::SampleTypeFloat32, Encoder::SamplesInterleaved },
+      { Encoder::SampleTypeInt32, Encoder::SamplesChannelArray, Encoder::SampleTypeInt16, Encoder::SamplesInterleaved },
+      { Encoder::SampleTypeFloat32, Encoder::SamplesChannelArray, Encoder::SampleTypeInt16, Encoder::SamplesInterleaved },
+      { Encoder::SampleTypeFloat32, Encoder::SamplesInterleaved, Encoder::SampleTypeInt32, Encoder::SamplesInterleaved },
+   };
+
+   Encoder::SampleConverterInstructionSet previousInstructionSet = Encoder::SampleConverter::GetInstructionSet();
+   Encoder::SampleConverterInstructionSet supportedInstructionSet = Encoder::SampleConverter::GetSupportedInstructionSet();
+
+   for (int instructionSet = Encoder::instructionSetScalar; instructionSet <= supportedInstructionSet; instructionSet++)
+   {
+      Encoder::SampleConverter::SetInstructionSet(static_cast<Encoder::SampleConverterInstructionSet>(instructionSet));
+
+      for (const ConversionConfig& config : configs)
+      {
+         BenchmarkResult result;
+         result.m_category = _T("convert");
+         result.m_name = _T("SampleContainer");
+         result.m_configuration.Format(_T("%s -> %s, %s"),
+            FormatName(config.m_sourceType, config.m_sourceFormat).GetString(),
+            FormatName(config.m_targetType, config.m_targetFormat).GetString(),
+            InstructionSetName(static_cast<Encoder::SampleConverterInstructionSet>(instructionSet)));
+
+         for (unsigned int iteration = 0; iteration < m_numIterations; iteration++)
+            ConvertSamples(config.m_sourceType, config.m_sourceFormat, config.m_targetType, config.m_targetFormat, result);
+
+         m_results.push_back(result);
+      }
+   }
+
+   Encoder::SampleConverter::SetInstructionSet(previousInstructionSet);
+}
+
+void CodecBenchmark::ConvertSamples(Encoder::SampleType sourceType, Encoder::SampleFormatType sourceFormat,
+   Encoder::SampleType targetType, Encoder::SampleFormatType targetFormat,
+   BenchmarkResult& result)
+{
+   size_t numSamples = m_signal.size() / c_signalChannels;
+   unsigned int sampleSize = Encoder::SampleConverter::GetSampleSize(sourceType);
+
+   // prepare source samples; not measured
+   std::vector<std::vector<unsigned char>> sourceBuffers(
+      sourceFormat == Encoder::SamplesInterleaved ? 1 : c_signalChannels);
+
+   for (auto& sourceBuffer : sourceBuffers)
+      sourceBuffer.resize(numSamples * sampleSize * (sourceFormat == Encoder::SamplesInterleaved ? c_signalChannels : 1));
+
+   if (sourceFormat == Encoder::SamplesInterleaved)
+   {
+      Encoder::SampleConverter::InterleavedToInterleaved(m_signal.data(), Encoder::SampleTypeInt16,
+         sourceBuffers[0].data(), sourceType, numSamples, c_signalChannels);
+   }
+   else
+   {
+      void* channels[c_signalChannels] = { sourceBuffers[0].data(), sourceBuffers[1].data() };
+
+      Encoder::SampleConverter::InterleavedToArray(m_signal.data(), Encoder::SampleTypeInt16,
+         channels, sourceType, numSamples, c_signalChannels);
+   }
+
+   Encoder::SampleContainer samples;
+
+   if (sourceType == Encoder::SampleTypeFloat32)
+      samples.SetInputModuleFloatTraits(sourceFormat, c_signalSamplerate, c_signalChannels);
+   else
+      samples.SetInputModuleTraits(static_cast<int>(sampleSize * 8), sourceFormat, c_signalSamplerate, c_signalChannels);
+
+   if (targetType == Encoder::SampleTypeFloat32)
+      samples.SetOutputModuleFloatTraits(targetFormat);
+   else
+      samples.SetOutputModuleTraits(static_cast<int>(Encoder::SampleConverter::GetSampleSize(targetType) * 8), targetFormat);
+
+   samples.ReserveSamples(c_blockSize);
+
+   for (size_t offset = 0; offset < numSamples; offset += c_blockSize)
+   {
+      int numBlockSamples = static_cast<int>(std::min<size_t>(c_blockSize, numSamples - offset));
+
+      if (sourceFormat == Encoder::SamplesInterleaved)
+      {
+         samples.PutSamplesInterleaved(sourceBuffers[0].data() + offset * sampleSize * c_signalChannels, numBlockSamples);
+      }
+      else
+      {
+         void* channels[c_signalChannels] =
+         {
+            sourceBuffers[0].data() + offset * sampleSize,
+            sourceBuffers[1].data() + offset * sampleSize,
+         };
+
+         samples.PutSamplesArray(channels, numBlockSamples);
+      }
+   }
+
+   result.m_numChannels = c_signalChannels;
+   result.m_samplerateInHz = c_signalSamplerate;
+   result.m_numSamples = numSamples;
+   result.m_numBytes = numSamples * sampleSize * c_signalChannels;
+
+   StoreFastestRun(result, samples.GetConversionNanoseconds());
+}
+
+void CodecBenchmark::RunChannelRemapping()
+{
+   /// channel matrix configuration
+   struct MatrixConfig
+   {
+      LPCTSTR m_name;                     ///< name of the matrix
+      Encoder::ChannelMatrix m_matrix;    ///< channel matrix
+      Encoder::SampleType m_sourceType;   ///< source sample type
+      Encoder::SampleType m_targetType;   ///< target sample type
+   };
+
+   // remapping as done by the input and output modules, and downmixing of 7.1 and 7.1.4 material
+   MatrixConfig configs[] =
+   {
+      { _T("aacInput"), Encoder::ChannelMatrix::FromChannelMapType(Encoder::aacInputChannelMap, 6), Encoder::SampleTypeInt16, Encoder::SampleTypeInt16 },
+      { _T("oggVorbisOutput"), Encoder::ChannelMatrix::FromChannelMapType(Encoder::oggVorbisOutputChannelMap, 8), Encoder::SampleTypeFloat32, Encoder::SampleTypeFloat32 },
+      { _T("oggVorbisOutput"), Encoder::ChannelMatrix::FromChannelMapType(Encoder::oggVorbisOutputChannelMap, 8), Encoder::SampleTypeInt16, Encoder::SampleTypeFloat32 },
+      { _T("stereoDownmix"), CreateStereoDownmixMatrix(8), Encoder::SampleTypeFloat32, Encoder::SampleTypeFloat32 },
+      { _T("stereoDownmix"), CreateStereoDownmixMatrix(12), Encoder::SampleTypeInt16, Encoder::SampleTypeFloat32 },
+   };
+
+   size_t numSamples = m_signal.size() / c_signalChannels;
+
+   Encoder::SampleConverterInstructionSet previousInstructionSet = Encoder::SampleConverter::GetInstructionSet();
+   Encoder::SampleConverterInstructionSet supportedInstructionSet = Encoder::SampleConverter::GetSupportedInstructionSet();
+
+   for (MatrixConfig& config : configs)
+   {
+      size_t numInputChannels = config.m_matrix.GetNumInputChannels();
+      size_t numOutputChannels = config.m_matrix.GetNumOutputChannels();
+      unsigned int sourceSampleSize = Encoder::SampleConverter::GetSampleSize(config.m_sourceType);
+
+      // prepare source samples, with the signal's channels repeated; not measured
+      std::vector<short> signal(numSamples * numInputChannels);
+      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+         for (size_t channel = 0; channel < numInputChannels; channel++)
+            signal[sampleIndex * numInputChannels + channel] = m_signal[sampleIndex * c_signalChannels + channel % c_signalChannels];
+
+      std::vector<unsigned char> sourceBuffer(signal.size() * sourceSampleSize);
+      Encoder::SampleConverter::InterleavedToInterleaved(signal.data(), Encoder::SampleTypeInt16,
+         sourceBuffer.data(), config.m_sourceType, numSamples, numInputChannels);
+
+      std::vector<unsigned char> targetBuffer(
+         c_blockSize * numOutputChannels * Encoder::SampleConverter::GetSampleSize(config.m_targetType));
+
+      for (int instructionSet = Encoder::instructionSetScalar; instructionSet <= supportedInstructionSet; instructionSet++)
+      {
+         Encoder::SampleConverter::SetInstructionSet(static_cast<Encoder::SampleConverterInstructionSet>(instructionSet));
+
+         BenchmarkResult result;
+         result.m_category = _T("remap");
+         result.m_name = _T("ChannelMatrix");
+         result.m_configuration.Format(_T("%s, %s -> %s, %u -> %u channels, %s"),
+            config.m_name,
+            FormatName(config.m_sourceType, Encoder::SamplesInterleaved).GetString(),
+            FormatName(config.m_targetType, Encoder::SamplesInterleaved).GetString(),
+            static_cast<unsigned int>(numInputChannels), static_cast<unsigned int>(numOutputChannels),
+            InstructionSetName(static_cast<Encoder::SampleConverterInstructionSet>(instructionSet)));
+         result.m_numChannels = static_cast<unsigned int>(numInputChannels);
+         result.m_samplerateInHz = c_signalSamplerate;
+         result.m_numSamples = numSamples;
+         result.m_numBytes = sourceBuffer.size();
+
+         for (unsigned int iteration = 0; iteration < m_numIterations; iteration++)
+         {
+            auto startTime = std::chrono::steady_clock::now();
+
+            for (size_t offset = 0; offset < numSamples; offset += c_blockSize)
+            {
+               config.m_matrix.ApplyInterleaved(
+                  sourceBuffer.data() + offset * sourceSampleSize * numInputChannels, config.m_sourceType,
+                  targetBuffer.data(), config.m_targetType,
+                  std::min<size_t>(c_blockSize, numSamples - offset));
+            }
+
+            StoreFastestRun(result, NanosecondsSince(startTime));
+         }
+
+         m_results.push_back(result);
+      }
+   }
+
+   Encoder::SampleConverter::SetInstructionSet(previousInstructionSet);
+}
+
+void CodecBenchmark::RunResampling(const CString& outputFolder, SettingsManager& settingsManager)
+{
+   Encoder::SampleConverterInstructionSet previousInstructionSet = Encoder::SampleConverter::GetInstructionSet();
+   Encoder::SampleConverterInstructionSet supportedInstructionSet = Encoder::SampleConverter::GetSupportedInstructionSet();
+
+   for (int instructionSet = Encoder::instructionSetScalar; instructionSet <= supportedInstructionSet; instructionSet++)
+   {
+      Encoder::SampleConverter::SetInstructionSet(static_cast<Encoder::SampleConverterInstructionSet>(instructionSet));
+
+      for (int quality = Encoder::resamplerQualityFast; quality <= Encoder::resamplerQualityBest; quality++)
+      {
+         BenchmarkResult result;
+         result.m_category = _T("resample");
+         result.m_name = _T("Resampler");
+         result.m_configuration.Format(_T("float32 interleaved, %u Hz -> %u Hz, %s, %s"),
+            c_signalSamplerate, c_resampleSamplerate,
+            ResamplerQualityName(static_cast<Encoder::ResamplerQuality>(quality)),
+            InstructionSetName(static_cast<Encoder::SampleConverterInstructionSet>(instructionSet)));
+
+         for (unsigned int iteration = 0; iteration < m_numIterations; iteration++)
+            ResampleSignal(static_cast<Encoder::ResamplerQuality>(quality), result);
+
+         m_results.push_back(result);
+      }
+   }
+
+   Encoder::SampleConverter::SetInstructionSet(previousInstructionSet);
+
+   // Opus encodes at 48 kHz; with quality off, the encoder resamples the signal itself
+   CString moduleName;
+   for (size_t moduleIndex = 0, maxModuleIndex = m_moduleManager.GetOutputModuleCount(); moduleIndex < maxModuleIndex; moduleIndex++)
+   {
+      if (m_moduleManager.GetOutputModuleID(moduleIndex) == ID_OM_OPUS)
+         moduleName = m_moduleManager.GetOutputModuleName(moduleIndex);
+   }
+
+   int previousQuality = settingsManager.QueryValueInt(GeneralResamplerQuality);
+
+   for (int quality = Encoder::resamplerQualityOff; quality <= Encoder::resamplerQualityBest; quality++)
+   {
+      settingsManager.setValue(GeneralResamplerQuality, quality);
+
+      BenchmarkResult result;
+      result.m_category = _T("resample");
+      result.m_name = moduleName;
+      result.m_configuration.Format(_T("int16 interleaved, %u channels, %u Hz, %s"),
+         c_signalChannels, c_signalSamplerate,
+         quality == Encoder::resamplerQualityOff
+         ? _T("encoder resampler")
+         : ResamplerQualityName(static_cast<Encoder::ResamplerQuality>(quality)));
+
+      for (unsigned int iteration = 0; iteration < m_numIterations; iteration++)
+      {
+         if (!EncodeSignal(ID_OM_OPUS, outputFolder, settingsManager, result, true))
+            break;
+      }
+
+      m_results.push_back(result);
+   }
+
+   settingsManager.setValue(GeneralResamplerQuality, previousQuality);
+}
+
+void CodecBenchmark::ResampleSignal(Encoder::ResamplerQuality quality, BenchmarkResult& result)
+{
+   size_t numSamples = m_signal.size() / c_signalChannels;
+
+   // prepare source samples; not measured
+   std::vector<float> sourceBuffer(numSamples * c_signalChannels);
+
+   Encoder::SampleConverter::InterleavedToInterleaved(m_signal.data(), Encoder::SampleTypeInt16,
+      sourceBuffer.data(), Encoder::SampleTypeFloat32, numSamples, c_signalChannels);
+
+   Encoder::Resampler resampler;
+   resampler.Init(c_signalSamplerate, c_resampleSamplerate, c_signalChannels, quality);
+
+   std::vector<float> targetBuffer(
+      std::max(resampler.GetMaxOutputSamples(c_blockSize), resampler.GetMaxFlushSamples()) * c_signalChannels);
+
+   auto startTime = std::chrono::steady_clock::now();
+
+   for (size_t offset = 0; offset < numSamples; offset += c_blockSize)
+   {
+      resampler.Process(sourceBuffer.data() + offset * c_signalChannels,
+         std::min<size_t>(c_blockSize, numSamples - offset),
+         targetBuffer.data());
+   }
+
+   resampler.Flush(targetBuffer.data());
+
+   StoreFastestRun(result, NanosecondsSince(startTime));
+
+   result.m_numChannels = c_signalChannels;
+   result.m_samplerateInHz = c_signalSamplerate;
+   result.m_numSamples = numSamples;
+   result.m_numBytes = sourceBuffer.size() * sizeof(float);
+}
+
+CStringA CodecBenchmark::ResultsJson() const
+{
+   CStringA json;
+   json.Format("{\n  \"version\": %s,\n  \"iterations\": %u,\n  \"instructionSet\": %s,\n  \"results\": [",
+      JsonString(App::Version()).GetString(),
+      m_numIterations,
+      JsonString(InstructionSetName(Encoder::SampleConverter::GetSupportedInstructionSet())).GetString());
+
+   for (size_t resultIndex = 0; resultIndex < m_results.size(); resultIndex++)
+   {
+      const BenchmarkResult& result = m_results[resultIndex];
+
+      json.AppendFormat("%s\n    {\"category\": %s, \"name\": %s, \"configuration\": %s",
+         resultIndex == 0 ? "" : ",",
+         JsonString(result.m_category).GetString(),
+         JsonString(result.m_name).GetString(),
+         JsonString(result.m_configuration).GetString());
+
+      if (!result.m_errorText.IsEmpty())
+      {
+         json.AppendFormat(", \"error\": %s}", JsonString(result.m_errorText).GetString());
+         continue;
+      }
+
+      json.AppendFormat(", \"channels\": %u, \"samplerate\": %u, \"samples\": %llu, \"bytes\": %llu, \"outputBytes\": %llu, "
+         "\"seconds\": %.6f, \"megabytesPerSecond\": %.3f, \"samplesPerSecond\": %.0f, \"realtimeFactor\": %.2f}",
+         result.m_numChannels,
+         result.m_samplerateInHz,
+         result.m_numSamples,
+         result.m_numBytes,
+         result.m_numOutputBytes,
+         result.m_nanoseconds / 1e9,
+         result.MegabytesPerSecond(),
+         result.SamplesPerSecond(),
+         result.RealtimeFactor());
+   }
+
+   json += "\n  ]\n}\n";
+
+   return json;
+}
+
+Encoder::ChannelMatrix CodecBenchmark::CreateStereoDownmixMatrix(size_t numInputChannels)
+{
+   // even channels go to the left, odd channels to the right, and all are mixed
+   // into the other side with half the level
+   Encoder::ChannelMatrix matrix(numInputChannels, 2);
+
+   float scale = 1.0f / (numInputChannels * 0.75f);
+   for (size_t inputChannel = 0; inputChannel < numInputChannels; inputChannel++)
+   {
+      matrix.SetCoefficient(inputChannel % 2, inputChannel, scale);
+      matrix.SetCoefficient(1 - inputChannel % 2, inputChannel, 0.5f * scale);
+   }
+
+   return matrix;
+}
+
+bool CodecBenchmark::IsFilterMatching(const CString& filterString, const CString& filename)
+{
+   int pos = filename.ReverseFind(_T('.'));
+   if (pos == -1)
+      return false;
+
+   CString extension = filename.Mid(pos);
+   extension.MakeLower();
+
+   // filter strings consist of pairs of description and wildcard patterns, e.g.
+   // "Wave Files (*.wav)|*.wav;*.aiff|"; only the patterns are searched
+   int index = 0;
+   for (int partIndex = 0; index != -1; partIndex++)
+   {
+      CString pattern = filterString.Tokenize(_T("|"), index);
+      if (index == -1 || partIndex % 2 == 0)
+         continue;
+
+      pattern.MakeLower();
+
+      int patternIndex = 0;
+      for (CString wildcard = pattern.Tokenize(_T(";"), patternIndex); patternIndex != -1; wildcard = pattern.Tokenize(_T(";"), patternIndex))
+      {
+         if (wildcard.Trim() == _T("*") + extension)
+            return true;
+      }
+   }
+
+   return false;
+}
+
+CString CodecBenchmark::FormatName(Encoder::SampleType sampleType, Encoder::SampleFormatType format)
+{
+   static const LPCTSTR c_sampleTypeNames[Encoder::SampleTypeMax] =
+   {
+      _T("int8"), _T("int16"), _T("int24"), _T("int32"), _T("float32")
+   };
+
+   CString name;
+   name.Format(_T("%s %s"),
+      c_sampleTypeNames[sampleType],
+      format == Encoder::SamplesInterleaved ? _T("interleaved") : _T("array"));
+
+   return name;
+}
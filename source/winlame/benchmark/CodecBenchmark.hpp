@@ -0,0 +1,155 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file CodecBenchmark.hpp
+/// \brief codec throughput benchmark
+//
+#pragma once
+
+#include "SettingsManager.hpp"
+#include "SampleContainer.hpp"
+#include "ChannelMatrix.hpp"
+#include <vector>
+
+namespace Encoder
+{
+   class ModuleManagerImpl;
+}
+
+namespace Benchmark
+{
+   /// result of a single benchmark configuration
+   struct BenchmarkResult
+   {
+      /// benchmark category: decode, encode, convert, remap or resample
+      CString m_category;
+
+      /// name of the module or function that was measured
+      CString m_name;
+
+      /// configuration, e.g. input filename or sample formats
+      CString m_configuration;
+
+      /// number of channels
+      unsigned int m_numChannels = 0;
+
+      /// sample rate, in Hz
+      unsigned int m_samplerateInHz = 0;
+
+      /// number of samples processed, per channel
+      unsigned long long m_numSamples = 0;
+
+      /// number of bytes processed; input file size for decoding, PCM data size otherwise
+      unsigned long long m_numBytes = 0;
+
+      /// number of bytes produced; output file size for encoding, 0 otherwise
+      unsigned long long m_numOutputBytes = 0;
+
+      /// fastest time of all iterations, in nanoseconds
+      unsigned long long m_nanoseconds = 0;
+
+      /// error text; empty when the benchmark ran successfully
+      CString m_errorText;
+
+      /// returns the number of processed megabytes per second
+      double MegabytesPerSecond() const;
+
+      /// returns the number of processed samples per second, per channel
+      double SamplesPerSecond() const;
+
+      /// returns how many times faster than realtime the audio was processed
+      double RealtimeFactor() const;
+   };
+
+   /// \brief measures decoding, encoding and sample processing throughput
+   /// \details Each configuration is run a number of times, and the fastest run is
+   /// reported, so that the results can be compared between builds. Decoders run
+   /// decode-only on all files of a corpus folder that they can read. Encoders are
+   /// fed from an in-memory PCM signal, so that decoding doesn't show up in the
+   /// results; their output is written to a temporary folder and deleted afterwards.
+   class CodecBenchmark
+   {
+   public:
+      /// ctor
+      CodecBenchmark(Encoder::ModuleManagerImpl& moduleManager, unsigned int numIterations,
+         unsigned int lengthInSeconds);
+
+      /// runs all input modules on all corpus files they support
+      void RunDecoders(const CString& corpusFolder);
+
+      /// runs all output modules with the PCM signal
+      void RunEncoders(const CString& outputFolder, SettingsManager& settingsManager);
+
+      /// runs sample container conversions between sample formats, for all instruction sets
+      void RunSampleConversions();
+
+      /// runs channel remapping and downmixing, for all instruction sets
+      void RunChannelRemapping();
+
+      /// \brief runs the resampler for all qualities and instruction sets, and compares
+      /// Opus encoding with the sample container resampler against the encoder's own one
+      void RunResampling(const CString& outputFolder, SettingsManager& settingsManager);
+
+      /// returns all results
+      const std::vector<BenchmarkResult>& GetResults() const { return m_results; }
+
+      /// formats all results as JSON document
+      CStringA ResultsJson() const;
+
+   private:
+      /// decodes a file with an input module once; returns false on errors
+      bool DecodeFile(Encoder::InputModule& inputModulePrototype, const CString& filename,
+         BenchmarkResult& result);
+
+      /// encodes the PCM signal with an output module once; returns false on errors
+      bool EncodeSignal(int outputModuleID, const CString& outputFolder,
+         SettingsManager& settingsManager, BenchmarkResult& result,
+         bool includeConversion = false);
+
+      /// converts the PCM signal from source to target format with a sample container once
+      void ConvertSamples(Encoder::SampleType sourceType, Encoder::SampleFormatType sourceFormat,
+         Encoder::SampleType targetType, Encoder::SampleFormatType targetFormat,
+         BenchmarkResult& result);
+
+      /// converts the PCM signal to the Opus coding rate with a resampler once
+      void ResampleSignal(Encoder::ResamplerQuality quality, BenchmarkResult& result);
+
+      /// creates a matrix that mixes all channels to stereo
+      static Encoder::ChannelMatrix CreateStereoDownmixMatrix(size_t numInputChannels);
+
+      /// returns if the filename has an extension that is listed in the filter string
+      static bool IsFilterMatching(const CString& filterString, const CString& filename);
+
+      /// returns the name of a sample type and format, e.g. "int16 interleaved"
+      static CString FormatName(Encoder::SampleType sampleType, Encoder::SampleFormatType format);
+
+   private:
+      /// module manager
+      Encoder::ModuleManagerImpl& m_moduleManager;
+
+      /// number of times each configuration is run
+      unsigned int m_numIterations;
+
+      /// 16 bit interleaved stereo PCM signal
+      std::vector<short> m_signal;
+
+      /// all results
+      std::vector<BenchmarkResult> m_results;
+   };
+
+} // namespace Benchmark
@@ -0,0 +1,246 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file winlamebench.cpp
+/// \brief contains the main function of the codec throughput benchmark
+//
+#include "stdafx.h"
+#include "CodecBenchmark.hpp"
+#include "ModuleManagerImpl.hpp"
+#include "LameNogapInstanceManager.hpp"
+#include <ulib/CommandLineParser.hpp>
+#include <cstdio>
+#include <set>
+
+/// command line options for the benchmark
+struct BenchmarkOptions
+{
+   /// folder with audio files to decode; when empty, decoders aren't run
+   CString m_corpusFolder;
+
+   /// file to write JSON results to; when empty, results are written to stdout
+   CString m_outputFilename;
+
+   /// folder to store encoded files temporarily
+   CString m_tempFolder = Path::Combine(Path::TempFolder(), _T("winlamebench"));
+
+   /// number of times each configuration is run
+   unsigned int m_numIterations = 3;
+
+   /// length of the PCM signal, in seconds
+   unsigned int m_lengthInSeconds = 30;
+
+   /// categories to run; when empty, all categories are run
+   std::set<CString> m_categories;
+
+   /// indicates if the usage text should be shown
+   bool m_showHelp = false;
+
+   /// returns if a benchmark category should be run
+   bool IsCategoryEnabled(LPCTSTR category) const
+   {
+      return m_categories.empty() || m_categories.find(category) != m_categories.end();
+   }
+};
+
+/// usage text
+static LPCTSTR c_usageText =
+   _T("Usage: winlamebench [options] [corpus folder]\n")
+   _T("Options:\n")
+   _T("  -i, --iterations <number>  runs of each configuration; the fastest run is reported\n")
+   _T("  -l, --length <seconds>     length of the PCM signal used for encoding and conversion\n")
+   _T("  -c, --category <name>      runs only this category; decode, encode, convert, remap or resample\n")
+   _T("  -o, --output <file>        writes JSON results to file instead of stdout\n")
+   _T("  -t, --temp-folder <folder> folder for temporary encoded files\n")
+   _T("  -h, --help                 shows this help\n")
+   _T("Decoders run on all files in the corpus folder, e.g. source\\winlame\\unittest\\res\n");
+
+/// parses command line; returns false and sets error text when the command line is invalid
+static bool ParseOptions(LPCTSTR commandLine, BenchmarkOptions& options, CString& errorText)
+{
+   CommandLineParser parser(commandLine);
+
+   // skip first string; it's the program's name
+   CString param;
+   parser.GetNext(param);
+
+   while (parser.GetNext(param))
+   {
+      if (param == _T("-h") || param == _T("--help") || param == _T("/?"))
+      {
+         options.m_showHelp = true;
+         continue;
+      }
+
+      if (param.GetLength() > 1 && param[0] == _T('-'))
+      {
+         // all other options have a value
+         CString value;
+         if (!parser.GetNext(value))
+         {
+            errorText.Format(_T("missing value for option %s"), param.GetString());
+            return false;
+         }
+
+         if (param == _T("-i") || param == _T("--iterations"))
+            options.m_numIterations = static_cast<unsigned int>(std::max(_ttoi(value), 1));
+         else if (param == _T("-l") || param == _T("--length"))
+            options.m_lengthInSeconds = static_cast<unsigned int>(std::max(_ttoi(value), 1));
+         else if (param == _T("-c") || param == _T("--category"))
+         {
+            if (value != _T("decode") && value != _T("encode") && value != _T("convert") && value != _T("remap") &&
+               value != _T("resample"))
+            {
+               errorText.Format(_T("unknown category: %s"), value.GetString());
+               return false;
+            }
+
+            options.m_categories.insert(value);
+         }
+         else if (param == _T("-o") || param == _T("--output"))
+            options.m_outputFilename = value;
+         else if (param == _T("-t") || param == _T("--temp-folder"))
+            options.m_tempFolder = value;
+         else
+         {
+            errorText.Format(_T("unknown option: %s"), param.GetString());
+            return false;
+         }
+
+         continue;
+      }
+
+      if (!options.m_corpusFolder.IsEmpty())
+      {
+         errorText = _T("only one corpus folder can be specified");
+         return false;
+      }
+
+      options.m_corpusFolder = param;
+   }
+
+   return true;
+}
+
+/// runs all benchmarks with given options; returns the exit code
+static int RunBenchmark(const BenchmarkOptions& options)
+{
+   // register objects in IoC container
+   IoCContainer& ioc = IoCContainer::Current();
+
+   Encoder::LameNogapInstanceManager lameNogapInstanceManager;
+   ioc.Register<Encoder::LameNogapInstanceManager>(std::ref(lameNogapInstanceManager));
+
+   Encoder::ModuleManagerImpl moduleManager;
+   ioc.Register<Encoder::ModuleManager>(std::ref(moduleManager));
+
+   Benchmark::CodecBenchmark benchmark(moduleManager, options.m_numIterations, options.m_lengthInSeconds);
+
+   if (options.IsCategoryEnabled(_T("decode")))
+   {
+      if (options.m_corpusFolder.IsEmpty())
+         _fputts(_T("no corpus folder specified; decoders are skipped\n"), stderr);
+      else
+         benchmark.RunDecoders(options.m_corpusFolder);
+   }
+
+   if (options.IsCategoryEnabled(_T("encode")))
+   {
+      if (!Path::FolderExists(options.m_tempFolder))
+         Path::CreateDirectoryRecursive(options.m_tempFolder);
+
+      // default settings for all output modules
+      SettingsManager settingsManager;
+      benchmark.RunEncoders(options.m_tempFolder, settingsManager);
+   }
+
+   if (options.IsCategoryEnabled(_T("convert")))
+      benchmark.RunSampleConversions();
+
+   if (options.IsCategoryEnabled(_T("remap")))
+      benchmark.RunChannelRemapping();
+
+   if (options.IsCategoryEnabled(_T("resample")))
+   {
+      if (!Path::FolderExists(options.m_tempFolder))
+         Path::CreateDirectoryRecursive(options.m_tempFolder);
+
+      SettingsManager settingsManager;
+      benchmark.RunResampling(options.m_tempFolder, settingsManager);
+   }
+
+   CStringA json = benchmark.ResultsJson();
+
+   FILE* fd = options.m_outputFilename.IsEmpty() ? stdout : _tfopen(options.m_outputFilename, _T("wb"));
+   if (fd == nullptr)
+   {
+      _ftprintf(stderr, _T("couldn't open output file: %s\n"), options.m_outputFilename.GetString());
+      return 1;
+   }
+
+   fputs(json, fd);
+
+   if (fd != stdout)
+      fclose(fd);
+
+   return 0;
+}
+
+/// main function
+int _tmain(int /*argc*/, TCHAR* /*argv*/[])
+{
+   // remove current directory from search path of LoadLibrary(); see App::App()
+   BOOL ret = SetDllDirectory(_T(""));
+   ATLASSERT(ret == TRUE);
+   UNUSED(ret);
+
+   BenchmarkOptions options;
+
+   CString errorText;
+   if (!ParseOptions(::GetCommandLine(), options, errorText))
+   {
+      _ftprintf(stderr, _T("%s\n%s"), errorText.GetString(), c_usageText);
+      return 2;
+   }
+
+   if (options.m_showHelp)
+   {
+      _fputts(c_usageText, stdout);
+      return 0;
+   }
+
+   HRESULT hr = ::CoInitialize(NULL);
+   ATLASSERT(SUCCEEDED(hr));
+   UNUSED(hr);
+
+   int exitCode = 0;
+   try
+   {
+      exitCode = RunBenchmark(options);
+   }
+   /// NOSONAR
+   catch (...)
+   {
+      _fputts(_T("exception while running benchmark\n"), stderr);
+      exitCode = 1;
+   }
+
+   ::CoUninitialize();
+
+   return exitCode;
+}
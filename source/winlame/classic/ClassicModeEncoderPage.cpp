@@ -138,8 +138,6 @@ BOOL ClassicModeEncoderPage::OnIdle()
    m_toolbar.EnableButton(ID_TASKS_STOP_ALL, m_taskManager.AreRunningTasksAvail());
    m_toolbar.EnableButton(ID_TASKS_REMOVE_COMPLETED, m_taskManager.AreCompletedTasksAvail());
 
-   m_taskManager.CheckRunnableTasks();
-
    UpdateWin7TaskBar();
 
    CheckAllTasksFinished();
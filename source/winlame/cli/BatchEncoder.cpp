@@ -0,0 +1,322 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file BatchEncoder.cpp
+/// \brief encodes files without user interface and reports progress as NDJSON
+//
+#include "stdafx.h"
+#include "BatchEncoder.hpp"
+#include "TaskManager.hpp"
+#include "InputFilesParser.hpp"
+#include "EncoderTask.hpp"
+#include "ModuleManagerImpl.hpp"
+#include "VariableManager.hpp"
+#include "TranscodeCache.hpp"
+#include "JsonString.hpp"
+#include <chrono>
+#include <cstdio>
+
+using Cli::BatchEncoder;
+using Encoder::JsonString;
+
+/// interval in which progress of running tasks is reported; completion is reported immediately
+const std::chrono::milliseconds c_progressInterval(250);
+
+BatchEncoder::BatchEncoder(const BatchEncoderOptions& options, TaskManager& taskManager,
+   std::shared_ptr<Encoder::TranscodeCache> transcodeCache,
+   std::shared_ptr<Encoder::DirectoryMirror> directoryMirror)
+   :m_options(options),
+   m_taskManager(taskManager),
+   m_transcodeCache(transcodeCache),
+   m_directoryMirror(directoryMirror),
+   m_taskChangesConsumerId(taskManager.RegisterTaskChangesConsumer())
+{
+}
+
+BatchEncoder::~BatchEncoder()
+{
+   m_taskManager.UnregisterTaskChangesConsumer(m_taskChangesConsumerId);
+}
+
+size_t BatchEncoder::AddTasks()
+{
+   if (m_directoryMirror != nullptr)
+   {
+      AddMirrorTasks();
+      return m_mapTaskFilenames.size();
+   }
+
+   // tasks are added while the folders are still scanned, so that encoding starts early
+   InputFilesParser parser;
+   parser.Parse(m_options.m_inputFilenames, [&](const CString& inputFilename)
+   {
+      CString outputFolder = m_options.m_outputFolder.IsEmpty()
+         ? Path::FolderName(inputFilename)
+         : m_options.m_outputFolder;
+
+      AddEncoderTask(inputFilename, outputFolder, m_options.m_overwriteExisting);
+   });
+
+   return m_mapTaskFilenames.size();
+}
+
+void BatchEncoder::AddMirrorTasks()
+{
+   // the output files are encoded again when the settings change
+   SettingsManager settingsManager = m_options.m_settingsManager;
+   unsigned long long settingsHash = Encoder::TranscodeCache::HashSettings(m_options.m_outputModuleID, settingsManager);
+
+   std::vector<CString> deletedOutputFilenames;
+   std::vector<Encoder::DirectoryMirror::SourceFile> sourceFiles =
+      m_directoryMirror->Scan(settingsHash, deletedOutputFilenames);
+
+   for (const CString& outputFilename : deletedOutputFilenames)
+      WriteLine("{\"event\":\"deleted\",\"output\":" + JsonString(outputFilename) + "}");
+
+   for (const Encoder::DirectoryMirror::SourceFile& sourceFile : sourceFiles)
+   {
+      // output files of changed input files are always replaced; skipped files are
+      // stored as well, so that they are only checked again when they change
+      unsigned int taskId = AddEncoderTask(sourceFile.m_inputFilename, sourceFile.m_outputFolder, true);
+      if (taskId == 0)
+         m_directoryMirror->SetEncoded(sourceFile, CString());
+      else
+         m_mapMirrorSourceFiles[taskId] = sourceFile;
+   }
+}
+
+unsigned int BatchEncoder::AddEncoderTask(const CString& inputFilename, const CString& outputFolder, bool overwriteExisting)
+{
+   Encoder::ModuleManager& moduleManager = IoCContainer::Current().Resolve<Encoder::ModuleManager>();
+   Encoder::ModuleManagerImpl& modImpl = reinterpret_cast<Encoder::ModuleManagerImpl&>(moduleManager);
+
+   // skip files that no input module can read, e.g. cover images in album folders
+   std::unique_ptr<Encoder::InputModule> inputModule(modImpl.ChooseInputModule(inputFilename));
+   if (inputModule == nullptr)
+   {
+      WriteLine("{\"event\":\"skipped\",\"input\":" + JsonString(inputFilename) + "}");
+      return 0;
+   }
+
+   Encoder::EncoderTaskSettings taskSettings;
+
+   taskSettings.m_inputFilename = inputFilename;
+   taskSettings.m_outputFolder = outputFolder;
+
+   taskSettings.m_title = Path::FilenameAndExt(inputFilename);
+   taskSettings.m_outputModuleID = m_options.m_outputModuleID;
+   taskSettings.m_settingsManager = m_options.m_settingsManager;
+   taskSettings.m_overwriteExisting = overwriteExisting;
+   taskSettings.m_pipelinedEncoding = m_options.m_pipelinedEncoding;
+   taskSettings.m_workerPool = &m_taskManager;
+   taskSettings.m_transcodeCache = m_transcodeCache;
+
+   std::shared_ptr<Encoder::EncoderTask> spTask(new Encoder::EncoderTask(0, taskSettings));
+
+   m_taskManager.AddTask(spTask);
+
+   CString outputFilename = spTask->GenerateOutputFilename(Path::FilenameOnly(inputFilename));
+
+   m_mapTaskFilenames[spTask->Id()] = std::make_pair(inputFilename, outputFilename);
+
+   return spTask->Id();
+}
+
+Cli::ExitCode BatchEncoder::Run(const std::atomic<bool>& stopRequested)
+{
+   auto startTime = std::chrono::steady_clock::now();
+
+   bool stopped = false;
+   for (;;)
+   {
+      if (stopRequested && !stopped)
+      {
+         m_taskManager.StopAll();
+         stopped = true;
+      }
+
+      // check before getting the changes, so that the last changes contain all final states
+      bool running = m_taskManager.AreRunningTasksAvail();
+
+      std::vector<TaskInfo> changedTaskInfos;
+      std::vector<unsigned int> removedTaskIds;
+      m_taskChangesVersion = m_taskManager.GetTaskChanges(m_taskChangesConsumerId, m_taskChangesVersion,
+         changedTaskInfos, removedTaskIds);
+
+      WriteTaskChanges(changedTaskInfos);
+
+      if (!running)
+         break;
+
+      m_taskManager.WaitAllCompleted(c_progressInterval);
+   }
+
+   std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+   size_t numCompleted = 0;
+   size_t numErrors = 0;
+   for (const auto& iter : m_mapReportedTaskState)
+   {
+      if (iter.second.first == TaskInfo::statusCompleted)
+         numCompleted++;
+      else if (iter.second.first == TaskInfo::statusError)
+         numErrors++;
+   }
+
+   CStringA line;
+   line.Format("{\"event\":\"summary\",\"tasks\":%zu,\"completed\":%zu,\"errors\":%zu,\"stopped\":%s,\"elapsedSeconds\":%.1f,\"statistics\":%s}",
+      m_mapTaskFilenames.size(), numCompleted, numErrors, stopped ? "true" : "false", elapsed.count(),
+      StatisticsJson(m_taskManager.GetStatistics()).GetString());
+
+   WriteLine(line);
+
+   return
+      stopped ? exitStopped :
+      numErrors > 0 ? exitTaskErrors :
+      exitSuccess;
+}
+
+void BatchEncoder::WriteTaskChanges(const std::vector<TaskInfo>& taskInfos)
+{
+   for (const TaskInfo& info : taskInfos)
+   {
+      auto state = std::make_pair(info.Status(), info.Progress());
+
+      auto iter = m_mapReportedTaskState.find(info.Id());
+      if (iter != m_mapReportedTaskState.end() && iter->second == state)
+         continue;
+
+      m_mapReportedTaskState[info.Id()] = state;
+
+      const std::pair<CString, CString>& filenames = m_mapTaskFilenames[info.Id()];
+
+      CStringA line;
+      line.Format("{\"event\":\"task\",\"id\":%u,\"input\":%s,\"output\":%s,\"status\":\"%s\",\"progress\":%u",
+         info.Id(),
+         JsonString(filenames.first).GetString(),
+         JsonString(filenames.second).GetString(),
+         StatusName(info.Status()),
+         info.Progress());
+
+      // the task manager appends the error text to the description of failed tasks
+      if (info.Status() == TaskInfo::statusError)
+         line += ",\"error\":" + JsonString(info.Description());
+
+      if (info.Status() == TaskInfo::statusCompleted ||
+         info.Status() == TaskInfo::statusError)
+         line += ",\"statistics\":" + StatisticsJson(info.Statistics());
+
+      // failed files stay out of the index, so that the next run tries them again
+      if (info.Status() == TaskInfo::statusCompleted &&
+         m_directoryMirror != nullptr)
+      {
+         auto iterSourceFile = m_mapMirrorSourceFiles.find(info.Id());
+         if (iterSourceFile != m_mapMirrorSourceFiles.end())
+            m_directoryMirror->SetEncoded(iterSourceFile->second, filenames.second);
+      }
+
+      line += "}";
+
+      WriteLine(line);
+   }
+}
+
+void BatchEncoder::ListModules()
+{
+   Encoder::ModuleManager& moduleManager = IoCContainer::Current().Resolve<Encoder::ModuleManager>();
+
+   VarMgrFacilitiesToModules facilitiesToModules;
+   for (size_t index = 0, maxIndex = moduleManager.GetOutputModuleCount(); index < maxIndex; index++)
+   {
+      int moduleID = moduleManager.GetOutputModuleID(index);
+
+      CStringA line;
+      line.Format("{\"event\":\"module\",\"id\":%i,\"name\":%s,\"facility\":%s}",
+         moduleID,
+         JsonString(moduleManager.GetOutputModuleName(index)).GetString(),
+         JsonString(facilitiesToModules.lookupName(moduleID)).GetString());
+
+      WriteLine(line);
+   }
+
+   VarMgrVariables variables;
+   for (int variableID = VarFirst + 1; variableID < VarLast; variableID++)
+   {
+      CString name = variables.lookupName(variableID);
+      if (name.IsEmpty())
+         continue; // internal variable without name
+
+      CStringA line;
+      line.Format("{\"event\":\"setting\",\"name\":%s,\"description\":%s,\"default\":%i}",
+         JsonString(name).GetString(),
+         JsonString(variables.lookupDescription(variableID)).GetString(),
+         variables.lookupDefaultValue(variableID));
+
+      WriteLine(line);
+   }
+}
+
+void BatchEncoder::WriteError(const CString& errorText)
+{
+   WriteLine("{\"event\":\"error\",\"message\":" + JsonString(errorText) + "}");
+}
+
+CStringA BatchEncoder::StatisticsJson(const Encoder::EncoderStatistics& statistics)
+{
+   CStringA json;
+   json.Format("{\"initSeconds\":%.3f,\"decodeSeconds\":%.3f,\"convertSeconds\":%.3f,\"encodeSeconds\":%.3f,"
+      "\"finishSeconds\":%.3f,\"totalSeconds\":%.3f,\"samples\":%llu,\"audioSeconds\":%.3f,"
+      "\"bytesIn\":%llu,\"bytesOut\":%llu,\"filesFromCache\":%llu,\"realtimeFactor\":%.2f}",
+      statistics.Seconds(Encoder::counterInitNanoseconds),
+      statistics.Seconds(Encoder::counterDecodeNanoseconds),
+      statistics.Seconds(Encoder::counterConvertNanoseconds),
+      statistics.Seconds(Encoder::counterEncodeNanoseconds),
+      statistics.Seconds(Encoder::counterFinishNanoseconds),
+      statistics.Seconds(Encoder::counterTotalNanoseconds),
+      statistics.Get(Encoder::counterSamples),
+      statistics.AudioSeconds(),
+      statistics.Get(Encoder::counterBytesIn),
+      statistics.Get(Encoder::counterBytesOut),
+      statistics.Get(Encoder::counterFilesFromCache),
+      statistics.RealtimeFactor());
+
+   return json;
+}
+
+void BatchEncoder::WriteLine(const CStringA& line)
+{
+   fputs(line, stdout);
+   fputc('\n', stdout);
+
+   // flush each line, so that scripts reading from a pipe see the progress immediately
+   fflush(stdout);
+}
+
+LPCSTR BatchEncoder::StatusName(TaskInfo::TaskStatus status)
+{
+   switch (status)
+   {
+   case TaskInfo::statusWaiting: return "waiting";
+   case TaskInfo::statusRunning: return "running";
+   case TaskInfo::statusCompleted: return "completed";
+   case TaskInfo::statusError: return "error";
+   default:
+      ATLASSERT(false);
+      return "unknown";
+   }
+}
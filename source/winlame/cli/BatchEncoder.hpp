@@ -0,0 +1,128 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file BatchEncoder.hpp
+/// \brief encodes files without user interface and reports progress as NDJSON
+//
+#pragma once
+
+#include "BatchEncoderOptions.hpp"
+#include "TaskInfo.hpp"
+#include "DirectoryMirror.hpp"
+#include <atomic>
+#include <map>
+
+class TaskManager;
+
+namespace Encoder
+{
+   class TranscodeCache;
+}
+
+namespace Cli
+{
+   /// exit codes of the command line batch encoder
+   enum ExitCode
+   {
+      exitSuccess = 0,     ///< all files were encoded
+      exitTaskErrors = 1,  ///< one or more files couldn't be encoded
+      exitUsageError = 2,  ///< the command line is invalid
+      exitNoInputFiles = 3,///< no input files were found
+      exitStopped = 4,     ///< encoding was stopped by the user
+   };
+
+   /// \brief encodes all input files using the task manager and writes progress to stdout
+   /// \details Each line written is a JSON object (newline delimited JSON). A line with
+   /// "event":"task" is written whenever the status or progress of a task changes, and a
+   /// line with "event":"summary" is written when all tasks are finished. Finished tasks
+   /// and the summary contain the per-stage timing and throughput counters.
+   class BatchEncoder
+   {
+   public:
+      /// ctor; the transcode cache and the directory mirror may be nullptr
+      BatchEncoder(const BatchEncoderOptions& options, TaskManager& taskManager,
+         std::shared_ptr<Encoder::TranscodeCache> transcodeCache,
+         std::shared_ptr<Encoder::DirectoryMirror> directoryMirror);
+
+      /// dtor
+      ~BatchEncoder();
+
+      /// \brief adds an encoder task for every input file; returns the number of tasks added
+      /// \details when mirroring, tasks are only added for added or changed input files
+      size_t AddTasks();
+
+      /// waits for all tasks to finish, writing progress; stops all tasks when
+      /// stopRequested is set; returns the exit code
+      ExitCode Run(const std::atomic<bool>& stopRequested);
+
+      /// writes all output modules and settings names as NDJSON
+      static void ListModules();
+
+      /// writes an error message as NDJSON
+      static void WriteError(const CString& errorText);
+
+   private:
+      /// adds encoder tasks for the input files that changed since the last mirror run
+      void AddMirrorTasks();
+
+      /// adds an encoder task for an input file, when an input module can read it;
+      /// returns the task id, or 0 when the file is skipped
+      unsigned int AddEncoderTask(const CString& inputFilename, const CString& outputFolder, bool overwriteExisting);
+
+      /// writes a line for every task whose status or progress has changed
+      void WriteTaskChanges(const std::vector<TaskInfo>& taskInfos);
+
+      /// formats timing and throughput counters as JSON object
+      static CStringA StatisticsJson(const Encoder::EncoderStatistics& statistics);
+
+      /// writes a single line to stdout and flushes it
+      static void WriteLine(const CStringA& line);
+
+      /// returns status name used in the output
+      static LPCSTR StatusName(TaskInfo::TaskStatus status);
+
+   private:
+      /// batch encoder options
+      const BatchEncoderOptions& m_options;
+
+      /// task manager running the tasks
+      TaskManager& m_taskManager;
+
+      /// transcode cache used by all tasks; may be nullptr
+      std::shared_ptr<Encoder::TranscodeCache> m_transcodeCache;
+
+      /// directory mirror when mirroring the input folder; may be nullptr
+      std::shared_ptr<Encoder::DirectoryMirror> m_directoryMirror;
+
+      /// input and output filenames for all task IDs
+      std::map<unsigned int, std::pair<CString, CString>> m_mapTaskFilenames;
+
+      /// scanned source files for all task IDs when mirroring the input folder
+      std::map<unsigned int, Encoder::DirectoryMirror::SourceFile> m_mapMirrorSourceFiles;
+
+      /// consumer id for getting task changes from the task manager
+      unsigned int m_taskChangesConsumerId;
+
+      /// version of the last task changes got from the task manager
+      unsigned long long m_taskChangesVersion = 0;
+
+      /// last reported status and progress for all task IDs
+      std::map<unsigned int, std::pair<TaskInfo::TaskStatus, unsigned int>> m_mapReportedTaskState;
+   };
+
+} // namespace Cli
@@ -0,0 +1,226 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file BatchEncoderOptions.cpp
+/// \brief command line options for the batch encoder
+//
+#include "stdafx.h"
+#include "BatchEncoderOptions.hpp"
+#include "VariableManager.hpp"
+#include <ulib/CommandLineParser.hpp>
+
+using Cli::BatchEncoderOptions;
+
+BatchEncoderOptions::BatchEncoderOptions()
+   :m_outputModuleID(ID_OM_LAME),
+   m_numThreads(0),
+   m_overwriteExisting(false),
+   m_pipelinedEncoding(true),
+   m_mirror(false),
+   m_showHelp(false),
+   m_listModules(false)
+{
+}
+
+bool BatchEncoderOptions::Parse(LPCTSTR commandLine, CString& errorText)
+{
+   CommandLineParser parser(commandLine);
+
+   // skip first string; it's the program's name
+   CString param;
+   parser.GetNext(param);
+
+   while (parser.GetNext(param))
+   {
+      if (param == _T("-h") || param == _T("--help") || param == _T("/?"))
+      {
+         m_showHelp = true;
+         continue;
+      }
+
+      if (param == _T("--list-modules"))
+      {
+         m_listModules = true;
+         continue;
+      }
+
+      if (param == _T("-y") || param == _T("--overwrite"))
+      {
+         m_overwriteExisting = true;
+         continue;
+      }
+
+      if (param == _T("--no-pipelined"))
+      {
+         m_pipelinedEncoding = false;
+         continue;
+      }
+
+      if (param == _T("--mirror"))
+      {
+         m_mirror = true;
+         continue;
+      }
+
+      if (param.GetLength() > 1 && param[0] == _T('-'))
+      {
+         // all other options have a value
+         CString value;
+         if (!parser.GetNext(value))
+         {
+            errorText.Format(_T("missing value for option %s"), param.GetString());
+            return false;
+         }
+
+         if (param == _T("-o") || param == _T("--output-module"))
+         {
+            m_outputModuleID = ParseOutputModule(value);
+            if (m_outputModuleID == -1)
+            {
+               errorText.Format(_T("unknown output module: %s"), value.GetString());
+               return false;
+            }
+         }
+         else if (param == _T("-d") || param == _T("--output-folder"))
+         {
+            m_outputFolder = value;
+         }
+         else if (param == _T("-s") || param == _T("--set"))
+         {
+            if (!ParseSetting(value, errorText))
+               return false;
+         }
+         else if (param == _T("-j") || param == _T("--threads"))
+         {
+            int numThreads = _ttoi(value);
+            if (numThreads < 0 || (numThreads == 0 && value != _T("0")))
+            {
+               errorText.Format(_T("invalid number of threads: %s"), value.GetString());
+               return false;
+            }
+
+            m_numThreads = static_cast<unsigned int>(numThreads);
+         }
+         else if (param == _T("--cache"))
+         {
+            m_cacheFilename = value;
+         }
+         else
+         {
+            errorText.Format(_T("unknown option: %s"), param.GetString());
+            return false;
+         }
+
+         continue;
+      }
+
+      m_inputFilenames.push_back(param);
+   }
+
+   if (m_mirror && !m_showHelp && !m_listModules)
+   {
+      CString inputFolder = m_inputFilenames.size() == 1 ? m_inputFilenames[0] : CString();
+      inputFolder.TrimRight(_T('\\'));
+
+      if (inputFolder.IsEmpty() || m_outputFolder.IsEmpty())
+      {
+         errorText = _T("--mirror needs exactly one input folder and an output folder");
+         return false;
+      }
+
+      // the output files must not be found as input files of the next run
+      CString outputFolder = m_outputFolder;
+      outputFolder.TrimRight(_T('\\'));
+      outputFolder += _T('\\');
+
+      if (outputFolder.Left(inputFolder.GetLength() + 1).CompareNoCase(inputFolder + _T('\\')) == 0)
+      {
+         errorText = _T("--mirror needs an output folder outside of the input folder");
+         return false;
+      }
+   }
+
+   return true;
+}
+
+CString BatchEncoderOptions::UsageText()
+{
+   return
+      _T("Usage: winlamecli [options] <file or folder>...\n")
+      _T("Options:\n")
+      _T("  -o, --output-module <name|id>  output module; lame, oggvorbis, sndFile, aac, wma, opus\n")
+      _T("  -d, --output-folder <folder>   output folder; default is the folder of each input file\n")
+      _T("  -s, --set <name>=<value>       sets an encoder setting, e.g. lameBitrate=256\n")
+      _T("  -j, --threads <number>         number of files encoded in parallel; 0 uses all CPU cores\n")
+      _T("  -y, --overwrite                overwrites existing output files\n")
+      _T("      --no-pipelined             decodes on the same thread as encoding\n")
+      _T("      --mirror                   mirrors the folder tree of one input folder to the output\n")
+      _T("                                 folder; only added and changed files are encoded, and\n")
+      _T("                                 output files of removed input files are deleted\n")
+      _T("      --cache <index file>       reuses output files of inputs that were already encoded\n")
+      _T("                                 with the same settings; the index file is created when needed\n")
+      _T("      --list-modules             lists output modules and settings names\n")
+      _T("  -h, --help                     shows this help\n")
+      _T("Progress is written to stdout, as one JSON object per line.\n")
+      _T("Exit codes: 0 success, 1 some files failed, 2 invalid command line,\n")
+      _T("3 no input files, 4 stopped by user\n");
+}
+
+int BatchEncoderOptions::ParseOutputModule(const CString& text)
+{
+   VarMgrFacilitiesToModules facilitiesToModules;
+   int moduleID = facilitiesToModules.lookupID(text);
+   if (moduleID != -1)
+      return moduleID;
+
+   int number = _ttoi(text);
+   return number > 0 ? number : -1;
+}
+
+bool BatchEncoderOptions::ParseSetting(const CString& text, CString& errorText)
+{
+   int pos = text.Find(_T('='));
+   if (pos <= 0)
+   {
+      errorText.Format(_T("setting must have the form name=value: %s"), text.GetString());
+      return false;
+   }
+
+   CString name = text.Left(pos);
+   CString value = text.Mid(pos + 1);
+
+   VarMgrVariables variables;
+   int variableID = variables.lookupID(name);
+   if (variableID == -1)
+   {
+      errorText.Format(_T("unknown setting: %s"), name.GetString());
+      return false;
+   }
+
+   LPTSTR end = nullptr;
+   long number = _tcstol(value, &end, 10);
+   if (value.IsEmpty() || end == nullptr || *end != 0)
+   {
+      errorText.Format(_T("setting value must be a number: %s"), text.GetString());
+      return false;
+   }
+
+   m_settingsManager.setValue(static_cast<unsigned short>(variableID), static_cast<int>(number));
+
+   return true;
+}
@@ -0,0 +1,87 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file BatchEncoderOptions.hpp
+/// \brief command line options for the batch encoder
+//
+#pragma once
+
+#include "SettingsManager.hpp"
+#include <vector>
+
+namespace Cli
+{
+   /// \brief options for the command line batch encoder
+   /// \details The options are parsed from a command line like this:
+   /// winlamecli --output-module lame --set lameBitrate=256 --threads 8 C:\Music
+   class BatchEncoderOptions
+   {
+   public:
+      /// ctor; sets default options
+      BatchEncoderOptions();
+
+      /// parses command line; the first parameter must be the program name;
+      /// returns false and sets error text when the command line is invalid
+      bool Parse(LPCTSTR commandLine, CString& errorText);
+
+      /// returns the usage text
+      static CString UsageText();
+
+      /// input files and folders; folders are searched recursively
+      std::vector<CString> m_inputFilenames;
+
+      /// output folder; when empty, output is stored in the folder of the input file
+      CString m_outputFolder;
+
+      /// output module ID
+      int m_outputModuleID;
+
+      /// encoder settings, set with --set name=value
+      SettingsManager m_settingsManager;
+
+      /// number of encoding tasks running in parallel; 0 means one per CPU core
+      unsigned int m_numThreads;
+
+      /// indicates if existing output files can be overwritten
+      bool m_overwriteExisting;
+
+      /// indicates if decoding runs on a separate thread, ahead of encoding
+      bool m_pipelinedEncoding;
+
+      /// indicates if the input folder tree is mirrored to the output folder; only
+      /// added and changed files are encoded, and output files of removed files are deleted
+      bool m_mirror;
+
+      /// filename of the transcode cache index; when empty, no cache is used
+      CString m_cacheFilename;
+
+      /// indicates if the usage text should be shown
+      bool m_showHelp;
+
+      /// indicates if all output modules and settings names should be listed
+      bool m_listModules;
+
+   private:
+      /// parses output module name or ID; returns -1 when the module is unknown
+      static int ParseOutputModule(const CString& text);
+
+      /// parses a name=value setting; returns false when the setting is invalid
+      bool ParseSetting(const CString& text, CString& errorText);
+   };
+
+} // namespace Cli
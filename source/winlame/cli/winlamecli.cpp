@@ -0,0 +1,169 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file winlamecli.cpp
+/// \brief contains the main function of the command line batch encoder
+//
+#include "stdafx.h"
+#include "BatchEncoder.hpp"
+#include "BatchEncoderOptions.hpp"
+#include "TaskManager.hpp"
+#include "ModuleManagerImpl.hpp"
+#include "LameNogapInstanceManager.hpp"
+#include "TranscodeCache.hpp"
+#include "DirectoryMirror.hpp"
+#include <cstdio>
+
+/// set when the user presses Ctrl+C or the console is closed
+static std::atomic<bool> s_stopRequested(false);
+
+/// console control handler; requests stopping all tasks
+static BOOL WINAPI ConsoleCtrlHandler(DWORD /*ctrlType*/)
+{
+   s_stopRequested = true;
+   return TRUE;
+}
+
+/// runs the batch encoder with given options; returns the exit code
+static Cli::ExitCode RunBatchEncoder(const Cli::BatchEncoderOptions& options)
+{
+   // register objects in IoC container
+   IoCContainer& ioc = IoCContainer::Current();
+
+   Encoder::LameNogapInstanceManager lameNogapInstanceManager;
+   ioc.Register<Encoder::LameNogapInstanceManager>(std::ref(lameNogapInstanceManager));
+
+   Encoder::ModuleManagerImpl moduleManager;
+   ioc.Register<Encoder::ModuleManager>(std::ref(moduleManager));
+
+   if (options.m_listModules)
+   {
+      Cli::BatchEncoder::ListModules();
+      return Cli::exitSuccess;
+   }
+
+   std::unique_ptr<Encoder::OutputModule> outputModule(moduleManager.GetOutputModule(options.m_outputModuleID));
+   if (outputModule == nullptr)
+   {
+      CString errorText;
+      errorText.Format(_T("output module %i is not available"), options.m_outputModuleID);
+
+      Cli::BatchEncoder::WriteError(errorText);
+      return Cli::exitUsageError;
+   }
+
+   if (options.m_inputFilenames.empty())
+   {
+      Cli::BatchEncoder::WriteError(_T("no input files or folders were specified"));
+      return Cli::exitUsageError;
+   }
+
+   std::shared_ptr<Encoder::TranscodeCache> transcodeCache;
+   if (!options.m_cacheFilename.IsEmpty())
+   {
+      transcodeCache = std::make_shared<Encoder::TranscodeCache>(options.m_cacheFilename);
+      if (!transcodeCache->Load())
+      {
+         CString errorText;
+         errorText.Format(_T("transcode cache index can't be read: %s"), options.m_cacheFilename.GetString());
+
+         Cli::BatchEncoder::WriteError(errorText);
+         return Cli::exitUsageError;
+      }
+   }
+
+   std::shared_ptr<Encoder::DirectoryMirror> directoryMirror;
+   if (options.m_mirror)
+   {
+      directoryMirror = std::make_shared<Encoder::DirectoryMirror>(options.m_inputFilenames[0], options.m_outputFolder);
+      if (!directoryMirror->Load())
+      {
+         CString errorText;
+         errorText.Format(_T("mirror index can't be read: %s"),
+            Encoder::DirectoryMirror::IndexFilename(options.m_outputFolder).GetString());
+
+         Cli::BatchEncoder::WriteError(errorText);
+         return Cli::exitUsageError;
+      }
+   }
+
+   TaskManagerConfig config;
+   config.m_bAutoTasksPerCpu = options.m_numThreads == 0;
+   config.m_uiUseNumTasks = options.m_numThreads;
+
+   TaskManager taskManager(config);
+   ioc.Register<TaskManager>(std::ref(taskManager));
+
+   Cli::BatchEncoder batchEncoder(options, taskManager, transcodeCache, directoryMirror);
+
+   // a mirror run without changed input files only writes the summary
+   if (batchEncoder.AddTasks() == 0 && directoryMirror == nullptr)
+   {
+      Cli::BatchEncoder::WriteError(_T("no input files were found"));
+      return Cli::exitNoInputFiles;
+   }
+
+   return batchEncoder.Run(s_stopRequested);
+}
+
+/// main function
+int _tmain(int /*argc*/, TCHAR* /*argv*/[])
+{
+   // remove current directory from search path of LoadLibrary(); see App::App()
+   BOOL ret = SetDllDirectory(_T(""));
+   ATLASSERT(ret == TRUE);
+   UNUSED(ret);
+
+   Cli::BatchEncoderOptions options;
+
+   CString errorText;
+   if (!options.Parse(::GetCommandLine(), errorText))
+   {
+      Cli::BatchEncoder::WriteError(errorText);
+      _fputts(Cli::BatchEncoderOptions::UsageText(), stderr);
+      return Cli::exitUsageError;
+   }
+
+   if (options.m_showHelp)
+   {
+      _fputts(Cli::BatchEncoderOptions::UsageText(), stdout);
+      return Cli::exitSuccess;
+   }
+
+   SetConsoleCtrlHandler(&ConsoleCtrlHandler, TRUE);
+
+   HRESULT hr = ::CoInitialize(NULL);
+   ATLASSERT(SUCCEEDED(hr));
+   UNUSED(hr);
+
+   Cli::ExitCode exitCode = Cli::exitSuccess;
+   try
+   {
+      exitCode = RunBatchEncoder(options);
+   }
+   /// NOSONAR
+   catch (...)
+   {
+      Cli::BatchEncoder::WriteError(_T("exception while running batch encoder"));
+      exitCode = Cli::exitTaskErrors;
+   }
+
+   ::CoUninitialize();
+
+   return exitCode;
+}
@@ -22,13 +22,9 @@
 //
 #include "stdafx.h"
 #include "resource.h"
-#include <fstream>
 #include "AacInputModule.hpp"
-#include <sys/types.h>
-#include <sys/stat.h>
 #include <ulib/DynamicLibrary.hpp>
 #include "AudioFileTag.hpp"
-#include "ChannelRemapper.hpp"
 
 using Encoder::AacInputModule;
 using Encoder::TrackInfo;
@@ -36,14 +32,10 @@ using Encoder::SampleContainer;
 
 AacInputModule::AacInputModule()
    :m_decoder(nullptr),
-   m_inputBufferHigh(0),
-   m_inputFileLength(0),
-   m_currentFilePos(0)
+   m_inputFileLength(0)
 {
    m_moduleId = ID_IM_AAC;
 
-   std::uninitialized_fill(std::begin(m_inputBuffer), std::end(m_inputBuffer), (unsigned char)0);
-
    memset(&m_info, 0, sizeof(m_info));
 }
 
@@ -149,8 +141,7 @@ int AacInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    TrackInfo& trackInfo, SampleContainer& samples)
 {
    // open infile
-   m_inputFile.open(infilename, std::ios::in | std::ios::binary);
-   if (!m_inputFile.is_open())
+   if (!m_inputSource.Open(infilename))
    {
       m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
       return -1;
@@ -167,21 +158,15 @@ int AacInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    }
 
    // find out length of aac file
-   struct _stat statbuf;
-   ::_tstat(infilename, &statbuf);
-   m_inputFileLength = statbuf.st_size; // 32 bit max.
-   m_currentFilePos = 0;
+   m_inputFileLength = static_cast<unsigned long>(m_inputSource.Length()); // 32 bit max.
 
-   // search for begin of aac stream, skipping id3v2 tags; modifies m_currentFilePos
+   // search for begin of aac stream, skipping id3v2 tags; modifies input source position
    // ...
 
    // retrieve id3v2 tag
    AudioFileTag tag(trackInfo);
    tag.ReadFromFile(infilename);
 
-   // seek to begin
-   m_inputFile.seekg(m_currentFilePos, std::ios::beg);
-
    // grab decoder instance
    m_decoder = NeAACDecOpen();
 
@@ -194,11 +179,13 @@ int AacInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    }
 
    // read first frame(s) and get infos about the aac file
-   m_inputFile.read(reinterpret_cast<char*>(m_inputBuffer), c_aacInputBufferSize);
+   size_t available = 0;
+   unsigned char* inputData = PeekInput(available);
 
    unsigned long dummy;
    unsigned char dummy2;
-   int result = NeAACDecInit(m_decoder, m_inputBuffer, sizeof(m_inputBuffer), &dummy, &dummy2);
+   int result = inputData == nullptr ? -1 :
+      NeAACDecInit(m_decoder, inputData, static_cast<unsigned long>(available), &dummy, &dummy2);
 
    if (result < 0)
    {
@@ -206,15 +193,19 @@ int AacInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
       return -2;
    }
 
-   m_inputBufferHigh = 0;
-
-   // seek to the next start
-   m_currentFilePos += result;
-   m_inputFile.seekg(m_currentFilePos, std::ios::beg);
+   // skip to the next start
+   m_inputSource.Skip(result);
 
    // get right file info (for HE AAC files)
+   inputData = PeekInput(available);
+   if (inputData == nullptr)
+   {
+      m_lastError.LoadString(IDS_ENCODER_ERROR_INIT_DECODER);
+      return -2;
+   }
+
    NeAACDecFrameInfo frameInfo;
-   NeAACDecDecode(m_decoder, &frameInfo, m_inputBuffer, sizeof(m_inputBuffer));
+   NeAACDecDecode(m_decoder, &frameInfo, inputData, static_cast<unsigned long>(available));
    if (frameInfo.error > 0)
    {
       m_lastError = CString(NeAACDecGetErrorMessage(frameInfo.error));
@@ -254,25 +245,16 @@ int AacInputModule::DecodeSamples(SampleContainer& samples)
    short* outputBuffer;
    short tempBuffer[2048 * c_aacNumMaxChannels];
 
-   // fill input buffer
-   if (m_inputBufferHigh < c_aacInputBufferSize)
-   {
-      m_inputFile.read(reinterpret_cast<char*>(m_inputBuffer + m_inputBufferHigh), std::streamsize(c_aacInputBufferSize) - m_inputBufferHigh);
-      int read = static_cast<int>(m_inputFile.gcount());
-
-      if (read == 0 && m_inputBufferHigh == 0)
-         return 0;
+   // decode directly from the input source
+   size_t available = 0;
+   unsigned char* inputData = PeekInput(available);
 
-      m_inputBufferHigh += read;
-      m_currentFilePos += read;
-   }
+   if (inputData == nullptr)
+      return 0;
 
-   // decode buffer
-   short* sampleBuffer = (short *)NeAACDecDecode(m_decoder, &frameInfo, m_inputBuffer, m_inputBufferHigh);
+   short* sampleBuffer = (short *)NeAACDecDecode(m_decoder, &frameInfo, inputData, static_cast<unsigned long>(available));
 
-   m_inputBufferHigh -= frameInfo.bytesconsumed;
-   memmove(m_inputBuffer, m_inputBuffer + frameInfo.bytesconsumed,
-      c_aacInputBufferSize - frameInfo.bytesconsumed);
+   m_inputSource.Skip(frameInfo.bytesconsumed);
 
    // check for return codes
    if (frameInfo.error > 0)
@@ -286,15 +268,21 @@ int AacInputModule::DecodeSamples(SampleContainer& samples)
    // remap channels
    if (frameInfo.channels > 2)
    {
+      if (m_channelMatrix.GetNumInputChannels() != frameInfo.channels)
+         m_channelMatrix = ChannelMatrix::FromChannelMapType(aacInputChannelMap, frameInfo.channels);
+
       outputBuffer = tempBuffer;
-      ChannelRemapper::RemapInterleaved(T_enChannelMapType::aacInputChannelMap,
-         sampleBuffer, numSamples, frameInfo.channels, outputBuffer);
+      m_channelMatrix.ApplyInterleaved(sampleBuffer, SampleTypeInt16, outputBuffer, SampleTypeInt16, numSamples);
    }
    else
       outputBuffer = sampleBuffer;
 
-   // copy the samples to the sample container
-   samples.PutSamplesInterleaved(outputBuffer, numSamples);
+   // put the samples in the sample container; the decoder's sample buffer stays
+   // valid until the next call to NeAACDecDecode(), so it can be lent without copying
+   if (outputBuffer == sampleBuffer)
+      samples.PutSamplesInterleavedBorrowed(outputBuffer, numSamples);
+   else
+      samples.PutSamplesInterleaved(outputBuffer, numSamples);
 
    return numSamples;
 }
@@ -302,5 +290,15 @@ int AacInputModule::DecodeSamples(SampleContainer& samples)
 void AacInputModule::DoneInput()
 {
    NeAACDecClose(m_decoder);
-   m_inputFile.close();
+   m_inputSource.Close();
+}
+
+unsigned char* AacInputModule::PeekInput(size_t& available)
+{
+   const unsigned char* data = m_inputSource.Peek(c_aacInputBufferSize, available);
+
+   available = std::min<size_t>(available, c_aacInputBufferSize);
+
+   // the decoder only reads from the buffer, but its API takes a non-const pointer
+   return const_cast<unsigned char*>(data);
 }
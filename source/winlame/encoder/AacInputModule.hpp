@@ -23,7 +23,8 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
-#include <iosfwd>
+#include "InputSource.hpp"
+#include "ChannelMatrix.hpp"
 #include "neaacdec.h"
 
 extern "C"
@@ -41,7 +42,7 @@ namespace Encoder
    /// max. numbers of channels the module is able to handle
    const int c_aacNumMaxChannels = 8;
 
-   /// calculated input buffer size
+   /// number of input bytes passed to the decoder at once
    const int c_aacInputBufferSize = c_aacFrameSize * c_aacNumMaxChannels;
 
    /// AAC input module
@@ -85,33 +86,31 @@ namespace Encoder
       // returns the number of percent done
       virtual float PercentDone() const override
       {
-         return m_inputFileLength == 0 ? 0.0f : float(m_currentFilePos) * 100.f / m_inputFileLength;
+         return m_inputFileLength == 0 ? 0.0f : float(m_inputSource.Position()) * 100.f / m_inputFileLength;
       }
 
       // called when done with decoding
       virtual void DoneInput() override;
 
+   private:
+      /// returns input data at the current position, with at most c_aacInputBufferSize bytes
+      unsigned char* PeekInput(size_t& available);
+
    private:
       /// libfaad handle
       faacDecHandle m_decoder;
 
-      /// file input buffer
-      unsigned char m_inputBuffer[c_aacInputBufferSize];
-
-      /// high watermark for the m_inputBuffer
-      int m_inputBufferHigh;
-
       /// length of input file
       unsigned long m_inputFileLength;
 
-      /// current position
-      unsigned long m_currentFilePos;
-
       /// aac file info
       faadAACInfo m_info;
 
-      /// input file stream
-      std::ifstream m_inputFile;
+      /// input source; the decoder reads directly from its buffer
+      InputSource m_inputSource;
+
+      /// matrix to remap channels from AAC to WAV order
+      ChannelMatrix m_channelMatrix;
 
       /// last error occured
       CString m_lastError;
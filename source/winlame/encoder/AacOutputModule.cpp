@@ -21,7 +21,6 @@
 /// \brief contains the implementation of the AAC output module
 //
 #include "stdafx.h"
-#include <fstream>
 #include "resource.h"
 #include "AacOutputModule.hpp"
 #include "neaacdec.h"
@@ -38,7 +37,6 @@ AacOutputModule::AacOutputModule()
    :m_handle(nullptr),
    m_inputBufferSize(0),
    m_outputBufferSize(0),
-   m_sampleBufferHigh(0),
    m_bitrateControlMethod(0)
 {
    m_moduleId = ID_OM_AAC;
@@ -87,10 +85,11 @@ int AacOutputModule::InitOutput(LPCTSTR outfilename,
    SettingsManager& mgr, const TrackInfo& trackInfo,
    SampleContainer& samples)
 {
-   m_outputFile.open(outfilename, std::ios::out | std::ios::binary);
-   if (!m_outputFile.is_open())
+   CString errorText;
+   if (!OpenOutputSink(outfilename, errorText))
    {
       m_lastError.LoadString(IDS_ENCODER_OUTPUT_FILE_CREATE_ERROR);
+      m_lastError.AppendFormat(_T(" (message \"%s\")"), errorText.GetString());
       return -1;
    }
 
@@ -106,9 +105,9 @@ int AacOutputModule::InitOutput(LPCTSTR outfilename,
       return -1;
    }
 
-   // alloc memory for input buffer
-   m_sampleBuffer.resize(m_inputBufferSize);
-   m_sampleBufferHigh = 0;
+   // faacEncEncode() always wants 'm_inputBufferSize' number of samples; otherwise
+   // it pads the frame with 0's
+   m_inputFrameBuffer.Init(m_inputBufferSize);
 
    // alloc memory for output buffer
    m_outputBuffer.resize(m_outputBufferSize);
@@ -163,6 +162,9 @@ int AacOutputModule::InitOutput(LPCTSTR outfilename,
    // set up output traits
    samples.SetOutputModuleTraits(16, SamplesInterleaved);
 
+   // let input modules deliver whole frames, so that they can be encoded without copying
+   samples.SetOutputModuleFrameSize(static_cast<int>(m_inputBufferSize / m_channels));
+
    return 0;
 }
 
@@ -170,77 +172,64 @@ int AacOutputModule::EncodeSamples(SampleContainer& samples)
 {
    // get input samples
    int numInputSamplesPerChannel = 0;
-   short* inputSampleBuffer = (short*)samples.GetSamplesInterleaved(numInputSamplesPerChannel);
-
-   // as faacEncEncode() always wants 'm_inputBufferSize' number of samples, we
-   // have to store samples until a whole block of samples can be passed to
-   // the function; otherwise faacEncEncode() would pad the buffer with 0's.
+   const short* inputSampleBuffer = (const short*)samples.GetSamplesInterleaved(numInputSamplesPerChannel);
 
-   size_t numInputSamples = numInputSamplesPerChannel * m_channels;
-   size_t inputSamplePos = 0;
+   size_t numInputSamples = size_t(numInputSamplesPerChannel) * m_channels;
 
-   //ATLTRACE(_T("AacOutputModule: encoding 0x%04x fresh input samples\n"), numInputSamples);
+   // when the block size is a multiple of the frame size, all frames are
+   // encoded directly from the sample block
+   m_inputFrameBuffer.SetInput(inputSampleBuffer, numInputSamples);
 
-   // fill the sample buffer from the input samples
-   do
+   for (const short* frame = m_inputFrameBuffer.NextFrame(); frame != nullptr; frame = m_inputFrameBuffer.NextFrame())
    {
-      size_t numSamplesToTransfer = std::min((size_t)m_inputBufferSize - m_sampleBufferHigh, numInputSamples - inputSamplePos);
-      if (numSamplesToTransfer > 0)
+      int ret = EncodeFrame(frame, m_inputBufferSize);
+      if (ret < 0)
       {
-         //ATLTRACE(_T("AacOutputModule: copying 0x%04x bytes to sample buffer\n"), numSamplesToTransfer);
-         memcpy(m_sampleBuffer.data() + m_sampleBufferHigh, inputSampleBuffer + inputSamplePos, numSamplesToTransfer * sizeof(short));
-         m_sampleBufferHigh += numSamplesToTransfer;
-         inputSamplePos += numSamplesToTransfer;
+         // consume rest of the input block
+         while (m_inputFrameBuffer.NextFrame() != nullptr)
+            ;
+         return ret;
       }
+   }
 
-      // if the sample buffer is full, encode one frame
-      if (m_inputBufferSize == m_sampleBufferHigh)
-      {
-         // encode the samples
-         int ret = faacEncEncode(m_handle,
-            reinterpret_cast<int*>(m_sampleBuffer.data()),
-            m_inputBufferSize,
-            m_outputBuffer.data(),
-            m_outputBuffer.size());
-
-         //ATLTRACE(_T("AacOutputModule: encoding the samples to %i output bytes\n"), ret);
-
-         if (ret < 0)
-            return ret;
-
-         // write the output buffer
-         if (ret > 0)
-            m_outputFile.write(reinterpret_cast<char*>(m_outputBuffer.data()), ret);
+   return static_cast<int>(numInputSamples);
+}
 
-         m_sampleBufferHigh = 0;
-      }
+int AacOutputModule::EncodeFrame(const short* frame, unsigned int numSamples)
+{
+   // faacEncEncode() only reads from the input buffer
+   int ret = faacEncEncode(m_handle,
+      reinterpret_cast<int*>(const_cast<short*>(frame)),
+      numSamples,
+      m_outputBuffer.data(),
+      m_outputBuffer.size());
 
-      // loop while the input samples are exhausted
-   } while (inputSamplePos < numInputSamples);
+   if (ret < 0)
+      return ret;
 
-   //ATLTRACE(_T("AacOutputModule: finished encoding samples, 0x%04x samples are left in buffer\n"), m_sampleBufferHigh);
+   // write the output buffer
+   if (ret > 0 &&
+      !m_outputSink->Write(m_outputBuffer.data(), ret))
+   {
+      m_lastError = m_outputSink->GetLastError();
+      return -1;
+   }
 
-   return numInputSamples;
+   return ret;
 }
 
 void AacOutputModule::DoneOutput()
 {
-   int ret = 0;
+   if (m_outputSink == nullptr)
+      return; // output wasn't initialized
 
-   // encode the last samples in sample buffer
-   if (m_sampleBufferHigh > 0)
-   {
-      //ATLTRACE(_T("AacOutputModule: encoding remaining 0x%04x samples that were left in buffer\n"), m_sampleBufferHigh);
-
-      ret = faacEncEncode(m_handle,
-         reinterpret_cast<int*>(m_sampleBuffer.data()),
-         m_sampleBufferHigh,
-         m_outputBuffer.data(),
-         m_outputBuffer.size());
+   int ret = 0;
 
-      if (ret > 0)
-         m_outputFile.write(reinterpret_cast<char*>(m_outputBuffer.data()), ret);
-   }
+   // encode the last samples that don't make up a whole frame
+   size_t numRemainingSamples = 0;
+   const short* remainingSamples = m_inputFrameBuffer.RemainingSamples(numRemainingSamples);
+   if (numRemainingSamples > 0)
+      EncodeFrame(remainingSamples, static_cast<unsigned int>(numRemainingSamples));
 
    // finish encoding and write the last aac frames
    while ((ret = faacEncEncode(m_handle,
@@ -249,10 +238,12 @@ void AacOutputModule::DoneOutput()
       m_outputBuffer.data(),
       m_outputBuffer.size())) > 0)
    {
-      m_outputFile.write(reinterpret_cast<char*>(m_outputBuffer.data()), ret);
+      m_outputSink->Write(m_outputBuffer.data(), ret);
    }
 
-   m_outputFile.close();
+   CString errorText;
+   if (!CloseOutputSink(errorText))
+      m_lastError = errorText;
 
    faacEncClose(m_handle);
 }
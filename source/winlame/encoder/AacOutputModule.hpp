@@ -23,8 +23,8 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
-#include <iosfwd>
 #include "faac.h"
+#include "SampleFrameBuffer.hpp"
 
 namespace Encoder
 {
@@ -53,6 +53,9 @@ namespace Encoder
       /// returns the extension the output module produces
       virtual CString GetOutputExtension() const override { return _T("aac"); }
 
+      /// writes through an output sink
+      virtual bool SupportsOutputSink() const override { return true; }
+
       /// initializes the output module
       virtual int InitOutput(LPCTSTR outfilename, SettingsManager& mgr,
          const TrackInfo& trackInfo, SampleContainer& samples) override;
@@ -63,6 +66,11 @@ namespace Encoder
       /// cleans up the output module
       virtual void DoneOutput() override;
 
+   private:
+      /// encodes one frame with given number of samples, for all channels; returns
+      /// number of bytes written, or a negative value on errors
+      int EncodeFrame(const short* frame, unsigned int numSamples);
+
    private:
       /// encoder handle
       faacEncHandle m_handle;
@@ -76,18 +84,12 @@ namespace Encoder
       /// output buffer
       std::vector<unsigned char> m_outputBuffer;
 
-      /// sample buffer
-      std::vector<short> m_sampleBuffer;
-
-      /// sample buffer high watermark
-      size_t m_sampleBufferHigh;
+      /// splits interleaved samples from the sample container into frames
+      SampleFrameBuffer<short> m_inputFrameBuffer;
 
       /// bitrate control method
       int m_bitrateControlMethod;
 
-      /// output file stream
-      std::ofstream m_outputFile;
-
       /// last error occured
       CString m_lastError;
    };
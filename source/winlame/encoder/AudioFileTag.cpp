@@ -29,12 +29,15 @@
 #include <taglib/fileref.h>
 #include <taglib/tpropertymap.h>
 #include <taglib/id3v2tag.h>
+#include <taglib/id3v2header.h>
 #include <taglib/mpegfile.h>
 #include <taglib/attachedpictureframe.h>
 #include <taglib/textidentificationframe.h>
 #include <taglib/flacfile.h>
 #include <taglib/oggflacfile.h>
 #include <taglib/xiphcomment.h>
+#include <taglib/opusfile.h>
+#include <taglib/vorbisfile.h>
 #pragma warning(pop)
 #include <ulib/win32/VersionInfoResource.hpp>
 #include "../../version.h"
@@ -90,6 +93,33 @@ std::shared_ptr<TagLib::FileRef> AudioFileTag::OpenFile(const CString& filename,
                true,
                TagLib::AudioProperties::ReadStyle::Accurate)));
    }
+   else if (audioFileType == AudioFileType::OggVorbis)
+   {
+      spFileRef.reset(
+         new TagLib::FileRef(
+            new TagLib::Ogg::Vorbis::File(
+               TagLib::FileName(filename),
+               true,
+               TagLib::AudioProperties::ReadStyle::Accurate)));
+   }
+   else if (audioFileType == AudioFileType::OggOpus)
+   {
+      spFileRef.reset(
+         new TagLib::FileRef(
+            new TagLib::Ogg::Opus::File(
+               TagLib::FileName(filename),
+               true,
+               TagLib::AudioProperties::ReadStyle::Accurate)));
+   }
+   else if (audioFileType == AudioFileType::FLAC)
+   {
+      spFileRef.reset(
+         new TagLib::FileRef(
+            new TagLib::FLAC::File(
+               TagLib::FileName(filename),
+               true,
+               TagLib::AudioProperties::ReadStyle::Accurate)));
+   }
 
    return spFileRef;
 }
@@ -133,6 +163,11 @@ TagLib::Ogg::XiphComment* AudioFileTag::FindOggXiphCommentTag(std::shared_ptr<Ta
    return nullptr;
 }
 
+bool AudioFileTag::IsOpusFile(std::shared_ptr<TagLib::FileRef> spFileRef)
+{
+   return dynamic_cast<TagLib::Ogg::Opus::File*>(spFileRef->file()) != nullptr;
+}
+
 void AudioFileTag::ReadTrackInfoFromTag(TagLib::Tag* tag)
 {
    for (auto property : tag->properties())
@@ -337,6 +372,33 @@ unsigned int AudioFileTag::GetTagLength() const
    return size;
 }
 
+std::vector<unsigned char> AudioFileTag::RenderId3v2Tag(unsigned int tagLength) const
+{
+   TagLib::ID3v2::Tag tag;
+
+   StoreTrackInfoInTag(&tag);
+   StoreTrackInfoInId3v2Tag(&tag);
+
+   // the rendered tag already ends with padding bytes, which are extended to the length
+   TagLib::ByteVector tagData = tag.render();
+
+   const unsigned int headerLength = TagLib::ID3v2::Header::size();
+   if (tagData.size() < headerLength || tagData.size() > tagLength)
+      return std::vector<unsigned char>();
+
+   std::vector<unsigned char> paddedTagData(tagData.begin(), tagData.end());
+   paddedTagData.resize(tagLength, 0);
+
+   // the tag size in the header doesn't include the header, and is stored as synchsafe integer
+   unsigned int tagSize = tagLength - headerLength;
+   paddedTagData[6] = static_cast<unsigned char>((tagSize >> 21) & 0x7f);
+   paddedTagData[7] = static_cast<unsigned char>((tagSize >> 14) & 0x7f);
+   paddedTagData[8] = static_cast<unsigned char>((tagSize >> 7) & 0x7f);
+   paddedTagData[9] = static_cast<unsigned char>(tagSize & 0x7f);
+
+   return paddedTagData;
+}
+
 bool AudioFileTag::WriteToFile(const CString& filename, AudioFileType audioFileType) const
 {
    std::shared_ptr<TagLib::FileRef> spFileRef = OpenFile(filename, audioFileType);
@@ -356,11 +418,43 @@ bool AudioFileTag::WriteToFile(const CString& filename, AudioFileType audioFileT
 
    TagLib::Ogg::XiphComment* oggXiphComment = FindOggXiphCommentTag(spFileRef);
    if (oggXiphComment != nullptr)
-      StoreTrackInfoInXiphCommentTag(oggXiphComment);
+      StoreTrackInfoInXiphCommentTag(oggXiphComment, IsOpusFile(spFileRef));
 
    return spFileRef->save();
 }
 
+bool AudioFileTag::WriteReplayGainToFile(const CString& filename, AudioFileType audioFileType) const
+{
+   std::shared_ptr<TagLib::FileRef> spFileRef = OpenFile(filename, audioFileType);
+
+   if (spFileRef == nullptr || spFileRef->isNull())
+      return false;
+
+   bool isStored = false;
+
+   TagLib::ID3v2::Tag* id3v2tag = FindId3v2Tag(spFileRef);
+   TagLib::Ogg::XiphComment* oggXiphComment = FindOggXiphCommentTag(spFileRef);
+
+   if (id3v2tag != nullptr)
+   {
+      TagLib::PropertyMap propertyMap = id3v2tag->properties();
+
+      isStored = StoreReplayGainInPropertyMap(propertyMap, false);
+      if (isStored)
+         id3v2tag->setProperties(propertyMap);
+   }
+   else if (oggXiphComment != nullptr)
+   {
+      TagLib::PropertyMap propertyMap = oggXiphComment->properties();
+
+      isStored = StoreReplayGainInPropertyMap(propertyMap, IsOpusFile(spFileRef));
+      if (isStored)
+         oggXiphComment->setProperties(propertyMap);
+   }
+
+   return isStored && spFileRef->save();
+}
+
 void AudioFileTag::StoreTrackInfoInId3v2Tag(TagLib::ID3v2::Tag* id3v2tag) const
 {
    bool isAvail = false;
@@ -420,9 +514,15 @@ void AudioFileTag::StoreTrackInfoInId3v2Tag(TagLib::ID3v2::Tag* id3v2tag) const
 
       id3v2tag->addFrame(pictureFrame);
    }
+
+   // ReplayGain infos are stored in TXXX frames
+   TagLib::PropertyMap propertyMap = id3v2tag->properties();
+
+   if (StoreReplayGainInPropertyMap(propertyMap, false))
+      id3v2tag->setProperties(propertyMap);
 }
 
-void AudioFileTag::StoreTrackInfoInXiphCommentTag(TagLib::Ogg::XiphComment* oggXiphComment) const
+void AudioFileTag::StoreTrackInfoInXiphCommentTag(TagLib::Ogg::XiphComment* oggXiphComment, bool isOpusFile) const
 {
    bool isAvail = false;
    int intValue = m_trackInfo.GetNumberInfo(TrackInfoDiscNumber, isAvail);
@@ -434,6 +534,57 @@ void AudioFileTag::StoreTrackInfoInXiphCommentTag(TagLib::Ogg::XiphComment* oggX
 
       oggXiphComment->setProperties(propertyMap);
    }
+
+   TagLib::PropertyMap propertyMap = oggXiphComment->properties();
+
+   if (StoreReplayGainInPropertyMap(propertyMap, isOpusFile))
+      oggXiphComment->setProperties(propertyMap);
+}
+
+bool AudioFileTag::StoreReplayGainInPropertyMap(TagLib::PropertyMap& propertyMap, bool isOpusFile) const
+{
+   // ReplayGain tag field
+   struct ReplayGainField
+   {
+      TrackInfoTextType m_textType; ///< track info text type
+      const char* m_key;            ///< property key
+      const char* m_opusKey;        ///< property key for Opus files; nullptr when not stored
+   };
+
+   static const ReplayGainField c_replayGainFields[] =
+   {
+      { TrackInfoTrackGain, "REPLAYGAIN_TRACK_GAIN", "R128_TRACK_GAIN" },
+      { TrackInfoTrackPeak, "REPLAYGAIN_TRACK_PEAK", nullptr },
+      { TrackInfoAlbumGain, "REPLAYGAIN_ALBUM_GAIN", "R128_ALBUM_GAIN" },
+      { TrackInfoAlbumPeak, "REPLAYGAIN_ALBUM_PEAK", nullptr },
+   };
+
+   bool isStored = false;
+   for (const ReplayGainField& field : c_replayGainFields)
+   {
+      bool isAvail = false;
+      CString textValue = m_trackInfo.GetTextInfo(field.m_textType, isAvail);
+      if (!isAvail)
+         continue;
+
+      if (!isOpusFile)
+      {
+         propertyMap.replace(TagLib::String(field.m_key), TagLib::StringList(TagLib::String(textValue)));
+         isStored = true;
+      }
+      else if (field.m_opusKey != nullptr)
+      {
+         // Opus files store the gain in 1/256 dB, relative to -23 LUFS instead of the
+         // ReplayGain reference of -18 LUFS, and no peak; see RFC 7845
+         int gain = static_cast<int>(std::lround((_tstof(textValue) - 5.0) * 256.0));
+
+         propertyMap.replace(TagLib::String(field.m_opusKey),
+            TagLib::StringList(TagLib::String::number(std::clamp(gain, -32768, 32767))));
+         isStored = true;
+      }
+   }
+
+   return isStored;
 }
 
 void AudioFileTag::StoreTrackInfoInTag(TagLib::Tag* tag) const
@@ -28,6 +28,7 @@ namespace TagLib
    class Tag;
    class File;
    class FileRef;
+   class PropertyMap;
    template <class T> class List;
    namespace ID3v2
    {
@@ -59,6 +60,9 @@ namespace Encoder
       {
          FromExtension = 0,   ///< guess audio file type from extension
          MPEG = 1,            ///< treat audio file as MPEG Layer 1/2/3 file
+         OggVorbis = 2,       ///< treat audio file as Ogg Vorbis file
+         OggOpus = 3,         ///< treat audio file as Ogg Opus file
+         FLAC = 4,            ///< treat audio file as FLAC file
       };
 
       /// creates tag instance using track info
@@ -73,9 +77,19 @@ namespace Encoder
       /// determines the length of the (ID3v2) tag that would be written from the track infos
       unsigned int GetTagLength() const;
 
+      /// \brief renders the ID3v2 tag from the track infos, padded to the given length
+      /// \details used to write the tag into space reserved with GetTagLength(), e.g. at the
+      /// start of an MPEG stream; returns an empty buffer when the tag doesn't fit
+      std::vector<unsigned char> RenderId3v2Tag(unsigned int tagLength) const;
+
       /// stores TrackInfo data to tag infos in audio file
       bool WriteToFile(const CString& filename, AudioFileType audioFileType = AudioFileType::FromExtension) const;
 
+      /// \brief stores only the ReplayGain infos of TrackInfo in the audio file
+      /// \details used when the gain is known only after the file was written; all
+      /// other tag infos of the file are kept
+      bool WriteReplayGainToFile(const CString& filename, AudioFileType audioFileType = AudioFileType::FromExtension) const;
+
       /// returns TagLib version number
       static CString GetTagLibVersion();
 
@@ -89,6 +103,9 @@ namespace Encoder
       /// finds Ogg comment tag in given file, if available
       static TagLib::Ogg::XiphComment* FindOggXiphCommentTag(std::shared_ptr<TagLib::FileRef> spFile);
 
+      /// returns if the given file is an Ogg Opus file
+      static bool IsOpusFile(std::shared_ptr<TagLib::FileRef> spFile);
+
       /// reads all track infos from tag
       void ReadTrackInfoFromTag(TagLib::Tag* tag);
 
@@ -111,7 +128,10 @@ namespace Encoder
       void StoreTrackInfoInId3v2Tag(TagLib::ID3v2::Tag* id3v2tag) const;
 
       /// stores extra track infos in given Xiph Comment tag
-      void StoreTrackInfoInXiphCommentTag(TagLib::Ogg::XiphComment* oggXiphComment) const;
+      void StoreTrackInfoInXiphCommentTag(TagLib::Ogg::XiphComment* oggXiphComment, bool isOpusFile) const;
+
+      /// stores ReplayGain infos in given property map; returns false when there are none
+      bool StoreReplayGainInPropertyMap(TagLib::PropertyMap& propertyMap, bool isOpusFile) const;
 
    private:
       /// track info to read or store
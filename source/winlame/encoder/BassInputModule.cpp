@@ -42,14 +42,10 @@ std::atomic<unsigned int> s_bassApiusageCount = { 0 };
 /// name of WMA picture tag
 const TCHAR* WMA_PICTURE_TAG = _T("WM/Picture");
 
-/// buffer size
-const int c_bassInputBufferSize = 4096;
-
 // BassInputModule methods
 
 BassInputModule::BassInputModule()
-   :m_buffer(nullptr),
-   m_isStream(TRUE),
+   :m_isStream(TRUE),
    m_fileLength(0),
    m_lengthInSeconds(0.0),
    m_modLength(0),
@@ -292,9 +288,6 @@ int BassInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
       }
    }
 
-   // create buffer
-   m_buffer = new char[c_bassInputBufferSize];
-
    // set up input traits
    samplecont.SetInputModuleTraits(
       16,
@@ -318,13 +311,19 @@ int BassInputModule::DecodeSamples(SampleContainer& samples)
    if (BASS_ChannelIsActive(m_channel) != BASS_ACTIVE_PLAYING)
       return 0;
 
-   DWORD ret = BASS_ChannelGetData(m_channel, m_buffer, c_bassInputBufferSize);
+   // read as many samples as the output module prefers; the buffer is allocated
+   // here, since the block size is only known when the output module is initialized
+   size_t bufferSize = size_t(samples.GetPreferredBlockSize()) * m_channelInfo.chans * (16 >> 3);
+   if (m_buffer.size() < bufferSize)
+      m_buffer.resize(bufferSize);
+
+   DWORD ret = BASS_ChannelGetData(m_channel, m_buffer.data(), static_cast<DWORD>(bufferSize));
 
    if (ret != 0 && ret != DWORD(-1))
    {
       ret /= m_channelInfo.chans * (16 >> 3); // samples
 
-      samples.PutSamplesInterleaved(m_buffer, ret);
+      samples.PutSamplesInterleavedBorrowed(m_buffer.data(), ret);
    }
 
    if (ret == DWORD(-1))
@@ -362,7 +361,7 @@ void BassInputModule::DoneInput()
       BASS_Free();
    }
 
-   delete[] m_buffer;
+   m_buffer.clear();
 }
 
 void BassInputModule::ReadWmaPictureTag(DWORD channel, TrackInfo& trackInfo)
@@ -84,7 +84,7 @@ namespace Encoder
       mutable CString m_filterString;
 
       /// decoding buffer
-      char* m_buffer;
+      std::vector<char> m_buffer;
 
       /// channel info
       BASS_CHANNELINFO m_channelInfo;
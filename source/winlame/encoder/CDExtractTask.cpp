@@ -25,6 +25,7 @@
 #include "UISettings.hpp"
 #include "resource.h"
 #include <basscd.h>
+#include <chrono>
 #include "CDRipTitleFormatManager.hpp"
 
 using Encoder::CDExtractTask;
@@ -32,6 +33,9 @@ using Encoder::TrackInfo;
 
 extern std::atomic<unsigned int> s_bassApiusageCount;
 
+/// time to wait for the drive when BASS has no data available yet
+const std::chrono::milliseconds c_driveDataWaitTime(5);
+
 CDExtractTask::CDExtractTask(unsigned int dependentTaskId, const CDRipDiscInfo& discinfo, const CDRipTrackInfo& trackinfo)
    :Task(dependentTaskId),
    m_discinfo(discinfo),
@@ -79,6 +83,8 @@ TaskInfo CDExtractTask::GetTaskInfo()
 void CDExtractTask::Run()
 {
    m_running = true;
+   PublishTaskInfo();
+
    ExtractTrack(m_trackinfo.m_rippedFilename);
    m_running = false;
    m_finished = true;
@@ -86,7 +92,10 @@ void CDExtractTask::Run()
 
 void CDExtractTask::Stop()
 {
+   std::unique_lock<std::mutex> lock(m_mutexStopped);
    m_stopped = true;
+
+   m_conditionStopped.notify_all();
 }
 
 CString CDExtractTask::GetTempFilename(const CString& discTrackTitle) const
@@ -194,12 +203,19 @@ bool CDExtractTask::ExtractTrack(const CString& tempFilename)
 
       if (availBytes == 0)
       {
-         // buffer is empty; wait a bit to fill it
-         Sleep(1);
+         // buffer is empty; BASS can't signal new data, so wait a bit for the drive,
+         // but wake up immediately when stopped
+         std::unique_lock<std::mutex> lock(m_mutexStopped);
+         if (m_conditionStopped.wait_for(lock, c_driveDataWaitTime, [this]() { return m_stopped.load(); }))
+         {
+            isFinished = false;
+            break;
+         }
+
          continue;
       }
 
-      samples.PutSamplesInterleaved(&vecBuffer[0], availBytes / sizeof(vecBuffer[0]) / 2);
+      samples.PutSamplesInterleavedBorrowed(&vecBuffer[0], availBytes / sizeof(vecBuffer[0]) / 2);
 
       currentLength += availBytes;
 
@@ -209,7 +225,12 @@ bool CDExtractTask::ExtractTrack(const CString& tempFilename)
          break;
       }
 
-      m_progressInPercent = currentLength * 100 / trackLength;
+      unsigned int progressInPercent = currentLength * 100 / trackLength;
+      if (progressInPercent != m_progressInPercent)
+      {
+         m_progressInPercent = progressInPercent;
+         PublishTaskInfo();
+      }
 
       int ret = outputModule.EncodeSamples(samples);
       if (ret < 0)
@@ -25,6 +25,8 @@
 #include "CDRipDiscInfo.hpp"
 #include "CDRipTrackInfo.hpp"
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 struct UISettings;
 
@@ -51,6 +53,9 @@ namespace Encoder
       /// task should be aborted, e.g. when program is closed
       virtual void Stop();
 
+      /// returns the CD drive the track is extracted from
+      virtual int CDDrive() const override { return static_cast<int>(m_discinfo.m_discDrive); }
+
       /// output filename for this task
       const CString& OutputFilename() { return m_trackinfo.m_rippedFilename; }
 
@@ -83,6 +88,12 @@ namespace Encoder
       /// indicates if task was stopped
       std::atomic<bool> m_stopped;
 
+      /// mutex for waiting on m_conditionStopped
+      std::mutex m_mutexStopped;
+
+      /// condition that is signaled when the task is stopped
+      std::condition_variable m_conditionStopped;
+
       /// indicates if task is running
       std::atomic<bool> m_running;
 
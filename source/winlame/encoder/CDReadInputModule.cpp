@@ -0,0 +1,194 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file CDReadInputModule.cpp
+/// \brief contains the implementation of the CD read input module
+//
+#include "stdafx.h"
+#include "resource.h"
+#include "CDReadInputModule.hpp"
+#include "CDExtractTask.hpp"
+#include <basscd.h>
+#include <ulib/DynamicLibrary.hpp>
+
+using Encoder::CDReadInputModule;
+using Encoder::TrackInfo;
+using Encoder::SampleContainer;
+
+extern std::atomic<unsigned int> s_bassApiusageCount;
+
+/// read buffer size, in samples of all channels
+const unsigned int c_cdReadBufferSize = 65536;
+
+/// number of bytes per second of CD audio
+const DWORD c_cdAudioBytesPerSecond = 44100 * 2 * sizeof(signed short);
+
+CDReadInputModule::CDReadInputModule(const CDReadJob& cdReadJob)
+   :m_cdReadJob(cdReadJob),
+   m_bassInitialized(false),
+   m_stream(0),
+   m_trackLength(0),
+   m_currentLength(0)
+{
+   m_moduleId = ID_IM_CDREAD;
+   m_channels = 2;
+   m_samplerate = 44100;
+}
+
+Encoder::InputModule* CDReadInputModule::CloneModule()
+{
+   return new CDReadInputModule(m_cdReadJob);
+}
+
+bool CDReadInputModule::IsAvailable() const
+{
+   DynamicLibrary bassLib(_T("bass.dll"));
+   DynamicLibrary bassCdLib(_T("basscd.dll"));
+
+   return bassLib.IsLoaded() && bassCdLib.IsLoaded();
+}
+
+CString CDReadInputModule::GetDescription() const
+{
+   CString desc;
+   desc.Format(IDS_CDEXTRACT_DESC_US,
+      m_cdReadJob.TrackInfo().m_numTrackOnDisc + 1,
+      m_cdReadJob.Title().GetString());
+
+   return desc;
+}
+
+int CDReadInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
+   TrackInfo& trackInfo, SampleContainer& samples)
+{
+   UNUSED(infilename);
+   UNUSED(mgr);
+
+   const CDRipDiscInfo& discInfo = m_cdReadJob.DiscInfo();
+
+   if (s_bassApiusageCount++ == 0)
+   {
+      BASS_Init(0, 44100, 0, nullptr, nullptr);
+   }
+
+   m_bassInitialized = true;
+
+   // check disc ID
+   CString CDID(BASS_CD_GetID(discInfo.m_discDrive, BASS_CDID_CDDB));
+   if (CDID != discInfo.m_CDID)
+   {
+      m_lastError.LoadString(IDS_CDRIP_PAGE_ERROR_WRONG_CD);
+      return -1;
+   }
+
+   unsigned int numTrackOnDisc = m_cdReadJob.TrackInfo().m_numTrackOnDisc;
+
+   m_trackLength = BASS_CD_GetTrackLength(discInfo.m_discDrive, numTrackOnDisc);
+   m_currentLength = 0;
+
+   m_stream = BASS_CD_StreamCreate(discInfo.m_discDrive, numTrackOnDisc, BASS_STREAM_DECODE);
+
+   if (m_stream == 0)
+   {
+      m_lastError.Format(_T("BASS error: %i"), BASS_ErrorGetCode());
+      return -1;
+   }
+
+   CDExtractTask::SetTrackInfoFromCDTrackInfo(trackInfo, m_cdReadJob);
+
+   m_buffer.resize(c_cdReadBufferSize);
+
+   // CD audio is always 16 bit stereo with 44100 Hz
+   samples.SetInputModuleTraits(16, SamplesInterleaved, 44100, 2);
+
+   return 0;
+}
+
+void CDReadInputModule::GetInfo(int& numChannels, int& bitrateInBps, int& lengthInSeconds, int& samplerateInHz) const
+{
+   numChannels = 2;
+   bitrateInBps = c_cdAudioBytesPerSecond * 8;
+   lengthInSeconds = static_cast<int>(m_trackLength / c_cdAudioBytesPerSecond);
+   samplerateInHz = 44100;
+}
+
+int CDReadInputModule::DecodeSamples(SampleContainer& samples)
+{
+   if (m_stream == 0 ||
+      BASS_ChannelIsActive(m_stream) == BASS_ACTIVE_STOPPED)
+   {
+      FreeStream();
+      return 0;
+   }
+
+   DWORD availBytes = BASS_ChannelGetData(m_stream, m_buffer.data(),
+      static_cast<DWORD>(m_buffer.size() * sizeof(m_buffer[0])));
+
+   // a decoding stream blocks until data was read from the drive, so no data
+   // means that either the track has ended or the read has failed
+   if (availBytes == DWORD(-1) || availBytes == 0)
+   {
+      int errorCode = BASS_ErrorGetCode();
+      if (errorCode == BASS_ERROR_ENDED ||
+         (errorCode == BASS_OK && BASS_ChannelIsActive(m_stream) == BASS_ACTIVE_STOPPED))
+      {
+         // track has ended; the drive isn't accessed anymore while encoding the rest
+         FreeStream();
+         return 0;
+      }
+
+      m_lastError.Format(_T("BASS error: %i"), errorCode);
+      return -1;
+   }
+
+   m_currentLength += availBytes;
+
+   int numSamples = static_cast<int>(availBytes / sizeof(m_buffer[0]) / 2);
+   samples.PutSamplesInterleavedBorrowed(m_buffer.data(), numSamples);
+
+   return numSamples;
+}
+
+float CDReadInputModule::PercentDone() const
+{
+   return m_trackLength == 0 ? 0.f : m_currentLength * 100.f / m_trackLength;
+}
+
+void CDReadInputModule::DoneInput()
+{
+   FreeStream();
+
+   if (m_bassInitialized &&
+      --s_bassApiusageCount == 0)
+   {
+      BASS_Free();
+   }
+
+   m_bassInitialized = false;
+
+   m_buffer.clear();
+}
+
+void CDReadInputModule::FreeStream()
+{
+   if (m_stream != 0)
+   {
+      BASS_StreamFree(m_stream);
+      m_stream = 0;
+   }
+}
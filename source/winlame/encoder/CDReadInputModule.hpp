@@ -0,0 +1,104 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file CDReadInputModule.hpp
+/// \brief contains the CD read input module definition
+//
+#pragma once
+
+#include "ModuleInterface.hpp"
+#include "CDReadJob.hpp"
+#include "bass.h"
+
+namespace Encoder
+{
+   /// \brief input module that reads an audio track directly from CD
+   /// \details The module isn't registered in the module manager, since it
+   /// doesn't read files; it's passed to the encoder in
+   /// EncoderSettings::m_inputModulePrototype instead.
+   class CDReadInputModule : public InputModule
+   {
+   public:
+      /// ctor
+      explicit CDReadInputModule(const CDReadJob& cdReadJob);
+
+      /// clones input module
+      virtual InputModule* CloneModule() override;
+
+      /// returns the module name
+      virtual CString GetModuleName() const override { return _T("CD Audio Reader"); }
+
+      /// returns the last error
+      virtual CString GetLastError() const override { return m_lastError; }
+
+      /// returns if the module is available
+      virtual bool IsAvailable() const override;
+
+      /// returns description of current track
+      virtual CString GetDescription() const override;
+
+      /// returns filter string; the module doesn't read files
+      virtual CString GetFilterString() const override { return CString(); }
+
+      /// initializes the input module; the filename isn't used
+      virtual int InitInput(LPCTSTR infilename, SettingsManager& mgr,
+         TrackInfo& trackInfo, SampleContainer& samples) override;
+
+      /// returns info about the CD track
+      virtual void GetInfo(int& numChannels, int& bitrateInBps, int& lengthInSeconds, int& samplerateInHz) const override;
+
+      /// decodes samples and stores them in the sample container
+      virtual int DecodeSamples(SampleContainer& samples) override;
+
+      /// returns the number of percent done
+      virtual float PercentDone() const override;
+
+      /// called when done with decoding
+      virtual void DoneInput() override;
+
+      /// returns the CD drive the track is read from
+      unsigned int CDDrive() const { return m_cdReadJob.DiscInfo().m_discDrive; }
+
+   private:
+      /// frees the CD stream, when not already done
+      void FreeStream();
+
+   private:
+      /// CD read job with disc and track infos
+      CDReadJob m_cdReadJob;
+
+      /// last error occured
+      CString m_lastError;
+
+      /// indicates if the BASS API was initialized by this module
+      bool m_bassInitialized;
+
+      /// CD stream handle
+      HSTREAM m_stream;
+
+      /// track length, in bytes
+      DWORD m_trackLength;
+
+      /// number of bytes read so far
+      DWORD m_currentLength;
+
+      /// read buffer
+      std::vector<signed short> m_buffer;
+   };
+
+} // namespace Encoder
@@ -0,0 +1,450 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file ChannelMatrix.cpp
+/// \brief channel remapping and downmixing matrix
+//
+#include "stdafx.h"
+#include "ChannelMatrix.hpp"
+#include <immintrin.h>
+
+using Encoder::ChannelMatrix;
+using Encoder::SampleConverter;
+
+namespace
+{
+   /// type of function that calculates target = source * coefficient, or adds it to target
+   typedef void(*T_fnMixKernel)(float* target, const float* source, float coefficient, size_t numSamples);
+
+   /// sets target to scaled source samples, plain C++ version
+   void ScaleScalar(float* target, const float* source, float coefficient, size_t numSamples)
+   {
+      for (size_t index = 0; index < numSamples; index++)
+         target[index] = source[index] * coefficient;
+   }
+
+   /// adds scaled source samples to target, plain C++ version
+   void MultiplyAddScalar(float* target, const float* source, float coefficient, size_t numSamples)
+   {
+      for (size_t index = 0; index < numSamples; index++)
+         target[index] += source[index] * coefficient;
+   }
+
+   /// sets target to scaled source samples, SSE2 version
+   void ScaleSSE2(float* target, const float* source, float coefficient, size_t numSamples)
+   {
+      __m128 factor = _mm_set1_ps(coefficient);
+
+      size_t index = 0;
+      for (; index + 4 <= numSamples; index += 4)
+         _mm_storeu_ps(target + index, _mm_mul_ps(_mm_loadu_ps(source + index), factor));
+
+      ScaleScalar(target + index, source + index, coefficient, numSamples - index);
+   }
+
+   /// adds scaled source samples to target, SSE2 version
+   void MultiplyAddSSE2(float* target, const float* source, float coefficient, size_t numSamples)
+   {
+      __m128 factor = _mm_set1_ps(coefficient);
+
+      size_t index = 0;
+      for (; index + 4 <= numSamples; index += 4)
+      {
+         __m128 sum = _mm_add_ps(_mm_loadu_ps(target + index), _mm_mul_ps(_mm_loadu_ps(source + index), factor));
+         _mm_storeu_ps(target + index, sum);
+      }
+
+      MultiplyAddScalar(target + index, source + index, coefficient, numSamples - index);
+   }
+
+   /// sets target to scaled source samples, AVX2 version
+   void ScaleAVX2(float* target, const float* source, float coefficient, size_t numSamples)
+   {
+      __m256 factor = _mm256_set1_ps(coefficient);
+
+      size_t index = 0;
+      for (; index + 8 <= numSamples; index += 8)
+         _mm256_storeu_ps(target + index, _mm256_mul_ps(_mm256_loadu_ps(source + index), factor));
+
+      _mm256_zeroupper();
+
+      ScaleScalar(target + index, source + index, coefficient, numSamples - index);
+   }
+
+   /// adds scaled source samples to target, AVX2 version
+   void MultiplyAddAVX2(float* target, const float* source, float coefficient, size_t numSamples)
+   {
+      __m256 factor = _mm256_set1_ps(coefficient);
+
+      size_t index = 0;
+      for (; index + 8 <= numSamples; index += 8)
+      {
+         __m256 sum = _mm256_add_ps(_mm256_loadu_ps(target + index), _mm256_mul_ps(_mm256_loadu_ps(source + index), factor));
+         _mm256_storeu_ps(target + index, sum);
+      }
+
+      _mm256_zeroupper();
+
+      MultiplyAddScalar(target + index, source + index, coefficient, numSamples - index);
+   }
+
+   /// \brief copies 16 bit samples to their remapped channel positions, using SSSE3 byte shuffles
+   /// \details remaps as many sample frames with one shuffle as fit into 16 bytes; returns
+   /// the number of remapped samples, leaving the remaining samples to the caller
+   size_t RemapSamplesInt16SSSE3(const unsigned char* source, unsigned char* target,
+      const std::vector<size_t>& remapChannels, size_t numInputChannels, size_t numSamples)
+   {
+      const size_t numOutputChannels = remapChannels.size();
+      const size_t maxFrameSize = std::max(numInputChannels, numOutputChannels) * 2;
+      const size_t minFrameSize = std::min(numInputChannels, numOutputChannels) * 2;
+
+      if (minFrameSize == 0 || maxFrameSize > 16)
+         return 0;
+
+      const size_t numFrames = 16 / maxFrameSize;
+
+      // unused target bytes are set to zero
+      alignas(16) char shuffle[16];
+      std::fill_n(shuffle, 16, char(-1));
+
+      for (size_t frameIndex = 0; frameIndex < numFrames; frameIndex++)
+         for (size_t channelIndex = 0; channelIndex < numOutputChannels; channelIndex++)
+         {
+            size_t targetOffset = (frameIndex * numOutputChannels + channelIndex) * 2;
+            size_t sourceOffset = (frameIndex * numInputChannels + remapChannels[channelIndex]) * 2;
+
+            shuffle[targetOffset] = static_cast<char>(sourceOffset);
+            shuffle[targetOffset + 1] = static_cast<char>(sourceOffset + 1);
+         }
+
+      const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffle));
+
+      // each shuffle reads and writes 16 bytes, even when the frames are smaller; the bytes
+      // written past the frames are overwritten by the next shuffle or by the caller
+      size_t sampleIndex = 0;
+      for (; (numSamples - sampleIndex) * minFrameSize >= 16; sampleIndex += numFrames)
+      {
+         __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + sampleIndex * numInputChannels * 2));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(target + sampleIndex * numOutputChannels * 2), _mm_shuffle_epi8(samples, mask));
+      }
+
+      return sampleIndex;
+   }
+
+   /// \brief copies 32 bit samples to their remapped channel positions, using AVX2 permutes
+   /// \details remaps as many sample frames with one permute as fit into 32 bytes; returns
+   /// the number of remapped samples, leaving the remaining samples to the caller
+   size_t RemapSamplesInt32AVX2(const unsigned char* source, unsigned char* target,
+      const std::vector<size_t>& remapChannels, size_t numInputChannels, size_t numSamples)
+   {
+      const size_t numOutputChannels = remapChannels.size();
+      const size_t maxFrameChannels = std::max(numInputChannels, numOutputChannels);
+      const size_t minFrameChannels = std::min(numInputChannels, numOutputChannels);
+
+      if (minFrameChannels == 0 || maxFrameChannels > 8)
+         return 0;
+
+      const size_t numFrames = 8 / maxFrameChannels;
+
+      alignas(32) int permute[8] = {};
+
+      for (size_t frameIndex = 0; frameIndex < numFrames; frameIndex++)
+         for (size_t channelIndex = 0; channelIndex < numOutputChannels; channelIndex++)
+         {
+            permute[frameIndex * numOutputChannels + channelIndex] =
+               static_cast<int>(frameIndex * numInputChannels + remapChannels[channelIndex]);
+         }
+
+      const __m256i indices = _mm256_load_si256(reinterpret_cast<const __m256i*>(permute));
+
+      // like the 16 bit version, 32 bytes are read and written per permute
+      size_t sampleIndex = 0;
+      for (; (numSamples - sampleIndex) * minFrameChannels >= 8; sampleIndex += numFrames)
+      {
+         __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + sampleIndex * numInputChannels * 4));
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + sampleIndex * numOutputChannels * 4),
+            _mm256_permutevar8x32_epi32(samples, indices));
+      }
+
+      _mm256_zeroupper();
+
+      return sampleIndex;
+   }
+
+   /// copies samples with given size to their remapped channel positions
+   template <size_t sampleSize>
+   void RemapSamples(const unsigned char* source, unsigned char* target,
+      const std::vector<size_t>& remapChannels, size_t numInputChannels, size_t numSamples)
+   {
+      const size_t numOutputChannels = remapChannels.size();
+
+      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+      {
+         for (size_t channelIndex = 0; channelIndex < numOutputChannels; channelIndex++)
+            memcpy(target + channelIndex * sampleSize, source + remapChannels[channelIndex] * sampleSize, sampleSize);
+
+         source += numInputChannels * sampleSize;
+         target += numOutputChannels * sampleSize;
+      }
+   }
+
+} // unnamed namespace
+
+ChannelMatrix::ChannelMatrix()
+   :m_numInputChannels(0),
+   m_numOutputChannels(0)
+{
+}
+
+ChannelMatrix::ChannelMatrix(size_t numInputChannels, size_t numOutputChannels)
+   :m_numInputChannels(numInputChannels),
+   m_numOutputChannels(numOutputChannels),
+   m_coefficients(numInputChannels * numOutputChannels, 0.0f)
+{
+   UpdateTerms();
+}
+
+ChannelMatrix ChannelMatrix::Identity(size_t numChannels)
+{
+   ChannelMatrix matrix(numChannels, numChannels);
+
+   for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+      matrix.m_coefficients[channelIndex * numChannels + channelIndex] = 1.0f;
+
+   matrix.UpdateTerms();
+
+   return matrix;
+}
+
+ChannelMatrix ChannelMatrix::FromChannelMap(const size_t* channelMap, size_t numChannels)
+{
+   ChannelMatrix matrix(numChannels, numChannels);
+
+   for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+   {
+      ATLASSERT(channelMap[channelIndex] < numChannels);
+      matrix.m_coefficients[channelIndex * numChannels + channelMap[channelIndex]] = 1.0f;
+   }
+
+   matrix.UpdateTerms();
+
+   return matrix;
+}
+
+ChannelMatrix ChannelMatrix::FromChannelMapType(T_enChannelMapType channelMapType, size_t numChannels)
+{
+   std::vector<size_t> channelMap(numChannels);
+
+   for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+      channelMap[channelIndex] = ChannelRemapper::GetMappedChannel(channelMapType, numChannels, channelIndex);
+
+   return FromChannelMap(channelMap.data(), numChannels);
+}
+
+bool ChannelMatrix::IsIdentity() const
+{
+   if (m_numInputChannels != m_numOutputChannels || m_remapChannels.empty())
+      return false;
+
+   for (size_t channelIndex = 0; channelIndex < m_numOutputChannels; channelIndex++)
+   {
+      if (m_remapChannels[channelIndex] != channelIndex)
+         return false;
+   }
+
+   return true;
+}
+
+void ChannelMatrix::SetCoefficient(size_t outputChannel, size_t inputChannel, float coefficient)
+{
+   ATLASSERT(outputChannel < m_numOutputChannels && inputChannel < m_numInputChannels);
+
+   m_coefficients[outputChannel * m_numInputChannels + inputChannel] = coefficient;
+
+   UpdateTerms();
+}
+
+ChannelMatrix ChannelMatrix::Multiply(const ChannelMatrix& other) const
+{
+   ATLASSERT(other.m_numOutputChannels == m_numInputChannels);
+
+   ChannelMatrix matrix(other.m_numInputChannels, m_numOutputChannels);
+
+   for (size_t outputChannel = 0; outputChannel < m_numOutputChannels; outputChannel++)
+      for (size_t inputChannel = 0; inputChannel < other.m_numInputChannels; inputChannel++)
+      {
+         float sum = 0.0f;
+         for (size_t index = 0; index < m_numInputChannels; index++)
+            sum += GetCoefficient(outputChannel, index) * other.GetCoefficient(index, inputChannel);
+
+         matrix.m_coefficients[outputChannel * other.m_numInputChannels + inputChannel] = sum;
+      }
+
+   matrix.UpdateTerms();
+
+   return matrix;
+}
+
+void ChannelMatrix::ApplyInterleaved(const void* source, SampleType sourceType,
+   void* target, SampleType targetType, size_t numSamples)
+{
+   ATLASSERT(!IsEmpty());
+
+   const unsigned char* sourceBytes = static_cast<const unsigned char*>(source);
+   unsigned char* targetBytes = static_cast<unsigned char*>(target);
+
+   const size_t sourceSampleSize = SampleConverter::GetSampleSize(sourceType);
+   const size_t targetSampleSize = SampleConverter::GetSampleSize(targetType);
+
+   if (sourceType == targetType && !m_remapChannels.empty())
+   {
+      RemapInterleaved(sourceBytes, targetBytes, sourceSampleSize, numSamples);
+      return;
+   }
+
+   T_fnMixKernel fnScale = &ScaleScalar;
+   T_fnMixKernel fnMultiplyAdd = &MultiplyAddScalar;
+
+   switch (SampleConverter::GetInstructionSet())
+   {
+   case instructionSetAVX2:
+      fnScale = &ScaleAVX2;
+      fnMultiplyAdd = &MultiplyAddAVX2;
+      break;
+
+   case instructionSetSSE2:
+      fnScale = &ScaleSSE2;
+      fnMultiplyAdd = &MultiplyAddSSE2;
+      break;
+
+   default:
+      break;
+   }
+
+   m_inputPlanes.resize(c_blockSize * m_numInputChannels);
+   m_outputPlanes.resize(c_blockSize * m_numOutputChannels);
+   m_inputPlanePointers.resize(m_numInputChannels);
+   m_outputPlanePointers.resize(m_numOutputChannels);
+
+   for (size_t channelIndex = 0; channelIndex < m_numInputChannels; channelIndex++)
+      m_inputPlanePointers[channelIndex] = m_inputPlanes.data() + channelIndex * c_blockSize;
+
+   for (size_t offset = 0; offset < numSamples; offset += c_blockSize)
+   {
+      size_t numBlockSamples = std::min(c_blockSize, numSamples - offset);
+
+      SampleConverter::InterleavedToArray(
+         sourceBytes + offset * sourceSampleSize * m_numInputChannels, sourceType,
+         m_inputPlanePointers.data(), SampleTypeFloat32,
+         numBlockSamples, m_numInputChannels);
+
+      for (size_t outputChannel = 0; outputChannel < m_numOutputChannels; outputChannel++)
+      {
+         const std::vector<Term>& terms = m_outputTerms[outputChannel];
+
+         // a copied input channel needs no mixing
+         if (terms.size() == 1 && terms[0].m_coefficient == 1.0f)
+         {
+            m_outputPlanePointers[outputChannel] = m_inputPlanePointers[terms[0].m_inputChannel];
+            continue;
+         }
+
+         float* outputPlane = m_outputPlanes.data() + outputChannel * c_blockSize;
+         m_outputPlanePointers[outputChannel] = outputPlane;
+
+         if (terms.empty())
+         {
+            std::fill_n(outputPlane, numBlockSamples, 0.0f);
+            continue;
+         }
+
+         fnScale(outputPlane, m_inputPlanes.data() + terms[0].m_inputChannel * c_blockSize,
+            terms[0].m_coefficient, numBlockSamples);
+
+         for (size_t termIndex = 1; termIndex < terms.size(); termIndex++)
+         {
+            fnMultiplyAdd(outputPlane, m_inputPlanes.data() + terms[termIndex].m_inputChannel * c_blockSize,
+               terms[termIndex].m_coefficient, numBlockSamples);
+         }
+      }
+
+      SampleConverter::ArrayToInterleaved(
+         m_outputPlanePointers.data(), SampleTypeFloat32,
+         targetBytes + offset * targetSampleSize * m_numOutputChannels, targetType,
+         numBlockSamples, m_numOutputChannels);
+   }
+}
+
+void ChannelMatrix::UpdateTerms()
+{
+   m_outputTerms.assign(m_numOutputChannels, std::vector<Term>());
+
+   bool isRemapOnly = true;
+   for (size_t outputChannel = 0; outputChannel < m_numOutputChannels; outputChannel++)
+   {
+      std::vector<Term>& terms = m_outputTerms[outputChannel];
+
+      for (size_t inputChannel = 0; inputChannel < m_numInputChannels; inputChannel++)
+      {
+         float coefficient = GetCoefficient(outputChannel, inputChannel);
+         if (coefficient != 0.0f)
+            terms.push_back(Term{ inputChannel, coefficient });
+      }
+
+      if (terms.size() != 1 || terms[0].m_coefficient != 1.0f)
+         isRemapOnly = false;
+   }
+
+   m_remapChannels.clear();
+
+   if (isRemapOnly)
+   {
+      for (const std::vector<Term>& terms : m_outputTerms)
+         m_remapChannels.push_back(terms[0].m_inputChannel);
+   }
+}
+
+void ChannelMatrix::RemapInterleaved(const unsigned char* source, unsigned char* target,
+   size_t sampleSize, size_t numSamples) const
+{
+   // 16 bit samples are shuffled using SSSE3, which all AVX2 capable CPUs support
+   if (SampleConverter::GetInstructionSet() >= instructionSetAVX2)
+   {
+      size_t numRemapped = 0;
+
+      if (sampleSize == 2)
+         numRemapped = RemapSamplesInt16SSSE3(source, target, m_remapChannels, m_numInputChannels, numSamples);
+      else if (sampleSize == 4)
+         numRemapped = RemapSamplesInt32AVX2(source, target, m_remapChannels, m_numInputChannels, numSamples);
+
+      source += numRemapped * m_numInputChannels * sampleSize;
+      target += numRemapped * m_numOutputChannels * sampleSize;
+      numSamples -= numRemapped;
+   }
+
+   switch (sampleSize)
+   {
+   case 1: RemapSamples<1>(source, target, m_remapChannels, m_numInputChannels, numSamples); break;
+   case 2: RemapSamples<2>(source, target, m_remapChannels, m_numInputChannels, numSamples); break;
+   case 3: RemapSamples<3>(source, target, m_remapChannels, m_numInputChannels, numSamples); break;
+   case 4: RemapSamples<4>(source, target, m_remapChannels, m_numInputChannels, numSamples); break;
+   default:
+      ATLASSERT(false);
+      break;
+   }
+}
@@ -0,0 +1,137 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file ChannelMatrix.hpp
+/// \brief channel remapping and downmixing matrix
+//
+#pragma once
+
+#include "SampleConverter.hpp"
+#include "ChannelRemapper.hpp"
+#include <vector>
+
+namespace Encoder
+{
+   /// \brief remaps and mixes channels of interleaved samples with a coefficient matrix
+   /// \details Each output channel is the weighted sum of the input channels; the
+   /// matrix has one row of input channel coefficients per output channel, so that
+   /// remapping, downmixing and upmixing are all done the same way, for any number of
+   /// channels. Samples are processed in blocks that fit into the CPU cache: each
+   /// block is converted to one float plane per input channel, the output planes are
+   /// mixed with the kernels of the current SampleConverter instruction set, and are
+   /// then converted to the target sample type, so sample type conversion needs no
+   /// extra pass over the samples. Output channels that just copy an input channel
+   /// reuse the input plane. Pure remapping between equal sample types only copies
+   /// the samples.
+   class ChannelMatrix
+   {
+   public:
+      /// ctor; creates an empty matrix
+      ChannelMatrix();
+
+      /// ctor; creates a matrix with all coefficients set to 0
+      ChannelMatrix(size_t numInputChannels, size_t numOutputChannels);
+
+      /// creates matrix that doesn't change the channels
+      static ChannelMatrix Identity(size_t numChannels);
+
+      /// creates matrix from a channel map; output channel i is input channel channelMap[i]
+      static ChannelMatrix FromChannelMap(const size_t* channelMap, size_t numChannels);
+
+      /// creates matrix from a pre-defined channel map type
+      static ChannelMatrix FromChannelMapType(T_enChannelMapType channelMapType, size_t numChannels);
+
+      /// returns if the matrix is empty, e.g. when default constructed
+      bool IsEmpty() const { return m_coefficients.empty(); }
+
+      /// returns if the matrix leaves all channels as they are
+      bool IsIdentity() const;
+
+      /// returns number of input channels
+      size_t GetNumInputChannels() const { return m_numInputChannels; }
+
+      /// returns number of output channels
+      size_t GetNumOutputChannels() const { return m_numOutputChannels; }
+
+      /// returns coefficient of input channel for output channel
+      float GetCoefficient(size_t outputChannel, size_t inputChannel) const
+      {
+         return m_coefficients[outputChannel * m_numInputChannels + inputChannel];
+      }
+
+      /// sets coefficient of input channel for output channel
+      void SetCoefficient(size_t outputChannel, size_t inputChannel, float coefficient);
+
+      /// returns matrix that applies the other matrix first, then this matrix
+      ChannelMatrix Multiply(const ChannelMatrix& other) const;
+
+      /// \brief applies the matrix to interleaved samples
+      /// \details source has GetNumInputChannels() channels, target has room for
+      /// GetNumOutputChannels() channels; source and target must not overlap
+      void ApplyInterleaved(const void* source, SampleType sourceType,
+         void* target, SampleType targetType, size_t numSamples);
+
+      /// number of samples per channel processed in one block
+      static constexpr size_t c_blockSize = 256;
+
+   private:
+      /// one input channel contributing to an output channel
+      struct Term
+      {
+         size_t m_inputChannel;  ///< input channel index
+         float m_coefficient;    ///< coefficient
+      };
+
+      /// updates the terms of all output channels after coefficients changed
+      void UpdateTerms();
+
+      /// copies samples to their remapped channel positions, without conversion
+      void RemapInterleaved(const unsigned char* source, unsigned char* target,
+         size_t sampleSize, size_t numSamples) const;
+
+   private:
+      /// number of input channels
+      size_t m_numInputChannels;
+
+      /// number of output channels
+      size_t m_numOutputChannels;
+
+      /// coefficients, one row of input channels per output channel
+      std::vector<float> m_coefficients;
+
+      /// non-zero terms, for each output channel
+      std::vector<std::vector<Term>> m_outputTerms;
+
+      /// input channel for each output channel, when every output channel copies
+      /// exactly one input channel; empty otherwise
+      std::vector<size_t> m_remapChannels;
+
+      /// float planes for the input channels of one block
+      std::vector<float> m_inputPlanes;
+
+      /// float planes for the mixed output channels of one block
+      std::vector<float> m_outputPlanes;
+
+      /// pointers to the input planes
+      std::vector<void*> m_inputPlanePointers;
+
+      /// pointers to the planes of each output channel; either mixed or input planes
+      std::vector<const void*> m_outputPlanePointers;
+   };
+
+} // namespace Encoder
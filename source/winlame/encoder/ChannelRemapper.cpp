@@ -25,46 +25,54 @@
 
 using Encoder::ChannelRemapper;
 
-const int MAX_CHANNELS = 6; ///< make this higher to support files with more channels
+const int MAX_CHANNELS = 8; ///< make this higher to support files with more channels
 
 /// channel remapping map
 const int g_channelMap[4][MAX_CHANNELS][MAX_CHANNELS] =
 {
    // aacInputChannelMap
    {
-      { 0, },               // mono
-      { 0, 1, },            // l, r
-      { 1, 2, 0, },         // c, l, r -> l, r, c
-      { 1, 2, 0, 3, },      // c, l, r, bc -> l, r, c, bc
-      { 1, 2, 0, 3, 4, },   // c, l, r, bl, br -> l, r, c, bl, br
-      { 1, 2, 0, 5, 3, 4 }  // c, l, r, bl, br, lfe -> l, r, c, lfe, bl, br
+      { 0, },                     // mono
+      { 0, 1, },                  // l, r
+      { 1, 2, 0, },               // c, l, r -> l, r, c
+      { 1, 2, 0, 3, },            // c, l, r, bc -> l, r, c, bc
+      { 1, 2, 0, 3, 4, },         // c, l, r, bl, br -> l, r, c, bl, br
+      { 1, 2, 0, 5, 3, 4 },       // c, l, r, bl, br, lfe -> l, r, c, lfe, bl, br
+      { 1, 2, 0, 6, 5, 3, 4 },    // c, l, r, sl, sr, bc, lfe -> l, r, c, lfe, bc, sl, sr
+      { 1, 2, 0, 7, 5, 6, 3, 4 }  // c, l, r, sl, sr, bl, br, lfe -> l, r, c, lfe, bl, br, sl, sr
    },
    // aacOutputChannelMap
    {
-      { 0, },               // mono
-      { 0, 1, },            // l, r
-      { 2, 0, 1, },         // l, r, c -> c, l, r
-      { 2, 0, 1, 3, },      // l, r, c, bc -> c, l, r, bc
-      { 2, 0, 1, 3, 4, },   // l, r, c, bl, br -> c, l, r, bl, br
-      { 2, 0, 1, 4, 5, 3 }  // l, r, c, lfe, bl, br -> c, l, r, bl, br, lfe
+      { 0, },                     // mono
+      { 0, 1, },                  // l, r
+      { 2, 0, 1, },               // l, r, c -> c, l, r
+      { 2, 0, 1, 3, },            // l, r, c, bc -> c, l, r, bc
+      { 2, 0, 1, 3, 4, },         // l, r, c, bl, br -> c, l, r, bl, br
+      { 2, 0, 1, 4, 5, 3 },       // l, r, c, lfe, bl, br -> c, l, r, bl, br, lfe
+      { 2, 0, 1, 5, 6, 4, 3 },    // l, r, c, lfe, bc, sl, sr -> c, l, r, sl, sr, bc, lfe
+      { 2, 0, 1, 6, 7, 4, 5, 3 }  // l, r, c, lfe, bl, br, sl, sr -> c, l, r, sl, sr, bl, br, lfe
    },
    // oggVorbisInputChannelMap
    {
-      { 0, },               // mono
-      { 0, 1, },            // l, r
-      { 0, 2, 1, },         // l, c, r -> l, r, c
-      { 0, 1, 2, 3, },      // l, r, bl, br
-      { 0, 2, 1, 3, 4, },   // l, c, r, bl, br -> l, r, c, bl, br
-      { 0, 2, 1, 5, 3, 4 }  // l, c, r, bl, br, lfe -> l, r, c, lfe, bl, br
+      { 0, },                     // mono
+      { 0, 1, },                  // l, r
+      { 0, 2, 1, },               // l, c, r -> l, r, c
+      { 0, 1, 2, 3, },            // l, r, bl, br
+      { 0, 2, 1, 3, 4, },         // l, c, r, bl, br -> l, r, c, bl, br
+      { 0, 2, 1, 5, 3, 4 },       // l, c, r, bl, br, lfe -> l, r, c, lfe, bl, br
+      { 0, 2, 1, 6, 5, 3, 4 },    // l, c, r, sl, sr, bc, lfe -> l, r, c, lfe, bc, sl, sr
+      { 0, 2, 1, 7, 5, 6, 3, 4 }  // l, c, r, sl, sr, bl, br, lfe -> l, r, c, lfe, bl, br, sl, sr
    },
    // oggVorbisOutputChannelMap
    {
-      { 0, },               // mono
-      { 0, 1, },            // l, r
-      { 0, 2, 1, },         // l, r, c -> l, c, r
-      { 0, 1, 2, 3, },      // l, r, bl, br
-      { 0, 2, 1, 3, 4, },   // l, r, c, bl, br -> l, c, r, bl, br
-      { 0, 2, 1, 4, 5, 3 }  // l, r, c, lfe, bl, br -> l, c, r, bl, br, lfe
+      { 0, },                     // mono
+      { 0, 1, },                  // l, r
+      { 0, 2, 1, },               // l, r, c -> l, c, r
+      { 0, 1, 2, 3, },            // l, r, bl, br
+      { 0, 2, 1, 3, 4, },         // l, r, c, bl, br -> l, c, r, bl, br
+      { 0, 2, 1, 4, 5, 3 },       // l, r, c, lfe, bl, br -> l, c, r, bl, br, lfe
+      { 0, 2, 1, 5, 6, 4, 3 },    // l, r, c, lfe, bc, sl, sr -> l, c, r, sl, sr, bc, lfe
+      { 0, 2, 1, 6, 7, 4, 5, 3 }  // l, r, c, lfe, bl, br, sl, sr -> l, c, r, sl, sr, bl, br, lfe
    }
 };
 
@@ -75,54 +83,23 @@ size_t ChannelRemapper::GetMaxMappedChannel()
 
 size_t ChannelRemapper::GetMappedChannel(T_enChannelMapType channelMapType, size_t numChannels, size_t inputChannel)
 {
-   if (numChannels >= MAX_CHANNELS ||
-      inputChannel >= MAX_CHANNELS)
-      return 0;
+   // channel counts without a channel map are passed through unchanged
+   if (numChannels == 0 ||
+      numChannels > MAX_CHANNELS ||
+      inputChannel >= numChannels)
+      return inputChannel;
 
    return g_channelMap[channelMapType][numChannels - 1][inputChannel];
 }
 
-void ChannelRemapper::ConvertSamplesToFloat(
-   short** sampleBuffer, size_t numSamples, size_t numChannels, float** outputBuffer)
-{
-   for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
-      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
-         outputBuffer[channelIndex][sampleIndex] = float(sampleBuffer[channelIndex][sampleIndex]) / 32768.f;
-}
-
-void ChannelRemapper::RemapInterleaved(T_enChannelMapType channelMapType,
-   short* sampleBuffer, size_t numSamples, size_t numChannels, short* outputBuffer)
-{
-   auto channelMap = g_channelMap[channelMapType];
-
-   for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
-      for (size_t channelIndex = 0; channelIndex < std::min<size_t>(numChannels, MAX_CHANNELS); channelIndex++)
-         outputBuffer[sampleIndex * numChannels + channelIndex] =
-         sampleBuffer[sampleIndex * numChannels + (channelMap[numChannels - 1][channelIndex])];
-
-   // copy the remaining channels
-   if (numChannels > MAX_CHANNELS)
-   {
-      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
-         for (size_t channelIndex = MAX_CHANNELS; channelIndex < numChannels; channelIndex++)
-            outputBuffer[sampleIndex * numChannels + channelIndex] = sampleBuffer[sampleIndex * numChannels + channelIndex];
-   }
-}
-
-void ChannelRemapper::RemapArrayToFloat(T_enChannelMapType channelMapType,
-   short** sampleBuffer, size_t numSamples, size_t numChannels, float** outputBuffer)
+void ChannelRemapper::RemapChannelPointers(T_enChannelMapType channelMapType,
+   float** sampleBuffer, size_t numChannels, float** outputBuffer)
 {
    auto channelMap = g_channelMap[channelMapType];
 
-   for (size_t channelIndex = 0; channelIndex < std::min<size_t>(numChannels, MAX_CHANNELS); channelIndex++)
-      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
-         outputBuffer[channelIndex][sampleIndex] =
-         float(sampleBuffer[channelMap[numChannels - 1][channelIndex]][sampleIndex]) / 32768.f;
-
-   if (numChannels > MAX_CHANNELS)
-   {
-      for (size_t channelIndex = MAX_CHANNELS; channelIndex < numChannels; channelIndex++)
-         for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
-            outputBuffer[channelIndex][sampleIndex] = float(sampleBuffer[channelIndex][sampleIndex]) / 32768.f;
-   }
+   // channel counts without a channel map are passed through unchanged
+   for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+      outputBuffer[channelIndex] = numChannels <= MAX_CHANNELS
+         ? sampleBuffer[channelMap[numChannels - 1][channelIndex]]
+         : sampleBuffer[channelIndex];
 }
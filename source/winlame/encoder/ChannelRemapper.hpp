@@ -42,17 +42,10 @@ namespace Encoder
       /// returns mapped output channel for a given input channel
       static size_t GetMappedChannel(T_enChannelMapType channelMapType, size_t numChannels, size_t inputChannel);
 
-      /// converts a sample buffer to float, without remapping
-      static void ConvertSamplesToFloat(
-         short** sampleBuffer, size_t numSamples, size_t numChannels, float** outputBuffer);
-
-      /// remaps an interleaved sample buffer with number of samples and channels to a stereo output buffer
-      static void RemapInterleaved(T_enChannelMapType channelMapType,
-         short* sampleBuffer, size_t numSamples, size_t numChannels, short* outputBuffer);
-
-      /// remaps an array sample buffer with number of samples and channels to a float stereo output buffer
-      static void RemapArrayToFloat(T_enChannelMapType channelMapType,
-         short** sampleBuffer, size_t numSamples, size_t numChannels, float** outputBuffer);
+      /// remaps the channel pointers of a float channel array sample buffer; the samples
+      /// themselves are not copied
+      static void RemapChannelPointers(T_enChannelMapType channelMapType,
+         float** sampleBuffer, size_t numChannels, float** outputBuffer);
    };
 
 } // namespace Encoder
@@ -0,0 +1,297 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file DirectoryMirror.cpp
+/// \brief mirrors a source folder tree to a target folder tree, encoding only changed files
+//
+#include "stdafx.h"
+#include "DirectoryMirror.hpp"
+#include <ulib/Path.hpp>
+#include <set>
+
+using Encoder::DirectoryMirror;
+
+namespace
+{
+   /// first line of the index file
+   const char c_indexFileHeader[] = "winLAME directory mirror 1";
+
+   /// removes trailing backslashes from a folder name
+   CString TrimFolder(const CString& folder)
+   {
+      CString trimmedFolder = folder;
+      trimmedFolder.TrimRight(_T('\\'));
+      return trimmedFolder;
+   }
+}
+
+DirectoryMirror::DirectoryMirror(const CString& sourceFolder, const CString& targetFolder)
+   :m_sourceFolder(TrimFolder(sourceFolder)),
+   m_targetFolder(TrimFolder(targetFolder)),
+   m_journal(IndexFilename(targetFolder), c_indexFileHeader)
+{
+}
+
+CString DirectoryMirror::IndexFilename(const CString& targetFolder)
+{
+   // starts with a dot, so that the file isn't part of the mirrored files
+   return TrimFolder(targetFolder) + _T("\\.winlame-mirror.txt");
+}
+
+bool DirectoryMirror::Load()
+{
+   m_mapEntries.clear();
+
+   size_t numRecords = 0;
+   bool hasCurrentFormat = false;
+   if (!m_journal.Read([&](const std::vector<CString>& fields) { ParseRecord(fields); },
+      numRecords, hasCurrentFormat))
+      return false;
+
+   if (!hasCurrentFormat ||
+      IndexJournal::IsRewriteNeeded(numRecords, m_mapEntries.size()))
+      return m_journal.Rewrite(FormatAllLines());
+
+   return true;
+}
+
+std::vector<DirectoryMirror::SourceFile> DirectoryMirror::Scan(unsigned long long settingsHash,
+   std::vector<CString>& deletedOutputFilenames)
+{
+   m_settingsHash = settingsHash;
+
+   // the index is stored in the target folder
+   if (!Path::FolderExists(m_targetFolder))
+      Path::CreateDirectoryRecursive(m_targetFolder);
+
+   // collect all target files first, to check if output files are missing
+   std::set<CString> targetPathKeys;
+   WalkFolder(m_targetFolder, CString(), [&](const CString& relativePath, const FileStamp&)
+   {
+      targetPathKeys.insert(PathKey(relativePath));
+   });
+
+   std::vector<SourceFile> sourceFiles;
+   std::set<CString> sourcePathKeys;
+
+   WalkFolder(m_sourceFolder, CString(), [&](const CString& relativePath, const FileStamp& stamp)
+   {
+      CString key = PathKey(relativePath);
+      sourcePathKeys.insert(key);
+
+      auto iter = m_mapEntries.find(key);
+      if (iter != m_mapEntries.end() &&
+         iter->second.m_stamp == stamp &&
+         iter->second.m_settingsHash == settingsHash &&
+         (iter->second.m_outputPath.IsEmpty() ||
+            targetPathKeys.find(PathKey(iter->second.m_outputPath)) != targetPathKeys.end()))
+         return;
+
+      SourceFile sourceFile;
+      sourceFile.m_inputFilename = m_sourceFolder + _T("\\") + relativePath;
+      sourceFile.m_stamp = stamp;
+
+      int pos = relativePath.ReverseFind(_T('\\'));
+      sourceFile.m_outputFolder = pos == -1
+         ? m_targetFolder
+         : m_targetFolder + _T("\\") + relativePath.Left(pos);
+
+      sourceFiles.push_back(sourceFile);
+   });
+
+   // remove entries of source files that don't exist anymore
+   CString lines;
+   for (auto iter = m_mapEntries.begin(); iter != m_mapEntries.end();)
+   {
+      if (sourcePathKeys.find(iter->first) != sourcePathKeys.end())
+      {
+         ++iter;
+         continue;
+      }
+
+      if (!iter->second.m_outputPath.IsEmpty() &&
+         DeleteOutputFile(iter->second.m_outputPath))
+         deletedOutputFilenames.push_back(m_targetFolder + _T("\\") + iter->second.m_outputPath);
+
+      lines += _T("D\t") + iter->second.m_sourcePath + _T("\n");
+      iter = m_mapEntries.erase(iter);
+   }
+
+   if (!lines.IsEmpty())
+      m_journal.Append(lines);
+
+   return sourceFiles;
+}
+
+void DirectoryMirror::SetEncoded(const SourceFile& sourceFile, const CString& outputFilename)
+{
+   Entry entry;
+   entry.m_sourcePath = RelativePath(m_sourceFolder, sourceFile.m_inputFilename);
+   entry.m_stamp = sourceFile.m_stamp;
+   entry.m_settingsHash = m_settingsHash;
+
+   if (entry.m_sourcePath.IsEmpty())
+      return;
+
+   if (!outputFilename.IsEmpty())
+      entry.m_outputPath = RelativePath(m_targetFolder, outputFilename);
+
+   CString key = PathKey(entry.m_sourcePath);
+
+   // the output filename changes when the output module was changed
+   auto iter = m_mapEntries.find(key);
+   if (iter != m_mapEntries.end() &&
+      !iter->second.m_outputPath.IsEmpty() &&
+      iter->second.m_outputPath.CompareNoCase(entry.m_outputPath) != 0)
+      DeleteOutputFile(iter->second.m_outputPath);
+
+   m_mapEntries[key] = entry;
+   m_journal.Append(FormatEntryLine(entry));
+}
+
+void DirectoryMirror::WalkFolder(const CString& folder, const CString& relativeFolder, const T_fnOnFile& fnOnFile)
+{
+   CString searchPath = folder;
+   if (!relativeFolder.IsEmpty())
+      searchPath += _T("\\") + relativeFolder;
+
+   searchPath += _T("\\*");
+
+   // basic info and large fetch avoid querying short names and reduce directory reads
+   WIN32_FIND_DATA findData = {};
+   HANDLE findHandle = FindFirstFileEx(searchPath, FindExInfoBasic, &findData,
+      FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+
+   if (findHandle == INVALID_HANDLE_VALUE)
+      return;
+
+   do
+   {
+      if (findData.cFileName[0] == _T('.'))
+         continue;
+
+      CString relativePath = relativeFolder.IsEmpty()
+         ? CString(findData.cFileName)
+         : relativeFolder + _T("\\") + findData.cFileName;
+
+      if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+      {
+         // junctions and symbolic links may form cycles
+         if ((findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) == 0)
+            WalkFolder(folder, relativePath, fnOnFile);
+
+         continue;
+      }
+
+      FileStamp stamp;
+      stamp.m_size = (static_cast<unsigned long long>(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow;
+      stamp.m_lastWriteTime = (static_cast<unsigned long long>(findData.ftLastWriteTime.dwHighDateTime) << 32) |
+         findData.ftLastWriteTime.dwLowDateTime;
+
+      fnOnFile(relativePath, stamp);
+
+   } while (FindNextFile(findHandle, &findData));
+
+   FindClose(findHandle);
+}
+
+CString DirectoryMirror::RelativePath(const CString& folder, const CString& filename)
+{
+   int folderLength = folder.GetLength();
+   if (filename.GetLength() <= folderLength + 1 ||
+      filename[folderLength] != _T('\\') ||
+      filename.Left(folderLength).CompareNoCase(folder) != 0)
+      return CString();
+
+   return filename.Mid(folderLength + 1);
+}
+
+CString DirectoryMirror::PathKey(const CString& relativePath)
+{
+   CString key = relativePath;
+   key.MakeLower();
+   return key;
+}
+
+bool DirectoryMirror::DeleteOutputFile(const CString& outputPath)
+{
+   if (!DeleteFile(m_targetFolder + _T("\\") + outputPath))
+      return false;
+
+   // remove folders up to the target folder, until a folder isn't empty
+   CString folderPath = outputPath;
+   for (int pos = folderPath.ReverseFind(_T('\\')); pos != -1; pos = folderPath.ReverseFind(_T('\\')))
+   {
+      folderPath = folderPath.Left(pos);
+
+      if (!RemoveDirectory(m_targetFolder + _T("\\") + folderPath))
+         break;
+   }
+
+   return true;
+}
+
+bool DirectoryMirror::ParseRecord(const std::vector<CString>& fields)
+{
+   if (fields.size() == 6 && fields[0] == _T("F"))
+   {
+      Entry entry;
+      entry.m_stamp.m_size = _tcstoui64(fields[1], nullptr, 10);
+      entry.m_stamp.m_lastWriteTime = _tcstoui64(fields[2], nullptr, 10);
+      entry.m_settingsHash = _tcstoui64(fields[3], nullptr, 16);
+      entry.m_sourcePath = fields[4];
+      entry.m_outputPath = fields[5];
+
+      if (entry.m_sourcePath.IsEmpty())
+         return false;
+
+      m_mapEntries[PathKey(entry.m_sourcePath)] = entry;
+      return true;
+   }
+
+   if (fields.size() == 2 && fields[0] == _T("D"))
+   {
+      m_mapEntries.erase(PathKey(fields[1]));
+      return true;
+   }
+
+   return false;
+}
+
+CString DirectoryMirror::FormatEntryLine(const Entry& entry)
+{
+   CString line;
+   line.Format(_T("F\t%llu\t%llu\t%016llx\t%s\t%s\n"),
+      entry.m_stamp.m_size,
+      entry.m_stamp.m_lastWriteTime,
+      entry.m_settingsHash,
+      entry.m_sourcePath.GetString(),
+      entry.m_outputPath.GetString());
+
+   return line;
+}
+
+CString DirectoryMirror::FormatAllLines() const
+{
+   CString lines;
+
+   for (const auto& iter : m_mapEntries)
+      lines += FormatEntryLine(iter.second);
+
+   return lines;
+}
@@ -0,0 +1,140 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file DirectoryMirror.hpp
+/// \brief mirrors a source folder tree to a target folder tree, encoding only changed files
+//
+#pragma once
+
+#include "IndexJournal.hpp"
+#include <map>
+
+namespace Encoder
+{
+   /// \brief mirrors a source folder tree to a target folder tree, with an index of all
+   /// source files and their output files
+   /// \details Every source file is encoded to the folder in the target tree that has the
+   /// same relative path as the source file's folder. The index stores size and last
+   /// write time of each source file, together with the settings hash used for encoding
+   /// and the output file. Scanning compares the source tree with the index, so that
+   /// only added and changed source files need to be encoded, and deletes the output
+   /// files of source files that were removed. The index is stored in the target folder.
+   class DirectoryMirror
+   {
+   public:
+      /// source file that needs to be encoded
+      struct SourceFile
+      {
+         /// input filename
+         CString m_inputFilename;
+
+         /// output folder, with the same relative path as the folder of the input file
+         CString m_outputFolder;
+
+         /// file stamp of the input file when it was scanned
+         FileStamp m_stamp;
+      };
+
+      /// ctor
+      DirectoryMirror(const CString& sourceFolder, const CString& targetFolder);
+
+      /// returns the filename of the index file in the target folder
+      static CString IndexFilename(const CString& targetFolder);
+
+      /// \brief loads the index file; a missing file is an empty index
+      /// \details returns false when the index file exists but can't be read
+      bool Load();
+
+      /// returns number of source files in the index
+      size_t GetNumSourceFiles() const { return m_mapEntries.size(); }
+
+      /// \brief compares the source folder tree with the index and returns all source files to encode
+      /// \details Source files are returned when they were added or changed, when they were
+      /// encoded with other settings, or when their output file is missing. Output files
+      /// of source files that were removed are deleted, together with folders that are
+      /// empty then; the deleted output filenames are returned.
+      std::vector<SourceFile> Scan(unsigned long long settingsHash, std::vector<CString>& deletedOutputFilenames);
+
+      /// \brief stores that a source file returned by Scan() was encoded to given output file
+      /// \details the output filename is empty when the source file isn't encoded at all,
+      /// e.g. for cover images; such files are returned by Scan() again when they change.
+      /// The file stamp taken by Scan() is stored, so that a source file that changes
+      /// while it is encoded is returned again by the next scan. The output file of an
+      /// earlier encoding is deleted when its name differs.
+      void SetEncoded(const SourceFile& sourceFile, const CString& outputFilename);
+
+   private:
+      /// index entry for a source file
+      struct Entry
+      {
+         /// path of the source file, relative to the source folder
+         CString m_sourcePath;
+
+         /// file stamp of the source file when it was encoded
+         FileStamp m_stamp;
+
+         /// settings hash used for encoding
+         unsigned long long m_settingsHash = 0;
+
+         /// path of the output file, relative to the target folder; empty when not encoded
+         CString m_outputPath;
+      };
+
+      /// function type that is called with the relative path and stamp of a file
+      typedef std::function<void(const CString& relativePath, const FileStamp& stamp)> T_fnOnFile;
+
+      /// calls the function for all files in the folder and its sub folders; files and
+      /// folders starting with a dot are skipped
+      static void WalkFolder(const CString& folder, const CString& relativeFolder, const T_fnOnFile& fnOnFile);
+
+      /// returns the path relative to the folder, or an empty string when the file isn't in the folder
+      static CString RelativePath(const CString& folder, const CString& filename);
+
+      /// returns the key used for relative paths; file names are case-insensitive
+      static CString PathKey(const CString& relativePath);
+
+      /// deletes an output file and all folders in the target tree that are empty then
+      bool DeleteOutputFile(const CString& outputPath);
+
+      /// parses the fields of an index record; returns false when it's not a valid record
+      bool ParseRecord(const std::vector<CString>& fields);
+
+      /// formats index line of an entry
+      static CString FormatEntryLine(const Entry& entry);
+
+      /// formats index lines of all entries
+      CString FormatAllLines() const;
+
+   private:
+      /// source folder, without trailing backslash
+      CString m_sourceFolder;
+
+      /// target folder, without trailing backslash
+      CString m_targetFolder;
+
+      /// settings hash passed to the last Scan() call
+      unsigned long long m_settingsHash = 0;
+
+      /// all index entries, by path key of the source path
+      std::map<CString, Entry> m_mapEntries;
+
+      /// index file
+      IndexJournal m_journal;
+   };
+
+} // namespace Encoder
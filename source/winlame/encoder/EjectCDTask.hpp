@@ -44,6 +44,9 @@ namespace Encoder
       /// task should be aborted, e.g. when program is closed
       virtual void Stop() override;
 
+      /// returns the CD drive to eject
+      virtual int CDDrive() const override { return static_cast<int>(m_discDrive); }
+
    private:
       /// disc drive index
       unsigned int m_discDrive;
@@ -24,6 +24,7 @@
 #include "EncoderImpl.hpp"
 #include <fstream>
 #include "LameOutputModule.hpp"
+#include "TranscodeCache.hpp"
 #include <sndfile.h>
 #include <ulib/thread/LightweightMutex.hpp>
 
@@ -41,6 +42,19 @@ EncoderInterface* EncoderInterface::CreateEncoder()
 /// mutex to protect threads from generating the same output filenames
 static LightweightMutex s_mutexTempOutputFile;
 
+/// default number of sample blocks the decoder may run ahead of the encoder in pipelined encoding
+const size_t c_numPipelineSampleBlocks = 8;
+
+/// returns size of file, or 0 when the file doesn't exist, e.g. for CD tracks
+static unsigned long long FileSize(const CString& filename)
+{
+   WIN32_FILE_ATTRIBUTE_DATA data = {};
+   if (!GetFileAttributesEx(filename, GetFileExInfoStandard, &data))
+      return 0;
+
+   return (static_cast<unsigned long long>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+}
+
 // EncoderImpl methods
 
 EncoderImpl::EncoderImpl()
@@ -101,6 +115,8 @@ void EncoderImpl::StopEncode()
       std::unique_lock<std::recursive_mutex> lock(m_mutex);
       m_encoderState.m_running = false;
       m_encoderState.m_paused = false;
+
+      m_conditionStateChanged.notify_all();
    }
 
    // wait for thread to finish
@@ -124,6 +140,9 @@ void EncoderImpl::Encode()
    m_encoderState.m_percent = 0.f;
    m_encoderState.m_errorCode = 0;
    m_encoderState.m_encodingDescription.Empty();
+   m_encoderState.m_statistics.Reset();
+
+   auto startTime = std::chrono::steady_clock::now();
 
    bool initOutputModule = false;
 
@@ -133,27 +152,25 @@ void EncoderImpl::Encode()
    if (m_inputModule != nullptr || m_outputModule != nullptr)
    {
       // end thread
-      m_encoderState.m_running = false;
-      m_encoderState.m_paused = false;
-      m_encoderState.m_finished = true;
       m_encoderState.m_errorCode = -1;
+      SetFinished();
       return;
    }
 
    // get input and output modules
    ModuleManagerImpl* modimpl = reinterpret_cast<ModuleManagerImpl*>(&m_moduleManager);
-   m_inputModule = std::unique_ptr<InputModule>(modimpl->ChooseInputModule(m_encoderSettings.m_inputFilename));
+   if (m_encoderSettings.m_inputModulePrototype != nullptr)
+      m_inputModule = std::unique_ptr<InputModule>(m_encoderSettings.m_inputModulePrototype->CloneModule());
+   else
+      m_inputModule = std::unique_ptr<InputModule>(modimpl->ChooseInputModule(m_encoderSettings.m_inputFilename));
    m_outputModule = std::unique_ptr<OutputModule>(modimpl->GetOutputModule(m_encoderSettings.m_outputModuleID));
 
+   if (m_outputModule != nullptr)
+      m_outputModule->SetWorkerPool(m_encoderSettings.m_workerPool);
+
    if (m_inputModule == nullptr ||
       m_outputModule == nullptr)
    {
-      // end thread
-      m_encoderState.m_running = false;
-      m_encoderState.m_paused = false;
-      m_encoderState.m_finished = true;
-      m_encoderState.m_errorCode = -1;
-
       if (m_inputModule == nullptr)
       {
          CString errorMessage;
@@ -162,6 +179,9 @@ void EncoderImpl::Encode()
          HandleError(m_encoderSettings.m_inputFilename, _T("Encoder"), -1, errorMessage);
       }
 
+      // end thread
+      m_encoderState.m_errorCode = -1;
+      SetFinished();
       return;
    }
 
@@ -172,6 +192,8 @@ void EncoderImpl::Encode()
 
    if (!PrepareInputModule(trackInfo))
       skipFile = true;
+   else
+      m_encoderState.m_statistics.Add(counterBytesIn, FileSize(m_encoderSettings.m_inputFilename));
 
    CString tempOutputFilename;
 
@@ -186,6 +208,13 @@ void EncoderImpl::Encode()
             break;
          }
 
+         // no need to encode when the output file can be taken from the cache
+         if (ReuseCachedOutput())
+         {
+            skipMoveFile = true;
+            break;
+         }
+
          // use the provided track info
          if (m_encoderSettings.m_useTrackInfo)
             trackInfo = m_encoderSettings.m_trackInfo;
@@ -212,8 +241,12 @@ void EncoderImpl::Encode()
       } while (false);
    }
 
+   m_encoderState.m_statistics.Add(counterInitNanoseconds, NanosecondsSince(startTime));
+
    lock.unlock();
 
+   OnEncoderStateChanged();
+
    if (!skipFile && !skipMoveFile)
       skipFile = MainLoop();
 
@@ -224,12 +257,24 @@ void EncoderImpl::Encode()
          WritePlaylistEntry(m_encoderSettings.m_outputFilename);
    }
 
+   auto finishStartTime = std::chrono::steady_clock::now();
+
    // done with modules
    if (m_inputModule != nullptr)
       m_inputModule->DoneInput();
 
    if (initOutputModule && m_outputModule != nullptr)
+   {
+      // the output module stores the gain values when closing the output file
+      if (!skipFile && m_analyzeLoudness)
+      {
+         LoudnessResult loudnessResult = m_loudnessAnalyzer.GetResult();
+         if (loudnessResult.m_isValid)
+            m_outputModule->SetLoudnessResult(loudnessResult);
+      }
+
       m_outputModule->DoneOutput();
+   }
 
    // delete modules
    m_inputModule.reset();
@@ -258,18 +303,72 @@ void EncoderImpl::Encode()
          if (m_encoderSettings.m_deleteInputAfterEncode)
             DeleteFile(m_encoderSettings.m_inputFilename);
       }
+
+      m_encoderState.m_statistics.Add(counterBytesOut, FileSize(m_encoderSettings.m_outputFilename));
+
+      if (m_useTranscodeCache && !skipMoveFile && m_encoderState.m_running)
+      {
+         m_encoderSettings.m_transcodeCache->AddOutput(m_encoderSettings.m_inputFilename,
+            m_inputContentHash, m_settingsHash, m_encoderSettings.m_outputFilename);
+      }
+
+      if (m_analyzeLoudness && m_encoderSettings.m_loudnessAlbum != nullptr)
+         m_encoderSettings.m_loudnessAlbum->AddTrack(m_encoderSettings.m_outputFilename, m_loudnessAnalyzer);
    }
 
+   m_encoderState.m_statistics.Add(counterFinishNanoseconds, NanosecondsSince(finishStartTime));
+   m_encoderState.m_statistics.Add(counterTotalNanoseconds, NanosecondsSince(startTime));
+
    // end thread
-   m_encoderState.m_running = false;
-   m_encoderState.m_paused = false;
-   m_encoderState.m_finished = true;
+   SetFinished();
+}
+
+void EncoderImpl::WaitForFinish()
+{
+   std::unique_lock<std::recursive_mutex> lock(m_mutex);
+
+   m_conditionStateChanged.wait(lock, [this]() { return !m_encoderState.m_running; });
+}
+
+void EncoderImpl::SetFinished()
+{
+   {
+      std::unique_lock<std::recursive_mutex> lock(m_mutex);
+
+      m_encoderState.m_running = false;
+      m_encoderState.m_paused = false;
+      m_encoderState.m_finished = true;
+
+      m_conditionStateChanged.notify_all();
+   }
+
+   OnEncoderStateChanged();
+}
+
+void EncoderImpl::SetPercentDone(float percentDone)
+{
+   bool changed = static_cast<int>(percentDone) != static_cast<int>(m_encoderState.m_percent);
+
+   m_encoderState.m_percent = percentDone;
+
+   if (changed)
+      OnEncoderStateChanged();
+}
+
+void EncoderImpl::WaitWhilePaused()
+{
+   std::unique_lock<std::recursive_mutex> lock(m_mutex);
+
+   m_conditionStateChanged.wait(lock,
+      [this]() { return !m_encoderState.m_paused || !m_encoderState.m_running; });
 }
 
 bool EncoderImpl::PrepareInputModule(TrackInfo& trackInfo)
 {
    // init new
    m_sampleContainer = SampleContainer();
+   m_sampleContainer.SetResamplerQuality(
+      static_cast<ResamplerQuality>(m_settingsManager->QueryValueInt(GeneralResamplerQuality)));
 
    int res = m_inputModule->InitInput(m_encoderSettings.m_inputFilename, *m_settingsManager,
       trackInfo, m_sampleContainer);
@@ -339,6 +438,66 @@ CString EncoderImpl::GetOutputFilename(const CString& outputPath, const CString&
    return outputFilename;
 }
 
+bool EncoderImpl::IsCacheableEncoding()
+{
+   if (m_encoderSettings.m_transcodeCache == nullptr)
+      return false;
+
+   // the output of CD tracks and of files with provided track info doesn't only
+   // depend on the input file, and album gain needs decoding all files of the album
+   if (m_encoderSettings.m_inputModulePrototype != nullptr ||
+      m_encoderSettings.m_useTrackInfo ||
+      m_encoderSettings.m_loudnessAlbum != nullptr)
+      return false;
+
+   // nogap encoding depends on the files encoded before and after
+   if (m_encoderSettings.m_outputModuleID == ID_OM_LAME &&
+      m_settingsManager->QueryValueInt(LameOptNoGap) == 1)
+      return false;
+
+   return m_encoderSettings.m_inputFilename.CompareNoCase(m_encoderSettings.m_outputFilename) != 0;
+}
+
+bool EncoderImpl::ReuseCachedOutput()
+{
+   m_useTranscodeCache = IsCacheableEncoding();
+   if (!m_useTranscodeCache)
+      return false;
+
+   TranscodeCache& transcodeCache = *m_encoderSettings.m_transcodeCache;
+
+   if (!transcodeCache.GetContentHash(m_encoderSettings.m_inputFilename, m_inputContentHash))
+   {
+      m_useTranscodeCache = false;
+      return false;
+   }
+
+   m_settingsHash = TranscodeCache::HashSettings(m_encoderSettings.m_outputModuleID, *m_settingsManager);
+
+   CString cachedOutputFilename;
+   if (!transcodeCache.FindOutput(m_inputContentHash, m_settingsHash, cachedOutputFilename))
+      return false;
+
+   CString outputFolder = Path::FolderName(m_encoderSettings.m_outputFilename);
+   if (!Path::FolderExists(outputFolder))
+      Path::CreateDirectoryRecursive(outputFolder);
+
+   if (!TranscodeCache::ReuseOutputFile(cachedOutputFilename, m_encoderSettings.m_outputFilename))
+      return false;
+
+   // the new output file is found by the next runs, even when the cached one is deleted
+   if (cachedOutputFilename.CompareNoCase(m_encoderSettings.m_outputFilename) != 0)
+   {
+      transcodeCache.AddOutput(m_encoderSettings.m_inputFilename,
+         m_inputContentHash, m_settingsHash, m_encoderSettings.m_outputFilename);
+   }
+
+   m_encoderState.m_statistics.Add(counterFilesFromCache, 1);
+   m_encoderState.m_percent = 100.0f;
+
+   return true;
+}
+
 bool EncoderImpl::CheckSameInputOutputFilenames(const CString& inputFilename,
    CString& outputFilename, OutputModule& outputModule)
 {
@@ -436,6 +595,13 @@ bool EncoderImpl::InitOutputModule(const CString& tempOutputFilename, const Trac
       return false;
    }
 
+   // analyze the samples in the format the output module receives them; when the
+   // analyzer doesn't support the sample rate, no gain values are stored
+   m_analyzeLoudness =
+      m_settingsManager->QueryValueInt(GeneralReplayGain) == 1 &&
+      m_loudnessAnalyzer.Init(m_sampleContainer.GetOutputModuleSampleRate(),
+         m_sampleContainer.GetOutputModuleChannels());
+
    return true;
 }
 
@@ -487,15 +653,37 @@ bool EncoderImpl::IsLossyOutputModule(int outputModuleID)
 
 bool EncoderImpl::MainLoop()
 {
+   if (m_encoderSettings.m_pipelinedEncoding)
+      return PipelinedMainLoop();
+
    bool skipFile = false;
+   bool isLastBlock = false;
 
    do
    {
-      int ret = m_inputModule->DecodeSamples(m_sampleContainer);
+      unsigned long long conversionNanoseconds = m_sampleContainer.GetConversionNanoseconds();
+      unsigned long long decodeNanoseconds = 0;
 
-      // no more samples?
+      int ret = 0;
+      {
+         StageTimer timer(decodeNanoseconds);
+         ret = m_inputModule->DecodeSamples(m_sampleContainer);
+      }
+
+      AddDecodeStatistics(ret, decodeNanoseconds,
+         m_sampleContainer.GetConversionNanoseconds() - conversionNanoseconds);
+
+      // no more samples? then encode what the resampler held back, if anything
       if (ret == 0)
-         break;
+      {
+         OnInputFinished();
+
+         ret = m_sampleContainer.FlushSamples();
+         if (ret == 0)
+            break;
+
+         isLastBlock = true;
+      }
 
       // catch errors
       if (ret < 0)
@@ -508,12 +696,85 @@ bool EncoderImpl::MainLoop()
          m_encoderState.m_errorCode = 3;
          skipFile = true;
       }
+      else if (m_analyzeLoudness)
+         m_loudnessAnalyzer.AnalyzeSamples(m_sampleContainer);
+
+      // get percent done
+      SetPercentDone(m_inputModule->PercentDone());
+
+      // stuff all samples received into output module
+      unsigned long long encodeNanoseconds = 0;
+      {
+         StageTimer timer(encodeNanoseconds);
+         ret = m_outputModule->EncodeSamples(m_sampleContainer);
+      }
+
+      m_encoderState.m_statistics.Add(counterEncodeNanoseconds, encodeNanoseconds);
+
+      // catch errors
+      if (ret < 0)
+      {
+         HandleError(m_encoderSettings.m_inputFilename, m_outputModule->GetModuleName(),
+            -ret, m_outputModule->GetLastError());
+
+         m_encoderState.m_errorCode = 4;
+         skipFile = true;
+      }
+
+      // check if we should stop the thread
+      if (!m_encoderState.m_running ||
+         skipFile ||
+         isLastBlock)
+         break;
+
+      // wait if we should pause
+      WaitWhilePaused();
+   }
+   while (true); // outer encoding loop
+
+   return skipFile;
+}
+
+bool EncoderImpl::PipelinedMainLoop()
+{
+   bool skipFile = false;
+
+   size_t numSampleBlocks = m_encoderSettings.m_numPipelineSampleBlocks > 0
+      ? m_encoderSettings.m_numPipelineSampleBlocks
+      : c_numPipelineSampleBlocks;
+
+   SampleBlockQueue queue(numSampleBlocks, m_sampleContainer);
+
+   int decodeResult = 0;
+   std::thread decoderThread([&]()
+   {
+      decodeResult = PipelinedDecodeLoop(queue);
+
+      OnInputFinished();
+   });
+
+   do
+   {
+      SampleBlock* block = queue.BeginRead();
+
+      // no more samples, or decoding error?
+      if (block == nullptr)
+         break;
 
       // get percent done
-      m_encoderState.m_percent = m_inputModule->PercentDone();
+      SetPercentDone(block->m_percentDone);
 
       // stuff all samples received into output module
-      ret = m_outputModule->EncodeSamples(m_sampleContainer);
+      unsigned long long encodeNanoseconds = 0;
+      int ret = 0;
+      {
+         StageTimer timer(encodeNanoseconds);
+         ret = m_outputModule->EncodeSamples(block->m_samples);
+      }
+
+      m_encoderState.m_statistics.Add(counterEncodeNanoseconds, encodeNanoseconds);
+
+      queue.EndRead();
 
       // catch errors
       if (ret < 0)
@@ -530,15 +791,104 @@ bool EncoderImpl::MainLoop()
          skipFile)
          break;
 
-      // sleep if we should pause
-      while (m_encoderState.m_paused)
-         Sleep(50);
+      // wait if we should pause; the decoder thread stops when the queue is full
+      WaitWhilePaused();
    }
    while (true); // outer encoding loop
 
+   queue.Cancel();
+   decoderThread.join();
+
+   // catch decoding errors
+   if (decodeResult < 0)
+   {
+      HandleError(m_encoderSettings.m_inputFilename,
+         m_inputModule->GetModuleName(),
+         -decodeResult,
+         m_inputModule->GetLastError());
+
+      m_encoderState.m_errorCode = 3;
+      skipFile = true;
+   }
+
    return skipFile;
 }
 
+int EncoderImpl::PipelinedDecodeLoop(SampleBlockQueue& queue)
+{
+   do
+   {
+      SampleBlock* block = queue.BeginWrite();
+
+      // encoding was stopped
+      if (block == nullptr)
+         return 0;
+
+      unsigned long long conversionNanoseconds = block->m_samples.GetConversionNanoseconds();
+      unsigned long long decodeNanoseconds = 0;
+
+      int ret = 0;
+      {
+         StageTimer timer(decodeNanoseconds);
+         ret = m_inputModule->DecodeSamples(block->m_samples);
+
+         // the input module reuses its buffer on the next call
+         if (ret > 0)
+            block->m_samples.ReleaseBorrowedSamples();
+      }
+
+      AddDecodeStatistics(ret, decodeNanoseconds,
+         block->m_samples.GetConversionNanoseconds() - conversionNanoseconds);
+
+      // no more samples? then pass on what the resampler held back, if anything
+      if (ret == 0 &&
+         block->m_samples.FlushSamples() > 0)
+      {
+         if (m_analyzeLoudness)
+            m_loudnessAnalyzer.AnalyzeSamples(block->m_samples);
+
+         block->m_percentDone = m_inputModule->PercentDone();
+         queue.EndWrite();
+
+         queue.CloseWrite();
+         return 0;
+      }
+
+      // no more samples, or error?
+      if (ret <= 0)
+      {
+         queue.CloseWrite();
+         return ret;
+      }
+
+      // analyzing runs on the decoder thread, since encoding usually is the slower stage
+      if (m_analyzeLoudness)
+         m_loudnessAnalyzer.AnalyzeSamples(block->m_samples);
+
+      block->m_percentDone = m_inputModule->PercentDone();
+
+      queue.EndWrite();
+   }
+   while (true);
+}
+
+void EncoderImpl::AddDecodeStatistics(int numSamples, unsigned long long decodeNanoseconds,
+   unsigned long long conversionNanoseconds)
+{
+   EncoderStatistics& statistics = m_encoderState.m_statistics;
+
+   // conversion runs inside DecodeSamples(), but is counted separately
+   statistics.Add(counterDecodeNanoseconds, decodeNanoseconds - std::min(decodeNanoseconds, conversionNanoseconds));
+   statistics.Add(counterConvertNanoseconds, conversionNanoseconds);
+
+   int samplerateInHz = m_sampleContainer.GetInputModuleSampleRate();
+   if (numSamples > 0 && samplerateInHz > 0)
+   {
+      statistics.Add(counterSamples, static_cast<unsigned long long>(numSamples));
+      statistics.Add(counterAudioMicroseconds, static_cast<unsigned long long>(numSamples) * 1000000 / samplerateInHz);
+   }
+}
+
 void EncoderImpl::WritePlaylistEntry(const CString& outputFilename)
 {
    CString playlistPathAndFilename = Path::Combine(m_encoderSettings.m_outputFolder, m_encoderSettings.m_playlistFilename);
@@ -28,8 +28,11 @@
 #include "ModuleManagerImpl.hpp"
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include "EncoderState.hpp"
 #include "EncoderSettings.hpp"
+#include "SampleBlockQueue.hpp"
+#include "LoudnessAnalyzer.hpp"
 
 namespace Encoder
 {
@@ -79,11 +82,16 @@ namespace Encoder
       {
          std::unique_lock<std::recursive_mutex> lock(m_mutex);
          m_encoderState.m_paused = !m_encoderState.m_paused;
+
+         m_conditionStateChanged.notify_all();
       }
 
       /// stops encoding
       virtual void StopEncode() override;
 
+      /// waits until the encoding thread has finished encoding; doesn't stop encoding
+      void WaitForFinish();
+
       /// creates output filename from input title (for reading CDs)
       static CString GetOutputFilenameByInputTitle(const CString& outputPath, const CString& inputTitle, const OutputModule& outputModule);
 
@@ -113,15 +121,52 @@ namespace Encoder
       /// generates temporary output filename
       void GenerateTempOutFilename(const CString& originalFilename, CString& tempFilename);
 
+      /// returns if the output of the current input file may be taken from, and stored in, the transcode cache
+      bool IsCacheableEncoding();
+
+      /// \brief provides the output file from the transcode cache, when the input file was
+      /// already encoded with the same settings
+      /// \details returns false when the output file must be encoded
+      bool ReuseCachedOutput();
+
       /// inits output module; step 2 of 2; see PrepareOutputModule()
       bool InitOutputModule(const CString& tempOutputFilename, const TrackInfo& trackInfo);
 
       /// formats encoding description
       void FormatEncodingDescription();
 
+      /// sets state to not running anymore and wakes up all waiting threads
+      void SetFinished();
+
+      /// sets percent done, and reports a change when the value in full percent has changed
+      void SetPercentDone(float percentDone);
+
+      /// \brief called on the encoder thread when encoding has started or finished, or when
+      /// the progress in full percent has changed
+      /// \details must return quickly; the default implementation does nothing
+      virtual void OnEncoderStateChanged() {}
+
+      /// \brief called when the input module has no more samples, or reading has failed
+      /// \details called on the decoder thread when encoding is pipelined; the default
+      /// implementation does nothing
+      virtual void OnInputFinished() {}
+
+      /// waits while encoding is paused; returns immediately when encoding was stopped
+      void WaitWhilePaused();
+
       /// main encoding loop; returns if file should be skipped
       bool MainLoop();
 
+      /// main encoding loop, with decoding running on a separate thread; returns if file should be skipped
+      bool PipelinedMainLoop();
+
+      /// decoding loop that fills the sample block queue; returns last DecodeSamples() result
+      int PipelinedDecodeLoop(SampleBlockQueue& queue);
+
+      /// adds decoding time, conversion time and number of decoded samples to the statistics
+      void AddDecodeStatistics(int numSamples, unsigned long long decodeNanoseconds,
+         unsigned long long conversionNanoseconds);
+
       /// writes playlist entry
       void WritePlaylistEntry(const CString& outputFilename);
 
@@ -161,9 +206,27 @@ namespace Encoder
       /// sample container
       SampleContainer m_sampleContainer;
 
+      /// loudness analyzer for the samples passed to the output module
+      LoudnessAnalyzer m_loudnessAnalyzer;
+
+      /// indicates if the loudness of the encoded samples is analyzed
+      bool m_analyzeLoudness = false;
+
+      /// indicates if the encoded output file is added to the transcode cache
+      bool m_useTranscodeCache = false;
+
+      /// content hash of the input file, when the transcode cache is used
+      unsigned long long m_inputContentHash = 0;
+
+      /// hash of the output module and its settings, when the transcode cache is used
+      unsigned long long m_settingsHash = 0;
+
       /// mutex to protect encoder state
       mutable std::recursive_mutex m_mutex;
 
+      /// condition that is signaled when the running or paused state changes; used with m_mutex
+      std::condition_variable_any m_conditionStateChanged;
+
       /// encoder worker thread
       std::unique_ptr<std::thread> m_workerThread;
    };
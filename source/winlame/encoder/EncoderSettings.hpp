@@ -23,6 +23,11 @@
 
 namespace Encoder
 {
+   class InputModule;
+   class LoudnessAlbum;
+   class TranscodeCache;
+   class WorkerPool;
+
    /// settings for the encoder
    struct EncoderSettings
    {
@@ -42,13 +47,39 @@ namespace Encoder
       /// the input file
       bool m_useTrackInfo;
 
+      /// indicates if decoding runs on a separate thread, ahead of encoding
+      bool m_pipelinedEncoding;
+
+      /// number of sample blocks decoding may run ahead of encoding, when pipelined;
+      /// 0 uses the default
+      size_t m_numPipelineSampleBlocks;
+
+      /// input module that is cloned for encoding, instead of choosing an input module
+      /// by the input filename; used for input that isn't read from a file, e.g. CD tracks
+      std::shared_ptr<InputModule> m_inputModulePrototype;
+
+      /// album that the loudness of the encoded track is added to, for calculating the
+      /// album gain; may be nullptr
+      std::shared_ptr<LoudnessAlbum> m_loudnessAlbum;
+
+      /// cache of earlier encoded output files; when the input file was already encoded
+      /// with the same settings, the output file is reused; may be nullptr
+      std::shared_ptr<TranscodeCache> m_transcodeCache;
+
+      /// pool of worker threads shared with other encoders; output modules that split up
+      /// encoding run the parts on it; may be nullptr
+      WorkerPool* m_workerPool;
+
       /// default ctor
       EncoderSettings()
          :m_outputSameFolder(false),
          m_outputModuleID(-1),
          m_overwriteExisting(false),
          m_deleteInputAfterEncode(false),
-         m_useTrackInfo(false)
+         m_useTrackInfo(false),
+         m_pipelinedEncoding(false),
+         m_numPipelineSampleBlocks(0),
+         m_workerPool(nullptr)
       {
       }
    };
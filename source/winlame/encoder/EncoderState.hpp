@@ -22,6 +22,7 @@
 #pragma once
 
 #include <atomic>
+#include "EncoderStatistics.hpp"
 
 namespace Encoder
 {
@@ -50,7 +51,8 @@ namespace Encoder
          m_finished((bool)otherState.m_finished),
          m_percent((float)otherState.m_percent),
          m_encodingDescription(otherState.m_encodingDescription),
-         m_errorCode((int)otherState.m_errorCode)
+         m_errorCode((int)otherState.m_errorCode),
+         m_statistics(otherState.m_statistics)
       {
       }
 
@@ -61,7 +63,8 @@ namespace Encoder
          m_finished((bool)otherState.m_finished),
          m_percent((float)otherState.m_percent),
          m_encodingDescription(otherState.m_encodingDescription),
-         m_errorCode((int)otherState.m_errorCode)
+         m_errorCode((int)otherState.m_errorCode),
+         m_statistics(otherState.m_statistics)
       {
       }
 
@@ -74,6 +77,7 @@ namespace Encoder
          m_percent = (float)otherState.m_percent;
          m_encodingDescription = otherState.m_encodingDescription;
          m_errorCode = (int)otherState.m_errorCode;
+         m_statistics = otherState.m_statistics;
 
          return *this;
       }
@@ -87,6 +91,7 @@ namespace Encoder
          m_percent = (float)otherState.m_percent;
          m_encodingDescription = otherState.m_encodingDescription;
          m_errorCode = (int)otherState.m_errorCode;
+         m_statistics = otherState.m_statistics;
 
          return *this;
       }
@@ -111,6 +116,9 @@ namespace Encoder
       /// negative one is a fatal error and should stop the whole encoding
       /// process
       std::atomic<int> m_errorCode;
+
+      /// timing and throughput counters
+      EncoderStatistics m_statistics;
    };
 
 } // namespace Encoder
@@ -0,0 +1,159 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file EncoderStatistics.hpp
+/// \brief timing and throughput counters of the encoder
+//
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace Encoder
+{
+   /// counters collected while encoding
+   enum EncoderCounter
+   {
+      counterInitNanoseconds = 0,   ///< time to open input and output, including reading and writing tags
+      counterDecodeNanoseconds,     ///< time in DecodeSamples(), without sample conversion
+      counterConvertNanoseconds,    ///< time converting samples in the sample container
+      counterEncodeNanoseconds,     ///< time in EncodeSamples()
+      counterFinishNanoseconds,     ///< time to flush the encoder, write tags and close and rename the output file
+      counterTotalNanoseconds,      ///< total time of encoding the file
+      counterSamples,               ///< number of decoded samples, per channel
+      counterAudioMicroseconds,     ///< duration of the decoded audio
+      counterBytesIn,               ///< size of the input file
+      counterBytesOut,              ///< size of the output file
+      counterFilesFromCache,        ///< number of output files reused from the transcode cache
+      counterMax
+   };
+
+   /// \brief timing and throughput counters of one encoding run, or of multiple runs added up
+   /// \details counters are updated by the encoder thread(s) while other threads may read them
+   struct EncoderStatistics
+   {
+      /// ctor
+      EncoderStatistics()
+      {
+         Reset();
+      }
+
+      /// copy ctor
+      EncoderStatistics(const EncoderStatistics& other)
+      {
+         *this = other;
+      }
+
+      /// assignment copy operator
+      EncoderStatistics& operator=(const EncoderStatistics& other)
+      {
+         for (size_t index = 0; index < counterMax; index++)
+            m_counters[index] = other.m_counters[index].load(std::memory_order_relaxed);
+
+         return *this;
+      }
+
+      /// sets all counters to 0
+      void Reset()
+      {
+         for (auto& counter : m_counters)
+            counter = 0;
+      }
+
+      /// returns counter value
+      unsigned long long Get(EncoderCounter counter) const
+      {
+         return m_counters[counter].load(std::memory_order_relaxed);
+      }
+
+      /// adds value to counter
+      void Add(EncoderCounter counter, unsigned long long value)
+      {
+         m_counters[counter].fetch_add(value, std::memory_order_relaxed);
+      }
+
+      /// adds all counters of other statistics, e.g. to sum up multiple tasks
+      void Add(const EncoderStatistics& other)
+      {
+         for (size_t index = 0; index < counterMax; index++)
+            Add(static_cast<EncoderCounter>(index), other.Get(static_cast<EncoderCounter>(index)));
+      }
+
+      /// returns counter value in seconds, for nanosecond counters
+      double Seconds(EncoderCounter counter) const
+      {
+         return Get(counter) / 1e9;
+      }
+
+      /// returns duration of decoded audio, in seconds
+      double AudioSeconds() const
+      {
+         return Get(counterAudioMicroseconds) / 1e6;
+      }
+
+      /// \brief returns how many times faster than realtime the audio was encoded
+      /// \details for added up statistics of multiple tasks this is the speed of a
+      /// single encoding thread, not of all threads together
+      double RealtimeFactor() const
+      {
+         unsigned long long totalNanoseconds = Get(counterTotalNanoseconds);
+         return totalNanoseconds == 0 ? 0.0 : AudioSeconds() / (totalNanoseconds / 1e9);
+      }
+
+   private:
+      /// all counter values
+      std::array<std::atomic<unsigned long long>, counterMax> m_counters;
+   };
+
+   /// returns nanoseconds elapsed since given start time
+   inline unsigned long long NanosecondsSince(std::chrono::steady_clock::time_point start)
+   {
+      return static_cast<unsigned long long>(
+         std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+   }
+
+   /// measures the time from construction to destruction and adds it to a nanoseconds counter
+   class StageTimer
+   {
+   public:
+      /// ctor; starts measuring
+      explicit StageTimer(unsigned long long& nanoseconds)
+         :m_nanoseconds(nanoseconds),
+         m_start(std::chrono::steady_clock::now())
+      {
+      }
+
+      /// dtor; adds elapsed time to counter
+      ~StageTimer()
+      {
+         m_nanoseconds += NanosecondsSince(m_start);
+      }
+
+      StageTimer(const StageTimer&) = delete;
+      StageTimer& operator=(const StageTimer&) = delete;
+
+   private:
+      /// counter to add time to
+      unsigned long long& m_nanoseconds;
+
+      /// start time
+      std::chrono::steady_clock::time_point m_start;
+   };
+
+} // namespace Encoder
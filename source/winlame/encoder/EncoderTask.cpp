@@ -21,6 +21,7 @@
 //
 #include "stdafx.h"
 #include "EncoderTask.hpp"
+#include "CDReadInputModule.hpp"
 
 using Encoder::EncoderTask;
 using Encoder::EncoderTaskSettings;
@@ -54,6 +55,14 @@ CString EncoderTask::GenerateOutputFilename(const CString& inputTitle)
    return EncoderImpl::GetEncoderSettings().m_outputFilename;
 }
 
+int EncoderTask::CDDrive() const
+{
+   const CDReadInputModule* cdReadInputModule =
+      dynamic_cast<const CDReadInputModule*>(m_settings.m_inputModulePrototype.get());
+
+   return cdReadInputModule != nullptr ? static_cast<int>(cdReadInputModule->CDDrive()) : -1;
+}
+
 TaskInfo EncoderTask::GetTaskInfo()
 {
    TaskInfo info(Id(), TaskInfo::taskEncoding);
@@ -72,6 +81,8 @@ TaskInfo EncoderTask::GetTaskInfo()
 
    info.Progress(static_cast<unsigned int>(encoderState.m_percent));
 
+   info.Statistics(encoderState.m_statistics);
+
    return info;
 }
 
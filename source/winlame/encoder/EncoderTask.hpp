@@ -69,7 +69,20 @@ namespace Encoder
       /// generates output filename for this task
       CString GenerateOutputFilename(const CString& inputTitle);
 
+      /// returns the CD drive the input is read from, or -1 when not reading directly from CD
+      virtual int CDDrive() const override;
+
+      /// returns if this task reads its input directly from CD
+      bool IsReadingCD() const { return CDDrive() >= 0; }
+
    private:
+      /// publishes the task info when encoding has started, finished or progressed
+      virtual void OnEncoderStateChanged() override { PublishTaskInfo(); }
+
+      /// releases the CD drive when reading from CD, so that the next track can be read
+      /// while this track is still being encoded
+      virtual void OnInputFinished() override { ReleaseCDDrive(); }
+
       /// checks errors and adds error texts from error handler to task result
       void CheckErrors();
 
@@ -22,10 +22,7 @@
 //
 #include "stdafx.h"
 #include "resource.h"
-#include <fstream>
 #include "FlacInputModule.hpp"
-#include <sys/types.h>
-#include <sys/stat.h>
 #include "FLAC/metadata.h"
 #include <ulib/DynamicLibrary.hpp>
 #include "AudioFileTag.hpp"
@@ -35,12 +32,70 @@ using Encoder::TrackInfo;
 using Encoder::SampleContainer;
 using Encoder::FLAC_context;
 
-// constants
+// callbacks
+
+static FLAC__StreamDecoderReadStatus FLAC_ReadCallback(
+   const FLAC__StreamDecoder* decoder,
+   FLAC__byte buffer[],
+   size_t* bytes,
+   void* clientData)
+{
+   FLAC_context* context = (FLAC_context*)clientData;
 
-/// frame size; default = 4608
-const unsigned int m_flacFrameSize = 576;
+   if (*bytes == 0)
+      return FLAC__STREAM_DECODER_READ_STATUS_ABORT;
 
-// callbacks
+   *bytes = context->inputSource->Read(buffer, *bytes);
+
+   return *bytes == 0
+      ? FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM
+      : FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+}
+
+static FLAC__StreamDecoderSeekStatus FLAC_SeekCallback(
+   const FLAC__StreamDecoder* decoder,
+   FLAC__uint64 absoluteByteOffset,
+   void* clientData)
+{
+   FLAC_context* context = (FLAC_context*)clientData;
+
+   return context->inputSource->Seek(static_cast<long long>(absoluteByteOffset), SEEK_SET)
+      ? FLAC__STREAM_DECODER_SEEK_STATUS_OK
+      : FLAC__STREAM_DECODER_SEEK_STATUS_ERROR;
+}
+
+static FLAC__StreamDecoderTellStatus FLAC_TellCallback(
+   const FLAC__StreamDecoder* decoder,
+   FLAC__uint64* absoluteByteOffset,
+   void* clientData)
+{
+   FLAC_context* context = (FLAC_context*)clientData;
+
+   *absoluteByteOffset = context->inputSource->Position();
+
+   return FLAC__STREAM_DECODER_TELL_STATUS_OK;
+}
+
+static FLAC__StreamDecoderLengthStatus FLAC_LengthCallback(
+   const FLAC__StreamDecoder* decoder,
+   FLAC__uint64* streamLength,
+   void* clientData)
+{
+   FLAC_context* context = (FLAC_context*)clientData;
+
+   *streamLength = context->inputSource->Length();
+
+   return FLAC__STREAM_DECODER_LENGTH_STATUS_OK;
+}
+
+static FLAC__bool FLAC_EofCallback(
+   const FLAC__StreamDecoder* decoder,
+   void* clientData)
+{
+   FLAC_context* context = (FLAC_context*)clientData;
+
+   return context->inputSource->IsEndOfFile();
+}
 
 static FLAC__StreamDecoderWriteStatus FLAC_WriteCallback(
    const FLAC__StreamDecoder* decoder,
@@ -50,24 +105,21 @@ static FLAC__StreamDecoderWriteStatus FLAC_WriteCallback(
 {
    FLAC_context* context = (FLAC_context*)clientData;
 
-   const unsigned numChannels = context->streamInfo.channels;
    const unsigned wide_samples = frame->header.blocksize;
-   unsigned wide_sample, sample, channel;
 
-   if (context->abortFlag)
+   if (context->abortFlag ||
+      context->samples == nullptr)
       return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
 
-   for (sample = context->numSamplesInReservoir * numChannels, wide_sample = 0;
-      wide_sample < wide_samples;
-      wide_sample++)
-   {
-      for (channel = 0; channel < numChannels; channel++, sample++)
-      {
-         context->reservoir[sample] = buffer[channel][wide_sample];
-      }
-   }
+   // DecodeSamples() decodes exactly one frame per call
+   ATLASSERT(context->numSamplesDecoded == 0);
+
+   // FLAC delivers samples right-aligned in 32 bit; they are aligned and converted
+   // to the output module's format in one pass, straight from the decoder's buffers
+   context->samples->PutSamplesArrayLowBits(buffer,
+      context->streamInfo.bits_per_sample, wide_samples);
 
-   context->numSamplesInReservoir += wide_samples;
+   context->numSamplesDecoded = wide_samples;
 
    return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 }
@@ -168,50 +220,11 @@ static void FLAC_ErrorCallback(const FLAC__StreamDecoder* decoder,
       context->abortFlag = true;
 }
 
-/// pack function to store sample data in byte array
-unsigned FLAC__pack_pcm_signed_little_endian(FLAC__byte* data, FLAC__int32* input,
-   unsigned wide_samples, unsigned numChannels, unsigned sourceBitsPerSample)
-{
-   FLAC__byte* const start = data;
-   unsigned samples = wide_samples * numChannels;
-   const unsigned bytesPerSample = sourceBitsPerSample / 8;
-
-   while (samples--)
-   {
-      FLAC__int32 sample = *input++;
-
-      switch (sourceBitsPerSample)
-      {
-      case 8:
-         data[0] = static_cast<FLAC__byte>(sample ^ 0x80);
-         break;
-      case 24:
-         data[2] = (FLAC__byte)(sample >> 16);
-         data[1] = (FLAC__byte)(sample >> 8);
-         data[0] = (FLAC__byte)sample;
-         break;
-      case 16:
-         data[1] = (FLAC__byte)(sample >> 8);
-         data[0] = (FLAC__byte)sample;
-         break;
-      default:
-         ATLASSERT(false); // invalid bits per sample
-         break;
-      }
-
-      data += bytesPerSample;
-   }
-
-   return data - start;
-}
-
-
 FlacInputModule::FlacInputModule()
    :m_fileLength(0),
    m_flacDecoder(nullptr),
    m_flacContext(nullptr),
-   m_samplePosition(0),
-   m_pcmBufferLength(0)
+   m_samplePosition(0)
 {
    m_moduleId = ID_IM_FLAC;
 }
@@ -270,21 +283,28 @@ int FlacInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
 {
    ReadTrackMetadata(infilename, trackinfo);
 
+   if (!m_inputSource.Open(infilename))
+   {
+      m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
+      return -1;
+   }
+
    // find out length of file
-   struct _stat statbuf;
-   ::_tstat(infilename, &statbuf);
-   m_fileLength = statbuf.st_size; // 32 bit max.
+   m_fileLength = static_cast<unsigned long>(m_inputSource.Length()); // 32 bit max.
 
    m_flacContext = new FLAC_context;
-   memset((void*)m_flacContext, 0, sizeof(FLAC_context));
    //m_flacContext->trackInfo = &trackinfo;
+   m_flacContext->inputSource = &m_inputSource;
 
    m_flacDecoder = FLAC__stream_decoder_new();
 
    // open stream
-   CStringA ansiFilename(GetAnsiCompatFilename(infilename));
-   FLAC__StreamDecoderInitStatus initStatus = FLAC__stream_decoder_init_file(m_flacDecoder,
-      ansiFilename,
+   FLAC__StreamDecoderInitStatus initStatus = FLAC__stream_decoder_init_stream(m_flacDecoder,
+      FLAC_ReadCallback,
+      FLAC_SeekCallback,
+      FLAC_TellCallback,
+      FLAC_LengthCallback,
+      FLAC_EofCallback,
       FLAC_WriteCallback,
       FLAC_MetadataCallback,
       FLAC_ErrorCallback,
@@ -305,13 +325,14 @@ int FlacInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    m_samplePosition = 0;
    m_flacContext->totalLengthInMs =
       static_cast<unsigned int>(m_flacContext->streamInfo.total_samples * 1000 / m_flacContext->streamInfo.sample_rate);
-   m_pcmBufferLength = (m_flacFrameSize * m_flacContext->streamInfo.channels * m_flacContext->streamInfo.bits_per_sample);
-   m_flacContext->reservoir = new FLAC__int32[m_flacContext->streamInfo.max_blocksize * m_flacContext->streamInfo.channels * 2];
 
-   m_inputBuffer.resize(m_pcmBufferLength);
+   // samples are reported as 8, 16 or 32 bit integers; 24 bit samples are reported
+   // as 32 bit, since the write callback aligns all samples to 32 bit anyway
+   unsigned int bitsPerSample = m_flacContext->streamInfo.bits_per_sample;
+   int containerBitsPerSample = bitsPerSample <= 8 ? 8 : bitsPerSample <= 16 ? 16 : 32;
 
    // set up input traits
-   samplecont.SetInputModuleTraits(m_flacContext->streamInfo.bits_per_sample, SamplesChannelArray,
+   samplecont.SetInputModuleTraits(containerBitsPerSample, SamplesChannelArray,
       m_flacContext->streamInfo.sample_rate, m_flacContext->streamInfo.channels);
 
    return 0;
@@ -327,37 +348,31 @@ void FlacInputModule::GetInfo(int& numChannels, int& bitrateInBps, int& lengthIn
 
 int FlacInputModule::DecodeSamples(SampleContainer& samples)
 {
-   while (m_flacContext->numSamplesInReservoir < m_flacFrameSize)
+   // the write callback stores a single frame in the sample container, as a whole
+   m_flacContext->samples = &samples;
+   m_flacContext->numSamplesDecoded = 0;
+
+   while (m_flacContext->numSamplesDecoded == 0)
    {
       if (FLAC__stream_decoder_get_state(m_flacDecoder) == FLAC__STREAM_DECODER_END_OF_STREAM)
       {
          return 0;
       }
-      else if (!FLAC__stream_decoder_process_single(m_flacDecoder))
+      else if (!FLAC__stream_decoder_process_single(m_flacDecoder) ||
+         m_flacContext->abortFlag)
       {
-         return 0;
+         // a decoder error must not end the file as if it were complete
+         m_lastError.LoadString(IDS_ENCODER_INTERNAL_DECODE_ERROR);
+         m_lastError.AppendFormat(_T(" (%hs)"),
+            FLAC__StreamDecoderStateString[FLAC__stream_decoder_get_state(m_flacDecoder)]);
+         return -1;
       }
    }
 
-   unsigned int numSamples = std::min(m_flacContext->numSamplesInReservoir, m_flacFrameSize);
-
-   FLAC__pack_pcm_signed_little_endian(
-      (unsigned char*)m_inputBuffer.data(),
-      m_flacContext->reservoir,
-      numSamples,
-      m_flacContext->streamInfo.channels,
-      m_flacContext->streamInfo.bits_per_sample);
-
-   unsigned int delta = numSamples * m_flacContext->streamInfo.channels;
-   for (unsigned int i = delta; i < m_flacContext->numSamplesInReservoir * m_flacContext->streamInfo.channels; i++)
-      m_flacContext->reservoir[i - delta] = m_flacContext->reservoir[i];
+   unsigned int numSamples = m_flacContext->numSamplesDecoded;
 
-   m_flacContext->numSamplesInReservoir -= numSamples;
    m_samplePosition += numSamples;
 
-   // copy the samples to the sample container
-   samples.PutSamplesInterleaved(m_inputBuffer.data(), numSamples);
-
    return numSamples;
 }
 
@@ -378,14 +393,11 @@ void FlacInputModule::DoneInput()
 
    if (m_flacContext)
    {
-      if (m_flacContext->reservoir)
-         delete[] m_flacContext->reservoir;
-
-      m_flacContext->reservoir = nullptr;
-
       delete m_flacContext;
       m_flacContext = nullptr;
    }
+
+   m_inputSource.Close();
 }
 
 void FlacInputModule::ReadTrackMetadata(LPCTSTR filename, TrackInfo& trackInfo)
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
+#include "InputSource.hpp"
 #include "FLAC/stream_decoder.h"
 
 namespace Encoder
@@ -31,19 +32,21 @@ namespace Encoder
    struct FLAC_context
    {
       FLAC__StreamMetadata_StreamInfo streamInfo;  ///< stream info
-      FLAC__int32* reservoir;                      ///< reservoir
-      unsigned int numSamplesInReservoir;          ///< number of samples in reservoir
+      SampleContainer* samples;                    ///< container to store decoded samples; set by DecodeSamples()
+      unsigned int numSamplesDecoded;              ///< number of samples stored by the last write callback
       unsigned int totalLengthInMs;                ///< total length in ms
       bool abortFlag;                              ///< abort flag
       TrackInfo* trackInfo;                        ///< track info
+      InputSource* inputSource;                    ///< input source to read from
 
       /// ctor
       FLAC_context()
-         :reservoir(nullptr),
-         numSamplesInReservoir(0),
+         :samples(nullptr),
+         numSamplesDecoded(0),
          totalLengthInMs(0),
          abortFlag(false),
-         trackInfo(nullptr)
+         trackInfo(nullptr),
+         inputSource(nullptr)
       {
          memset(&streamInfo, 0, sizeof(streamInfo));
       }
@@ -100,6 +103,9 @@ namespace Encoder
       /// length of input file
       unsigned long m_fileLength;
 
+      /// input source
+      InputSource m_inputSource;
+
       /// last error occured
       CString m_lastError;
 
@@ -109,14 +115,8 @@ namespace Encoder
       /// flac context
       FLAC_context* m_flacContext;
 
-      /// input buffer
-      std::vector<FLAC__int32> m_inputBuffer;
-
       /// sample position
       FLAC__uint64 m_samplePosition;
-
-      /// buffer length
-      unsigned int m_pcmBufferLength;
    };
 
 } // namespace Encoder
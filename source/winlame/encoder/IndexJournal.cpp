@@ -0,0 +1,168 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file IndexJournal.cpp
+/// \brief text file with index records that are appended when added
+//
+#include "stdafx.h"
+#include "IndexJournal.hpp"
+#include <ulib/UTF8.hpp>
+
+using Encoder::FileStamp;
+using Encoder::IndexJournal;
+
+bool FileStamp::Read(const CString& filename, FileStamp& stamp)
+{
+   WIN32_FILE_ATTRIBUTE_DATA data = {};
+   if (!GetFileAttributesEx(filename, GetFileExInfoStandard, &data) ||
+      (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+      return false;
+
+   stamp.m_size = (static_cast<unsigned long long>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+   stamp.m_lastWriteTime = (static_cast<unsigned long long>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+      data.ftLastWriteTime.dwLowDateTime;
+
+   return true;
+}
+
+IndexJournal::IndexJournal(const CString& filename, const CStringA& header)
+   :m_filename(filename),
+   m_header(header)
+{
+}
+
+bool IndexJournal::Read(T_fnOnRecord fnOnRecord, size_t& numRecords, bool& hasCurrentFormat) const
+{
+   numRecords = 0;
+   hasCurrentFormat = false;
+
+   std::vector<char> data;
+   {
+      FILE* fd = _tfopen(m_filename, _T("rb"));
+      if (fd == nullptr)
+      {
+         // a missing file is a new journal
+         hasCurrentFormat = true;
+         return GetFileAttributes(m_filename) == INVALID_FILE_ATTRIBUTES;
+      }
+
+      char buffer[4096];
+      size_t length;
+      while ((length = fread(buffer, 1, sizeof(buffer), fd)) > 0)
+         data.insert(data.end(), buffer, buffer + length);
+
+      fclose(fd);
+   }
+
+   bool isFirstLine = true;
+
+   size_t lineStart = 0;
+   while (lineStart < data.size())
+   {
+      size_t lineEnd = lineStart;
+      while (lineEnd < data.size() && data[lineEnd] != '\n')
+         lineEnd++;
+
+      std::string utf8Line(data.data() + lineStart, lineEnd - lineStart);
+      if (!utf8Line.empty() && utf8Line.back() == '\r')
+         utf8Line.pop_back();
+
+      lineStart = lineEnd + 1;
+
+      if (isFirstLine)
+      {
+         // a file with another format has no usable records
+         hasCurrentFormat = m_header == utf8Line.c_str();
+         if (!hasCurrentFormat)
+            break;
+
+         isFirstLine = false;
+         continue;
+      }
+
+      numRecords++;
+      fnOnRecord(SplitFields(UTF8ToString(utf8Line.c_str())));
+   }
+
+   // an empty file is a new journal
+   if (data.empty())
+      hasCurrentFormat = true;
+
+   return true;
+}
+
+void IndexJournal::Append(const CString& lines)
+{
+   FILE* fd = _tfopen(m_filename, _T("ab"));
+   if (fd == nullptr)
+      return;
+
+   fseek(fd, 0, SEEK_END);
+   if (ftell(fd) == 0)
+   {
+      fputs(m_header, fd);
+      fputs("\n", fd);
+   }
+
+   std::vector<char> utf8Buffer;
+   StringToUTF8(lines, utf8Buffer);
+
+   fputs(utf8Buffer.data(), fd);
+   fclose(fd);
+}
+
+bool IndexJournal::Rewrite(const CString& lines)
+{
+   CString tempFilename = m_filename + _T(".temp");
+
+   FILE* fd = _tfopen(tempFilename, _T("wb"));
+   if (fd == nullptr)
+      return false;
+
+   std::vector<char> utf8Buffer;
+   StringToUTF8(lines, utf8Buffer);
+
+   bool isError = fputs(m_header, fd) < 0;
+   isError = fputs("\n", fd) < 0 || isError;
+   isError = fputs(utf8Buffer.data(), fd) < 0 || isError;
+   isError = fclose(fd) != 0 || isError;
+
+   if (isError)
+   {
+      DeleteFile(tempFilename);
+      return false;
+   }
+
+   return MoveFileEx(tempFilename, m_filename, MOVEFILE_REPLACE_EXISTING) != FALSE;
+}
+
+std::vector<CString> IndexJournal::SplitFields(const CString& line)
+{
+   std::vector<CString> fields;
+
+   int start = 0;
+   for (int pos = line.Find(_T('\t')); pos != -1; pos = line.Find(_T('\t'), start))
+   {
+      fields.push_back(line.Mid(start, pos - start));
+      start = pos + 1;
+   }
+
+   fields.push_back(line.Mid(start));
+
+   return fields;
+}
@@ -0,0 +1,92 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file IndexJournal.hpp
+/// \brief text file with index records that are appended when added
+//
+#pragma once
+
+#include <functional>
+#include <vector>
+
+namespace Encoder
+{
+   /// size and last write time of a file
+   struct FileStamp
+   {
+      /// file size, in bytes
+      unsigned long long m_size = 0;
+
+      /// last write time, as FILETIME value
+      unsigned long long m_lastWriteTime = 0;
+
+      /// compares file stamps
+      bool operator==(const FileStamp& other) const
+      {
+         return m_size == other.m_size && m_lastWriteTime == other.m_lastWriteTime;
+      }
+
+      /// reads size and last write time of a file; returns false when the file doesn't exist
+      static bool Read(const CString& filename, FileStamp& stamp);
+   };
+
+   /// \brief UTF-8 text file with one index record per line
+   /// \details The first line contains a header that identifies the file format. Each
+   /// record consists of tab separated fields. New records are appended to the end of
+   /// the file as soon as they are known, so that nothing is lost when the application
+   /// is ended while working; later records replace earlier ones. Since the file grows
+   /// with every change, the owner rewrites it with only the current records when most
+   /// records are outdated.
+   class IndexJournal
+   {
+   public:
+      /// function type that is called with the fields of a record
+      typedef std::function<void(const std::vector<CString>& fields)> T_fnOnRecord;
+
+      /// ctor; takes the filename and the header line, without line ending
+      IndexJournal(const CString& filename, const CStringA& header);
+
+      /// \brief reads all records and returns the number of records read
+      /// \details a missing file or a file with another header has no records; returns
+      /// false when the file exists but can't be read
+      bool Read(T_fnOnRecord fnOnRecord, size_t& numRecords, bool& hasCurrentFormat) const;
+
+      /// appends lines with records to the file; the header is written to a new file
+      void Append(const CString& lines);
+
+      /// replaces the whole file with the header and given lines with records
+      bool Rewrite(const CString& lines);
+
+      /// returns if a journal with given number of records should be rewritten
+      static bool IsRewriteNeeded(size_t numRecords, size_t numCurrentRecords)
+      {
+         return numRecords > 2 * numCurrentRecords + 100;
+      }
+
+      /// splits a line into tab separated fields
+      static std::vector<CString> SplitFields(const CString& line);
+
+   private:
+      /// journal filename
+      CString m_filename;
+
+      /// header line
+      CStringA m_header;
+   };
+
+} // namespace Encoder
@@ -51,7 +51,7 @@ namespace Encoder
       virtual void GetInfo(int& numChannels, int& bitrateInBps, int& lengthInSeconds, int& samplerateInHz) const = 0;
 
       /// \brief decodes samples and stores them in the sample container
-      /// \details returns number of samples decoded, or 0 if finished
+      /// \details returns number of samples decoded per channel, or 0 if finished;
       /// a negative value indicates an error
       virtual int DecodeSamples(SampleContainer& samples) = 0;
 
@@ -0,0 +1,309 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file InputSource.cpp
+/// \brief input source that input modules read encoded data from
+//
+#include "stdafx.h"
+#include "InputSource.hpp"
+#include <cstdio>
+
+using Encoder::InputSource;
+
+/// memory range for PrefetchVirtualMemory(); same layout as WIN32_MEMORY_RANGE_ENTRY
+struct MemoryRangeEntry
+{
+   PVOID VirtualAddress; ///< start address
+   SIZE_T NumberOfBytes; ///< number of bytes
+};
+
+/// function type of PrefetchVirtualMemory(), which is only available since Windows 8
+typedef BOOL(WINAPI* T_fnPrefetchVirtualMemory)(HANDLE process,
+   ULONG_PTR numEntries, MemoryRangeEntry* virtualAddresses, ULONG flags);
+
+InputSource::~InputSource()
+{
+   Close();
+}
+
+bool InputSource::Open(LPCTSTR filename, bool useMapping)
+{
+   Close();
+
+   m_fileHandle = ::CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+   if (m_fileHandle == INVALID_HANDLE_VALUE)
+      return false;
+
+   LARGE_INTEGER fileSize = {};
+   if (!::GetFileSizeEx(m_fileHandle, &fileSize))
+   {
+      Close();
+      return false;
+   }
+
+   m_length = static_cast<unsigned long long>(fileSize.QuadPart);
+   m_position = 0;
+
+   // empty files can't be mapped
+   if (useMapping && m_length > 0 && IsLocalFile(filename))
+      m_mappingHandle = ::CreateFileMapping(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+   if (m_mappingHandle == nullptr)
+      m_buffer.resize(c_readAheadBufferSize);
+
+   return true;
+}
+
+void InputSource::Close()
+{
+   if (m_window != nullptr)
+      ::UnmapViewOfFile(m_window);
+
+   if (m_mappingHandle != nullptr)
+      ::CloseHandle(m_mappingHandle);
+
+   if (m_fileHandle != INVALID_HANDLE_VALUE)
+      ::CloseHandle(m_fileHandle);
+
+   m_fileHandle = INVALID_HANDLE_VALUE;
+   m_mappingHandle = nullptr;
+   m_length = 0;
+   m_position = 0;
+
+   m_window = nullptr;
+   m_windowPosition = 0;
+   m_windowLength = 0;
+   m_prefetchPosition = 0;
+
+   std::vector<unsigned char>().swap(m_buffer);
+   m_bufferPosition = 0;
+   m_bufferLength = 0;
+}
+
+size_t InputSource::Read(void* buffer, size_t size)
+{
+   unsigned char* destination = static_cast<unsigned char*>(buffer);
+
+   size_t numRead = 0;
+   while (numRead < size)
+   {
+      size_t available = 0;
+      const unsigned char* data = Peek(size - numRead, available);
+      if (data == nullptr)
+         break;
+
+      size_t copyLength = std::min(available, size - numRead);
+      memcpy(destination + numRead, data, copyLength);
+
+      Skip(copyLength);
+      numRead += copyLength;
+   }
+
+   return numRead;
+}
+
+bool InputSource::Seek(long long offset, int origin)
+{
+   long long basePosition = 0;
+   switch (origin)
+   {
+   case SEEK_SET:
+      basePosition = 0;
+      break;
+
+   case SEEK_CUR:
+      basePosition = static_cast<long long>(m_position);
+      break;
+
+   case SEEK_END:
+      basePosition = static_cast<long long>(m_length);
+      break;
+
+   default:
+      ATLASSERT(false);
+      return false;
+   }
+
+   long long newPosition = basePosition + offset;
+   if (newPosition < 0)
+      return false;
+
+   // when jumping to another position, only prefetch again when the decoder continues
+   // reading from there; decoders often seek around while reading headers
+   if (static_cast<unsigned long long>(newPosition) != m_position)
+      m_prefetchPosition = static_cast<unsigned long long>(newPosition) + c_prefetchSize;
+
+   m_position = static_cast<unsigned long long>(newPosition);
+
+   return true;
+}
+
+const unsigned char* InputSource::Peek(size_t minSize, size_t& available)
+{
+   available = 0;
+
+   if (!IsOpen() || IsEndOfFile())
+      return nullptr;
+
+   size_t neededSize = static_cast<size_t>(
+      std::min<unsigned long long>(std::min<size_t>(minSize, size_t(c_readAheadBufferSize)), m_length - m_position));
+
+   if (IsMapped())
+   {
+      if (m_window == nullptr ||
+         m_position < m_windowPosition ||
+         m_position + neededSize > m_windowPosition + m_windowLength)
+      {
+         if (!MapWindow())
+            return nullptr;
+
+         ATLASSERT(m_position + neededSize <= m_windowPosition + m_windowLength);
+      }
+
+      Prefetch();
+
+      available = static_cast<size_t>(m_windowPosition + m_windowLength - m_position);
+      return m_window + (m_position - m_windowPosition);
+   }
+
+   if (m_position < m_bufferPosition ||
+      m_position + neededSize > m_bufferPosition + m_bufferLength)
+   {
+      if (!FillBuffer() || m_bufferLength == 0)
+         return nullptr;
+   }
+
+   available = static_cast<size_t>(m_bufferPosition + m_bufferLength - m_position);
+   return m_buffer.data() + (m_position - m_bufferPosition);
+}
+
+bool InputSource::IsLocalFile(LPCTSTR filename)
+{
+   // a mapped file that can't be paged in, e.g. when the network connection is
+   // lost, raises an exception in the decoder, so only map files on fixed drives
+   TCHAR volumePath[MAX_PATH] = {};
+   if (!::GetVolumePathName(filename, volumePath, MAX_PATH))
+      return false;
+
+   return ::GetDriveType(volumePath) == DRIVE_FIXED;
+}
+
+bool InputSource::MapWindow()
+{
+   if (m_window != nullptr)
+   {
+      ::UnmapViewOfFile(m_window);
+      m_window = nullptr;
+   }
+
+   static const DWORD allocationGranularity = []()
+   {
+      SYSTEM_INFO systemInfo = {};
+      ::GetSystemInfo(&systemInfo);
+      return systemInfo.dwAllocationGranularity;
+   }();
+
+   // views must start at a multiple of the allocation granularity
+   unsigned long long windowPosition = m_position - m_position % allocationGranularity;
+   size_t windowLength = static_cast<size_t>(
+      std::min<unsigned long long>(c_mappingWindowSize, m_length - windowPosition));
+
+   void* view = ::MapViewOfFile(m_mappingHandle, FILE_MAP_READ,
+      static_cast<DWORD>(windowPosition >> 32),
+      static_cast<DWORD>(windowPosition & 0xffffffff),
+      windowLength);
+
+   if (view == nullptr)
+      return false;
+
+   m_window = static_cast<const unsigned char*>(view);
+   m_windowPosition = windowPosition;
+   m_windowLength = windowLength;
+
+   return true;
+}
+
+bool InputSource::FillBuffer()
+{
+   // keep the data after the read position that is already in the buffer
+   size_t keepLength = 0;
+   if (m_position >= m_bufferPosition &&
+      m_position < m_bufferPosition + m_bufferLength)
+   {
+      size_t keepOffset = static_cast<size_t>(m_position - m_bufferPosition);
+      keepLength = m_bufferLength - keepOffset;
+
+      memmove(m_buffer.data(), m_buffer.data() + keepOffset, keepLength);
+   }
+
+   m_bufferPosition = m_position;
+   m_bufferLength = keepLength;
+
+   LARGE_INTEGER filePosition = {};
+   filePosition.QuadPart = static_cast<LONGLONG>(m_bufferPosition + keepLength);
+
+   if (!::SetFilePointerEx(m_fileHandle, filePosition, nullptr, FILE_BEGIN))
+      return false;
+
+   while (m_bufferLength < m_buffer.size())
+   {
+      DWORD numRead = 0;
+      if (!::ReadFile(m_fileHandle, m_buffer.data() + m_bufferLength,
+         static_cast<DWORD>(m_buffer.size() - m_bufferLength), &numRead, nullptr))
+         return false;
+
+      if (numRead == 0)
+         break;
+
+      m_bufferLength += numRead;
+   }
+
+   return true;
+}
+
+void InputSource::Prefetch()
+{
+   // prefetch the next range when the read position has passed half of the last prefetched range
+   if (m_position + c_prefetchSize / 2 < m_prefetchPosition)
+      return;
+
+   unsigned long long startPosition = std::max(m_position, m_prefetchPosition);
+   unsigned long long endPosition = std::min(startPosition + c_prefetchSize, m_windowPosition + m_windowLength);
+
+   if (startPosition >= endPosition)
+      return;
+
+   static const T_fnPrefetchVirtualMemory fnPrefetchVirtualMemory =
+      reinterpret_cast<T_fnPrefetchVirtualMemory>(
+         ::GetProcAddress(::GetModuleHandle(_T("kernel32.dll")), "PrefetchVirtualMemory"));
+
+   if (fnPrefetchVirtualMemory != nullptr)
+   {
+      MemoryRangeEntry range =
+      {
+         const_cast<unsigned char*>(m_window + (startPosition - m_windowPosition)),
+         static_cast<SIZE_T>(endPosition - startPosition)
+      };
+
+      fnPrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+   }
+
+   m_prefetchPosition = endPosition;
+}
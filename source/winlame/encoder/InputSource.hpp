@@ -0,0 +1,146 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file InputSource.hpp
+/// \brief input source that input modules read encoded data from
+//
+#pragma once
+
+#include <vector>
+
+namespace Encoder
+{
+   /// \brief input source for reading encoded data from a file
+   /// \details Files on local drives are read through a file mapping; a window of
+   /// the file is mapped into memory and moved along while reading, so that large
+   /// files don't need a large address space. Other files, e.g. on network drives,
+   /// where paging in can fail, are read into a large read-ahead buffer. Decoders
+   /// can either copy data with Read(), or decode directly from the data returned
+   /// by Peek() and then Skip() the consumed bytes. Seek() and Read() follow the
+   /// semantics of the C runtime file functions, so they can be used to implement
+   /// the read callbacks of the various decoder libraries.
+   class InputSource
+   {
+   public:
+      /// ctor
+      InputSource() = default;
+
+      /// dtor; closes input source
+      ~InputSource();
+
+      /// deleted copy ctor
+      InputSource(const InputSource&) = delete;
+
+      /// deleted copy assignment operator
+      InputSource& operator=(const InputSource&) = delete;
+
+      /// opens file for reading; when useMapping is false, the file is never mapped
+      bool Open(LPCTSTR filename, bool useMapping = true);
+
+      /// closes file
+      void Close();
+
+      /// returns if a file is opened
+      bool IsOpen() const { return m_fileHandle != INVALID_HANDLE_VALUE; }
+
+      /// returns if the file is read through a file mapping
+      bool IsMapped() const { return m_mappingHandle != nullptr; }
+
+      /// returns length of file, in bytes
+      unsigned long long Length() const { return m_length; }
+
+      /// returns current read position
+      unsigned long long Position() const { return m_position; }
+
+      /// returns if the read position is at or after the end of the file
+      bool IsEndOfFile() const { return m_position >= m_length; }
+
+      /// reads data at current position; returns number of bytes read, or 0 at end of file
+      size_t Read(void* buffer, size_t size);
+
+      /// seeks to new position, relative to origin SEEK_SET, SEEK_CUR or SEEK_END; returns false on errors
+      bool Seek(long long offset, int origin);
+
+      /// \brief returns data at the current read position, without advancing the position
+      /// \details at least minSize bytes are available, up to the read-ahead buffer
+      /// size, except when the end of the file is reached; returns nullptr at the end
+      /// of the file or on errors. The data stays valid until the next call to a
+      /// method other than Skip().
+      const unsigned char* Peek(size_t minSize, size_t& available);
+
+      /// advances read position, e.g. after decoding data returned by Peek()
+      void Skip(size_t numBytes) { m_position += numBytes; }
+
+      /// size of read-ahead buffer; also the maximum number of bytes Peek() guarantees
+      static const size_t c_readAheadBufferSize = 1024 * 1024;
+
+      /// size of a mapped window of the file
+      static const size_t c_mappingWindowSize = 32 * 1024 * 1024;
+
+      /// number of bytes in front of the read position that are prefetched from a mapped file
+      static const size_t c_prefetchSize = 4 * 1024 * 1024;
+
+   private:
+      /// returns if the file is on a local fixed drive and can safely be mapped
+      static bool IsLocalFile(LPCTSTR filename);
+
+      /// maps a new window of the file, starting at or shortly before the current position
+      bool MapWindow();
+
+      /// refills the read-ahead buffer, starting at the current position
+      bool FillBuffer();
+
+      /// tells the memory manager to read in the mapped pages in front of the read position
+      void Prefetch();
+
+   private:
+      /// file handle
+      HANDLE m_fileHandle = INVALID_HANDLE_VALUE;
+
+      /// file mapping handle; nullptr when the read-ahead buffer is used
+      HANDLE m_mappingHandle = nullptr;
+
+      /// length of file
+      unsigned long long m_length = 0;
+
+      /// current read position
+      unsigned long long m_position = 0;
+
+      /// currently mapped window of the file
+      const unsigned char* m_window = nullptr;
+
+      /// file position of the mapped window
+      unsigned long long m_windowPosition = 0;
+
+      /// length of the mapped window
+      size_t m_windowLength = 0;
+
+      /// file position up to where the mapped window has been prefetched
+      unsigned long long m_prefetchPosition = 0;
+
+      /// read-ahead buffer
+      std::vector<unsigned char> m_buffer;
+
+      /// file position of the read-ahead buffer
+      unsigned long long m_bufferPosition = 0;
+
+      /// number of bytes in the read-ahead buffer
+      size_t m_bufferLength = 0;
+   };
+
+} // namespace Encoder
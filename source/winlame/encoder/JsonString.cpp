@@ -0,0 +1,55 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file JsonString.cpp
+/// \brief formatting of JSON string literals
+//
+#include "stdafx.h"
+#include "JsonString.hpp"
+#include <ulib/UTF8.hpp>
+
+CStringA Encoder::JsonString(const CString& text)
+{
+   CString escaped = _T("\"");
+
+   for (int index = 0, maxIndex = text.GetLength(); index < maxIndex; index++)
+   {
+      TCHAR ch = text[index];
+      switch (ch)
+      {
+      case _T('\"'): escaped += _T("\\\""); break;
+      case _T('\\'): escaped += _T("\\\\"); break;
+      case _T('\n'): escaped += _T("\\n"); break;
+      case _T('\r'): escaped += _T("\\r"); break;
+      case _T('\t'): escaped += _T("\\t"); break;
+      default:
+         if (static_cast<unsigned int>(ch) < 0x20)
+            escaped.AppendFormat(_T("\\u%04x"), static_cast<unsigned int>(ch));
+         else
+            escaped += ch;
+         break;
+      }
+   }
+
+   escaped += _T("\"");
+
+   std::vector<char> utf8Buffer;
+   StringToUTF8(escaped, utf8Buffer);
+
+   return CStringA(utf8Buffer.data());
+}
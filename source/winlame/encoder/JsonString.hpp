@@ -0,0 +1,30 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file JsonString.hpp
+/// \brief formatting of JSON string literals
+//
+#pragma once
+
+namespace Encoder
+{
+   /// \brief formats text as JSON string literal, including quotes, in UTF-8
+   /// \details used by the NDJSON output of the command line encoder and the benchmark
+   CStringA JsonString(const CString& text);
+
+} // namespace Encoder
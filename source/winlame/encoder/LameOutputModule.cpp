@@ -21,14 +21,13 @@
 /// \brief contains the implementation of the LAME output module
 //
 #include "stdafx.h"
-#include <fstream>
 #include "resource.h"
 #include "LameOutputModule.hpp"
 #include "LameNogapInstanceManager.hpp"
 #include "WaveMp3Header.hpp"
 #include "Id3v1Tag.hpp"
 #include "AudioFileTag.hpp"
-#include <ulib/win32/ErrorMessage.hpp>
+#include "LameParallelEncoder.hpp"
 
 using Encoder::LameOutputModule;
 using Encoder::TrackInfo;
@@ -37,9 +36,9 @@ using Encoder::SampleContainer;
 LameOutputModule::LameOutputModule()
    :m_instance(nullptr),
    m_writeInfoTag(true),
-   m_inputBufferFill(0),
    m_bufferType(nle_buffer_short),
-   m_inputBufferSize(1152),
+   m_frameSize(1152),
+   m_bytesPerSample(0),
    m_nogapEncoding(false),
    m_nogapIsLastFile(false),
    m_nogapInstanceManager(IoCContainer::Current().Resolve<LameNogapInstanceManager>()),
@@ -108,19 +107,20 @@ int LameOutputModule::InitOutput(LPCTSTR outfilename,
    SampleContainer& samples)
 {
    // open output file
-   m_mp3Filename = outfilename;
-
-   m_outputFile.open(outfilename, std::ios::out | std::ios::binary);
-   if (!m_outputFile.is_open())
+   CString lastErrorText;
+   if (!OpenOutputSink(outfilename, lastErrorText))
    {
-      CString lastErrorText = Win32::ErrorMessage().ToString();
-
       m_lastError.LoadString(IDS_ENCODER_OUTPUT_FILE_CREATE_ERROR);
       m_lastError.AppendFormat(_T(" (message \"%s\", filename \"%s\")"), lastErrorText.GetString(), outfilename);
 
       return -1;
    }
 
+   // the VBR Info tag can only be written when the output can be overwritten after
+   // encoding; a pipe gets no VBR Info tag
+   m_writeInfoTag = m_outputSink->CanOverwrite();
+   m_id3v2TagLength = 0;
+
    // alloc memory for output mp3 buffer
    m_mp3OutputBuffer.resize(nlame_const_maxmp3buffer);
 
@@ -174,7 +174,7 @@ int LameOutputModule::InitOutput(LPCTSTR outfilename,
       nlame_callback_set(m_instance, nle_callback_message, LameErrorCallback);
 
       // set all nlame variables
-      int ret = SetEncodingParameters(mgr);
+      int ret = SetEncodingParameters(m_instance, mgr, false);
 
       if (ret < 0)
       {
@@ -183,14 +183,26 @@ int LameOutputModule::InitOutput(LPCTSTR outfilename,
       }
    }
 
-   AddPaddingForID3v2AndLameTag(m_trackInfoID3v2);
+   // reserve space for the ReplayGain frames added after encoding, using the longest values
+   TrackInfo paddingTrackInfo = m_trackInfoID3v2;
+   if (mgr.QueryValueInt(GeneralReplayGain) == 1)
+   {
+      LoudnessResult placeholderResult;
+      placeholderResult.m_loudness = LoudnessHistogram::c_absoluteGate;
+      placeholderResult.m_peak = 10.0;
+      placeholderResult.StoreTrackGain(paddingTrackInfo);
+   }
+
+   // when the output can't be overwritten, the ID3v2 tag is written right away, without
+   // the ReplayGain values
+   if (m_outputSink->CanOverwrite())
+      AddPaddingForID3v2AndLameTag(paddingTrackInfo);
+   else if (!m_writeWaveHeader)
+      WriteID3v2Tag();
 
    // do description string
    GenerateDescription(mgr);
 
-   // always write VBR info tag
-   //m_writeInfoTag = mgr.QueryValueInt(LameVBRWriteTag) == 1;
-
    m_nogapIsLastFile = mgr.QueryValueInt(GeneralIsLastFile) == 1;
 
    // generate info tag?
@@ -221,19 +233,24 @@ int LameOutputModule::InitOutput(LPCTSTR outfilename,
    if (frameSize <= 0)
       return -1;
 
-   m_inputBufferSize = static_cast<unsigned int>(frameSize);
+   m_frameSize = static_cast<unsigned int>(frameSize);
+
+   // let input modules deliver whole frames, so that they can be encoded without copying
+   samples.SetOutputModuleFrameSize(frameSize);
 
-   m_inputBuffer.resize(m_inputBufferSize * m_channels * (bitsPerSample >> 3));
-   m_inputBufferFill = 0;
+   m_bytesPerSample = m_channels * (bitsPerSample >> 3);
+   m_inputFrameBuffer.Init(size_t(m_frameSize) * m_bytesPerSample);
 
    m_numSamplesEncoded = 0;
    m_numDataBytesWritten = 0;
 
+   InitParallelEncoding(mgr);
+
    // write wave mp3 header when requested
    if (m_writeWaveHeader)
    {
       // write wave header
-      WriteWaveMp3Header(m_outputFile,
+      WriteWaveMp3Header(*m_outputSink,
          nlame_var_get_int(m_instance, nle_var_channel_mode) == nle_mode_mono ? 1 : 2,
          nlame_var_get_int(m_instance, nle_var_out_samplerate),
          nlame_var_get_int(m_instance, nle_var_bitrate),
@@ -247,7 +264,7 @@ int LameOutputModule::InitOutput(LPCTSTR outfilename,
 /// done due to the fact that LAME expects that number of samples, or it will
 /// produce different output, e.g. when feeding less than 576 samples per call
 /// to nlame_encode_buffer_*().
-int LameOutputModule::EncodeFrame()
+int LameOutputModule::EncodeFrame(const unsigned char* frame, unsigned int numSamples)
 {
    if (m_mp3OutputBuffer.empty())
       return -1;
@@ -257,16 +274,15 @@ int LameOutputModule::EncodeFrame()
    if (m_channels == 1)
    {
       ret = nlame_encode_buffer_mono(m_instance, m_bufferType,
-         m_inputBuffer.data(), m_inputBufferFill, m_mp3OutputBuffer.data(), m_mp3OutputBuffer.size());
+         frame, numSamples, m_mp3OutputBuffer.data(), m_mp3OutputBuffer.size());
    }
    else
    {
       ret = nlame_encode_buffer_interleaved(m_instance, m_bufferType,
-         m_inputBuffer.data(), m_inputBufferFill, m_mp3OutputBuffer.data(), m_mp3OutputBuffer.size());
+         frame, numSamples, m_mp3OutputBuffer.data(), m_mp3OutputBuffer.size());
    }
 
-   m_numSamplesEncoded += m_inputBufferFill;
-   m_inputBufferFill = 0;
+   m_numSamplesEncoded += numSamples;
 
    // error?
    if (ret < 0)
@@ -275,7 +291,12 @@ int LameOutputModule::EncodeFrame()
    // write out data when available
    if (ret > 0)
    {
-      m_outputFile.write(reinterpret_cast<char*>(m_mp3OutputBuffer.data()), ret);
+      if (!m_outputSink->Write(m_mp3OutputBuffer.data(), ret))
+      {
+         m_lastError = m_outputSink->GetLastError();
+         return -1;
+      }
+
       m_numDataBytesWritten += ret;
    }
 
@@ -288,33 +309,33 @@ int LameOutputModule::EncodeSamples(SampleContainer& samples)
    int numSamples = 0;
    unsigned char* sampleBuffer = (unsigned char*)samples.GetSamplesInterleaved(numSamples);
 
-   unsigned int sampleBufferCount = 0;
-
-   int ret = 0;
-   int sampleSizeInBytes = samples.GetOutputModuleBitsPerSample() >> 3;
-   do
+   if (m_parallelEncoder != nullptr)
    {
-      unsigned int fillsize = std::min(m_inputBufferSize - m_inputBufferFill, static_cast<unsigned int>(numSamples));
+      if (!m_parallelEncoder->EncodeSamples(sampleBuffer, static_cast<unsigned int>(numSamples)))
+      {
+         m_lastError = m_parallelEncoder->GetLastError();
+         return -1;
+      }
 
-      // copy samples into inbuffer; note: m_inputBufferFill is counted in "samples"
-      memcpy(
-         m_inputBuffer.data() + m_inputBufferFill * m_channels * sampleSizeInBytes,
-         sampleBuffer + sampleBufferCount * m_channels * sampleSizeInBytes,
-         fillsize * m_channels * sampleSizeInBytes);
+      return 0;
+   }
 
-      m_inputBufferFill += fillsize;
-      numSamples -= fillsize;
-      sampleBufferCount += fillsize;
+   // when the block size is a multiple of the frame size, all frames are
+   // encoded directly from the sample block
+   m_inputFrameBuffer.SetInput(sampleBuffer, size_t(numSamples) * m_bytesPerSample);
 
-      if (m_inputBufferFill == m_inputBufferSize)
+   int ret = 0;
+   for (const unsigned char* frame = m_inputFrameBuffer.NextFrame(); frame != nullptr; frame = m_inputFrameBuffer.NextFrame())
+   {
+      ret = EncodeFrame(frame, m_frameSize);
+      if (ret < 0)
       {
-         // encode one frame
-         ret = EncodeFrame();
-         if (ret < 0)
-            break;
+         // consume rest of the input block
+         while (m_inputFrameBuffer.NextFrame() != nullptr)
+            ;
+         break;
       }
-
-   } while (numSamples > 0);
+   }
 
    return ret;
 }
@@ -337,17 +358,29 @@ void LameOutputModule::FlushOutputBuffer()
 
    if (ret > 0)
    {
-      m_outputFile.write(reinterpret_cast<char*>(m_mp3OutputBuffer.data()), ret);
+      m_outputSink->Write(m_mp3OutputBuffer.data(), ret);
       m_numDataBytesWritten += ret;
    }
 }
 
 void LameOutputModule::FinishEncoding()
 {
-   // encode remaining samples, if any
-   EncodeFrame();
+   if (m_parallelEncoder != nullptr)
+   {
+      // encode last segment and write out all remaining frames
+      if (!m_parallelEncoder->Finish())
+         m_lastError = m_parallelEncoder->GetLastError();
+   }
+   else
+   {
+      // encode remaining samples, if any
+      size_t numBytes = 0;
+      const unsigned char* remainingSamples = m_inputFrameBuffer.RemainingSamples(numBytes);
+      if (numBytes > 0)
+         EncodeFrame(remainingSamples, static_cast<unsigned int>(numBytes / m_bytesPerSample));
 
-   FlushOutputBuffer();
+      FlushOutputBuffer();
+   }
 
    // write ID3v1 tag when available
    // note: we write id3 tag when we do gapless encoding, too, since
@@ -356,31 +389,41 @@ void LameOutputModule::FinishEncoding()
    //       since that that might confuse some software
    if (!m_writeWaveHeader && /* !m_nogapEncoding && */ m_ID33v1Tag != nullptr)
    {
-      m_outputFile.write((char*)m_ID33v1Tag->GetData(), 128);
+      m_outputSink->Write(m_ID33v1Tag->GetData(), 128);
    }
 
    if (m_writeWaveHeader)
    {
       // fix up fact chunk and riff header lengths; seeks around a bit
-      FixupWaveMp3Header(m_outputFile, m_numDataBytesWritten, m_numSamplesEncoded);
+      FixupWaveMp3Header(*m_outputSink, m_numDataBytesWritten, m_numSamplesEncoded);
    }
 
-   // close file
-   m_outputFile.close();
-
-   // add VBR info tag to mp3 file
-   // note: since nlame_write_vbr_infotag() seeks to the front of the output
-   //       file, the wave header might get overwritten, so we don't write a
-   //       info tag when writing a wave header
-   // Write VBR Info tag before AudioFileTag has the chance to modify the file
+   // add VBR info tag to mp3 file, overwriting the empty first frame
+   // note: no space is reserved for the info tag when writing a wave header,
+   //       so we don't write an info tag then
    if (m_writeInfoTag && !m_writeWaveHeader)
-      WriteVBRInfoTag(m_instance, m_mp3Filename);
+   {
+      if (m_parallelEncoder != nullptr)
+         WriteParallelInfoTag();
+      else
+         WriteVBRInfoTag(m_instance);
+   }
 
    // write ID3v2 tag
    // note: we re-write the ID3v2 tag here into the padding space previously
    // created by AddPaddingForID3v2AndLameTag().
-   if (!m_writeWaveHeader)
+   if (!m_writeWaveHeader && m_id3v2TagLength > 0)
+   {
+      if (m_loudnessResult.m_isValid)
+         m_loudnessResult.StoreTrackGain(m_trackInfoID3v2);
+
       WriteID3v2Tag();
+   }
+
+   // close file
+   CString errorText;
+   if (!CloseOutputSink(errorText))
+      m_lastError = errorText;
 }
 
 void LameOutputModule::FreeLameInstance()
@@ -407,26 +450,28 @@ void LameOutputModule::FreeLameInstance()
 
 void LameOutputModule::DoneOutput()
 {
-   if (m_outputFile.is_open())
+   if (m_outputSink != nullptr)
       FinishEncoding();
 
+   m_parallelEncoder.reset();
+
    if (m_instance != nullptr)
       FreeLameInstance();
 
    m_instance = nullptr;
 }
 
-int LameOutputModule::SetEncodingParameters(SettingsManager& mgr)
+int LameOutputModule::SetEncodingParameters(nlame_instance_t* instance, SettingsManager& mgr, bool parallelSegment)
 {
-   nlame_var_set_int(m_instance, nle_var_in_samplerate, m_samplerate);
-   nlame_var_set_int(m_instance, nle_var_num_channels, m_channels);
+   nlame_var_set_int(instance, nle_var_in_samplerate, m_samplerate);
+   nlame_var_set_int(instance, nle_var_num_channels, m_channels);
 
    // mono encoding?
    bool bMono = mgr.QueryValueInt(LameSimpleMono) == 1;
 
    // set mono encoding, else let LAME choose the default (which is joint stereo)
    if (bMono)
-      nlame_var_set_int(m_instance, nle_var_channel_mode, nle_mode_mono);
+      nlame_var_set_int(instance, nle_var_channel_mode, nle_mode_mono);
 
    // which mode? 0: bitrate mode, 1: quality mode
    if (mgr.QueryValueInt(LameSimpleQualityOrBitrate) == 0)
@@ -437,14 +482,14 @@ int LameOutputModule::SetEncodingParameters(SettingsManager& mgr)
       if (mgr.QueryValueInt(LameSimpleCBR) == 1)
       {
          // CBR
-         nlame_var_set_int(m_instance, nle_var_vbr_mode, nle_vbr_mode_off);
-         nlame_var_set_int(m_instance, nle_var_bitrate, nBitrate);
+         nlame_var_set_int(instance, nle_var_vbr_mode, nle_vbr_mode_off);
+         nlame_var_set_int(instance, nle_var_bitrate, nBitrate);
       }
       else
       {
          // ABR
-         nlame_var_set_int(m_instance, nle_var_vbr_mode, nle_vbr_mode_abr);
-         nlame_var_set_int(m_instance, nle_var_abr_mean_bitrate, nBitrate);
+         nlame_var_set_int(instance, nle_var_vbr_mode, nle_vbr_mode_abr);
+         nlame_var_set_int(instance, nle_var_abr_mean_bitrate, nBitrate);
       }
    }
    else
@@ -452,15 +497,15 @@ int LameOutputModule::SetEncodingParameters(SettingsManager& mgr)
       // quality mode; value ranges from 0 to 9
       int quality = mgr.QueryValueInt(LameSimpleQuality);
 
-      nlame_var_set_int(m_instance, nle_var_vbr_quality, quality);
+      nlame_var_set_int(instance, nle_var_vbr_quality, quality);
 
       // VBR mode; LameSimpleVBRMode, 0: standard, 1: fast
       int vbrMode = mgr.QueryValueInt(LameSimpleVBRMode);
 
       if (vbrMode == 0)
-         nlame_var_set_int(m_instance, nle_var_vbr_mode, nle_vbr_mode_old); // standard
+         nlame_var_set_int(instance, nle_var_vbr_mode, nle_vbr_mode_old); // standard
       else
-         nlame_var_set_int(m_instance, nle_var_vbr_mode, nle_vbr_mode_new); // fast
+         nlame_var_set_int(instance, nle_var_vbr_mode, nle_vbr_mode_new); // fast
    }
 
    // encode quality; LameSimpleEncodeQuality, 0: fast, 1: standard, 2: high
@@ -475,17 +520,79 @@ int LameOutputModule::SetEncodingParameters(SettingsManager& mgr)
    // note: when using "standard" encoding quality we don't set nle_var_quality,
    // since the LAME engine then chooses the default quality value.
    if (encodingQuality == 0)
-      nlame_var_set_int(m_instance, nle_var_quality, nlame_var_get_int(m_instance, nle_var_quality_value_fast));
+      nlame_var_set_int(instance, nle_var_quality, nlame_var_get_int(instance, nle_var_quality_value_fast));
    else if (encodingQuality == 2)
-      nlame_var_set_int(m_instance, nle_var_quality, nlame_var_get_int(m_instance, nle_var_quality_value_high));
+      nlame_var_set_int(instance, nle_var_quality, nlame_var_get_int(instance, nle_var_quality_value_high));
 
-   // always use replay gain, and decode on-the-fly to get the peak sample
-   // the result is written into the LAME VBR Info tag
-   nlame_var_set_int(m_instance, nle_var_find_replay_gain, 1);
-   nlame_var_set_int(m_instance, nle_var_decode_on_the_fly, 1);
+   // segments are put together at frame boundaries, so a frame must not use
+   // the bit reservoir of frames from another segment
+   if (parallelSegment)
+      nlame_var_set_int(instance, nle_var_disable_reservoir, 1);
+
+   // replay gain and peak sample aren't calculated by LAME, since decoding the
+   // output on-the-fly to find the peak is slow; the encoder analyzes the input
+   // samples instead, and the result is written into the LAME VBR Info tag
 
    // init more settings in nlame
-   return nlame_init_params(m_instance);
+   return nlame_init_params(instance);
+}
+
+nlame_instance_t* LameOutputModule::CreateSegmentInstance(SettingsManager& mgr)
+{
+   nlame_instance_t* instance = nlame_new();
+   if (instance == nullptr)
+      return nullptr;
+
+   // the ID3 tags and the VBR Info tag are written for the whole stream
+   nlame_var_set_int(instance, nle_var_id3tag_write_automatic, 0);
+   nlame_var_set_int(instance, nle_var_vbr_generate_info_tag, 0);
+
+   // set callbacks
+   nlame_callback_set(instance, nle_callback_error, LameErrorCallback);
+   nlame_callback_set(instance, nle_callback_debug, LameErrorCallback);
+   nlame_callback_set(instance, nle_callback_message, LameErrorCallback);
+
+   if (SetEncodingParameters(instance, mgr, true) < 0)
+   {
+      nlame_delete(instance);
+      return nullptr;
+   }
+
+   return instance;
+}
+
+void LameOutputModule::InitParallelEncoding(SettingsManager& mgr)
+{
+   // not used for nogap encoding, since the encoder is passed on to the next
+   // file, and not when LAME resamples, since the segments then don't line up
+   // with the frames of the whole stream
+   if (mgr.QueryValueInt(LameParallelEncoding) != 1 ||
+      m_nogapEncoding ||
+      m_writeWaveHeader ||
+      nlame_var_get_int(m_instance, nle_var_out_samplerate) != m_samplerate)
+      return;
+
+   m_parallelEncoder = std::make_unique<LameParallelEncoder>(
+      [this, settings = mgr]() mutable { return CreateSegmentInstance(settings); },
+      [this](const unsigned char* data, size_t length)
+      {
+         m_outputSink->Write(data, length);
+         m_numDataBytesWritten += static_cast<unsigned int>(length);
+      },
+      m_bufferType,
+      static_cast<unsigned int>(m_channels),
+      m_frameSize,
+      m_workerPool,
+      std::thread::hardware_concurrency());
+
+   // reserve space for the VBR Info tag frame, which LAME would write as first frame
+   if (m_writeInfoTag)
+   {
+      std::vector<char> infoTagFrame(nlame_get_vbr_infotag_length(m_instance), 0);
+      m_outputSink->Write(infoTagFrame.data(), infoTagFrame.size());
+   }
+
+   m_description += _T(", parallel encoding");
 }
 
 void LameOutputModule::GenerateDescription(SettingsManager& mgr)
@@ -532,30 +639,35 @@ void LameOutputModule::GenerateDescription(SettingsManager& mgr)
    m_description = text;
 }
 
-void LameOutputModule::AddPaddingForID3v2AndLameTag(const TrackInfo& trackInfo)
+void LameOutputModule::AddPaddingForID3v2AndLameTag(TrackInfo& trackInfo)
 {
    // add padding for writing ID3v2 tag and VBR Info tag at the end of
    // encoding, using the AudioFileTag class, and don't use LAME's functions
    unsigned int paddingSize = 0;
 
-   AudioFileTag tag{ m_trackInfoID3v2 };
+   AudioFileTag tag{ trackInfo };
    paddingSize += tag.GetTagLength();
 
+   // the ID3v2 tag fills all of the padding, up to the VBR Info tag
+   m_fileOffsetID3v2Tag = m_outputSink->Position();
+
    // add bytes for the VBR Info tag
    if (m_writeInfoTag && !m_writeWaveHeader)
    {
       paddingSize += nlame_get_vbr_infotag_length(m_instance);
 
-      m_fileOffsetVbrInfoTag = paddingSize + static_cast<long>(m_outputFile.tellp());
+      m_fileOffsetVbrInfoTag = paddingSize + static_cast<long>(m_outputSink->Position());
    }
 
+   m_id3v2TagLength = paddingSize;
+
    if (paddingSize > 0)
    {
       std::array<char, 4096> paddingBuffer = {};
       while (paddingSize > 0)
       {
          size_t sizeToWrite = std::min(size_t(paddingSize), paddingBuffer.size());
-         m_outputFile.write(paddingBuffer.data(), sizeToWrite);
+         m_outputSink->Write(paddingBuffer.data(), sizeToWrite);
 
          paddingSize -= int(sizeToWrite);
       }
@@ -565,19 +677,95 @@ void LameOutputModule::AddPaddingForID3v2AndLameTag(const TrackInfo& trackInfo)
 void LameOutputModule::WriteID3v2Tag()
 {
    AudioFileTag tag{ m_trackInfoID3v2 };
-   tag.WriteToFile(m_mp3Filename, AudioFileTag::AudioFileType::MPEG);
+
+   // without reserved padding space, the tag is written at the current position
+   if (m_id3v2TagLength == 0)
+   {
+      std::vector<unsigned char> tagData = tag.RenderId3v2Tag(tag.GetTagLength());
+      m_outputSink->Write(tagData.data(), tagData.size());
+      return;
+   }
+
+   std::vector<unsigned char> tagData = tag.RenderId3v2Tag(m_id3v2TagLength);
+   if (!tagData.empty())
+      m_outputSink->Overwrite(m_fileOffsetID3v2Tag, tagData.data(), tagData.size());
 }
 
-void LameOutputModule::WriteVBRInfoTag(nlame_instance_t* instance, LPCTSTR mp3Filename)
+void LameOutputModule::WriteVBRInfoTag(nlame_instance_t* instance)
 {
-   FILE* fp = _wfopen(mp3Filename, _T("r+b"));
+   // large enough for the longest frame, a free format frame with 640 kbps at 32 kHz
+   std::vector<unsigned char> infoTagFrame(2880);
 
-   if (fp != nullptr)
-   {
-      fseek(fp, m_fileOffsetVbrInfoTag, SEEK_SET);
+   size_t length = nlame_get_vbr_infotag(instance, infoTagFrame.data(), infoTagFrame.size());
+   if (length == 0)
+      return;
 
-      nlame_write_vbr_infotag_offset(instance, fp);
+   infoTagFrame.resize(length);
 
-      fclose(fp);
-   }
+   // LAME doesn't calculate the replay gain; store the values of the encoder
+   Mp3InfoTagParams params;
+   SetReplayGainParams(params);
+
+   if (params.m_hasReplayGain)
+      Mp3InfoTag::UpdateReplayGain(infoTagFrame, params);
+
+   m_outputSink->Overwrite(static_cast<unsigned long long>(m_fileOffsetVbrInfoTag),
+      infoTagFrame.data(), infoTagFrame.size());
+}
+
+void LameOutputModule::WriteParallelInfoTag()
+{
+   int vbrMode = nlame_var_get_int(m_instance, nle_var_vbr_mode);
+   int channelMode = nlame_var_get_int(m_instance, nle_var_channel_mode);
+
+   Mp3InfoTagParams params;
+   params.m_isCbr = vbrMode == nle_vbr_mode_off;
+
+   params.m_quality = static_cast<unsigned int>(std::clamp(100 -
+      10 * nlame_var_get_int(m_instance, nle_var_vbr_quality) -
+      nlame_var_get_int(m_instance, nle_var_quality), 0, 100));
+
+   params.m_encoderVersion = std::string("LAME") + nlame_lame_version_get(nle_lame_version_short);
+
+   params.m_vbrMethod =
+      vbrMode == nle_vbr_mode_off ? 1 :
+      vbrMode == nle_vbr_mode_abr ? 2 :
+      vbrMode == nle_vbr_mode_old ? 3 : 4;
+
+   params.m_lowpassFrequency = static_cast<unsigned int>(std::max(0, nlame_var_get_int(m_instance, nle_var_lowpass_freq)));
+   params.m_athType = static_cast<unsigned int>(std::max(0, nlame_var_get_int(m_instance, nle_var_ath_type)));
+
+   int bitrate =
+      vbrMode == nle_vbr_mode_off ? nlame_var_get_int(m_instance, nle_var_bitrate) :
+      vbrMode == nle_vbr_mode_abr ? nlame_var_get_int(m_instance, nle_var_abr_mean_bitrate) :
+      nlame_var_get_int(m_instance, nle_var_vbr_min_bitrate);
+   params.m_bitrate = static_cast<unsigned int>(std::max(0, bitrate));
+
+   params.m_stereoMode =
+      channelMode == nle_mode_mono ? 0 :
+      channelMode == nle_mode_stereo ? 1 :
+      channelMode == nle_mode_dual_channel ? 2 :
+      nlame_var_get_int(m_instance, nle_var_force_ms) == 1 ? 4 : 3;
+
+   params.m_encoderDelay = static_cast<unsigned int>(std::max(0, nlame_var_get_int(m_instance, nle_var_encoder_delay)));
+   params.m_numSamples = m_parallelEncoder->GetNumSamples();
+   params.m_sourceSamplerate = static_cast<unsigned int>(m_samplerate);
+
+   SetReplayGainParams(params);
+
+   std::vector<unsigned char> infoTagFrame = m_parallelEncoder->GetInfoTag().BuildFrame(
+      static_cast<unsigned int>(nlame_get_vbr_infotag_length(m_instance)), params);
+
+   if (infoTagFrame.empty())
+      return;
+
+   m_outputSink->Overwrite(static_cast<unsigned long long>(m_fileOffsetVbrInfoTag),
+      infoTagFrame.data(), infoTagFrame.size());
+}
+
+void LameOutputModule::SetReplayGainParams(Mp3InfoTagParams& params) const
+{
+   params.m_hasReplayGain = m_loudnessResult.m_isValid;
+   params.m_peakSignalAmplitude = m_loudnessResult.m_peak;
+   params.m_radioReplayGain = m_loudnessResult.GetGain();
 }
@@ -22,13 +22,15 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
-#include <iosfwd>
 #include "nlame.h"
+#include "SampleFrameBuffer.hpp"
 
 namespace Encoder
 {
    struct Id3v1Tag;
    class LameNogapInstanceManager;
+   class LameParallelEncoder;
+   struct Mp3InfoTagParams;
 
    /// LAME output module
    class LameOutputModule : public OutputModule
@@ -57,6 +59,9 @@ namespace Encoder
       /// returns the extension the output module produces
       virtual CString GetOutputExtension() const override { return m_writeWaveHeader ? _T("wav") : _T("mp3"); }
 
+      /// writes through an output sink
+      virtual bool SupportsOutputSink() const override { return true; }
+
       /// lets the output module fetch some settings, right after module creation
       virtual void PrepareOutput(SettingsManager& mgr) override;
 
@@ -71,14 +76,21 @@ namespace Encoder
       virtual void DoneOutput() override;
 
    private:
-      /// sets all encoding parameters from settings
-      int SetEncodingParameters(SettingsManager& mgr);
+      /// sets all encoding parameters from settings; for segments of parallel
+      /// encoding, the bit reservoir is disabled
+      int SetEncodingParameters(nlame_instance_t* instance, SettingsManager& mgr, bool parallelSegment);
+
+      /// creates nlame instance for encoding a segment in parallel encoding mode
+      nlame_instance_t* CreateSegmentInstance(SettingsManager& mgr);
+
+      /// starts parallel encoding when enabled and possible with the current settings
+      void InitParallelEncoding(SettingsManager& mgr);
 
       /// generatse a description text
       void GenerateDescription(SettingsManager& mgr);
 
-      /// encodes one frame
-      int EncodeFrame();
+      /// encodes one frame with given number of samples per channel
+      int EncodeFrame(const unsigned char* frame, unsigned int numSamples);
 
       /// flushes LAME output buffer without encoding more samples
       void FlushOutputBuffer();
@@ -90,38 +102,39 @@ namespace Encoder
       void FreeLameInstance();
 
       /// adds padding to the output file for later writing ID3v2 and LAME Info tag
-      void AddPaddingForID3v2AndLameTag(const TrackInfo& trackinfo);
+      void AddPaddingForID3v2AndLameTag(TrackInfo& trackinfo);
 
-      /// writes out ID3v2 tag
+      /// writes out ID3v2 tag into the padding space, or at the current position when
+      /// there is none
       void WriteID3v2Tag();
 
-      /// Writes VBR Info tag
-      void WriteVBRInfoTag(nlame_instance_t* inst, LPCTSTR mp3filename);
+      /// writes VBR Info tag into the first frame
+      void WriteVBRInfoTag(nlame_instance_t* inst);
+
+      /// writes VBR Info tag for all frames encoded in parallel encoding mode
+      void WriteParallelInfoTag();
+
+      /// sets peak and replay gain info tag params from the loudness result, when available
+      void SetReplayGainParams(Mp3InfoTagParams& params) const;
 
    private:
       /// nlame instance
       nlame_instance_t* m_instance;
 
-      /// output file stream
-      std::ofstream m_outputFile;
-
-      /// output mp3 filename
-      CString m_mp3Filename;
-
       /// indicates if we should write a vbr info tag
       bool m_writeInfoTag;
 
       /// encode buffer type
       nlame_encode_buffer_type m_bufferType;
 
-      /// current input buffer size for LAME
-      unsigned int m_inputBufferSize;
+      /// number of samples per frame, per channel
+      unsigned int m_frameSize;
 
-      /// LAME input buffer
-      std::vector<unsigned char> m_inputBuffer;
+      /// splits interleaved samples from the sample container into frames
+      SampleFrameBuffer<unsigned char> m_inputFrameBuffer;
 
-      /// inbuffer filled indicator
-      unsigned int m_inputBufferFill;
+      /// number of bytes of one sample of all channels
+      unsigned int m_bytesPerSample;
 
       /// mp3 output buffer
       std::vector<unsigned char> m_mp3OutputBuffer;
@@ -156,11 +169,20 @@ namespace Encoder
       /// file offset when the VBR Info tag should be written to
       long m_fileOffsetVbrInfoTag = 0;
 
+      /// file offset of the padding space the ID3v2 tag is written to
+      unsigned long long m_fileOffsetID3v2Tag = 0;
+
+      /// length of the padding space for the ID3v2 tag; 0 when there is none
+      unsigned int m_id3v2TagLength = 0;
+
       /// number of samples encoded so gar
       unsigned int m_numSamplesEncoded;
 
       /// number of data bytes written
       unsigned int m_numDataBytesWritten;
+
+      /// encoder for parallel encoding mode; nullptr when not used
+      std::unique_ptr<LameParallelEncoder> m_parallelEncoder;
    };
 
 } // namespace Encoder
@@ -0,0 +1,265 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file LameParallelEncoder.cpp
+/// \brief encodes segments of a single input stream with LAME in parallel
+//
+#include "stdafx.h"
+#include "LameParallelEncoder.hpp"
+#include "WorkerPool.hpp"
+#include <climits>
+
+using Encoder::LameParallelEncoder;
+
+LameParallelEncoder::LameParallelEncoder(T_fnCreateInstance fnCreateInstance, T_fnWriteOutput fnWriteOutput,
+   nlame_encode_buffer_type bufferType, unsigned int numChannels, unsigned int frameSize,
+   WorkerPool* workerPool, unsigned int maxSegmentsInFlight, unsigned int numFramesPerSegment)
+   :m_fnCreateInstance(fnCreateInstance),
+   m_fnWriteOutput(fnWriteOutput),
+   m_bufferType(bufferType),
+   m_numChannels(numChannels),
+   m_frameSize(frameSize),
+   m_bytesPerSample(numChannels * (bufferType == nle_buffer_int ? 4 : 2)),
+   m_workerPool(workerPool),
+   m_maxSegmentsInFlight(std::max(maxSegmentsInFlight, 1U)),
+   m_numFramesPerSegment(numFramesPerSegment)
+{
+   // the overlap of the next segment is taken from the end of the current segment
+   ATLASSERT(numFramesPerSegment >= c_numOverlapFrames);
+}
+
+LameParallelEncoder::~LameParallelEncoder()
+{
+   // wait for all segments, without writing them out
+   for (auto& segment : m_pendingSegments)
+      segment.wait();
+}
+
+bool LameParallelEncoder::EncodeSamples(const unsigned char* samples, unsigned int numSamples)
+{
+   m_numSamples += numSamples;
+
+   size_t numBytes = size_t(numSamples) * m_bytesPerSample;
+   while (numBytes > 0)
+   {
+      size_t segmentBytes = size_t(m_numSegmentOverlapFrames + m_numFramesPerSegment + c_numLookaheadFrames) *
+         m_frameSize * m_bytesPerSample;
+
+      size_t fillBytes = std::min(numBytes, segmentBytes - m_segmentSamples.size());
+
+      m_segmentSamples.insert(m_segmentSamples.end(), samples, samples + fillBytes);
+
+      samples += fillBytes;
+      numBytes -= fillBytes;
+
+      if (m_segmentSamples.size() == segmentBytes &&
+         !StartSegment(false))
+         return false;
+   }
+
+   return true;
+}
+
+bool LameParallelEncoder::Finish()
+{
+   // the segment buffer only is empty when no samples were added at all
+   if (!m_segmentSamples.empty() &&
+      !StartSegment(true))
+      return false;
+
+   while (!m_pendingSegments.empty())
+   {
+      if (!WriteOldestSegment())
+         return false;
+   }
+
+   return true;
+}
+
+bool LameParallelEncoder::StartSegment(bool isLastSegment)
+{
+   // the next segment starts with the overlap frames before its first frame, and
+   // already contains the lookahead frames of this segment
+   std::vector<unsigned char> nextSegmentSamples;
+   if (!isLastSegment)
+   {
+      size_t nextSegmentStart = size_t(m_numSegmentOverlapFrames + m_numFramesPerSegment - c_numOverlapFrames) *
+         m_frameSize * m_bytesPerSample;
+
+      nextSegmentSamples.reserve(size_t(c_numOverlapFrames + m_numFramesPerSegment + c_numLookaheadFrames) *
+         m_frameSize * m_bytesPerSample);
+
+      nextSegmentSamples.assign(m_segmentSamples.begin() + nextSegmentStart, m_segmentSamples.end());
+   }
+
+   // limit the number of segments in memory
+   while (m_pendingSegments.size() >= m_maxSegmentsInFlight)
+   {
+      if (!WriteOldestSegment())
+         return false;
+   }
+
+   auto segmentTask = std::make_shared<std::packaged_task<SegmentResult()>>(
+      [this, samples = std::move(m_segmentSamples), numSkipFrames = m_numSegmentOverlapFrames, isLastSegment]() mutable
+      {
+         return EncodeSegment(std::move(samples), numSkipFrames, isLastSegment);
+      });
+
+   m_pendingSegments.push_back(segmentTask->get_future());
+
+   // when all worker threads are busy, e.g. with other encoding tasks, the segment
+   // is encoded right away, on the calling thread
+   if (m_workerPool == nullptr ||
+      !m_workerPool->TryRun([segmentTask]() { (*segmentTask)(); }))
+      (*segmentTask)();
+
+   m_segmentSamples = std::move(nextSegmentSamples);
+   m_numSegmentOverlapFrames = c_numOverlapFrames;
+
+   return true;
+}
+
+LameParallelEncoder::SegmentResult LameParallelEncoder::EncodeSegment(std::vector<unsigned char> samples,
+   unsigned int numSkipFrames, bool isLastSegment)
+{
+   SegmentResult result;
+
+   nlame_instance_t* instance = nullptr;
+   {
+      // LAME initializes some global tables when creating the first instance
+      std::unique_lock<std::mutex> lock(m_mutexCreateInstance);
+      instance = m_fnCreateInstance();
+   }
+
+   if (instance == nullptr)
+   {
+      result.m_errorText = _T("nlame_new() failed");
+      return result;
+   }
+
+   std::vector<unsigned char> mp3Buffer(nlame_const_maxmp3buffer);
+   std::vector<unsigned char> mp3Data;
+   mp3Data.reserve(samples.size() / 4);
+
+   // encode exactly one frame per call, as LameOutputModule::EncodeFrame() does
+   unsigned int numSamples = static_cast<unsigned int>(samples.size() / m_bytesPerSample);
+
+   int ret = 0;
+   for (unsigned int offset = 0; offset < numSamples && ret >= 0; offset += m_frameSize)
+   {
+      unsigned int numFrameSamples = std::min(m_frameSize, numSamples - offset);
+      const unsigned char* frameSamples = samples.data() + size_t(offset) * m_bytesPerSample;
+
+      if (m_numChannels == 1)
+      {
+         ret = nlame_encode_buffer_mono(instance, m_bufferType,
+            frameSamples, numFrameSamples, mp3Buffer.data(), static_cast<unsigned int>(mp3Buffer.size()));
+      }
+      else
+      {
+         ret = nlame_encode_buffer_interleaved(instance, m_bufferType,
+            frameSamples, numFrameSamples, mp3Buffer.data(), static_cast<unsigned int>(mp3Buffer.size()));
+      }
+
+      if (ret > 0)
+         mp3Data.insert(mp3Data.end(), mp3Buffer.begin(), mp3Buffer.begin() + ret);
+   }
+
+   if (ret >= 0)
+   {
+      ret = nlame_encode_flush(instance, mp3Buffer.data(), static_cast<unsigned int>(mp3Buffer.size()));
+
+      if (ret > 0)
+         mp3Data.insert(mp3Data.end(), mp3Buffer.begin(), mp3Buffer.begin() + ret);
+   }
+
+   nlame_delete(instance);
+
+   if (ret < 0)
+   {
+      result.m_errorText.Format(_T("LAME encoding failed with error code %i"), ret);
+      return result;
+   }
+
+   SplitFrames(mp3Data, numSkipFrames, isLastSegment ? UINT_MAX : m_numFramesPerSegment, result);
+
+   return result;
+}
+
+bool LameParallelEncoder::SplitFrames(const std::vector<unsigned char>& mp3Data, unsigned int numSkipFrames,
+   unsigned int numKeepFrames, SegmentResult& result)
+{
+   result.m_mp3Data.reserve(mp3Data.size());
+
+   size_t pos = 0;
+   for (unsigned int frameIndex = 0; pos < mp3Data.size(); frameIndex++)
+   {
+      Mp3FrameHeader header;
+      if (!header.Parse(mp3Data.data() + pos, mp3Data.size() - pos) ||
+         pos + header.m_frameLength > mp3Data.size())
+      {
+         result.m_errorText = _T("LAME produced invalid mp3 frame data");
+         return false;
+      }
+
+      if (frameIndex >= numSkipFrames &&
+         frameIndex - numSkipFrames < numKeepFrames)
+      {
+         result.m_mp3Data.insert(result.m_mp3Data.end(),
+            mp3Data.begin() + pos,
+            mp3Data.begin() + pos + header.m_frameLength);
+
+         result.m_frameLengths.push_back(static_cast<unsigned short>(header.m_frameLength));
+      }
+
+      pos += header.m_frameLength;
+   }
+
+   if (numKeepFrames != UINT_MAX &&
+      result.m_frameLengths.size() < numKeepFrames)
+   {
+      result.m_errorText = _T("LAME produced too few mp3 frames for segment");
+      return false;
+   }
+
+   return true;
+}
+
+bool LameParallelEncoder::WriteOldestSegment()
+{
+   SegmentResult result = m_pendingSegments.front().get();
+   m_pendingSegments.pop_front();
+
+   if (!result.m_errorText.IsEmpty())
+   {
+      m_lastError = result.m_errorText;
+      return false;
+   }
+
+   const unsigned char* frame = result.m_mp3Data.data();
+   for (unsigned short frameLength : result.m_frameLengths)
+   {
+      m_infoTag.AddFrame(frame, frameLength);
+      frame += frameLength;
+   }
+
+   if (!result.m_mp3Data.empty())
+      m_fnWriteOutput(result.m_mp3Data.data(), result.m_mp3Data.size());
+
+   return true;
+}
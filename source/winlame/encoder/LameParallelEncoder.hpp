@@ -0,0 +1,167 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file LameParallelEncoder.hpp
+/// \brief encodes segments of a single input stream with LAME in parallel
+//
+#pragma once
+
+#include "nlame.h"
+#include "Mp3InfoTag.hpp"
+#include <deque>
+#include <functional>
+#include <future>
+
+namespace Encoder
+{
+   class WorkerPool;
+
+   /// \brief encodes one sample stream by splitting it into segments that are encoded in parallel
+   /// \details The input samples are split into segments at frame boundaries. Each
+   /// segment is encoded by its own nlame instance on a thread of the worker pool, or on
+   /// the calling thread when no worker thread is free. The encoder
+   /// of a segment starts some frames before the segment, so that the psychoacoustic
+   /// model is primed, and continues some frames after it, so that the last frames of
+   /// the segment don't contain the padding of the encoder flush. Since all segment
+   /// encoders start at a frame boundary of the whole stream, their frames line up
+   /// with the frames of a single encoder; only the frames of the segment itself are
+   /// kept. The instances must be created with the bit reservoir disabled, so that
+   /// frames don't reference data in frames of another segment, and without resampling.
+   /// Encoded frames are passed to the output function in stream order, on the thread
+   /// calling EncodeSamples() or Finish().
+   class LameParallelEncoder
+   {
+   public:
+      /// function type to create a new initialized nlame instance; returns nullptr on error
+      typedef std::function<nlame_instance_t*()> T_fnCreateInstance;
+
+      /// function type to write out encoded mp3 data
+      typedef std::function<void(const unsigned char* data, size_t length)> T_fnWriteOutput;
+
+      /// ctor
+      LameParallelEncoder(T_fnCreateInstance fnCreateInstance, T_fnWriteOutput fnWriteOutput,
+         nlame_encode_buffer_type bufferType, unsigned int numChannels, unsigned int frameSize,
+         WorkerPool* workerPool, unsigned int maxSegmentsInFlight,
+         unsigned int numFramesPerSegment = c_defaultNumFramesPerSegment);
+
+      /// dtor; waits for running segments
+      ~LameParallelEncoder();
+
+      /// returns the last error
+      CString GetLastError() const { return m_lastError; }
+
+      /// returns the info tag for all encoded frames
+      const Mp3InfoTag& GetInfoTag() const { return m_infoTag; }
+
+      /// returns number of samples passed to EncodeSamples(), per channel
+      unsigned long long GetNumSamples() const { return m_numSamples; }
+
+      /// adds interleaved samples; may wait for a segment to be encoded; returns false on errors
+      bool EncodeSamples(const unsigned char* samples, unsigned int numSamples);
+
+      /// encodes the last segment and writes out all remaining frames; returns false on errors
+      bool Finish();
+
+      /// default number of frames in a segment
+      static const unsigned int c_defaultNumFramesPerSegment = 500;
+
+      /// number of frames encoded before a segment to prime the encoder
+      static const unsigned int c_numOverlapFrames = 8;
+
+      /// number of frames encoded after a segment
+      static const unsigned int c_numLookaheadFrames = 4;
+
+   private:
+      /// encoded frames of a segment
+      struct SegmentResult
+      {
+         /// mp3 data of all frames to keep
+         std::vector<unsigned char> m_mp3Data;
+
+         /// lengths of all frames in m_mp3Data
+         std::vector<unsigned short> m_frameLengths;
+
+         /// error text; empty when segment was encoded successfully
+         CString m_errorText;
+      };
+
+      /// starts encoding the segment in the current segment buffer
+      bool StartSegment(bool isLastSegment);
+
+      /// encodes a segment; runs on a worker thread or the calling thread
+      SegmentResult EncodeSegment(std::vector<unsigned char> samples,
+         unsigned int numSkipFrames, bool isLastSegment);
+
+      /// splits mp3 data into frames and keeps the frames of the segment
+      static bool SplitFrames(const std::vector<unsigned char>& mp3Data, unsigned int numSkipFrames,
+         unsigned int numKeepFrames, SegmentResult& result);
+
+      /// waits for the oldest segment and writes out its frames
+      bool WriteOldestSegment();
+
+   private:
+      /// function to create nlame instances
+      T_fnCreateInstance m_fnCreateInstance;
+
+      /// mutex to serialize creating nlame instances
+      std::mutex m_mutexCreateInstance;
+
+      /// function to write encoded data
+      T_fnWriteOutput m_fnWriteOutput;
+
+      /// buffer type of input samples
+      nlame_encode_buffer_type m_bufferType;
+
+      /// number of channels
+      unsigned int m_numChannels;
+
+      /// number of samples per frame, per channel
+      unsigned int m_frameSize;
+
+      /// number of bytes for one sample of all channels
+      unsigned int m_bytesPerSample;
+
+      /// worker pool to encode segments on; may be nullptr
+      WorkerPool* m_workerPool;
+
+      /// maximum number of segments encoded or waiting to be written out
+      unsigned int m_maxSegmentsInFlight;
+
+      /// number of frames in a segment
+      unsigned int m_numFramesPerSegment;
+
+      /// samples of the current segment, including overlap before the segment
+      std::vector<unsigned char> m_segmentSamples;
+
+      /// number of overlap frames at the start of the current segment buffer
+      unsigned int m_numSegmentOverlapFrames = 0;
+
+      /// segments currently being encoded, in stream order
+      std::deque<std::future<SegmentResult>> m_pendingSegments;
+
+      /// info tag with all frames written
+      Mp3InfoTag m_infoTag;
+
+      /// number of samples added, per channel
+      unsigned long long m_numSamples = 0;
+
+      /// last error
+      CString m_lastError;
+   };
+
+} // namespace Encoder
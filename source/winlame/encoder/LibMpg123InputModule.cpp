@@ -31,7 +31,7 @@ using Encoder::SampleContainer;
 
 LibMpg123InputModule::LibMpg123InputModule()
 :m_isAtEndOfFile(false),
-m_fileSize(0L)
+m_fileSize(0)
 {
    m_moduleId = ID_IM_LIBMPG123;
 }
@@ -135,19 +135,13 @@ int LibMpg123InputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
 
    m_decoder.reset(handle, mpg123_delete);
 
-   FILE* fd = nullptr;
-   errno_t err = _tfopen_s(&fd, infilename, _T("rb"));
-
-   if (err != 0 || fd == nullptr)
+   if (!m_inputSource.Open(infilename))
    {
       m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
       return -1;
    }
 
-   m_inputFile.reset(fd, fclose);
-
-   if (!GetFileSize())
-      return -1;
+   m_fileSize = m_inputSource.Length();
 
    GetTrackInfo(infilename, trackInfo);
 
@@ -184,10 +178,15 @@ void LibMpg123InputModule::GetInfo(int& numChannels, int& bitrateInBps, int& len
 
 int LibMpg123InputModule::DecodeSamples(SampleContainer& samples)
 {
-   unsigned char sampleBuffer[32768];
+   // mpg123_read() fills the whole buffer, so read as many samples as the output module prefers
+   int sampleSize = samples.GetInputModuleBitsPerSample();
+
+   size_t bufferSize = size_t(samples.GetPreferredBlockSize()) * m_channels * (sampleSize / 8);
+   if (m_sampleBuffer.size() < bufferSize)
+      m_sampleBuffer.resize(bufferSize);
 
    size_t bytesWritten = 0;
-   int ret = mpg123_read(m_decoder.get(), sampleBuffer, sizeof(sampleBuffer), &bytesWritten);
+   int ret = mpg123_read(m_decoder.get(), m_sampleBuffer.data(), bufferSize, &bytesWritten);
    if (ret != MPG123_OK &&
       ret != MPG123_DONE)
    {
@@ -202,10 +201,9 @@ int LibMpg123InputModule::DecodeSamples(SampleContainer& samples)
    if (bytesWritten == 0)
       return 0;
 
-   int sampleSize = samples.GetInputModuleBitsPerSample();
    int numSamplesPerChannel = bytesWritten / m_channels / (sampleSize / 8);
 
-   samples.PutSamplesInterleaved(sampleBuffer, numSamplesPerChannel);
+   samples.PutSamplesInterleavedBorrowed(m_sampleBuffer.data(), numSamplesPerChannel);
 
    return numSamplesPerChannel;
 }
@@ -213,17 +211,15 @@ int LibMpg123InputModule::DecodeSamples(SampleContainer& samples)
 float LibMpg123InputModule::PercentDone() const
 {
    if (m_decoder == nullptr ||
-      m_inputFile == nullptr ||
+      !m_inputSource.IsOpen() ||
       m_fileSize == 0)
       return 0.0f;
 
-   if (feof(m_inputFile.get()) ||
+   if (m_inputSource.IsEndOfFile() ||
       m_isAtEndOfFile)
       return 100.0f;
 
-   long pos = ftell(m_inputFile.get());
-
-   return float(pos) * 100.0f / m_fileSize;
+   return float(m_inputSource.Position()) * 100.0f / m_fileSize;
 }
 
 void LibMpg123InputModule::DoneInput()
@@ -234,46 +230,26 @@ void LibMpg123InputModule::DoneInput()
       mpg123_close(m_decoder.get());
 
    m_decoder.reset();
-}
-
-bool LibMpg123InputModule::GetFileSize()
-{
-   errno_t err = fseek(m_inputFile.get(), 0, SEEK_END);
-   if (err != 0)
-   {
-      m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
-      m_inputFile.reset();
-      return false;
-   }
 
-   m_fileSize = ftell(m_inputFile.get());
-
-   err = fseek(m_inputFile.get(), 0, SEEK_SET);
-   if (err != 0)
-   {
-      m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
-      m_inputFile.reset();
-      return false;
-   }
-
-   return true;
+   m_inputSource.Close();
 }
 
 static mpg123_ssize_t ReadFromFile(void* handle, void* buffer, size_t size)
 {
-   return fread(buffer, 1, size, (FILE*)handle);
+   return static_cast<mpg123_ssize_t>(reinterpret_cast<Encoder::InputSource*>(handle)->Read(buffer, size));
 }
 
 static off_t SeekInFile(void* handle, off_t offset, int direction)
 {
-   if (fseek((FILE*)handle, offset, direction) != 0)
+   Encoder::InputSource* inputSource = reinterpret_cast<Encoder::InputSource*>(handle);
+   if (!inputSource->Seek(offset, direction))
       return (off_t)-1;
-   return ftell((FILE*)handle);
+   return static_cast<off_t>(inputSource->Position());
 }
 
 static void CleanupFile(void* handle)
 {
-   // don't fclose the handle here, since m_inputFile will do that for us
+   // don't close the input source here, since DoneInput() will do that for us
    UNUSED(handle);
 }
 
@@ -281,7 +257,7 @@ bool LibMpg123InputModule::OpenStream()
 {
    mpg123_replace_reader_handle(m_decoder.get(), ReadFromFile, SeekInFile, CleanupFile);
 
-   int ret = mpg123_open_handle(m_decoder.get(), m_inputFile.get());
+   int ret = mpg123_open_handle(m_decoder.get(), &m_inputSource);
    if (ret != MPG123_OK)
    {
       m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
@@ -302,11 +278,10 @@ bool LibMpg123InputModule::GetTrackInfo(const CString& filename, TrackInfo& trac
    // search for id3v1 tag
    if (!found)
    {
-      errno_t err = fseek(m_inputFile.get(), -128L, SEEK_END);
-      if (err == 0)
+      if (m_inputSource.Seek(-128L, SEEK_END))
       {
          Id3v1Tag id3tag;
-         int ret = fread(id3tag.GetData(), 128, 1, m_inputFile.get());
+         size_t ret = m_inputSource.Read(id3tag.GetData(), 128);
          if (ret == 128 && id3tag.IsValidTag())
          {
             // store found id3 tag infos
@@ -315,8 +290,7 @@ bool LibMpg123InputModule::GetTrackInfo(const CString& filename, TrackInfo& trac
          }
       }
 
-      err = fseek(m_inputFile.get(), 0, SEEK_SET);
-      if (err != 0)
+      if (!m_inputSource.Seek(0, SEEK_SET))
          return false;
    }
 
@@ -339,8 +313,11 @@ bool LibMpg123InputModule::SetupDecoder()
 
    for (long rate : std::vector<long>(ratesList, ratesList + ratesListSize))
    {
-      // only request 32-bit samples
-      int ret = mpg123_format(m_decoder.get(), rate, MPG123_STEREO | MPG123_MONO, MPG123_ENC_SIGNED_32);
+      // request float samples, as the decoder synthesizes them natively; fall back to
+      // 32-bit integer samples when the library was built without float output
+      int ret = mpg123_format(m_decoder.get(), rate, MPG123_STEREO | MPG123_MONO, MPG123_ENC_FLOAT_32);
+      if (ret != MPG123_OK)
+         ret = mpg123_format(m_decoder.get(), rate, MPG123_STEREO | MPG123_MONO, MPG123_ENC_SIGNED_32);
 
       if (ret != MPG123_OK)
       {
@@ -369,7 +346,10 @@ bool LibMpg123InputModule::SetFormat(SampleContainer& samples)
    m_channels = numChannels;
    m_samplerate = sampleRate;
 
-   samples.SetInputModuleTraits(encoding == MPG123_ENC_SIGNED_32 ? 32 : 16, SamplesInterleaved, m_samplerate, numChannels);
+   if (encoding == MPG123_ENC_FLOAT_32)
+      samples.SetInputModuleFloatTraits(SamplesInterleaved, m_samplerate, numChannels);
+   else
+      samples.SetInputModuleTraits(encoding == MPG123_ENC_SIGNED_32 ? 32 : 16, SamplesInterleaved, m_samplerate, numChannels);
 
    return true;
 }
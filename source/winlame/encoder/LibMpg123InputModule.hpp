@@ -22,6 +22,7 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
+#include "InputSource.hpp"
 #define MPG123_ENUM_API
 #include <mpg123.h>
 
@@ -74,9 +75,6 @@ namespace Encoder
       virtual void DoneInput() override;
 
    private:
-      /// reads file size from opened input file
-      bool GetFileSize();
-
       /// opens m3 stream from input file
       bool OpenStream();
 
@@ -96,17 +94,20 @@ namespace Encoder
       /// last error text
       CString m_lastError;
 
-      /// input file
-      std::shared_ptr<FILE> m_inputFile;
+      /// input source
+      InputSource m_inputSource;
 
       /// file size of input file
-      long m_fileSize;
+      unsigned long long m_fileSize;
 
       /// handle to the mpg123 decoder
       std::shared_ptr<mpg123_handle> m_decoder;
 
       /// indicates if the decoder is at the end of the file
       bool m_isAtEndOfFile;
+
+      /// sample buffer; lent to the sample container until the next DecodeSamples() call
+      std::vector<unsigned char> m_sampleBuffer;
    };
 
 } // namespace Encoder
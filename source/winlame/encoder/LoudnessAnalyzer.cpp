@@ -0,0 +1,608 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file LoudnessAnalyzer.cpp
+/// \brief EBU R128 loudness and sample peak analyzer, for ReplayGain tags
+//
+#include "stdafx.h"
+#include "LoudnessAnalyzer.hpp"
+#include "SampleContainer.hpp"
+#include "SampleConverter.hpp"
+#include "TrackInfo.hpp"
+#include <immintrin.h>
+#include <cmath>
+#include <numeric>
+
+using Encoder::LoudnessResult;
+using Encoder::LoudnessHistogram;
+using Encoder::LoudnessAnalyzer;
+using Encoder::LoudnessAlbum;
+
+namespace
+{
+   /// biquad filter coefficients
+   typedef LoudnessAnalyzer::BiquadCoefficients BiquadCoefficients;
+
+   /// channel weights for up to 8 channels, in WAVE channel order; the LFE channel isn't
+   /// weighted, and surround channels are weighted by +1.5 dB, as in ITU-R BS.1770-4
+   const double c_channelWeights[8][8] =
+   {
+      { 1.0 },                                        // mono
+      { 1.0, 1.0 },                                   // stereo
+      { 1.0, 1.0, 1.0 },                              // L, R, C
+      { 1.0, 1.0, 1.41, 1.41 },                       // quadrophonic
+      { 1.0, 1.0, 1.0, 1.41, 1.41 },                  // L, R, C, BL, BR
+      { 1.0, 1.0, 1.0, 0.0, 1.41, 1.41 },             // 5.1
+      { 1.0, 1.0, 1.0, 0.0, 1.41, 1.41, 1.41 },       // 6.1
+      { 1.0, 1.0, 1.0, 0.0, 1.41, 1.41, 1.41, 1.41 }, // 7.1
+   };
+
+   /// runs both K-weighting filters, plain C++ version, for all channels starting at firstChannel
+   void FilterChannelsScalar(const float* samples, size_t numSamples, size_t numChannels,
+      size_t firstChannel, const BiquadCoefficients* coefficients, double* state, double* sums)
+   {
+      const BiquadCoefficients& shelving = coefficients[0];
+      const BiquadCoefficients& highpass = coefficients[1];
+
+      for (size_t channel = firstChannel; channel < numChannels; channel++)
+      {
+         double shelving1 = state[channel];
+         double shelving2 = state[numChannels + channel];
+         double highpass1 = state[2 * numChannels + channel];
+         double highpass2 = state[3 * numChannels + channel];
+         double sum = 0.0;
+
+         const float* sample = samples + channel;
+         for (size_t index = 0; index < numSamples; index++, sample += numChannels)
+         {
+            // both filters in transposed direct form II
+            double x = *sample;
+            double y = shelving.b0 * x + shelving1;
+            shelving1 = shelving.b1 * x - shelving.a1 * y + shelving2;
+            shelving2 = shelving.b2 * x - shelving.a2 * y;
+
+            double z = highpass.b0 * y + highpass1;
+            highpass1 = highpass.b1 * y - highpass.a1 * z + highpass2;
+            highpass2 = highpass.b2 * y - highpass.a2 * z;
+
+            sum += z * z;
+         }
+
+         state[channel] = shelving1;
+         state[numChannels + channel] = shelving2;
+         state[2 * numChannels + channel] = highpass1;
+         state[3 * numChannels + channel] = highpass2;
+         sums[channel] += sum;
+      }
+   }
+
+   /// runs both K-weighting filters, SSE2 version, for pairs of channels starting at
+   /// firstChannel; returns the first channel that wasn't filtered
+   size_t FilterChannelPairsSSE2(const float* samples, size_t numSamples, size_t numChannels,
+      size_t firstChannel, const BiquadCoefficients* coefficients, double* state, double* sums)
+   {
+      const __m128d shelvingB0 = _mm_set1_pd(coefficients[0].b0);
+      const __m128d shelvingB1 = _mm_set1_pd(coefficients[0].b1);
+      const __m128d shelvingB2 = _mm_set1_pd(coefficients[0].b2);
+      const __m128d shelvingA1 = _mm_set1_pd(coefficients[0].a1);
+      const __m128d shelvingA2 = _mm_set1_pd(coefficients[0].a2);
+      const __m128d highpassB0 = _mm_set1_pd(coefficients[1].b0);
+      const __m128d highpassB1 = _mm_set1_pd(coefficients[1].b1);
+      const __m128d highpassB2 = _mm_set1_pd(coefficients[1].b2);
+      const __m128d highpassA1 = _mm_set1_pd(coefficients[1].a1);
+      const __m128d highpassA2 = _mm_set1_pd(coefficients[1].a2);
+
+      size_t channel = firstChannel;
+      for (; channel + 2 <= numChannels; channel += 2)
+      {
+         __m128d shelving1 = _mm_loadu_pd(state + channel);
+         __m128d shelving2 = _mm_loadu_pd(state + numChannels + channel);
+         __m128d highpass1 = _mm_loadu_pd(state + 2 * numChannels + channel);
+         __m128d highpass2 = _mm_loadu_pd(state + 3 * numChannels + channel);
+         __m128d sum = _mm_setzero_pd();
+
+         const float* sample = samples + channel;
+         for (size_t index = 0; index < numSamples; index++, sample += numChannels)
+         {
+            __m128d x = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(sample))));
+
+            __m128d y = _mm_add_pd(_mm_mul_pd(shelvingB0, x), shelving1);
+            shelving1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(shelvingB1, x), _mm_mul_pd(shelvingA1, y)), shelving2);
+            shelving2 = _mm_sub_pd(_mm_mul_pd(shelvingB2, x), _mm_mul_pd(shelvingA2, y));
+
+            __m128d z = _mm_add_pd(_mm_mul_pd(highpassB0, y), highpass1);
+            highpass1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(highpassB1, y), _mm_mul_pd(highpassA1, z)), highpass2);
+            highpass2 = _mm_sub_pd(_mm_mul_pd(highpassB2, y), _mm_mul_pd(highpassA2, z));
+
+            sum = _mm_add_pd(sum, _mm_mul_pd(z, z));
+         }
+
+         _mm_storeu_pd(state + channel, shelving1);
+         _mm_storeu_pd(state + numChannels + channel, shelving2);
+         _mm_storeu_pd(state + 2 * numChannels + channel, highpass1);
+         _mm_storeu_pd(state + 3 * numChannels + channel, highpass2);
+         _mm_storeu_pd(sums + channel, _mm_add_pd(_mm_loadu_pd(sums + channel), sum));
+      }
+
+      return channel;
+   }
+
+   /// runs both K-weighting filters, AVX2 version, for groups of four channels starting
+   /// at firstChannel; returns the first channel that wasn't filtered
+   size_t FilterChannelQuadsAVX2(const float* samples, size_t numSamples, size_t numChannels,
+      size_t firstChannel, const BiquadCoefficients* coefficients, double* state, double* sums)
+   {
+      const __m256d shelvingB0 = _mm256_set1_pd(coefficients[0].b0);
+      const __m256d shelvingB1 = _mm256_set1_pd(coefficients[0].b1);
+      const __m256d shelvingB2 = _mm256_set1_pd(coefficients[0].b2);
+      const __m256d shelvingA1 = _mm256_set1_pd(coefficients[0].a1);
+      const __m256d shelvingA2 = _mm256_set1_pd(coefficients[0].a2);
+      const __m256d highpassB0 = _mm256_set1_pd(coefficients[1].b0);
+      const __m256d highpassB1 = _mm256_set1_pd(coefficients[1].b1);
+      const __m256d highpassB2 = _mm256_set1_pd(coefficients[1].b2);
+      const __m256d highpassA1 = _mm256_set1_pd(coefficients[1].a1);
+      const __m256d highpassA2 = _mm256_set1_pd(coefficients[1].a2);
+
+      size_t channel = firstChannel;
+      for (; channel + 4 <= numChannels; channel += 4)
+      {
+         __m256d shelving1 = _mm256_loadu_pd(state + channel);
+         __m256d shelving2 = _mm256_loadu_pd(state + numChannels + channel);
+         __m256d highpass1 = _mm256_loadu_pd(state + 2 * numChannels + channel);
+         __m256d highpass2 = _mm256_loadu_pd(state + 3 * numChannels + channel);
+         __m256d sum = _mm256_setzero_pd();
+
+         const float* sample = samples + channel;
+         for (size_t index = 0; index < numSamples; index++, sample += numChannels)
+         {
+            __m256d x = _mm256_cvtps_pd(_mm_loadu_ps(sample));
+
+            __m256d y = _mm256_add_pd(_mm256_mul_pd(shelvingB0, x), shelving1);
+            shelving1 = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(shelvingB1, x), _mm256_mul_pd(shelvingA1, y)), shelving2);
+            shelving2 = _mm256_sub_pd(_mm256_mul_pd(shelvingB2, x), _mm256_mul_pd(shelvingA2, y));
+
+            __m256d z = _mm256_add_pd(_mm256_mul_pd(highpassB0, y), highpass1);
+            highpass1 = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(highpassB1, y), _mm256_mul_pd(highpassA1, z)), highpass2);
+            highpass2 = _mm256_sub_pd(_mm256_mul_pd(highpassB2, y), _mm256_mul_pd(highpassA2, z));
+
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(z, z));
+         }
+
+         _mm256_storeu_pd(state + channel, shelving1);
+         _mm256_storeu_pd(state + numChannels + channel, shelving2);
+         _mm256_storeu_pd(state + 2 * numChannels + channel, highpass1);
+         _mm256_storeu_pd(state + 3 * numChannels + channel, highpass2);
+         _mm256_storeu_pd(sums + channel, _mm256_add_pd(_mm256_loadu_pd(sums + channel), sum));
+      }
+
+      _mm256_zeroupper();
+
+      return channel;
+   }
+
+   /// runs both K-weighting filters, plain C++ version
+   void FilterScalar(const float* samples, size_t numSamples, size_t numChannels,
+      const BiquadCoefficients* coefficients, double* state, double* sums)
+   {
+      FilterChannelsScalar(samples, numSamples, numChannels, 0, coefficients, state, sums);
+   }
+
+   /// runs both K-weighting filters, SSE2 version, with scalar fallback for the last channel
+   void FilterSSE2(const float* samples, size_t numSamples, size_t numChannels,
+      const BiquadCoefficients* coefficients, double* state, double* sums)
+   {
+      size_t channel = FilterChannelPairsSSE2(samples, numSamples, numChannels, 0, coefficients, state, sums);
+      FilterChannelsScalar(samples, numSamples, numChannels, channel, coefficients, state, sums);
+   }
+
+   /// runs both K-weighting filters, AVX2 version, with SSE2 and scalar fallback for the last channels
+   void FilterAVX2(const float* samples, size_t numSamples, size_t numChannels,
+      const BiquadCoefficients* coefficients, double* state, double* sums)
+   {
+      size_t channel = FilterChannelQuadsAVX2(samples, numSamples, numChannels, 0, coefficients, state, sums);
+      channel = FilterChannelPairsSSE2(samples, numSamples, numChannels, channel, coefficients, state, sums);
+      FilterChannelsScalar(samples, numSamples, numChannels, channel, coefficients, state, sums);
+   }
+
+   /// returns maximum absolute sample value, plain C++ version
+   float PeakScalar(const float* samples, size_t count)
+   {
+      float peak = 0.0f;
+      for (size_t index = 0; index < count; index++)
+         peak = std::max(peak, std::fabs(samples[index]));
+
+      return peak;
+   }
+
+   /// returns maximum absolute sample value, SSE2 version
+   float PeakSSE2(const float* samples, size_t count)
+   {
+      const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+      __m128 peak1 = _mm_setzero_ps();
+      __m128 peak2 = _mm_setzero_ps();
+
+      size_t index = 0;
+      for (; index + 8 <= count; index += 8)
+      {
+         peak1 = _mm_max_ps(peak1, _mm_and_ps(_mm_loadu_ps(samples + index), absMask));
+         peak2 = _mm_max_ps(peak2, _mm_and_ps(_mm_loadu_ps(samples + index + 4), absMask));
+      }
+
+      __m128 peak = _mm_max_ps(peak1, peak2);
+      peak = _mm_max_ps(peak, _mm_movehl_ps(peak, peak));
+      peak = _mm_max_ss(peak, _mm_shuffle_ps(peak, peak, 1));
+
+      return std::max(_mm_cvtss_f32(peak), PeakScalar(samples + index, count - index));
+   }
+
+   /// returns maximum absolute sample value, AVX2 version
+   float PeakAVX2(const float* samples, size_t count)
+   {
+      const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+      __m256 peak1 = _mm256_setzero_ps();
+      __m256 peak2 = _mm256_setzero_ps();
+
+      size_t index = 0;
+      for (; index + 16 <= count; index += 16)
+      {
+         peak1 = _mm256_max_ps(peak1, _mm256_and_ps(_mm256_loadu_ps(samples + index), absMask));
+         peak2 = _mm256_max_ps(peak2, _mm256_and_ps(_mm256_loadu_ps(samples + index + 8), absMask));
+      }
+
+      __m256 peak256 = _mm256_max_ps(peak1, peak2);
+      __m128 peak = _mm_max_ps(_mm256_castps256_ps128(peak256), _mm256_extractf128_ps(peak256, 1));
+
+      _mm256_zeroupper();
+
+      peak = _mm_max_ps(peak, _mm_movehl_ps(peak, peak));
+      peak = _mm_max_ss(peak, _mm_shuffle_ps(peak, peak, 1));
+
+      return std::max(_mm_cvtss_f32(peak), PeakSSE2(samples + index, count - index));
+   }
+
+} // unnamed namespace
+
+void LoudnessResult::StoreTrackGain(TrackInfo& trackInfo) const
+{
+   CString text;
+   text.Format(_T("%+.2f dB"), GetGain());
+   trackInfo.SetTextInfo(TrackInfoTrackGain, text);
+
+   text.Format(_T("%.6f"), m_peak);
+   trackInfo.SetTextInfo(TrackInfoTrackPeak, text);
+}
+
+void LoudnessResult::StoreAlbumGain(TrackInfo& trackInfo) const
+{
+   CString text;
+   text.Format(_T("%+.2f dB"), GetGain());
+   trackInfo.SetTextInfo(TrackInfoAlbumGain, text);
+
+   text.Format(_T("%.6f"), m_peak);
+   trackInfo.SetTextInfo(TrackInfoAlbumPeak, text);
+}
+
+LoudnessHistogram::LoudnessHistogram()
+   :m_binBlockCounts(c_numBins),
+   m_binEnergies(c_numBins),
+   m_numBlocks(0)
+{
+}
+
+void LoudnessHistogram::AddBlock(double energy)
+{
+   double loudness = LoudnessFromEnergy(energy);
+
+   // also catches silence, with a loudness of -inf
+   if (!(loudness > c_absoluteGate))
+      return;
+
+   unsigned int bin = BinFromLoudness(loudness);
+   m_binBlockCounts[bin]++;
+   m_binEnergies[bin] += energy;
+   m_numBlocks++;
+}
+
+void LoudnessHistogram::Merge(const LoudnessHistogram& other)
+{
+   for (unsigned int bin = 0; bin < c_numBins; bin++)
+   {
+      m_binBlockCounts[bin] += other.m_binBlockCounts[bin];
+      m_binEnergies[bin] += other.m_binEnergies[bin];
+   }
+
+   m_numBlocks += other.m_numBlocks;
+}
+
+bool LoudnessHistogram::GetIntegratedLoudness(double& loudness) const
+{
+   if (m_numBlocks == 0)
+      return false;
+
+   // the relative gate is calculated from all blocks above the absolute gate
+   double totalEnergy = std::accumulate(m_binEnergies.begin(), m_binEnergies.end(), 0.0);
+   double relativeGate = LoudnessFromEnergy(totalEnergy / m_numBlocks) + c_relativeGate;
+
+   unsigned int firstBin = relativeGate > c_absoluteGate ? BinFromLoudness(relativeGate) : 0;
+
+   unsigned long long numGatedBlocks = 0;
+   double gatedEnergy = 0.0;
+   for (unsigned int bin = firstBin; bin < c_numBins; bin++)
+   {
+      numGatedBlocks += m_binBlockCounts[bin];
+      gatedEnergy += m_binEnergies[bin];
+   }
+
+   if (numGatedBlocks == 0)
+      return false;
+
+   loudness = LoudnessFromEnergy(gatedEnergy / numGatedBlocks);
+   return true;
+}
+
+void LoudnessHistogram::Reset()
+{
+   std::fill(m_binBlockCounts.begin(), m_binBlockCounts.end(), 0);
+   std::fill(m_binEnergies.begin(), m_binEnergies.end(), 0.0);
+   m_numBlocks = 0;
+}
+
+double LoudnessHistogram::LoudnessFromEnergy(double energy)
+{
+   return -0.691 + 10.0 * std::log10(energy);
+}
+
+unsigned int LoudnessHistogram::BinFromLoudness(double loudness)
+{
+   double bin = (loudness - c_absoluteGate) * c_binsPerLU;
+   return bin < c_numBins ? static_cast<unsigned int>(bin) : c_numBins - 1;
+}
+
+LoudnessAnalyzer::LoudnessAnalyzer()
+   :m_numChannels(0),
+   m_coefficients{},
+   m_fnFilter(&FilterScalar),
+   m_fnPeak(&PeakScalar),
+   m_subBlockLength(0),
+   m_subBlockPos(0),
+   m_subBlockEnergies{},
+   m_numSubBlocks(0),
+   m_peak(0.0f)
+{
+}
+
+bool LoudnessAnalyzer::Init(unsigned int samplerateInHz, unsigned int numChannels)
+{
+   // the Nyquist frequency must be well above the shelving filter frequency of about 1.7 kHz
+   if (samplerateInHz < 8000 || numChannels == 0)
+      return false;
+
+   m_numChannels = numChannels;
+
+   // filter coefficients for any sample rate, derived from the 48 kHz coefficients
+   // given in ITU-R BS.1770-4; shelving filter first
+   const double pi = 3.14159265358979323846;
+   double K = std::tan(pi * 1681.974450955533 / samplerateInHz);
+   double Q = 0.7071752369554196;
+   double Vh = std::pow(10.0, 3.999843853973347 / 20.0);
+   double Vb = std::pow(Vh, 0.4996667741545416);
+   double a0 = 1.0 + K / Q + K * K;
+
+   m_coefficients[0].b0 = (Vh + Vb * K / Q + K * K) / a0;
+   m_coefficients[0].b1 = 2.0 * (K * K - Vh) / a0;
+   m_coefficients[0].b2 = (Vh - Vb * K / Q + K * K) / a0;
+   m_coefficients[0].a1 = 2.0 * (K * K - 1.0) / a0;
+   m_coefficients[0].a2 = (1.0 - K / Q + K * K) / a0;
+
+   // highpass filter
+   K = std::tan(pi * 38.13547087602444 / samplerateInHz);
+   Q = 0.5003270373238773;
+   a0 = 1.0 + K / Q + K * K;
+
+   m_coefficients[1].b0 = 1.0;
+   m_coefficients[1].b1 = -2.0;
+   m_coefficients[1].b2 = 1.0;
+   m_coefficients[1].a1 = 2.0 * (K * K - 1.0) / a0;
+   m_coefficients[1].a2 = (1.0 - K / Q + K * K) / a0;
+
+   m_channelWeights.assign(numChannels, 1.0);
+   if (numChannels <= 8)
+      std::copy(c_channelWeights[numChannels - 1], c_channelWeights[numChannels - 1] + numChannels, m_channelWeights.begin());
+
+   m_filterState.resize(4 * size_t(numChannels));
+   m_channelSums.resize(numChannels);
+   m_conversionBuffer.resize(c_maxConversionSamples * numChannels);
+
+   switch (SampleConverter::GetInstructionSet())
+   {
+   case instructionSetAVX2:
+      m_fnFilter = &FilterAVX2;
+      m_fnPeak = &PeakAVX2;
+      break;
+   case instructionSetSSE2:
+      m_fnFilter = &FilterSSE2;
+      m_fnPeak = &PeakSSE2;
+      break;
+   default:
+      m_fnFilter = &FilterScalar;
+      m_fnPeak = &PeakScalar;
+      break;
+   }
+
+   m_subBlockLength = (samplerateInHz + 5) / 10;
+
+   Reset();
+
+   return true;
+}
+
+void LoudnessAnalyzer::AnalyzeSamples(SampleContainer& samples)
+{
+   if (m_numChannels == 0)
+      return;
+
+   SampleType sampleType = samples.GetOutputModuleSampleType();
+   size_t sampleSize = SampleConverter::GetSampleSize(sampleType);
+
+   int numSamples = 0;
+   if (samples.GetOutputModuleSampleFormat() == SamplesInterleaved)
+   {
+      const unsigned char* interleaved =
+         static_cast<const unsigned char*>(samples.GetSamplesInterleaved(numSamples));
+
+      if (sampleType == SampleTypeFloat32)
+      {
+         AnalyzeInterleaved(reinterpret_cast<const float*>(interleaved), static_cast<size_t>(numSamples));
+         return;
+      }
+
+      for (size_t offset = 0; offset < static_cast<size_t>(numSamples); offset += c_maxConversionSamples)
+      {
+         size_t count = std::min(c_maxConversionSamples, static_cast<size_t>(numSamples) - offset);
+
+         SampleConverter::InterleavedToInterleaved(
+            interleaved + offset * m_numChannels * sampleSize, sampleType,
+            m_conversionBuffer.data(), SampleTypeFloat32,
+            count, m_numChannels);
+
+         AnalyzeInterleaved(m_conversionBuffer.data(), count);
+      }
+   }
+   else
+   {
+      void** channelArray = samples.GetSamplesArray(numSamples);
+
+      std::vector<const void*> channels(m_numChannels);
+      for (size_t offset = 0; offset < static_cast<size_t>(numSamples); offset += c_maxConversionSamples)
+      {
+         size_t count = std::min(c_maxConversionSamples, static_cast<size_t>(numSamples) - offset);
+
+         for (unsigned int channel = 0; channel < m_numChannels; channel++)
+            channels[channel] = static_cast<const unsigned char*>(channelArray[channel]) + offset * sampleSize;
+
+         SampleConverter::ArrayToInterleaved(
+            channels.data(), sampleType,
+            m_conversionBuffer.data(), SampleTypeFloat32,
+            count, m_numChannels);
+
+         AnalyzeInterleaved(m_conversionBuffer.data(), count);
+      }
+   }
+}
+
+void LoudnessAnalyzer::AnalyzeInterleaved(const float* samples, size_t numSamples)
+{
+   if (m_numChannels == 0)
+      return;
+
+   m_peak = std::max(m_peak, m_fnPeak(samples, numSamples * m_numChannels));
+
+   while (numSamples > 0)
+   {
+      size_t count = std::min(numSamples, m_subBlockLength - m_subBlockPos);
+
+      FilterSamples(samples, count);
+
+      samples += count * m_numChannels;
+      numSamples -= count;
+   }
+}
+
+LoudnessResult LoudnessAnalyzer::GetResult() const
+{
+   LoudnessResult result;
+   result.m_isValid = m_histogram.GetIntegratedLoudness(result.m_loudness);
+   result.m_peak = m_peak;
+
+   return result;
+}
+
+void LoudnessAnalyzer::Reset()
+{
+   std::fill(m_filterState.begin(), m_filterState.end(), 0.0);
+   std::fill(m_channelSums.begin(), m_channelSums.end(), 0.0);
+   std::fill(std::begin(m_subBlockEnergies), std::end(m_subBlockEnergies), 0.0);
+
+   m_subBlockPos = 0;
+   m_numSubBlocks = 0;
+   m_histogram.Reset();
+   m_peak = 0.0f;
+}
+
+void LoudnessAnalyzer::FilterSamples(const float* samples, size_t numSamples)
+{
+   m_fnFilter(samples, numSamples, m_numChannels, m_coefficients, m_filterState.data(), m_channelSums.data());
+
+   m_subBlockPos += numSamples;
+   if (m_subBlockPos == m_subBlockLength)
+      FinishSubBlock();
+}
+
+void LoudnessAnalyzer::FinishSubBlock()
+{
+   double energy = 0.0;
+   for (unsigned int channel = 0; channel < m_numChannels; channel++)
+   {
+      energy += m_channelWeights[channel] * m_channelSums[channel];
+      m_channelSums[channel] = 0.0;
+   }
+
+   m_subBlockEnergies[m_numSubBlocks % 4] = energy;
+   m_numSubBlocks++;
+   m_subBlockPos = 0;
+
+   // a gating block consists of the last 4 sub-blocks; the samples of an incomplete
+   // sub-block at the end of the stream are never part of a gating block
+   if (m_numSubBlocks >= 4)
+   {
+      double blockEnergy =
+         (m_subBlockEnergies[0] + m_subBlockEnergies[1]) +
+         (m_subBlockEnergies[2] + m_subBlockEnergies[3]);
+
+      m_histogram.AddBlock(blockEnergy / (4.0 * m_subBlockLength));
+   }
+}
+
+void LoudnessAlbum::AddTrack(const CString& filename, const LoudnessAnalyzer& analyzer)
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   m_filenames.push_back(filename);
+   m_histogram.Merge(analyzer.GetHistogram());
+   m_peak = std::max(m_peak, analyzer.GetPeak());
+}
+
+LoudnessResult LoudnessAlbum::GetResult() const
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   LoudnessResult result;
+   result.m_isValid = m_histogram.GetIntegratedLoudness(result.m_loudness);
+   result.m_peak = m_peak;
+
+   return result;
+}
+
+std::vector<CString> LoudnessAlbum::GetFilenames() const
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   return m_filenames;
+}
@@ -0,0 +1,258 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file LoudnessAnalyzer.hpp
+/// \brief EBU R128 loudness and sample peak analyzer, for ReplayGain tags
+//
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+namespace Encoder
+{
+   class SampleContainer;
+   class TrackInfo;
+
+   /// loudness and peak of a track or an album
+   struct LoudnessResult
+   {
+      /// indicates if the loudness was measured; false when there were no samples, or only silence
+      bool m_isValid = false;
+
+      /// integrated loudness, in LUFS
+      double m_loudness = 0.0;
+
+      /// sample peak, where 1.0 is full scale
+      double m_peak = 0.0;
+
+      /// returns the ReplayGain 2.0 gain adjustment, in dB
+      double GetGain() const { return c_replayGainReference - m_loudness; }
+
+      /// stores gain and peak as track ReplayGain infos in the track info
+      void StoreTrackGain(TrackInfo& trackInfo) const;
+
+      /// stores gain and peak as album ReplayGain infos in the track info
+      void StoreAlbumGain(TrackInfo& trackInfo) const;
+
+      /// reference loudness of ReplayGain 2.0, in LUFS
+      static constexpr double c_replayGainReference = -18.0;
+   };
+
+   /// \brief histogram of the loudness of all gating blocks of a track or album
+   /// \details Blocks are counted in bins of 1/c_binsPerLU LU, from the absolute
+   /// gate up to +5 LUFS, and the energy of each bin is summed up exactly. The
+   /// integrated loudness is calculated from the bins above the relative gate, so
+   /// that a block is gated with an error of at most one bin width, without
+   /// storing every block. Histograms of tracks can be merged to get the album loudness.
+   class LoudnessHistogram
+   {
+   public:
+      /// ctor
+      LoudnessHistogram();
+
+      /// adds a gating block with given mean square energy; blocks below the absolute gate are ignored
+      void AddBlock(double energy);
+
+      /// adds all blocks of another histogram
+      void Merge(const LoudnessHistogram& other);
+
+      /// returns the number of blocks above the absolute gate
+      unsigned long long GetNumBlocks() const { return m_numBlocks; }
+
+      /// \brief calculates the integrated loudness, in LUFS, as in ITU-R BS.1770-4
+      /// \details returns false when there are no blocks above the absolute gate
+      bool GetIntegratedLoudness(double& loudness) const;
+
+      /// removes all blocks
+      void Reset();
+
+      /// converts mean square energy of a block to loudness, in LUFS
+      static double LoudnessFromEnergy(double energy);
+
+      /// absolute gate, in LUFS
+      static constexpr double c_absoluteGate = -70.0;
+
+      /// relative gate, in LU below the loudness of all blocks above the absolute gate
+      static constexpr double c_relativeGate = -10.0;
+
+      /// number of bins per LU
+      static constexpr unsigned int c_binsPerLU = 10;
+
+      /// number of bins, from the absolute gate to +5 LUFS
+      static constexpr unsigned int c_numBins = 75 * c_binsPerLU;
+
+   private:
+      /// returns bin index for given loudness, in LUFS; must be above the absolute gate
+      static unsigned int BinFromLoudness(double loudness);
+
+   private:
+      /// number of blocks in each bin
+      std::vector<unsigned long long> m_binBlockCounts;
+
+      /// summed energy of the blocks in each bin
+      std::vector<double> m_binEnergies;
+
+      /// number of blocks in all bins
+      unsigned long long m_numBlocks;
+   };
+
+   /// \brief measures integrated loudness and sample peak of a sample stream
+   /// \details The loudness is measured as specified by ITU-R BS.1770-4 and EBU
+   /// R128: the samples are K-weighted by a high shelving filter and a highpass
+   /// filter, whose coefficients are calculated for the sample rate, and the
+   /// weighted mean square of all channels is taken over 400 ms blocks that
+   /// overlap by 75%. The filters are IIR filters, so they can't be vectorized
+   /// along the samples of a channel; instead, the kernels run the filters of
+   /// two (SSE2) or four (AVX2) neighbouring channels of the interleaved samples
+   /// in the lanes of one register, in double precision. The sample peak is
+   /// searched over all samples at once. The instruction set selected for the
+   /// SampleConverter is used.
+   class LoudnessAnalyzer
+   {
+   public:
+      /// coefficients of a biquad filter, with a0 normalized to 1
+      struct BiquadCoefficients
+      {
+         double b0;  ///< coefficient b0
+         double b1;  ///< coefficient b1
+         double b2;  ///< coefficient b2
+         double a1;  ///< coefficient a1
+         double a2;  ///< coefficient a2
+      };
+
+      /// ctor
+      LoudnessAnalyzer();
+
+      /// sets up the filters and resets all values; returns false when the parameters aren't supported
+      bool Init(unsigned int samplerateInHz, unsigned int numChannels);
+
+      /// returns number of channels
+      unsigned int GetNumChannels() const { return m_numChannels; }
+
+      /// analyzes the samples in the sample container, in the output module format
+      void AnalyzeSamples(SampleContainer& samples);
+
+      /// analyzes interleaved float samples; numSamples is the number of samples per channel
+      void AnalyzeInterleaved(const float* samples, size_t numSamples);
+
+      /// returns loudness and peak of all samples analyzed so far
+      LoudnessResult GetResult() const;
+
+      /// returns the histogram of all gating blocks so far
+      const LoudnessHistogram& GetHistogram() const { return m_histogram; }
+
+      /// returns the sample peak of all samples analyzed so far
+      double GetPeak() const { return m_peak; }
+
+      /// resets all values, e.g. to start a new stream
+      void Reset();
+
+      /// maximum number of samples per channel converted at once from the sample container
+      static constexpr size_t c_maxConversionSamples = 4096;
+
+   private:
+      /// filters samples that belong to the current sub-block
+      void FilterSamples(const float* samples, size_t numSamples);
+
+      /// finishes a sub-block, and adds a gating block when enough sub-blocks are available
+      void FinishSubBlock();
+
+   private:
+      /// \brief type of function running both K-weighting filters over interleaved samples
+      /// \details state contains 4 rows of numChannels values: the two state values of
+      /// the shelving filter, then of the highpass filter; the squared filter output
+      /// is added to sums, for each channel
+      typedef void(*T_fnFilter)(const float* samples, size_t numSamples, size_t numChannels,
+         const BiquadCoefficients* coefficients, double* state, double* sums);
+
+      /// type of function returning the maximum absolute value of samples
+      typedef float(*T_fnPeak)(const float* samples, size_t count);
+
+      /// number of channels
+      unsigned int m_numChannels;
+
+      /// coefficients of the shelving filter and of the highpass filter
+      BiquadCoefficients m_coefficients[2];
+
+      /// weight of each channel
+      std::vector<double> m_channelWeights;
+
+      /// filter state; see T_fnFilter
+      std::vector<double> m_filterState;
+
+      /// sum of the squared filter output in the current sub-block, for each channel
+      std::vector<double> m_channelSums;
+
+      /// filter function for the current instruction set
+      T_fnFilter m_fnFilter;
+
+      /// peak function for the current instruction set
+      T_fnPeak m_fnPeak;
+
+      /// number of samples per channel in a sub-block of 100 ms; a gating block has 4 sub-blocks
+      size_t m_subBlockLength;
+
+      /// number of samples per channel in the current sub-block so far
+      size_t m_subBlockPos;
+
+      /// weighted energies of the last sub-blocks, as ring buffer
+      double m_subBlockEnergies[4];
+
+      /// number of sub-blocks finished so far
+      unsigned long long m_numSubBlocks;
+
+      /// histogram of all gating blocks
+      LoudnessHistogram m_histogram;
+
+      /// sample peak so far
+      float m_peak;
+
+      /// float samples converted from the sample container
+      std::vector<float> m_conversionBuffer;
+   };
+
+   /// \brief collects the loudness of all tracks of an album, encoded in a batch
+   /// \details tracks may be added from multiple encoder threads
+   class LoudnessAlbum
+   {
+   public:
+      /// adds the loudness of a track, with the filename of the encoded file
+      void AddTrack(const CString& filename, const LoudnessAnalyzer& analyzer);
+
+      /// returns loudness and peak of all tracks added so far
+      LoudnessResult GetResult() const;
+
+      /// returns the filenames of all tracks added so far
+      std::vector<CString> GetFilenames() const;
+
+   private:
+      /// mutex to protect all members
+      mutable std::mutex m_mutex;
+
+      /// filenames of all tracks
+      std::vector<CString> m_filenames;
+
+      /// histogram of all gating blocks of all tracks
+      LoudnessHistogram m_histogram;
+
+      /// sample peak of all tracks
+      double m_peak = 0.0;
+   };
+
+} // namespace Encoder
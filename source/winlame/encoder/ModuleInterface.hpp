@@ -50,6 +50,7 @@ namespace Encoder
 #define ID_OM_OPUS                      16
 #define ID_IM_LIBMPG123                 17
 #define ID_IM_MONKEYSAUDIO              18
+#define ID_IM_CDREAD                    19
 
    /// returns a filename compatible for ansi APIs such as fopen()
    CString GetAnsiCompatFilename(LPCTSTR pszFilename);
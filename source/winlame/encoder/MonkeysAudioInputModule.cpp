@@ -120,9 +120,6 @@ namespace MonkeysAudio
       proc_APEDecompress_GetInfo       GetInfo;
    };
 
-   /// buffer size for MonkeysAudio's audio module
-   const int c_macBufferSize = 8192;
-
    /// encodes an error string based on macdll error code
    CString EncodeMonkeyErrorString(int errorCode)
    {
@@ -368,12 +365,19 @@ int MonkeysAudioInputModule::DecodeSamples(SampleContainer& samples)
 {
    ATLASSERT(s_dll.IsAvail() && m_handle != nullptr);
 
-   unsigned char buffer[MonkeysAudio::c_macBufferSize] = {};
    APE::int64 numBlocksRetrieved = 0;
 
-   // get data from file
+   // read as many samples as the output module prefers; one block contains one
+   // sample of all channels
    APE::int64 blockalign = s_dll.GetInfo(m_handle, APE::IAPEDecompress::APE_INFO_BLOCK_ALIGN, 0, 0);
-   int retval = s_dll.GetData(m_handle, buffer, MonkeysAudio::c_macBufferSize / blockalign, &numBlocksRetrieved);
+   APE::int64 numBlocks = samples.GetPreferredBlockSize();
+
+   size_t bufferSize = static_cast<size_t>(numBlocks * blockalign);
+   if (m_sampleBuffer.size() < bufferSize)
+      m_sampleBuffer.resize(bufferSize);
+
+   // get data from file
+   int retval = s_dll.GetData(m_handle, m_sampleBuffer.data(), numBlocks, &numBlocksRetrieved);
 
    // success?
    if (retval != 0)
@@ -387,9 +391,10 @@ int MonkeysAudioInputModule::DecodeSamples(SampleContainer& samples)
    APE::int64 bitsPerSample = s_dll.GetInfo(m_handle, APE::IAPEDecompress::APE_INFO_BITS_PER_SAMPLE, 0, 0);
    if (8 == bitsPerSample)
    {
-      for (int i = 0; i < MonkeysAudio::c_macBufferSize; ++i)
+      size_t numBytesRetrieved = static_cast<size_t>(numBlocksRetrieved * blockalign);
+      for (size_t i = 0; i < numBytesRetrieved; ++i)
       {
-         buffer[i] = ((buffer[i] & 0x80) ^ 0x80) | (buffer[i] & 0x7f);   // invert most significant bit
+         m_sampleBuffer[i] = ((m_sampleBuffer[i] & 0x80) ^ 0x80) | (m_sampleBuffer[i] & 0x7f);   // invert most significant bit
       }
    }
 
@@ -397,7 +402,7 @@ int MonkeysAudioInputModule::DecodeSamples(SampleContainer& samples)
    m_numCurrentSamples += numBlocksRetrieved;
 
    // put samples in container
-   samples.PutSamplesInterleaved(buffer, static_cast<int>(numBlocksRetrieved));
+   samples.PutSamplesInterleavedBorrowed(m_sampleBuffer.data(), static_cast<int>(numBlocksRetrieved));
 
    // return samples retrieved
    return static_cast<int>(numBlocksRetrieved);
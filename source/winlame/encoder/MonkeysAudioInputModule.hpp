@@ -100,6 +100,9 @@ namespace Encoder
       /// number of samples in file
       int64_t m_numTotalSamples;
 
+      /// sample buffer; lent to the sample container until the next DecodeSamples() call
+      std::vector<unsigned char> m_sampleBuffer;
+
       /// last error occured
       CString m_lastError;
    };
@@ -0,0 +1,285 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file Mp3InfoTag.cpp
+/// \brief MPEG layer III frame header parsing and Xing/LAME info tag generation
+//
+#include "stdafx.h"
+#include "Mp3InfoTag.hpp"
+#include <cmath>
+
+using Encoder::Mp3FrameHeader;
+using Encoder::Mp3InfoTag;
+using Encoder::Mp3InfoTagParams;
+
+/// layer III bitrates in kbps, for MPEG 1 and MPEG 2/2.5, indexed by bitrate index
+static const unsigned int c_bitrateTable[2][15] =
+{
+   { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+   { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 },
+};
+
+/// sample rates in Hz, for MPEG 2.5, reserved, MPEG 2 and MPEG 1, indexed by sample rate index
+static const unsigned int c_samplerateTable[4][3] =
+{
+   { 11025, 12000, 8000 },
+   { 0, 0, 0 },
+   { 22050, 24000, 16000 },
+   { 44100, 48000, 32000 },
+};
+
+/// number of entries in the Xing seek table
+const unsigned int c_numSeekTableEntries = 100;
+
+/// length of the Xing part of the info tag, from "Xing" up to the quality indicator
+const unsigned int c_xingTagLength = 4 + 4 + 4 + 4 + c_numSeekTableEntries + 4;
+
+/// length of the LAME extension of the info tag
+const unsigned int c_lameTagLength = 36;
+
+/// writes value as big endian number with given number of bytes
+static void WriteBigEndian(unsigned char* data, unsigned int value, unsigned int numBytes)
+{
+   for (unsigned int index = 0; index < numBytes; index++)
+      data[index] = static_cast<unsigned char>(value >> (8 * (numBytes - 1 - index)));
+}
+
+/// writes peak signal amplitude and radio replay gain into the LAME extension, in the format LAME uses
+static void WriteReplayGain(unsigned char* lameTag, const Mp3InfoTagParams& params)
+{
+   if (!params.m_hasReplayGain)
+      return;
+
+   // peak as fixed point number with 23 fractional bits
+   double peak = std::clamp(params.m_peakSignalAmplitude, 0.0, 255.0);
+   WriteBigEndian(lameTag + 11, static_cast<unsigned int>(peak * (1 << 23) + 0.5), 4);
+
+   // name code radio, originator "determined automatically", sign bit and gain in 0.1 dB
+   int gain = std::clamp(static_cast<int>(std::floor(params.m_radioReplayGain * 10.0 + 0.5)), -0x1fe, 0x1fe);
+
+   unsigned int radioReplayGain = 0x2000 | 0x0c00 |
+      (gain < 0 ? 0x0200 | static_cast<unsigned int>(-gain) : static_cast<unsigned int>(gain));
+
+   WriteBigEndian(lameTag + 15, radioReplayGain, 2);
+}
+
+bool Mp3FrameHeader::Parse(const unsigned char* data, size_t length)
+{
+   if (length < 4)
+      return false;
+
+   unsigned int header =
+      (static_cast<unsigned int>(data[0]) << 24) |
+      (static_cast<unsigned int>(data[1]) << 16) |
+      (static_cast<unsigned int>(data[2]) << 8) |
+      data[3];
+
+   // sync word and layer III
+   if ((header & 0xffe00000) != 0xffe00000 ||
+      ((header >> 17) & 3) != 1)
+      return false;
+
+   unsigned int versionIndex = (header >> 19) & 3;
+   unsigned int bitrateIndex = (header >> 12) & 15;
+   unsigned int samplerateIndex = (header >> 10) & 3;
+
+   if (versionIndex == 1 || bitrateIndex == 0 || bitrateIndex == 15 || samplerateIndex == 3)
+      return false;
+
+   m_header = header;
+   m_isMpeg1 = versionIndex == 3;
+   m_isMono = ((header >> 6) & 3) == 3;
+   m_hasCrc = (header & 0x00010000) == 0;
+   m_bitrate = c_bitrateTable[m_isMpeg1 ? 1 : 0][bitrateIndex];
+   m_samplerate = c_samplerateTable[versionIndex][samplerateIndex];
+   m_samplesPerFrame = m_isMpeg1 ? 1152 : 576;
+   m_frameLength = CalcFrameLength(m_isMpeg1, m_bitrate, m_samplerate) + ((header >> 9) & 1);
+
+   return true;
+}
+
+unsigned int Mp3FrameHeader::GetSideInfoLength() const
+{
+   if (m_isMpeg1)
+      return m_isMono ? 17 : 32;
+
+   return m_isMono ? 9 : 17;
+}
+
+unsigned int Mp3FrameHeader::CalcFrameLength(bool isMpeg1, unsigned int bitrate, unsigned int samplerate)
+{
+   return (isMpeg1 ? 144000 : 72000) * bitrate / samplerate;
+}
+
+void Mp3InfoTag::AddFrame(const unsigned char* frame, size_t length)
+{
+   if (m_frameLengths.empty())
+      m_firstFrameHeader.Parse(frame, length);
+
+   m_frameLengths.push_back(static_cast<unsigned short>(length));
+   m_totalLength += length;
+
+   m_musicCrc = CalcCrc16(frame, length, m_musicCrc);
+}
+
+std::vector<unsigned char> Mp3InfoTag::BuildFrame(unsigned int frameLength, const Mp3InfoTagParams& params) const
+{
+   if (m_frameLengths.empty() || m_firstFrameHeader.m_header == 0)
+      return std::vector<unsigned char>();
+
+   // find bitrate index for the frame length
+   const unsigned int* bitrates = c_bitrateTable[m_firstFrameHeader.m_isMpeg1 ? 1 : 0];
+
+   unsigned int bitrateIndex = 1;
+   while (bitrateIndex < 15 &&
+      Mp3FrameHeader::CalcFrameLength(m_firstFrameHeader.m_isMpeg1, bitrates[bitrateIndex], m_firstFrameHeader.m_samplerate) != frameLength)
+      bitrateIndex++;
+
+   unsigned int tagOffset = 4 + m_firstFrameHeader.GetSideInfoLength();
+
+   if (bitrateIndex == 15 || tagOffset + c_xingTagLength + c_lameTagLength > frameLength)
+      return std::vector<unsigned char>();
+
+   std::vector<unsigned char> frame(frameLength, 0);
+
+   // header: same as first frame, but with other bitrate, no padding and no CRC
+   unsigned int header = (m_firstFrameHeader.m_header & ~0x0000f200U) | (bitrateIndex << 12) | 0x00010000;
+   WriteBigEndian(frame.data(), header, 4);
+
+   // Xing part; all values are big endian
+   unsigned long long streamLength = frameLength + m_totalLength;
+   unsigned int numFrames = static_cast<unsigned int>(m_frameLengths.size());
+
+   unsigned char* data = frame.data() + tagOffset;
+   memcpy(data, params.m_isCbr ? "Info" : "Xing", 4);
+   WriteBigEndian(data + 4, 0x0000000f, 4); // frames, bytes, seek table and quality are present
+   WriteBigEndian(data + 8, numFrames, 4);
+   WriteBigEndian(data + 12, static_cast<unsigned int>(streamLength), 4);
+
+   // seek table: position of the frame at each percent of the stream, in 1/256 of the stream length
+   unsigned char* seekTable = data + 16;
+   unsigned long long framePosition = frameLength;
+   size_t frameIndex = 0;
+   for (unsigned int percent = 0; percent < c_numSeekTableEntries; percent++)
+   {
+      size_t percentFrameIndex = static_cast<size_t>(static_cast<unsigned long long>(percent) * numFrames / c_numSeekTableEntries);
+      for (; frameIndex < percentFrameIndex; frameIndex++)
+         framePosition += m_frameLengths[frameIndex];
+
+      seekTable[percent] = static_cast<unsigned char>(std::min<unsigned long long>(255, framePosition * 256 / streamLength));
+   }
+
+   WriteBigEndian(data + 16 + c_numSeekTableEntries, std::min(params.m_quality, 100U), 4);
+
+   // LAME extension
+   unsigned char* lameTag = data + c_xingTagLength;
+
+   std::string encoderVersion = params.m_encoderVersion.substr(0, 9);
+   memcpy(lameTag, encoderVersion.data(), encoderVersion.size());
+
+   lameTag[9] = static_cast<unsigned char>(params.m_vbrMethod & 15); // revision 0
+   lameTag[10] = static_cast<unsigned char>(std::min((params.m_lowpassFrequency + 50) / 100, 255U));
+
+   // audiophile replay gain stays 0, since the album isn't known yet
+   WriteReplayGain(lameTag, params);
+
+   lameTag[19] = static_cast<unsigned char>((params.m_athType & 15) | 0x10); // nspsytune is always on
+   lameTag[20] = static_cast<unsigned char>(std::min(params.m_bitrate, 255U));
+
+   long long padding =
+      static_cast<long long>(numFrames) * m_firstFrameHeader.m_samplesPerFrame -
+      params.m_encoderDelay - static_cast<long long>(params.m_numSamples);
+
+   unsigned int encoderDelay = std::min(params.m_encoderDelay, 4095U);
+   unsigned int encoderPadding = static_cast<unsigned int>(std::clamp<long long>(padding, 0, 4095));
+   WriteBigEndian(lameTag + 21, (encoderDelay << 12) | encoderPadding, 3);
+
+   unsigned int sourceFrequency =
+      params.m_sourceSamplerate <= 32000 ? 0 :
+      params.m_sourceSamplerate <= 44100 ? 1 :
+      params.m_sourceSamplerate <= 48000 ? 2 : 3;
+
+   // noise shaping 1, stereo mode, source frequency
+   lameTag[24] = static_cast<unsigned char>(1 | ((params.m_stereoMode & 7) << 2) | (sourceFrequency << 6));
+
+   WriteBigEndian(lameTag + 28, static_cast<unsigned int>(streamLength), 4);
+   WriteBigEndian(lameTag + 32, m_musicCrc, 2);
+
+   // CRC of all bytes of the tag frame before the tag CRC
+   size_t tagCrcOffset = static_cast<size_t>(lameTag + 34 - frame.data());
+   WriteBigEndian(lameTag + 34, CalcCrc16(frame.data(), tagCrcOffset), 2);
+
+   return frame;
+}
+
+bool Mp3InfoTag::UpdateReplayGain(std::vector<unsigned char>& frame, const Mp3InfoTagParams& params)
+{
+   Mp3FrameHeader header;
+   if (!header.Parse(frame.data(), frame.size()))
+      return false;
+
+   size_t tagOffset = 4 + (header.m_hasCrc ? 2 : 0) + header.GetSideInfoLength();
+   if (tagOffset + 8 > frame.size())
+      return false;
+
+   unsigned char* data = frame.data() + tagOffset;
+   if (memcmp(data, "Xing", 4) != 0 && memcmp(data, "Info", 4) != 0)
+      return false;
+
+   // the LAME extension follows the Xing fields present
+   unsigned int flags = data[7];
+   size_t lameTagOffset = tagOffset + 8 +
+      ((flags & 1) != 0 ? 4 : 0) +
+      ((flags & 2) != 0 ? 4 : 0) +
+      ((flags & 4) != 0 ? c_numSeekTableEntries : 0) +
+      ((flags & 8) != 0 ? 4 : 0);
+
+   if (lameTagOffset + c_lameTagLength > frame.size())
+      return false;
+
+   unsigned char* lameTag = frame.data() + lameTagOffset;
+   WriteReplayGain(lameTag, params);
+
+   WriteBigEndian(lameTag + 34, CalcCrc16(frame.data(), lameTagOffset + 34), 2);
+
+   return true;
+}
+
+unsigned short Mp3InfoTag::CalcCrc16(const unsigned char* data, size_t length, unsigned short crc)
+{
+   // CRC-16 with polynomial 0x8005, processed LSB first, as LAME does
+   static const std::array<unsigned short, 256> crcTable = []()
+   {
+      std::array<unsigned short, 256> table = {};
+      for (unsigned int index = 0; index < 256; index++)
+      {
+         unsigned int value = index;
+         for (int bit = 0; bit < 8; bit++)
+            value = (value & 1) != 0 ? (value >> 1) ^ 0xa001 : value >> 1;
+
+         table[index] = static_cast<unsigned short>(value);
+      }
+
+      return table;
+   }();
+
+   for (size_t index = 0; index < length; index++)
+      crc = static_cast<unsigned short>((crc >> 8) ^ crcTable[(crc ^ data[index]) & 0xff]);
+
+   return crc;
+}
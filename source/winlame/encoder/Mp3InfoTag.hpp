@@ -0,0 +1,153 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file Mp3InfoTag.hpp
+/// \brief MPEG layer III frame header parsing and Xing/LAME info tag generation
+//
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Encoder
+{
+   /// header of a single MPEG audio layer III frame
+   struct Mp3FrameHeader
+   {
+      /// parses frame header; returns false when the data doesn't start with a valid layer III frame header
+      bool Parse(const unsigned char* data, size_t length);
+
+      /// returns the length of the side info following the header and the optional CRC, in bytes
+      unsigned int GetSideInfoLength() const;
+
+      /// returns frame length in bytes, for given MPEG version, bitrate and sample rate, without padding
+      static unsigned int CalcFrameLength(bool isMpeg1, unsigned int bitrate, unsigned int samplerate);
+
+      /// raw 32 bit header value
+      unsigned int m_header = 0;
+
+      /// indicates if the frame is MPEG 1; else it's MPEG 2 or MPEG 2.5
+      bool m_isMpeg1 = false;
+
+      /// indicates if the frame is a mono frame
+      bool m_isMono = false;
+
+      /// indicates if a CRC follows the header
+      bool m_hasCrc = false;
+
+      /// bitrate, in kbps
+      unsigned int m_bitrate = 0;
+
+      /// sample rate, in Hz
+      unsigned int m_samplerate = 0;
+
+      /// number of samples per channel in the frame
+      unsigned int m_samplesPerFrame = 0;
+
+      /// frame length, in bytes, including header
+      unsigned int m_frameLength = 0;
+   };
+
+   /// parameters for the LAME extension of the info tag
+   struct Mp3InfoTagParams
+   {
+      /// indicates if the stream is CBR; "Info" is written instead of "Xing"
+      bool m_isCbr = false;
+
+      /// quality indicator, from 0 to 100
+      unsigned int m_quality = 0;
+
+      /// encoder short version string, e.g. "LAME3.100"; at most 9 characters are used
+      std::string m_encoderVersion;
+
+      /// VBR method: 1 CBR, 2 ABR, 3 VBR old, 4 VBR new (mtrh)
+      unsigned int m_vbrMethod = 0;
+
+      /// lowpass frequency, in Hz
+      unsigned int m_lowpassFrequency = 0;
+
+      /// ATH type used by encoder
+      unsigned int m_athType = 0;
+
+      /// ABR or CBR bitrate, or minimum VBR bitrate, in kbps
+      unsigned int m_bitrate = 0;
+
+      /// stereo mode: 0 mono, 1 stereo, 2 dual channel, 3 joint stereo, 4 forced joint stereo
+      unsigned int m_stereoMode = 0;
+
+      /// number of samples added at the start by the encoder, per channel
+      unsigned int m_encoderDelay = 0;
+
+      /// number of input samples, per channel; used to calculate the padding at the end
+      unsigned long long m_numSamples = 0;
+
+      /// sample rate of the input samples, in Hz
+      unsigned int m_sourceSamplerate = 0;
+
+      /// indicates if peak signal amplitude and radio replay gain are stored; else they stay 0
+      bool m_hasReplayGain = false;
+
+      /// peak signal amplitude, where 1.0 is full scale
+      double m_peakSignalAmplitude = 0.0;
+
+      /// radio (track) replay gain, in dB
+      double m_radioReplayGain = 0.0;
+   };
+
+   /// \brief collects infos about an mp3 stream and generates a Xing/LAME info tag frame
+   /// \details the tag frame is placed in front of all audio frames and contains the
+   /// number of frames and bytes, a seek table, and encoder delay and padding for
+   /// gapless playback. See http://gabriel.mp3-tech.org/mp3infotag.html
+   class Mp3InfoTag
+   {
+   public:
+      /// adds an audio frame of the stream; frames must be added in stream order
+      void AddFrame(const unsigned char* frame, size_t length);
+
+      /// returns number of audio frames added
+      size_t GetNumFrames() const { return m_frameLengths.size(); }
+
+      /// \brief generates the info tag frame, with given length
+      /// \details the header of the first audio frame is used as template; returns an
+      /// empty buffer when there are no frames, or when the info tag doesn't fit into
+      /// a frame with the given length
+      std::vector<unsigned char> BuildFrame(unsigned int frameLength, const Mp3InfoTagParams& params) const;
+
+      /// \brief stores peak signal amplitude and radio replay gain of the params in an existing info tag frame
+      /// \details used for tag frames written by LAME; the tag CRC is updated. Returns
+      /// false when the frame doesn't contain an info tag with a LAME extension
+      static bool UpdateReplayGain(std::vector<unsigned char>& frame, const Mp3InfoTagParams& params);
+
+      /// calculates CRC-16 as used in the LAME tag, starting with given CRC value
+      static unsigned short CalcCrc16(const unsigned char* data, size_t length, unsigned short crc = 0);
+
+   private:
+      /// header of first audio frame
+      Mp3FrameHeader m_firstFrameHeader;
+
+      /// lengths of all audio frames, in bytes
+      std::vector<unsigned short> m_frameLengths;
+
+      /// total length of all audio frames, in bytes
+      unsigned long long m_totalLength = 0;
+
+      /// CRC-16 of all audio frames
+      unsigned short m_musicCrc = 0;
+   };
+
+} // namespace Encoder
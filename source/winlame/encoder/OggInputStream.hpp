@@ -22,18 +22,19 @@
 #pragma once
 
 #include <ogg/ogg.h>
+#include "InputSource.hpp"
+#include <memory>
 
 namespace Encoder
 {
    /// \brief wrapper for ogg input streams
-   /// \details reads in bytes from passed FILE, and outputs ogg_packet's
+   /// \details reads in bytes from passed input source, and outputs ogg_packet's
    class OggInputStream
    {
    public:
       /// ctor
-      OggInputStream(FILE* fd, bool bFreeFd)
-         :m_fd(fd),
-         m_freeFd(bFreeFd),
+      explicit OggInputStream(std::shared_ptr<InputSource> inputSource)
+         :m_inputSource(inputSource),
          m_endOfStream(false),
          m_streamInit(false)
       {
@@ -43,24 +44,21 @@ namespace Encoder
          memset(&m_currentPage, 0, sizeof(m_currentPage));
       }
 
-      /// dtor; auto-closes stream and file
+      /// dtor; auto-closes stream
       ~OggInputStream()
       {
          ogg_sync_clear(&m_sync);
          ogg_stream_clear(&m_stream);
-
-         if (m_freeFd)
-            fclose(m_fd);
       }
 
-      /// returns file ptr
-      FILE* GetFd() const { return m_fd; }
+      /// returns input source
+      std::shared_ptr<InputSource> GetInputSource() const { return m_inputSource; }
 
-      /// reads more data from file into stream
+      /// reads more data from input source into stream
       void ReadInput(size_t uiSize)
       {
          char* data = ogg_sync_buffer(&m_sync, uiSize);
-         size_t uiRead = fread(data, sizeof(char), uiSize, m_fd);
+         size_t uiRead = m_inputSource->Read(data, uiSize);
 
          if (uiRead == 0)
             m_endOfStream = true;
@@ -71,7 +69,7 @@ namespace Encoder
       /// returns if stream is at its end
       bool IsEndOfStream() const
       {
-         return m_endOfStream || feof(m_fd);
+         return m_endOfStream || m_inputSource->IsEndOfFile();
       }
 
       /// reads next packet
@@ -106,11 +104,8 @@ namespace Encoder
       }
 
    private:
-      /// file to read from
-      FILE* m_fd;
-
-      /// indicates if m_fd is freed in dtor
-      bool m_freeFd;
+      /// input source to read from
+      std::shared_ptr<InputSource> m_inputSource;
 
       /// indicates if stream is at end
       bool m_endOfStream;
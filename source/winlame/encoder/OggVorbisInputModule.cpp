@@ -35,26 +35,31 @@ using Encoder::SampleContainer;
 extern CString GetOggVorbisVersionString();
 
 /// ogg vorbis input buffer size
-const int c_oggInputBufferSize = 512 * 6; // must be a multiple of max channels
+const int c_oggInputBufferSize = 512 * 6; ///< max. number of samples per channel to decode at once
 
 static size_t ReadDataSource(void* buffer, size_t size, size_t count, void* dataSource)
 {
-   return fread(buffer, size, count, reinterpret_cast<FILE*>(dataSource));
+   if (size == 0)
+      return 0;
+
+   return reinterpret_cast<Encoder::InputSource*>(dataSource)->Read(buffer, size * count) / size;
 }
 
 static int SeekDataSource(void* dataSource, ogg_int64_t offset, int whence)
 {
-   return _fseeki64(reinterpret_cast<FILE*>(dataSource), offset, whence);
+   return reinterpret_cast<Encoder::InputSource*>(dataSource)->Seek(offset, whence) ? 0 : -1;
 }
 
 static int CloseDataSource(void* dataSource)
 {
-   return fclose(reinterpret_cast<FILE*>(dataSource));
+   // the input source is closed in DoneInput()
+   UNUSED(dataSource);
+   return 0;
 }
 
 static long FilePosDataSource(void* dataSource)
 {
-   return ftell(reinterpret_cast<FILE*>(dataSource));
+   return static_cast<long>(reinterpret_cast<Encoder::InputSource*>(dataSource)->Position());
 }
 
 /// ogg vorbis reading callbacks
@@ -68,8 +73,7 @@ ov_callbacks c_callbacks =
 
 OggVorbisInputModule::OggVorbisInputModule()
    :m_numCurrentSamples(0),
-   m_numMaxSamples(0),
-   m_inputFile(nullptr)
+   m_numMaxSamples(0)
 {
    m_moduleId = ID_IM_OGGV;
 
@@ -145,16 +149,14 @@ int OggVorbisInputModule::InitInput(LPCTSTR m_inputFilename,
 {
    IsAvailable();
 
-   m_inputFile = _wfopen(m_inputFilename, _T("rb"));
-
-   if (m_inputFile == NULL)
+   if (!m_inputSource.Open(m_inputFilename))
    {
       m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
       return -1;
    }
 
    // open ogg vorbis file
-   if (ov_open_callbacks(m_inputFile, &m_vf, NULL, 0, c_callbacks) < 0)
+   if (ov_open_callbacks(&m_inputSource, &m_vf, NULL, 0, c_callbacks) < 0)
    {
       m_lastError.Format(IDS_ENCODER_INVALID_FILE_FORMAT);
       return -2;
@@ -168,8 +170,10 @@ int OggVorbisInputModule::InitInput(LPCTSTR m_inputFilename,
    m_channels = vi->channels;
    m_samplerate = vi->rate;
 
+   m_channelArray.resize(m_channels);
+
    // set up input traits
-   samplecont.SetInputModuleTraits(sizeof(short) * 8, SamplesInterleaved, m_samplerate, m_channels);
+   samplecont.SetInputModuleFloatTraits(SamplesChannelArray, m_samplerate, m_channels);
 
    GetTrackInfo(trackInfo);
 
@@ -188,20 +192,13 @@ void OggVorbisInputModule::GetInfo(int& numChannels, int& bitrateInBps, int& len
 
 int OggVorbisInputModule::DecodeSamples(SampleContainer& samples)
 {
-   short buffer[c_oggInputBufferSize];
+   float** buffer = nullptr;
    int bitstream;
 
-   // temporary sample buffer
-   short* outputBuffer;
-   short tempBuffer[c_oggInputBufferSize];
-
-   // read in samples
-   int ret = ov_read(&m_vf,
-      reinterpret_cast<char*>(buffer),
-      c_oggInputBufferSize * sizeof(short),
-      0,
-      sizeof(short),
-      1,
+   // read in samples; the decoder owns the returned float channel array
+   int ret = ov_read_float(&m_vf,
+      &buffer,
+      c_oggInputBufferSize,
       &bitstream);
 
    if (ret < 0)
@@ -210,20 +207,14 @@ int OggVorbisInputModule::DecodeSamples(SampleContainer& samples)
       return ret;
    }
 
-   ret /= m_channels * sizeof(short);
-
-   // channel remap
-   if (m_channels > 2 && ret > 0)
+   // channel remap; only the channel pointers have to be reordered
+   if (ret > 0)
    {
-      outputBuffer = tempBuffer;
-      ChannelRemapper::RemapInterleaved(T_enChannelMapType::oggVorbisInputChannelMap,
-         buffer, ret, m_channels, outputBuffer);
-   }
-   else
-      outputBuffer = buffer;
+      ChannelRemapper::RemapChannelPointers(T_enChannelMapType::oggVorbisInputChannelMap,
+         buffer, m_channels, m_channelArray.data());
 
-   if (ret > 0)
-      samples.PutSamplesInterleaved(outputBuffer, ret);
+      samples.PutSamplesArray(reinterpret_cast<void**>(m_channelArray.data()), ret);
+   }
 
    m_numCurrentSamples += ret;
 
@@ -234,7 +225,7 @@ void OggVorbisInputModule::DoneInput()
 {
    ov_clear(&m_vf);
 
-   fclose(m_inputFile);
+   m_inputSource.Close();
 }
 
 void OggVorbisInputModule::GetTrackInfo(TrackInfo& trackInfo)
@@ -22,7 +22,7 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
-#include <cstdio>
+#include "InputSource.hpp"
 #include <../include/vorbis/vorbisfile.h>
 
 namespace Encoder
@@ -90,11 +90,14 @@ namespace Encoder
       /// maximum number of samples
       __int64 m_numMaxSamples;
 
-      /// input file
-      FILE* m_inputFile;
+      /// input source
+      InputSource m_inputSource;
 
       /// decoding file struct
       mutable OggVorbis_File m_vf;
+
+      /// channel array pointing to the decoded samples, in output channel order
+      std::vector<float*> m_channelArray;
    };
 
 } // namespace Encoder
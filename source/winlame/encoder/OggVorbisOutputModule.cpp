@@ -21,7 +21,6 @@
 /// \brief contains the implementation of the ogg vorbis output module
 //
 #include "stdafx.h"
-#include <fstream>
 #include "resource.h"
 #include "OggVorbisOutputModule.hpp"
 #include "OpusOutputModule.hpp"
@@ -30,6 +29,7 @@
 #include <cmath>
 #include <ulib/UTF8.hpp>
 #include "ChannelRemapper.hpp"
+#include "AudioFileTag.hpp"
 
 using Encoder::OggVorbisOutputModule;
 using Encoder::TrackInfo;
@@ -162,10 +162,13 @@ int OggVorbisOutputModule::InitOutput(LPCTSTR outfilename,
    m_channels = samples.GetInputModuleChannels();
    m_samplerate = samples.GetInputModuleSampleRate();
 
-   m_outputStream.open(CStringA(outfilename).GetString(), std::ios::out | std::ios::binary);
-   if (!m_outputStream.is_open())
+   m_outputFilename = outfilename;
+
+   CString errorText;
+   if (!OpenOutputSink(outfilename, errorText))
    {
       m_lastError.LoadString(IDS_ENCODER_OUTPUT_FILE_CREATE_ERROR);
+      m_lastError.AppendFormat(_T(" (message \"%s\")"), errorText.GetString());
       return -1;
    }
 
@@ -179,7 +182,9 @@ int OggVorbisOutputModule::InitOutput(LPCTSTR outfilename,
 
    WriteHeader();
 
-   samples.SetOutputModuleTraits(16, SamplesChannelArray, m_samplerate, m_channels);
+   m_channelArray.resize(m_channels);
+
+   samples.SetOutputModuleFloatTraits(SamplesChannelArray, m_samplerate, m_channels);
 
    return 0;
 }
@@ -398,8 +403,7 @@ void OggVorbisOutputModule::WriteHeader()
       if (result == 0)
          break;
 
-      m_outputStream.write(reinterpret_cast<char*>(m_og.header), m_og.header_len);
-      m_outputStream.write(reinterpret_cast<char*>(m_og.body), m_og.body_len);
+      WritePage();
    }
 }
 
@@ -410,22 +414,18 @@ int OggVorbisOutputModule::EncodeSamples(SampleContainer& samples)
 
    // get samples
    int numSamples = 0;
-   short** buffer = (short**)samples.GetSamplesArray(numSamples);
+   float** buffer = (float**)samples.GetSamplesArray(numSamples);
 
    if (numSamples != 0)
    {
       float** sampleBuffer = vorbis_analysis_buffer(&m_vd, numSamples);
 
+      ChannelRemapper::RemapChannelPointers(T_enChannelMapType::oggVorbisOutputChannelMap,
+         buffer, m_channels, m_channelArray.data());
+
       // copy samples to analysis buffer
-      if (m_channels > 2)
-      {
-         ChannelRemapper::RemapArrayToFloat(T_enChannelMapType::oggVorbisOutputChannelMap,
-            buffer, numSamples, m_channels, sampleBuffer);
-      }
-      else
-      {
-         ChannelRemapper::ConvertSamplesToFloat(buffer, numSamples, m_channels, sampleBuffer);
-      }
+      for (int channelIndex = 0; channelIndex < m_channels; channelIndex++)
+         std::copy_n(m_channelArray[channelIndex], numSamples, sampleBuffer[channelIndex]);
    }
 
    // tell the library how much we actually submitted
@@ -433,6 +433,9 @@ int OggVorbisOutputModule::EncodeSamples(SampleContainer& samples)
 
    WriteBlocks();
 
+   if (!m_lastError.IsEmpty())
+      return -1;
+
    return numSamples;
 }
 
@@ -459,8 +462,7 @@ void OggVorbisOutputModule::WriteBlocks()
             if (result == 0)
                break;
 
-            m_outputStream.write(reinterpret_cast<char*>(m_og.header), m_og.header_len);
-            m_outputStream.write(reinterpret_cast<char*>(m_og.body), m_og.body_len);
+            WritePage();
 
             // this could be set above, but for illustrative purposes, I do
             // it here (to show that vorbis does know where the stream ends)
@@ -471,10 +473,23 @@ void OggVorbisOutputModule::WriteBlocks()
    }
 }
 
+void OggVorbisOutputModule::WritePage()
+{
+   if (m_outputSink->Write(m_og.header, m_og.header_len) &&
+      m_outputSink->Write(m_og.body, m_og.body_len))
+      return;
+
+   m_lastError = m_outputSink->GetLastError();
+}
+
 void OggVorbisOutputModule::DoneOutput()
 {
    if (!m_lastError.IsEmpty())
+   {
+      CString errorText;
+      CloseOutputSink(errorText);
       return;
+   }
 
    vorbis_analysis_wrote(&m_vd, 0);
 
@@ -491,5 +506,17 @@ void OggVorbisOutputModule::DoneOutput()
    // ogg_page and ogg_packet structs always point to storage in
    // libvorbis.  They're never freed or manipulated directly
 
-   m_outputStream.close();
+   CString errorText;
+   if (!CloseOutputSink(errorText))
+      m_lastError = errorText;
+
+   // the Vorbis comment header was already written at the start, so the gain values
+   // are stored by rewriting the tag
+   if (m_lastError.IsEmpty() && m_loudnessResult.m_isValid)
+   {
+      TrackInfo trackInfo;
+      m_loudnessResult.StoreTrackGain(trackInfo);
+
+      AudioFileTag(trackInfo).WriteReplayGainToFile(m_outputFilename, AudioFileTag::AudioFileType::OggVorbis);
+   }
 }
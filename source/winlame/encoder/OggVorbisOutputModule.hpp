@@ -22,7 +22,6 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
-#include <iosfwd>
 #include "vorbis/codec.h"
 
 namespace Encoder
@@ -54,6 +53,9 @@ namespace Encoder
       /// returns the extension the output module produces
       virtual CString GetOutputExtension() const override { return _T("ogg"); }
 
+      /// writes through an output sink
+      virtual bool SupportsOutputSink() const override { return true; }
+
       /// initializes the output module
       virtual int InitOutput(LPCTSTR outfilename, SettingsManager& mgr,
          const TrackInfo& trackInfo, SampleContainer& samples) override;
@@ -80,13 +82,16 @@ namespace Encoder
       /// write all ready blocks
       void WriteBlocks();
 
-   private:
-      /// output file stream
-      std::ofstream m_outputStream;
+      /// writes current ogg page to the output sink; sets last error on errors
+      void WritePage();
 
+   private:
       /// last error occured
       CString m_lastError;
 
+      /// output filename; used to store the gain values after encoding
+      CString m_outputFilename;
+
       /// chosen bitrate mode
       int m_bitrateMode;
 
@@ -116,6 +121,9 @@ namespace Encoder
 
       /// local working space for packet->PCM decode
       vorbis_block     m_vb;
+
+      /// channel array pointing to the input samples, in output channel order
+      std::vector<float*> m_channelArray;
    };
 
 } // namespace Encoder
@@ -80,17 +80,14 @@ CString OpusInputModule::GetFilterString() const
 int OpusInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    TrackInfo& trackInfo, SampleContainer& samples)
 {
-   FILE* fd = nullptr;
-   errno_t err = _tfopen_s(&fd, infilename, _T("rb"));
-
-   if (err != 0 || fd == nullptr)
+   if (!m_inputSource.Open(infilename))
    {
       m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
       return -1;
    }
 
    int errorCode = 0;
-   OggOpusFile* file = op_open_callbacks(fd, &m_callbacks, nullptr, 0, &errorCode);
+   OggOpusFile* file = op_open_callbacks(&m_inputSource, &m_callbacks, nullptr, 0, &errorCode);
 
    if (file != nullptr)
       m_inputFile.reset(file, op_free);
@@ -105,9 +102,18 @@ int OpusInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    const OpusHead* header = op_head(m_inputFile.get(), 0);
 
    // set up input traits
-   samples.SetInputModuleTraits(16, SamplesInterleaved,
+   samples.SetInputModuleFloatTraits(SamplesInterleaved,
       48000, header->channel_count);
 
+   // channel mapping family 1 uses Vorbis channel order; other families have no defined order
+   m_channelMatrix = ChannelMatrix();
+   if (header->mapping_family == 1 && header->channel_count > 2)
+   {
+      ChannelMatrix channelMatrix = ChannelMatrix::FromChannelMapType(oggVorbisInputChannelMap, header->channel_count);
+      if (!channelMatrix.IsIdentity())
+         m_channelMatrix = channelMatrix;
+   }
+
    m_numTotalSamples = op_pcm_total(m_inputFile.get(), -1);
 
    GetTrackInfo(trackInfo);
@@ -137,17 +143,48 @@ int OpusInputModule::DecodeSamples(SampleContainer& samples)
    if (header == nullptr)
       return -1;
 
-   short sampleBuffer[48000];
+   // op_read_float() decodes at most one packet per call, so call it until the
+   // block size the output module prefers is filled
+   int blockSize = samples.GetPreferredBlockSize();
+
+   size_t bufferSize = size_t(blockSize) * header->channel_count;
+   if (m_sampleBuffer.size() < bufferSize)
+      m_sampleBuffer.resize(bufferSize);
+
+   int numSamplesPerChannel = 0;
+   while (numSamplesPerChannel < blockSize)
+   {
+      int currentLink = 0;
+      int ret = op_read_float(m_inputFile.get(),
+         m_sampleBuffer.data() + size_t(numSamplesPerChannel) * header->channel_count,
+         static_cast<int>(size_t(blockSize - numSamplesPerChannel) * header->channel_count),
+         &currentLink);
+
+      if (ret < 0 && numSamplesPerChannel == 0)
+         return ret;
 
-   int currentLink = 0;
-   int numSamplesPerChannel = op_read(m_inputFile.get(), sampleBuffer, sizeof(sampleBuffer) / sizeof(*sampleBuffer), &currentLink);
+      if (ret <= 0)
+         break;
+
+      numSamplesPerChannel += ret;
+   }
 
    if (numSamplesPerChannel == 0)
       return 0;
 
-   samples.PutSamplesInterleaved(sampleBuffer, numSamplesPerChannel);
+   if (!m_channelMatrix.IsEmpty())
+   {
+      m_remapBuffer.resize(m_sampleBuffer.size());
+
+      m_channelMatrix.ApplyInterleaved(m_sampleBuffer.data(), SampleTypeFloat32,
+         m_remapBuffer.data(), SampleTypeFloat32, numSamplesPerChannel);
 
-   return numSamplesPerChannel * header->channel_count;
+      samples.PutSamplesInterleavedBorrowed(m_remapBuffer.data(), numSamplesPerChannel);
+   }
+   else
+      samples.PutSamplesInterleavedBorrowed(m_sampleBuffer.data(), numSamplesPerChannel);
+
+   return numSamplesPerChannel;
 }
 
 float OpusInputModule::PercentDone() const
@@ -164,6 +201,7 @@ float OpusInputModule::PercentDone() const
 void OpusInputModule::DoneInput()
 {
    m_inputFile.reset();
+   m_inputSource.Close();
 }
 
 void OpusInputModule::GetTrackInfo(TrackInfo& trackInfo)
@@ -314,24 +352,25 @@ LPCTSTR OpusInputModule::ErrorTextFromCode(int errorCode)
 
 int OpusInputModule::ReadStream(void* stream, unsigned char* buffer, int numBytes)
 {
-   FILE* fd = reinterpret_cast<FILE*>(stream);
-   return fread(buffer, 1, numBytes, fd);
+   InputSource* inputSource = reinterpret_cast<InputSource*>(stream);
+   return static_cast<int>(inputSource->Read(buffer, numBytes));
 }
 
 int OpusInputModule::SeekStream(void* stream, opus_int64 offset, int whence)
 {
-   FILE* fd = reinterpret_cast<FILE*>(stream);
-   return _fseeki64(fd, offset, whence);
+   InputSource* inputSource = reinterpret_cast<InputSource*>(stream);
+   return inputSource->Seek(offset, whence) ? 0 : -1;
 }
 
 opus_int64 OpusInputModule::PosStream(void* stream)
 {
-   FILE* fd = reinterpret_cast<FILE*>(stream);
-   return _ftelli64(fd);
+   InputSource* inputSource = reinterpret_cast<InputSource*>(stream);
+   return static_cast<opus_int64>(inputSource->Position());
 }
 
 int OpusInputModule::CloseStream(void* stream)
 {
-   FILE* fd = reinterpret_cast<FILE*>(stream);
-   return fclose(fd);
+   // the input source is closed in DoneInput()
+   UNUSED(stream);
+   return 0;
 }
@@ -22,6 +22,8 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
+#include "InputSource.hpp"
+#include "ChannelMatrix.hpp"
 #include <../include/opus/opusfile.h>
 
 namespace Encoder
@@ -98,11 +100,23 @@ namespace Encoder
       /// file callbacks
       OpusFileCallbacks m_callbacks;
 
+      /// input source; must outlive m_inputFile
+      InputSource m_inputSource;
+
       /// input file
       std::shared_ptr<OggOpusFile> m_inputFile;
 
       /// total number of samples in the file
       ogg_int64_t m_numTotalSamples;
+
+      /// sample buffer; lent to the sample container until the next DecodeSamples() call
+      std::vector<float> m_sampleBuffer;
+
+      /// matrix to remap channels from Vorbis to WAV order; empty when no remapping is needed
+      ChannelMatrix m_channelMatrix;
+
+      /// buffer for remapped samples; lent to the sample container instead of m_sampleBuffer
+      std::vector<float> m_remapBuffer;
    };
 
 } // namespace Encoder
@@ -24,6 +24,7 @@
 #include "OpusOutputModule.hpp"
 #include <ulib/UTF8.hpp>
 #include "App.hpp"
+#include "AudioFileTag.hpp"
 #include <wincrypt.h>
 #include <ogg/ogg.h>
 
@@ -126,15 +127,15 @@ int OpusEncData::write_callback(void* user_data, const unsigned char* ptr, opus_
    OpusEncData* data = (OpusEncData*)user_data;
    data->bytes_written += len;
    data->pages_out++;
-   return fwrite(ptr, 1, len, data->m_outputFile.get()) != (size_t)len;
+   return data->m_outputSink->Write(ptr, static_cast<size_t>(len)) ? 0 : 1;
 }
 
 int OpusEncData::close_callback(void* user_data)
 {
    OpusEncData* data = (OpusEncData*)user_data;
 
-   int ret = fclose(data->m_outputFile.get()) != 0;
-   data->m_outputFile.reset();
+   int ret = data->m_outputSink->Close() ? 0 : 1;
+   data->m_outputSink.reset();
    return ret;
 }
 
@@ -167,13 +168,12 @@ OpusOutputModule::OpusOutputModule()
    m_complexity(10),
    m_opusBitrateMode(0),
    m_inputSampleRate(48000),
+   m_encoderSampleRate(48000),
    m_inputSampleSize(16),
    m_codingRate(48000),
    m_downmix(0),
    m_frameSize(960),
-   m_numSamplesPerFrame(0),
-   m_32bitMode(false),
-   m_outputStreamAtEnd(false)
+   m_numSamplesPerFrame(0)
 {
    m_moduleId = ID_OM_OPUS;
 }
@@ -206,7 +206,7 @@ CString OpusOutputModule::GetDescription() const
    desc.Format(IDS_FORMAT_INFO_OPUS_OUTPUT,
       m_channels,
       m_inputSampleRate,
-      m_32bitMode ? 32 : 16,
+      m_inputSampleSize,
       bitrateMode,
       m_bitrateInBps / 1000,
       m_complexity);
@@ -230,8 +230,6 @@ int OpusOutputModule::InitOutput(LPCTSTR outfilename,
    m_channels = samples.GetInputModuleChannels();
    m_inputSampleSize = samples.GetInputModuleBitsPerSample();
 
-   m_32bitMode = samples.GetInputModuleBitsPerSample() == 32;
-
    // set options from UI
    m_bitrateInBps = mgr.QueryValueInt(OpusTargetBitrate) * 1000;
    m_complexity = mgr.QueryValueInt(OpusComplexity);
@@ -243,23 +241,39 @@ int OpusOutputModule::InitOutput(LPCTSTR outfilename,
    if (!OpenOutputFile(outfilename))
       return -1;
 
+   m_outputFilename = outfilename;
+
+   // when the sample container resamples, the encoder gets samples at the coding
+   // rate and doesn't have to run its own resampler
+   m_encoderSampleRate = samples.IsResamplingEnabled() ? m_codingRate : m_inputSampleRate;
+
    if (!InitEncoder())
       return -1;
 
    if (!SetEncoderOptions())
       return -1;
 
-   m_samplerate = m_codingRate;
+   m_samplerate = m_encoderSampleRate;
 
    // set up output traits
-   samples.SetOutputModuleTraits(m_32bitMode ? 32 : 16, SamplesInterleaved, m_samplerate, m_channels);
+   // the encoder takes float samples, so let the sample container deliver them directly
+   samples.SetOutputModuleFloatTraits(SamplesInterleaved, m_samplerate, m_channels);
+
+   // let input modules deliver whole frames, so that they can be encoded without copying
+   samples.SetOutputModuleFrameSize(m_frameSize);
 
    return 0;
 }
 
 int OpusOutputModule::EncodeSamples(SampleContainer& samples)
 {
-   int numSamples = RefillInputSampleBuffer(samples);
+   // get samples
+   int numSamples = 0;
+
+   // numSamples is in "samples per channel", so input buffer contains numSamples*m_channels samples
+   const float* inputBuffer = (const float*)samples.GetSamplesInterleaved(numSamples);
+
+   m_inputFrameBuffer.SetInput(inputBuffer, static_cast<size_t>(numSamples) * m_channels);
 
    if (!EncodeInputBufferUntilEmpty())
       return -1; // error occured
@@ -272,6 +286,21 @@ void OpusOutputModule::DoneOutput()
    EncodeRemainingInputBuffer();
 
    m_encoder.Close();
+
+   // the encoder already closed the sink, but still reports write errors
+   CString errorText;
+   if (!CloseOutputSink(errorText) && m_lastError.IsEmpty())
+      m_lastError = errorText;
+
+   // the OpusTags header was already written at the start, so the gain values are
+   // stored by rewriting the tag
+   if (m_lastError.IsEmpty() && m_loudnessResult.m_isValid)
+   {
+      TrackInfo trackInfo;
+      m_loudnessResult.StoreTrackGain(trackInfo);
+
+      AudioFileTag(trackInfo).WriteReplayGainToFile(m_outputFilename, AudioFileTag::AudioFileType::OggOpus);
+   }
 }
 
 bool OpusOutputModule::StoreTrackInfos(const TrackInfo& trackinfo)
@@ -407,27 +436,40 @@ bool OpusOutputModule::InitEncoder()
       m_downmix = m_channels > 8 ? 1 : 2;
    }
 
+   // the encoder expects channels in Vorbis order
+   ChannelMatrix remapMatrix = ChannelMatrix::FromChannelMapType(oggVorbisOutputChannelMap, m_channels);
+
+   m_channelMatrix = ChannelMatrix();
+
    if (m_downmix > 0 && m_downmix < m_channels)
    {
       if (!SetupDownmix(static_cast<size_t>(m_channels), static_cast<size_t>(m_downmix)))
          return false;
+
+      // remap and downmix in one pass
+      m_channelMatrix = m_channelMatrix.Multiply(remapMatrix);
    }
    else
+   {
       m_downmix = 0;
 
+      if (!remapMatrix.IsIdentity())
+         m_channelMatrix = remapMatrix;
+   }
+
    m_frameSize = 960; // 20 ms frames
 
    // Initialize Opus encoder
    int outputChannels = m_downmix != 0 ? m_downmix : m_channels;
-   if (!m_encoder.Create(m_inputSampleRate, outputChannels, m_lastError))
+   if (!m_encoder.Create(m_encoderSampleRate, outputChannels, m_lastError))
       return false;
 
    m_numSamplesPerFrame = m_frameSize * m_channels;
 
-   m_inputFloatBuffer.resize(m_numSamplesPerFrame);
+   m_inputFrameBuffer.Init(m_numSamplesPerFrame);
 
-   if (m_downmix != 0)
-      m_downmixFloatBuffer.resize(m_numSamplesPerFrame);
+   if (!m_channelMatrix.IsEmpty())
+      m_channelMatrixBuffer.resize(m_numSamplesPerFrame);
 
    return true;
 }
@@ -528,102 +570,31 @@ bool OpusOutputModule::SetEncoderOptions()
 
 bool OpusOutputModule::OpenOutputFile(LPCTSTR outputFilename)
 {
-   FILE* fout = _tfopen(outputFilename, _T("wb"));
-
-   if (fout != nullptr)
-   {
-      m_encoder.m_outputFile.reset(fout, ::fclose);
-      return true;
-   }
-
-   return false;
-}
-
-long OpusOutputModule::ReadFloatSamples16(float* buffer, int samples)
-{
-   int numSamples = std::min(m_inputInt16Buffer.size(), size_t(samples * m_channels));
-
-   //ATLTRACE(_T("ReadFloatSamples16: Requesting %i samples, returning %i samples\n"), samples, numSamples / m_channels);
-
-   constexpr int16_t scaleFactor = std::numeric_limits<int16_t>::max();
-
-   for (int i = 0; i < numSamples; i++)
-   {
-      buffer[i] = float(m_inputInt16Buffer[i]) / scaleFactor;
-   }
-
-   // remove samples from input buffer
-   m_inputInt16Buffer.erase(m_inputInt16Buffer.begin(), m_inputInt16Buffer.begin() + numSamples);
-
-   return numSamples / m_channels;
-}
-
-long OpusOutputModule::ReadFloatSamples32(float* buffer, int samples)
-{
-   int numSamples = std::min(m_inputInt32Buffer.size(), size_t(samples * m_channels));
-
-   //ATLTRACE(_T("ReadFloatSamples32: Requesting %i samples, returning %i samples\n"), samples, numSamples / m_channels);
-
-   constexpr int32_t scaleFactor = std::numeric_limits<int32_t>::max();
-
-   for (int i = 0; i < numSamples; i++)
-   {
-      buffer[i] = float(m_inputInt32Buffer[i]) / scaleFactor;
-   }
-
-   // remove samples from input buffer
-   m_inputInt32Buffer.erase(m_inputInt32Buffer.begin(), m_inputInt32Buffer.begin() + numSamples);
-
-   return numSamples / m_channels;
-}
-
-int OpusOutputModule::RefillInputSampleBuffer(SampleContainer& samples)
-{
-   // get samples
-   int numSamples = 0;
-
-   if (m_32bitMode)
+   CString errorText;
+   if (!OpenOutputSink(outputFilename, errorText))
    {
-      static_assert(sizeof(int) == sizeof(opus_int32), "short and opus_int16 must have the same size");
-
-      // numSamples is in "samples per channel", so input buffer contains numSamples*m_channels samples
-      opus_int32* inputBuffer = (opus_int32*)samples.GetSamplesInterleaved(numSamples);
-
-      size_t startIndex = m_inputInt32Buffer.size();
-
-      m_inputInt32Buffer.resize(startIndex + numSamples * m_channels);
-
-      std::copy_n(inputBuffer, numSamples * m_channels, m_inputInt32Buffer.begin() + startIndex);
+      m_lastError.LoadString(IDS_ENCODER_OUTPUT_FILE_CREATE_ERROR);
+      m_lastError.AppendFormat(_T(" (message \"%s\")"), errorText.GetString());
+      return false;
    }
-   else
-   {
-      static_assert(sizeof(short) == sizeof(opus_int16), "short and opus_int16 must have the same size");
-
-      opus_int16* inputBuffer = (opus_int16*)samples.GetSamplesInterleaved(numSamples);
-
-      size_t startIndex = m_inputInt16Buffer.size();
-
-      m_inputInt16Buffer.resize(startIndex + numSamples * m_channels);
 
-      std::copy_n(inputBuffer, numSamples * m_channels, m_inputInt16Buffer.begin() + startIndex);
-   }
+   m_encoder.m_outputSink = m_outputSink;
 
-   return numSamples;
+   return true;
 }
 
 bool OpusOutputModule::EncodeInputBufferUntilEmpty()
 {
-   // as long as the input buffer has samples for one frame, encode it
-   bool inputBufferSufficientSamples =
-      (m_32bitMode ? m_inputInt32Buffer.size() : m_inputInt16Buffer.size()) >= size_t(m_numSamplesPerFrame);
-
-   while (inputBufferSufficientSamples)
+   // as long as the input buffer has samples for one frame, encode it; the
+   // frames are taken from the sample container without copying, when possible
+   for (const float* frame = m_inputFrameBuffer.NextFrame(); frame != nullptr; frame = m_inputFrameBuffer.NextFrame())
    {
-      if (!EncodeInputBufferFrame())
+      if (!EncodeInputBufferFrame(frame, m_frameSize))
+      {
+         // discard rest of input
+         m_inputFrameBuffer.Init(m_numSamplesPerFrame);
          return false; // error occured
-
-      inputBufferSufficientSamples =
-         (m_32bitMode ? m_inputInt32Buffer.size() : m_inputInt16Buffer.size()) >= size_t(m_numSamplesPerFrame);
+      }
    }
 
    return true;
@@ -631,52 +602,32 @@ bool OpusOutputModule::EncodeInputBufferUntilEmpty()
 
 void OpusOutputModule::EncodeRemainingInputBuffer()
 {
-   size_t inputBufferSize = m_32bitMode ? m_inputInt32Buffer.size() : m_inputInt16Buffer.size();
-
-   if (inputBufferSize > 0)
-   {
-      EncodeInputBufferUntilEmpty();
+   if (m_encoder.enc == nullptr)
+      return;
 
-      inputBufferSize = m_32bitMode ? m_inputInt32Buffer.size() : m_inputInt16Buffer.size();
+   size_t numSamples = 0;
+   const float* samples = m_inputFrameBuffer.RemainingSamples(numSamples);
 
-      if (inputBufferSize > 0)
-      {
-         while (!m_outputStreamAtEnd)
-         {
-            if (!EncodeInputBufferFrame())
-               return; // there was an error
-         }
-      }
+   if (numSamples > 0 &&
+      !EncodeInputBufferFrame(samples, static_cast<opus_int32>(numSamples / m_channels)))
+      return; // there was an error
 
-      int ret = ope_encoder_drain(m_encoder.enc);
-      if (ret != OPE_OK)
-      {
-         m_lastError.Format(
-            _T("Error: Encoding aborted: %hs"),
-            ope_strerror(ret));
-      }
+   // always drain, even when the stream ended at a frame boundary
+   int ret = ope_encoder_drain(m_encoder.enc);
+   if (ret != OPE_OK)
+   {
+      m_lastError.Format(
+         _T("Error: Encoding aborted: %hs"),
+         ope_strerror(ret));
    }
 }
 
-bool OpusOutputModule::EncodeInputBufferFrame()
+bool OpusOutputModule::EncodeInputBufferFrame(const float* samples, opus_int32 numSamplesPerChannel)
 {
-   // read samples
-   opus_int32 nb_samples = -1; // number of samples, per channel
-
-   if (m_32bitMode)
-      nb_samples = ReadFloatSamples32(m_inputFloatBuffer.data(), m_frameSize);
-   else
-      nb_samples = ReadFloatSamples16(m_inputFloatBuffer.data(), m_frameSize);
-
-   if (nb_samples < m_frameSize)
-   {
-      m_outputStreamAtEnd = true;
-   }
-
-   if (!m_downmixMatrix.empty())
-      DownmixSamples(nb_samples);
+   if (!m_channelMatrix.IsEmpty())
+      samples = ApplyChannelMatrix(samples, numSamplesPerChannel);
 
-   int ret = ope_encoder_write_float(m_encoder.enc, m_inputFloatBuffer.data(), nb_samples);
+   int ret = ope_encoder_write_float(m_encoder.enc, samples, numSamplesPerChannel);
    if (ret != OPE_OK)
    {
       m_lastError.Format(
@@ -712,8 +663,7 @@ std::string OpusOutputModule::GetMetadataBlockPicture(const std::vector<unsigned
    return base64image;
 }
 
-// Note: The stupid_matrix table and the code in SetupDownmix() and
-// DownmixSamples() is taken from opus-tools' audio-in.c file:
+// Note: The stupid_matrix table and the code in SetupDownmix() is taken from opus-tools' audio-in.c file:
 // https://github.com/xiph/opus-tools/blob/master/src/audio-in.c
 // The following copyright header appears in the file
 //
@@ -769,58 +719,45 @@ bool OpusOutputModule::SetupDownmix(size_t inputNumChannels, size_t outputNumCha
       return false;
    }
 
-   m_downmixMatrix.resize(inputNumChannels * outputNumChannels);
+   std::vector<float> downmixMatrix(inputNumChannels * outputNumChannels);
 
    if (outputNumChannels == 1 && inputNumChannels > 8)
    {
       for (size_t i = 0; i < inputNumChannels; i++)
-         m_downmixMatrix[i] = 1.0f / inputNumChannels;
+         downmixMatrix[i] = 1.0f / inputNumChannels;
    }
    else if (outputNumChannels == 2)
    {
       for (size_t j = 0; j < outputNumChannels; j++)
          for (size_t i = 0; i < inputNumChannels; i++)
-            m_downmixMatrix[inputNumChannels * j + i] = stupid_matrix[inputNumChannels - 2][i][j];
+            downmixMatrix[inputNumChannels * j + i] = stupid_matrix[inputNumChannels - 2][i][j];
    }
    else
    {
       for (size_t i = 0; i < inputNumChannels; i++)
-         m_downmixMatrix[i] = stupid_matrix[inputNumChannels - 2][i][0] + stupid_matrix[inputNumChannels - 2][i][1];
+         downmixMatrix[i] = stupid_matrix[inputNumChannels - 2][i][0] + stupid_matrix[inputNumChannels - 2][i][1];
    }
 
    float sum = 0.f;
    for (size_t i = 0; i < inputNumChannels * outputNumChannels; i++)
-      sum += m_downmixMatrix[i];
+      sum += downmixMatrix[i];
 
    sum = (float)outputNumChannels / sum;
-   for (size_t i = 0; i < inputNumChannels * outputNumChannels; i++)
-      m_downmixMatrix[i] *= sum;
+
+   m_channelMatrix = ChannelMatrix(inputNumChannels, outputNumChannels);
+
+   for (size_t j = 0; j < outputNumChannels; j++)
+      for (size_t i = 0; i < inputNumChannels; i++)
+         m_channelMatrix.SetCoefficient(j, i, downmixMatrix[inputNumChannels * j + i] * sum);
 
    return true;
 }
 
-void OpusOutputModule::DownmixSamples(opus_int32& numSamplesPerChannel)
+const float* OpusOutputModule::ApplyChannelMatrix(const float* samples, opus_int32 numSamplesPerChannel)
 {
-   ATLASSERT(m_downmix == 1 || m_downmix == 2); // downmix value must be 1 or 2
-
-   size_t inputNumChannels = m_channels;
-   size_t outputNumChannels = m_downmix;
-
-   for (opus_int32 i = 0; i < numSamplesPerChannel; i++)
-   {
-      for (size_t j = 0; j < outputNumChannels; j++)
-      {
-         float* sample = &m_downmixFloatBuffer[i * outputNumChannels + j];
-         *sample = 0.f;
-
-         for (size_t k = 0; k < inputNumChannels; k++)
-         {
-            *sample += m_inputFloatBuffer[i * inputNumChannels + k] * m_downmixMatrix[inputNumChannels * j + k];
-         }
-      }
-   }
-
-   numSamplesPerChannel = numSamplesPerChannel * m_downmix / m_channels;
+   m_channelMatrix.ApplyInterleaved(samples, SampleTypeFloat32,
+      m_channelMatrixBuffer.data(), SampleTypeFloat32, numSamplesPerChannel);
 
-   std::swap(m_downmixFloatBuffer, m_inputFloatBuffer);
+   // the number of samples per channel stays the same, only the number of channels may change
+   return m_channelMatrixBuffer.data();
 }
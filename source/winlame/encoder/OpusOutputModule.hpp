@@ -22,6 +22,8 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
+#include "SampleFrameBuffer.hpp"
+#include "ChannelMatrix.hpp"
 #include <opus/opusenc.h>
 
 
@@ -45,8 +47,8 @@ namespace Encoder
       /// Opus comments
       std::shared_ptr<OggOpusComments> m_comments;
 
-      /// output file
-      std::shared_ptr<FILE> m_outputFile;
+      /// output sink; shared with the output module
+      std::shared_ptr<OutputSink> m_outputSink;
 
       opus_int64 total_bytes;
       opus_int64 bytes_written;
@@ -91,6 +93,9 @@ namespace Encoder
       /// returns the extension the output module produces
       virtual CString GetOutputExtension() const override { return _T("opus"); }
 
+      /// writes through an output sink
+      virtual bool SupportsOutputSink() const override { return true; }
+
       /// initializes the output module
       virtual int InitOutput(LPCTSTR outfilename, SettingsManager& mgr,
          const TrackInfo& trackInfo, SampleContainer& samples) override;
@@ -111,7 +116,7 @@ namespace Encoder
       /// initializes encoder
       bool InitEncoder();
 
-      /// sets up downmixing to stereo or mono
+      /// sets up downmixing to stereo or mono, from channels in Vorbis order
       bool SetupDownmix(size_t inputNumChannels, size_t outputNumChannels);
 
       /// sets encoder options
@@ -120,17 +125,8 @@ namespace Encoder
       /// opens output file
       bool OpenOutputFile(LPCTSTR outputFilename);
 
-      /// reads float samples from 16-bit buffer
-      long ReadFloatSamples16(float* buffer, int samples);
-
-      /// reads float samples from 32-bit buffer
-      long ReadFloatSamples32(float* buffer, int samples);
-
-      /// downmix samples in input float sample buffer
-      void DownmixSamples(opus_int32& numSamplesPerChannel);
-
-      /// refills input sample buffer from sample container
-      int RefillInputSampleBuffer(SampleContainer& samples);
+      /// remaps or downmixes samples into channel matrix buffer; returns the resulting samples
+      const float* ApplyChannelMatrix(const float* samples, opus_int32 numSamplesPerChannel);
 
       /// feeds the input buffer to the encoder until it doesn't hold a complete frame anymore
       bool EncodeInputBufferUntilEmpty();
@@ -138,13 +134,16 @@ namespace Encoder
       /// encodes remaining input buffer, even when it isn't a full frame anymore
       void EncodeRemainingInputBuffer();
 
-      /// encodes input buffer samples for one frame with encoder
-      bool EncodeInputBufferFrame();
+      /// encodes samples for one frame with encoder
+      bool EncodeInputBufferFrame(const float* samples, opus_int32 numSamplesPerChannel);
 
    private:
       /// last error occured
       CString m_lastError;
 
+      /// output filename; used to store the gain values after encoding
+      CString m_outputFilename;
+
       /// encoding options and data
       OpusEncData m_encoder;
 
@@ -159,6 +158,9 @@ namespace Encoder
 
       opus_int32 m_inputSampleRate;
 
+      /// sample rate of the samples passed to the encoder; either the input or the coding rate
+      opus_int32 m_encoderSampleRate;
+
       /// number of bits in input samples
       unsigned int m_inputSampleSize;
 
@@ -176,26 +178,15 @@ namespace Encoder
       /// number of samples per frame we should feed the encoder with, for all channels
       opus_int32 m_numSamplesPerFrame;
 
-      /// input buffer for 16-bit samples
-      std::vector<opus_int16> m_inputInt16Buffer;
-
-      /// input buffer for 32-bit samples
-      std::vector<opus_int32> m_inputInt32Buffer;
-
-      /// input buffer for float samples; contains at most one frame
-      std::vector<float> m_inputFloatBuffer;
-
-      /// matrix for factors for downmixing channels
-      std::vector<float> m_downmixMatrix;
-
-      /// buffer for downmixed float samples
-      std::vector<float> m_downmixFloatBuffer;
+      /// splits float samples from the sample container into frames
+      SampleFrameBuffer<float> m_inputFrameBuffer;
 
-      /// indicates if the input module supports 32-bit samples
-      bool m_32bitMode;
+      /// matrix to remap channels from WAV to Vorbis order, and to downmix them;
+      /// empty when the samples are passed to the encoder unchanged
+      ChannelMatrix m_channelMatrix;
 
-      /// indicates if the output stream is at the end
-      bool m_outputStreamAtEnd;
+      /// buffer for remapped or downmixed float samples
+      std::vector<float> m_channelMatrixBuffer;
    };
 
 } /// namespace Encoder
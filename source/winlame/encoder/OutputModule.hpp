@@ -22,6 +22,8 @@
 #pragma once
 
 #include "ModuleBase.hpp"
+#include "OutputSink.hpp"
+#include "LoudnessAnalyzer.hpp"
 
 class SettingsManager;
 
@@ -29,6 +31,7 @@ namespace Encoder
 {
    class TrackInfo;
    class SampleContainer;
+   class WorkerPool;
 
    /// output module base class
    class OutputModule : public ModuleBase
@@ -54,6 +57,69 @@ namespace Encoder
 
       /// cleans up the output module
       virtual void DoneOutput() = 0;
+
+      /// \brief sets loudness and peak of all encoded samples
+      /// \details called after the last EncodeSamples() call, before DoneOutput();
+      /// output modules that support a gain tag format store the values in the
+      /// output file in DoneOutput()
+      void SetLoudnessResult(const LoudnessResult& loudnessResult) { m_loudnessResult = loudnessResult; }
+
+      /// returns if the output module writes through an output sink set by SetOutputSink()
+      virtual bool SupportsOutputSink() const { return false; }
+
+      /// \brief sets the output sink the next InitOutput() call writes to, instead of
+      /// creating the output file
+      /// \details only used by output modules that write through an output sink; the
+      /// sink is closed by DoneOutput()
+      void SetOutputSink(std::shared_ptr<OutputSink> outputSink) { m_outputSink = outputSink; }
+
+      /// sets the worker pool that output modules splitting up encoding run the parts on;
+      /// must be called before InitOutput(); may be nullptr
+      void SetWorkerPool(WorkerPool* workerPool) { m_workerPool = workerPool; }
+
+   protected:
+      /// opens the output sink set by SetOutputSink(), or a buffered file sink for the
+      /// output filename; returns false and the error text on errors
+      bool OpenOutputSink(LPCTSTR outfilename, CString& errorText)
+      {
+         if (m_outputSink != nullptr)
+            return true;
+
+         std::shared_ptr<FileOutputSink> fileOutputSink = std::make_shared<FileOutputSink>();
+         if (!fileOutputSink->Open(outfilename))
+         {
+            errorText = fileOutputSink->GetLastError();
+            return false;
+         }
+
+         m_outputSink = fileOutputSink;
+         return true;
+      }
+
+      /// closes the output sink; returns false and the error text when writing has failed
+      bool CloseOutputSink(CString& errorText)
+      {
+         if (m_outputSink == nullptr)
+            return true;
+
+         bool result = m_outputSink->Close();
+         if (!result)
+            errorText = m_outputSink->GetLastError();
+
+         m_outputSink.reset();
+
+         return result;
+      }
+
+   protected:
+      /// output sink the module writes to
+      std::shared_ptr<OutputSink> m_outputSink;
+
+      /// loudness and peak of all encoded samples; only valid when set by SetLoudnessResult()
+      LoudnessResult m_loudnessResult;
+
+      /// worker pool shared with other encoders; may be nullptr
+      WorkerPool* m_workerPool = nullptr;
    };
 
 } // namespace Encoder
@@ -0,0 +1,321 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file OutputSink.cpp
+/// \brief output sinks that output modules write encoded data to
+//
+#include "stdafx.h"
+#include "OutputSink.hpp"
+#include <ulib/win32/ErrorMessage.hpp>
+
+using Encoder::FileOutputSink;
+using Encoder::MemoryOutputSink;
+
+/// maximum number of bytes written with a single WriteFile() call
+const size_t c_maxWriteLength = 64 * 1024 * 1024;
+
+FileOutputSink::FileOutputSink(bool writeBehind, size_t bufferSize)
+   :m_writeBehind(writeBehind),
+   m_bufferSize(bufferSize)
+{
+}
+
+FileOutputSink::~FileOutputSink()
+{
+   Close();
+}
+
+bool FileOutputSink::Open(LPCTSTR filename)
+{
+   HANDLE handle = ::CreateFile(filename, GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+      CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+   if (handle == INVALID_HANDLE_VALUE)
+   {
+      m_lastError = Win32::ErrorMessage().ToString();
+      return false;
+   }
+
+   return StartWriting(handle, true);
+}
+
+bool FileOutputSink::Attach(HANDLE handle)
+{
+   return StartWriting(handle, false);
+}
+
+bool FileOutputSink::StartWriting(HANDLE handle, bool ownsHandle)
+{
+   ATLASSERT(m_handle == INVALID_HANDLE_VALUE); // must not be open already
+
+   m_handle = handle;
+   m_ownsHandle = ownsHandle;
+   m_canSeek = ::GetFileType(handle) == FILE_TYPE_DISK;
+   m_position = 0;
+   m_bufferLength = 0;
+   m_writeFailed = false;
+   m_stopWriting = false;
+
+   m_buffer = GetFreeBuffer();
+   if (m_buffer == nullptr)
+   {
+      m_lastError = _T("Couldn't allocate output buffer");
+      return false;
+   }
+
+   if (m_writeBehind)
+      m_writeBehindThread = std::thread(&FileOutputSink::RunWriteBehindThread, this);
+
+   return true;
+}
+
+bool FileOutputSink::Write(const void* data, size_t length)
+{
+   if (m_writeFailed || m_buffer == nullptr)
+      return false;
+
+   const unsigned char* source = static_cast<const unsigned char*>(data);
+
+   m_position += length;
+
+   while (length > 0)
+   {
+      size_t copyLength = std::min(length, m_bufferSize - m_bufferLength);
+
+      memcpy(m_buffer.get() + m_bufferLength, source, copyLength);
+
+      m_bufferLength += copyLength;
+      source += copyLength;
+      length -= copyLength;
+
+      if (m_bufferLength == m_bufferSize &&
+         !SubmitBuffer())
+         return false;
+   }
+
+   return true;
+}
+
+bool FileOutputSink::Overwrite(unsigned long long position, const void* data, size_t length)
+{
+   if (!m_canSeek || m_writeFailed || m_buffer == nullptr || position + length > m_position)
+      return false;
+
+   // still in the current buffer?
+   unsigned long long bufferPosition = m_position - m_bufferLength;
+   if (position >= bufferPosition)
+   {
+      memcpy(m_buffer.get() + (position - bufferPosition), data, length);
+      return true;
+   }
+
+   if (!Flush())
+      return false;
+
+   LARGE_INTEGER filePosition = {};
+   filePosition.QuadPart = static_cast<LONGLONG>(position);
+
+   if (!::SetFilePointerEx(m_handle, filePosition, nullptr, FILE_BEGIN))
+   {
+      m_lastError = Win32::ErrorMessage().ToString();
+      return false;
+   }
+
+   bool result = WriteToHandle(static_cast<const unsigned char*>(data), length);
+
+   LARGE_INTEGER endPosition = {};
+   if (!::SetFilePointerEx(m_handle, endPosition, nullptr, FILE_END))
+   {
+      m_lastError = Win32::ErrorMessage().ToString();
+      m_writeFailed = true;
+      return false;
+   }
+
+   return result;
+}
+
+bool FileOutputSink::Close()
+{
+   if (m_handle == INVALID_HANDLE_VALUE)
+      return !m_writeFailed;
+
+   SubmitBuffer();
+
+   if (m_writeBehindThread.joinable())
+   {
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         m_stopWriting = true;
+      }
+
+      m_conditionBuffersChanged.notify_all();
+
+      m_writeBehindThread.join();
+   }
+
+   if (m_ownsHandle)
+      ::CloseHandle(m_handle);
+
+   m_handle = INVALID_HANDLE_VALUE;
+
+   m_buffer.reset();
+   m_freeBuffers.clear();
+
+   return !m_writeFailed;
+}
+
+FileOutputSink::T_bufferPtr FileOutputSink::GetFreeBuffer()
+{
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      if (!m_freeBuffers.empty())
+      {
+         T_bufferPtr buffer = std::move(m_freeBuffers.back());
+         m_freeBuffers.pop_back();
+
+         return buffer;
+      }
+   }
+
+   return T_bufferPtr(static_cast<unsigned char*>(_aligned_malloc(m_bufferSize, c_bufferAlignment)));
+}
+
+bool FileOutputSink::SubmitBuffer()
+{
+   if (m_bufferLength == 0)
+      return !m_writeFailed;
+
+   if (!m_writeBehind)
+   {
+      bool result = WriteToHandle(m_buffer.get(), m_bufferLength);
+      m_bufferLength = 0;
+
+      return result;
+   }
+
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      m_conditionBuffersChanged.wait(lock,
+         [this]() { return m_pendingBuffers.size() < c_maxPendingBuffers || m_writeFailed; });
+
+      if (m_writeFailed)
+         return false;
+
+      m_pendingBuffers.emplace_back(std::move(m_buffer), m_bufferLength);
+   }
+
+   m_conditionBuffersChanged.notify_all();
+
+   m_buffer = GetFreeBuffer();
+   m_bufferLength = 0;
+
+   if (m_buffer == nullptr)
+   {
+      m_lastError = _T("Couldn't allocate output buffer");
+      m_writeFailed = true;
+      return false;
+   }
+
+   return true;
+}
+
+bool FileOutputSink::Flush()
+{
+   if (!SubmitBuffer())
+      return false;
+
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   m_conditionBuffersChanged.wait(lock, [this]() { return m_pendingBuffers.empty(); });
+
+   return !m_writeFailed;
+}
+
+bool FileOutputSink::WriteToHandle(const unsigned char* data, size_t length)
+{
+   while (length > 0)
+   {
+      DWORD lengthToWrite = static_cast<DWORD>(std::min(length, c_maxWriteLength));
+      DWORD lengthWritten = 0;
+
+      if (!::WriteFile(m_handle, data, lengthToWrite, &lengthWritten, nullptr) ||
+         lengthWritten == 0)
+      {
+         m_lastError = Win32::ErrorMessage().ToString();
+         m_writeFailed = true;
+         return false;
+      }
+
+      data += lengthWritten;
+      length -= lengthWritten;
+   }
+
+   return true;
+}
+
+void FileOutputSink::RunWriteBehindThread()
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   for (;;)
+   {
+      m_conditionBuffersChanged.wait(lock,
+         [this]() { return !m_pendingBuffers.empty() || m_stopWriting; });
+
+      if (m_pendingBuffers.empty())
+         break; // stopped, and all buffers are written
+
+      // the buffer stays in the queue while writing, so that Flush() waits for it
+      PendingBuffer& pendingBuffer = m_pendingBuffers.front();
+
+      lock.unlock();
+
+      // after an error, the remaining buffers are only discarded
+      if (!m_writeFailed)
+         WriteToHandle(pendingBuffer.m_buffer.get(), pendingBuffer.m_length);
+
+      lock.lock();
+
+      m_freeBuffers.push_back(std::move(pendingBuffer.m_buffer));
+      m_pendingBuffers.pop_front();
+
+      m_conditionBuffersChanged.notify_all();
+   }
+}
+
+bool MemoryOutputSink::Write(const void* data, size_t length)
+{
+   const unsigned char* source = static_cast<const unsigned char*>(data);
+
+   m_data.insert(m_data.end(), source, source + length);
+   m_position += length;
+
+   return true;
+}
+
+bool MemoryOutputSink::Overwrite(unsigned long long position, const void* data, size_t length)
+{
+   if (position + length > m_data.size())
+      return false;
+
+   memcpy(m_data.data() + position, data, length);
+
+   return true;
+}
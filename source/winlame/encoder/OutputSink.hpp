@@ -0,0 +1,227 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file OutputSink.hpp
+/// \brief output sinks that output modules write encoded data to
+//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Encoder
+{
+   /// \brief target that output modules write their encoded data to
+   /// \details data is always appended at the end; already written data can be overwritten
+   /// with Overwrite(), e.g. to fix up header fields, when the target allows it
+   class OutputSink
+   {
+   public:
+      /// dtor
+      virtual ~OutputSink() {}
+
+      /// returns number of bytes written so far
+      unsigned long long Position() const { return m_position; }
+
+      /// returns the last error
+      const CString& GetLastError() const { return m_lastError; }
+
+      /// returns if already written data can be overwritten; false e.g. for a pipe
+      virtual bool CanOverwrite() const = 0;
+
+      /// appends data; returns false on errors
+      virtual bool Write(const void* data, size_t length) = 0;
+
+      /// overwrites already written data at given position; returns false on errors, or when
+      /// the target can't seek, e.g. a pipe
+      virtual bool Overwrite(unsigned long long position, const void* data, size_t length) = 0;
+
+      /// writes out all buffered data and closes the target; returns false when writing failed
+      virtual bool Close() = 0;
+
+   protected:
+      /// number of bytes written
+      unsigned long long m_position = 0;
+
+      /// last error
+      CString m_lastError;
+   };
+
+   /// \brief output sink that writes to a file or pipe, using large buffers
+   /// \details Data is collected in aligned buffers of a fixed size, so that the file is
+   /// written with a few large sequential writes instead of one write per frame or page.
+   /// With write-behind, full buffers are written by a background thread, so that the
+   /// encoding thread only waits for the disk when all buffers are still pending.
+   class FileOutputSink : public OutputSink
+   {
+   public:
+      /// ctor
+      explicit FileOutputSink(bool writeBehind = true, size_t bufferSize = c_defaultBufferSize);
+
+      /// dtor; closes the sink
+      virtual ~FileOutputSink();
+
+      /// creates the file; returns false on errors
+      bool Open(LPCTSTR filename);
+
+      /// writes to an already open handle, e.g. a pipe or the standard output; the handle
+      /// isn't closed by the sink
+      bool Attach(HANDLE handle);
+
+      /// returns if the handle is a file that can be seeked
+      virtual bool CanOverwrite() const override { return m_canSeek; }
+
+      /// appends data; returns false on errors
+      virtual bool Write(const void* data, size_t length) override;
+
+      /// overwrites already written data; data still in the current buffer is overwritten
+      /// there, else all pending buffers are written and the file is seeked
+      virtual bool Overwrite(unsigned long long position, const void* data, size_t length) override;
+
+      /// writes out all buffered data and closes the file
+      virtual bool Close() override;
+
+      /// default size of a buffer, in bytes
+      static const size_t c_defaultBufferSize = 1024 * 1024;
+
+      /// alignment of the buffers, in bytes
+      static const size_t c_bufferAlignment = 4096;
+
+      /// maximum number of full buffers waiting for the write-behind thread
+      static const size_t c_maxPendingBuffers = 4;
+
+   private:
+      /// deleter for aligned buffers
+      struct AlignedBufferDeleter
+      {
+         /// frees buffer
+         void operator()(unsigned char* buffer) const { _aligned_free(buffer); }
+      };
+
+      /// aligned buffer type
+      typedef std::unique_ptr<unsigned char, AlignedBufferDeleter> T_bufferPtr;
+
+      /// full buffer waiting to be written
+      struct PendingBuffer
+      {
+         /// ctor
+         PendingBuffer(T_bufferPtr buffer, size_t length)
+            :m_buffer(std::move(buffer)),
+            m_length(length)
+         {
+         }
+
+         /// buffer
+         T_bufferPtr m_buffer;
+
+         /// number of bytes used in buffer
+         size_t m_length;
+      };
+
+      /// starts writing to handle
+      bool StartWriting(HANDLE handle, bool ownsHandle);
+
+      /// returns a free buffer, or allocates a new one
+      T_bufferPtr GetFreeBuffer();
+
+      /// writes out current buffer, or hands it over to the write-behind thread
+      bool SubmitBuffer();
+
+      /// submits current buffer and waits until all pending buffers are written
+      bool Flush();
+
+      /// writes data to the handle; sets last error on errors
+      bool WriteToHandle(const unsigned char* data, size_t length);
+
+      /// write-behind thread function
+      void RunWriteBehindThread();
+
+   private:
+      /// indicates if full buffers are written by a background thread
+      bool m_writeBehind;
+
+      /// size of each buffer
+      size_t m_bufferSize;
+
+      /// file or pipe handle
+      HANDLE m_handle = INVALID_HANDLE_VALUE;
+
+      /// indicates if the handle is closed by the sink
+      bool m_ownsHandle = false;
+
+      /// indicates if the handle is a disk file that can be seeked
+      bool m_canSeek = false;
+
+      /// current buffer that is filled by Write()
+      T_bufferPtr m_buffer;
+
+      /// number of bytes used in current buffer
+      size_t m_bufferLength = 0;
+
+      /// indicates if writing has failed; no more data is written then
+      std::atomic<bool> m_writeFailed{ false };
+
+      /// mutex protecting pending and free buffers and the stop flag
+      std::mutex m_mutex;
+
+      /// condition that is signaled when buffers were submitted or written, or when stopping
+      std::condition_variable m_conditionBuffersChanged;
+
+      /// full buffers, in order of writing; the first one is being written
+      std::deque<PendingBuffer> m_pendingBuffers;
+
+      /// buffers that were already written and can be reused
+      std::vector<T_bufferPtr> m_freeBuffers;
+
+      /// indicates if the write-behind thread should stop when all buffers are written
+      bool m_stopWriting = false;
+
+      /// write-behind thread
+      std::thread m_writeBehindThread;
+   };
+
+   /// output sink that collects all data in memory
+   class MemoryOutputSink : public OutputSink
+   {
+   public:
+      /// returns all data written
+      const std::vector<unsigned char>& GetData() const { return m_data; }
+
+      /// returns true; all data stays in memory
+      virtual bool CanOverwrite() const override { return true; }
+
+      /// appends data
+      virtual bool Write(const void* data, size_t length) override;
+
+      /// overwrites already written data
+      virtual bool Overwrite(unsigned long long position, const void* data, size_t length) override;
+
+      /// does nothing; the data stays available
+      virtual bool Close() override { return true; }
+
+   private:
+      /// all data written
+      std::vector<unsigned char> m_data;
+   };
+
+} // namespace Encoder
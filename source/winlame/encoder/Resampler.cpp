@@ -0,0 +1,363 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file Resampler.cpp
+/// \brief polyphase sample rate converter
+//
+#include "stdafx.h"
+#include "Resampler.hpp"
+#include "SampleConverter.hpp"
+#include <immintrin.h>
+#include <climits>
+#include <cmath>
+#include <numeric>
+
+using Encoder::Resampler;
+using Encoder::ResamplerQuality;
+
+namespace
+{
+   /// filter parameters for a quality setting
+   struct FilterParams
+   {
+      /// number of taps per phase, when not decimating
+      size_t m_numTaps;
+
+      /// cutoff frequency, relative to the lower Nyquist frequency
+      double m_cutoff;
+
+      /// Kaiser window beta parameter
+      double m_kaiserBeta;
+   };
+
+   /// filter parameters, indexed by quality
+   const FilterParams c_filterParams[] =
+   {
+      { 0, 0.0, 0.0 },     // resamplerQualityOff
+      { 16, 0.85, 5.0 },   // resamplerQualityFast
+      { 32, 0.92, 7.5 },   // resamplerQualityMedium
+      { 64, 0.96, 9.5 },   // resamplerQualityBest
+   };
+
+   /// maximum number of taps per phase, when decimating by a large factor
+   const size_t c_maxNumTaps = 1024;
+
+   /// modified Bessel function of the first kind, order 0
+   double BesselI0(double x)
+   {
+      double sum = 1.0;
+      double term = 1.0;
+      for (int k = 1; k < 50 && term > sum * 1e-12; k++)
+      {
+         double factor = x / (2.0 * k);
+         term *= factor * factor;
+         sum += term;
+      }
+
+      return sum;
+   }
+
+   /// calculates dot product, plain C++ version
+   float DotProductScalar(const float* samples, const float* coefficients, size_t length)
+   {
+      // four partial sums, so that the additions don't depend on each other
+      float sum[4] = {};
+      for (size_t index = 0; index < length; index += 4)
+      {
+         sum[0] += samples[index] * coefficients[index];
+         sum[1] += samples[index + 1] * coefficients[index + 1];
+         sum[2] += samples[index + 2] * coefficients[index + 2];
+         sum[3] += samples[index + 3] * coefficients[index + 3];
+      }
+
+      return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+   }
+
+   /// calculates dot product, SSE2 version
+   float DotProductSSE2(const float* samples, const float* coefficients, size_t length)
+   {
+      __m128 sum1 = _mm_setzero_ps();
+      __m128 sum2 = _mm_setzero_ps();
+
+      for (size_t index = 0; index < length; index += 8)
+      {
+         sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(samples + index), _mm_loadu_ps(coefficients + index)));
+         sum2 = _mm_add_ps(sum2, _mm_mul_ps(_mm_loadu_ps(samples + index + 4), _mm_loadu_ps(coefficients + index + 4)));
+      }
+
+      __m128 sum = _mm_add_ps(sum1, sum2);
+      sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+      sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+
+      return _mm_cvtss_f32(sum);
+   }
+
+   /// calculates dot product, AVX2 version
+   float DotProductAVX2(const float* samples, const float* coefficients, size_t length)
+   {
+      __m256 sum1 = _mm256_setzero_ps();
+      __m256 sum2 = _mm256_setzero_ps();
+
+      size_t index = 0;
+      for (; index + 16 <= length; index += 16)
+      {
+         sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(samples + index), _mm256_loadu_ps(coefficients + index)));
+         sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(_mm256_loadu_ps(samples + index + 8), _mm256_loadu_ps(coefficients + index + 8)));
+      }
+
+      if (index < length)
+         sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(samples + index), _mm256_loadu_ps(coefficients + index)));
+
+      __m256 sum256 = _mm256_add_ps(sum1, sum2);
+      __m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum256), _mm256_extractf128_ps(sum256, 1));
+
+      _mm256_zeroupper();
+
+      sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+      sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+
+      return _mm_cvtss_f32(sum);
+   }
+
+} // unnamed namespace
+
+Resampler::Resampler()
+   :m_inputSamplerateInHz(0),
+   m_outputSamplerateInHz(0),
+   m_numChannels(0),
+   m_quality(resamplerQualityOff),
+   m_upFactor(1),
+   m_downFactor(1),
+   m_numPhases(1),
+   m_interpolatePhases(false),
+   m_numTaps(0),
+   m_fnDotProduct(&DotProductScalar),
+   m_historyIndex(0),
+   m_phase(0),
+   m_numTotalInputSamples(0),
+   m_numTotalOutputSamples(0)
+{
+}
+
+bool Resampler::Init(int inputSamplerateInHz, int outputSamplerateInHz, size_t numChannels, ResamplerQuality quality)
+{
+   if (inputSamplerateInHz <= 0 || outputSamplerateInHz <= 0 || numChannels == 0 ||
+      quality <= resamplerQualityOff || quality > resamplerQualityBest)
+      return false;
+
+   m_inputSamplerateInHz = inputSamplerateInHz;
+   m_outputSamplerateInHz = outputSamplerateInHz;
+   m_numChannels = numChannels;
+   m_quality = quality;
+
+   unsigned long long divisor = std::gcd(inputSamplerateInHz, outputSamplerateInHz);
+   m_upFactor = static_cast<unsigned long long>(outputSamplerateInHz) / divisor;
+   m_downFactor = static_cast<unsigned long long>(inputSamplerateInHz) / divisor;
+
+   m_interpolatePhases = m_upFactor > c_maxNumPhases;
+   m_numPhases = m_interpolatePhases ? c_maxNumPhases : static_cast<unsigned int>(m_upFactor);
+
+   // when decimating, the cutoff frequency is lowered, and the filter gets longer
+   // by the same factor, so that the transition band keeps its relative width
+   const FilterParams& params = c_filterParams[quality];
+   double ratio = std::min(1.0, double(outputSamplerateInHz) / inputSamplerateInHz);
+
+   size_t numTaps = static_cast<size_t>(std::ceil(params.m_numTaps / ratio));
+   m_numTaps = std::min((numTaps + 7) & ~size_t(7), c_maxNumTaps);
+
+   CalcFilterTable(params.m_cutoff * ratio, params.m_kaiserBeta);
+
+   switch (SampleConverter::GetInstructionSet())
+   {
+   case instructionSetAVX2: m_fnDotProduct = &DotProductAVX2; break;
+   case instructionSetSSE2: m_fnDotProduct = &DotProductSSE2; break;
+   default: m_fnDotProduct = &DotProductScalar; break;
+   }
+
+   Reset();
+
+   return true;
+}
+
+size_t Resampler::GetMaxOutputSamples(size_t numInputSamples) const
+{
+   // the history may contain up to one input sample whose output samples weren't calculated yet
+   return static_cast<size_t>((numInputSamples + 1) * m_upFactor / m_downFactor + 1);
+}
+
+size_t Resampler::Process(const float* input, size_t numInputSamples, float* output)
+{
+   ATLASSERT(m_numTaps > 0); // Init() must have been called
+
+   // append samples to the history of each channel
+   for (size_t channel = 0; channel < m_numChannels; channel++)
+   {
+      std::vector<float>& history = m_channelHistory[channel];
+
+      size_t historyLength = history.size();
+      history.resize(historyLength + numInputSamples);
+
+      float* target = history.data() + historyLength;
+      const float* source = input + channel;
+      for (size_t index = 0; index < numInputSamples; index++, source += m_numChannels)
+         target[index] = *source;
+   }
+
+   m_numTotalInputSamples += numInputSamples;
+
+   size_t numOutputSamples = CalcOutputSamples(output, ULLONG_MAX);
+
+   DiscardHistory();
+
+   return numOutputSamples;
+}
+
+size_t Resampler::Flush(float* output)
+{
+   // the last output sample lines up with the last input sample, or lies before it
+   unsigned long long numTotalOutputSamples =
+      (m_numTotalInputSamples * m_upFactor + m_downFactor - 1) / m_downFactor;
+
+   // zeros after the end of the stream, so that the filters of the last output samples can run
+   for (std::vector<float>& history : m_channelHistory)
+      history.resize(history.size() + m_numTaps, 0.0f);
+
+   size_t numOutputSamples = CalcOutputSamples(output, numTotalOutputSamples);
+
+   Reset();
+
+   return numOutputSamples;
+}
+
+void Resampler::Reset()
+{
+   // zeros before the start of the stream; the first output sample's filter
+   // starts m_numTaps / 2 - 1 samples before the first input sample
+   m_channelHistory.assign(m_numChannels, std::vector<float>(m_numTaps / 2 - 1, 0.0f));
+
+   m_historyIndex = m_numTaps / 2 - 1;
+   m_phase = 0;
+   m_numTotalInputSamples = 0;
+   m_numTotalOutputSamples = 0;
+}
+
+void Resampler::CalcFilterTable(double cutoff, double kaiserBeta)
+{
+   const double pi = 3.14159265358979323846;
+   const double halfLength = m_numTaps / 2.0;
+   const double besselBeta = BesselI0(kaiserBeta);
+
+   // one extra phase at the end, with the filter shifted by a whole sample; used
+   // when interpolating between phases
+   m_filterTable.resize((m_numPhases + 1) * m_numTaps);
+
+   std::vector<double> coefficients(m_numTaps);
+   for (unsigned int phaseIndex = 0; phaseIndex <= m_numPhases; phaseIndex++)
+   {
+      double fraction = double(phaseIndex) / m_numPhases;
+
+      double sum = 0.0;
+      for (size_t tapIndex = 0; tapIndex < m_numTaps; tapIndex++)
+      {
+         // distance of the tap's input sample to the output sample position
+         double time = double(tapIndex) - halfLength + 1.0 - fraction;
+
+         double sinc = time == 0.0 ? 1.0 : std::sin(pi * cutoff * time) / (pi * cutoff * time);
+
+         double windowPosition = time / halfLength;
+         double window = std::abs(windowPosition) >= 1.0 ? 0.0 :
+            BesselI0(kaiserBeta * std::sqrt(1.0 - windowPosition * windowPosition)) / besselBeta;
+
+         coefficients[tapIndex] = sinc * window;
+         sum += coefficients[tapIndex];
+      }
+
+      // normalize each phase to unity gain at DC
+      float* phase = m_filterTable.data() + phaseIndex * m_numTaps;
+      for (size_t tapIndex = 0; tapIndex < m_numTaps; tapIndex++)
+         phase[tapIndex] = static_cast<float>(coefficients[tapIndex] / sum);
+   }
+}
+
+size_t Resampler::CalcOutputSamples(float* output, unsigned long long maxTotalOutputSamples)
+{
+   const size_t historyLength = m_channelHistory[0].size();
+   const size_t numTapsAfter = m_numTaps / 2;
+
+   size_t numOutputSamples = 0;
+
+   while (m_historyIndex + numTapsAfter < historyLength &&
+      m_numTotalOutputSamples < maxTotalOutputSamples)
+   {
+      const size_t windowStart = m_historyIndex + 1 - numTapsAfter;
+
+      if (!m_interpolatePhases)
+      {
+         const float* coefficients = m_filterTable.data() + m_phase * m_numTaps;
+
+         for (size_t channel = 0; channel < m_numChannels; channel++)
+            *output++ = m_fnDotProduct(m_channelHistory[channel].data() + windowStart, coefficients, m_numTaps);
+      }
+      else
+      {
+         // interpolate linearly between the two nearest phases
+         unsigned long long scaledPhase = m_phase * m_numPhases;
+         size_t phaseIndex = static_cast<size_t>(scaledPhase / m_upFactor);
+         float weight = float(scaledPhase % m_upFactor) / float(m_upFactor);
+
+         const float* coefficients1 = m_filterTable.data() + phaseIndex * m_numTaps;
+         const float* coefficients2 = coefficients1 + m_numTaps;
+
+         for (size_t channel = 0; channel < m_numChannels; channel++)
+         {
+            const float* samples = m_channelHistory[channel].data() + windowStart;
+
+            float value1 = m_fnDotProduct(samples, coefficients1, m_numTaps);
+            float value2 = m_fnDotProduct(samples, coefficients2, m_numTaps);
+
+            *output++ = value1 + weight * (value2 - value1);
+         }
+      }
+
+      numOutputSamples++;
+      m_numTotalOutputSamples++;
+
+      // advance by M / L input samples
+      m_phase += m_downFactor;
+      m_historyIndex += static_cast<size_t>(m_phase / m_upFactor);
+      m_phase %= m_upFactor;
+   }
+
+   return numOutputSamples;
+}
+
+void Resampler::DiscardHistory()
+{
+   const size_t historyLength = m_channelHistory[0].size();
+   const size_t windowStart = m_historyIndex + 1 - m_numTaps / 2;
+
+   // when decimating, the next window may even start after the last input sample
+   size_t numDiscard = std::min(windowStart, historyLength);
+   if (numDiscard == 0)
+      return;
+
+   for (std::vector<float>& history : m_channelHistory)
+      history.erase(history.begin(), history.begin() + numDiscard);
+
+   m_historyIndex -= numDiscard;
+}
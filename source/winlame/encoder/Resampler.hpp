@@ -0,0 +1,159 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file Resampler.hpp
+/// \brief polyphase sample rate converter
+//
+#pragma once
+
+#include <vector>
+
+namespace Encoder
+{
+   /// quality of the sample rate conversion
+   enum ResamplerQuality
+   {
+      resamplerQualityOff = 0,      ///< the sample container doesn't resample; output modules resample themselves
+      resamplerQualityFast = 1,     ///< short filter with a wide transition band
+      resamplerQualityMedium = 2,   ///< default quality
+      resamplerQualityBest = 3,     ///< long filter with a narrow transition band
+   };
+
+   /// \brief polyphase FIR sample rate converter for interleaved float samples
+   /// \details The conversion ratio is reduced to L/M = output rate / input rate.
+   /// Each output sample is calculated with one of L precalculated phases of a
+   /// Kaiser windowed sinc lowpass filter, so that no coefficients are calculated
+   /// while converting. When L is too large for a filter table, the output is
+   /// interpolated between the two nearest of c_maxNumPhases phases. The channels
+   /// are kept in separate history buffers, so that the filter runs over
+   /// consecutive samples; the dot products use the instruction set selected for
+   /// the SampleConverter. Output sample n lines up with input sample n * M / L,
+   /// so no delay is added.
+   class Resampler
+   {
+   public:
+      /// ctor
+      Resampler();
+
+      /// sets up conversion and resets all state; returns false when the parameters aren't supported
+      bool Init(int inputSamplerateInHz, int outputSamplerateInHz, size_t numChannels, ResamplerQuality quality);
+
+      /// returns input sample rate
+      int GetInputSamplerate() const { return m_inputSamplerateInHz; }
+
+      /// returns output sample rate
+      int GetOutputSamplerate() const { return m_outputSamplerateInHz; }
+
+      /// returns number of channels
+      size_t GetNumChannels() const { return m_numChannels; }
+
+      /// returns quality
+      ResamplerQuality GetQuality() const { return m_quality; }
+
+      /// returns the number of filter taps used for every output sample
+      size_t GetNumTaps() const { return m_numTaps; }
+
+      /// returns the maximum number of output samples for given number of input samples, per channel
+      size_t GetMaxOutputSamples(size_t numInputSamples) const;
+
+      /// returns the maximum number of output samples returned by Flush(), per channel
+      size_t GetMaxFlushSamples() const { return GetMaxOutputSamples(m_numTaps); }
+
+      /// \brief converts interleaved samples
+      /// \details output must have room for GetMaxOutputSamples(numInputSamples)
+      /// samples of all channels; returns the number of output samples, per channel.
+      /// Some output samples are held back until enough following input samples
+      /// have arrived.
+      size_t Process(const float* input, size_t numInputSamples, float* output);
+
+      /// \brief returns the samples held back at the end of the stream and resets the state
+      /// \details output must have room for GetMaxFlushSamples() samples of all
+      /// channels; returns the number of output samples, per channel
+      size_t Flush(float* output);
+
+      /// resets the state, e.g. to start a new stream
+      void Reset();
+
+      /// maximum number of filter phases stored in the table
+      static constexpr unsigned int c_maxNumPhases = 1024;
+
+   private:
+      /// calculates the filter table
+      void CalcFilterTable(double cutoff, double kaiserBeta);
+
+      /// calculates output samples as long as enough input samples are available,
+      /// but at most up to given total number of output samples; returns number of samples
+      size_t CalcOutputSamples(float* output, unsigned long long maxTotalOutputSamples);
+
+      /// removes history samples that aren't needed anymore
+      void DiscardHistory();
+
+   private:
+      /// type of function calculating the dot product of two vectors; the length is a multiple of 8
+      typedef float(*T_fnDotProduct)(const float* samples, const float* coefficients, size_t length);
+
+      /// input sample rate
+      int m_inputSamplerateInHz;
+
+      /// output sample rate
+      int m_outputSamplerateInHz;
+
+      /// number of channels
+      size_t m_numChannels;
+
+      /// quality
+      ResamplerQuality m_quality;
+
+      /// interpolation factor L
+      unsigned long long m_upFactor;
+
+      /// decimation factor M
+      unsigned long long m_downFactor;
+
+      /// number of phases in the filter table, without the extra phase at the end
+      unsigned int m_numPhases;
+
+      /// indicates if the output is interpolated between two phases, since L is larger than the table
+      bool m_interpolatePhases;
+
+      /// number of taps per phase; a multiple of 8
+      size_t m_numTaps;
+
+      /// filter table; m_numPhases + 1 phases with m_numTaps coefficients each
+      std::vector<float> m_filterTable;
+
+      /// dot product function for the current instruction set
+      T_fnDotProduct m_fnDotProduct;
+
+      /// input samples history, one buffer for each channel
+      std::vector<std::vector<float>> m_channelHistory;
+
+      /// index of the input sample in the history at or before the position of the next output sample
+      size_t m_historyIndex;
+
+      /// position of the next output sample between two input samples, in units of 1/L
+      unsigned long long m_phase;
+
+      /// number of input samples processed since the start of the stream, per channel
+      unsigned long long m_numTotalInputSamples;
+
+      /// number of output samples returned since the start of the stream, per channel
+      unsigned long long m_numTotalOutputSamples;
+   };
+
+} // namespace Encoder
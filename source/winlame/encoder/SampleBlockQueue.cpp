@@ -0,0 +1,171 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file SampleBlockQueue.cpp
+/// \brief lock-free ring of sample blocks between a producer and a consumer thread
+//
+#include "stdafx.h"
+#include "SampleBlockQueue.hpp"
+
+using Encoder::SampleBlockQueue;
+using Encoder::SampleBlock;
+
+/// number of tries a waiting side spins before it blocks
+const unsigned int c_numSpinTries = 64;
+
+SampleBlockQueue::SampleBlockQueue(size_t numBlocks, const SampleContainer& traits, int numSamplesPerBlock)
+{
+   ATLASSERT(numBlocks > 0 && numBlocks <= (c_countMask + 1) / 2);
+
+   // a power of two keeps block indices continuous when the counters wrap around
+   size_t numBlocksPowerOfTwo = 1;
+   while (numBlocksPowerOfTwo < numBlocks)
+      numBlocksPowerOfTwo *= 2;
+
+   m_indexMask = static_cast<uint32_t>(numBlocksPowerOfTwo - 1);
+
+   for (size_t index = 0; index < numBlocksPowerOfTwo; index++)
+   {
+      m_blocks.push_back(std::make_unique<SampleBlock>());
+      m_blocks.back()->m_samples.CopyModuleTraits(traits);
+
+      if (numSamplesPerBlock > 0)
+         m_blocks.back()->m_samples.ReserveSamples(numSamplesPerBlock);
+   }
+}
+
+SampleBlock* SampleBlockQueue::BeginWrite()
+{
+   const uint32_t writeCount = m_writeCount.load(std::memory_order_relaxed) & c_countMask;
+
+   for (unsigned int numTries = 0; ; numTries++)
+   {
+      if (m_cancelled.load(std::memory_order_acquire))
+         return nullptr;
+
+      if (NumFilledBlocks(writeCount, m_producerReadCount) < m_blocks.size())
+         return m_blocks[writeCount & m_indexMask].get();
+
+      // only look at the consumer's cache line when the ring seems to be full
+      uint32_t readCount = m_readCount.load(std::memory_order_acquire);
+      if (readCount != m_producerReadCount)
+      {
+         m_producerReadCount = readCount;
+         continue;
+      }
+
+      WaitForChange(m_readCount, readCount, m_producerWaiting, numTries);
+   }
+}
+
+void SampleBlockQueue::EndWrite()
+{
+   if (m_cancelled.load(std::memory_order_acquire))
+      return;
+
+   uint32_t writeCount = m_writeCount.load(std::memory_order_relaxed);
+   ATLASSERT((writeCount & c_closedFlag) == 0);
+
+   StoreAndNotify(m_writeCount, (writeCount + 1) & c_countMask, m_consumerWaiting);
+}
+
+void SampleBlockQueue::CloseWrite()
+{
+   m_writeCount.fetch_or(c_closedFlag);
+   m_writeCount.notify_all();
+}
+
+SampleBlock* SampleBlockQueue::BeginRead()
+{
+   const uint32_t readCount = m_readCount.load(std::memory_order_relaxed);
+
+   for (unsigned int numTries = 0; ; numTries++)
+   {
+      if (m_cancelled.load(std::memory_order_acquire))
+         return nullptr;
+
+      if (NumFilledBlocks(m_consumerWriteCount, readCount) > 0)
+         return m_blocks[readCount & m_indexMask].get();
+
+      // only look at the producer's cache line when the ring seems to be empty
+      uint32_t writeCount = m_writeCount.load(std::memory_order_acquire);
+      if (writeCount != m_consumerWriteCount)
+      {
+         m_consumerWriteCount = writeCount;
+         continue;
+      }
+
+      // end of stream?
+      if ((writeCount & c_closedFlag) != 0)
+         return nullptr;
+
+      WaitForChange(m_writeCount, writeCount, m_consumerWaiting, numTries);
+   }
+}
+
+void SampleBlockQueue::EndRead()
+{
+   if (m_cancelled.load(std::memory_order_acquire))
+      return;
+
+   uint32_t readCount = m_readCount.load(std::memory_order_relaxed);
+
+   StoreAndNotify(m_readCount, (readCount + 1) & c_countMask, m_producerWaiting);
+}
+
+void SampleBlockQueue::Cancel()
+{
+   m_cancelled.store(true);
+
+   // change both counters, so that waiting sides wake up and see the cancel flag;
+   // the counter values don't matter anymore after cancelling
+   m_writeCount.fetch_add(1);
+   m_writeCount.notify_all();
+
+   m_readCount.fetch_add(1);
+   m_readCount.notify_all();
+}
+
+void SampleBlockQueue::WaitForChange(std::atomic<uint32_t>& counter, uint32_t value,
+   std::atomic<bool>& waitingFlag, unsigned int numTries)
+{
+   if (numTries < c_numSpinTries)
+   {
+      std::this_thread::yield();
+      return;
+   }
+
+   // announce waiting before checking the counter a last time; pairs with StoreAndNotify()
+   waitingFlag.store(true);
+
+   if (!m_cancelled.load())
+      counter.wait(value);
+
+   waitingFlag.store(false, std::memory_order_relaxed);
+}
+
+void SampleBlockQueue::StoreAndNotify(std::atomic<uint32_t>& counter, uint32_t value,
+   std::atomic<bool>& waitingFlag)
+{
+   // sequentially consistent store and load, so that either the waiting side sees the
+   // new value before blocking, or this side sees the waiting flag
+   counter.store(value);
+
+   if (waitingFlag.load())
+      counter.notify_one();
+}
@@ -0,0 +1,147 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file SampleBlockQueue.hpp
+/// \brief lock-free ring of sample blocks between a producer and a consumer thread
+//
+#pragma once
+
+#include "SampleContainer.hpp"
+#include <cstdint>
+
+#pragma warning(push)
+#pragma warning(disable: 4324) // structure was padded due to alignment specifier
+
+namespace Encoder
+{
+   /// block of samples passed through a SampleBlockQueue
+   struct SampleBlock
+   {
+      /// samples of this block
+      SampleContainer m_samples;
+
+      /// percent done of the input module after decoding this block
+      float m_percentDone = 0.0f;
+   };
+
+   /// \brief lock-free single-producer, single-consumer ring of preallocated sample blocks
+   /// \details the producer fills blocks with BeginWrite() and EndWrite(), the
+   /// consumer processes them with BeginRead() and EndRead(), in the same order.
+   /// Blocks are reused, so no allocations take place while samples are passed.
+   /// The read and write counters live on separate cache lines and are only
+   /// written by their own side. When all blocks are filled, the producer waits
+   /// until the consumer has processed a block (back-pressure); when no block is
+   /// filled, the consumer waits. Waiting spins shortly, then blocks on the
+   /// counter of the other side; the other side only wakes it up when it is
+   /// actually waiting.
+   class SampleBlockQueue
+   {
+   public:
+      /// \brief ctor; creates blocks with the same module traits as the given container
+      /// \details the number of blocks is rounded up to a power of two; when
+      /// numSamplesPerBlock is given, memory for that many samples is preallocated
+      SampleBlockQueue(size_t numBlocks, const SampleContainer& traits, int numSamplesPerBlock = 0);
+
+      /// returns the number of blocks in the ring
+      size_t GetNumBlocks() const { return m_blocks.size(); }
+
+      /// returns the next free block to fill, waiting for one to become free;
+      /// returns nullptr when the queue was cancelled; producer only
+      SampleBlock* BeginWrite();
+
+      /// passes the block returned by BeginWrite() on to the consumer; producer only
+      void EndWrite();
+
+      /// marks the end of the stream; the consumer still gets all blocks written so far;
+      /// producer only
+      void CloseWrite();
+
+      /// returns the next filled block, waiting for one to arrive; returns nullptr
+      /// at the end of the stream or when the queue was cancelled; consumer only
+      SampleBlock* BeginRead();
+
+      /// returns the block returned by BeginRead() to the producer; consumer only
+      void EndRead();
+
+      /// cancels the queue; all waiting and further calls return immediately; may be
+      /// called from any thread
+      void Cancel();
+
+   private:
+      /// returns number of filled blocks for given write and read counter
+      static uint32_t NumFilledBlocks(uint32_t writeCount, uint32_t readCount)
+      {
+         return (writeCount - readCount) & c_countMask;
+      }
+
+      /// waits until the counter has changed from the given value; spins first
+      void WaitForChange(std::atomic<uint32_t>& counter, uint32_t value,
+         std::atomic<bool>& waitingFlag, unsigned int numTries);
+
+      /// stores new counter value and wakes up the other side when it's waiting
+      static void StoreAndNotify(std::atomic<uint32_t>& counter, uint32_t value,
+         std::atomic<bool>& waitingFlag);
+
+   private:
+      /// size of a cache line
+      static constexpr size_t c_cacheLineSize = 64;
+
+      /// flag in the write counter that is set when the producer closed the stream
+      static constexpr uint32_t c_closedFlag = 0x80000000U;
+
+      /// mask for the actual count in the read and write counters
+      static constexpr uint32_t c_countMask = 0x7fffffffU;
+
+      /// all sample blocks
+      std::vector<std::unique_ptr<SampleBlock>> m_blocks;
+
+      /// mask to get block index from a counter value
+      uint32_t m_indexMask = 0;
+
+      /// indicates if the queue was cancelled
+      std::atomic<bool> m_cancelled = false;
+
+      // producer side
+
+      /// number of blocks written, plus closed flag; written by producer
+      alignas(c_cacheLineSize) std::atomic<uint32_t> m_writeCount = 0;
+
+      /// indicates if the producer waits for the read counter to change
+      std::atomic<bool> m_producerWaiting = false;
+
+      /// last read counter value seen by the producer
+      uint32_t m_producerReadCount = 0;
+
+      // consumer side
+
+      /// number of blocks read; written by consumer
+      alignas(c_cacheLineSize) std::atomic<uint32_t> m_readCount = 0;
+
+      /// indicates if the consumer waits for the write counter to change
+      std::atomic<bool> m_consumerWaiting = false;
+
+      /// last write counter value seen by the consumer
+      uint32_t m_consumerWriteCount = 0;
+
+      /// padding, so that the consumer side doesn't share a cache line with other data
+      alignas(c_cacheLineSize) char m_padding = 0;
+   };
+
+} // namespace Encoder
+
+#pragma warning(pop)
@@ -21,16 +21,22 @@
 //
 #include "stdafx.h"
 #include "SampleContainer.hpp"
-#include <cstring>
+#include "SampleConverter.hpp"
 
 using Encoder::SampleContainer;
 using Encoder::SampleFormatType;
+using Encoder::SampleConverter;
+using Encoder::Resampler;
 
 SampleContainer::SampleContainer()
    :m_channelArray(nullptr),
    m_interleaved(nullptr),
+   m_borrowedInterleaved(nullptr),
    m_numBytesAvail(0),
-   m_numSamplesAvail(0)
+   m_numSamplesAvail(0),
+   m_outputModuleFrameSize(0),
+   m_resamplerQuality(resamplerQualityMedium),
+   m_conversionNanoseconds(0)
 {
    source.format = SamplesUnknown;
    target.format = SamplesUnknown;
@@ -49,6 +55,15 @@ void SampleContainer::SetInputModuleTraits(int bitsPerSample,
    source.format = format;
    source.samplerateInHz = samplerateInHz;
    source.numChannels = numChannels;
+   source.floatSamples = false;
+}
+
+void SampleContainer::SetInputModuleFloatTraits(SampleFormatType format,
+   int samplerateInHz, int numChannels)
+{
+   SetInputModuleTraits(sizeof(float) * 8, format, samplerateInHz, numChannels);
+
+   source.floatSamples = true;
 }
 
 void SampleContainer::SetOutputModuleTraits(int bitsPerSample,
@@ -64,6 +79,7 @@ void SampleContainer::SetOutputModuleTraits(int bitsPerSample,
    target.format = format;
    target.samplerateInHz = samplerateInHz;
    target.numChannels = numChannels;
+   target.floatSamples = false;
 
    // initial value
    m_numBytesAvail = 512;
@@ -89,36 +105,70 @@ void SampleContainer::SetOutputModuleTraits(int bitsPerSample,
       ATLASSERT(false);
       break;
    }
+
+   InitResampler();
+}
+
+void SampleContainer::SetOutputModuleFloatTraits(SampleFormatType format,
+   int samplerateInHz, int numChannels)
+{
+   SetOutputModuleTraits(sizeof(float) * 8, format, samplerateInHz, numChannels);
+
+   target.floatSamples = true;
+}
+
+void SampleContainer::SetOutputModuleFrameSize(int numSamples)
+{
+   m_outputModuleFrameSize = numSamples;
+
+   ReserveSamples(GetPreferredBlockSize());
+}
+
+int SampleContainer::GetPreferredBlockSize() const
+{
+   if (m_outputModuleFrameSize <= 0)
+      return c_defaultBlockSize;
+
+   // as many whole frames as fit into the default block size, but at least one
+   int numFrames = std::max(1, c_defaultBlockSize / m_outputModuleFrameSize);
+   return numFrames * m_outputModuleFrameSize;
 }
 
 void SampleContainer::PutSamplesInterleaved(void* samples, int numSamples)
 {
+   StageTimer timer(m_conversionNanoseconds);
+
+   m_borrowedInterleaved = nullptr;
+
+   if (m_resampler != nullptr)
+   {
+      ResampleInterleaved(samples, numSamples);
+      return;
+   }
+
    // check if there is enough space in the buffer
    if (numSamples > m_numBytesAvail)
       ReallocMemory(numSamples);
 
+   ATLASSERT(source.numChannels == target.numChannels);
+
    // conversion from interleaved to ...
 
    switch (target.format)
    {
    case SamplesChannelArray: // channel array
-   {
-      for (int i = 0; i < source.numChannels; i++)
-      {
-         DeinterleaveChannel((unsigned char*)(samples)+i * (source.bitsPerSample >> 3),
-            numSamples, i, source.numChannels*source.bitsPerSample >> 3);
-      }
-   }
-   break;
+      SampleConverter::InterleavedToArray(
+         samples, GetSourceSampleType(),
+         m_channelArray, GetTargetSampleType(),
+         numSamples, source.numChannels);
+      break;
+
    case SamplesInterleaved: // interleaved
-   {
-      for (int i = 0; i < source.numChannels; i++)
-      {
-         InterleaveChannel((unsigned char*)(samples)+i * (source.bitsPerSample >> 3),
-            numSamples, i, source.numChannels*(source.bitsPerSample >> 3));
-      }
-   }
-   break;
+      SampleConverter::InterleavedToInterleaved(
+         samples, GetSourceSampleType(),
+         m_interleaved, GetTargetSampleType(),
+         numSamples, source.numChannels);
+      break;
 
    default:
       ATLASSERT(false);
@@ -128,47 +178,126 @@ void SampleContainer::PutSamplesInterleaved(void* samples, int numSamples)
    m_numSamplesAvail = numSamples;
 }
 
+void SampleContainer::PutSamplesInterleavedBorrowed(void* samples, int numSamples)
+{
+   if (!IsPassthrough())
+   {
+      PutSamplesInterleaved(samples, numSamples);
+      return;
+   }
+
+   m_borrowedInterleaved = samples;
+   m_numSamplesAvail = numSamples;
+}
+
 void SampleContainer::PutSamplesArray(void** samples, int numSamples)
 {
+   StageTimer timer(m_conversionNanoseconds);
+
+   m_borrowedInterleaved = nullptr;
+
+   if (m_resampler != nullptr)
+   {
+      ResampleArray(samples, numSamples);
+      return;
+   }
+
    // check if there is enough space in the buffer
    if (numSamples > m_numBytesAvail)
       ReallocMemory(numSamples);
 
+   ATLASSERT(source.numChannels == target.numChannels);
+
    // conversion from channel array to ...
 
    switch (target.format)
    {
    case SamplesChannelArray: // channel array
-   {
-      for (int i = 0; i < source.numChannels; i++)
-      {
-         DeinterleaveChannel((unsigned char*)(samples[i]), numSamples,
-            i, source.bitsPerSample >> 3);
-      }
-   }
-   break;
+      SampleConverter::ArrayToArray(
+         samples, GetSourceSampleType(),
+         m_channelArray, GetTargetSampleType(),
+         numSamples, source.numChannels);
+      break;
 
    case SamplesInterleaved: // interleaved
+      SampleConverter::ArrayToInterleaved(
+         samples, GetSourceSampleType(),
+         m_interleaved, GetTargetSampleType(),
+         numSamples, source.numChannels);
+      break;
+
+   default:
+      ATLASSERT(false);
+      break;
+   }
+
+   m_numSamplesAvail = numSamples;
+}
+
+void SampleContainer::PutSamplesArrayLowBits(const int* const* samples, unsigned int sourceBits, int numSamples)
+{
+   StageTimer timer(m_conversionNanoseconds);
+
+   m_borrowedInterleaved = nullptr;
+
+   if (m_resampler != nullptr)
    {
-      for (int i = 0; i < source.numChannels; i++)
-      {
-         InterleaveChannel((unsigned char*)(samples[i]), numSamples,
-            i, source.bitsPerSample >> 3);
-      }
+      ResampleArrayLowBits(samples, sourceBits, numSamples);
+      return;
    }
-   break;
+
+   // check if there is enough space in the buffer
+   if (numSamples > m_numBytesAvail)
+      ReallocMemory(numSamples);
+
+   ATLASSERT(source.numChannels == target.numChannels);
+
+   switch (target.format)
+   {
+   case SamplesChannelArray: // channel array
+      SampleConverter::LowBitsArrayToArray(
+         samples, sourceBits,
+         m_channelArray, GetTargetSampleType(),
+         numSamples, source.numChannels);
+      break;
+
+   case SamplesInterleaved: // interleaved
+      SampleConverter::LowBitsArrayToInterleaved(
+         samples, sourceBits,
+         m_interleaved, GetTargetSampleType(),
+         numSamples, source.numChannels);
+      break;
 
    default:
       ATLASSERT(false);
       break;
    }
+
    m_numSamplesAvail = numSamples;
 }
 
+int SampleContainer::FlushSamples()
+{
+   if (m_resampler == nullptr)
+      return 0;
+
+   StageTimer timer(m_conversionNanoseconds);
+
+   m_borrowedInterleaved = nullptr;
+
+   m_resampleOutput.resize(m_resampler->GetMaxFlushSamples() * source.numChannels);
+
+   int numSamples = static_cast<int>(m_resampler->Flush(m_resampleOutput.data()));
+
+   StoreResampledSamples(numSamples);
+
+   return numSamples;
+}
+
 void* SampleContainer::GetSamplesInterleaved(int& numSamples)
 {
    numSamples = m_numSamplesAvail;
-   return m_interleaved;
+   return m_borrowedInterleaved != nullptr ? m_borrowedInterleaved : m_interleaved;
 }
 
 void** SampleContainer::GetSamplesArray(int& numSamples)
@@ -177,6 +306,157 @@ void** SampleContainer::GetSamplesArray(int& numSamples)
    return m_channelArray;
 }
 
+bool SampleContainer::IsPassthrough() const
+{
+   return source.format != SamplesUnknown &&
+      target.format == SamplesInterleaved &&
+      source.numChannels == target.numChannels &&
+      source.samplerateInHz == target.samplerateInHz &&
+      GetSourceSampleType() == GetTargetSampleType();
+}
+
+void SampleContainer::CopyModuleTraits(const SampleContainer& other)
+{
+   DeallocMemory();
+
+   source = other.source;
+
+   // the resampler is reused by InitResampler(), instead of creating a new one
+   m_resamplerQuality = other.m_resamplerQuality;
+   m_resampler = other.m_resampler;
+
+   if (other.target.floatSamples)
+      SetOutputModuleFloatTraits(other.target.format, other.target.samplerateInHz, other.target.numChannels);
+   else
+      SetOutputModuleTraits(other.target.bitsPerSample, other.target.format, other.target.samplerateInHz, other.target.numChannels);
+
+   SetOutputModuleFrameSize(other.m_outputModuleFrameSize);
+}
+
+void SampleContainer::ReserveSamples(int numSamples)
+{
+   if (numSamples > m_numBytesAvail)
+      ReallocMemory(numSamples);
+}
+
+void SampleContainer::ReleaseBorrowedSamples()
+{
+   if (m_borrowedInterleaved == nullptr)
+      return;
+
+   // source and target traits match, so this just copies the samples
+   PutSamplesInterleaved(m_borrowedInterleaved, m_numSamplesAvail);
+}
+
+void SampleContainer::InitResampler()
+{
+   if (m_resamplerQuality == resamplerQualityOff ||
+      source.samplerateInHz <= 0 ||
+      source.samplerateInHz == target.samplerateInHz)
+   {
+      m_resampler.reset();
+      return;
+   }
+
+   ATLASSERT(source.numChannels == target.numChannels);
+
+   if (m_resampler != nullptr &&
+      m_resampler->GetInputSamplerate() == source.samplerateInHz &&
+      m_resampler->GetOutputSamplerate() == target.samplerateInHz &&
+      m_resampler->GetNumChannels() == size_t(source.numChannels) &&
+      m_resampler->GetQuality() == m_resamplerQuality)
+      return;
+
+   m_resampler = std::make_shared<Resampler>();
+   if (!m_resampler->Init(source.samplerateInHz, target.samplerateInHz, source.numChannels, m_resamplerQuality))
+      m_resampler.reset();
+}
+
+void SampleContainer::ResampleInterleaved(const void* samples, int numSamples)
+{
+   // float input samples are passed to the resampler directly
+   const float* input = static_cast<const float*>(samples);
+
+   if (GetSourceSampleType() != SampleTypeFloat32)
+   {
+      m_resampleInput.resize(size_t(numSamples) * source.numChannels);
+
+      SampleConverter::InterleavedToInterleaved(
+         samples, GetSourceSampleType(),
+         m_resampleInput.data(), SampleTypeFloat32,
+         numSamples, source.numChannels);
+
+      input = m_resampleInput.data();
+   }
+
+   m_resampleOutput.resize(m_resampler->GetMaxOutputSamples(numSamples) * source.numChannels);
+
+   size_t numOutputSamples = m_resampler->Process(input, numSamples, m_resampleOutput.data());
+
+   StoreResampledSamples(static_cast<int>(numOutputSamples));
+}
+
+void SampleContainer::ResampleArray(void** samples, int numSamples)
+{
+   m_resampleInput.resize(size_t(numSamples) * source.numChannels);
+
+   SampleConverter::ArrayToInterleaved(
+      samples, GetSourceSampleType(),
+      m_resampleInput.data(), SampleTypeFloat32,
+      numSamples, source.numChannels);
+
+   m_resampleOutput.resize(m_resampler->GetMaxOutputSamples(numSamples) * source.numChannels);
+
+   size_t numOutputSamples = m_resampler->Process(m_resampleInput.data(), numSamples, m_resampleOutput.data());
+
+   StoreResampledSamples(static_cast<int>(numOutputSamples));
+}
+
+void SampleContainer::ResampleArrayLowBits(const int* const* samples, unsigned int sourceBits, int numSamples)
+{
+   m_resampleInput.resize(size_t(numSamples) * source.numChannels);
+
+   SampleConverter::LowBitsArrayToInterleaved(
+      samples, sourceBits,
+      m_resampleInput.data(), SampleTypeFloat32,
+      numSamples, source.numChannels);
+
+   m_resampleOutput.resize(m_resampler->GetMaxOutputSamples(numSamples) * source.numChannels);
+
+   size_t numOutputSamples = m_resampler->Process(m_resampleInput.data(), numSamples, m_resampleOutput.data());
+
+   StoreResampledSamples(static_cast<int>(numOutputSamples));
+}
+
+void SampleContainer::StoreResampledSamples(int numSamples)
+{
+   if (numSamples > m_numBytesAvail)
+      ReallocMemory(numSamples);
+
+   switch (target.format)
+   {
+   case SamplesChannelArray:
+      SampleConverter::InterleavedToArray(
+         m_resampleOutput.data(), SampleTypeFloat32,
+         m_channelArray, GetTargetSampleType(),
+         numSamples, target.numChannels);
+      break;
+
+   case SamplesInterleaved:
+      SampleConverter::InterleavedToInterleaved(
+         m_resampleOutput.data(), SampleTypeFloat32,
+         m_interleaved, GetTargetSampleType(),
+         numSamples, target.numChannels);
+      break;
+
+   default:
+      ATLASSERT(false);
+      break;
+   }
+
+   m_numSamplesAvail = numSamples;
+}
+
 void SampleContainer::ReallocMemory(int newSamples)
 {
    m_numBytesAvail = newSamples;
@@ -223,106 +503,8 @@ void SampleContainer::DeallocMemory()
       m_interleaved = nullptr;
    }
 
+   m_borrowedInterleaved = nullptr;
+
    source.format = SamplesUnknown;
    target.format = SamplesUnknown;
 }
-
-void SampleContainer::InterleaveChannel(unsigned char* samples, int numSamples, int channel, int sourceStep)
-{
-   int sourceShift = 32 - source.bitsPerSample;
-   int dbps = target.bitsPerSample >> 3;
-   int destShift = 32 - target.bitsPerSample;
-   int destStep = target.numChannels * (target.bitsPerSample >> 3);
-
-   int roundbit = destShift > 0 ? (1 << (destShift - 1)) : 0;
-   int destHigh = std::numeric_limits<int>::max() - roundbit + 1;
-
-   unsigned char *destbuf =
-      ((unsigned char*)m_interleaved) + dbps * channel;
-
-   for (int i = 0; i < numSamples; i++)
-   {
-      signed int sample;
-
-      sample = *((unsigned int*)samples);
-
-      // normalize
-
-      // shift up
-      sample <<= sourceShift;
-
-      // do sth with the sample
-
-      // add rounding value
-      if (sample < destHigh)
-         sample += roundbit;
-
-      // shift to target bps
-      sample >>= destShift;
-
-      // store sample in destbuf
-      _asm
-      {
-         mov   edi, destbuf
-         mov   eax, sample
-         mov   ecx, dbps
-         label1 :
-         stosb
-            shr   eax, 8
-            loop  label1
-      }
-
-      destbuf += destStep;
-      samples += sourceStep;
-   }
-}
-
-void SampleContainer::DeinterleaveChannel(unsigned char*samples, int numSamples, int channel, int sourceStep)
-{
-   int sourceShift = 32 - source.bitsPerSample;
-   int dbps = target.bitsPerSample >> 3;
-   int destShift = 32 - target.bitsPerSample;
-   int destStep = dbps;
-
-   int roundbit = destShift > 0 ? (1 << (destShift - 1)) : 0;
-   int destHigh = std::numeric_limits<int>::max() - roundbit + 1;
-
-   unsigned char *destbuf = (unsigned char*)m_channelArray[channel];
-
-   for (int i = 0; i < numSamples; i++)
-   {
-      signed int sample;
-
-      sample = *((unsigned int*)samples);
-
-      // normalize
-
-      // shift up
-      sample <<= sourceShift;
-
-      // do sth with the sample
-
-      // add rounding value
-      if (sample < destHigh)
-         sample += roundbit;
-
-      // shift to target bps
-      sample >>= destShift;
-
-      // store sample in destbuf
-      _asm
-      {
-         mov   edi, destbuf
-         mov   eax, sample
-         mov   ecx, dbps
-         label1 :
-         stosb
-            shr   eax, 8
-            loop  label1
-      }
-
-      destbuf += destStep;
-      samples += sourceStep;
-   }
-
-}
@@ -23,6 +23,11 @@
 //
 #pragma once
 
+#include "SampleConverter.hpp"
+#include "EncoderStatistics.hpp"
+#include "Resampler.hpp"
+#include <memory>
+
 namespace Encoder
 {
    /// sample format type
@@ -48,12 +53,16 @@ namespace Encoder
       /// number of channels
       int numChannels;
 
+      /// indicates if samples are 32 bit float values, normalized to [-1.0; 1.0]
+      bool floatSamples;
+
       /// ctor
       ModuleTraits()
          :bitsPerSample(0),
          format(SamplesInterleaved),
          samplerateInHz(0),
-         numChannels(0)
+         numChannels(0),
+         floatSamples(false)
       {
       }
    };
@@ -83,8 +92,25 @@ namespace Encoder
       /// returns the input module bits per sample
       int GetInputModuleBitsPerSample() { return source.bitsPerSample; }
 
+      /// sets traits of the input module, delivering 32 bit float samples
+      void SetInputModuleFloatTraits(SampleFormatType format,
+         int samplerateInHz, int numChannels);
+
+      /// returns if the input module delivers float samples
+      bool IsInputModuleFloat() const { return source.floatSamples; }
+
       // output module functions
 
+      /// \brief sets the quality used to convert the sample rate
+      /// \details must be called before the output module traits are set; when the
+      /// output module sample rate differs from the input module sample rate, the
+      /// samples are then converted in the container. With resamplerQualityOff, the
+      /// output module must set the input module sample rate and resample itself.
+      void SetResamplerQuality(ResamplerQuality quality) { m_resamplerQuality = quality; }
+
+      /// returns if the container converts the sample rate when the output module asks for a different one
+      bool IsResamplingEnabled() const { return m_resamplerQuality != resamplerQualityOff; }
+
       /// sets traits of the output module
       void SetOutputModuleTraits(int bitsPerSample, SampleFormatType format,
          int samplerateInHz = -1, int numChannels = -1);
@@ -98,20 +124,91 @@ namespace Encoder
       /// returns the input module bits per sample
       int GetOutputModuleBitsPerSample() { return target.bitsPerSample; }
 
+      /// sets traits of the output module, accepting 32 bit float samples
+      void SetOutputModuleFloatTraits(SampleFormatType format,
+         int samplerateInHz = -1, int numChannels = -1);
+
+      /// returns if the output module accepts float samples
+      bool IsOutputModuleFloat() const { return target.floatSamples; }
+
+      /// returns the output module sample format
+      SampleFormatType GetOutputModuleSampleFormat() const { return target.format; }
+
+      /// returns the sample type of the samples returned to the output module
+      SampleType GetOutputModuleSampleType() const { return GetTargetSampleType(); }
+
+      /// \brief sets the number of samples per channel the output module encodes at once
+      /// \details input modules then deliver blocks of a multiple of that size, so
+      /// that the output module can encode frames directly from the sample block
+      void SetOutputModuleFrameSize(int numSamples);
+
+      // functions to negotiate block size
+
+      /// \brief returns the number of samples per channel the input module should
+      /// deliver with each DecodeSamples() call
+      /// \details this is a multiple of the output module frame size, when the output
+      /// module set one; input modules that can read any number of samples should
+      /// fill exactly that many samples, except at the end of the stream
+      int GetPreferredBlockSize() const;
+
+      /// default block size, in samples per channel, when the output module has no frame size
+      static constexpr int c_defaultBlockSize = 4096;
+
       // functions to put samples in or get samples out
 
       /// stores samples in interleaved format in the sample container
       void PutSamplesInterleaved(void* samples, int numSamples);
 
-      /// stores samples in interleaved format in the sample container
+      /// \brief stores samples in interleaved format, borrowing the buffer when possible
+      /// \details when the input and output module traits match (same sample type,
+      /// number of channels and interleaved output format), no copy is made and
+      /// GetSamplesInterleaved() returns the passed buffer directly. The buffer must
+      /// therefore stay valid and unmodified until the next call to
+      /// DecodeSamples() or DoneInput() of the input module. Otherwise the samples
+      /// are converted as with PutSamplesInterleaved().
+      void PutSamplesInterleavedBorrowed(void* samples, int numSamples);
+
+      /// stores samples in channel array format in the sample container
       void PutSamplesArray(void **samples, int numSamples);
 
+      /// \brief stores channel array samples stored in the lower sourceBits bits of 32 bit
+      /// integers, e.g. as decoded by libFLAC
+      /// \details the samples are converted to the output module format in a single pass;
+      /// the input module traits are set up with the bits per sample of a sample type
+      /// that holds sourceBits bits
+      void PutSamplesArrayLowBits(const int* const* samples, unsigned int sourceBits, int numSamples);
+
+      /// \brief stores the samples the resampler held back at the end of the stream
+      /// \details returns the number of samples stored, per channel; 0 when the
+      /// container doesn't resample or no samples are left
+      int FlushSamples();
+
       /// retrieves samples in interleaved format
       void* GetSamplesInterleaved(int& numSamples);
 
       /// retrieves samples in channel array format
       void** GetSamplesArray(int& numSamples);
 
+      /// returns if input and output module traits match, so that samples can be
+      /// passed through without conversion
+      bool IsPassthrough() const;
+
+      /// \brief sets up input and output module traits from another sample container
+      /// \details used to set up additional containers with the same traits, e.g. for
+      /// passing samples between threads
+      void CopyModuleTraits(const SampleContainer& other);
+
+      /// preallocates memory for the given number of samples per channel
+      void ReserveSamples(int numSamples);
+
+      /// \brief copies borrowed samples into the container's own memory
+      /// \details afterwards the samples stay valid even when the input module reuses
+      /// its buffer; does nothing when the samples weren't borrowed
+      void ReleaseBorrowedSamples();
+
+      /// returns time spent converting samples, summed up over all calls, in nanoseconds
+      unsigned long long GetConversionNanoseconds() const { return m_conversionNanoseconds; }
+
    private:
       /// reallocates internal output buffers
       void ReallocMemory(int newSampleSize);
@@ -119,11 +216,33 @@ namespace Encoder
       /// deallocates memory
       void DeallocMemory();
 
-      /// converts samples to interleaved target buffer
-      void InterleaveChannel(unsigned char* samples, int numSamples, int numChannels, int sourceStep);
+      /// sets up resampler for the current input and output module traits
+      void InitResampler();
+
+      /// converts interleaved input samples to the output sample rate
+      void ResampleInterleaved(const void* samples, int numSamples);
+
+      /// converts channel array input samples to the output sample rate
+      void ResampleArray(void** samples, int numSamples);
+
+      /// converts channel array input samples stored in the lower bits of 32 bit integers
+      /// to the output sample rate
+      void ResampleArrayLowBits(const int* const* samples, unsigned int sourceBits, int numSamples);
+
+      /// stores the samples in the resampler output buffer in the output module format
+      void StoreResampledSamples(int numSamples);
+
+      /// returns sample type of the input module samples
+      SampleType GetSourceSampleType() const
+      {
+         return source.floatSamples ? SampleTypeFloat32 : SampleConverter::SampleTypeFromBitsPerSample(source.bitsPerSample);
+      }
 
-      /// converts samples to channel array target buffer
-      void DeinterleaveChannel(unsigned char* samples, int numSamples, int numChannels, int sourceStep);
+      /// returns sample type of the output module samples
+      SampleType GetTargetSampleType() const
+      {
+         return target.floatSamples ? SampleTypeFloat32 : SampleConverter::SampleTypeFromBitsPerSample(target.bitsPerSample);
+      }
 
    private:
       /// source traits
@@ -138,11 +257,34 @@ namespace Encoder
       /// interleaved samples memory
       void* m_interleaved;
 
+      /// interleaved samples borrowed from the input module; nullptr when samples were copied
+      void* m_borrowedInterleaved;
+
       /// number of bytes available in the buffer(s)
       int m_numBytesAvail;
 
       /// number of available samples
       int m_numSamplesAvail;
+
+      /// number of samples per channel the output module encodes at once; 0 when not set
+      int m_outputModuleFrameSize;
+
+      /// quality used to convert the sample rate
+      ResamplerQuality m_resamplerQuality;
+
+      /// resampler; nullptr when the sample rate isn't converted. Containers set up
+      /// with CopyModuleTraits() share the resampler, since they carry consecutive
+      /// blocks of the same stream
+      std::shared_ptr<Resampler> m_resampler;
+
+      /// interleaved float samples passed to the resampler
+      std::vector<float> m_resampleInput;
+
+      /// interleaved float samples returned by the resampler
+      std::vector<float> m_resampleOutput;
+
+      /// time spent converting samples, in nanoseconds
+      unsigned long long m_conversionNanoseconds;
    };
 
 } // namespace Encoder
@@ -0,0 +1,1314 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file SampleConverter.cpp
+/// \brief sample format conversion kernels implementation
+//
+#include "stdafx.h"
+#include "SampleConverter.hpp"
+#include <intrin.h>
+#include <immintrin.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using Encoder::SampleConverter;
+using Encoder::SampleType;
+using Encoder::SampleConverterInstructionSet;
+
+namespace
+{
+   /// factor to scale a 32 bit aligned integer sample to float
+   const float c_int32ToFloatScale = 1.0f / 2147483648.0f;
+
+   /// largest float value that can be converted to a 32 bit integer
+   const float c_floatToInt32Max = 2147483520.0f;
+
+   /// number of channels for which the channel pointer list doesn't allocate memory
+   const size_t c_maxStackChannels = 16;
+
+   /// size of the stack buffer used to convert interleaved samples block by block, in bytes
+   const size_t c_blockBufferSize = 8 * 1024;
+
+   /// \brief sample traits
+   /// \details integer samples are loaded aligned to 32 bit, and stored from
+   /// a value that was already shifted down to the target bit depth
+   template <SampleType T> struct SampleTraits;
+
+   /// sample traits for 8 bit signed integer samples
+   template <> struct SampleTraits<Encoder::SampleTypeInt8>
+   {
+      static const bool isFloat = false;
+      static const int bitsPerSample = 8;
+      static const unsigned int sampleSize = 1;
+
+      static int Load(const unsigned char* sample)
+      {
+         return static_cast<int>(static_cast<unsigned int>(sample[0]) << 24);
+      }
+
+      static void Store(unsigned char* sample, int value)
+      {
+         sample[0] = static_cast<unsigned char>(value);
+      }
+   };
+
+   /// sample traits for 16 bit signed integer samples
+   template <> struct SampleTraits<Encoder::SampleTypeInt16>
+   {
+      static const bool isFloat = false;
+      static const int bitsPerSample = 16;
+      static const unsigned int sampleSize = 2;
+
+      static int Load(const unsigned char* sample)
+      {
+         unsigned short value;
+         memcpy(&value, sample, sizeof(value));
+         return static_cast<int>(static_cast<unsigned int>(value) << 16);
+      }
+
+      static void Store(unsigned char* sample, int value)
+      {
+         short storeValue = static_cast<short>(value);
+         memcpy(sample, &storeValue, sizeof(storeValue));
+      }
+   };
+
+   /// sample traits for 24 bit signed integer samples, packed into 3 bytes
+   template <> struct SampleTraits<Encoder::SampleTypeInt24>
+   {
+      static const bool isFloat = false;
+      static const int bitsPerSample = 24;
+      static const unsigned int sampleSize = 3;
+
+      static int Load(const unsigned char* sample)
+      {
+         return static_cast<int>(
+            (static_cast<unsigned int>(sample[0]) << 8) |
+            (static_cast<unsigned int>(sample[1]) << 16) |
+            (static_cast<unsigned int>(sample[2]) << 24));
+      }
+
+      static void Store(unsigned char* sample, int value)
+      {
+         sample[0] = static_cast<unsigned char>(value);
+         sample[1] = static_cast<unsigned char>(value >> 8);
+         sample[2] = static_cast<unsigned char>(value >> 16);
+      }
+   };
+
+   /// sample traits for 32 bit signed integer samples
+   template <> struct SampleTraits<Encoder::SampleTypeInt32>
+   {
+      static const bool isFloat = false;
+      static const int bitsPerSample = 32;
+      static const unsigned int sampleSize = 4;
+
+      static int Load(const unsigned char* sample)
+      {
+         int value;
+         memcpy(&value, sample, sizeof(value));
+         return value;
+      }
+
+      static void Store(unsigned char* sample, int value)
+      {
+         memcpy(sample, &value, sizeof(value));
+      }
+   };
+
+   /// sample traits for 32 bit float samples
+   template <> struct SampleTraits<Encoder::SampleTypeFloat32>
+   {
+      static const bool isFloat = true;
+      static const int bitsPerSample = 32;
+      static const unsigned int sampleSize = 4;
+
+      static float Load(const unsigned char* sample)
+      {
+         float value;
+         memcpy(&value, sample, sizeof(value));
+         return value;
+      }
+
+      static void Store(unsigned char* sample, float value)
+      {
+         memcpy(sample, &value, sizeof(value));
+      }
+   };
+
+   /// rounds a 32 bit aligned sample to nearest and shifts it down to the target bit depth
+   template <int TargetBits>
+   inline int RoundToBits(int value)
+   {
+      if constexpr (TargetBits == 32)
+      {
+         return value;
+      }
+      else
+      {
+         const int roundBit = 1 << (32 - TargetBits - 1);
+         const int maxValue = std::numeric_limits<int>::max() - roundBit + 1;
+
+         // don't round up samples that would overflow
+         if (value < maxValue)
+            value += roundBit;
+
+         return value >> (32 - TargetBits);
+      }
+   }
+
+   /// scales a float sample to the target bit depth, clips it and rounds to nearest
+   template <int TargetBits>
+   inline int FloatToBits(float value)
+   {
+      const float scale = static_cast<float>(1ULL << (TargetBits - 1));
+      const float maxValue = TargetBits == 32 ? c_floatToInt32Max : scale - 1.0f;
+
+      value *= scale;
+
+      // also catches NaN values
+      if (!(value >= -scale))
+         value = -scale;
+      else if (value > maxValue)
+         value = maxValue;
+
+      return static_cast<int>(std::lrintf(value));
+   }
+
+   /// converts a single sample
+   template <SampleType SourceType, SampleType TargetType>
+   inline void ConvertSample(const unsigned char* source, unsigned char* target)
+   {
+      using Source = SampleTraits<SourceType>;
+      using Target = SampleTraits<TargetType>;
+
+      if constexpr (Source::isFloat && Target::isFloat)
+         Target::Store(target, Source::Load(source));
+      else if constexpr (Source::isFloat)
+         Target::Store(target, FloatToBits<Target::bitsPerSample>(Source::Load(source)));
+      else if constexpr (Target::isFloat)
+         Target::Store(target, static_cast<float>(Source::Load(source)) * c_int32ToFloatScale);
+      else
+         Target::Store(target, RoundToBits<Target::bitsPerSample>(Source::Load(source)));
+   }
+
+   /// kernel function type that converts a contiguous range of samples
+   typedef void(*FlatKernel)(const unsigned char* source, unsigned char* target, size_t count);
+
+   /// \brief kernel function type that converts strided samples of all channels in one pass
+   /// \details the n'th sample of a channel is located at channelStart[channel] + n * step
+   typedef void(*StridedKernel)(
+      const unsigned char* const* source, size_t sourceStep,
+      unsigned char* const* target, size_t targetStep,
+      size_t numSamples, size_t numChannels);
+
+   /// kernel function type that splits interleaved samples into channels, without conversion
+   typedef void(*DeinterleaveKernel)(const unsigned char* source, unsigned char* const* target,
+      size_t numSamples, size_t numChannels);
+
+   /// kernel function type that merges channels into interleaved samples, without conversion
+   typedef void(*InterleaveKernel)(const unsigned char* const* source, unsigned char* target,
+      size_t numSamples, size_t numChannels);
+
+   /// converts a contiguous range of samples, scalar version
+   template <SampleType SourceType, SampleType TargetType>
+   void ConvertFlatScalar(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      const unsigned int sourceSize = SampleTraits<SourceType>::sampleSize;
+      const unsigned int targetSize = SampleTraits<TargetType>::sampleSize;
+
+      for (size_t index = 0; index < count; index++)
+         ConvertSample<SourceType, TargetType>(source + index * sourceSize, target + index * targetSize);
+   }
+
+   /// converts strided samples of all channels, frame by frame, scalar version
+   template <SampleType SourceType, SampleType TargetType>
+   void ConvertStridedScalar(
+      const unsigned char* const* source, size_t sourceStep,
+      unsigned char* const* target, size_t targetStep,
+      size_t numSamples, size_t numChannels)
+   {
+      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+      {
+         const size_t sourceOffset = sampleIndex * sourceStep;
+         const size_t targetOffset = sampleIndex * targetStep;
+
+         for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+         {
+            ConvertSample<SourceType, TargetType>(
+               source[channelIndex] + sourceOffset,
+               target[channelIndex] + targetOffset);
+         }
+      }
+   }
+
+   /// copies samples without conversion
+   template <unsigned int SampleSize>
+   void CopyFlat(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      memcpy(target, source, count * SampleSize);
+   }
+
+   /// splits interleaved samples into channels, without conversion, scalar version
+   template <unsigned int SampleSize>
+   void DeinterleaveScalar(const unsigned char* source, unsigned char* const* target,
+      size_t numSamples, size_t numChannels)
+   {
+      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+      {
+         for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+         {
+            memcpy(target[channelIndex] + sampleIndex * SampleSize, source, SampleSize);
+            source += SampleSize;
+         }
+      }
+   }
+
+   /// merges channels into interleaved samples, without conversion, scalar version
+   template <unsigned int SampleSize>
+   void InterleaveScalar(const unsigned char* const* source, unsigned char* target,
+      size_t numSamples, size_t numChannels)
+   {
+      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+      {
+         for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+         {
+            memcpy(target, source[channelIndex] + sampleIndex * SampleSize, SampleSize);
+            target += SampleSize;
+         }
+      }
+   }
+
+   /// returns a row of the scalar flat kernel table, for a given source type
+   template <SampleType SourceType>
+   constexpr std::array<FlatKernel, Encoder::SampleTypeMax> MakeFlatKernelRow()
+   {
+      return
+      {
+         &ConvertFlatScalar<SourceType, Encoder::SampleTypeInt8>,
+         &ConvertFlatScalar<SourceType, Encoder::SampleTypeInt16>,
+         &ConvertFlatScalar<SourceType, Encoder::SampleTypeInt24>,
+         &ConvertFlatScalar<SourceType, Encoder::SampleTypeInt32>,
+         &ConvertFlatScalar<SourceType, Encoder::SampleTypeFloat32>,
+      };
+   }
+
+   /// returns a row of the scalar strided kernel table, for a given source type
+   template <SampleType SourceType>
+   constexpr std::array<StridedKernel, Encoder::SampleTypeMax> MakeStridedKernelRow()
+   {
+      return
+      {
+         &ConvertStridedScalar<SourceType, Encoder::SampleTypeInt8>,
+         &ConvertStridedScalar<SourceType, Encoder::SampleTypeInt16>,
+         &ConvertStridedScalar<SourceType, Encoder::SampleTypeInt24>,
+         &ConvertStridedScalar<SourceType, Encoder::SampleTypeInt32>,
+         &ConvertStridedScalar<SourceType, Encoder::SampleTypeFloat32>,
+      };
+   }
+
+   /// scalar flat kernels; indexed by source type and target type
+   const std::array<std::array<FlatKernel, Encoder::SampleTypeMax>, Encoder::SampleTypeMax> c_flatKernelsScalar =
+   {
+      MakeFlatKernelRow<Encoder::SampleTypeInt8>(),
+      MakeFlatKernelRow<Encoder::SampleTypeInt16>(),
+      MakeFlatKernelRow<Encoder::SampleTypeInt24>(),
+      MakeFlatKernelRow<Encoder::SampleTypeInt32>(),
+      MakeFlatKernelRow<Encoder::SampleTypeFloat32>(),
+   };
+
+   /// scalar strided kernels; indexed by source type and target type
+   const std::array<std::array<StridedKernel, Encoder::SampleTypeMax>, Encoder::SampleTypeMax> c_stridedKernelsScalar =
+   {
+      MakeStridedKernelRow<Encoder::SampleTypeInt8>(),
+      MakeStridedKernelRow<Encoder::SampleTypeInt16>(),
+      MakeStridedKernelRow<Encoder::SampleTypeInt24>(),
+      MakeStridedKernelRow<Encoder::SampleTypeInt32>(),
+      MakeStridedKernelRow<Encoder::SampleTypeFloat32>(),
+   };
+
+   /// \brief kernel function type that converts channel samples stored in the lower bits
+   /// of 32 bit integers, frame by frame
+   /// \details the n'th sample of a target channel is located at target[channel] + n * targetStep
+   typedef void(*LowBitsKernel)(
+      const int* const* source, unsigned int shift,
+      unsigned char* const* target, size_t targetStep,
+      size_t numSamples, size_t numChannels);
+
+   /// \brief converts channel samples stored in the lower bits of 32 bit integers, scalar version
+   /// \details every sample is aligned to 32 bit and converted in the same step
+   template <SampleType TargetType>
+   void ConvertLowBitsScalar(
+      const int* const* source, unsigned int shift,
+      unsigned char* const* target, size_t targetStep,
+      size_t numSamples, size_t numChannels)
+   {
+      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+      {
+         const size_t targetOffset = sampleIndex * targetStep;
+
+         for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+         {
+            int value = static_cast<int>(static_cast<unsigned int>(source[channelIndex][sampleIndex]) << shift);
+
+            ConvertSample<Encoder::SampleTypeInt32, TargetType>(
+               reinterpret_cast<const unsigned char*>(&value),
+               target[channelIndex] + targetOffset);
+         }
+      }
+   }
+
+   /// low bits kernels; indexed by target type
+   const std::array<LowBitsKernel, Encoder::SampleTypeMax> c_lowBitsKernels =
+   {
+      &ConvertLowBitsScalar<Encoder::SampleTypeInt8>,
+      &ConvertLowBitsScalar<Encoder::SampleTypeInt16>,
+      &ConvertLowBitsScalar<Encoder::SampleTypeInt24>,
+      &ConvertLowBitsScalar<Encoder::SampleTypeInt32>,
+      &ConvertLowBitsScalar<Encoder::SampleTypeFloat32>,
+   };
+
+   // SSE2 kernels
+
+   /// converts 16 bit to 32 bit samples, SSE2 version
+   void ConvertInt16ToInt32SSE2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      const __m128i zero = _mm_setzero_si128();
+
+      size_t index = 0;
+      for (; index + 8 <= count; index += 8)
+      {
+         __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * 2));
+
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(target + index * 4), _mm_unpacklo_epi16(zero, samples));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(target + index * 4 + 16), _mm_unpackhi_epi16(zero, samples));
+      }
+
+      ConvertFlatScalar<Encoder::SampleTypeInt16, Encoder::SampleTypeInt32>(
+         source + index * 2, target + index * 4, count - index);
+   }
+
+   /// rounds 32 bit samples to nearest 16 bit value, still in 32 bit lanes; SSE2 version
+   inline __m128i RoundInt32ToInt16SSE2(__m128i samples)
+   {
+      const __m128i roundBit = _mm_set1_epi32(0x8000);
+      const __m128i maxValue = _mm_set1_epi32(0x7fff8000);
+
+      __m128i round = _mm_and_si128(_mm_cmplt_epi32(samples, maxValue), roundBit);
+      return _mm_srai_epi32(_mm_add_epi32(samples, round), 16);
+   }
+
+   /// converts 32 bit to 16 bit samples, SSE2 version
+   void ConvertInt32ToInt16SSE2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      size_t index = 0;
+      for (; index + 8 <= count; index += 8)
+      {
+         __m128i samples1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * 4));
+         __m128i samples2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * 4 + 16));
+
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(target + index * 2),
+            _mm_packs_epi32(RoundInt32ToInt16SSE2(samples1), RoundInt32ToInt16SSE2(samples2)));
+      }
+
+      ConvertFlatScalar<Encoder::SampleTypeInt32, Encoder::SampleTypeInt16>(
+         source + index * 4, target + index * 2, count - index);
+   }
+
+   /// converts 16 bit samples to float, SSE2 version
+   void ConvertInt16ToFloatSSE2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      const __m128i zero = _mm_setzero_si128();
+      const __m128 scale = _mm_set1_ps(c_int32ToFloatScale);
+
+      size_t index = 0;
+      for (; index + 8 <= count; index += 8)
+      {
+         __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * 2));
+
+         _mm_storeu_ps(reinterpret_cast<float*>(target + index * 4),
+            _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(zero, samples)), scale));
+         _mm_storeu_ps(reinterpret_cast<float*>(target + index * 4 + 16),
+            _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(zero, samples)), scale));
+      }
+
+      ConvertFlatScalar<Encoder::SampleTypeInt16, Encoder::SampleTypeFloat32>(
+         source + index * 2, target + index * 4, count - index);
+   }
+
+   /// converts 32 bit samples to float, SSE2 version
+   void ConvertInt32ToFloatSSE2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      const __m128 scale = _mm_set1_ps(c_int32ToFloatScale);
+
+      size_t index = 0;
+      for (; index + 4 <= count; index += 4)
+      {
+         __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * 4));
+
+         _mm_storeu_ps(reinterpret_cast<float*>(target + index * 4),
+            _mm_mul_ps(_mm_cvtepi32_ps(samples), scale));
+      }
+
+      ConvertFlatScalar<Encoder::SampleTypeInt32, Encoder::SampleTypeFloat32>(
+         source + index * 4, target + index * 4, count - index);
+   }
+
+   /// scales and clips float samples and converts them to 32 bit lanes, SSE2 version
+   inline __m128i ScaleFloatSSE2(__m128 samples, __m128 scale, __m128 minValue, __m128 maxValue)
+   {
+      // note: _mm_max_ps() returns the second operand for NaN values
+      samples = _mm_max_ps(_mm_mul_ps(samples, scale), minValue);
+      return _mm_cvtps_epi32(_mm_min_ps(samples, maxValue));
+   }
+
+   /// converts float samples to 16 bit, SSE2 version
+   void ConvertFloatToInt16SSE2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      const __m128 scale = _mm_set1_ps(32768.0f);
+      const __m128 minValue = _mm_set1_ps(-32768.0f);
+      const __m128 maxValue = _mm_set1_ps(32767.0f);
+
+      size_t index = 0;
+      for (; index + 8 <= count; index += 8)
+      {
+         __m128 samples1 = _mm_loadu_ps(reinterpret_cast<const float*>(source + index * 4));
+         __m128 samples2 = _mm_loadu_ps(reinterpret_cast<const float*>(source + index * 4 + 16));
+
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(target + index * 2),
+            _mm_packs_epi32(
+               ScaleFloatSSE2(samples1, scale, minValue, maxValue),
+               ScaleFloatSSE2(samples2, scale, minValue, maxValue)));
+      }
+
+      ConvertFlatScalar<Encoder::SampleTypeFloat32, Encoder::SampleTypeInt16>(
+         source + index * 4, target + index * 2, count - index);
+   }
+
+   /// converts float samples to 32 bit, SSE2 version
+   void ConvertFloatToInt32SSE2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      const __m128 scale = _mm_set1_ps(2147483648.0f);
+      const __m128 minValue = _mm_set1_ps(-2147483648.0f);
+      const __m128 maxValue = _mm_set1_ps(c_floatToInt32Max);
+
+      size_t index = 0;
+      for (; index + 4 <= count; index += 4)
+      {
+         __m128 samples = _mm_loadu_ps(reinterpret_cast<const float*>(source + index * 4));
+
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(target + index * 4),
+            ScaleFloatSSE2(samples, scale, minValue, maxValue));
+      }
+
+      ConvertFlatScalar<Encoder::SampleTypeFloat32, Encoder::SampleTypeInt32>(
+         source + index * 4, target + index * 4, count - index);
+   }
+
+   /// splits interleaved 16 bit stereo samples into two channels, SSE2 version
+   void DeinterleaveStereoInt16SSE2(const unsigned char* source, unsigned char* const* target,
+      size_t numSamples, size_t numChannels)
+   {
+      unsigned char* left = target[0];
+      unsigned char* right = target[1];
+
+      size_t index = 0;
+      for (; index + 8 <= numSamples; index += 8)
+      {
+         // each 32 bit lane contains one sample frame: left in the low, right in the high word
+         __m128i frames1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * 4));
+         __m128i frames2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * 4 + 16));
+
+         __m128i left1 = _mm_srai_epi32(_mm_slli_epi32(frames1, 16), 16);
+         __m128i left2 = _mm_srai_epi32(_mm_slli_epi32(frames2, 16), 16);
+
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(left + index * 2), _mm_packs_epi32(left1, left2));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(right + index * 2),
+            _mm_packs_epi32(_mm_srai_epi32(frames1, 16), _mm_srai_epi32(frames2, 16)));
+      }
+
+      unsigned char* const targetChannels[2] = { left + index * 2, right + index * 2 };
+
+      DeinterleaveScalar<2>(source + index * 4, targetChannels, numSamples - index, numChannels);
+   }
+
+   /// merges two channels of 16 bit samples into interleaved stereo samples, SSE2 version
+   void InterleaveStereoInt16SSE2(const unsigned char* const* source, unsigned char* target,
+      size_t numSamples, size_t numChannels)
+   {
+      const unsigned char* left = source[0];
+      const unsigned char* right = source[1];
+
+      size_t index = 0;
+      for (; index + 8 <= numSamples; index += 8)
+      {
+         __m128i leftSamples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + index * 2));
+         __m128i rightSamples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + index * 2));
+
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(target + index * 4), _mm_unpacklo_epi16(leftSamples, rightSamples));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(target + index * 4 + 16), _mm_unpackhi_epi16(leftSamples, rightSamples));
+      }
+
+      const unsigned char* const sourceChannels[2] = { left + index * 2, right + index * 2 };
+
+      InterleaveScalar<2>(sourceChannels, target + index * 4, numSamples - index, numChannels);
+   }
+
+   /// splits interleaved 32 bit or float stereo samples into two channels, SSE2 version
+   void DeinterleaveStereoInt32SSE2(const unsigned char* source, unsigned char* const* target,
+      size_t numSamples, size_t numChannels)
+   {
+      unsigned char* left = target[0];
+      unsigned char* right = target[1];
+
+      size_t index = 0;
+      for (; index + 4 <= numSamples; index += 4)
+      {
+         // the samples are only moved, so float shuffles can be used for integer samples, too
+         __m128 frames1 = _mm_loadu_ps(reinterpret_cast<const float*>(source + index * 8));
+         __m128 frames2 = _mm_loadu_ps(reinterpret_cast<const float*>(source + index * 8 + 16));
+
+         _mm_storeu_ps(reinterpret_cast<float*>(left + index * 4), _mm_shuffle_ps(frames1, frames2, _MM_SHUFFLE(2, 0, 2, 0)));
+         _mm_storeu_ps(reinterpret_cast<float*>(right + index * 4), _mm_shuffle_ps(frames1, frames2, _MM_SHUFFLE(3, 1, 3, 1)));
+      }
+
+      unsigned char* const targetChannels[2] = { left + index * 4, right + index * 4 };
+
+      DeinterleaveScalar<4>(source + index * 8, targetChannels, numSamples - index, numChannels);
+   }
+
+   /// merges two channels of 32 bit or float samples into interleaved stereo samples, SSE2 version
+   void InterleaveStereoInt32SSE2(const unsigned char* const* source, unsigned char* target,
+      size_t numSamples, size_t numChannels)
+   {
+      const unsigned char* left = source[0];
+      const unsigned char* right = source[1];
+
+      size_t index = 0;
+      for (; index + 4 <= numSamples; index += 4)
+      {
+         __m128 leftSamples = _mm_loadu_ps(reinterpret_cast<const float*>(left + index * 4));
+         __m128 rightSamples = _mm_loadu_ps(reinterpret_cast<const float*>(right + index * 4));
+
+         _mm_storeu_ps(reinterpret_cast<float*>(target + index * 8), _mm_unpacklo_ps(leftSamples, rightSamples));
+         _mm_storeu_ps(reinterpret_cast<float*>(target + index * 8 + 16), _mm_unpackhi_ps(leftSamples, rightSamples));
+      }
+
+      const unsigned char* const sourceChannels[2] = { left + index * 4, right + index * 4 };
+
+      InterleaveScalar<4>(sourceChannels, target + index * 8, numSamples - index, numChannels);
+   }
+
+   // generic SSE kernels, for all other sample type combinations
+
+   /// \brief loads 4 integer samples and aligns them to 32 bit lanes; SSE2 version
+   /// \details 24 bit samples are shuffled using SSSE3, and 16 bytes are read
+   template <SampleType SourceType>
+   inline __m128i LoadAlignedSSE(const unsigned char* source)
+   {
+      const __m128i zero = _mm_setzero_si128();
+
+      if constexpr (SourceType == Encoder::SampleTypeInt8)
+      {
+         int samples;
+         memcpy(&samples, source, sizeof(samples));
+         return _mm_unpacklo_epi16(zero, _mm_unpacklo_epi8(zero, _mm_cvtsi32_si128(samples)));
+      }
+      else if constexpr (SourceType == Encoder::SampleTypeInt16)
+      {
+         return _mm_unpacklo_epi16(zero, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source)));
+      }
+      else if constexpr (SourceType == Encoder::SampleTypeInt24)
+      {
+         const __m128i shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+         return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source)), shuffle);
+      }
+      else
+      {
+         return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+      }
+   }
+
+   /// \brief stores 4 integer samples that were already shifted down to the target bit depth; SSE2 version
+   /// \details 24 bit samples are shuffled using SSSE3
+   template <SampleType TargetType>
+   inline void StoreShiftedSSE(unsigned char* target, __m128i samples)
+   {
+      if constexpr (TargetType == Encoder::SampleTypeInt8)
+      {
+         __m128i packed = _mm_packs_epi32(samples, samples);
+         int value = _mm_cvtsi128_si32(_mm_packs_epi16(packed, packed));
+         memcpy(target, &value, sizeof(value));
+      }
+      else if constexpr (TargetType == Encoder::SampleTypeInt16)
+      {
+         _mm_storel_epi64(reinterpret_cast<__m128i*>(target), _mm_packs_epi32(samples, samples));
+      }
+      else if constexpr (TargetType == Encoder::SampleTypeInt24)
+      {
+         const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+         __m128i packed = _mm_shuffle_epi8(samples, shuffle);
+
+         _mm_storel_epi64(reinterpret_cast<__m128i*>(target), packed);
+         int value = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+         memcpy(target + 8, &value, sizeof(value));
+      }
+      else
+      {
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(target), samples);
+      }
+   }
+
+   /// rounds 32 bit aligned samples to nearest and shifts them down to the target bit depth; SSE2 version
+   template <int TargetBits>
+   inline __m128i RoundToBitsSSE2(__m128i samples)
+   {
+      if constexpr (TargetBits == 32)
+      {
+         return samples;
+      }
+      else
+      {
+         const int roundBit = 1 << (32 - TargetBits - 1);
+
+         const __m128i roundBits = _mm_set1_epi32(roundBit);
+         const __m128i maxValue = _mm_set1_epi32(std::numeric_limits<int>::max() - roundBit + 1);
+
+         __m128i round = _mm_and_si128(_mm_cmplt_epi32(samples, maxValue), roundBits);
+         return _mm_srai_epi32(_mm_add_epi32(samples, round), 32 - TargetBits);
+      }
+   }
+
+   /// converts a contiguous range of samples, 4 samples at a time; generic SSE version
+   template <SampleType SourceType, SampleType TargetType>
+   void ConvertFlatSSE(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      using Source = SampleTraits<SourceType>;
+      using Target = SampleTraits<TargetType>;
+
+      // loading 4 packed 24 bit samples reads 16 bytes, so 2 more samples must be available
+      const size_t readAhead = SourceType == Encoder::SampleTypeInt24 ? 2 : 0;
+
+      const float floatScale = static_cast<float>(1ULL << (Target::bitsPerSample - 1));
+      const __m128 scale = _mm_set1_ps(Source::isFloat ? floatScale : c_int32ToFloatScale);
+      const __m128 minValue = _mm_set1_ps(-floatScale);
+      const __m128 maxValue = _mm_set1_ps(Target::bitsPerSample == 32 ? c_floatToInt32Max : floatScale - 1.0f);
+
+      size_t index = 0;
+      for (; index + 4 + readAhead <= count; index += 4)
+      {
+         const unsigned char* sourceSamples = source + index * Source::sampleSize;
+         unsigned char* targetSamples = target + index * Target::sampleSize;
+
+         if constexpr (Source::isFloat)
+         {
+            __m128 samples = _mm_loadu_ps(reinterpret_cast<const float*>(sourceSamples));
+            StoreShiftedSSE<TargetType>(targetSamples, ScaleFloatSSE2(samples, scale, minValue, maxValue));
+         }
+         else if constexpr (Target::isFloat)
+         {
+            _mm_storeu_ps(reinterpret_cast<float*>(targetSamples),
+               _mm_mul_ps(_mm_cvtepi32_ps(LoadAlignedSSE<SourceType>(sourceSamples)), scale));
+         }
+         else
+         {
+            StoreShiftedSSE<TargetType>(targetSamples,
+               RoundToBitsSSE2<Target::bitsPerSample>(LoadAlignedSSE<SourceType>(sourceSamples)));
+         }
+      }
+
+      ConvertFlatScalar<SourceType, TargetType>(
+         source + index * Source::sampleSize, target + index * Target::sampleSize, count - index);
+   }
+
+   /// returns generic SSE flat kernel for a given source and target type
+   template <SampleType SourceType, SampleType TargetType>
+   constexpr FlatKernel MakeFlatKernelSSE()
+   {
+      if constexpr (SourceType == TargetType)
+         return &CopyFlat<SampleTraits<SourceType>::sampleSize>;
+      else
+         return &ConvertFlatSSE<SourceType, TargetType>;
+   }
+
+   /// returns a row of the generic SSE flat kernel table, for a given source type
+   template <SampleType SourceType>
+   constexpr std::array<FlatKernel, Encoder::SampleTypeMax> MakeFlatKernelRowSSE()
+   {
+      return
+      {
+         MakeFlatKernelSSE<SourceType, Encoder::SampleTypeInt8>(),
+         MakeFlatKernelSSE<SourceType, Encoder::SampleTypeInt16>(),
+         MakeFlatKernelSSE<SourceType, Encoder::SampleTypeInt24>(),
+         MakeFlatKernelSSE<SourceType, Encoder::SampleTypeInt32>(),
+         MakeFlatKernelSSE<SourceType, Encoder::SampleTypeFloat32>(),
+      };
+   }
+
+   /// generic SSE flat kernels; indexed by source type and target type
+   const std::array<std::array<FlatKernel, Encoder::SampleTypeMax>, Encoder::SampleTypeMax> c_flatKernelsSSE =
+   {
+      MakeFlatKernelRowSSE<Encoder::SampleTypeInt8>(),
+      MakeFlatKernelRowSSE<Encoder::SampleTypeInt16>(),
+      MakeFlatKernelRowSSE<Encoder::SampleTypeInt24>(),
+      MakeFlatKernelRowSSE<Encoder::SampleTypeInt32>(),
+      MakeFlatKernelRowSSE<Encoder::SampleTypeFloat32>(),
+   };
+
+   // AVX2 kernels
+
+   /// converts 16 bit to 32 bit samples, AVX2 version
+   void ConvertInt16ToInt32AVX2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      size_t index = 0;
+      for (; index + 8 <= count; index += 8)
+      {
+         __m256i samples = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * 2)));
+
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + index * 4), _mm256_slli_epi32(samples, 16));
+      }
+
+      _mm256_zeroupper();
+
+      ConvertFlatScalar<Encoder::SampleTypeInt16, Encoder::SampleTypeInt32>(
+         source + index * 2, target + index * 4, count - index);
+   }
+
+   /// rounds 32 bit samples to nearest 16 bit value, still in 32 bit lanes; AVX2 version
+   inline __m256i RoundInt32ToInt16AVX2(__m256i samples)
+   {
+      const __m256i roundBit = _mm256_set1_epi32(0x8000);
+      const __m256i maxValue = _mm256_set1_epi32(0x7fff8000);
+
+      __m256i round = _mm256_and_si256(_mm256_cmpgt_epi32(maxValue, samples), roundBit);
+      return _mm256_srai_epi32(_mm256_add_epi32(samples, round), 16);
+   }
+
+   /// converts 32 bit to 16 bit samples, AVX2 version
+   void ConvertInt32ToInt16AVX2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      size_t index = 0;
+      for (; index + 16 <= count; index += 16)
+      {
+         __m256i samples1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + index * 4));
+         __m256i samples2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + index * 4 + 32));
+
+         // packing works per 128 bit lane, so the 64 bit blocks have to be reordered
+         __m256i packed = _mm256_packs_epi32(RoundInt32ToInt16AVX2(samples1), RoundInt32ToInt16AVX2(samples2));
+
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + index * 2), _mm256_permute4x64_epi64(packed, 0xd8));
+      }
+
+      _mm256_zeroupper();
+
+      ConvertFlatScalar<Encoder::SampleTypeInt32, Encoder::SampleTypeInt16>(
+         source + index * 4, target + index * 2, count - index);
+   }
+
+   /// converts 16 bit samples to float, AVX2 version
+   void ConvertInt16ToFloatAVX2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      const __m256 scale = _mm256_set1_ps(c_int32ToFloatScale);
+
+      size_t index = 0;
+      for (; index + 8 <= count; index += 8)
+      {
+         __m256i samples = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * 2)));
+
+         _mm256_storeu_ps(reinterpret_cast<float*>(target + index * 4),
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_slli_epi32(samples, 16)), scale));
+      }
+
+      _mm256_zeroupper();
+
+      ConvertFlatScalar<Encoder::SampleTypeInt16, Encoder::SampleTypeFloat32>(
+         source + index * 2, target + index * 4, count - index);
+   }
+
+   /// converts 32 bit samples to float, AVX2 version
+   void ConvertInt32ToFloatAVX2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      const __m256 scale = _mm256_set1_ps(c_int32ToFloatScale);
+
+      size_t index = 0;
+      for (; index + 8 <= count; index += 8)
+      {
+         __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + index * 4));
+
+         _mm256_storeu_ps(reinterpret_cast<float*>(target + index * 4),
+            _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+      }
+
+      _mm256_zeroupper();
+
+      ConvertFlatScalar<Encoder::SampleTypeInt32, Encoder::SampleTypeFloat32>(
+         source + index * 4, target + index * 4, count - index);
+   }
+
+   /// scales and clips float samples and converts them to 32 bit lanes, AVX2 version
+   inline __m256i ScaleFloatAVX2(__m256 samples, __m256 scale, __m256 minValue, __m256 maxValue)
+   {
+      // note: _mm256_max_ps() returns the second operand for NaN values
+      samples = _mm256_max_ps(_mm256_mul_ps(samples, scale), minValue);
+      return _mm256_cvtps_epi32(_mm256_min_ps(samples, maxValue));
+   }
+
+   /// converts float samples to 16 bit, AVX2 version
+   void ConvertFloatToInt16AVX2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      const __m256 scale = _mm256_set1_ps(32768.0f);
+      const __m256 minValue = _mm256_set1_ps(-32768.0f);
+      const __m256 maxValue = _mm256_set1_ps(32767.0f);
+
+      size_t index = 0;
+      for (; index + 16 <= count; index += 16)
+      {
+         __m256 samples1 = _mm256_loadu_ps(reinterpret_cast<const float*>(source + index * 4));
+         __m256 samples2 = _mm256_loadu_ps(reinterpret_cast<const float*>(source + index * 4 + 32));
+
+         __m256i packed = _mm256_packs_epi32(
+            ScaleFloatAVX2(samples1, scale, minValue, maxValue),
+            ScaleFloatAVX2(samples2, scale, minValue, maxValue));
+
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + index * 2), _mm256_permute4x64_epi64(packed, 0xd8));
+      }
+
+      _mm256_zeroupper();
+
+      ConvertFlatScalar<Encoder::SampleTypeFloat32, Encoder::SampleTypeInt16>(
+         source + index * 4, target + index * 2, count - index);
+   }
+
+   /// converts float samples to 32 bit, AVX2 version
+   void ConvertFloatToInt32AVX2(const unsigned char* source, unsigned char* target, size_t count)
+   {
+      const __m256 scale = _mm256_set1_ps(2147483648.0f);
+      const __m256 minValue = _mm256_set1_ps(-2147483648.0f);
+      const __m256 maxValue = _mm256_set1_ps(c_floatToInt32Max);
+
+      size_t index = 0;
+      for (; index + 8 <= count; index += 8)
+      {
+         __m256 samples = _mm256_loadu_ps(reinterpret_cast<const float*>(source + index * 4));
+
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + index * 4),
+            ScaleFloatAVX2(samples, scale, minValue, maxValue));
+      }
+
+      _mm256_zeroupper();
+
+      ConvertFlatScalar<Encoder::SampleTypeFloat32, Encoder::SampleTypeInt32>(
+         source + index * 4, target + index * 4, count - index);
+   }
+
+   /// detects the best instruction set supported by the CPU and the OS
+   SampleConverterInstructionSet DetectInstructionSet()
+   {
+      int cpuInfo[4] = {};
+      __cpuid(cpuInfo, 0);
+
+      const int maxFunctionId = cpuInfo[0];
+      if (maxFunctionId < 1)
+         return Encoder::instructionSetScalar;
+
+      __cpuid(cpuInfo, 1);
+
+      const bool hasSSE2 = (cpuInfo[3] & (1 << 26)) != 0;
+      const bool hasOSXSAVE = (cpuInfo[2] & (1 << 27)) != 0;
+      const bool hasAVX = (cpuInfo[2] & (1 << 28)) != 0;
+
+      bool hasAVX2 = false;
+
+      // the OS must also save the YMM registers on context switches
+      if (maxFunctionId >= 7 && hasOSXSAVE && hasAVX &&
+         (_xgetbv(0) & 6) == 6)
+      {
+         __cpuidex(cpuInfo, 7, 0);
+         hasAVX2 = (cpuInfo[1] & (1 << 5)) != 0;
+      }
+
+      if (hasAVX2)
+         return Encoder::instructionSetAVX2;
+
+      return hasSSE2 ? Encoder::instructionSetSSE2 : Encoder::instructionSetScalar;
+   }
+
+   /// returns the instruction set currently in use
+   std::atomic<SampleConverterInstructionSet>& CurrentInstructionSet()
+   {
+      static std::atomic<SampleConverterInstructionSet> s_instructionSet{ SampleConverter::GetSupportedInstructionSet() };
+      return s_instructionSet;
+   }
+
+   /// returns the flat kernel to use for a given source and target type
+   FlatKernel GetFlatKernel(SampleType sourceType, SampleType targetType)
+   {
+      if (sourceType == targetType)
+      {
+         switch (SampleConverter::GetSampleSize(sourceType))
+         {
+         case 1: return &CopyFlat<1>;
+         case 2: return &CopyFlat<2>;
+         case 3: return &CopyFlat<3>;
+         default: return &CopyFlat<4>;
+         }
+      }
+
+      const SampleConverterInstructionSet instructionSet = CurrentInstructionSet();
+
+      if (instructionSet >= Encoder::instructionSetSSE2)
+      {
+         const bool useAVX2 = instructionSet >= Encoder::instructionSetAVX2;
+
+         switch (sourceType * Encoder::SampleTypeMax + targetType)
+         {
+         case Encoder::SampleTypeInt16 * Encoder::SampleTypeMax + Encoder::SampleTypeInt32:
+            return useAVX2 ? &ConvertInt16ToInt32AVX2 : &ConvertInt16ToInt32SSE2;
+         case Encoder::SampleTypeInt32 * Encoder::SampleTypeMax + Encoder::SampleTypeInt16:
+            return useAVX2 ? &ConvertInt32ToInt16AVX2 : &ConvertInt32ToInt16SSE2;
+         case Encoder::SampleTypeInt16 * Encoder::SampleTypeMax + Encoder::SampleTypeFloat32:
+            return useAVX2 ? &ConvertInt16ToFloatAVX2 : &ConvertInt16ToFloatSSE2;
+         case Encoder::SampleTypeInt32 * Encoder::SampleTypeMax + Encoder::SampleTypeFloat32:
+            return useAVX2 ? &ConvertInt32ToFloatAVX2 : &ConvertInt32ToFloatSSE2;
+         case Encoder::SampleTypeFloat32 * Encoder::SampleTypeMax + Encoder::SampleTypeInt16:
+            return useAVX2 ? &ConvertFloatToInt16AVX2 : &ConvertFloatToInt16SSE2;
+         case Encoder::SampleTypeFloat32 * Encoder::SampleTypeMax + Encoder::SampleTypeInt32:
+            return useAVX2 ? &ConvertFloatToInt32AVX2 : &ConvertFloatToInt32SSE2;
+         default:
+            break;
+         }
+
+         // 24 bit samples are shuffled using SSSE3, which all AVX2 capable CPUs support
+         const bool needsSSSE3 =
+            sourceType == Encoder::SampleTypeInt24 ||
+            targetType == Encoder::SampleTypeInt24;
+
+         if (useAVX2 || !needsSSSE3)
+            return c_flatKernelsSSE[sourceType][targetType];
+      }
+
+      return c_flatKernelsScalar[sourceType][targetType];
+   }
+
+   /// returns the kernel to split interleaved samples of given size into channels
+   DeinterleaveKernel GetDeinterleaveKernel(unsigned int sampleSize, size_t numChannels)
+   {
+      if (numChannels == 2 &&
+         CurrentInstructionSet() >= Encoder::instructionSetSSE2)
+      {
+         if (sampleSize == 2)
+            return &DeinterleaveStereoInt16SSE2;
+
+         if (sampleSize == 4)
+            return &DeinterleaveStereoInt32SSE2;
+      }
+
+      switch (sampleSize)
+      {
+      case 1: return &DeinterleaveScalar<1>;
+      case 2: return &DeinterleaveScalar<2>;
+      case 3: return &DeinterleaveScalar<3>;
+      default: return &DeinterleaveScalar<4>;
+      }
+   }
+
+   /// returns the kernel to merge channels of given sample size into interleaved samples
+   InterleaveKernel GetInterleaveKernel(unsigned int sampleSize, size_t numChannels)
+   {
+      if (numChannels == 2 &&
+         CurrentInstructionSet() >= Encoder::instructionSetSSE2)
+      {
+         if (sampleSize == 2)
+            return &InterleaveStereoInt16SSE2;
+
+         if (sampleSize == 4)
+            return &InterleaveStereoInt32SSE2;
+      }
+
+      switch (sampleSize)
+      {
+      case 1: return &InterleaveScalar<1>;
+      case 2: return &InterleaveScalar<2>;
+      case 3: return &InterleaveScalar<3>;
+      default: return &InterleaveScalar<4>;
+      }
+   }
+
+   /// returns if the flat kernel for given source and target type is vectorized
+   bool IsVectorizedFlatKernel(FlatKernel kernel, SampleType sourceType, SampleType targetType)
+   {
+      return kernel != c_flatKernelsScalar[sourceType][targetType];
+   }
+
+   /// list of channel start pointers; only allocates memory for large channel counts
+   template <typename T>
+   class ChannelPointerList
+   {
+   public:
+      /// ctor
+      explicit ChannelPointerList(size_t numChannels)
+         :m_heapPointers(numChannels > c_maxStackChannels ? numChannels : 0)
+      {
+      }
+
+      /// returns pointer list
+      T* Data()
+      {
+         return m_heapPointers.empty() ? m_stackPointers : m_heapPointers.data();
+      }
+
+   private:
+      /// pointers for common channel counts
+      T m_stackPointers[c_maxStackChannels] = {};
+
+      /// pointers for large channel counts
+      std::vector<T> m_heapPointers;
+   };
+
+} // unnamed namespace
+
+SampleType SampleConverter::SampleTypeFromBitsPerSample(int bitsPerSample)
+{
+   if (bitsPerSample <= 8)
+      return SampleTypeInt8;
+
+   if (bitsPerSample <= 16)
+      return SampleTypeInt16;
+
+   if (bitsPerSample <= 24)
+      return SampleTypeInt24;
+
+   return SampleTypeInt32;
+}
+
+unsigned int SampleConverter::GetSampleSize(SampleType sampleType)
+{
+   switch (sampleType)
+   {
+   case SampleTypeInt8: return 1;
+   case SampleTypeInt16: return 2;
+   case SampleTypeInt24: return 3;
+   case SampleTypeInt32: return 4;
+   case SampleTypeFloat32: return 4;
+   default:
+      ATLASSERT(false);
+      return 0;
+   }
+}
+
+SampleConverterInstructionSet SampleConverter::GetSupportedInstructionSet()
+{
+   static const SampleConverterInstructionSet s_supportedInstructionSet = DetectInstructionSet();
+   return s_supportedInstructionSet;
+}
+
+SampleConverterInstructionSet SampleConverter::GetInstructionSet()
+{
+   return CurrentInstructionSet();
+}
+
+void SampleConverter::SetInstructionSet(SampleConverterInstructionSet instructionSet)
+{
+   CurrentInstructionSet() = std::min(instructionSet, GetSupportedInstructionSet());
+}
+
+void SampleConverter::InterleavedToInterleaved(
+   const void* source, SampleType sourceType,
+   void* target, SampleType targetType,
+   size_t numSamples, size_t numChannels)
+{
+   // with the same number of channels, all samples can be converted in one go
+   GetFlatKernel(sourceType, targetType)(
+      static_cast<const unsigned char*>(source),
+      static_cast<unsigned char*>(target),
+      numSamples * numChannels);
+}
+
+void SampleConverter::InterleavedToArray(
+   const void* source, SampleType sourceType,
+   void** target, SampleType targetType,
+   size_t numSamples, size_t numChannels)
+{
+   const unsigned char* sourceBuffer = static_cast<const unsigned char*>(source);
+
+   if (numChannels == 1)
+   {
+      GetFlatKernel(sourceType, targetType)(sourceBuffer, static_cast<unsigned char*>(target[0]), numSamples);
+      return;
+   }
+
+   const unsigned int sourceSize = GetSampleSize(sourceType);
+   const unsigned int targetSize = GetSampleSize(targetType);
+
+   if (sourceType == targetType)
+   {
+      GetDeinterleaveKernel(sourceSize, numChannels)(sourceBuffer,
+         reinterpret_cast<unsigned char* const*>(target),
+         numSamples, numChannels);
+      return;
+   }
+
+   FlatKernel kernel = GetFlatKernel(sourceType, targetType);
+
+   if (numChannels <= c_maxStackChannels &&
+      IsVectorizedFlatKernel(kernel, sourceType, targetType))
+   {
+      // convert blocks of interleaved samples with the vectorized kernel, then split them into channels
+      DeinterleaveKernel deinterleave = GetDeinterleaveKernel(targetSize, numChannels);
+
+      alignas(32) unsigned char blockBuffer[c_blockBufferSize];
+      const size_t maxBlockSamples = c_blockBufferSize / (targetSize * numChannels);
+
+      unsigned char* blockTarget[c_maxStackChannels];
+
+      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex += maxBlockSamples)
+      {
+         const size_t numBlockSamples = std::min(maxBlockSamples, numSamples - sampleIndex);
+
+         kernel(sourceBuffer + sampleIndex * numChannels * sourceSize, blockBuffer, numBlockSamples * numChannels);
+
+         for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+            blockTarget[channelIndex] = static_cast<unsigned char*>(target[channelIndex]) + sampleIndex * targetSize;
+
+         deinterleave(blockBuffer, blockTarget, numBlockSamples, numChannels);
+      }
+
+      return;
+   }
+
+   ChannelPointerList<const unsigned char*> sourceChannels(numChannels);
+   for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+      sourceChannels.Data()[channelIndex] = sourceBuffer + channelIndex * sourceSize;
+
+   c_stridedKernelsScalar[sourceType][targetType](
+      sourceChannels.Data(), sourceSize * numChannels,
+      reinterpret_cast<unsigned char* const*>(target), targetSize,
+      numSamples, numChannels);
+}
+
+void SampleConverter::ArrayToInterleaved(
+   const void* const* source, SampleType sourceType,
+   void* target, SampleType targetType,
+   size_t numSamples, size_t numChannels)
+{
+   unsigned char* targetBuffer = static_cast<unsigned char*>(target);
+
+   if (numChannels == 1)
+   {
+      GetFlatKernel(sourceType, targetType)(static_cast<const unsigned char*>(source[0]), targetBuffer, numSamples);
+      return;
+   }
+
+   const unsigned int sourceSize = GetSampleSize(sourceType);
+   const unsigned int targetSize = GetSampleSize(targetType);
+
+   if (sourceType == targetType)
+   {
+      GetInterleaveKernel(sourceSize, numChannels)(
+         reinterpret_cast<const unsigned char* const*>(source),
+         targetBuffer, numSamples, numChannels);
+      return;
+   }
+
+   FlatKernel kernel = GetFlatKernel(sourceType, targetType);
+
+   if (numChannels <= c_maxStackChannels &&
+      IsVectorizedFlatKernel(kernel, sourceType, targetType))
+   {
+      // merge blocks of channel samples, then convert them with the vectorized kernel
+      InterleaveKernel interleave = GetInterleaveKernel(sourceSize, numChannels);
+
+      alignas(32) unsigned char blockBuffer[c_blockBufferSize];
+      const size_t maxBlockSamples = c_blockBufferSize / (sourceSize * numChannels);
+
+      const unsigned char* blockSource[c_maxStackChannels];
+
+      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex += maxBlockSamples)
+      {
+         const size_t numBlockSamples = std::min(maxBlockSamples, numSamples - sampleIndex);
+
+         for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+            blockSource[channelIndex] = static_cast<const unsigned char*>(source[channelIndex]) + sampleIndex * sourceSize;
+
+         interleave(blockSource, blockBuffer, numBlockSamples, numChannels);
+
+         kernel(blockBuffer, targetBuffer + sampleIndex * numChannels * targetSize, numBlockSamples * numChannels);
+      }
+
+      return;
+   }
+
+   ChannelPointerList<unsigned char*> targetChannels(numChannels);
+   for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+      targetChannels.Data()[channelIndex] = targetBuffer + channelIndex * targetSize;
+
+   c_stridedKernelsScalar[sourceType][targetType](
+      reinterpret_cast<const unsigned char* const*>(source), sourceSize,
+      targetChannels.Data(), targetSize * numChannels,
+      numSamples, numChannels);
+}
+
+void SampleConverter::ArrayToArray(
+   const void* const* source, SampleType sourceType,
+   void** target, SampleType targetType,
+   size_t numSamples, size_t numChannels)
+{
+   FlatKernel kernel = GetFlatKernel(sourceType, targetType);
+
+   for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+   {
+      kernel(
+         static_cast<const unsigned char*>(source[channelIndex]),
+         static_cast<unsigned char*>(target[channelIndex]),
+         numSamples);
+   }
+}
+
+void SampleConverter::LowBitsArrayToInterleaved(
+   const int* const* source, unsigned int sourceBits,
+   void* target, SampleType targetType,
+   size_t numSamples, size_t numChannels)
+{
+   ATLASSERT(sourceBits > 0 && sourceBits <= 32);
+
+   const unsigned int targetSize = GetSampleSize(targetType);
+   unsigned char* targetBuffer = static_cast<unsigned char*>(target);
+
+   ChannelPointerList<unsigned char*> targetChannels(numChannels);
+   for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+      targetChannels.Data()[channelIndex] = targetBuffer + channelIndex * targetSize;
+
+   c_lowBitsKernels[targetType](
+      source, 32 - sourceBits,
+      targetChannels.Data(), targetSize * numChannels,
+      numSamples, numChannels);
+}
+
+void SampleConverter::LowBitsArrayToArray(
+   const int* const* source, unsigned int sourceBits,
+   void** target, SampleType targetType,
+   size_t numSamples, size_t numChannels)
+{
+   ATLASSERT(sourceBits > 0 && sourceBits <= 32);
+
+   c_lowBitsKernels[targetType](
+      source, 32 - sourceBits,
+      reinterpret_cast<unsigned char* const*>(target), GetSampleSize(targetType),
+      numSamples, numChannels);
+}
@@ -0,0 +1,117 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file SampleConverter.hpp
+/// \brief sample format conversion kernels
+/// \details converts between 8/16/24/32 bit integer and 32 bit float samples,
+/// interleaved and channel array layout, in a single pass over all channels.
+/// The kernels are vectorized using SSE2 or AVX2, selected at runtime, with a
+/// scalar fallback. 24 bit samples are only vectorized when AVX2 is available,
+/// since they need SSSE3 shuffles. Interleaving and deinterleaving of more than
+/// 16 channels always uses scalar code.
+//
+#pragma once
+
+namespace Encoder
+{
+   /// type of a single sample value in a sample buffer
+   enum SampleType
+   {
+      SampleTypeInt8 = 0,     ///< 8 bit signed integer
+      SampleTypeInt16 = 1,    ///< 16 bit signed integer
+      SampleTypeInt24 = 2,    ///< 24 bit signed integer, packed into 3 bytes
+      SampleTypeInt32 = 3,    ///< 32 bit signed integer
+      SampleTypeFloat32 = 4,  ///< 32 bit float, normalized to [-1.0; 1.0]
+      SampleTypeMax = 5,      ///< number of sample types
+   };
+
+   /// instruction set used by the sample conversion kernels
+   enum SampleConverterInstructionSet
+   {
+      instructionSetScalar = 0,  ///< plain C++ code
+      instructionSetSSE2 = 1,    ///< SSE2 kernels, with scalar fallback
+      instructionSetAVX2 = 2,    ///< AVX2 kernels, with SSE2 and scalar fallback
+   };
+
+   /// \brief sample conversion helper class
+   /// \details integer samples are converted by aligning them to 32 bit and
+   /// shifting them down to the target bit depth, rounding to nearest. Float
+   /// samples are scaled by 2^(bits-1), clipped and rounded to nearest.
+   /// Source and target always have the same number of channels.
+   class SampleConverter
+   {
+   public:
+      /// returns sample type for given number of integer bits per sample
+      static SampleType SampleTypeFromBitsPerSample(int bitsPerSample);
+
+      /// returns size of a single sample of given type, in bytes
+      static unsigned int GetSampleSize(SampleType sampleType);
+
+      /// returns the best instruction set supported by the CPU
+      static SampleConverterInstructionSet GetSupportedInstructionSet();
+
+      /// returns the instruction set currently used by the kernels
+      static SampleConverterInstructionSet GetInstructionSet();
+
+      /// \brief sets instruction set to use by the kernels; used for testing and benchmarks
+      /// \details when the CPU doesn't support the instruction set, the best
+      /// supported instruction set is used instead
+      static void SetInstructionSet(SampleConverterInstructionSet instructionSet);
+
+      /// converts interleaved samples to interleaved samples
+      static void InterleavedToInterleaved(
+         const void* source, SampleType sourceType,
+         void* target, SampleType targetType,
+         size_t numSamples, size_t numChannels);
+
+      /// converts interleaved samples to channel array samples
+      static void InterleavedToArray(
+         const void* source, SampleType sourceType,
+         void** target, SampleType targetType,
+         size_t numSamples, size_t numChannels);
+
+      /// converts channel array samples to interleaved samples
+      static void ArrayToInterleaved(
+         const void* const* source, SampleType sourceType,
+         void* target, SampleType targetType,
+         size_t numSamples, size_t numChannels);
+
+      /// converts channel array samples to channel array samples
+      static void ArrayToArray(
+         const void* const* source, SampleType sourceType,
+         void** target, SampleType targetType,
+         size_t numSamples, size_t numChannels);
+
+      /// \brief converts channel array samples stored in the lower sourceBits bits of 32 bit
+      /// integers, e.g. as decoded by libFLAC, to interleaved samples
+      /// \details the samples are aligned to 32 bit and converted in a single pass, using scalar code
+      static void LowBitsArrayToInterleaved(
+         const int* const* source, unsigned int sourceBits,
+         void* target, SampleType targetType,
+         size_t numSamples, size_t numChannels);
+
+      /// \brief converts channel array samples stored in the lower sourceBits bits of 32 bit
+      /// integers to channel array samples
+      /// \details the samples are aligned to 32 bit and converted in a single pass, using scalar code
+      static void LowBitsArrayToArray(
+         const int* const* source, unsigned int sourceBits,
+         void** target, SampleType targetType,
+         size_t numSamples, size_t numChannels);
+   };
+
+} // namespace Encoder
@@ -0,0 +1,132 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file SampleFrameBuffer.hpp
+/// \brief splits blocks of interleaved samples into fixed size frames
+//
+#pragma once
+
+namespace Encoder
+{
+   /// \brief splits blocks of interleaved samples into frames of a fixed size
+   /// \details output modules get sample blocks of arbitrary size from the
+   /// sample container, but encoders often need frames of a fixed size. The
+   /// input block is consumed using an offset; frames that lie completely in
+   /// the input block are returned without copying. Only a frame that spans
+   /// two input blocks is assembled in an internal buffer, so the cost per
+   /// frame doesn't depend on the size of the input blocks.
+   template <typename T>
+   class SampleFrameBuffer
+   {
+   public:
+      /// sets the number of samples per frame, for all channels; discards all samples
+      void Init(size_t numSamplesPerFrame)
+      {
+         m_frameBuffer.resize(numSamplesPerFrame);
+         m_numFrameSamples = 0;
+         ResetInput();
+      }
+
+      /// returns the number of samples per frame, for all channels
+      size_t GetNumSamplesPerFrame() const { return m_frameBuffer.size(); }
+
+      /// \brief sets a new block of input samples
+      /// \details the block must stay valid until NextFrame() returned nullptr
+      void SetInput(const T* samples, size_t numSamples)
+      {
+         ATLASSERT(m_inputOffset == m_numInputSamples); // previous input must have been consumed
+
+         m_inputSamples = samples;
+         m_numInputSamples = numSamples;
+         m_inputOffset = 0;
+      }
+
+      /// \brief returns the next complete frame, or nullptr when the input doesn't
+      /// contain another complete frame
+      /// \details the frame stays valid until the next call to NextFrame(). When
+      /// nullptr is returned, the remaining input samples were stored and the
+      /// input block isn't accessed anymore.
+      const T* NextFrame()
+      {
+         const size_t numSamplesPerFrame = m_frameBuffer.size();
+         const size_t numInputSamplesLeft = m_numInputSamples - m_inputOffset;
+
+         // frame completely inside the input block
+         if (m_numFrameSamples == 0 && numInputSamplesLeft >= numSamplesPerFrame)
+         {
+            const T* frame = m_inputSamples + m_inputOffset;
+            m_inputOffset += numSamplesPerFrame;
+            return frame;
+         }
+
+         // frame spans input blocks; collect samples in frame buffer
+         size_t numSamplesToCopy = std::min(numSamplesPerFrame - m_numFrameSamples, numInputSamplesLeft);
+
+         std::copy_n(m_inputSamples + m_inputOffset, numSamplesToCopy, m_frameBuffer.data() + m_numFrameSamples);
+
+         m_inputOffset += numSamplesToCopy;
+         m_numFrameSamples += numSamplesToCopy;
+
+         if (m_numFrameSamples < numSamplesPerFrame)
+         {
+            ResetInput();
+            return nullptr;
+         }
+
+         m_numFrameSamples = 0;
+         return m_frameBuffer.data();
+      }
+
+      /// returns the samples that don't make up a complete frame; used at the end of the stream
+      const T* RemainingSamples(size_t& numSamples)
+      {
+         ATLASSERT(m_inputOffset == m_numInputSamples); // NextFrame() must have returned nullptr
+
+         numSamples = m_numFrameSamples;
+         m_numFrameSamples = 0;
+
+         return m_frameBuffer.data();
+      }
+
+   private:
+      /// forgets about the input block
+      void ResetInput()
+      {
+         m_inputSamples = nullptr;
+         m_numInputSamples = 0;
+         m_inputOffset = 0;
+      }
+
+   private:
+      /// buffer for a frame that spans input blocks
+      std::vector<T> m_frameBuffer;
+
+      /// number of samples already collected in the frame buffer
+      size_t m_numFrameSamples = 0;
+
+      /// current input block
+      const T* m_inputSamples = nullptr;
+
+      /// number of samples in the input block
+      size_t m_numInputSamples = 0;
+
+      /// offset of the next sample to consume from the input block
+      size_t m_inputOffset = 0;
+   };
+
+} // namespace Encoder
@@ -32,13 +32,11 @@ using Encoder::SndFileInputModule;
 using Encoder::TrackInfo;
 using Encoder::SampleContainer;
 
-/// sndfile input buffer size
-const int c_sndfileInputBufferSize = 512;
-
 SndFileInputModule::SndFileInputModule()
    :m_sndfile(nullptr),
    m_sampleCount(0),
-   m_numOutputBits(0)
+   m_numOutputBits(0),
+   m_floatSamples(false)
 {
    m_moduleId = ID_IM_SNDFILE;
    memset(&m_sfinfo, 0, sizeof(m_sfinfo));
@@ -165,29 +163,35 @@ int SndFileInputModule::InitInput(LPCTSTR infilename,
    case SF_FORMAT_PCM_24:
    case SF_FORMAT_DWVW_24:
    case SF_FORMAT_PCM_32:
+      m_numOutputBits = 32;
+      break;
    case SF_FORMAT_FLOAT:
    case SF_FORMAT_DOUBLE:
       m_numOutputBits = 32;
+      m_floatSamples = true;
       break;
    default:
       m_numOutputBits = 16;
       break;
    }
 
-   // prepare input buffer
-   if (m_numOutputBits == 32)
-      m_buffer.resize(sizeof(int) * c_sndfileInputBufferSize * m_sfinfo.channels);
-   else if (m_numOutputBits == 16)
-      m_buffer.resize(sizeof(short) * c_sndfileInputBufferSize * m_sfinfo.channels);
-   else
+   // the input buffer is allocated in DecodeSamples(), since the block size is
+   // only known when the output module is initialized
+   m_buffer.clear();
+
+   if (m_numOutputBits != 32 && m_numOutputBits != 16)
    {
       m_lastError.LoadString(IDS_ENCODER_INVALID_FILE_FORMAT);
       return -1;
    }
 
    // set up input traits
-   samples.SetInputModuleTraits(m_numOutputBits, SamplesInterleaved,
-      m_sfinfo.samplerate, m_sfinfo.channels);
+   if (m_floatSamples)
+      samples.SetInputModuleFloatTraits(SamplesInterleaved,
+         m_sfinfo.samplerate, m_sfinfo.channels);
+   else
+      samples.SetInputModuleTraits(m_numOutputBits, SamplesInterleaved,
+         m_sfinfo.samplerate, m_sfinfo.channels);
 
    return 0;
 }
@@ -266,16 +270,26 @@ void SndFileInputModule::GetInfo(int& numChannels, int& bitrateInBps, int& lengt
 
 int SndFileInputModule::DecodeSamples(SampleContainer& samples)
 {
+   // read as many samples as the output module prefers
+   int numSamplesPerChannel = samples.GetPreferredBlockSize();
+
+   size_t bufferSize = size_t(numSamplesPerChannel) * m_sfinfo.channels * (m_numOutputBits >> 3);
+   if (m_buffer.size() < bufferSize)
+      m_buffer.resize(bufferSize);
+
    // read samples
    sf_count_t ret;
 
    int* intBuffer = reinterpret_cast<int*>(m_buffer.data());
    short* shortBuffer = reinterpret_cast<short*>(m_buffer.data());
+   float* floatBuffer = reinterpret_cast<float*>(m_buffer.data());
 
-   if (m_numOutputBits == 32)
-      ret = sf_readf_int(m_sndfile, intBuffer, c_sndfileInputBufferSize);
+   if (m_floatSamples)
+      ret = sf_readf_float(m_sndfile, floatBuffer, numSamplesPerChannel);
+   else if (m_numOutputBits == 32)
+      ret = sf_readf_int(m_sndfile, intBuffer, numSamplesPerChannel);
    else
-      ret = sf_readf_short(m_sndfile, shortBuffer, c_sndfileInputBufferSize);
+      ret = sf_readf_short(m_sndfile, shortBuffer, numSamplesPerChannel);
 
    int iret = static_cast<int>(ret);
 
@@ -289,7 +303,7 @@ int SndFileInputModule::DecodeSamples(SampleContainer& samples)
    }
 
    // put samples in container
-   samples.PutSamplesInterleaved(m_buffer.data(), iret);
+   samples.PutSamplesInterleavedBorrowed(m_buffer.data(), iret);
 
    // count samples
    m_sampleCount += iret;
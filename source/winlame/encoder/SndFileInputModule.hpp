@@ -100,6 +100,9 @@ namespace Encoder
       /// number of output bits
       int m_numOutputBits;
 
+      /// indicates if the file contains float samples, which are decoded as float
+      bool m_floatSamples;
+
       /// filter string
       mutable CString m_filterString;
    };
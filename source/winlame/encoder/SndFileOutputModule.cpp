@@ -26,6 +26,7 @@
 #include "SndFileFormats.hpp"
 #include <ulib/DynamicLibrary.hpp>
 #include "App.hpp"
+#include "AudioFileTag.hpp"
 
 using Encoder::SndFileOutputModule;
 using Encoder::TrackInfo;
@@ -104,6 +105,8 @@ int SndFileOutputModule::InitOutput(LPCTSTR outfilename,
 
    m_sfinfo.format = m_format | m_subType;
 
+   m_outputFilename = outfilename;
+
    // opens the file for writing
 #ifdef UNICODE
    m_sndfile = sf_wchar_open(outfilename, SFM_WRITE, &m_sfinfo);
@@ -143,8 +146,12 @@ int SndFileOutputModule::InitOutput(LPCTSTR outfilename,
       break;
    }
 
-   // set up output traits
-   samples.SetOutputModuleTraits(numOutputBits, SamplesInterleaved);
+   // set up output traits; float formats get float samples without converting them to integer first
+   if (m_subType == SF_FORMAT_FLOAT ||
+      m_subType == SF_FORMAT_DOUBLE)
+      samples.SetOutputModuleFloatTraits(SamplesInterleaved);
+   else
+      samples.SetOutputModuleTraits(numOutputBits, SamplesInterleaved);
 
    return 0;
 }
@@ -158,21 +165,13 @@ int SndFileOutputModule::EncodeSamples(SampleContainer& samples)
    void* sampleBuffer = samples.GetSamplesInterleaved(numSamples);
 
    // write samples
-   if (samples.GetOutputModuleBitsPerSample() == 16)
+   if (samples.IsOutputModuleFloat())
    {
-      ret = sf_write_short(m_sndfile, (short*)sampleBuffer, sf_count_t(numSamples) * m_sfinfo.channels);
+      ret = sf_write_float(m_sndfile, (float*)sampleBuffer, sf_count_t(numSamples) * m_sfinfo.channels);
    }
-   else if (m_subType == SF_FORMAT_FLOAT ||
-      m_subType == SF_FORMAT_DOUBLE)
+   else if (samples.GetOutputModuleBitsPerSample() == 16)
    {
-      int* intSampleBuffer = (int*)sampleBuffer;
-
-      std::vector<float> floatBuffer(numSamples * m_sfinfo.channels);
-
-      for (int i = 0; i < numSamples * m_sfinfo.channels; i++)
-         floatBuffer[i] = float(intSampleBuffer[i]) / (1UL << 31);
-
-      ret = sf_write_float(m_sndfile, floatBuffer.data(), floatBuffer.size());
+      ret = sf_write_short(m_sndfile, (short*)sampleBuffer, sf_count_t(numSamples) * m_sfinfo.channels);
    }
    else if (samples.GetOutputModuleBitsPerSample() == 32)
    {
@@ -195,6 +194,24 @@ int SndFileOutputModule::EncodeSamples(SampleContainer& samples)
 void SndFileOutputModule::DoneOutput()
 {
    sf_close(m_sndfile);
+
+   // libsndfile can't write arbitrary tag fields, so the gain values are stored
+   // afterwards for the formats that have a tag that supports them
+   if (!m_lastError.IsEmpty() || !m_loudnessResult.m_isValid)
+      return;
+
+   AudioFileTag::AudioFileType audioFileType;
+   if (m_format == SF_FORMAT_FLAC)
+      audioFileType = AudioFileTag::AudioFileType::FLAC;
+   else if (m_format == SF_FORMAT_OGG && m_subType == SF_FORMAT_VORBIS)
+      audioFileType = AudioFileTag::AudioFileType::OggVorbis;
+   else
+      return;
+
+   TrackInfo trackInfo;
+   m_loudnessResult.StoreTrackGain(trackInfo);
+
+   AudioFileTag(trackInfo).WriteReplayGainToFile(m_outputFilename, audioFileType);
 }
 
 void SndFileOutputModule::SetTrackInfo(const TrackInfo& trackInfo)
@@ -80,6 +80,9 @@ namespace Encoder
       /// last error occured
       CString m_lastError;
 
+      /// output filename; used to store the gain values after encoding
+      CString m_outputFilename;
+
       /// format to write
       int m_format;
 
@@ -97,33 +97,17 @@ CString SpeexInputModule::GetFilterString() const
 int SpeexInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    TrackInfo& trackInfo, SampleContainer& samples)
 {
-   FILE* fd = nullptr;
-   errno_t err = _tfopen_s(&fd, infilename, _T("rb"));
+   std::shared_ptr<InputSource> inputSource = std::make_shared<InputSource>();
 
-   if (err != 0 || fd == nullptr)
+   if (!inputSource->Open(infilename))
    {
       m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
       return -1;
    }
 
-   err = fseek(fd, 0, SEEK_END);
-   if (err != 0)
-   {
-      m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
-      fclose(fd);
-      return -1;
-   }
+   m_fileSize = inputSource->Length();
 
-   m_fileSize = ftell(fd);
-   err = fseek(fd, 0, SEEK_SET);
-   if (err != 0)
-   {
-      m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
-      fclose(fd);
-      return -1;
-   }
-
-   m_inputStream.reset(new OggInputStream(fd, false));
+   m_inputStream.reset(new OggInputStream(inputSource));
 
    size_t numTryReads = 3;
    while (!m_inputStream->IsEndOfStream() && numTryReads > 0)
@@ -146,7 +130,6 @@ int SpeexInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    if (m_header == nullptr)
    {
       m_lastError = _T("Couldn't read Speex header");
-      fclose(fd);
       return -1;
    }
 
@@ -157,15 +140,13 @@ int SpeexInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
       m_header->rate, m_header->nb_channels);
 
    // re-init file
-   err = fseek(fd, 0, SEEK_SET);
-   if (err != 0)
+   if (!inputSource->Seek(0, SEEK_SET))
    {
       m_lastError.LoadString(IDS_ENCODER_INPUT_FILE_OPEN_ERROR);
-      fclose(fd);
       return -1;
    }
 
-   m_inputStream.reset(new OggInputStream(fd, true));
+   m_inputStream.reset(new OggInputStream(inputSource));
 
    m_packetCount = 0;
 
@@ -217,9 +198,10 @@ int SpeexInputModule::DecodeSamples(SampleContainer& samples)
 
             ATLASSERT(!sampleBuffer.empty());
 
-            samples.PutSamplesInterleaved(sampleBuffer.data(), sampleBuffer.size() / m_header->nb_channels);
+            int numSamplesPerChannel = static_cast<int>(sampleBuffer.size() / m_header->nb_channels);
+            samples.PutSamplesInterleaved(sampleBuffer.data(), numSamplesPerChannel);
 
-            return sampleBuffer.size();
+            return numSamplesPerChannel;
          }
 
       m_packetCount++;
@@ -238,9 +220,9 @@ float SpeexInputModule::PercentDone() const
    if (m_inputStream->IsEndOfStream())
       return 100.0f;
 
-   long lPos = ftell(m_inputStream->GetFd());
+   unsigned long long pos = m_inputStream->GetInputSource()->Position();
 
-   return float(lPos) * 100.0f / m_fileSize;
+   return float(pos) * 100.0f / m_fileSize;
 }
 
 void SpeexInputModule::DoneInput()
@@ -248,6 +230,7 @@ void SpeexInputModule::DoneInput()
    speex_bits_destroy(&m_bits);
    m_header.reset();
    m_decoderState.reset();
+   m_inputStream.reset();
 }
 
 void SpeexInputModule::InitDecoder()
@@ -334,13 +317,9 @@ void SpeexInputModule::CalcSampleCount() const
    if (m_inputStream == nullptr)
       return;
 
-   FILE* fd = m_inputStream->GetFd();
-   if (fd == nullptr)
-      return;
+   std::shared_ptr<InputSource> inputSource = m_inputStream->GetInputSource();
 
-   long currentPos = ftell(fd);
-   if (currentPos < 0)
-      return;
+   unsigned long long currentPos = inputSource->Position();
 
    ogg_int64_t sampleCount = 0;
    ogg_int64_t samplesPerPacket = 0;
@@ -369,8 +348,7 @@ void SpeexInputModule::CalcSampleCount() const
       }
    }
 
-   int ret = fseek(fd, currentPos, SEEK_SET);
-   if (ret != 0)
+   if (!inputSource->Seek(static_cast<long long>(currentPos), SEEK_SET))
       return;
 
    m_sampleCount = sampleCount;
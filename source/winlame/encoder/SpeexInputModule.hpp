@@ -97,7 +97,7 @@ namespace Encoder
       std::shared_ptr<OggInputStream> m_inputStream;
 
       /// file size
-      long m_fileSize;
+      unsigned long long m_fileSize;
 
       /// packet count
       unsigned int m_packetCount;
@@ -37,6 +37,10 @@ namespace Encoder
       TrackInfoComment,    ///< track comment
       TrackInfoGenre,      ///< track genre
       TrackInfoComposer,   ///< track composer
+      TrackInfoTrackGain,  ///< ReplayGain track gain, e.g. "-6.54 dB"
+      TrackInfoTrackPeak,  ///< ReplayGain track peak, e.g. "0.987654"
+      TrackInfoAlbumGain,  ///< ReplayGain album gain
+      TrackInfoAlbumPeak,  ///< ReplayGain album peak
    };
 
    /// track number info enum
@@ -0,0 +1,441 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TranscodeCache.cpp
+/// \brief persistent cache of encoded output files, keyed by input content and settings
+//
+#include "stdafx.h"
+#include "TranscodeCache.hpp"
+#include "SettingsManager.hpp"
+
+using Encoder::ContentHasher;
+using Encoder::TranscodeCache;
+
+namespace
+{
+   /// XXH64 primes
+   const unsigned long long c_prime1 = 0x9E3779B185EBCA87ULL;
+   const unsigned long long c_prime2 = 0xC2B2AE3D27D4EB4FULL;
+   const unsigned long long c_prime3 = 0x165667B19E3779F9ULL;
+   const unsigned long long c_prime4 = 0x85EBCA77C2B2AE63ULL;
+   const unsigned long long c_prime5 = 0x27D4EB2F165667C5ULL;
+
+   /// rotates value left
+   inline unsigned long long RotateLeft(unsigned long long value, int bits)
+   {
+      return (value << bits) | (value >> (64 - bits));
+   }
+
+   /// reads little endian 64 bit value
+   inline unsigned long long Read64(const unsigned char* data)
+   {
+      unsigned long long value;
+      memcpy(&value, data, sizeof(value));
+      return value;
+   }
+
+   /// reads little endian 32 bit value
+   inline unsigned long long Read32(const unsigned char* data)
+   {
+      unsigned int value;
+      memcpy(&value, data, sizeof(value));
+      return value;
+   }
+
+   /// processes one 8 byte lane value
+   inline unsigned long long Round(unsigned long long accumulator, unsigned long long input)
+   {
+      accumulator += input * c_prime2;
+      accumulator = RotateLeft(accumulator, 31);
+      return accumulator * c_prime1;
+   }
+
+   /// merges an accumulator into the hash
+   inline unsigned long long MergeRound(unsigned long long hash, unsigned long long accumulator)
+   {
+      hash ^= Round(0, accumulator);
+      return hash * c_prime1 + c_prime4;
+   }
+
+   /// first line of the index file
+   const char c_indexFileHeader[] = "winLAME transcode cache 1";
+
+   /// size of chunks when reading input files for hashing
+   const size_t c_hashChunkSize = 1024 * 1024;
+}
+
+ContentHasher::ContentHasher(unsigned long long seed)
+   :m_seed(seed)
+{
+   m_accumulators[0] = seed + c_prime1 + c_prime2;
+   m_accumulators[1] = seed + c_prime2;
+   m_accumulators[2] = seed;
+   m_accumulators[3] = seed - c_prime1;
+}
+
+void ContentHasher::Update(const void* data, size_t length)
+{
+   const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+
+   m_totalLength += length;
+
+   // fill up the stripe that was started by the last call
+   if (m_bufferLength > 0)
+   {
+      size_t fillLength = std::min(length, sizeof(m_buffer) - m_bufferLength);
+      memcpy(m_buffer + m_bufferLength, bytes, fillLength);
+
+      m_bufferLength += fillLength;
+      bytes += fillLength;
+      length -= fillLength;
+
+      if (m_bufferLength < sizeof(m_buffer))
+         return;
+
+      for (int lane = 0; lane < 4; lane++)
+         m_accumulators[lane] = Round(m_accumulators[lane], Read64(m_buffer + lane * 8));
+
+      m_bufferLength = 0;
+   }
+
+   for (; length >= sizeof(m_buffer); bytes += sizeof(m_buffer), length -= sizeof(m_buffer))
+   {
+      for (int lane = 0; lane < 4; lane++)
+         m_accumulators[lane] = Round(m_accumulators[lane], Read64(bytes + lane * 8));
+   }
+
+   memcpy(m_buffer, bytes, length);
+   m_bufferLength = length;
+}
+
+unsigned long long ContentHasher::Finish() const
+{
+   unsigned long long hash;
+   if (m_totalLength >= sizeof(m_buffer))
+   {
+      hash = RotateLeft(m_accumulators[0], 1) + RotateLeft(m_accumulators[1], 7) +
+         RotateLeft(m_accumulators[2], 12) + RotateLeft(m_accumulators[3], 18);
+
+      for (int lane = 0; lane < 4; lane++)
+         hash = MergeRound(hash, m_accumulators[lane]);
+   }
+   else
+      hash = m_seed + c_prime5;
+
+   hash += m_totalLength;
+
+   const unsigned char* bytes = m_buffer;
+   size_t length = m_bufferLength;
+
+   for (; length >= 8; bytes += 8, length -= 8)
+   {
+      hash ^= Round(0, Read64(bytes));
+      hash = RotateLeft(hash, 27) * c_prime1 + c_prime4;
+   }
+
+   if (length >= 4)
+   {
+      hash ^= Read32(bytes) * c_prime1;
+      hash = RotateLeft(hash, 23) * c_prime2 + c_prime3;
+      bytes += 4;
+      length -= 4;
+   }
+
+   for (; length > 0; bytes++, length--)
+   {
+      hash ^= *bytes * c_prime5;
+      hash = RotateLeft(hash, 11) * c_prime1;
+   }
+
+   hash ^= hash >> 33;
+   hash *= c_prime2;
+   hash ^= hash >> 29;
+   hash *= c_prime3;
+   hash ^= hash >> 32;
+
+   return hash;
+}
+
+TranscodeCache::TranscodeCache(const CString& indexFilename)
+   :m_journal(indexFilename, c_indexFileHeader)
+{
+}
+
+bool TranscodeCache::Load()
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   m_mapInputFiles.clear();
+   m_mapOutputFiles.clear();
+
+   // invalid records, e.g. a partly written last line, are skipped
+   size_t numRecords = 0;
+   bool hasCurrentFormat = false;
+   if (!m_journal.Read([&](const std::vector<CString>& fields) { ParseRecord(fields); },
+      numRecords, hasCurrentFormat))
+      return false;
+
+   if (!hasCurrentFormat ||
+      IndexJournal::IsRewriteNeeded(numRecords, m_mapInputFiles.size() + m_mapOutputFiles.size()))
+      return m_journal.Rewrite(FormatAllLines());
+
+   return true;
+}
+
+size_t TranscodeCache::GetNumOutputFiles() const
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+   return m_mapOutputFiles.size();
+}
+
+bool TranscodeCache::GetContentHash(const CString& inputFilename, unsigned long long& contentHash)
+{
+   InputFileInfo info;
+   if (!FileStamp::Read(inputFilename, info.m_stamp))
+      return false;
+
+   CString key = InputFilenameKey(inputFilename);
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      auto iter = m_mapInputFiles.find(key);
+      if (iter != m_mapInputFiles.end() &&
+         iter->second.m_stamp == info.m_stamp)
+      {
+         contentHash = iter->second.m_contentHash;
+         return true;
+      }
+   }
+
+   if (!HashFileContent(inputFilename, info.m_contentHash))
+      return false;
+
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   m_mapInputFiles[key] = info;
+   m_journal.Append(FormatInputLine(key, info));
+
+   contentHash = info.m_contentHash;
+   return true;
+}
+
+bool TranscodeCache::FindOutput(unsigned long long contentHash, unsigned long long settingsHash, CString& outputFilename) const
+{
+   OutputFileInfo info;
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      auto iter = m_mapOutputFiles.find(std::make_pair(contentHash, settingsHash));
+      if (iter == m_mapOutputFiles.end())
+         return false;
+
+      info = iter->second;
+   }
+
+   FileStamp stamp;
+   if (!FileStamp::Read(info.m_filename, stamp) ||
+      !(stamp == info.m_stamp))
+      return false;
+
+   outputFilename = info.m_filename;
+   return true;
+}
+
+void TranscodeCache::AddOutput(const CString& inputFilename, unsigned long long contentHash,
+   unsigned long long settingsHash, const CString& outputFilename)
+{
+   OutputFileInfo info;
+   info.m_filename = outputFilename;
+   if (!FileStamp::Read(outputFilename, info.m_stamp))
+      return;
+
+   // the input file stamp is stored again, since the input may have been hashed by
+   // another cache instance, or the file was modified while encoding
+   InputFileInfo inputInfo;
+   bool storeInputInfo = FileStamp::Read(inputFilename, inputInfo.m_stamp);
+   inputInfo.m_contentHash = contentHash;
+
+   CString key = InputFilenameKey(inputFilename);
+
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   CString lines;
+
+   auto iter = m_mapInputFiles.find(key);
+   if (storeInputInfo &&
+      (iter == m_mapInputFiles.end() ||
+         !(iter->second.m_stamp == inputInfo.m_stamp) ||
+         iter->second.m_contentHash != contentHash))
+   {
+      m_mapInputFiles[key] = inputInfo;
+      lines += FormatInputLine(key, inputInfo);
+   }
+
+   m_mapOutputFiles[std::make_pair(contentHash, settingsHash)] = info;
+   lines += FormatOutputLine(contentHash, settingsHash, info);
+
+   m_journal.Append(lines);
+}
+
+unsigned long long TranscodeCache::HashSettings(int outputModuleID, SettingsManager& settingsManager)
+{
+   VarMgrVariables variables;
+
+   CString text;
+   text.Format(_T("outputModule=%i;"), outputModuleID);
+
+   for (int varID = VarFirst + 1; varID < VarLast; varID++)
+   {
+      // these only control the current encoding run
+      if (varID == LameNoGapInstanceId ||
+         varID == GeneralIsLastFile)
+         continue;
+
+      // the names instead of the IDs are used, so that the hash doesn't change when
+      // variables are added
+      CString name = variables.lookupName(varID);
+      if (name.IsEmpty())
+         continue;
+
+      text.AppendFormat(_T("%s=%i;"), name.GetString(),
+         settingsManager.QueryValueInt(static_cast<unsigned short>(varID)));
+   }
+
+   CStringA textA(text);
+
+   ContentHasher hasher;
+   hasher.Update(textA.GetString(), textA.GetLength());
+   return hasher.Finish();
+}
+
+bool TranscodeCache::ReuseOutputFile(const CString& cachedOutputFilename, const CString& outputFilename)
+{
+   if (cachedOutputFilename.CompareNoCase(outputFilename) == 0)
+      return true;
+
+   // the existing file is deleted instead of being overwritten, since it may be a hard
+   // link to the cached file, which would be overwritten, too
+   DeleteFile(outputFilename);
+
+   return CopyFile(cachedOutputFilename, outputFilename, TRUE) != FALSE;
+}
+
+bool TranscodeCache::HashFileContent(const CString& filename, unsigned long long& contentHash)
+{
+   FILE* fd = _tfopen(filename, _T("rb"));
+   if (fd == nullptr)
+      return false;
+
+   ContentHasher hasher;
+   std::vector<unsigned char> buffer(c_hashChunkSize);
+
+   size_t length;
+   while ((length = fread(buffer.data(), 1, buffer.size(), fd)) > 0)
+      hasher.Update(buffer.data(), length);
+
+   bool isError = ferror(fd) != 0;
+   fclose(fd);
+
+   if (isError)
+      return false;
+
+   contentHash = hasher.Finish();
+   return true;
+}
+
+CString TranscodeCache::InputFilenameKey(const CString& inputFilename)
+{
+   CString key = inputFilename;
+   key.MakeLower();
+   return key;
+}
+
+bool TranscodeCache::ParseRecord(const std::vector<CString>& fields)
+{
+   if (fields.size() == 5 && fields[0] == _T("I"))
+   {
+      InputFileInfo info;
+      info.m_stamp.m_size = _tcstoui64(fields[1], nullptr, 10);
+      info.m_stamp.m_lastWriteTime = _tcstoui64(fields[2], nullptr, 10);
+      info.m_contentHash = _tcstoui64(fields[3], nullptr, 16);
+
+      if (fields[4].IsEmpty())
+         return false;
+
+      m_mapInputFiles[fields[4]] = info;
+      return true;
+   }
+
+   if (fields.size() == 6 && fields[0] == _T("O"))
+   {
+      unsigned long long contentHash = _tcstoui64(fields[1], nullptr, 16);
+      unsigned long long settingsHash = _tcstoui64(fields[2], nullptr, 16);
+
+      OutputFileInfo info;
+      info.m_stamp.m_size = _tcstoui64(fields[3], nullptr, 10);
+      info.m_stamp.m_lastWriteTime = _tcstoui64(fields[4], nullptr, 10);
+      info.m_filename = fields[5];
+
+      if (info.m_filename.IsEmpty())
+         return false;
+
+      m_mapOutputFiles[std::make_pair(contentHash, settingsHash)] = info;
+      return true;
+   }
+
+   return false;
+}
+
+CString TranscodeCache::FormatInputLine(const CString& inputFilename, const InputFileInfo& info)
+{
+   CString line;
+   line.Format(_T("I\t%llu\t%llu\t%016llx\t%s\n"),
+      info.m_stamp.m_size,
+      info.m_stamp.m_lastWriteTime,
+      info.m_contentHash,
+      inputFilename.GetString());
+
+   return line;
+}
+
+CString TranscodeCache::FormatOutputLine(unsigned long long contentHash, unsigned long long settingsHash,
+   const OutputFileInfo& info)
+{
+   CString line;
+   line.Format(_T("O\t%016llx\t%016llx\t%llu\t%llu\t%s\n"),
+      contentHash,
+      settingsHash,
+      info.m_stamp.m_size,
+      info.m_stamp.m_lastWriteTime,
+      info.m_filename.GetString());
+
+   return line;
+}
+
+CString TranscodeCache::FormatAllLines() const
+{
+   CString lines;
+
+   for (const auto& iter : m_mapInputFiles)
+      lines += FormatInputLine(iter.first, iter.second);
+
+   for (const auto& iter : m_mapOutputFiles)
+      lines += FormatOutputLine(iter.first.first, iter.first.second, iter.second);
+
+   return lines;
+}
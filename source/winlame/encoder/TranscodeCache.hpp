@@ -0,0 +1,167 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TranscodeCache.hpp
+/// \brief persistent cache of encoded output files, keyed by input content and settings
+//
+#pragma once
+
+#include "IndexJournal.hpp"
+#include <map>
+#include <mutex>
+
+class SettingsManager;
+
+namespace Encoder
+{
+   /// \brief calculates the 64 bit xxHash (XXH64) of data that is passed in one or more parts
+   /// \see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+   class ContentHasher
+   {
+   public:
+      /// ctor
+      explicit ContentHasher(unsigned long long seed = 0);
+
+      /// adds data to the hash
+      void Update(const void* data, size_t length);
+
+      /// returns the hash of all data added so far
+      unsigned long long Finish() const;
+
+   private:
+      /// seed value
+      unsigned long long m_seed;
+
+      /// accumulators of the four lanes
+      unsigned long long m_accumulators[4];
+
+      /// data that doesn't fill a 32 byte stripe yet
+      unsigned char m_buffer[32];
+
+      /// number of bytes in m_buffer
+      size_t m_bufferLength = 0;
+
+      /// number of bytes added in total
+      unsigned long long m_totalLength = 0;
+   };
+
+   /// \brief persistent index of encoded output files, to skip encoding when the same
+   /// input was already encoded with the same settings
+   /// \details The cache key is the content hash of the input file, together with a hash
+   /// of the output module ID and all encoding settings. Since hashing the content needs
+   /// reading the whole file, the content hash is also stored per input filename, with
+   /// the size and the last write time of the file; when they are unchanged, the stored
+   /// content hash is used. Cached output files are only used while their size and last
+   /// write time are unchanged. The index is a UTF-8 text file; new entries are appended
+   /// as soon as they are added, and superseded lines are removed when loading the index.
+   /// All methods may be called from multiple encoder threads.
+   class TranscodeCache
+   {
+   public:
+      /// ctor; takes the filename of the index file
+      explicit TranscodeCache(const CString& indexFilename);
+
+      /// \brief loads the index file; a missing file is an empty index
+      /// \details returns false when the index file exists but can't be read
+      bool Load();
+
+      /// returns number of cached output files
+      size_t GetNumOutputFiles() const;
+
+      /// \brief returns the content hash of an input file
+      /// \details the stored hash is used when size and last write time of the file are
+      /// unchanged; else the file is read. Returns false when the file can't be read
+      bool GetContentHash(const CString& inputFilename, unsigned long long& contentHash);
+
+      /// \brief finds an output file for given input content and settings
+      /// \details returns false when there's none, or when the output file was
+      /// modified or deleted since it was added
+      bool FindOutput(unsigned long long contentHash, unsigned long long settingsHash, CString& outputFilename) const;
+
+      /// adds an output file that was encoded from given input file and settings, replacing
+      /// an earlier output file of the same input content and settings
+      void AddOutput(const CString& inputFilename, unsigned long long contentHash,
+         unsigned long long settingsHash, const CString& outputFilename);
+
+      /// \brief returns the hash of an output module ID and all settings that influence the output
+      /// \details settings that only control a single encoding run, e.g. the nogap
+      /// instance, aren't used; settings that aren't set count with their default value
+      static unsigned long long HashSettings(int outputModuleID, SettingsManager& settingsManager);
+
+      /// \brief provides a cached output file under another filename
+      /// \details copies the file; an existing file with the new name is replaced. Returns
+      /// true without doing anything when both filenames are the same. The file is never
+      /// hard linked, since both names would then alias the same data, and tagging the new
+      /// file or rewriting it with album gain would also modify the cached file.
+      static bool ReuseOutputFile(const CString& cachedOutputFilename, const CString& outputFilename);
+
+   private:
+      /// content hash of an input file, valid while the file stamp is unchanged
+      struct InputFileInfo
+      {
+         /// file stamp of the input file when the content was hashed
+         FileStamp m_stamp;
+
+         /// content hash
+         unsigned long long m_contentHash = 0;
+      };
+
+      /// cached output file
+      struct OutputFileInfo
+      {
+         /// output filename
+         CString m_filename;
+
+         /// file stamp of the output file when it was added
+         FileStamp m_stamp;
+      };
+
+      /// reads the whole file and calculates its content hash; returns false on errors
+      static bool HashFileContent(const CString& filename, unsigned long long& contentHash);
+
+      /// returns the key used for input filenames; file names are case-insensitive
+      static CString InputFilenameKey(const CString& inputFilename);
+
+      /// parses the fields of an index record; returns false when it's not a valid record
+      bool ParseRecord(const std::vector<CString>& fields);
+
+      /// formats index lines of an input file
+      static CString FormatInputLine(const CString& inputFilename, const InputFileInfo& info);
+
+      /// formats index lines of an output file
+      static CString FormatOutputLine(unsigned long long contentHash, unsigned long long settingsHash,
+         const OutputFileInfo& info);
+
+      /// formats index lines of all entries
+      CString FormatAllLines() const;
+
+   private:
+      /// index file
+      IndexJournal m_journal;
+
+      /// mutex to protect the index
+      mutable std::mutex m_mutex;
+
+      /// infos of all input files, by input filename key
+      std::map<CString, InputFileInfo> m_mapInputFiles;
+
+      /// all cached output files, by content hash and settings hash
+      std::map<std::pair<unsigned long long, unsigned long long>, OutputFileInfo> m_mapOutputFiles;
+   };
+
+} // namespace Encoder
@@ -149,6 +149,7 @@ WL_VARMAP_START(varMapVariables)
 // persistent encoder variables
 WL_VARMAP_ENTRY(LameOptNoGap, _T("lameNoGap"), _T("nogap Encoding"), 0)
 WL_VARMAP_ENTRY(LameWriteWaveHeader, _T("lameWriteWaveHeader"), _T("write Wave Header"), 0)
+WL_VARMAP_ENTRY(LameParallelEncoding, _T("lameParallelEncoding"), _T("parallel Encoding"), 0)
 
 WL_VARMAP_ENTRY(LameSimpleEncodeQuality, _T("lameEncodeQuality"), _T("LAME encode quality"), 1)
 WL_VARMAP_ENTRY(LameSimpleMono, _T("lameMono"), _T("LAME mono"), 0)
@@ -187,6 +188,9 @@ WL_VARMAP_ENTRY(OpusComplexity, _T("opusComplexity"), _T("Opus Complexity"), 10)
 WL_VARMAP_ENTRY(OpusBitrateMode, _T("opusBitrateMode"), _T("Opus Bitrate Mode"), 0)
 
 WL_VARMAP_ENTRY(GeneralIsLastFile, _T("isLastFile"), _T("is last file"), 0)
+WL_VARMAP_ENTRY(GeneralResamplerQuality, _T("resamplerQuality"), _T("Resampler Quality"), 2)
+WL_VARMAP_ENTRY(GeneralReplayGain, _T("replayGain"), _T("ReplayGain Analysis"), 1)
+WL_VARMAP_ENTRY(GeneralAlbumGain, _T("albumGain"), _T("ReplayGain Album Gain"), 0)
 WL_VARMAP_END()
 
 
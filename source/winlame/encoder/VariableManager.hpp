@@ -75,6 +75,7 @@ enum
    LameOptNoGap,
    LameNoGapInstanceId,
    LameWriteWaveHeader,
+   LameParallelEncoding,
 
    LameSimpleEncodeQuality,
    LameSimpleMono,
@@ -105,6 +106,9 @@ enum
    AacAutoBandwidth,
 
    GeneralIsLastFile,
+   GeneralResamplerQuality,
+   GeneralReplayGain,
+   GeneralAlbumGain,
 
    WmaBitrate,
    WmaQuality,
@@ -22,7 +22,7 @@
 #include "stdafx.h"
 #include "WaveMp3Header.hpp"
 #include <mmreg.h>
-#include <fstream>
+#include "OutputSink.hpp"
 
 /// \verbatim from mmreg.h:
 /// //
@@ -84,21 +84,21 @@
 /// chunk data, data 0x007145f6
 /// chunk LIST, data 0x00000040
 
-void Encoder::WriteWaveMp3Header(std::ofstream& outputFile, unsigned int numChannels,
+void Encoder::WriteWaveMp3Header(OutputSink& outputSink, unsigned int numChannels,
    unsigned int samplerateInHz, unsigned int bitrateInBps, unsigned short codecDelay)
 {
    // write riff header
-   outputFile.write("RIFF", 4);
+   outputSink.Write("RIFF", 4);
 
    unsigned int data = 0xffffffff; // length of file; we don't know yet
-   outputFile.write(reinterpret_cast<char*>(&data), 4);
+   outputSink.Write(&data, 4);
 
-   outputFile.write("WAVE", 4);
+   outputSink.Write("WAVE", 4);
 
    // write "fmt " chunk
-   outputFile.write("fmt ", 4);
+   outputSink.Write("fmt ", 4);
    data = 16 + 2 + 12;
-   outputFile.write(reinterpret_cast<char*>(&data), 4);
+   outputSink.Write(&data, 4);
 
    // prepare and write format info with extra mp3 data
    MPEGLAYER3WAVEFORMAT fmt;
@@ -116,36 +116,33 @@ void Encoder::WriteWaveMp3Header(std::ofstream& outputFile, unsigned int numChan
    fmt.nFramesPerBlock = 1;
    fmt.nCodecDelay = codecDelay;
 
-   outputFile.write(reinterpret_cast<char*>(&fmt), sizeof(MPEGLAYER3WAVEFORMAT));
+   outputSink.Write(&fmt, sizeof(MPEGLAYER3WAVEFORMAT));
 
    // write "fact" chunk
-   outputFile.write("fact", 4);
+   outputSink.Write("fact", 4);
    data = 4;
-   outputFile.write(reinterpret_cast<char*>(&data), 4);
+   outputSink.Write(&data, 4);
    data = 0xffffffff; // number of samples: we don't know yet
-   outputFile.write(reinterpret_cast<char*>(&data), 4);
+   outputSink.Write(&data, 4);
 
    // write "data" chunk
-   outputFile.write("data", 4);
+   outputSink.Write("data", 4);
    data = 0xffffffff; // number of data bytes: we don't know yet
-   outputFile.write(reinterpret_cast<char*>(&data), 4);
+   outputSink.Write(&data, 4);
 }
 
-void Encoder::FixupWaveMp3Header(std::ofstream& outputFile, unsigned int dataLength,
+void Encoder::FixupWaveMp3Header(OutputSink& outputSink, unsigned int dataLength,
    unsigned int numSamples)
 {
    // whole riff file size
-   outputFile.seekp(4);
    unsigned int data = dataLength + 0x0046 - 8;
-   outputFile.write(reinterpret_cast<char*>(&data), 4);
+   outputSink.Overwrite(4, &data, 4);
 
    // "fact" chunk: sample size
-   outputFile.seekp(0x003a);
    data = numSamples;
-   outputFile.write(reinterpret_cast<char*>(&data), 4);
+   outputSink.Overwrite(0x003a, &data, 4);
 
    // "data" chunk: length
-   outputFile.seekp(0x0042);
    data = dataLength;
-   outputFile.write(reinterpret_cast<char*>(&data), 4);
+   outputSink.Overwrite(0x0042, &data, 4);
 }
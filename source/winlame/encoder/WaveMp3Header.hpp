@@ -21,26 +21,26 @@
 //
 #pragma once
 
-#include <iosfwd>
-
 namespace Encoder
 {
+   class OutputSink;
+
    // global functions
 
-   /// writes RIFF wave mp3 header to output stream
-   /// \param outputFile output file stream to write to
+   /// writes RIFF wave mp3 header to output sink
+   /// \param outputSink output sink to write to
    /// \param numChannels number of channels, either 1 or 2
    /// \param samplerateInHz mp3 file sample rate
    /// \param bitrateInBps bitrate of the mp3
    /// \param codecDelay codec sample delay when decoding
-   void WriteWaveMp3Header(std::ofstream& outputFile, unsigned int numChannels,
+   void WriteWaveMp3Header(OutputSink& outputSink, unsigned int numChannels,
       unsigned int samplerateInHz, unsigned int bitrateInBps, unsigned short codecDelay);
 
-   /// fixes fact chunk and riff header lengths; seeks around in the file
-   /// \param outputFile output file stream to write to
+   /// fixes fact chunk and riff header lengths by overwriting the header fields
+   /// \param outputSink output sink to write to
    /// \param dataLength number of mp3 data bytes written
    /// \param numSamples number of samples written
-   void FixupWaveMp3Header(std::ofstream& outputFile, unsigned int dataLength,
+   void FixupWaveMp3Header(OutputSink& outputSink, unsigned int dataLength,
       unsigned int numSamples);
 
 } // namespace Encoder
@@ -0,0 +1,42 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file WorkerPool.hpp
+/// \brief pool of worker threads shared by all running encoders
+//
+#pragma once
+
+#include <functional>
+
+namespace Encoder
+{
+   /// \brief pool of worker threads that an encoder can run parts of its work on
+   /// \details The pool is shared by all running encoders, so that the number of busy
+   /// threads doesn't grow with the number of encoders that split up their work.
+   class WorkerPool
+   {
+   public:
+      /// dtor
+      virtual ~WorkerPool() {}
+
+      /// \brief runs a work item on a free worker thread; returns false when no thread
+      /// is free, and the caller has to run the work item itself
+      virtual bool TryRun(std::function<void()> work) = 0;
+   };
+
+} // namespace Encoder
@@ -0,0 +1,113 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file WriteAlbumGainTask.cpp
+/// \brief Write album gain task class
+//
+#include "stdafx.h"
+#include "WriteAlbumGainTask.hpp"
+#include "LoudnessAnalyzer.hpp"
+#include "AudioFileTag.hpp"
+#include "TrackInfo.hpp"
+#include "resource.h"
+#include <ulib/Path.hpp>
+
+using Encoder::WriteAlbumGainTask;
+
+WriteAlbumGainTask::WriteAlbumGainTask(std::shared_ptr<LoudnessAlbum> album)
+   :m_album(album),
+   m_numFilesWritten(0),
+   m_numFiles(0),
+   m_finished(false),
+   m_stopped(false)
+{
+}
+
+TaskInfo WriteAlbumGainTask::GetTaskInfo()
+{
+   TaskInfo info(Id(), TaskInfo::taskWriteAlbumGain);
+
+   CString title;
+   title.LoadString(IDS_ALBUM_GAIN_TASK_TITLE);
+   info.Name(title);
+
+   CString description;
+   description.Format(IDS_ALBUM_GAIN_TASK_DESCRIPTION_U, m_numFiles.load());
+   info.Description(description);
+
+   unsigned int numFiles = m_numFiles;
+   info.Progress(m_finished || m_stopped ? 100 :
+      numFiles == 0 ? 0 : m_numFilesWritten * 100 / numFiles);
+
+   info.Status(
+      !ErrorText().IsEmpty() ? TaskInfo::statusError :
+      m_finished || m_stopped ? TaskInfo::statusCompleted :
+      IsStarted() ? TaskInfo::statusRunning : TaskInfo::statusWaiting);
+
+   return info;
+}
+
+void WriteAlbumGainTask::Run()
+{
+   if (m_stopped)
+      return;
+
+   m_finished = false;
+
+   // the tracks of the album are only known after all encoder tasks have run; tracks
+   // that failed to encode aren't part of the album
+   std::vector<CString> filenames = m_album->GetFilenames();
+   m_numFiles = static_cast<unsigned int>(filenames.size());
+
+   LoudnessResult albumResult = m_album->GetResult();
+
+   // all tracks are silent; there's no gain to store
+   if (!albumResult.m_isValid)
+   {
+      m_finished = true;
+      return;
+   }
+
+   TrackInfo trackInfo;
+   albumResult.StoreAlbumGain(trackInfo);
+
+   AudioFileTag tag{ trackInfo };
+
+   for (const CString& filename : filenames)
+   {
+      if (m_stopped)
+         break;
+
+      if (!tag.WriteReplayGainToFile(filename))
+      {
+         CString errorText;
+         errorText.Format(IDS_ALBUM_GAIN_TASK_ERROR_WRITE_S, Path::FilenameAndExt(filename).GetString());
+         SetTaskError(errorText);
+      }
+
+      m_numFilesWritten++;
+      PublishTaskInfo();
+   }
+
+   m_finished = true;
+}
+
+void WriteAlbumGainTask::Stop()
+{
+   m_stopped = true;
+}
@@ -0,0 +1,66 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file WriteAlbumGainTask.hpp
+/// \brief Write album gain task class
+//
+#pragma once
+
+#include "Task.hpp"
+#include <atomic>
+
+namespace Encoder
+{
+   class LoudnessAlbum;
+
+   /// Task to store the album gain in all encoded files of an album
+   class WriteAlbumGainTask : public Task
+   {
+   public:
+      /// ctor; the album is filled by the encoder tasks this task depends on
+      explicit WriteAlbumGainTask(std::shared_ptr<LoudnessAlbum> album);
+      /// dtor
+      virtual ~WriteAlbumGainTask() {}
+
+      /// returns current task info; must return immediately
+      virtual TaskInfo GetTaskInfo();
+
+      /// runs task; may take longer
+      virtual void Run();
+
+      /// task should be aborted, e.g. when program is closed
+      virtual void Stop();
+
+   private:
+      /// album with loudness of all encoded tracks
+      std::shared_ptr<LoudnessAlbum> m_album;
+
+      /// number of files the album gain was stored in so far
+      std::atomic<unsigned int> m_numFilesWritten;
+
+      /// number of files to store the album gain in; known when the task runs
+      std::atomic<unsigned int> m_numFiles;
+
+      /// indicates if task is already finished
+      std::atomic<bool> m_finished;
+
+      /// indicates if task was stopped
+      std::atomic<bool> m_stopped;
+   };
+
+} // namespace Encoder
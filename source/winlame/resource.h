@@ -213,6 +213,8 @@
 #define IDS_MAIN_TASKS_FILENAME_OR_TRACK_PLAYLIST 40133
 #define IDS_MAIN_TASKS_TASK_DETAILS_SELECT_TASK 40134
 #define IDS_MAIN_TASKS_TASKTYPE_EJECT_CD 40135
+#define IDS_MAIN_TASKS_TASKTYPE_ALBUM_GAIN 40136
+#define IDS_MAIN_TASKS_FILENAME_OR_TRACK_ALBUM_GAIN 40137
 #define IDS_AAC_NO_MPEG2_LTP            40200
 #define IDS_OGGV_QUALITY                40201
 #define IDS_OGGV_BITRATE                40202
@@ -296,6 +298,9 @@
 #define IDS_PLAYLIST_TASK_DESCRIPTION_SU 41613
 #define IDS_EJECT_CD_TASK_TITLE         41614
 #define IDS_EJECT_CD_TASK_DESCRIPTION   41615
+#define IDS_ALBUM_GAIN_TASK_TITLE       41616
+#define IDS_ALBUM_GAIN_TASK_DESCRIPTION_U 41617
+#define IDS_ALBUM_GAIN_TASK_ERROR_WRITE_S 41618
 #define IDS_FILTER_AAC_INPUT            41700
 #define IDS_FILTER_BASS_INPUT           41701
 #define IDS_FILTER_BASS_WMA_INPUT       41702
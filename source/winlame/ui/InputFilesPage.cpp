@@ -28,9 +28,16 @@
 #include "OutputSettingsPage.hpp"
 #include "ClassicModeStartPage.hpp"
 #include "RedrawLock.hpp"
+#include <chrono>
 
 using namespace UI;
 
+/// number of found files after which the scan thread updates the list
+const size_t c_numFilesPerUpdate = 256;
+
+/// time after which the scan thread updates the list with the files found so far
+const std::chrono::milliseconds c_updateInterval{ 100 };
+
 CString InputFilesPage::m_filterString;
 
 InputFilesPage::InputFilesPage(WizardPageHost& pageHost,
@@ -40,10 +47,18 @@ InputFilesPage::InputFilesPage(WizardPageHost& pageHost,
    m_pageWidth(0),
    m_uiSettings(IoCContainer::Current().Resolve<UISettings>()),
    m_setSysImageList(false),
-   m_inputFilesList(inputFilesList)
+   m_inputFilesList(inputFilesList),
+   m_isScanning(false),
+   m_leavePageAfterScan(false)
 {
 }
 
+InputFilesPage::~InputFilesPage()
+{
+   if (m_scanThread.joinable())
+      m_scanThread.join();
+}
+
 LRESULT InputFilesPage::OnInitDialog(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/)
 {
    DoDataExchange(DDX_LOAD);
@@ -73,6 +88,13 @@ LRESULT InputFilesPage::OnInitDialog(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*
 
 LRESULT InputFilesPage::OnButtonOK(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& bHandled)
 {
+   // files that are still being scanned must be encoded, too; leave page when done
+   if (m_isScanning)
+   {
+      m_leavePageAfterScan = true;
+      return 1; // prevent leaving dialog
+   }
+
    m_audioFileInfoManager.Stop();
 
    int max = m_listViewInputFiles.GetItemCount();
@@ -177,6 +199,47 @@ LRESULT InputFilesPage::OnUpdateAudioInfo(UINT uMsg, WPARAM wParam, LPARAM lPara
    return 0;
 }
 
+LRESULT InputFilesPage::OnInputFilesFound(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL& bHandled)
+{
+   std::unique_ptr<std::vector<CString>> foundFiles(reinterpret_cast<std::vector<CString>*>(lParam));
+
+   InsertFilenames(*foundFiles);
+
+   return 0;
+}
+
+LRESULT InputFilesPage::OnInputFilesParsed(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL& bHandled)
+{
+   std::unique_ptr<InputFilesParser> parser(reinterpret_cast<InputFilesParser*>(lParam));
+
+   // files of different folders were inserted in the order they were found
+   m_listViewInputFiles.ReorderFiles(parser->FileList());
+
+   if (!parser->PlaylistName().IsEmpty())
+   {
+      CString name = Path::FilenameOnly(parser->PlaylistName());
+      m_uiSettings.playlist_filename = name + _T(".m3u");
+   }
+
+   m_isScanning = false;
+
+   if (!m_pendingInputFilesLists.empty())
+   {
+      StartScanningFiles();
+      return 0;
+   }
+
+   if (m_leavePageAfterScan)
+   {
+      m_leavePageAfterScan = false;
+
+      BOOL handled = TRUE;
+      OnButtonOK(0, IDOK, nullptr, handled);
+   }
+
+   return 0;
+}
+
 LRESULT InputFilesPage::OnListItemChanged(int idCtrl, LPNMHDR pnmh, BOOL& bHandled)
 {
    // called when the selected item in the list changes
@@ -282,16 +345,65 @@ void InputFilesPage::ResizeListCtrlColumns(int dx)
 
 void InputFilesPage::AddFiles(const std::vector<CString>& inputFilesList)
 {
-   InputFilesParser parser;
-   parser.Parse(inputFilesList);
+   if (inputFilesList.empty())
+      return;
+
+   // files are scanned one list after another, so that they are inserted in order
+   m_pendingInputFilesLists.push_back(inputFilesList);
+
+   if (!m_isScanning)
+      StartScanningFiles();
+}
+
+void InputFilesPage::StartScanningFiles()
+{
+   // the last scan has already posted all its results
+   if (m_scanThread.joinable())
+      m_scanThread.join();
+
+   m_isScanning = true;
+
+   m_scanThread = std::thread(&InputFilesPage::ScanFiles, m_hWnd, m_pendingInputFilesLists.front());
+
+   m_pendingInputFilesLists.erase(m_pendingInputFilesLists.begin());
+}
+
+void InputFilesPage::ScanFiles(HWND hwndPage, const std::vector<CString>& inputFilesList)
+{
+   auto parser = std::make_unique<InputFilesParser>();
 
-   InsertFilenames(parser.FileList());
+   std::vector<CString> foundFiles;
+   auto lastUpdate = std::chrono::steady_clock::now();
 
-   if (!parser.PlaylistName().IsEmpty())
+   // the list can only be updated on the UI thread, so found files are posted in batches
+   auto postFoundFiles = [&]()
    {
-      CString name = Path::FilenameOnly(parser.PlaylistName());
-      m_uiSettings.playlist_filename = name + _T(".m3u");
-   }
+      if (foundFiles.empty())
+         return;
+
+      auto files = new std::vector<CString>(std::move(foundFiles));
+      foundFiles.clear();
+
+      if (!::PostMessage(hwndPage, WM_INPUT_FILES_FOUND, 0, reinterpret_cast<LPARAM>(files)))
+         delete files; // page was already closed
+
+      lastUpdate = std::chrono::steady_clock::now();
+   };
+
+   parser->Parse(inputFilesList, [&](const CString& filename)
+   {
+      foundFiles.push_back(filename);
+
+      if (foundFiles.size() >= c_numFilesPerUpdate ||
+         std::chrono::steady_clock::now() - lastUpdate >= c_updateInterval)
+         postFoundFiles();
+   });
+
+   postFoundFiles();
+
+   InputFilesParser* result = parser.release();
+   if (!::PostMessage(hwndPage, WM_INPUT_FILES_PARSED, 0, reinterpret_cast<LPARAM>(result)))
+      delete result;
 }
 
 void InputFilesPage::InsertFilenames(const std::vector<CString>& inputFilesList)
@@ -25,17 +25,26 @@
 #include "InputListCtrl.hpp"
 #include "AudioFileInfoManager.hpp"
 #include "resource.h"
+#include <thread>
 
 /// window message used to update audio info for a file
 #define WM_UPDATE_AUDIO_INFO (WM_APP + 4)
 
+/// window message used to insert files found while scanning input files
+#define WM_INPUT_FILES_FOUND (WM_APP + 5)
+
+/// window message sent when scanning input files has finished
+#define WM_INPUT_FILES_PARSED (WM_APP + 6)
+
 struct UISettings;
+class InputFilesParser;
 
 namespace UI
 {
    /// \brief Input files page
    /// \details shows all files opened/dropped, checks them for audio infos and errors
-   /// and displays them; processing is done in separate thread.
+   /// and displays them; processing is done in separate thread. Folders are scanned on
+   /// a separate thread, too, and files are inserted into the list while scanning.
    class InputFilesPage :
       public WizardPage,
       public CWinDataExchange<InputFilesPage>,
@@ -45,10 +54,8 @@ namespace UI
       /// ctor
       InputFilesPage(WizardPageHost& pageHost,
          const std::vector<CString>& inputFilesList);
-      /// dtor
-      ~InputFilesPage()
-      {
-      }
+      /// dtor; waits for scanning input files to finish
+      ~InputFilesPage();
 
       /// opens file dialog and returns all files selected
       static bool OpenFileDialog(HWND hwndParent, std::vector<CString>& filenamesList);
@@ -73,6 +80,8 @@ namespace UI
          MESSAGE_HANDLER(WM_KEYDOWN, OnKeyDown)
          MESSAGE_HANDLER(WM_SIZE, OnSize)
          MESSAGE_HANDLER(WM_UPDATE_AUDIO_INFO, OnUpdateAudioInfo)
+         MESSAGE_HANDLER(WM_INPUT_FILES_FOUND, OnInputFilesFound)
+         MESSAGE_HANDLER(WM_INPUT_FILES_PARSED, OnInputFilesParsed)
          NOTIFY_HANDLER(IDC_INPUT_LIST_INPUTFILES, LVN_ITEMCHANGED, OnListItemChanged)
          NOTIFY_HANDLER(IDC_INPUT_LIST_INPUTFILES, NM_DBLCLK, OnDoubleClickedList)
          COMMAND_HANDLER(IDC_INPUT_BUTTON_PLAY, BN_CLICKED, OnButtonPlay)
@@ -109,6 +118,12 @@ namespace UI
       /// called when audio info for a file was updated
       LRESULT OnUpdateAudioInfo(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL& bHandled);
 
+      /// called when files were found while scanning input files
+      LRESULT OnInputFilesFound(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL& bHandled);
+
+      /// called when scanning input files has finished
+      LRESULT OnInputFilesParsed(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL& bHandled);
+
       /// called when the selected item in the list ctrl changes
       LRESULT OnListItemChanged(int idCtrl, LPNMHDR pnmh, BOOL& bHandled);
 
@@ -129,9 +144,15 @@ namespace UI
       /// resizes list view columns
       void ResizeListCtrlColumns(int cx);
 
-      /// adds files to list
+      /// adds files to list; folders are scanned on a separate thread
       void AddFiles(const std::vector<CString>& inputFilesList);
 
+      /// starts scanning the next pending input files on the scan thread
+      void StartScanningFiles();
+
+      /// scans input files and posts found files to the page; runs on the scan thread
+      static void ScanFiles(HWND hwndPage, const std::vector<CString>& inputFilesList);
+
       /// insert new file names into list
       void InsertFilenames(const std::vector<CString>& inputFilesList);
 
@@ -167,6 +188,18 @@ namespace UI
       /// list of passed filenames; cleared after inserting into list
       std::vector<CString> m_inputFilesList;
 
+      /// input files added while the scan thread was busy, to scan next
+      std::vector<std::vector<CString>> m_pendingInputFilesLists;
+
+      /// thread scanning input files
+      std::thread m_scanThread;
+
+      /// indicates if the scan thread is scanning input files
+      bool m_isScanning;
+
+      /// indicates if the page is left as soon as scanning has finished
+      bool m_leavePageAfterScan;
+
       /// indicates if system image list was already set on list control
       bool m_setSysImageList;
 
@@ -21,6 +21,7 @@
 //
 #include "stdafx.h"
 #include "InputListCtrl.hpp"
+#include <map>
 
 /// darker color for alternate lines list control
 COLORREF g_clrAlternateListColor = RGB(232, 232, 232);
@@ -166,6 +167,42 @@ void InputListCtrl::UpdateAudioFileInfo(const AudioFileEntry& updatedEntry)
    }
 }
 
+void InputListCtrl::ReorderFiles(const std::vector<CString>& filenames)
+{
+   // position of each file; a file listed more than once keeps its first position
+   std::map<CString, size_t> mapFilePositions;
+   for (size_t i = 0, iMax = filenames.size(); i < iMax; i++)
+      mapFilePositions.insert(std::make_pair(filenames[i], i));
+
+   // files not in the list keep their position, before all files in the list
+   int max = GetItemCount();
+
+   std::map<LPARAM, size_t> mapItemRanks;
+   for (int i = 0; i < max; i++)
+   {
+      AudioFileEntry* entry = reinterpret_cast<AudioFileEntry*>(GetItemData(i));
+
+      auto iter = mapFilePositions.find(entry->filename);
+      mapItemRanks[reinterpret_cast<LPARAM>(entry)] =
+         iter == mapFilePositions.end() ? i : max + iter->second;
+   }
+
+   SortItems(InputListCtrl::RankCompare,
+      reinterpret_cast<LPARAM>(&mapItemRanks));
+}
+
+int InputListCtrl::RankCompare(LPARAM lParam1, LPARAM lParam2,
+   LPARAM lParamSort)
+{
+   const std::map<LPARAM, size_t>& mapItemRanks =
+      *reinterpret_cast<const std::map<LPARAM, size_t>*>(lParamSort);
+
+   size_t rank1 = mapItemRanks.at(lParam1);
+   size_t rank2 = mapItemRanks.at(lParam2);
+
+   return rank1 < rank2 ? -1 : rank1 > rank2 ? 1 : 0;
+}
+
 int InputListCtrl::SortCompare(LPARAM lParam1, LPARAM lParam2,
    LPARAM lParamSort)
 {
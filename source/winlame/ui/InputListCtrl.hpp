@@ -66,6 +66,10 @@ namespace UI
       /// updates audio file infos about one file
       void UpdateAudioFileInfo(const AudioFileEntry& entry);
 
+      /// \brief moves the given files to the end of the list, in the given order
+      /// \details used when files were inserted in a different order than they should be encoded
+      void ReorderFiles(const std::vector<CString>& filenames);
+
    private:
       // message map
       BEGIN_MSG_MAP(InputListCtrl)
@@ -131,6 +135,10 @@ namespace UI
       static int CALLBACK SortCompare(LPARAM lParam1, LPARAM lParam2,
          LPARAM lParamSort);
 
+      /// compare function for sorting by rank; lParamSort points to a map from entry to rank
+      static int CALLBACK RankCompare(LPARAM lParam1, LPARAM lParam2,
+         LPARAM lParamSort);
+
       /// sets audio infos for given item
       void SetItemAudioInfos(int iItem, int length, int bitrate, int samplerate);
 
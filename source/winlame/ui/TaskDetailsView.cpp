@@ -98,6 +98,7 @@ CString TaskDetailsView::TaskTypeFromInfo(const TaskInfo& info)
    case TaskInfo::taskCdExtraction: resourceID = IDS_MAIN_TASKS_TASKTYPE_CDREAD; break;
    case TaskInfo::taskWritePlaylist: resourceID = IDS_MAIN_TASKS_TASKTYPE_PLAYLIST; break;
    case TaskInfo::taskEjectCD: resourceID = IDS_MAIN_TASKS_TASKTYPE_EJECT_CD; break;
+   case TaskInfo::taskWriteAlbumGain: resourceID = IDS_MAIN_TASKS_TASKTYPE_ALBUM_GAIN; break;
    case TaskInfo::taskUnknown:
    default:
       ATLASSERT(false);
@@ -115,6 +116,7 @@ CString TaskDetailsView::LabelFilenameOrTrackFromInfo(const TaskInfo& info)
    case TaskInfo::taskEncoding: resourceID = IDS_MAIN_TASKS_FILENAME_OR_TRACK_ENCODE; break;
    case TaskInfo::taskCdExtraction: resourceID = IDS_MAIN_TASKS_FILENAME_OR_TRACK_CDREAD; break;
    case TaskInfo::taskWritePlaylist: resourceID = IDS_MAIN_TASKS_FILENAME_OR_TRACK_PLAYLIST; break;
+   case TaskInfo::taskWriteAlbumGain: resourceID = IDS_MAIN_TASKS_FILENAME_OR_TRACK_ALBUM_GAIN; break;
    case TaskInfo::taskUnknown:
    default:
       ATLASSERT(false);
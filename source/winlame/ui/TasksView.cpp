@@ -25,7 +25,7 @@
 #include "TaskManager.hpp"
 #include "TaskInfo.hpp"
 #include "RedrawLock.hpp"
-#include <set>
+#include <algorithm>
 
 using UI::TasksView;
 
@@ -47,6 +47,17 @@ const int c_progressColumn = 1;
 /// index of status column
 const int c_statusColumn = 2;
 
+TasksView::TasksView(TaskManager& taskManager)
+   :m_taskManager(taskManager),
+   m_taskChangesConsumerId(taskManager.RegisterTaskChangesConsumer())
+{
+}
+
+TasksView::~TasksView()
+{
+   m_taskManager.UnregisterTaskChangesConsumer(m_taskChangesConsumerId);
+}
+
 BOOL TasksView::PreTranslateMessage(MSG* /*msg*/)
 {
    return FALSE;
@@ -124,70 +135,72 @@ void TasksView::Init(bool useLargeNameColumn)
 
 void TasksView::UpdateTasks()
 {
-   int topIndex = GetTopIndex();
+   // only the tasks that changed since the last update are updated; the items keep their
+   // selection and scroll position
+   std::vector<TaskInfo> changedTaskInfos;
+   std::vector<unsigned int> removedTaskIds;
 
-   std::set<int> selectedTaskIds;
-   {
-      int selectedItemIndex = GetNextItem(-1, LVNI_SELECTED);
-      while (selectedItemIndex != -1)
-      {
-         selectedTaskIds.insert(static_cast<int>(GetItemData(selectedItemIndex)));
+   unsigned long long version = m_taskManager.GetTaskChanges(m_taskChangesConsumerId, m_taskChangesVersion,
+      changedTaskInfos, removedTaskIds);
 
-         selectedItemIndex = GetNextItem(selectedItemIndex, LVNI_SELECTED);
-      }
-   }
+   if (version == m_taskChangesVersion && GetItemCount() > 0)
+      return; // nothing changed
 
-   std::set<int> itemIndicesToSelect;
+   m_taskChangesVersion = version;
 
    RedrawLock lock(*this);
-   DeleteAllItems();
 
-   std::vector<TaskInfo> taskInfoList = m_taskManager.CurrentTasks();
+   // remove "no task" item
+   if (m_taskIds.empty())
+      DeleteAllItems();
 
-   if (taskInfoList.empty())
+   for (unsigned int taskId : removedTaskIds)
    {
-      int itemIndex = InsertItem(0, CString(MAKEINTRESOURCE(IDS_MAIN_TASKS_VIEW_NO_TASK)));
-      SetItemData(itemIndex, c_itemIdNoData);
+      auto iter = std::lower_bound(m_taskIds.begin(), m_taskIds.end(), taskId);
+      if (iter == m_taskIds.end() || *iter != taskId)
+         continue; // task was never shown
 
-      return;
+      DeleteItem(static_cast<int>(iter - m_taskIds.begin()));
+      m_taskIds.erase(iter);
    }
 
-   for (size_t infoIndex = 0, maxInfoIndex = taskInfoList.size(); infoIndex < maxInfoIndex; infoIndex++)
+   for (const TaskInfo& info : changedTaskInfos)
    {
-      const TaskInfo& info = taskInfoList[infoIndex];
-
-      int itemIndex = InsertItem(GetItemCount(), info.Name(), IconFromTaskType(info));
-      SetItemData(itemIndex, info.Id());
-
-      CString progressText;
-      progressText.Format(IDS_MAIN_TASKS_PERCENT_DONE_U, info.Progress());
+      // task ids are increasing, so new tasks are appended in most cases
+      auto iter = std::lower_bound(m_taskIds.begin(), m_taskIds.end(), info.Id());
+      int itemIndex = static_cast<int>(iter - m_taskIds.begin());
 
-      SetItemText(itemIndex, c_progressColumn, progressText);
-
-      CString statusText = StatusTextFromStatus(info.Status());
-      SetItemText(itemIndex, c_statusColumn, statusText);
-
-      // select item when previously selected
-      if (selectedTaskIds.find(info.Id()) != selectedTaskIds.end())
+      if (iter == m_taskIds.end() || *iter != info.Id())
       {
-         itemIndicesToSelect.insert(itemIndex);
+         itemIndex = InsertItem(itemIndex, info.Name(), IconFromTaskType(info));
+         SetItemData(itemIndex, info.Id());
+
+         m_taskIds.insert(iter, info.Id());
       }
-   }
 
-   for (auto iter = itemIndicesToSelect.begin(); iter != itemIndicesToSelect.end(); iter++)
-   {
-      int itemIndex = *iter;
-      SetItemState(itemIndex, LVIS_SELECTED, LVIS_SELECTED);
+      UpdateTaskItem(itemIndex, info);
    }
 
-   if (topIndex > 0 && topIndex < GetItemCount())
+   if (m_taskIds.empty())
    {
-      // first scroll to the end, then back up to the previous top index
-      EnsureVisible(GetItemCount()-1, false);
-      EnsureVisible(topIndex, false);
+      int itemIndex = InsertItem(0, CString(MAKEINTRESOURCE(IDS_MAIN_TASKS_VIEW_NO_TASK)));
+      SetItemData(itemIndex, c_itemIdNoData);
    }
 }
 
+void TasksView::UpdateTaskItem(int itemIndex, const TaskInfo& info)
+{
+   SetItemText(itemIndex, c_nameColumn, info.Name());
+
+   CString progressText;
+   progressText.Format(IDS_MAIN_TASKS_PERCENT_DONE_U, info.Progress());
+
+   SetItemText(itemIndex, c_progressColumn, progressText);
+
+   CString statusText = StatusTextFromStatus(info.Status());
+   SetItemText(itemIndex, c_statusColumn, statusText);
+}
+
 CString TasksView::StatusTextFromStatus(TaskInfo::TaskStatus status)
 {
    switch (status)
@@ -214,6 +227,7 @@ int TasksView::IconFromTaskType(const TaskInfo& info)
    case TaskInfo::taskCdExtraction: return 2;
    case TaskInfo::taskWritePlaylist: return 3;
    case TaskInfo::taskEjectCD: return 2;
+   case TaskInfo::taskWriteAlbumGain: return 3;
    case TaskInfo::taskUnknown:
    default:
       ATLASSERT(false);
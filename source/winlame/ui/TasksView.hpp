@@ -45,10 +45,10 @@ namespace UI
       typedef std::function<void(size_t clickedIndex)> T_fnOnClickedTask;
 
       /// ctor
-      explicit TasksView(TaskManager& taskManager)
-         :m_taskManager(taskManager)
-      {
-      }
+      explicit TasksView(TaskManager& taskManager);
+
+      /// dtor
+      ~TasksView();
 
       /// initialize tasks view list
       void Init(bool useLargeNameColumn = true);
@@ -87,6 +87,9 @@ namespace UI
    private:
       friend class TaskDetailsView;
 
+      /// updates texts of list item with task info
+      void UpdateTaskItem(int itemIndex, const TaskInfo& info);
+
       /// returns status text from task status
       static CString StatusTextFromStatus(TaskInfo::TaskStatus status);
 
@@ -102,6 +105,15 @@ namespace UI
       /// "clicked task" handler
       T_fnOnClickedTask m_fnOnClickedTask;
 
+      /// consumer id for getting task changes from the task manager
+      unsigned int m_taskChangesConsumerId;
+
+      /// version of the task changes shown in the list
+      unsigned long long m_taskChangesVersion = 0;
+
+      /// ids of all tasks shown in the list, in the order of the list items
+      std::vector<unsigned int> m_taskIds;
+
       // UI
 
       /// task list images
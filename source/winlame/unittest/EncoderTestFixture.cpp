@@ -66,15 +66,7 @@ void EncoderTestFixture::StartEncodeAndWaitForFinish(Encoder::EncoderImpl& encod
 {
    encoder.StartEncode();
 
-   // wait for encoding to finish
-   bool isRunning = false;
-   do
-   {
-      Encoder::EncoderState state = encoder.GetEncoderState();
-      isRunning = state.m_running;
-      Sleep(10);
-
-   } while (isRunning);
+   encoder.WaitForFinish();
 
    encoder.StopEncode();
 }
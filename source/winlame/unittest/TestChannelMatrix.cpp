@@ -0,0 +1,214 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestChannelMatrix.cpp
+/// \brief Tests channel remapping and downmixing with the channel matrix
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "ChannelMatrix.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using Encoder::ChannelMatrix;
+using Encoder::ChannelRemapper;
+using Encoder::SampleConverter;
+
+namespace unittest
+{
+   /// tests for ChannelMatrix class
+   TEST_CLASS(TestChannelMatrix)
+   {
+   public:
+      /// resets instruction set after each test
+      TEST_METHOD_CLEANUP(TearDown)
+      {
+         SampleConverter::SetInstructionSet(SampleConverter::GetSupportedInstructionSet());
+      }
+
+      /// tests that input and output channel maps of a codec undo each other
+      TEST_METHOD(TestChannelMapsRoundTrip)
+      {
+         const std::pair<Encoder::T_enChannelMapType, Encoder::T_enChannelMapType> channelMapTypes[] =
+         {
+            { Encoder::aacInputChannelMap, Encoder::aacOutputChannelMap },
+            { Encoder::oggVorbisInputChannelMap, Encoder::oggVorbisOutputChannelMap },
+         };
+
+         for (const auto& channelMapType : channelMapTypes)
+         {
+            for (size_t numChannels = 1; numChannels <= 12; numChannels++)
+            {
+               ChannelMatrix inputMatrix = ChannelMatrix::FromChannelMapType(channelMapType.first, numChannels);
+               ChannelMatrix outputMatrix = ChannelMatrix::FromChannelMapType(channelMapType.second, numChannels);
+
+               Assert::IsTrue(outputMatrix.Multiply(inputMatrix).IsIdentity(), _T("channel maps must undo each other"));
+            }
+         }
+
+         // channel counts without a channel map are passed through
+         Assert::IsTrue(ChannelMatrix::FromChannelMapType(Encoder::oggVorbisInputChannelMap, 12).IsIdentity(),
+            _T("12 channels must be passed through"));
+      }
+
+      /// tests remapping without sample type conversion
+      TEST_METHOD(TestRemap)
+      {
+         const size_t numChannels = 8;
+         const size_t numSamples = 1000;
+
+         std::vector<short> input(numSamples * numChannels);
+         for (size_t index = 0; index < input.size(); index++)
+            input[index] = static_cast<short>(index);
+
+         ChannelMatrix matrix = ChannelMatrix::FromChannelMapType(Encoder::aacInputChannelMap, numChannels);
+
+         std::vector<short> output(input.size());
+         matrix.ApplyInterleaved(input.data(), Encoder::SampleTypeInt16, output.data(), Encoder::SampleTypeInt16, numSamples);
+
+         for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+            for (size_t channel = 0; channel < numChannels; channel++)
+            {
+               size_t inputChannel = ChannelRemapper::GetMappedChannel(Encoder::aacInputChannelMap, numChannels, channel);
+
+               Assert::AreEqual(input[sampleIndex * numChannels + inputChannel], output[sampleIndex * numChannels + channel],
+                  _T("sample must be copied from mapped channel"));
+            }
+      }
+
+      /// tests remapping and converting sample types in one pass
+      TEST_METHOD(TestRemapWithConversion)
+      {
+         const size_t numChannels = 6;
+         const size_t numSamples = 700;
+
+         std::vector<short> input(numSamples * numChannels);
+         for (size_t index = 0; index < input.size(); index++)
+            input[index] = static_cast<short>(index * 16);
+
+         ChannelMatrix matrix = ChannelMatrix::FromChannelMapType(Encoder::oggVorbisOutputChannelMap, numChannels);
+
+         std::vector<float> output(input.size());
+         matrix.ApplyInterleaved(input.data(), Encoder::SampleTypeInt16, output.data(), Encoder::SampleTypeFloat32, numSamples);
+
+         for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+            for (size_t channel = 0; channel < numChannels; channel++)
+            {
+               size_t inputChannel = ChannelRemapper::GetMappedChannel(Encoder::oggVorbisOutputChannelMap, numChannels, channel);
+
+               Assert::AreEqual(input[sampleIndex * numChannels + inputChannel] / 32768.0f, output[sampleIndex * numChannels + channel],
+                  _T("sample must be converted from mapped channel"));
+            }
+      }
+
+      /// tests remapping 16 and 32 bit samples, for all instruction sets and channel counts
+      TEST_METHOD(TestRemapAllInstructionSets)
+      {
+         for (Encoder::SampleType sampleType : { Encoder::SampleTypeInt16, Encoder::SampleTypeInt32 })
+         {
+            const size_t sampleSize = SampleConverter::GetSampleSize(sampleType);
+
+            for (size_t numInputChannels = 1; numInputChannels <= 10; numInputChannels++)
+            {
+               // remap to reversed channels, and select every other channel
+               for (size_t numOutputChannels : { numInputChannels, (numInputChannels + 1) / 2 })
+               {
+                  ChannelMatrix matrix(numInputChannels, numOutputChannels);
+                  for (size_t channel = 0; channel < numOutputChannels; channel++)
+                  {
+                     size_t inputChannel = numOutputChannels == numInputChannels
+                        ? numInputChannels - 1 - channel
+                        : channel * 2;
+
+                     matrix.SetCoefficient(channel, inputChannel, 1.0f);
+                  }
+
+                  for (size_t numSamples : { 1, 7, 1001 })
+                  {
+                     std::vector<unsigned char> input(numSamples * numInputChannels * sampleSize);
+                     for (size_t index = 0; index < input.size(); index++)
+                        input[index] = static_cast<unsigned char>(index * 7 + index / 251);
+
+                     for (int instructionSet = Encoder::instructionSetScalar;
+                        instructionSet <= SampleConverter::GetSupportedInstructionSet();
+                        instructionSet++)
+                     {
+                        SampleConverter::SetInstructionSet(Encoder::SampleConverterInstructionSet(instructionSet));
+
+                        std::vector<unsigned char> output(numSamples * numOutputChannels * sampleSize);
+                        matrix.ApplyInterleaved(input.data(), sampleType, output.data(), sampleType, numSamples);
+
+                        for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+                           for (size_t channel = 0; channel < numOutputChannels; channel++)
+                           {
+                              size_t inputChannel = numOutputChannels == numInputChannels
+                                 ? numInputChannels - 1 - channel
+                                 : channel * 2;
+
+                              Assert::IsTrue(0 == memcmp(
+                                 &output[(sampleIndex * numOutputChannels + channel) * sampleSize],
+                                 &input[(sampleIndex * numInputChannels + inputChannel) * sampleSize],
+                                 sampleSize),
+                                 _T("sample must be copied from mapped channel"));
+                           }
+                     }
+                  }
+               }
+            }
+         }
+      }
+
+      /// tests downmixing 7.1.4 channels to stereo, for all instruction sets
+      TEST_METHOD(TestDownmix)
+      {
+         const size_t numInputChannels = 12;
+         const size_t numSamples = 1001;
+
+         ChannelMatrix matrix(numInputChannels, 2);
+         for (size_t channel = 0; channel < numInputChannels; channel++)
+         {
+            matrix.SetCoefficient(channel % 2, channel, 0.1f);
+            if (channel == 2)
+               matrix.SetCoefficient(1, channel, 0.05f);
+         }
+
+         std::vector<float> input(numSamples * numInputChannels);
+         for (size_t index = 0; index < input.size(); index++)
+            input[index] = float(index % 97) / 97.0f - 0.5f;
+
+         for (int instructionSet = Encoder::instructionSetScalar;
+            instructionSet <= SampleConverter::GetSupportedInstructionSet();
+            instructionSet++)
+         {
+            SampleConverter::SetInstructionSet(Encoder::SampleConverterInstructionSet(instructionSet));
+
+            std::vector<float> output(numSamples * 2);
+            matrix.ApplyInterleaved(input.data(), Encoder::SampleTypeFloat32, output.data(), Encoder::SampleTypeFloat32, numSamples);
+
+            for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+               for (size_t outputChannel = 0; outputChannel < 2; outputChannel++)
+               {
+                  float expected = 0.0f;
+                  for (size_t inputChannel = 0; inputChannel < numInputChannels; inputChannel++)
+                     expected += input[sampleIndex * numInputChannels + inputChannel] * matrix.GetCoefficient(outputChannel, inputChannel);
+
+                  Assert::AreEqual(expected, output[sampleIndex * 2 + outputChannel], 1e-5f, _T("downmixed sample must match"));
+               }
+         }
+      }
+   };
+}
@@ -0,0 +1,181 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestDirectoryMirror.cpp
+/// \brief Tests mirroring a source folder tree to a target folder tree
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "DirectoryMirror.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for DirectoryMirror class
+   TEST_CLASS(TestDirectoryMirror)
+   {
+   public:
+      /// tests that only added and changed source files are returned, and that outputs
+      /// of removed source files are deleted
+      TEST_METHOD(TestScanChanges)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString sourceFolder = Path::Combine(folder.FolderName(), _T("source"));
+         CString targetFolder = Path::Combine(folder.FolderName(), _T("target"));
+
+         WriteFile(sourceFolder, _T("track1.wav"), "track 1");
+         WriteFile(sourceFolder, _T("album\\track2.wav"), "track 2");
+         WriteFile(sourceFolder, _T("album\\cover.jpg"), "cover");
+
+         // first run returns all files, with output folders in the target tree
+         Encoder::DirectoryMirror mirror(sourceFolder, targetFolder);
+         Assert::IsTrue(mirror.Load(), _T("loading missing index must succeed"));
+
+         std::vector<CString> deletedOutputFilenames;
+         std::vector<Encoder::DirectoryMirror::SourceFile> sourceFiles = mirror.Scan(1, deletedOutputFilenames);
+
+         Assert::AreEqual(size_t(3), sourceFiles.size(), _T("all source files must be returned"));
+         Assert::IsTrue(deletedOutputFilenames.empty(), _T("no output files must be deleted"));
+
+         for (const auto& sourceFile : sourceFiles)
+         {
+            CString relativeFolder = sourceFile.m_inputFilename.Find(_T("\\album\\")) != -1 ? _T("\\album") : _T("");
+            Assert::IsTrue(sourceFile.m_outputFolder == targetFolder + relativeFolder,
+               _T("output folder must mirror source folder"));
+
+            // the cover isn't encoded
+            CString outputFilename;
+            if (sourceFile.m_inputFilename.Find(_T("cover")) == -1)
+            {
+               outputFilename = Path::Combine(sourceFile.m_outputFolder,
+                  Path::FilenameOnly(sourceFile.m_inputFilename) + _T(".mp3"));
+               WriteFile(outputFilename, CString(), "output");
+            }
+
+            mirror.SetEncoded(sourceFile, outputFilename);
+         }
+
+         Assert::AreEqual(size_t(3), mirror.GetNumSourceFiles(), _T("index must contain all source files"));
+
+         // second run, with the loaded index, returns nothing
+         {
+            Encoder::DirectoryMirror mirror2(sourceFolder, targetFolder);
+            Assert::IsTrue(mirror2.Load(), _T("loading index must succeed"));
+
+            Assert::IsTrue(mirror2.Scan(1, deletedOutputFilenames).empty(), _T("unchanged source files must not be returned"));
+         }
+
+         // changed settings return all files again
+         Assert::AreEqual(size_t(3), mirror.Scan(2, deletedOutputFilenames).size(), _T("all files must be returned for other settings"));
+         Assert::IsTrue(mirror.Scan(1, deletedOutputFilenames).empty(), _T("no files must be returned for the stored settings"));
+
+         // changed source file and missing output file
+         WriteFile(sourceFolder, _T("track1.wav"), "track 1, remastered");
+         DeleteFile(Path::Combine(targetFolder, _T("album\\track2.mp3")));
+
+         sourceFiles = mirror.Scan(1, deletedOutputFilenames);
+         Assert::AreEqual(size_t(2), sourceFiles.size(), _T("changed file and file with missing output must be returned"));
+
+         // removed source files
+         DeleteFile(Path::Combine(sourceFolder, _T("track1.wav")));
+
+         sourceFiles = mirror.Scan(1, deletedOutputFilenames);
+         Assert::AreEqual(size_t(1), deletedOutputFilenames.size(), _T("output of removed file must be deleted"));
+         Assert::IsFalse(Path::FileExists(Path::Combine(targetFolder, _T("track1.mp3"))), _T("output file must not exist anymore"));
+      }
+
+      /// tests that folders of deleted output files are removed when empty
+      TEST_METHOD(TestRemoveEmptyFolders)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString sourceFolder = Path::Combine(folder.FolderName(), _T("source"));
+         CString targetFolder = Path::Combine(folder.FolderName(), _T("target"));
+
+         CString inputFilename = WriteFile(sourceFolder, _T("artist\\album\\track.wav"), "track");
+         CString outputFilename = WriteFile(targetFolder, _T("artist\\album\\track.mp3"), "output");
+
+         Encoder::DirectoryMirror mirror(sourceFolder, targetFolder);
+         Assert::IsTrue(mirror.Load(), _T("loading missing index must succeed"));
+
+         std::vector<CString> deletedOutputFilenames;
+         std::vector<Encoder::DirectoryMirror::SourceFile> sourceFiles = mirror.Scan(1, deletedOutputFilenames);
+         Assert::AreEqual(size_t(1), sourceFiles.size(), _T("source file must be returned"));
+
+         mirror.SetEncoded(sourceFiles[0], outputFilename);
+
+         DeleteFile(inputFilename);
+
+         Assert::IsTrue(mirror.Scan(1, deletedOutputFilenames).empty(), _T("no source files must be returned"));
+         Assert::AreEqual(size_t(1), deletedOutputFilenames.size(), _T("output file must be deleted"));
+
+         Assert::IsFalse(Path::FolderExists(Path::Combine(targetFolder, _T("artist"))), _T("empty folders must be removed"));
+         Assert::IsTrue(Path::FolderExists(targetFolder), _T("target folder must be kept"));
+      }
+
+      /// tests that a source file changed while it is encoded is returned by the next scan
+      TEST_METHOD(TestSourceChangedWhileEncoding)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString sourceFolder = Path::Combine(folder.FolderName(), _T("source"));
+         CString targetFolder = Path::Combine(folder.FolderName(), _T("target"));
+
+         WriteFile(sourceFolder, _T("track.wav"), "track");
+
+         Encoder::DirectoryMirror mirror(sourceFolder, targetFolder);
+         Assert::IsTrue(mirror.Load(), _T("loading missing index must succeed"));
+
+         std::vector<CString> deletedOutputFilenames;
+         std::vector<Encoder::DirectoryMirror::SourceFile> sourceFiles = mirror.Scan(1, deletedOutputFilenames);
+         Assert::AreEqual(size_t(1), sourceFiles.size(), _T("source file must be returned"));
+
+         // the source file changes after scanning, before encoding has finished
+         WriteFile(sourceFolder, _T("track.wav"), "track, edited while encoding");
+
+         CString outputFilename = WriteFile(targetFolder, _T("track.mp3"), "output");
+         mirror.SetEncoded(sourceFiles[0], outputFilename);
+
+         sourceFiles = mirror.Scan(1, deletedOutputFilenames);
+         Assert::AreEqual(size_t(1), sourceFiles.size(), _T("changed source file must be returned again"));
+
+         // the second encoding covers the current file
+         mirror.SetEncoded(sourceFiles[0], outputFilename);
+         Assert::IsTrue(mirror.Scan(1, deletedOutputFilenames).empty(), _T("unchanged source file must not be returned"));
+      }
+
+   private:
+      /// writes a file with given content, creating its folder; returns the filename
+      static CString WriteFile(const CString& folder, const CString& relativePath, const std::string& content)
+      {
+         CString filename = relativePath.IsEmpty() ? folder : Path::Combine(folder, relativePath);
+
+         Path::CreateDirectoryRecursive(Path::FolderName(filename));
+
+         std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+         file << content;
+
+         return filename;
+      }
+   };
+}
@@ -28,6 +28,11 @@
 #include "EncoderImpl.hpp"
 #include "ModuleManager.hpp"
 #include "ModuleManagerImpl.hpp"
+#include "OutputSink.hpp"
+#include "WorkerPool.hpp"
+#include <atomic>
+#include <cmath>
+#include <thread>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -73,5 +78,267 @@ namespace unittest
          // output file must exist
          Assert::IsTrue(Path::FileExists(encoderSettings.m_outputFilename), _T("output file must exist"));
       }
+
+      /// tests encoding with decoding running on a separate thread
+      TEST_METHOD(TestEncodePipelined)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.mp3"));
+         ExtractFromResource(IDR_SAMPLE_MP3, filename);
+
+         // encode file
+         Encoder::EncoderImpl encoder;
+
+         Encoder::EncoderSettings encoderSettings;
+         encoderSettings.m_inputFilename = filename;
+         encoderSettings.m_outputFilename = Path::Combine(folder.FolderName(), _T("output.mp3"));
+         encoderSettings.m_outputModuleID = ID_OM_LAME; // encode to LAME mp3
+         encoderSettings.m_pipelinedEncoding = true;
+
+         encoder.SetEncoderSettings(encoderSettings);
+
+         SettingsManager settingsManager;
+         settingsManager.setValue(LameSimpleQualityOrBitrate, 0);
+         settingsManager.setValue(LameSimpleEncodeQuality, 1);
+         settingsManager.setValue(LameSimpleQuality, 4);
+
+         encoder.SetSettingsManager(&settingsManager);
+
+         StartEncodeAndWaitForFinish(encoder);
+
+         // encoding must succeed, and output file must exist
+         Assert::AreEqual(0, encoder.GetEncoderState().m_errorCode.load(), _T("encoding must not report an error"));
+         Assert::IsTrue(encoder.GetAllErrorInfos().empty(), _T("there must be no error infos"));
+         Assert::IsTrue(Path::FileExists(encoderSettings.m_outputFilename), _T("output file must exist"));
+      }
+
+      /// tests encoding with segments of the input encoded in parallel
+      TEST_METHOD(TestEncodeParallel)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.mp3"));
+         ExtractFromResource(IDR_SAMPLE_MP3, filename);
+
+         // encode file
+         Encoder::EncoderImpl encoder;
+
+         Encoder::EncoderSettings encoderSettings;
+         encoderSettings.m_inputFilename = filename;
+         encoderSettings.m_outputFilename = Path::Combine(folder.FolderName(), _T("output.mp3"));
+         encoderSettings.m_outputModuleID = ID_OM_LAME; // encode to LAME mp3
+
+         encoder.SetEncoderSettings(encoderSettings);
+
+         SettingsManager settingsManager;
+         settingsManager.setValue(LameSimpleQualityOrBitrate, 0);
+         settingsManager.setValue(LameSimpleEncodeQuality, 1);
+         settingsManager.setValue(LameSimpleQuality, 4);
+         settingsManager.setValue(LameParallelEncoding, 1);
+
+         encoder.SetSettingsManager(&settingsManager);
+
+         StartEncodeAndWaitForFinish(encoder);
+
+         // encoding must succeed, and output file must exist
+         Assert::AreEqual(0, encoder.GetEncoderState().m_errorCode.load(), _T("encoding must not report an error"));
+         Assert::IsTrue(encoder.GetAllErrorInfos().empty(), _T("there must be no error infos"));
+         Assert::IsTrue(Path::FileExists(encoderSettings.m_outputFilename), _T("output file must exist"));
+      }
+
+      /// tests parallel encoding on a worker pool that is busy most of the time, so that
+      /// segments are also encoded on the encoding thread
+      TEST_METHOD(TestEncodeParallelOnWorkerPool)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.mp3"));
+         ExtractFromResource(IDR_SAMPLE_MP3, filename);
+
+         SingleWorkerPool workerPool;
+
+         // encode file
+         Encoder::EncoderImpl encoder;
+
+         Encoder::EncoderSettings encoderSettings;
+         encoderSettings.m_inputFilename = filename;
+         encoderSettings.m_outputFilename = Path::Combine(folder.FolderName(), _T("output.mp3"));
+         encoderSettings.m_outputModuleID = ID_OM_LAME; // encode to LAME mp3
+         encoderSettings.m_workerPool = &workerPool;
+
+         encoder.SetEncoderSettings(encoderSettings);
+
+         SettingsManager settingsManager;
+         settingsManager.setValue(LameSimpleQualityOrBitrate, 0);
+         settingsManager.setValue(LameSimpleEncodeQuality, 1);
+         settingsManager.setValue(LameSimpleQuality, 4);
+         settingsManager.setValue(LameParallelEncoding, 1);
+
+         encoder.SetSettingsManager(&settingsManager);
+
+         StartEncodeAndWaitForFinish(encoder);
+
+         // encoding must succeed, and every segment must have been offered to the pool
+         Assert::AreEqual(0, encoder.GetEncoderState().m_errorCode.load(), _T("encoding must not report an error"));
+         Assert::IsTrue(encoder.GetAllErrorInfos().empty(), _T("there must be no error infos"));
+         Assert::IsTrue(Path::FileExists(encoderSettings.m_outputFilename), _T("output file must exist"));
+         Assert::IsTrue(workerPool.m_numTryRunCalls > 0, _T("segments must be passed to the worker pool"));
+         Assert::IsTrue(workerPool.m_maxNumRunning <= 1, _T("worker pool must not run more than one segment"));
+      }
+
+      /// tests that the ID3v2 tag and the VBR Info tag are written through the output sink
+      TEST_METHOD(TestEncodeToMemory)
+      {
+         auto sink = std::make_shared<Encoder::MemoryOutputSink>();
+         EncodeToSink(sink);
+
+         const std::vector<unsigned char>& data = sink->GetData();
+
+         size_t tagLength = GetId3v2TagLength(data);
+         Assert::IsTrue(tagLength > 0, _T("output must start with an ID3v2 tag"));
+         Assert::IsTrue(IsInfoTagFrame(data, tagLength), _T("VBR Info tag must follow the ID3v2 tag"));
+      }
+
+      /// tests that the ID3v2 tag is written right away when the output can't be overwritten
+      TEST_METHOD(TestEncodeToPipe)
+      {
+         auto sink = std::make_shared<PipeOutputSink>();
+         EncodeToSink(sink);
+
+         Assert::IsFalse(sink->m_overwriteCalled, _T("output must not be overwritten"));
+
+         const std::vector<unsigned char>& data = sink->GetData();
+
+         size_t tagLength = GetId3v2TagLength(data);
+         Assert::IsTrue(tagLength > 0, _T("output must start with an ID3v2 tag"));
+         Assert::IsTrue(data.size() > tagLength + 1 && data[tagLength] == 0xff && (data[tagLength + 1] & 0xe0) == 0xe0,
+            _T("first frame must follow the ID3v2 tag"));
+         Assert::IsFalse(IsInfoTagFrame(data, tagLength), _T("there must be no empty VBR Info tag frame"));
+      }
+
+   private:
+      /// worker pool with a single worker thread
+      class SingleWorkerPool : public Encoder::WorkerPool
+      {
+      public:
+         /// dtor; waits for the worker thread
+         virtual ~SingleWorkerPool()
+         {
+            if (m_thread.joinable())
+               m_thread.join();
+         }
+
+         /// runs work on the worker thread, when it's not busy
+         virtual bool TryRun(std::function<void()> work) override
+         {
+            m_numTryRunCalls++;
+
+            if (m_numRunning > 0)
+               return false;
+
+            if (m_thread.joinable())
+               m_thread.join();
+
+            m_maxNumRunning = std::max(m_maxNumRunning, ++m_numRunning);
+
+            m_thread = std::thread([this, work]()
+               {
+                  work();
+                  m_numRunning--;
+               });
+
+            return true;
+         }
+
+         /// number of TryRun() calls
+         unsigned int m_numTryRunCalls = 0;
+
+         /// maximum number of work items running at the same time
+         unsigned int m_maxNumRunning = 0;
+
+      private:
+         /// number of work items running
+         std::atomic<unsigned int> m_numRunning = 0;
+
+         /// worker thread
+         std::thread m_thread;
+      };
+
+      /// output sink that behaves like a pipe, collecting the data in memory
+      class PipeOutputSink : public Encoder::MemoryOutputSink
+      {
+      public:
+         /// returns false, like for a pipe
+         virtual bool CanOverwrite() const override { return false; }
+
+         /// fails, like for a pipe
+         virtual bool Overwrite(unsigned long long, const void*, size_t) override
+         {
+            m_overwriteCalled = true;
+            return false;
+         }
+
+         /// indicates if Overwrite() was called
+         bool m_overwriteCalled = false;
+      };
+
+      /// encodes one second of a stereo sine signal to the output sink
+      void EncodeToSink(std::shared_ptr<Encoder::OutputSink> sink)
+      {
+         Encoder::ModuleManagerImpl moduleManager;
+         std::unique_ptr<Encoder::OutputModule> outputModule(moduleManager.GetOutputModule(ID_OM_LAME));
+         Assert::IsNotNull(outputModule.get(), _T("LAME output module must be available"));
+
+         SettingsManager settingsManager;
+         outputModule->PrepareOutput(settingsManager);
+
+         Assert::IsTrue(outputModule->SupportsOutputSink(), _T("LAME output module must support output sinks"));
+         outputModule->SetOutputSink(sink);
+
+         Encoder::TrackInfo trackInfo;
+         trackInfo.SetTextInfo(Encoder::TrackInfoTitle, _T("Sine"));
+
+         const int samplerateInHz = 44100;
+         Encoder::SampleContainer samples;
+         samples.SetInputModuleTraits(16, Encoder::SamplesInterleaved, samplerateInHz, 2);
+
+         Assert::AreEqual(0, outputModule->InitOutput(_T("unused.mp3"), settingsManager, trackInfo, samples),
+            _T("initializing output must succeed"));
+
+         std::vector<short> signal;
+         for (int sample = 0; sample < samplerateInHz; sample++)
+         {
+            short value = static_cast<short>(10000.0 * std::sin(sample * 2.0 * 3.14159265358979 * 440.0 / samplerateInHz));
+            signal.push_back(value);
+            signal.push_back(value);
+         }
+
+         samples.PutSamplesInterleaved(signal.data(), samplerateInHz);
+         Assert::AreEqual(0, outputModule->EncodeSamples(samples), _T("encoding must succeed"));
+
+         outputModule->DoneOutput();
+      }
+
+      /// returns the length of the ID3v2 tag at the start of the data, or 0 when there's none
+      static size_t GetId3v2TagLength(const std::vector<unsigned char>& data)
+      {
+         if (data.size() < 10 || data[0] != 'I' || data[1] != 'D' || data[2] != '3')
+            return 0;
+
+         // the size is stored as synchsafe integer and doesn't include the header
+         return 10 + ((size_t(data[6]) << 21) | (size_t(data[7]) << 14) | (size_t(data[8]) << 7) | data[9]);
+      }
+
+      /// returns if the frame at given offset contains a VBR Info tag
+      static bool IsInfoTagFrame(const std::vector<unsigned char>& data, size_t offset)
+      {
+         // the tag follows the side info, which is at most 32 bytes long
+         std::string frameStart(data.begin() + std::min(offset, data.size()),
+            data.begin() + std::min(offset + 64, data.size()));
+
+         return frameStart.find("Info") != std::string::npos ||
+            frameStart.find("Xing") != std::string::npos;
+      }
    };
 }
@@ -0,0 +1,146 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestEncoderStatistics.cpp
+/// \brief Tests encoder timing and throughput counters
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "EncoderTestFixture.hpp"
+#include "EncoderStatistics.hpp"
+#include "SampleContainer.hpp"
+#include "EncoderImpl.hpp"
+#include "resource_unittest.h"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+#include <sndfile.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for EncoderStatistics class and sample conversion timing
+   TEST_CLASS(TestEncoderStatistics), public EncoderTestFixture
+   {
+   public:
+      /// sets up test; called before each test
+      TEST_CLASS_INITIALIZE(SetUp)
+      {
+         EncoderTestFixture::SetUp();
+      }
+
+      /// tests adding up statistics and calculating the realtime factor
+      TEST_METHOD(TestAddAndRealtimeFactor)
+      {
+         Encoder::EncoderStatistics statistics;
+
+         Assert::AreEqual(0.0, statistics.RealtimeFactor(), _T("realtime factor must be 0 without time"));
+
+         // 10 seconds of audio, encoded in 2 seconds
+         statistics.Add(Encoder::counterAudioMicroseconds, 10000000);
+         statistics.Add(Encoder::counterTotalNanoseconds, 2000000000);
+         statistics.Add(Encoder::counterBytesOut, 1000);
+
+         Assert::AreEqual(5.0, statistics.RealtimeFactor(), 1e-9, _T("realtime factor must match"));
+
+         Encoder::EncoderStatistics total;
+         total.Add(statistics);
+         total.Add(statistics);
+
+         Assert::AreEqual(2000ULL, total.Get(Encoder::counterBytesOut), _T("counters must be added up"));
+         Assert::AreEqual(20.0, total.AudioSeconds(), 1e-9, _T("audio duration must be added up"));
+         Assert::AreEqual(5.0, total.RealtimeFactor(), 1e-9, _T("realtime factor must stay the same"));
+
+         Encoder::EncoderStatistics copy = total;
+         total.Reset();
+
+         Assert::AreEqual(0ULL, total.Get(Encoder::counterBytesOut), _T("counters must be reset"));
+         Assert::AreEqual(2000ULL, copy.Get(Encoder::counterBytesOut), _T("copy must keep counters"));
+      }
+
+      /// tests that converting samples is timed, and passing through borrowed samples isn't
+      TEST_METHOD(TestConversionTime)
+      {
+         const int numSamples = 48000;
+         std::vector<short> samples(numSamples * 2, 0);
+
+         Encoder::SampleContainer passthrough;
+         passthrough.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 48000, 2);
+         passthrough.SetOutputModuleTraits(16, Encoder::SamplesInterleaved);
+
+         passthrough.PutSamplesInterleavedBorrowed(samples.data(), numSamples);
+         Assert::AreEqual(0ULL, passthrough.GetConversionNanoseconds(), _T("borrowing samples must not count as conversion"));
+
+         Encoder::SampleContainer converting;
+         converting.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 48000, 2);
+         converting.SetOutputModuleTraits(32, Encoder::SamplesChannelArray);
+
+         for (int count = 0; count < 10; count++)
+            converting.PutSamplesInterleaved(samples.data(), numSamples);
+
+         Assert::IsTrue(converting.GetConversionNanoseconds() > 0, _T("converting samples must be timed"));
+      }
+
+      /// tests that decoded samples are counted per channel for stereo input files
+      TEST_METHOD(TestStereoAudioDuration)
+      {
+         std::vector<std::tuple<UINT, LPCTSTR>> inputFilesList =
+         {
+            std::make_tuple(IDR_SAMPLE_FLAC, _T("sample.flac")),
+            std::make_tuple(IDR_SAMPLE_OPUS, _T("sample.opus")),
+            std::make_tuple(IDR_SAMPLE_SPEEX, _T("sample.spx")),
+         };
+
+         for (auto inputInfos : inputFilesList)
+         {
+            UnitTest::AutoCleanupFolder folder;
+
+            CString filename = Path::Combine(folder.FolderName(), std::get<1>(inputInfos));
+            ExtractFromResource(std::get<0>(inputInfos), filename);
+
+            int numChannels = 0, bitrateInBps = 0, lengthInSeconds = 0, samplerateInHz = 0;
+            GetAudioFileInfos(filename, numChannels, bitrateInBps, lengthInSeconds, samplerateInHz);
+
+            Assert::AreEqual(2, numChannels, _T("input file must be stereo"));
+
+            Encoder::EncoderImpl encoder;
+
+            Encoder::EncoderSettings encoderSettings;
+            encoderSettings.m_inputFilename = filename;
+            encoderSettings.m_outputFilename = Path::Combine(folder.FolderName(), _T("output.wav"));
+            encoderSettings.m_outputModuleID = ID_OM_WAVE;
+
+            encoder.SetEncoderSettings(encoderSettings);
+
+            SettingsManager settingsManager;
+            settingsManager.setValue(SndFileFormat, SF_FORMAT_WAV);
+            settingsManager.setValue(SndFileSubType, SF_FORMAT_PCM_16);
+
+            encoder.SetSettingsManager(&settingsManager);
+
+            StartEncodeAndWaitForFinish(encoder);
+
+            // the file length is rounded down to full seconds; the duration would be a
+            // multiple of it when samples of all channels were counted
+            Encoder::EncoderStatistics statistics = encoder.GetEncoderState().m_statistics;
+            Assert::AreEqual(double(lengthInSeconds), statistics.AudioSeconds(), 1.0,
+               _T("decoded audio duration must match file length"));
+         }
+      }
+   };
+}
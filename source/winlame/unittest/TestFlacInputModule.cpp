@@ -0,0 +1,228 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestFlacInputModule.cpp
+/// \brief Tests decoding .flac files with the FLAC input module
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "FlacInputModule.hpp"
+#include "SampleContainer.hpp"
+#include "SettingsManager.hpp"
+#include "TrackInfo.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+#include "FLAC/stream_encoder.h"
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for the FlacInputModule class
+   TEST_CLASS(TestFlacInputModule)
+   {
+   public:
+      /// tests that 24 bit samples are shifted to the top of 32 bit samples
+      TEST_METHOD(TestDecode24BitSamples)
+      {
+         UnitTest::AutoCleanupFolder folder;
+         CString filename = Path::Combine(folder.FolderName(), _T("sample24.flac"));
+
+         const unsigned int numChannels = 2;
+         const unsigned int numSamples = 3000;
+         std::vector<unsigned long long> frameEndOffsets;
+         WriteFlacFile(filename, numChannels, 24, 1024, numSamples, frameEndOffsets);
+
+         std::vector<int> decodedSamples;
+         Assert::AreEqual(0, DecodeFile(filename, decodedSamples, nullptr), _T("decoding must succeed"));
+
+         Assert::AreEqual(size_t(numSamples) * numChannels, decodedSamples.size(), _T("all samples must be decoded"));
+
+         for (unsigned int sample = 0; sample < numSamples; sample++)
+         {
+            for (unsigned int channel = 0; channel < numChannels; channel++)
+            {
+               int expected = static_cast<int>(static_cast<unsigned int>(SampleValue(sample, channel, 24)) << 8);
+               Assert::AreEqual(expected, decodedSamples[size_t(sample) * numChannels + channel],
+                  _T("24 bit sample must be shifted into 32 bit"));
+            }
+         }
+      }
+
+      /// tests that every call to DecodeSamples() returns exactly one frame
+      TEST_METHOD(TestDecodeOneFramePerCall)
+      {
+         UnitTest::AutoCleanupFolder folder;
+         CString filename = Path::Combine(folder.FolderName(), _T("sample16.flac"));
+
+         const unsigned int blockSize = 1152;
+         const unsigned int numSamples = blockSize * 3 + 100;
+         std::vector<unsigned long long> frameEndOffsets;
+         WriteFlacFile(filename, 2, 16, blockSize, numSamples, frameEndOffsets);
+
+         std::vector<int> decodedSamples;
+         std::vector<int> samplesPerCall;
+         Assert::AreEqual(0, DecodeFile(filename, decodedSamples, &samplesPerCall), _T("decoding must succeed"));
+
+         std::vector<int> expectedSamplesPerCall{ int(blockSize), int(blockSize), int(blockSize), 100 };
+         Assert::IsTrue(expectedSamplesPerCall == samplesPerCall, _T("each call must return a single frame"));
+
+         for (unsigned int sample = 0; sample < numSamples; sample++)
+         {
+            Assert::AreEqual(SampleValue(sample, 1, 16) << 16, decodedSamples[size_t(sample) * 2 + 1],
+               _T("16 bit sample must be shifted into 32 bit"));
+         }
+      }
+
+      /// tests that a corrupted frame is reported as error, not as end of file
+      TEST_METHOD(TestDecodeErrorIsNotEndOfFile)
+      {
+         UnitTest::AutoCleanupFolder folder;
+         CString filename = Path::Combine(folder.FolderName(), _T("corrupt.flac"));
+
+         std::vector<unsigned long long> frameEndOffsets;
+         WriteFlacFile(filename, 2, 16, 1024, 1024 * 4, frameEndOffsets);
+         Assert::AreEqual(size_t(4), frameEndOffsets.size(), _T("file must contain 4 frames"));
+
+         // invert the CRC-16 footer of the second frame
+         {
+            std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekg(frameEndOffsets[1] - 1);
+            char footer = 0;
+            file.read(&footer, 1);
+            footer = static_cast<char>(~footer);
+            file.seekp(frameEndOffsets[1] - 1);
+            file.write(&footer, 1);
+         }
+
+         std::vector<int> decodedSamples;
+         std::vector<int> samplesPerCall;
+         CString lastError;
+         int ret = DecodeFile(filename, decodedSamples, &samplesPerCall, &lastError);
+
+         Assert::IsTrue(ret < 0, _T("decoding must fail"));
+         Assert::IsFalse(lastError.IsEmpty(), _T("decoding must set an error text"));
+         Assert::AreEqual(size_t(1), samplesPerCall.size(), _T("only the first frame must be decoded"));
+      }
+
+   private:
+      /// returns a deterministic sample value that uses the full range of the given bit depth
+      static int SampleValue(unsigned int sample, unsigned int channel, unsigned int bitsPerSample)
+      {
+         unsigned int range = 1U << bitsPerSample;
+         unsigned int value = (sample * 7919U + channel * 104729U + (sample * sample) % 65521U) % range;
+         return static_cast<int>(value) - static_cast<int>(range / 2);
+      }
+
+      /// encoder context used when writing a FLAC file
+      struct EncoderOutput
+      {
+         std::vector<unsigned char> data;                   ///< encoded data
+         std::vector<unsigned long long>* frameEndOffsets;  ///< end offsets of all frames
+      };
+
+      /// FLAC encoder write callback; collects data and stores the end offset of every frame
+      static FLAC__StreamEncoderWriteStatus FLAC_WriteCallback(const FLAC__StreamEncoder* encoder,
+         const FLAC__byte buffer[], size_t bytes, unsigned samples, unsigned currentFrame, void* clientData)
+      {
+         EncoderOutput* output = reinterpret_cast<EncoderOutput*>(clientData);
+         output->data.insert(output->data.end(), buffer, buffer + bytes);
+
+         // a call with samples writes one complete frame
+         if (samples > 0)
+            output->frameEndOffsets->push_back(output->data.size());
+
+         return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+      }
+
+      /// writes a FLAC file with a fixed block size and SampleValue() samples
+      static void WriteFlacFile(const CString& filename, unsigned int numChannels, unsigned int bitsPerSample,
+         unsigned int blockSize, unsigned int numSamples, std::vector<unsigned long long>& frameEndOffsets)
+      {
+         EncoderOutput output;
+         output.frameEndOffsets = &frameEndOffsets;
+
+         FLAC__StreamEncoder* encoder = FLAC__stream_encoder_new();
+         Assert::IsNotNull(encoder, _T("encoder must be created"));
+
+         FLAC__stream_encoder_set_channels(encoder, numChannels);
+         FLAC__stream_encoder_set_bits_per_sample(encoder, bitsPerSample);
+         FLAC__stream_encoder_set_sample_rate(encoder, 44100);
+         FLAC__stream_encoder_set_compression_level(encoder, 0);
+         FLAC__stream_encoder_set_blocksize(encoder, blockSize);
+         FLAC__stream_encoder_set_total_samples_estimate(encoder, numSamples);
+
+         FLAC__StreamEncoderInitStatus initStatus = FLAC__stream_encoder_init_stream(encoder,
+            FLAC_WriteCallback, nullptr, nullptr, nullptr, &output);
+         Assert::IsTrue(initStatus == FLAC__STREAM_ENCODER_INIT_STATUS_OK, _T("encoder must be initialized"));
+
+         std::vector<FLAC__int32> samples;
+         for (unsigned int sample = 0; sample < numSamples; sample++)
+            for (unsigned int channel = 0; channel < numChannels; channel++)
+               samples.push_back(SampleValue(sample, channel, bitsPerSample));
+
+         Assert::IsTrue(0 != FLAC__stream_encoder_process_interleaved(encoder, samples.data(), numSamples),
+            _T("samples must be encoded"));
+         Assert::IsTrue(0 != FLAC__stream_encoder_finish(encoder), _T("encoding must be finished"));
+
+         FLAC__stream_encoder_delete(encoder);
+
+         std::ofstream file(filename, std::ios::out | std::ios::binary);
+         file.write(reinterpret_cast<const char*>(output.data.data()), output.data.size());
+      }
+
+      /// decodes a file to 32 bit interleaved samples; returns the first negative
+      /// DecodeSamples() return value, or 0 at the end of the file
+      static int DecodeFile(const CString& filename, std::vector<int>& decodedSamples,
+         std::vector<int>* samplesPerCall, CString* lastError = nullptr)
+      {
+         Encoder::FlacInputModule inputModule;
+
+         Encoder::TrackInfo trackInfo;
+         Encoder::SampleContainer samples;
+         SettingsManager settingsManager;
+         Assert::AreEqual(0, inputModule.InitInput(filename, settingsManager, trackInfo, samples),
+            _T("input module must be initialized"));
+
+         samples.SetOutputModuleTraits(32, Encoder::SamplesInterleaved);
+
+         int ret = 0;
+         while ((ret = inputModule.DecodeSamples(samples)) > 0)
+         {
+            int numSamples = 0;
+            const int* buffer = reinterpret_cast<const int*>(samples.GetSamplesInterleaved(numSamples));
+
+            Assert::AreEqual(ret, numSamples, _T("returned number of samples must match container"));
+
+            decodedSamples.insert(decodedSamples.end(),
+               buffer, buffer + size_t(numSamples) * samples.GetOutputModuleChannels());
+
+            if (samplesPerCall != nullptr)
+               samplesPerCall->push_back(numSamples);
+         }
+
+         if (lastError != nullptr)
+            *lastError = inputModule.GetLastError();
+
+         inputModule.DoneInput();
+
+         return ret;
+      }
+   };
+}
@@ -0,0 +1,226 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestInputFilesParser.cpp
+/// \brief Tests scanning input files and folders
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "InputFilesParser.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+#include <algorithm>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for InputFilesParser class
+   TEST_CLASS(TestInputFilesParser)
+   {
+   public:
+      /// tests that the file list has the same order as scanning the folders one after another
+      TEST_METHOD(TestFileListOrder)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         // more folders than scan threads, with different numbers of files
+         for (int folderIndex = 0; folderIndex < 20; folderIndex++)
+         {
+            CString subFolder;
+            subFolder.Format(_T("folder%02i"), folderIndex);
+
+            for (int fileIndex = 0; fileIndex <= folderIndex % 5; fileIndex++)
+            {
+               CString filename;
+               filename.Format(_T("track%02i.wav"), fileIndex);
+               WriteFile(folder.FolderName(), subFolder + _T("\\") + filename);
+            }
+         }
+
+         WriteFile(folder.FolderName(), _T("first.wav"));
+         WriteFile(folder.FolderName(), _T("last.wav"));
+
+         InputFilesParser parser;
+         parser.Parse(std::vector<CString>{ folder.FolderName() });
+
+         std::vector<CString> expected;
+         ListFolder(folder.FolderName(), expected);
+
+         Assert::AreEqual(size_t(2 + 4 * 15), expected.size(), _T("reference listing must find all files"));
+         Assert::IsTrue(expected == parser.FileList(), _T("file list must be in sequential scan order"));
+      }
+
+      /// tests scanning folders nested deeper than there are scan threads
+      TEST_METHOD(TestNestedFolders)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString relativePath;
+         for (int depth = 0; depth < 20; depth++)
+         {
+            CString subFolder;
+            subFolder.Format(_T("level%02i"), depth);
+            relativePath = relativePath.IsEmpty() ? subFolder : relativePath + _T("\\") + subFolder;
+
+            WriteFile(folder.FolderName(), relativePath + _T("\\a.wav"));
+            WriteFile(folder.FolderName(), relativePath + _T("\\z.wav"));
+
+            // a sibling folder at every level
+            WriteFile(folder.FolderName(), relativePath + _T("\\sibling\\track.wav"));
+         }
+
+         InputFilesParser parser;
+         parser.Parse(std::vector<CString>{ folder.FolderName() });
+
+         std::vector<CString> expected;
+         ListFolder(folder.FolderName(), expected);
+
+         Assert::AreEqual(size_t(20 * 3), parser.FileList().size(), _T("all files must be found"));
+         Assert::IsTrue(expected == parser.FileList(), _T("file list must be in sequential scan order"));
+      }
+
+      /// tests that files and folders keep the order in which they were passed
+      TEST_METHOD(TestInputOrder)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString folderB = Path::Combine(folder.FolderName(), _T("b"));
+         CString folderA = Path::Combine(folder.FolderName(), _T("a"));
+
+         WriteFile(folderB, _T("track1.wav"));
+         WriteFile(folderB, _T("cd2\\track2.wav"));
+         CString singleFile = WriteFile(folder.FolderName(), _T("single.wav"));
+         WriteFile(folderA, _T("track3.wav"));
+
+         InputFilesParser parser;
+         parser.Parse(std::vector<CString>{ folderB + _T("\\"), singleFile, folderA });
+
+         std::vector<CString> expected;
+         ListFolder(folderB, expected);
+         expected.push_back(singleFile);
+         ListFolder(folderA, expected);
+
+         Assert::AreEqual(size_t(4), expected.size(), _T("reference listing must find all files"));
+         Assert::IsTrue(expected == parser.FileList(), _T("files must be in the order they were passed"));
+      }
+
+      /// tests that the function passed to Parse() is called on the calling thread, for
+      /// every file, and with the files of a folder in folder order
+      TEST_METHOD(TestCallbackOnCallingThread)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         for (int folderIndex = 0; folderIndex < 12; folderIndex++)
+         {
+            CString subFolder;
+            subFolder.Format(_T("folder%02i"), folderIndex);
+
+            WriteFile(folder.FolderName(), subFolder + _T("\\track1.wav"));
+            WriteFile(folder.FolderName(), subFolder + _T("\\track2.wav"));
+            WriteFile(folder.FolderName(), subFolder + _T("\\nested\\track3.wav"));
+         }
+
+         DWORD callingThreadId = ::GetCurrentThreadId();
+         bool calledOnOtherThread = false;
+         std::vector<CString> foundFiles;
+
+         InputFilesParser parser;
+         parser.Parse(std::vector<CString>{ folder.FolderName() },
+            [&](const CString& filename)
+            {
+               if (::GetCurrentThreadId() != callingThreadId)
+                  calledOnOtherThread = true;
+
+               foundFiles.push_back(filename);
+            });
+
+         Assert::IsFalse(calledOnOtherThread, _T("function must be called on the calling thread"));
+
+         const std::vector<CString>& fileList = parser.FileList();
+         Assert::AreEqual(size_t(12 * 3), fileList.size(), _T("all files must be found"));
+
+         // files of the same folder must be passed in the same order as in the file list
+         for (const CString& filename : fileList)
+         {
+            CString folderName = Path::FolderName(filename);
+
+            Assert::IsTrue(FilesInFolder(foundFiles, folderName) == FilesInFolder(fileList, folderName),
+               _T("files of a folder must be passed in folder order"));
+         }
+
+         std::vector<CString> sortedFoundFiles = foundFiles;
+         std::vector<CString> sortedFileList = fileList;
+         std::sort(sortedFoundFiles.begin(), sortedFoundFiles.end());
+         std::sort(sortedFileList.begin(), sortedFileList.end());
+
+         Assert::IsTrue(sortedFoundFiles == sortedFileList, _T("every file must be passed exactly once"));
+      }
+
+   private:
+      /// writes a small file, creating its folder; returns the filename
+      static CString WriteFile(const CString& folder, const CString& relativePath)
+      {
+         CString filename = Path::Combine(folder, relativePath);
+
+         Path::CreateDirectoryRecursive(Path::FolderName(filename));
+
+         std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+         file << "RIFF";
+
+         return filename;
+      }
+
+      /// lists all files of a folder recursively, one folder after another, as reference
+      static void ListFolder(CString folder, std::vector<CString>& fileList)
+      {
+         folder.TrimRight(_T('\\'));
+
+         WIN32_FIND_DATA findData = { 0 };
+         HANDLE hFind = ::FindFirstFile(folder + _T("\\*.*"), &findData);
+         Assert::IsTrue(hFind != INVALID_HANDLE_VALUE, _T("folder must be listed"));
+
+         do
+         {
+            if (findData.cFileName[0] == '.')
+               continue;
+
+            CString filename = folder + _T("\\") + findData.cFileName;
+
+            if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+               ListFolder(filename, fileList);
+            else
+               fileList.push_back(filename);
+
+         } while (::FindNextFile(hFind, &findData));
+
+         ::FindClose(hFind);
+      }
+
+      /// returns all files directly in the given folder, in list order
+      static std::vector<CString> FilesInFolder(const std::vector<CString>& fileList, const CString& folder)
+      {
+         std::vector<CString> files;
+         std::copy_if(fileList.begin(), fileList.end(), std::back_inserter(files),
+            [&](const CString& filename) { return Path::FolderName(filename) == folder; });
+
+         return files;
+      }
+   };
+}
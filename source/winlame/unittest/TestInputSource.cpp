@@ -0,0 +1,102 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestInputSource.cpp
+/// \brief Tests reading encoded data through input sources
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "InputSource.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for InputSource class
+   TEST_CLASS(TestInputSource)
+   {
+   public:
+      /// tests reading a file, through a file mapping and through the read-ahead buffer
+      TEST_METHOD(TestReadAndSeek)
+      {
+         UnitTest::AutoCleanupFolder folder;
+         CString filename = Path::Combine(folder.FolderName(), _T("input.bin"));
+
+         // larger than the read-ahead buffer
+         std::vector<unsigned char> data(3 * Encoder::InputSource::c_readAheadBufferSize + 123);
+         for (size_t index = 0; index < data.size(); index++)
+            data[index] = static_cast<unsigned char>(index * 7 + index / 251);
+
+         {
+            std::ofstream stream(filename.GetString(), std::ios::out | std::ios::binary);
+            stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+         }
+
+         for (bool useMapping : { true, false })
+         {
+            Encoder::InputSource inputSource;
+            Assert::IsTrue(inputSource.Open(filename, useMapping), _T("file must be opened"));
+
+            if (!useMapping)
+               Assert::IsFalse(inputSource.IsMapped(), _T("file must not be mapped"));
+
+            Assert::AreEqual<unsigned long long>(data.size(), inputSource.Length(), _T("length must match"));
+
+            // read whole file in chunks of different sizes
+            std::vector<unsigned char> readData;
+            for (size_t chunkIndex = 0; !inputSource.IsEndOfFile(); chunkIndex++)
+            {
+               std::vector<unsigned char> chunk(chunkIndex % 3 == 0 ? 65536 + chunkIndex : 1000 + chunkIndex);
+               size_t numRead = inputSource.Read(chunk.data(), chunk.size());
+
+               Assert::IsTrue(numRead > 0, _T("data must be read until end of file"));
+               readData.insert(readData.end(), chunk.begin(), chunk.begin() + numRead);
+            }
+
+            Assert::IsTrue(data == readData, _T("read data must match file content"));
+            Assert::AreEqual<size_t>(0, inputSource.Read(readData.data(), 1), _T("no data must be read at end of file"));
+
+            // seeking
+            Assert::IsTrue(inputSource.Seek(-100, SEEK_END), _T("seeking from end must succeed"));
+            Assert::AreEqual<unsigned long long>(data.size() - 100, inputSource.Position(), _T("position must match"));
+            Assert::AreEqual<size_t>(100, inputSource.Read(readData.data(), 200), _T("only data up to the end must be read"));
+
+            Assert::IsFalse(inputSource.Seek(-1, SEEK_SET), _T("seeking before start must fail"));
+
+            // peeking
+            Assert::IsTrue(inputSource.Seek(Encoder::InputSource::c_readAheadBufferSize - 10, SEEK_SET), _T("seeking must succeed"));
+
+            size_t available = 0;
+            const unsigned char* peekData = inputSource.Peek(1000, available);
+
+            Assert::IsNotNull(peekData, _T("peeked data must be available"));
+            Assert::IsTrue(available >= 1000, _T("at least the requested size must be available"));
+            Assert::AreEqual(0, memcmp(peekData, data.data() + inputSource.Position(), 1000), _T("peeked data must match file content"));
+
+            inputSource.Skip(1000);
+            Assert::AreEqual<unsigned long long>(Encoder::InputSource::c_readAheadBufferSize + 990, inputSource.Position(), _T("position must be advanced"));
+
+            inputSource.Close();
+            Assert::IsFalse(inputSource.IsOpen(), _T("input source must be closed"));
+         }
+      }
+   };
+}
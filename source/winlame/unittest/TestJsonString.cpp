@@ -0,0 +1,56 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestJsonString.cpp
+/// \brief Tests formatting JSON string literals
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "JsonString.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for JsonString function
+   TEST_CLASS(TestJsonString)
+   {
+   public:
+      /// tests that text is quoted and special characters are escaped
+      TEST_METHOD(TestEscaping)
+      {
+         Assert::AreEqual("\"\"", Encoder::JsonString(CString()).GetString(), _T("empty text must be quoted"));
+
+         Assert::AreEqual("\"C:\\\\Music\\\\\\\"Live\\\".mp3\"",
+            Encoder::JsonString(_T("C:\\Music\\\"Live\".mp3")).GetString(),
+            _T("backslashes and quotes must be escaped"));
+
+         Assert::AreEqual("\"a\\nb\\rc\\td\\u0001\"",
+            Encoder::JsonString(_T("a\nb\rc\td\x01")).GetString(),
+            _T("control characters must be escaped"));
+      }
+
+      /// tests that non-ASCII text is encoded as UTF-8
+      TEST_METHOD(TestUtf8)
+      {
+         Assert::AreEqual("\"\xc3\xa4\xe2\x82\xac\"",
+            Encoder::JsonString(_T("\x00e4\x20ac")).GetString(),
+            _T("text must be encoded as UTF-8"));
+      }
+   };
+}
@@ -0,0 +1,276 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestLoudnessAnalyzer.cpp
+/// \brief Tests loudness analysis, using test signals of EBU Tech 3341
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "LoudnessAnalyzer.hpp"
+#include "SampleContainer.hpp"
+#include "TrackInfo.hpp"
+#include <cmath>
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using Encoder::LoudnessAnalyzer;
+using Encoder::LoudnessResult;
+using Encoder::SampleConverter;
+
+namespace unittest
+{
+   /// tests for LoudnessAnalyzer, LoudnessHistogram and LoudnessAlbum classes
+   TEST_CLASS(TestLoudnessAnalyzer)
+   {
+   public:
+      /// resets instruction set after each test
+      TEST_METHOD_CLEANUP(TearDown)
+      {
+         SampleConverter::SetInstructionSet(SampleConverter::GetSupportedInstructionSet());
+      }
+
+      /// tests that unsupported parameters are rejected
+      TEST_METHOD(TestInit)
+      {
+         LoudnessAnalyzer analyzer;
+         Assert::IsTrue(analyzer.Init(44100, 2), _T("CD format must be supported"));
+         Assert::IsTrue(analyzer.Init(8000, 1), _T("8 kHz must be supported"));
+         Assert::IsFalse(analyzer.Init(4000, 2), _T("too low sample rate must not be supported"));
+         Assert::IsFalse(analyzer.Init(48000, 0), _T("zero channels must not be supported"));
+      }
+
+      /// tests a stereo 1 kHz sine at -23 dBFS, at different sample rates (EBU Tech 3341, case 1)
+      TEST_METHOD(TestSineLoudness)
+      {
+         for (unsigned int samplerateInHz : { 44100U, 48000U, 96000U })
+         {
+            LoudnessAnalyzer analyzer;
+            Assert::IsTrue(analyzer.Init(samplerateInHz, 2), _T("init must succeed"));
+
+            AnalyzeSine(analyzer, samplerateInHz, -23.0, 20.0);
+
+            LoudnessResult result = analyzer.GetResult();
+            Assert::IsTrue(result.m_isValid, _T("result must be valid"));
+            Assert::AreEqual(-23.0, result.m_loudness, 0.1, _T("loudness must match"));
+            Assert::AreEqual(-18.0 + 23.0, result.GetGain(), 0.1, _T("gain must be relative to the reference level"));
+            Assert::AreEqual(std::pow(10.0, -23.0 / 20.0), result.m_peak, 1e-3, _T("peak must match amplitude"));
+         }
+      }
+
+      /// tests the relative gate (EBU Tech 3341, case 3)
+      TEST_METHOD(TestRelativeGate)
+      {
+         LoudnessAnalyzer analyzer;
+         analyzer.Init(48000, 2);
+
+         AnalyzeSine(analyzer, 48000, -36.0, 10.0);
+         AnalyzeSine(analyzer, 48000, -23.0, 60.0);
+         AnalyzeSine(analyzer, 48000, -36.0, 10.0);
+
+         Assert::AreEqual(-23.0, analyzer.GetResult().m_loudness, 0.1, _T("quiet parts must be gated"));
+      }
+
+      /// tests the absolute and relative gate (EBU Tech 3341, case 4)
+      TEST_METHOD(TestAbsoluteGate)
+      {
+         LoudnessAnalyzer analyzer;
+         analyzer.Init(48000, 2);
+
+         AnalyzeSine(analyzer, 48000, -72.0, 10.0);
+         AnalyzeSine(analyzer, 48000, -36.0, 10.0);
+         AnalyzeSine(analyzer, 48000, -23.0, 60.0);
+         AnalyzeSine(analyzer, 48000, -36.0, 10.0);
+         AnalyzeSine(analyzer, 48000, -72.0, 10.0);
+
+         Assert::AreEqual(-23.0, analyzer.GetResult().m_loudness, 0.1, _T("quiet parts must be gated"));
+      }
+
+      /// tests that silence and too short signals don't give a result
+      TEST_METHOD(TestSilence)
+      {
+         LoudnessAnalyzer analyzer;
+         analyzer.Init(44100, 2);
+
+         // shorter than a gating block
+         AnalyzeSine(analyzer, 44100, -20.0, 0.3);
+         Assert::IsFalse(analyzer.GetResult().m_isValid, _T("signal shorter than 400 ms must not be valid"));
+
+         analyzer.Reset();
+
+         std::vector<float> silence(44100 * 2 * 5, 0.0f);
+         analyzer.AnalyzeInterleaved(silence.data(), silence.size() / 2);
+
+         LoudnessResult result = analyzer.GetResult();
+         Assert::IsFalse(result.m_isValid, _T("silence must not be valid"));
+         Assert::AreEqual(0.0, result.m_peak, _T("peak of silence must be 0"));
+      }
+
+      /// tests that the kernels for all instruction sets give the same result
+      TEST_METHOD(TestInstructionSets)
+      {
+         // 7 channels use the four channel, two channel and one channel code paths
+         const unsigned int numChannels = 7;
+
+         std::mt19937 random(42);
+         std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+
+         std::vector<float> samples(48000 * numChannels * 3);
+         for (float& sample : samples)
+            sample = distribution(random);
+
+         samples[12345] = -0.75f;
+
+         LoudnessResult expected;
+         for (auto instructionSet : { Encoder::instructionSetScalar, Encoder::instructionSetSSE2, Encoder::instructionSetAVX2 })
+         {
+            SampleConverter::SetInstructionSet(instructionSet);
+
+            LoudnessAnalyzer analyzer;
+            analyzer.Init(48000, numChannels);
+
+            // odd block sizes, so that blocks don't end on sub-block boundaries
+            for (size_t offset = 0; offset < samples.size() / numChannels; offset += 1001)
+            {
+               size_t numSamples = std::min<size_t>(1001, samples.size() / numChannels - offset);
+               analyzer.AnalyzeInterleaved(samples.data() + offset * numChannels, numSamples);
+            }
+
+            LoudnessResult result = analyzer.GetResult();
+            Assert::IsTrue(result.m_isValid, _T("result must be valid"));
+            Assert::AreEqual(0.75, result.m_peak, _T("peak must match"));
+
+            if (instructionSet == Encoder::instructionSetScalar)
+               expected = result;
+            else
+               Assert::AreEqual(expected.m_loudness, result.m_loudness, 1e-6, _T("loudness must match scalar result"));
+         }
+      }
+
+      /// tests analyzing 16 bit samples from the sample container
+      TEST_METHOD(TestSampleContainer)
+      {
+         const unsigned int samplerateInHz = 44100;
+         std::vector<float> floatSamples = CreateSine(samplerateInHz * 5, std::pow(10.0, -20.0 / 20.0), samplerateInHz);
+
+         std::vector<short> shortSamples(floatSamples.size());
+         for (size_t index = 0; index < floatSamples.size(); index++)
+            shortSamples[index] = static_cast<short>(std::lround(floatSamples[index] * 32768.0f));
+
+         Encoder::SampleContainer container;
+         container.SetInputModuleTraits(16, Encoder::SamplesInterleaved, samplerateInHz, 2);
+         container.SetOutputModuleTraits(16, Encoder::SamplesInterleaved, samplerateInHz);
+
+         LoudnessAnalyzer analyzer;
+         analyzer.Init(samplerateInHz, 2);
+
+         // more samples than the analyzer converts at once
+         const int blockSize = 10000;
+         for (size_t offset = 0; offset < shortSamples.size() / 2; offset += blockSize)
+         {
+            int numSamples = static_cast<int>(std::min<size_t>(blockSize, shortSamples.size() / 2 - offset));
+            container.PutSamplesInterleaved(shortSamples.data() + offset * 2, numSamples);
+
+            analyzer.AnalyzeSamples(container);
+         }
+
+         LoudnessAnalyzer floatAnalyzer;
+         floatAnalyzer.Init(samplerateInHz, 2);
+         floatAnalyzer.AnalyzeInterleaved(floatSamples.data(), floatSamples.size() / 2);
+
+         Assert::AreEqual(floatAnalyzer.GetResult().m_loudness, analyzer.GetResult().m_loudness, 0.01,
+            _T("loudness of 16 bit samples must match float samples"));
+         Assert::AreEqual(floatAnalyzer.GetPeak(), analyzer.GetPeak(), 1e-4,
+            _T("peak of 16 bit samples must match float samples"));
+      }
+
+      /// tests calculating the album loudness from multiple tracks
+      TEST_METHOD(TestAlbum)
+      {
+         LoudnessAnalyzer loudTrack;
+         loudTrack.Init(48000, 2);
+         AnalyzeSine(loudTrack, 48000, -20.0, 10.0);
+
+         LoudnessAnalyzer quietTrack;
+         quietTrack.Init(48000, 2);
+         AnalyzeSine(quietTrack, 48000, -26.0, 10.0);
+
+         Encoder::LoudnessAlbum album;
+         album.AddTrack(_T("track1.mp3"), loudTrack);
+         album.AddTrack(_T("track2.mp3"), quietTrack);
+
+         Assert::AreEqual(size_t(2), album.GetFilenames().size(), _T("album must contain both tracks"));
+
+         // both tracks are above the relative gate, so their energies are averaged
+         double expectedLoudness = 10.0 * std::log10((std::pow(10.0, -2.0) + std::pow(10.0, -2.6)) / 2.0);
+
+         LoudnessResult result = album.GetResult();
+         Assert::IsTrue(result.m_isValid, _T("album result must be valid"));
+         Assert::AreEqual(expectedLoudness, result.m_loudness, 0.1, _T("album loudness must match"));
+         Assert::AreEqual(loudTrack.GetPeak(), result.m_peak, _T("album peak must be the peak of the loudest track"));
+      }
+
+      /// tests storing the gain values as text
+      TEST_METHOD(TestStoreGain)
+      {
+         LoudnessResult result;
+         result.m_isValid = true;
+         result.m_loudness = -11.456;
+         result.m_peak = 0.987654321;
+
+         Encoder::TrackInfo trackInfo;
+         result.StoreTrackGain(trackInfo);
+
+         bool isAvail = false;
+         CString trackGain = trackInfo.GetTextInfo(Encoder::TrackInfoTrackGain, isAvail);
+         Assert::IsTrue(isAvail, _T("track gain must be available"));
+         Assert::IsTrue(trackGain == _T("-6.54 dB"), _T("track gain must match"));
+
+         CString trackPeak = trackInfo.GetTextInfo(Encoder::TrackInfoTrackPeak, isAvail);
+         Assert::IsTrue(trackPeak == _T("0.987654"), _T("track peak must match"));
+
+         trackInfo.GetTextInfo(Encoder::TrackInfoAlbumGain, isAvail);
+         Assert::IsFalse(isAvail, _T("album gain must not be available"));
+      }
+
+   private:
+      /// creates interleaved stereo 1 kHz sine samples with given amplitude
+      static std::vector<float> CreateSine(size_t numSamples, double amplitude, unsigned int samplerateInHz)
+      {
+         const double pi = 3.14159265358979323846;
+
+         std::vector<float> samples(numSamples * 2);
+         for (size_t index = 0; index < numSamples; index++)
+            samples[index * 2] = samples[index * 2 + 1] =
+               float(amplitude * std::sin(2.0 * pi * 1000.0 * index / samplerateInHz));
+
+         return samples;
+      }
+
+      /// analyzes a stereo 1 kHz sine with given level in dBFS and duration, in seconds
+      static void AnalyzeSine(LoudnessAnalyzer& analyzer, unsigned int samplerateInHz,
+         double levelInDb, double durationInSeconds)
+      {
+         std::vector<float> samples = CreateSine(
+            static_cast<size_t>(durationInSeconds * samplerateInHz),
+            std::pow(10.0, levelInDb / 20.0),
+            samplerateInHz);
+
+         analyzer.AnalyzeInterleaved(samples.data(), samples.size() / 2);
+      }
+   };
+}
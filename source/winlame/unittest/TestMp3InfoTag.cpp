@@ -0,0 +1,201 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestMp3InfoTag.cpp
+/// \brief Tests mp3 frame header parsing and info tag generation
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "Mp3InfoTag.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for Mp3FrameHeader and Mp3InfoTag classes
+   TEST_CLASS(TestMp3InfoTag)
+   {
+   public:
+      /// tests parsing frame headers
+      TEST_METHOD(TestParseFrameHeader)
+      {
+         // MPEG 1, layer III, no CRC, 128 kbps, 44100 Hz, padding, joint stereo
+         const unsigned char mpeg1Header[4] = { 0xff, 0xfb, 0x92, 0x40 };
+
+         Encoder::Mp3FrameHeader header;
+         Assert::IsTrue(header.Parse(mpeg1Header, sizeof(mpeg1Header)), _T("header must be valid"));
+
+         Assert::IsTrue(header.m_isMpeg1, _T("must be MPEG 1"));
+         Assert::IsFalse(header.m_isMono, _T("must not be mono"));
+         Assert::IsFalse(header.m_hasCrc, _T("must not have CRC"));
+         Assert::AreEqual(128U, header.m_bitrate, _T("bitrate must match"));
+         Assert::AreEqual(44100U, header.m_samplerate, _T("sample rate must match"));
+         Assert::AreEqual(1152U, header.m_samplesPerFrame, _T("samples per frame must match"));
+         Assert::AreEqual(418U, header.m_frameLength, _T("frame length must include padding"));
+         Assert::AreEqual(32U, header.GetSideInfoLength(), _T("side info length must match"));
+
+         // MPEG 2, layer III, no CRC, 64 kbps, 22050 Hz, no padding, mono
+         const unsigned char mpeg2Header[4] = { 0xff, 0xf3, 0x80, 0xc0 };
+
+         Assert::IsTrue(header.Parse(mpeg2Header, sizeof(mpeg2Header)), _T("header must be valid"));
+
+         Assert::IsFalse(header.m_isMpeg1, _T("must be MPEG 2"));
+         Assert::IsTrue(header.m_isMono, _T("must be mono"));
+         Assert::AreEqual(64U, header.m_bitrate, _T("bitrate must match"));
+         Assert::AreEqual(22050U, header.m_samplerate, _T("sample rate must match"));
+         Assert::AreEqual(576U, header.m_samplesPerFrame, _T("samples per frame must match"));
+         Assert::AreEqual(208U, header.m_frameLength, _T("frame length must match"));
+         Assert::AreEqual(9U, header.GetSideInfoLength(), _T("side info length must match"));
+
+         // no sync, layer II, free format bitrate
+         const unsigned char noSync[4] = { 0xff, 0x7b, 0x92, 0x40 };
+         const unsigned char layer2[4] = { 0xff, 0xfd, 0x92, 0x40 };
+         const unsigned char freeFormat[4] = { 0xff, 0xfb, 0x02, 0x40 };
+
+         Assert::IsFalse(header.Parse(noSync, sizeof(noSync)), _T("header without sync must be invalid"));
+         Assert::IsFalse(header.Parse(layer2, sizeof(layer2)), _T("layer II header must be invalid"));
+         Assert::IsFalse(header.Parse(freeFormat, sizeof(freeFormat)), _T("free format header must be invalid"));
+         Assert::IsFalse(header.Parse(mpeg1Header, 3), _T("short header must be invalid"));
+      }
+
+      /// tests CRC-16 calculation, using the CRC-16/ARC check value
+      TEST_METHOD(TestCrc16)
+      {
+         const char text[] = "123456789";
+
+         Assert::AreEqual(static_cast<unsigned short>(0xbb3d),
+            Encoder::Mp3InfoTag::CalcCrc16(reinterpret_cast<const unsigned char*>(text), 9),
+            _T("CRC must match check value"));
+
+         // calculating in parts must give the same result
+         unsigned short crc = Encoder::Mp3InfoTag::CalcCrc16(reinterpret_cast<const unsigned char*>(text), 4);
+         crc = Encoder::Mp3InfoTag::CalcCrc16(reinterpret_cast<const unsigned char*>(text) + 4, 5, crc);
+
+         Assert::AreEqual(static_cast<unsigned short>(0xbb3d), crc, _T("CRC in parts must match check value"));
+      }
+
+      /// tests generating an info tag frame
+      TEST_METHOD(TestBuildFrame)
+      {
+         const unsigned int numFrames = 1000;
+
+         // CBR stream with MPEG 1, 128 kbps, 44100 Hz, joint stereo frames
+         std::vector<unsigned char> frame(417, 0);
+         frame[0] = 0xff;
+         frame[1] = 0xfb;
+         frame[2] = 0x90;
+         frame[3] = 0x40;
+
+         Encoder::Mp3InfoTag infoTag;
+         for (unsigned int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+            infoTag.AddFrame(frame.data(), frame.size());
+
+         Assert::AreEqual(size_t(numFrames), infoTag.GetNumFrames(), _T("number of frames must match"));
+
+         Encoder::Mp3InfoTagParams params;
+         params.m_isCbr = true;
+         params.m_encoderVersion = "LAME3.100";
+         params.m_vbrMethod = 1;
+         params.m_bitrate = 128;
+         params.m_encoderDelay = 576;
+         params.m_numSamples = numFrames * 1152 - 576 - 1000;
+         params.m_sourceSamplerate = 44100;
+
+         std::vector<unsigned char> tagFrame = infoTag.BuildFrame(417, params);
+
+         Assert::AreEqual(size_t(417), tagFrame.size(), _T("tag frame must have requested length"));
+
+         Encoder::Mp3FrameHeader header;
+         Assert::IsTrue(header.Parse(tagFrame.data(), tagFrame.size()), _T("tag frame must have a valid header"));
+         Assert::AreEqual(417U, header.m_frameLength, _T("tag frame header must describe requested length"));
+
+         const unsigned char* tag = tagFrame.data() + 4 + 32;
+         Assert::AreEqual(0, memcmp(tag, "Info", 4), _T("CBR tag must start with Info"));
+         Assert::AreEqual(numFrames, ReadBigEndian(tag + 8, 4), _T("number of frames must match"));
+         Assert::AreEqual(417U * (numFrames + 1), ReadBigEndian(tag + 12, 4), _T("number of bytes must include tag frame"));
+
+         // seek table must increase for a CBR stream
+         const unsigned char* seekTable = tag + 16;
+         Assert::AreEqual(0U, unsigned(seekTable[0]), _T("seek table must start at 0"));
+         Assert::AreEqual(128U, unsigned(seekTable[50]), _T("seek table must be at half of the stream"));
+         for (unsigned int percent = 1; percent < 100; percent++)
+            Assert::IsTrue(seekTable[percent] >= seekTable[percent - 1], _T("seek table must increase"));
+
+         const unsigned char* lameTag = tag + 120;
+         Assert::AreEqual(0, memcmp(lameTag, "LAME3.100", 9), _T("encoder version must match"));
+         Assert::AreEqual((576U << 12) | 1000U, ReadBigEndian(lameTag + 21, 3), _T("delay and padding must match"));
+
+         unsigned short tagCrc = Encoder::Mp3InfoTag::CalcCrc16(tagFrame.data(), size_t(lameTag + 34 - tagFrame.data()));
+         Assert::AreEqual(unsigned(tagCrc), ReadBigEndian(lameTag + 34, 2), _T("tag CRC must match"));
+
+         // a frame length that doesn't match any bitrate can't be used
+         Assert::IsTrue(infoTag.BuildFrame(100, params).empty(), _T("tag frame with invalid length must not be built"));
+      }
+
+      /// tests storing peak signal amplitude and radio replay gain in the info tag
+      TEST_METHOD(TestReplayGain)
+      {
+         std::vector<unsigned char> frame(417, 0);
+         frame[0] = 0xff;
+         frame[1] = 0xfb;
+         frame[2] = 0x90;
+         frame[3] = 0x40;
+
+         Encoder::Mp3InfoTag infoTag;
+         for (unsigned int frameIndex = 0; frameIndex < 100; frameIndex++)
+            infoTag.AddFrame(frame.data(), frame.size());
+
+         Encoder::Mp3InfoTagParams params;
+         params.m_isCbr = true;
+         params.m_encoderVersion = "LAME3.100";
+         params.m_bitrate = 128;
+
+         std::vector<unsigned char> tagFrameWithoutGain = infoTag.BuildFrame(417, params);
+
+         params.m_hasReplayGain = true;
+         params.m_peakSignalAmplitude = 0.5;
+         params.m_radioReplayGain = -6.54;
+
+         std::vector<unsigned char> tagFrame = infoTag.BuildFrame(417, params);
+
+         const unsigned char* lameTag = tagFrame.data() + 4 + 32 + 120;
+         Assert::AreEqual(0x400000U, ReadBigEndian(lameTag + 11, 4), _T("peak must be stored as 9.23 fixed point"));
+         Assert::AreEqual(0x2000U | 0x0c00U | 0x0200U | 65U, ReadBigEndian(lameTag + 15, 2),
+            _T("radio replay gain must be stored with sign and in 0.1 dB"));
+         Assert::AreEqual(0U, ReadBigEndian(lameTag + 17, 2), _T("audiophile replay gain must not be stored"));
+
+         // updating the tag frame written without gain must give the same frame
+         Assert::IsTrue(Encoder::Mp3InfoTag::UpdateReplayGain(tagFrameWithoutGain, params), _T("update must succeed"));
+         Assert::IsTrue(tagFrame == tagFrameWithoutGain, _T("updated tag frame must match built tag frame"));
+
+         // a frame without info tag can't be updated
+         Assert::IsFalse(Encoder::Mp3InfoTag::UpdateReplayGain(frame, params), _T("frame without info tag must not be updated"));
+      }
+
+   private:
+      /// reads big endian number with given number of bytes
+      static unsigned int ReadBigEndian(const unsigned char* data, unsigned int numBytes)
+      {
+         unsigned int value = 0;
+         for (unsigned int index = 0; index < numBytes; index++)
+            value = (value << 8) | data[index];
+
+         return value;
+      }
+   };
+}
@@ -0,0 +1,161 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestOutputSink.cpp
+/// \brief Tests writing encoded data through output sinks
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "OutputSink.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for FileOutputSink and MemoryOutputSink classes
+   TEST_CLASS(TestOutputSink)
+   {
+   public:
+      /// tests writing many small chunks to a file, with and without write-behind
+      TEST_METHOD(TestFileWriteAndOverwrite)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         for (bool writeBehind : { false, true })
+         {
+            CString filename = Path::Combine(folder.FolderName(), writeBehind ? _T("behind.bin") : _T("direct.bin"));
+
+            // small buffers, so that many buffers are written
+            Encoder::FileOutputSink sink(writeBehind, 4096);
+            Assert::IsTrue(sink.Open(filename), _T("file must be created"));
+            Assert::IsTrue(sink.CanOverwrite(), _T("file must be overwritable"));
+
+            std::vector<unsigned char> expected = WriteTestData(sink);
+
+            // overwrite data already written to the file, and data still in the buffer
+            const unsigned char header[4] = { 'R', 'I', 'F', 'F' };
+            Assert::IsTrue(sink.Overwrite(2, header, sizeof(header)), _T("overwriting written data must succeed"));
+            std::copy_n(header, sizeof(header), expected.begin() + 2);
+
+            Assert::IsTrue(sink.Overwrite(expected.size() - 4, header, sizeof(header)), _T("overwriting buffered data must succeed"));
+            std::copy_n(header, sizeof(header), expected.end() - 4);
+
+            Assert::IsFalse(sink.Overwrite(expected.size() - 2, header, sizeof(header)), _T("overwriting past the end must fail"));
+
+            Assert::IsTrue(sink.Write(header, sizeof(header)), _T("writing after overwriting must succeed"));
+            expected.insert(expected.end(), header, header + sizeof(header));
+
+            Assert::AreEqual<unsigned long long>(expected.size(), sink.Position(), _T("position must match number of bytes written"));
+            Assert::IsTrue(sink.Close(), _T("closing must succeed"));
+
+            Assert::IsTrue(expected == ReadFile(filename), _T("file content must match written data"));
+         }
+      }
+
+      /// tests writing to a pipe
+      TEST_METHOD(TestPipe)
+      {
+         HANDLE readHandle = nullptr;
+         HANDLE writeHandle = nullptr;
+         Assert::IsTrue(FALSE != ::CreatePipe(&readHandle, &writeHandle, nullptr, 0), _T("pipe must be created"));
+
+         std::vector<unsigned char> received;
+         std::thread readerThread([&]()
+         {
+            unsigned char buffer[1024];
+            DWORD numRead = 0;
+            while (::ReadFile(readHandle, buffer, sizeof(buffer), &numRead, nullptr) && numRead > 0)
+               received.insert(received.end(), buffer, buffer + numRead);
+         });
+
+         std::vector<unsigned char> expected;
+         {
+            Encoder::FileOutputSink sink(true, 4096);
+            Assert::IsTrue(sink.Attach(writeHandle), _T("attaching pipe must succeed"));
+            Assert::IsFalse(sink.CanOverwrite(), _T("pipe must not be overwritable"));
+
+            expected = WriteTestData(sink);
+
+            const unsigned char data[2] = { 1, 2 };
+            Assert::IsFalse(sink.Overwrite(0, data, sizeof(data)), _T("pipe can't be seeked"));
+
+            Assert::IsTrue(sink.Close(), _T("closing must succeed"));
+         }
+
+         // the sink doesn't close attached handles
+         ::CloseHandle(writeHandle);
+         readerThread.join();
+         ::CloseHandle(readHandle);
+
+         Assert::IsTrue(expected == received, _T("received data must match written data"));
+      }
+
+      /// tests writing to memory
+      TEST_METHOD(TestMemory)
+      {
+         Encoder::MemoryOutputSink sink;
+
+         std::vector<unsigned char> expected = WriteTestData(sink);
+
+         const unsigned char data[2] = { 1, 2 };
+         Assert::IsTrue(sink.Overwrite(10, data, sizeof(data)), _T("overwriting must succeed"));
+         std::copy_n(data, sizeof(data), expected.begin() + 10);
+
+         Assert::IsFalse(sink.Overwrite(expected.size() - 1, data, sizeof(data)), _T("overwriting past the end must fail"));
+
+         Assert::IsTrue(sink.Close(), _T("closing must succeed"));
+
+         Assert::IsTrue(expected == sink.GetData(), _T("data must match written data"));
+      }
+
+   private:
+      /// writes test data in small chunks of different sizes; returns all data written
+      static std::vector<unsigned char> WriteTestData(Encoder::OutputSink& sink)
+      {
+         std::vector<unsigned char> data;
+
+         for (unsigned int chunkIndex = 0; chunkIndex < 2000; chunkIndex++)
+         {
+            std::vector<unsigned char> chunk(chunkIndex % 97 + 1);
+            for (size_t index = 0; index < chunk.size(); index++)
+               chunk[index] = static_cast<unsigned char>(chunkIndex + index);
+
+            Assert::IsTrue(sink.Write(chunk.data(), chunk.size()), _T("writing must succeed"));
+
+            data.insert(data.end(), chunk.begin(), chunk.end());
+         }
+
+         return data;
+      }
+
+      /// reads whole file
+      static std::vector<unsigned char> ReadFile(const CString& filename)
+      {
+         std::ifstream stream(filename.GetString(), std::ios::in | std::ios::binary);
+
+         return std::vector<unsigned char>(
+            std::istreambuf_iterator<char>(stream),
+            std::istreambuf_iterator<char>());
+      }
+   };
+}
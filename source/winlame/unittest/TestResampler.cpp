@@ -0,0 +1,224 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestResampler.cpp
+/// \brief Tests the polyphase resampler and resampling in the sample container
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "Resampler.hpp"
+#include "SampleContainer.hpp"
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using Encoder::Resampler;
+using Encoder::SampleConverter;
+
+namespace unittest
+{
+   /// tests for Resampler class
+   TEST_CLASS(TestResampler)
+   {
+   public:
+      /// resets instruction set after each test
+      TEST_METHOD_CLEANUP(TearDown)
+      {
+         SampleConverter::SetInstructionSet(SampleConverter::GetSupportedInstructionSet());
+      }
+
+      /// tests that a sine tone keeps its frequency and amplitude
+      TEST_METHOD(TestSineTone)
+      {
+         for (int quality = Encoder::resamplerQualityFast; quality <= Encoder::resamplerQualityBest; quality++)
+         {
+            Resampler resampler;
+            Assert::IsTrue(resampler.Init(44100, 48000, 1, Encoder::ResamplerQuality(quality)), _T("init must succeed"));
+
+            std::vector<float> output = ResampleAll(resampler, CreateSine(44100, 1000.0, 44100, 1), 4096);
+
+            // skip the start and end, where the filter runs over the zeros outside the signal
+            double sum = 0.0;
+            size_t numZeroCrossings = 0;
+            for (size_t index = 1000; index < 47000; index++)
+            {
+               sum += double(output[index]) * output[index];
+               if ((output[index - 1] < 0.0f) != (output[index] < 0.0f))
+                  numZeroCrossings++;
+            }
+
+            double amplitude = std::sqrt(2.0 * sum / 46000);
+
+            Assert::AreEqual(0.5, amplitude, 0.005, _T("amplitude must be preserved"));
+            Assert::AreEqual(1917.0, double(numZeroCrossings), 2.0, _T("frequency must be preserved"));
+         }
+      }
+
+      /// tests the number of output samples, for several sample rate ratios
+      TEST_METHOD(TestNumOutputSamples)
+      {
+         const int samplerates[][2] =
+         {
+            { 44100, 48000 }, { 48000, 44100 }, { 44100, 8000 }, { 8000, 44100 }, { 44100, 44101 },
+         };
+
+         for (const auto& samplerate : samplerates)
+         {
+            Resampler resampler;
+            Assert::IsTrue(resampler.Init(samplerate[0], samplerate[1], 2, Encoder::resamplerQualityMedium), _T("init must succeed"));
+
+            const size_t numInputSamples = 12345;
+            std::vector<float> output = ResampleAll(resampler, CreateSine(numInputSamples, 440.0, samplerate[0], 2), 1000);
+
+            // last output sample lines up with the last input sample, or lies before it
+            size_t expected = size_t((numInputSamples * (unsigned long long)samplerate[1] + samplerate[0] - 1) / samplerate[0]);
+
+            Assert::AreEqual(expected * 2, output.size(), _T("number of output samples must match sample rate ratio"));
+         }
+      }
+
+      /// tests that the output doesn't depend on the block sizes passed to Process()
+      TEST_METHOD(TestBlockSizes)
+      {
+         std::vector<float> input = CreateSine(10000, 1000.0, 44100, 2);
+
+         Resampler resampler;
+         resampler.Init(44100, 48000, 2, Encoder::resamplerQualityBest);
+
+         std::vector<float> expected = ResampleAll(resampler, input, input.size() / 2);
+
+         for (size_t blockSize : { 1, 7, 64, 1152, 4096 })
+         {
+            std::vector<float> output = ResampleAll(resampler, input, blockSize);
+
+            Assert::IsTrue(expected == output, _T("output must not depend on block size"));
+         }
+      }
+
+      /// tests that all instruction sets calculate the same output
+      TEST_METHOD(TestInstructionSets)
+      {
+         std::vector<float> input = CreateSine(10000, 3000.0, 48000, 2);
+
+         SampleConverter::SetInstructionSet(Encoder::instructionSetScalar);
+
+         Resampler resampler;
+         resampler.Init(48000, 44100, 2, Encoder::resamplerQualityMedium);
+
+         std::vector<float> expected = ResampleAll(resampler, input, 4096);
+
+         for (int instructionSet = Encoder::instructionSetSSE2;
+            instructionSet <= SampleConverter::GetSupportedInstructionSet();
+            instructionSet++)
+         {
+            SampleConverter::SetInstructionSet(Encoder::SampleConverterInstructionSet(instructionSet));
+
+            resampler.Init(48000, 44100, 2, Encoder::resamplerQualityMedium);
+
+            std::vector<float> output = ResampleAll(resampler, input, 4096);
+
+            Assert::AreEqual(expected.size(), output.size(), _T("number of samples must match"));
+            for (size_t index = 0; index < expected.size(); index++)
+               Assert::AreEqual(expected[index], output[index], 1e-5f, _T("samples must match scalar output"));
+         }
+      }
+
+      /// tests resampling in the sample container
+      TEST_METHOD(TestSampleContainer)
+      {
+         Encoder::SampleContainer container;
+         container.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 44100, 2);
+         container.SetOutputModuleTraits(16, Encoder::SamplesInterleaved, 48000);
+
+         Assert::IsFalse(container.IsPassthrough(), _T("different sample rates must not be passed through"));
+
+         std::vector<short> input(44100 * 2, 1000);
+
+         int numOutputSamples = 0;
+         for (size_t offset = 0; offset < 44100; offset += 4096)
+         {
+            int numBlockSamples = static_cast<int>(std::min<size_t>(4096, 44100 - offset));
+            container.PutSamplesInterleaved(input.data() + offset * 2, numBlockSamples);
+
+            int numSamples = 0;
+            short* samples = static_cast<short*>(container.GetSamplesInterleaved(numSamples));
+
+            if (offset == 8192)
+               Assert::AreEqual(1000, int(samples[0]), _T("DC value must be preserved"));
+
+            numOutputSamples += numSamples;
+         }
+
+         numOutputSamples += container.FlushSamples();
+
+         Assert::AreEqual(48000, numOutputSamples, _T("one second of samples must be returned"));
+         Assert::AreEqual(0, container.FlushSamples(), _T("second flush must not return samples"));
+
+         // with resampling turned off, the samples are passed as they are
+         Encoder::SampleContainer unresampled;
+         unresampled.SetResamplerQuality(Encoder::resamplerQualityOff);
+         unresampled.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 44100, 2);
+         unresampled.SetOutputModuleTraits(16, Encoder::SamplesInterleaved, 48000);
+
+         unresampled.PutSamplesInterleaved(input.data(), 4096);
+
+         int numSamples = 0;
+         unresampled.GetSamplesInterleaved(numSamples);
+
+         Assert::AreEqual(4096, numSamples, _T("samples must not be resampled"));
+         Assert::AreEqual(0, unresampled.FlushSamples(), _T("flush must not return samples"));
+      }
+
+   private:
+      /// creates interleaved sine tone samples with amplitude 0.5 on all channels
+      static std::vector<float> CreateSine(size_t numSamples, double frequency, int samplerateInHz, size_t numChannels)
+      {
+         const double pi = 3.14159265358979323846;
+
+         std::vector<float> samples(numSamples * numChannels);
+         for (size_t index = 0; index < numSamples; index++)
+            for (size_t channel = 0; channel < numChannels; channel++)
+               samples[index * numChannels + channel] = float(0.5 * std::sin(2.0 * pi * frequency * index / samplerateInHz));
+
+         return samples;
+      }
+
+      /// resamples all samples, passing blocks of given size, and flushes the resampler
+      static std::vector<float> ResampleAll(Resampler& resampler, const std::vector<float>& input, size_t blockSize)
+      {
+         size_t numChannels = resampler.GetNumChannels();
+         size_t numInputSamples = input.size() / numChannels;
+
+         std::vector<float> output;
+         std::vector<float> buffer(
+            std::max(resampler.GetMaxOutputSamples(blockSize), resampler.GetMaxFlushSamples()) * numChannels);
+
+         for (size_t offset = 0; offset < numInputSamples; offset += blockSize)
+         {
+            size_t numBlockSamples = std::min(blockSize, numInputSamples - offset);
+            size_t numSamples = resampler.Process(input.data() + offset * numChannels, numBlockSamples, buffer.data());
+
+            output.insert(output.end(), buffer.begin(), buffer.begin() + numSamples * numChannels);
+         }
+
+         size_t numSamples = resampler.Flush(buffer.data());
+         output.insert(output.end(), buffer.begin(), buffer.begin() + numSamples * numChannels);
+
+         return output;
+      }
+   };
+}
@@ -0,0 +1,361 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestSampleBlockQueue.cpp
+/// \brief Tests and benchmarks passing sample blocks between threads
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "SampleBlockQueue.hpp"
+#include <chrono>
+#include <condition_variable>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for SampleBlockQueue class
+   TEST_CLASS(TestSampleBlockQueue)
+   {
+   public:
+      /// tests that all blocks arrive in order, with a queue smaller than the number of blocks
+      TEST_METHOD(TestProducerConsumerOrder)
+      {
+         Encoder::SampleContainer traits;
+         traits.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 44100, 1);
+         traits.SetOutputModuleTraits(16, Encoder::SamplesInterleaved);
+
+         Encoder::SampleBlockQueue queue(3, traits);
+
+         const int numBlocks = 1000;
+
+         std::thread producerThread([&]()
+         {
+            for (short blockIndex = 0; blockIndex < numBlocks; blockIndex++)
+            {
+               Encoder::SampleBlock* block = queue.BeginWrite();
+               if (block == nullptr)
+                  return;
+
+               // borrowed samples must be copied before the buffer is reused
+               short samples[2] = { blockIndex, short(-blockIndex) };
+               block->m_samples.PutSamplesInterleavedBorrowed(samples, 2);
+               block->m_samples.ReleaseBorrowedSamples();
+
+               block->m_percentDone = float(blockIndex);
+
+               queue.EndWrite();
+            }
+
+            queue.CloseWrite();
+         });
+
+         int numBlocksRead = 0;
+         for (;;)
+         {
+            Encoder::SampleBlock* block = queue.BeginRead();
+            if (block == nullptr)
+               break;
+
+            int numSamples = 0;
+            const short* samples = static_cast<const short*>(block->m_samples.GetSamplesInterleaved(numSamples));
+
+            Assert::AreEqual(2, numSamples, _T("number of samples must match"));
+            Assert::AreEqual(short(numBlocksRead), samples[0], _T("first sample must match"));
+            Assert::AreEqual(short(-numBlocksRead), samples[1], _T("second sample must match"));
+            Assert::AreEqual(float(numBlocksRead), block->m_percentDone, _T("block info must match"));
+
+            queue.EndRead();
+            numBlocksRead++;
+         }
+
+         producerThread.join();
+
+         Assert::AreEqual(numBlocks, numBlocksRead, _T("all blocks must have been read"));
+      }
+
+      /// tests that cancelling the queue releases a producer waiting for a free block
+      TEST_METHOD(TestCancelReleasesProducer)
+      {
+         Encoder::SampleContainer traits;
+         traits.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 44100, 2);
+         traits.SetOutputModuleTraits(16, Encoder::SamplesInterleaved);
+
+         Encoder::SampleBlockQueue queue(2, traits);
+
+         std::atomic<int> numBlocksWritten = 0;
+
+         std::thread producerThread([&]()
+         {
+            while (queue.BeginWrite() != nullptr)
+            {
+               queue.EndWrite();
+               numBlocksWritten++;
+            }
+         });
+
+         // the producer fills the queue and then has to wait
+         while (numBlocksWritten < 2)
+            std::this_thread::yield();
+
+         Sleep(10);
+         Assert::AreEqual(2, numBlocksWritten.load(), _T("producer must wait for free blocks"));
+
+         queue.Cancel();
+         producerThread.join();
+
+         Assert::IsTrue(queue.BeginRead() == nullptr, _T("cancelled queue must not return blocks"));
+      }
+
+      /// tests that the number of blocks is rounded up to a power of two
+      TEST_METHOD(TestNumBlocksRoundedUp)
+      {
+         Encoder::SampleContainer traits;
+         traits.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 44100, 2);
+         traits.SetOutputModuleTraits(16, Encoder::SamplesInterleaved);
+
+         Assert::AreEqual(size_t(1), Encoder::SampleBlockQueue(1, traits).GetNumBlocks(), _T("1 block must stay 1 block"));
+         Assert::AreEqual(size_t(4), Encoder::SampleBlockQueue(3, traits).GetNumBlocks(), _T("3 blocks must be rounded up"));
+         Assert::AreEqual(size_t(8), Encoder::SampleBlockQueue(8, traits).GetNumBlocks(), _T("8 blocks must stay 8 blocks"));
+      }
+
+      /// tests that the preferred block size is a multiple of the output module frame
+      /// size, and that the blocks of the queue use the same block size
+      TEST_METHOD(TestPreferredBlockSize)
+      {
+         Encoder::SampleContainer traits;
+         traits.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 44100, 2);
+         traits.SetOutputModuleTraits(16, Encoder::SamplesInterleaved);
+
+         Assert::AreEqual(Encoder::SampleContainer::c_defaultBlockSize, traits.GetPreferredBlockSize(),
+            _T("block size without frame size must be the default block size"));
+
+         traits.SetOutputModuleFrameSize(1152);
+         Assert::AreEqual(3 * 1152, traits.GetPreferredBlockSize(), _T("block size must contain whole LAME frames"));
+
+         traits.SetOutputModuleFrameSize(1024);
+         Assert::AreEqual(4 * 1024, traits.GetPreferredBlockSize(), _T("block size must contain whole AAC frames"));
+
+         traits.SetOutputModuleFrameSize(8192);
+         Assert::AreEqual(8192, traits.GetPreferredBlockSize(), _T("block size must contain at least one frame"));
+
+         traits.SetOutputModuleFrameSize(960);
+         Encoder::SampleBlockQueue queue(2, traits);
+
+         Encoder::SampleBlock* block = queue.BeginWrite();
+         Assert::IsTrue(block != nullptr, _T("queue must return a block"));
+         Assert::AreEqual(traits.GetPreferredBlockSize(), block->m_samples.GetPreferredBlockSize(),
+            _T("block must use the same block size"));
+
+         queue.EndWrite();
+      }
+
+      /// tests that closing an empty queue ends a waiting consumer
+      TEST_METHOD(TestCloseWriteReleasesConsumer)
+      {
+         Encoder::SampleContainer traits;
+         traits.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 44100, 2);
+         traits.SetOutputModuleTraits(16, Encoder::SamplesInterleaved);
+
+         Encoder::SampleBlockQueue queue(4, traits);
+
+         std::thread consumerThread([&]()
+         {
+            Assert::IsTrue(queue.BeginRead() != nullptr, _T("first block must be read"));
+            queue.EndRead();
+
+            Assert::IsTrue(queue.BeginRead() == nullptr, _T("closed queue must end the stream"));
+         });
+
+         queue.BeginWrite();
+         queue.EndWrite();
+
+         Sleep(10);
+         queue.CloseWrite();
+
+         consumerThread.join();
+      }
+
+      /// \brief measures throughput of passing blocks between two threads
+      /// \details compares the lock-free ring with a queue based on a mutex and a
+      /// condition variable; results are written to the test output
+      TEST_METHOD(BenchmarkSampleBlockQueue)
+      {
+         const int numSamplesPerBlock = 1152;
+         const int numChannels = 2;
+         const size_t numBlocks = 8;
+         const int numBlocksTotal = 100000;
+
+         Encoder::SampleContainer traits;
+         traits.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 44100, numChannels);
+         traits.SetOutputModuleTraits(16, Encoder::SamplesInterleaved);
+
+         std::vector<short> samples(numSamplesPerBlock * numChannels);
+
+         Encoder::SampleBlockQueue lockFreeQueue(numBlocks, traits, numSamplesPerBlock);
+         double lockFreeSeconds = MeasureProducerConsumer(lockFreeQueue, samples, numSamplesPerBlock, numBlocksTotal);
+
+         MutexSampleBlockQueue mutexQueue(numBlocks, traits);
+         double mutexSeconds = MeasureProducerConsumer(mutexQueue, samples, numSamplesPerBlock, numBlocksTotal);
+
+         LogThroughput(_T("mutex"), numBlocksTotal, numSamplesPerBlock, mutexSeconds, mutexSeconds);
+         LogThroughput(_T("lock-free"), numBlocksTotal, numSamplesPerBlock, lockFreeSeconds, mutexSeconds);
+      }
+
+   private:
+      /// \brief sample block queue protected by a mutex and a condition variable
+      /// \details used as reference for the benchmark
+      class MutexSampleBlockQueue
+      {
+      public:
+         /// ctor
+         MutexSampleBlockQueue(size_t numBlocks, const Encoder::SampleContainer& traits)
+            :m_blocks(numBlocks)
+         {
+            for (auto& block : m_blocks)
+               block.m_samples.CopyModuleTraits(traits);
+         }
+
+         /// returns next free block
+         Encoder::SampleBlock* BeginWrite()
+         {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_conditionChanged.wait(lock, [&]() { return m_numFilledBlocks < m_blocks.size(); });
+            return &m_blocks[m_writeIndex];
+         }
+
+         /// passes block to consumer
+         void EndWrite()
+         {
+            {
+               std::unique_lock<std::mutex> lock(m_mutex);
+               m_writeIndex = (m_writeIndex + 1) % m_blocks.size();
+               m_numFilledBlocks++;
+            }
+
+            m_conditionChanged.notify_all();
+         }
+
+         /// marks end of stream
+         void CloseWrite()
+         {
+            {
+               std::unique_lock<std::mutex> lock(m_mutex);
+               m_writeClosed = true;
+            }
+
+            m_conditionChanged.notify_all();
+         }
+
+         /// returns next filled block, or nullptr at end of stream
+         Encoder::SampleBlock* BeginRead()
+         {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_conditionChanged.wait(lock, [&]() { return m_writeClosed || m_numFilledBlocks > 0; });
+            return m_numFilledBlocks > 0 ? &m_blocks[m_readIndex] : nullptr;
+         }
+
+         /// returns block to producer
+         void EndRead()
+         {
+            {
+               std::unique_lock<std::mutex> lock(m_mutex);
+               m_readIndex = (m_readIndex + 1) % m_blocks.size();
+               m_numFilledBlocks--;
+            }
+
+            m_conditionChanged.notify_all();
+         }
+
+      private:
+         /// all blocks
+         std::vector<Encoder::SampleBlock> m_blocks;
+
+         /// index of next block to write
+         size_t m_writeIndex = 0;
+
+         /// index of next block to read
+         size_t m_readIndex = 0;
+
+         /// number of filled blocks
+         size_t m_numFilledBlocks = 0;
+
+         /// indicates if the producer closed the stream
+         bool m_writeClosed = false;
+
+         /// mutex to protect queue state
+         std::mutex m_mutex;
+
+         /// condition that is signaled when queue state changes
+         std::condition_variable m_conditionChanged;
+      };
+
+      /// passes blocks with samples from a producer to a consumer thread; returns seconds taken
+      template <typename TQueue>
+      static double MeasureProducerConsumer(TQueue& queue, std::vector<short>& samples,
+         int numSamplesPerBlock, int numBlocksTotal)
+      {
+         auto start = std::chrono::steady_clock::now();
+
+         std::thread producerThread([&]()
+         {
+            for (int blockIndex = 0; blockIndex < numBlocksTotal; blockIndex++)
+            {
+               Encoder::SampleBlock* block = queue.BeginWrite();
+               if (block == nullptr)
+                  break;
+
+               block->m_samples.PutSamplesInterleaved(samples.data(), numSamplesPerBlock);
+               queue.EndWrite();
+            }
+
+            queue.CloseWrite();
+         });
+
+         int numBlocksRead = 0;
+         for (Encoder::SampleBlock* block = queue.BeginRead(); block != nullptr; block = queue.BeginRead())
+         {
+            int numSamples = 0;
+            block->m_samples.GetSamplesInterleaved(numSamples);
+
+            queue.EndRead();
+            numBlocksRead++;
+         }
+
+         producerThread.join();
+
+         Assert::AreEqual(numBlocksTotal, numBlocksRead, _T("all blocks must have been read"));
+
+         return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+
+      /// writes throughput of a queue to test output
+      static void LogThroughput(LPCTSTR queueName, int numBlocksTotal, int numSamplesPerBlock,
+         double seconds, double referenceSeconds)
+      {
+         CString text;
+         text.Format(_T("%-10s: %8.1f kBlocks/s, %8.1f MSamples/s, speedup %5.1fx\n"),
+            queueName,
+            numBlocksTotal / seconds / 1e3,
+            double(numBlocksTotal) * numSamplesPerBlock / seconds / 1e6,
+            referenceSeconds / seconds);
+
+         Logger::WriteMessage(text.GetString());
+      }
+   };
+}
@@ -0,0 +1,549 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestSampleConverter.cpp
+/// \brief Tests and benchmarks the sample conversion kernels
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "SampleConverter.hpp"
+#include "SampleContainer.hpp"
+#include <chrono>
+#include <random>
+#include <limits>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using Encoder::SampleConverter;
+using Encoder::SampleType;
+
+namespace unittest
+{
+   /// tests for SampleConverter class
+   TEST_CLASS(TestSampleConverter)
+   {
+   public:
+      /// resets instruction set after each test
+      TEST_METHOD_CLEANUP(TearDown)
+      {
+         SampleConverter::SetInstructionSet(SampleConverter::GetSupportedInstructionSet());
+      }
+
+      /// tests converting known values between integer sample types
+      TEST_METHOD(TestConvertIntegerValues)
+      {
+         const short samples16[] = { 0, 1, -1, 32767, -32768, 0x1234 };
+         int samples32[_countof(samples16)] = {};
+
+         SampleConverter::InterleavedToInterleaved(samples16, Encoder::SampleTypeInt16,
+            samples32, Encoder::SampleTypeInt32, _countof(samples16), 1);
+
+         for (size_t index = 0; index < _countof(samples16); index++)
+            Assert::AreEqual(int(samples16[index]) * 65536, samples32[index], _T("16 bit samples must be shifted up"));
+
+         const int roundSamples[] = { 0x00007fff, 0x00008000, -0x00008000, -0x00008001, std::numeric_limits<int>::max() };
+         const short expected16[] = { 0, 1, 0, -1, 32767 };
+         short result16[_countof(roundSamples)] = {};
+
+         SampleConverter::InterleavedToInterleaved(roundSamples, Encoder::SampleTypeInt32,
+            result16, Encoder::SampleTypeInt16, _countof(roundSamples), 1);
+
+         for (size_t index = 0; index < _countof(roundSamples); index++)
+            Assert::AreEqual(expected16[index], result16[index], _T("32 bit samples must be rounded to nearest without overflow"));
+      }
+
+      /// tests converting float values, with clipping
+      TEST_METHOD(TestConvertFloatValues)
+      {
+         const float samples[] = { 0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f };
+         const short expected16[] = { 0, 16384, -16384, 32767, -32768, 32767, -32768 };
+         short result16[_countof(samples)] = {};
+
+         SampleConverter::InterleavedToInterleaved(samples, Encoder::SampleTypeFloat32,
+            result16, Encoder::SampleTypeInt16, _countof(samples), 1);
+
+         for (size_t index = 0; index < _countof(samples); index++)
+            Assert::AreEqual(expected16[index], result16[index], _T("float samples must be scaled and clipped"));
+
+         float resultFloat[_countof(expected16)] = {};
+         SampleConverter::InterleavedToInterleaved(expected16, Encoder::SampleTypeInt16,
+            resultFloat, Encoder::SampleTypeFloat32, _countof(expected16), 1);
+
+         Assert::AreEqual(0.5f, resultFloat[1], _T("16 bit sample must be converted to float"));
+         Assert::AreEqual(-1.0f, resultFloat[4], _T("16 bit sample must be converted to float"));
+      }
+
+      /// tests that all instruction sets and all layouts produce the same samples
+      TEST_METHOD(TestAllKernelsMatchScalar)
+      {
+         std::mt19937 random(42);
+
+         for (size_t numChannels = 1; numChannels <= 8; numChannels++)
+         {
+            for (size_t numSamples : { 1, 7, 8, 17, 1001 })
+            {
+               for (int sourceType = 0; sourceType < Encoder::SampleTypeMax; sourceType++)
+               {
+                  std::vector<unsigned char> source = CreateRandomSamples(random,
+                     SampleType(sourceType), numSamples * numChannels);
+
+                  for (int targetType = 0; targetType < Encoder::SampleTypeMax; targetType++)
+                  {
+                     SampleConverter::SetInstructionSet(Encoder::instructionSetScalar);
+                     std::vector<unsigned char> expected = ConvertAllLayouts(
+                        source, SampleType(sourceType), SampleType(targetType), numSamples, numChannels);
+
+                     for (int instructionSet = Encoder::instructionSetSSE2;
+                        instructionSet <= SampleConverter::GetSupportedInstructionSet();
+                        instructionSet++)
+                     {
+                        SampleConverter::SetInstructionSet(Encoder::SampleConverterInstructionSet(instructionSet));
+
+                        std::vector<unsigned char> actual = ConvertAllLayouts(
+                           source, SampleType(sourceType), SampleType(targetType), numSamples, numChannels);
+
+                        Assert::IsTrue(expected == actual, _T("vectorized kernels must produce the same samples as scalar kernels"));
+                     }
+                  }
+               }
+            }
+         }
+      }
+
+      /// tests that samples stored in the lower bits of 32 bit integers are converted like
+      /// the same samples aligned to 32 bit
+      TEST_METHOD(TestConvertLowBitsSamples)
+      {
+         std::mt19937 random(11);
+
+         const size_t numChannels = 3;
+         const size_t numSamples = 257;
+
+         for (unsigned int sourceBits : { 8U, 16U, 20U, 24U, 32U })
+         {
+            // right-aligned source samples, and the same samples aligned to 32 bit
+            std::vector<std::vector<int>> sourceArray(numChannels, std::vector<int>(numSamples));
+            std::vector<int> alignedInterleaved(numSamples * numChannels);
+            std::vector<const int*> sourcePointers;
+
+            for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+            {
+               for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+               {
+                  int aligned = static_cast<int>(random() << (32 - sourceBits));
+
+                  sourceArray[channelIndex][sampleIndex] = aligned >> (32 - sourceBits);
+                  alignedInterleaved[sampleIndex * numChannels + channelIndex] = aligned;
+               }
+
+               sourcePointers.push_back(sourceArray[channelIndex].data());
+            }
+
+            for (int targetType = 0; targetType < Encoder::SampleTypeMax; targetType++)
+            {
+               const unsigned int targetSize = SampleConverter::GetSampleSize(SampleType(targetType));
+
+               std::vector<unsigned char> expected(numSamples * numChannels * targetSize);
+               SampleConverter::InterleavedToInterleaved(alignedInterleaved.data(), Encoder::SampleTypeInt32,
+                  expected.data(), SampleType(targetType), numSamples, numChannels);
+
+               std::vector<unsigned char> interleaved(expected.size());
+               SampleConverter::LowBitsArrayToInterleaved(sourcePointers.data(), sourceBits,
+                  interleaved.data(), SampleType(targetType), numSamples, numChannels);
+
+               Assert::IsTrue(expected == interleaved, _T("low bits to interleaved conversion must match"));
+
+               std::vector<std::vector<unsigned char>> targetArray(numChannels, std::vector<unsigned char>(numSamples * targetSize));
+               std::vector<void*> targetPointers;
+               for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+                  targetPointers.push_back(targetArray[channelIndex].data());
+
+               SampleConverter::LowBitsArrayToArray(sourcePointers.data(), sourceBits,
+                  targetPointers.data(), SampleType(targetType), numSamples, numChannels);
+
+               CheckArrayMatchesInterleaved(targetArray, expected, targetSize);
+            }
+         }
+      }
+
+      /// tests that the sample container still produces the same samples as the previous per-channel code
+      TEST_METHOD(TestSampleContainerMatchesPerChannelConversion)
+      {
+         std::mt19937 random(7);
+
+         const int numChannels = 6;
+         const int numSamples = 999;
+
+         for (int sourceBits : { 16, 24, 32 })
+         {
+            std::vector<unsigned char> source = CreateRandomSamples(random,
+               SampleConverter::SampleTypeFromBitsPerSample(sourceBits), numSamples * numChannels);
+
+            for (int targetBits : { 16, 32 })
+            {
+               Encoder::SampleContainer container;
+               container.SetInputModuleTraits(sourceBits, Encoder::SamplesInterleaved, 44100, numChannels);
+               container.SetOutputModuleTraits(targetBits, Encoder::SamplesInterleaved);
+
+               container.PutSamplesInterleaved(source.data(), numSamples);
+
+               int numSamplesOut = 0;
+               const unsigned char* actual = static_cast<const unsigned char*>(container.GetSamplesInterleaved(numSamplesOut));
+
+               std::vector<unsigned char> expected = ConvertPerChannel(source, sourceBits, targetBits, numSamples, numChannels);
+
+               Assert::AreEqual(numSamples, numSamplesOut, _T("number of samples must match"));
+               Assert::IsTrue(memcmp(expected.data(), actual, expected.size()) == 0, _T("samples must match per-channel conversion"));
+            }
+         }
+      }
+
+      /// tests that borrowed samples are passed through without copying when traits match
+      TEST_METHOD(TestSampleContainerBorrowedPassthrough)
+      {
+         std::mt19937 random(11);
+
+         const int numChannels = 2;
+         const int numSamples = 512;
+
+         std::vector<unsigned char> source = CreateRandomSamples(random, Encoder::SampleTypeInt16, numSamples * numChannels);
+
+         Encoder::SampleContainer container;
+         container.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 44100, numChannels);
+         container.SetOutputModuleTraits(16, Encoder::SamplesInterleaved);
+
+         Assert::IsTrue(container.IsPassthrough(), _T("matching traits must enable passthrough"));
+
+         container.PutSamplesInterleavedBorrowed(source.data(), numSamples);
+
+         int numSamplesOut = 0;
+         void* actual = container.GetSamplesInterleaved(numSamplesOut);
+
+         Assert::AreEqual(numSamples, numSamplesOut, _T("number of samples must match"));
+         Assert::IsTrue(actual == source.data(), _T("borrowed buffer must be passed through"));
+
+         // a non-borrowing put must not return the previously borrowed buffer
+         container.PutSamplesInterleaved(source.data(), numSamples / 2);
+         actual = container.GetSamplesInterleaved(numSamplesOut);
+
+         Assert::AreEqual(numSamples / 2, numSamplesOut, _T("number of samples must match"));
+         Assert::IsTrue(actual != source.data(), _T("copied samples must be stored in the container"));
+         Assert::IsTrue(memcmp(source.data(), actual, numSamples / 2 * numChannels * sizeof(short)) == 0, _T("copied samples must match"));
+      }
+
+      /// tests that borrowed samples are converted when traits don't match
+      TEST_METHOD(TestSampleContainerBorrowedConversion)
+      {
+         std::mt19937 random(13);
+
+         const int numChannels = 2;
+         const int numSamples = 512;
+
+         std::vector<unsigned char> source = CreateRandomSamples(random, Encoder::SampleTypeInt16, numSamples * numChannels);
+
+         Encoder::SampleContainer container;
+         container.SetInputModuleTraits(16, Encoder::SamplesInterleaved, 44100, numChannels);
+         container.SetOutputModuleTraits(32, Encoder::SamplesInterleaved);
+
+         Assert::IsFalse(container.IsPassthrough(), _T("different sample types must disable passthrough"));
+
+         container.PutSamplesInterleavedBorrowed(source.data(), numSamples);
+
+         int numSamplesOut = 0;
+         const unsigned char* actual = static_cast<const unsigned char*>(container.GetSamplesInterleaved(numSamplesOut));
+
+         std::vector<unsigned char> expected = ConvertPerChannel(source, 16, 32, numSamples, numChannels);
+
+         Assert::AreEqual(numSamples, numSamplesOut, _T("number of samples must match"));
+         Assert::IsTrue(actual != source.data(), _T("converted samples must be stored in the container"));
+         Assert::IsTrue(memcmp(expected.data(), actual, expected.size()) == 0, _T("samples must be converted"));
+      }
+
+      /// tests float input and output module traits in the sample container
+      TEST_METHOD(TestSampleContainerFloatTraits)
+      {
+         const int numChannels = 2;
+         const float source[] = { 0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 0.25f };
+         const int numSamples = _countof(source) / numChannels;
+
+         Encoder::SampleContainer container;
+         container.SetInputModuleFloatTraits(Encoder::SamplesInterleaved, 48000, numChannels);
+
+         Assert::IsTrue(container.IsInputModuleFloat(), _T("input module must deliver float samples"));
+         Assert::AreEqual(32, container.GetInputModuleBitsPerSample(), _T("float samples must have 32 bits"));
+
+         // float to float is passed through
+         {
+            Encoder::SampleContainer floatContainer;
+            floatContainer.SetInputModuleFloatTraits(Encoder::SamplesInterleaved, 48000, numChannels);
+            floatContainer.SetOutputModuleFloatTraits(Encoder::SamplesInterleaved);
+
+            Assert::IsTrue(floatContainer.IsPassthrough(), _T("float to float must enable passthrough"));
+         }
+
+         // float to 32-bit integer must not be passed through
+         {
+            Encoder::SampleContainer intContainer;
+            intContainer.SetInputModuleFloatTraits(Encoder::SamplesInterleaved, 48000, numChannels);
+            intContainer.SetOutputModuleTraits(32, Encoder::SamplesInterleaved);
+
+            Assert::IsFalse(intContainer.IsPassthrough(), _T("float to integer must be converted"));
+         }
+
+         // float to 16-bit channel array
+         container.SetOutputModuleTraits(16, Encoder::SamplesChannelArray);
+         Assert::IsFalse(container.IsOutputModuleFloat(), _T("output module must accept integer samples"));
+
+         container.PutSamplesInterleavedBorrowed(const_cast<float*>(source), numSamples);
+
+         int numSamplesOut = 0;
+         short** actual = reinterpret_cast<short**>(container.GetSamplesArray(numSamplesOut));
+
+         const short expectedLeft[] = { 0, -16384, -32768 };
+         const short expectedRight[] = { 16384, 32767, 8192 };
+
+         Assert::AreEqual(numSamples, numSamplesOut, _T("number of samples must match"));
+         for (int index = 0; index < numSamples; index++)
+         {
+            Assert::AreEqual(expectedLeft[index], actual[0][index], _T("left channel samples must match"));
+            Assert::AreEqual(expectedRight[index], actual[1][index], _T("right channel samples must match"));
+         }
+      }
+
+      /// \brief measures throughput of the kernels against the previous per-channel conversion
+      /// \details results are written to the test output
+      TEST_METHOD(BenchmarkSampleConversion)
+      {
+         const size_t numSamples = 4096;
+         const size_t numChannels = 2;
+         const size_t numRepeats = 2000;
+
+         std::mt19937 random(1);
+
+         const std::pair<int, int> conversions[] = { { 16, 16 }, { 16, 32 }, { 24, 16 }, { 32, 16 } };
+
+         for (const auto& conversion : conversions)
+         {
+            const int sourceBits = conversion.first;
+            const int targetBits = conversion.second;
+
+            SampleType sourceType = SampleConverter::SampleTypeFromBitsPerSample(sourceBits);
+            SampleType targetType = SampleConverter::SampleTypeFromBitsPerSample(targetBits);
+
+            std::vector<unsigned char> source = CreateRandomSamples(random, sourceType, numSamples * numChannels);
+            std::vector<unsigned char> target(numSamples * numChannels * SampleConverter::GetSampleSize(targetType));
+
+            double perChannelSeconds = MeasureSeconds(numRepeats, [&]()
+            {
+               ConvertPerChannel(source, sourceBits, targetBits, numSamples, numChannels, target.data());
+            });
+
+            LogThroughput(sourceBits, targetBits, _T("per-channel"), numSamples * numChannels * numRepeats, perChannelSeconds, perChannelSeconds);
+
+            for (int instructionSet = Encoder::instructionSetScalar;
+               instructionSet <= SampleConverter::GetSupportedInstructionSet();
+               instructionSet++)
+            {
+               SampleConverter::SetInstructionSet(Encoder::SampleConverterInstructionSet(instructionSet));
+
+               double seconds = MeasureSeconds(numRepeats, [&]()
+               {
+                  SampleConverter::InterleavedToInterleaved(source.data(), sourceType,
+                     target.data(), targetType, numSamples, numChannels);
+               });
+
+               LogThroughput(sourceBits, targetBits, GetInstructionSetName(instructionSet),
+                  numSamples * numChannels * numRepeats, seconds, perChannelSeconds);
+            }
+         }
+      }
+
+   private:
+      /// creates buffer with random samples of given type
+      static std::vector<unsigned char> CreateRandomSamples(std::mt19937& random, SampleType sampleType, size_t count)
+      {
+         std::vector<unsigned char> samples(count * SampleConverter::GetSampleSize(sampleType));
+
+         if (sampleType == Encoder::SampleTypeFloat32)
+         {
+            // also produce values outside of the valid range, to check clipping
+            std::uniform_real_distribution<float> distribution(-1.25f, 1.25f);
+
+            float* floatSamples = reinterpret_cast<float*>(samples.data());
+            for (size_t index = 0; index < count; index++)
+               floatSamples[index] = distribution(random);
+         }
+         else
+         {
+            for (unsigned char& value : samples)
+               value = static_cast<unsigned char>(random());
+         }
+
+         return samples;
+      }
+
+      /// converts samples using all layout combinations and checks that they produce the same result
+      static std::vector<unsigned char> ConvertAllLayouts(const std::vector<unsigned char>& source,
+         SampleType sourceType, SampleType targetType, size_t numSamples, size_t numChannels)
+      {
+         const unsigned int sourceSize = SampleConverter::GetSampleSize(sourceType);
+         const unsigned int targetSize = SampleConverter::GetSampleSize(targetType);
+
+         std::vector<unsigned char> interleaved(numSamples * numChannels * targetSize);
+         SampleConverter::InterleavedToInterleaved(source.data(), sourceType,
+            interleaved.data(), targetType, numSamples, numChannels);
+
+         // split source into channel array
+         std::vector<std::vector<unsigned char>> sourceArray(numChannels, std::vector<unsigned char>(numSamples * sourceSize));
+         std::vector<const void*> sourcePointers;
+         for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+         {
+            for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+            {
+               memcpy(&sourceArray[channelIndex][sampleIndex * sourceSize],
+                  &source[(sampleIndex * numChannels + channelIndex) * sourceSize], sourceSize);
+            }
+
+            sourcePointers.push_back(sourceArray[channelIndex].data());
+         }
+
+         std::vector<std::vector<unsigned char>> targetArray(numChannels, std::vector<unsigned char>(numSamples * targetSize));
+         std::vector<void*> targetPointers;
+         for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+            targetPointers.push_back(targetArray[channelIndex].data());
+
+         std::vector<unsigned char> arrayToInterleaved(interleaved.size());
+         SampleConverter::ArrayToInterleaved(sourcePointers.data(), sourceType,
+            arrayToInterleaved.data(), targetType, numSamples, numChannels);
+
+         Assert::IsTrue(interleaved == arrayToInterleaved, _T("array to interleaved conversion must match"));
+
+         SampleConverter::InterleavedToArray(source.data(), sourceType,
+            targetPointers.data(), targetType, numSamples, numChannels);
+         CheckArrayMatchesInterleaved(targetArray, interleaved, targetSize);
+
+         SampleConverter::ArrayToArray(sourcePointers.data(), sourceType,
+            targetPointers.data(), targetType, numSamples, numChannels);
+         CheckArrayMatchesInterleaved(targetArray, interleaved, targetSize);
+
+         return interleaved;
+      }
+
+      /// checks that channel array samples match interleaved samples
+      static void CheckArrayMatchesInterleaved(const std::vector<std::vector<unsigned char>>& channelArray,
+         const std::vector<unsigned char>& interleaved, unsigned int sampleSize)
+      {
+         const size_t numChannels = channelArray.size();
+
+         for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+         {
+            const std::vector<unsigned char>& channel = channelArray[channelIndex];
+            for (size_t sampleIndex = 0; sampleIndex < channel.size() / sampleSize; sampleIndex++)
+            {
+               Assert::IsTrue(0 == memcmp(&channel[sampleIndex * sampleSize],
+                  &interleaved[(sampleIndex * numChannels + channelIndex) * sampleSize], sampleSize),
+                  _T("channel array conversion must match"));
+            }
+         }
+      }
+
+      /// \brief converts samples channel by channel, like the previous SampleContainer code did
+      /// \details used as reference for correctness and for the benchmark
+      static std::vector<unsigned char> ConvertPerChannel(const std::vector<unsigned char>& source,
+         int sourceBits, int targetBits, size_t numSamples, size_t numChannels, unsigned char* target = nullptr)
+      {
+         std::vector<unsigned char> result;
+         if (target == nullptr)
+         {
+            result.resize(numSamples * numChannels * (targetBits >> 3));
+            target = result.data();
+         }
+
+         const int sourceStep = int(numChannels) * (sourceBits >> 3);
+         const int targetStep = int(numChannels) * (targetBits >> 3);
+
+         const int sourceShift = 32 - sourceBits;
+         const int targetShift = 32 - targetBits;
+         const int roundBit = targetShift > 0 ? (1 << (targetShift - 1)) : 0;
+         const int targetHigh = std::numeric_limits<int>::max() - roundBit + 1;
+
+         for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+         {
+            const unsigned char* sourceBuffer = source.data() + channelIndex * (sourceBits >> 3);
+            unsigned char* targetBuffer = target + channelIndex * (targetBits >> 3);
+
+            for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+            {
+               // only read the sample bytes; the previous code read 4 bytes per sample
+               unsigned int rawSample = 0;
+               memcpy(&rawSample, sourceBuffer, sourceBits >> 3);
+
+               int sample = static_cast<int>(rawSample << sourceShift);
+
+               if (sample < targetHigh)
+                  sample += roundBit;
+
+               sample >>= targetShift;
+
+               memcpy(targetBuffer, &sample, targetBits >> 3);
+
+               sourceBuffer += sourceStep;
+               targetBuffer += targetStep;
+            }
+         }
+
+         return result;
+      }
+
+      /// measures the time needed to run a function a number of times
+      template <typename TFunc>
+      static double MeasureSeconds(size_t numRepeats, TFunc func)
+      {
+         auto start = std::chrono::steady_clock::now();
+
+         for (size_t repeatIndex = 0; repeatIndex < numRepeats; repeatIndex++)
+            func();
+
+         return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+
+      /// returns display name of instruction set
+      static LPCTSTR GetInstructionSetName(int instructionSet)
+      {
+         switch (instructionSet)
+         {
+         case Encoder::instructionSetScalar: return _T("scalar");
+         case Encoder::instructionSetSSE2: return _T("SSE2");
+         case Encoder::instructionSetAVX2: return _T("AVX2");
+         default: return _T("???");
+         }
+      }
+
+      /// writes throughput of a conversion to test output
+      static void LogThroughput(int sourceBits, int targetBits, LPCTSTR kernelName,
+         size_t numSamplesTotal, double seconds, double referenceSeconds)
+      {
+         CString text;
+         text.Format(_T("%i bit -> %i bit, %-12s: %8.1f MSamples/s, speedup %5.1fx\n"),
+            sourceBits, targetBits, kernelName,
+            numSamplesTotal / seconds / 1e6,
+            referenceSeconds / seconds);
+
+         Logger::WriteMessage(text.GetString());
+      }
+   };
+}
@@ -0,0 +1,200 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestSampleFrameBuffer.cpp
+/// \brief Tests and benchmarks splitting sample blocks into frames
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "SampleFrameBuffer.hpp"
+#include <chrono>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for SampleFrameBuffer class
+   TEST_CLASS(TestSampleFrameBuffer)
+   {
+   public:
+      /// tests that frames contain all samples in order, for various block sizes
+      TEST_METHOD(TestFramesInOrder)
+      {
+         const size_t numSamplesPerFrame = 960 * 2;
+         const size_t numSamplesTotal = 100000;
+
+         for (size_t numSamplesPerBlock : { size_t(1), size_t(7), numSamplesPerFrame - 1, numSamplesPerFrame,
+            numSamplesPerFrame + 1, size_t(48000 * 2) })
+         {
+            std::vector<float> output;
+            output.reserve(numSamplesTotal);
+
+            SplitIntoFrames(numSamplesPerFrame, numSamplesPerBlock, numSamplesTotal,
+               [&](const float* frame, size_t numSamples)
+               {
+                  output.insert(output.end(), frame, frame + numSamples);
+               });
+
+            Assert::AreEqual(numSamplesTotal, output.size(), _T("all samples must have been returned"));
+
+            for (size_t index = 0; index < numSamplesTotal; index++)
+               Assert::AreEqual(float(index), output[index], _T("samples must be in order"));
+         }
+      }
+
+      /// tests that frames inside the input block are returned without copying
+      TEST_METHOD(TestFramesInsideBlockNotCopied)
+      {
+         std::vector<float> block(10);
+
+         Encoder::SampleFrameBuffer<float> frameBuffer;
+         frameBuffer.Init(4);
+
+         frameBuffer.SetInput(block.data(), block.size());
+
+         Assert::IsTrue(block.data() == frameBuffer.NextFrame(), _T("first frame must point into block"));
+         Assert::IsTrue(block.data() + 4 == frameBuffer.NextFrame(), _T("second frame must point into block"));
+         Assert::IsTrue(nullptr == frameBuffer.NextFrame(), _T("block must not contain a third frame"));
+
+         size_t numSamples = 0;
+         frameBuffer.RemainingSamples(numSamples);
+         Assert::AreEqual(size_t(2), numSamples, _T("two samples must remain"));
+      }
+
+      /// \brief measures the cost per frame for different input block sizes
+      /// \details compares the frame buffer with a vector that appends input
+      /// blocks and erases each frame from the front, as the Opus output module
+      /// did before; the cost per frame of the frame buffer must not depend on
+      /// the number of samples waiting in the input block
+      TEST_METHOD(BenchmarkSampleFrameBuffer)
+      {
+         const size_t numSamplesPerFrame = 960 * 2;
+         const size_t numSamplesTotal = 48000 * 2 * 60;
+
+         double smallBlockSeconds = 0.0;
+         double largeBlockSeconds = 0.0;
+
+         // sum of first sample of each frame, so that frames are really accessed
+         float checksum = 0.0f;
+         auto onFrame = [&](const float* frame, size_t) { checksum += frame[0]; };
+
+         for (size_t numSamplesPerBlock : { size_t(1152 * 2), size_t(48000 * 2), size_t(480000 * 2) })
+         {
+            double frameBufferSeconds = MeasureSeconds([&]()
+            {
+               SplitIntoFrames(numSamplesPerFrame, numSamplesPerBlock, numSamplesTotal, onFrame);
+            });
+
+            double eraseSeconds = MeasureSeconds([&]()
+            {
+               SplitIntoFramesUsingErase(numSamplesPerFrame, numSamplesPerBlock, numSamplesTotal, onFrame);
+            });
+
+            size_t numFrames = numSamplesTotal / numSamplesPerFrame;
+
+            CString text;
+            text.Format(_T("block size %7zu: frame buffer %8.1f ns/frame, erase %8.1f ns/frame\n"),
+               numSamplesPerBlock,
+               frameBufferSeconds / numFrames * 1e9,
+               eraseSeconds / numFrames * 1e9);
+
+            Logger::WriteMessage(text.GetString());
+
+            if (smallBlockSeconds == 0.0)
+               smallBlockSeconds = frameBufferSeconds;
+            largeBlockSeconds = frameBufferSeconds;
+         }
+
+         Assert::IsTrue(checksum > 0.0f, _T("frames must have been processed"));
+
+         // generous limit, so that the test doesn't fail on busy machines
+         Assert::IsTrue(largeBlockSeconds < smallBlockSeconds * 4.0,
+            _T("cost per frame must not depend on block size"));
+      }
+
+   private:
+      /// splits blocks of consecutive sample values into frames and calls function for
+      /// each frame, and for the remaining samples
+      template <typename Func>
+      static void SplitIntoFrames(size_t numSamplesPerFrame, size_t numSamplesPerBlock, size_t numSamplesTotal,
+         Func onFrame)
+      {
+         Encoder::SampleFrameBuffer<float> frameBuffer;
+         frameBuffer.Init(numSamplesPerFrame);
+
+         std::vector<float> block(numSamplesPerBlock);
+
+         for (size_t sampleIndex = 0; sampleIndex < numSamplesTotal; )
+         {
+            size_t numSamples = std::min(numSamplesPerBlock, numSamplesTotal - sampleIndex);
+            for (size_t index = 0; index < numSamples; index++)
+               block[index] = float(sampleIndex + index);
+
+            sampleIndex += numSamples;
+
+            frameBuffer.SetInput(block.data(), numSamples);
+
+            for (const float* frame = frameBuffer.NextFrame(); frame != nullptr; frame = frameBuffer.NextFrame())
+               onFrame(frame, numSamplesPerFrame);
+         }
+
+         size_t numRemainingSamples = 0;
+         const float* remainingSamples = frameBuffer.RemainingSamples(numRemainingSamples);
+         if (numRemainingSamples > 0)
+            onFrame(remainingSamples, numRemainingSamples);
+      }
+
+      /// splits sample blocks into frames, by appending to a vector and erasing from the front
+      template <typename Func>
+      static void SplitIntoFramesUsingErase(size_t numSamplesPerFrame, size_t numSamplesPerBlock, size_t numSamplesTotal,
+         Func onFrame)
+      {
+         std::vector<float> block(numSamplesPerBlock);
+         std::vector<float> inputBuffer;
+         std::vector<float> frame(numSamplesPerFrame);
+
+         for (size_t sampleIndex = 0; sampleIndex < numSamplesTotal; )
+         {
+            size_t numSamples = std::min(numSamplesPerBlock, numSamplesTotal - sampleIndex);
+            for (size_t index = 0; index < numSamples; index++)
+               block[index] = float(sampleIndex + index);
+
+            sampleIndex += numSamples;
+
+            inputBuffer.insert(inputBuffer.end(), block.begin(), block.begin() + numSamples);
+
+            while (inputBuffer.size() >= numSamplesPerFrame)
+            {
+               std::copy_n(inputBuffer.begin(), numSamplesPerFrame, frame.begin());
+               inputBuffer.erase(inputBuffer.begin(), inputBuffer.begin() + numSamplesPerFrame);
+
+               onFrame(frame.data(), numSamplesPerFrame);
+            }
+         }
+      }
+
+      /// runs function and returns the seconds it took
+      template <typename Func>
+      static double MeasureSeconds(Func func)
+      {
+         auto start = std::chrono::steady_clock::now();
+         func();
+         return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+   };
+}
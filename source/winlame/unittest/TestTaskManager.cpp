@@ -0,0 +1,603 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestTaskManager.cpp
+/// \brief Tests scheduling tasks with the task manager
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "TaskManager.hpp"
+#include "Task.hpp"
+#include <algorithm>
+#include <map>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// time to wait for tasks to start or complete
+   const std::chrono::seconds c_waitTimeout{ 10 };
+
+   /// time after which a task that may not start is assumed to stay waiting
+   const std::chrono::milliseconds c_notStartedDelay{ 200 };
+
+   /// records when fake tasks start and finish, and how many of them run at the same time
+   class TaskRecorder
+   {
+   public:
+      /// called when a task has started running
+      void Started(unsigned int taskId, TaskInfo::TaskType taskType, int cdDrive)
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+
+         m_events.push_back(std::make_pair(true, taskId));
+
+         m_maxRunningByType[taskType] = std::max(m_maxRunningByType[taskType], ++m_numRunningByType[taskType]);
+
+         if (cdDrive >= 0)
+            m_maxRunningPerDrive = std::max(m_maxRunningPerDrive, ++m_numRunningByDrive[cdDrive]);
+
+         m_condition.notify_all();
+      }
+
+      /// called when a task has finished running
+      void Finished(unsigned int taskId, TaskInfo::TaskType taskType, int cdDrive)
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+
+         m_events.push_back(std::make_pair(false, taskId));
+
+         m_numRunningByType[taskType]--;
+
+         if (cdDrive >= 0)
+            m_numRunningByDrive[cdDrive]--;
+
+         m_condition.notify_all();
+      }
+
+      /// called when a task doesn't access its CD drive anymore
+      void CDDriveReleased(int cdDrive)
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         m_numRunningByDrive[cdDrive]--;
+      }
+
+      /// waits until the given number of tasks has started; returns false on timeout
+      bool WaitStarted(size_t numTasks)
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+
+         return m_condition.wait_for(lock, c_waitTimeout,
+            [&]() { return StartOrderUnlocked().size() >= numTasks; });
+      }
+
+      /// waits until the given task has finished; returns false on timeout
+      bool WaitFinished(unsigned int taskId)
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+
+         return m_condition.wait_for(lock, c_waitTimeout,
+            [&]() { return EventIndex(false, taskId) != std::string::npos; });
+      }
+
+      /// returns if the task has started
+      bool IsStarted(unsigned int taskId)
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         return EventIndex(true, taskId) != std::string::npos;
+      }
+
+      /// returns if a task started after another task had finished
+      bool IsStartedAfter(unsigned int taskId, unsigned int finishedTaskId)
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+
+         size_t finishedIndex = EventIndex(false, finishedTaskId);
+         size_t startedIndex = EventIndex(true, taskId);
+
+         return finishedIndex != std::string::npos && startedIndex != std::string::npos &&
+            startedIndex > finishedIndex;
+      }
+
+      /// returns the ids of all started tasks, in the order they were started
+      std::vector<unsigned int> StartOrder()
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         return StartOrderUnlocked();
+      }
+
+      /// returns the maximum number of tasks of the given type that ran at the same time
+      unsigned int MaxRunning(TaskInfo::TaskType taskType)
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         return m_maxRunningByType[taskType];
+      }
+
+      /// returns the maximum number of tasks that accessed the same CD drive at the same time
+      unsigned int MaxRunningPerDrive()
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         return m_maxRunningPerDrive;
+      }
+
+   private:
+      /// returns the index of the start or finish event of a task, or npos when there is none
+      size_t EventIndex(bool started, unsigned int taskId) const
+      {
+         auto iter = std::find(m_events.begin(), m_events.end(), std::make_pair(started, taskId));
+         return iter == m_events.end() ? std::string::npos : size_t(iter - m_events.begin());
+      }
+
+      /// returns the ids of all started tasks; must be called with the mutex locked
+      std::vector<unsigned int> StartOrderUnlocked() const
+      {
+         std::vector<unsigned int> startOrder;
+         for (const auto& taskEvent : m_events)
+         {
+            if (taskEvent.first)
+               startOrder.push_back(taskEvent.second);
+         }
+
+         return startOrder;
+      }
+
+      /// mutex protecting all members
+      std::mutex m_mutex;
+
+      /// condition signaled when a task started or finished
+      std::condition_variable m_condition;
+
+      /// start (true) and finish (false) events, with task id
+      std::vector<std::pair<bool, unsigned int>> m_events;
+
+      /// number of running tasks, by task type
+      std::map<TaskInfo::TaskType, unsigned int> m_numRunningByType;
+
+      /// maximum number of tasks running at the same time, by task type
+      std::map<TaskInfo::TaskType, unsigned int> m_maxRunningByType;
+
+      /// number of running tasks, by CD drive
+      std::map<int, unsigned int> m_numRunningByDrive;
+
+      /// maximum number of tasks running at the same time on any CD drive
+      unsigned int m_maxRunningPerDrive = 0;
+   };
+
+   /// fake task that records running, and optionally waits in Run() until released or stopped
+   class FakeTask : public Task
+   {
+   public:
+      /// ctor
+      FakeTask(TaskRecorder& recorder, TaskInfo::TaskType taskType, bool isBlocking, int cdDrive = -1)
+         :m_recorder(recorder),
+         m_taskType(taskType),
+         m_isBlocking(isBlocking),
+         m_cdDrive(cdDrive)
+      {
+      }
+
+      /// lets the task end with an error
+      void SetFailing() { m_isFailing = true; }
+
+      /// lets the task release its CD drive as soon as it runs
+      void SetReleasingCDDrive() { m_isReleasingCDDrive = true; }
+
+      /// lets a blocking task finish running
+      void Release()
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         m_isReleased = true;
+         m_condition.notify_all();
+      }
+
+      /// returns if Stop() was called
+      bool IsStopped() const { return m_isStopped; }
+
+      virtual TaskInfo GetTaskInfo() override
+      {
+         TaskInfo info(Id(), m_taskType);
+         info.Status(m_status);
+         return info;
+      }
+
+      virtual void Run() override
+      {
+         m_status = TaskInfo::statusRunning;
+         m_recorder.Started(Id(), m_taskType, m_cdDrive);
+
+         if (m_isReleasingCDDrive)
+         {
+            m_recorder.CDDriveReleased(m_cdDrive);
+            ReleaseCDDrive();
+         }
+
+         {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [&]() { return !m_isBlocking || m_isReleased || m_isStopped; });
+         }
+
+         m_recorder.Finished(Id(), m_taskType, m_isReleasingCDDrive ? -1 : m_cdDrive);
+
+         if (m_isFailing)
+            SetTaskError(_T("task failed"));
+
+         m_status = TaskInfo::statusCompleted;
+      }
+
+      virtual void Stop() override
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         m_isStopped = true;
+         m_condition.notify_all();
+      }
+
+      virtual int CDDrive() const override { return m_cdDrive; }
+
+   private:
+      /// recorder to report to
+      TaskRecorder& m_recorder;
+
+      /// task type
+      TaskInfo::TaskType m_taskType;
+
+      /// indicates if the task waits in Run() until released or stopped
+      bool m_isBlocking;
+
+      /// CD drive the task accesses, or -1
+      int m_cdDrive;
+
+      /// indicates if the task ends with an error
+      bool m_isFailing = false;
+
+      /// indicates if the task releases its CD drive as soon as it runs
+      bool m_isReleasingCDDrive = false;
+
+      /// current task status
+      std::atomic<TaskInfo::TaskStatus> m_status = TaskInfo::statusWaiting;
+
+      /// mutex protecting the flags
+      std::mutex m_mutex;
+
+      /// condition signaled when released or stopped
+      std::condition_variable m_condition;
+
+      /// indicates if the task was released
+      bool m_isReleased = false;
+
+      /// indicates if the task was stopped
+      std::atomic<bool> m_isStopped = false;
+   };
+
+   /// tests for TaskManager class
+   TEST_CLASS(TestTaskManager)
+   {
+   public:
+      /// tests a task depending on two tasks that both depend on the same task
+      TEST_METHOD(TestDiamondDependency)
+      {
+         TaskRecorder recorder;
+         TaskManager taskManager(TaskManagerConfig{});
+
+         auto taskA = std::make_shared<FakeTask>(recorder, TaskInfo::taskUnknown, true);
+         taskManager.AddTask(taskA);
+
+         auto taskB = std::make_shared<FakeTask>(recorder, TaskInfo::taskUnknown, true);
+         taskB->AddDependentTaskId(taskA->Id());
+         taskManager.AddTask(taskB);
+
+         auto taskC = std::make_shared<FakeTask>(recorder, TaskInfo::taskUnknown, true);
+         taskC->AddDependentTaskId(taskA->Id());
+         taskManager.AddTask(taskC);
+
+         auto taskD = std::make_shared<FakeTask>(recorder, TaskInfo::taskUnknown, false);
+         taskD->AddDependentTaskId(taskB->Id());
+         taskD->AddDependentTaskId(taskC->Id());
+         taskManager.AddTask(taskD);
+
+         Assert::IsTrue(recorder.WaitStarted(1), _T("first task must start"));
+         std::this_thread::sleep_for(c_notStartedDelay);
+         Assert::IsFalse(recorder.IsStarted(taskB->Id()), _T("dependent task must wait"));
+
+         taskA->Release();
+         Assert::IsTrue(recorder.WaitStarted(3), _T("both dependent tasks must start"));
+
+         taskB->Release();
+         Assert::IsTrue(recorder.WaitFinished(taskB->Id()), _T("task must finish"));
+         std::this_thread::sleep_for(c_notStartedDelay);
+         Assert::IsFalse(recorder.IsStarted(taskD->Id()), _T("last task must wait for both tasks"));
+
+         taskC->Release();
+         Assert::IsTrue(taskManager.WaitAllCompleted(c_waitTimeout), _T("all tasks must complete"));
+
+         Assert::IsTrue(recorder.IsStartedAfter(taskB->Id(), taskA->Id()) &&
+            recorder.IsStartedAfter(taskC->Id(), taskA->Id()),
+            _T("dependent tasks must start after first task finished"));
+         Assert::IsTrue(recorder.IsStartedAfter(taskD->Id(), taskB->Id()) &&
+            recorder.IsStartedAfter(taskD->Id(), taskC->Id()),
+            _T("last task must start after both tasks finished"));
+      }
+
+      /// tests that tasks depending on a task that failed are still run
+      TEST_METHOD(TestFailedDependency)
+      {
+         TaskRecorder recorder;
+         TaskManager taskManager(TaskManagerConfig{});
+
+         auto failingTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskEncoding, false);
+         failingTask->SetFailing();
+         taskManager.AddTask(failingTask);
+
+         auto dependentTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskWritePlaylist, false);
+         dependentTask->AddDependentTaskId(failingTask->Id());
+         taskManager.AddTask(dependentTask);
+
+         Assert::IsTrue(taskManager.WaitAllCompleted(c_waitTimeout), _T("all tasks must complete"));
+         Assert::IsTrue(recorder.IsStarted(dependentTask->Id()), _T("dependent task must run after failed task"));
+
+         std::vector<TaskInfo> taskInfos = taskManager.CurrentTasks();
+         Assert::AreEqual(size_t(2), taskInfos.size(), _T("there must be two tasks"));
+         Assert::IsTrue(TaskInfo::statusError == taskInfos[0].Status(), _T("failed task must have error status"));
+         Assert::IsTrue(TaskInfo::statusCompleted == taskInfos[1].Status(), _T("dependent task must be completed"));
+      }
+
+      /// tests that tasks depending on a task that was stopped are never run
+      TEST_METHOD(TestStoppedDependency)
+      {
+         TaskRecorder recorder;
+         TaskManager taskManager(TaskManagerConfig{});
+
+         auto runningTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskEncoding, true);
+         taskManager.AddTask(runningTask);
+
+         auto dependentTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskWritePlaylist, false);
+         dependentTask->AddDependentTaskId(runningTask->Id());
+         taskManager.AddTask(dependentTask);
+
+         Assert::IsTrue(recorder.WaitStarted(1), _T("first task must start"));
+
+         taskManager.StopAll();
+
+         Assert::IsTrue(runningTask->IsStopped(), _T("running task must be stopped"));
+         Assert::IsTrue(dependentTask->IsStopped(), _T("waiting task must be stopped"));
+         Assert::IsTrue(taskManager.WaitAllCompleted(c_waitTimeout), _T("all tasks must be completed"));
+
+         Assert::IsTrue(recorder.WaitFinished(runningTask->Id()), _T("running task must return"));
+         std::this_thread::sleep_for(c_notStartedDelay);
+         Assert::IsFalse(recorder.IsStarted(dependentTask->Id()), _T("dependent task must never run"));
+      }
+
+      /// tests that StopAll() only publishes task infos of tasks that weren't completed yet
+      TEST_METHOD(TestStopAllPublishesOnce)
+      {
+         TaskRecorder recorder;
+         TaskManager taskManager(TaskManagerConfig{});
+
+         unsigned int consumerId = taskManager.RegisterTaskChangesConsumer();
+
+         auto completedTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskEncoding, false);
+         taskManager.AddTask(completedTask);
+
+         Assert::IsTrue(taskManager.WaitAllCompleted(c_waitTimeout), _T("first task must complete"));
+
+         auto runningTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskEncoding, true);
+         taskManager.AddTask(runningTask);
+
+         Assert::IsTrue(recorder.WaitStarted(2), _T("second task must start"));
+
+         std::vector<TaskInfo> changedTaskInfos;
+         std::vector<unsigned int> removedTaskIds;
+         unsigned long long version = taskManager.GetTaskChanges(consumerId, 0, changedTaskInfos, removedTaskIds);
+
+         taskManager.StopAll();
+
+         version = taskManager.GetTaskChanges(consumerId, version, changedTaskInfos, removedTaskIds);
+
+         Assert::AreEqual(size_t(1), changedTaskInfos.size(), _T("only the stopped task must be published"));
+         Assert::AreEqual(runningTask->Id(), changedTaskInfos[0].Id(), _T("stopped task must be published"));
+         Assert::IsFalse(completedTask->IsStopped(), _T("completed task must not be stopped"));
+
+         // the stopped task returning from Run() must not be published again
+         Assert::IsTrue(recorder.WaitFinished(runningTask->Id()), _T("running task must return"));
+         std::this_thread::sleep_for(c_notStartedDelay);
+
+         unsigned long long lastVersion = taskManager.GetTaskChanges(consumerId, version, changedTaskInfos, removedTaskIds);
+
+         Assert::AreEqual(version, lastVersion, _T("no task info must be published after stopping"));
+         Assert::IsTrue(changedTaskInfos.empty(), _T("no task info must be changed after stopping"));
+
+         // a second StopAll(), e.g. from the dtor, must not publish anything
+         taskManager.StopAll();
+
+         lastVersion = taskManager.GetTaskChanges(consumerId, version, changedTaskInfos, removedTaskIds);
+         Assert::AreEqual(version, lastVersion, _T("stopping again must not publish task infos"));
+
+         taskManager.UnregisterTaskChangesConsumer(consumerId);
+      }
+
+      /// tests that waiting tasks are started in the order of their task type's priority
+      TEST_METHOD(TestDispatchPriorityOrder)
+      {
+         TaskRecorder recorder;
+
+         // one encoding thread, plus the additional threads
+         TaskManagerConfig config;
+         config.m_bAutoTasksPerCpu = false;
+         config.m_uiUseNumTasks = 1;
+         TaskManager taskManager(config);
+
+         // occupy all threads, so that all following tasks have to wait
+         std::vector<std::shared_ptr<FakeTask>> runningTasks;
+         for (unsigned int taskIndex = 0; taskIndex < 3; taskIndex++)
+         {
+            runningTasks.push_back(std::make_shared<FakeTask>(recorder, TaskInfo::taskUnknown, true));
+            taskManager.AddTask(runningTasks.back());
+         }
+
+         Assert::IsTrue(recorder.WaitStarted(3), _T("all threads must be busy"));
+
+         // add waiting tasks in reverse order of priority
+         std::vector<std::shared_ptr<FakeTask>> waitingTasks
+         {
+            std::make_shared<FakeTask>(recorder, TaskInfo::taskEncoding, true),
+            std::make_shared<FakeTask>(recorder, TaskInfo::taskUnknown, true),
+            std::make_shared<FakeTask>(recorder, TaskInfo::taskWriteAlbumGain, true),
+            std::make_shared<FakeTask>(recorder, TaskInfo::taskWritePlaylist, true),
+            std::make_shared<FakeTask>(recorder, TaskInfo::taskEjectCD, true),
+            std::make_shared<FakeTask>(recorder, TaskInfo::taskCdExtraction, true, 0),
+         };
+
+         for (std::shared_ptr<FakeTask> spTask : waitingTasks)
+            taskManager.AddTask(spTask);
+
+         std::this_thread::sleep_for(c_notStartedDelay);
+         Assert::AreEqual(size_t(3), recorder.StartOrder().size(), _T("tasks must wait for a free thread"));
+
+         // free one thread at a time; each task started keeps its thread busy
+         runningTasks.insert(runningTasks.end(), waitingTasks.rbegin(), waitingTasks.rend());
+
+         for (size_t taskIndex = 0; taskIndex < waitingTasks.size(); taskIndex++)
+         {
+            runningTasks[taskIndex]->Release();
+
+            Assert::IsTrue(recorder.WaitStarted(3 + taskIndex + 1), _T("next task must start"));
+         }
+
+         std::vector<unsigned int> startOrder = recorder.StartOrder();
+
+         for (size_t taskIndex = 0; taskIndex < waitingTasks.size(); taskIndex++)
+         {
+            Assert::AreEqual(waitingTasks[waitingTasks.size() - 1 - taskIndex]->Id(), startOrder[3 + taskIndex],
+               _T("tasks must be started in the order of priority"));
+         }
+
+         for (std::shared_ptr<FakeTask> spTask : runningTasks)
+            spTask->Release();
+
+         Assert::IsTrue(taskManager.WaitAllCompleted(c_waitTimeout), _T("all tasks must complete"));
+      }
+
+      /// tests that no more encoding tasks than CPU cores run at the same time, and that
+      /// other tasks still run when all encoding tasks are busy
+      TEST_METHOD(TestEncodingTasksLimitedToCores)
+      {
+         unsigned int numCores = std::thread::hardware_concurrency();
+         if (numCores == 0)
+            return; // number of cores is unknown
+
+         TaskRecorder recorder;
+         TaskManager taskManager(TaskManagerConfig{});
+
+         std::vector<std::shared_ptr<FakeTask>> encodingTasks;
+         for (unsigned int taskIndex = 0; taskIndex < numCores + 2; taskIndex++)
+         {
+            encodingTasks.push_back(std::make_shared<FakeTask>(recorder, TaskInfo::taskEncoding, true));
+            taskManager.AddTask(encodingTasks.back());
+         }
+
+         Assert::IsTrue(recorder.WaitStarted(numCores), _T("one encoding task per core must start"));
+
+         auto playlistTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskWritePlaylist, false);
+         taskManager.AddTask(playlistTask);
+
+         Assert::IsTrue(recorder.WaitFinished(playlistTask->Id()), _T("other tasks must run while encoding"));
+         Assert::AreEqual(numCores, recorder.MaxRunning(TaskInfo::taskEncoding), _T("encoding tasks must be limited"));
+
+         encodingTasks.front()->Release();
+
+         Assert::IsTrue(recorder.WaitStarted(numCores + 2), _T("next encoding task must start"));
+
+         for (std::shared_ptr<FakeTask> spTask : encodingTasks)
+            spTask->Release();
+
+         Assert::IsTrue(taskManager.WaitAllCompleted(c_waitTimeout), _T("all tasks must complete"));
+         Assert::AreEqual(numCores, recorder.MaxRunning(TaskInfo::taskEncoding), _T("encoding tasks must be limited"));
+      }
+
+      /// tests that only one task accesses a CD drive at a time, without blocking other drives
+      TEST_METHOD(TestOneTaskPerCDDrive)
+      {
+         TaskRecorder recorder;
+         TaskManager taskManager(TaskManagerConfig{});
+
+         // an encoding task reading from CD is scheduled like a CD extraction task
+         auto firstTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskCdExtraction, true, 0);
+         auto secondTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskEncoding, true, 0);
+         auto otherDriveTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskCdExtraction, true, 1);
+
+         taskManager.AddTask(firstTask);
+         taskManager.AddTask(secondTask);
+         taskManager.AddTask(otherDriveTask);
+
+         Assert::IsTrue(recorder.WaitStarted(2), _T("tasks for both drives must start"));
+         std::this_thread::sleep_for(c_notStartedDelay);
+
+         Assert::IsTrue(recorder.IsStarted(otherDriveTask->Id()), _T("other drive must not be blocked"));
+         Assert::IsFalse(recorder.IsStarted(secondTask->Id()), _T("second task for drive must wait"));
+
+         firstTask->Release();
+
+         Assert::IsTrue(recorder.WaitStarted(3), _T("second task for drive must start"));
+         Assert::IsTrue(recorder.IsStartedAfter(secondTask->Id(), firstTask->Id()),
+            _T("second task must start after first task finished"));
+
+         // many short tasks on the same drives
+         for (unsigned int taskIndex = 0; taskIndex < 20; taskIndex++)
+            taskManager.AddTask(std::make_shared<FakeTask>(recorder, TaskInfo::taskCdExtraction, false, taskIndex % 2));
+
+         secondTask->Release();
+         otherDriveTask->Release();
+
+         Assert::IsTrue(taskManager.WaitAllCompleted(c_waitTimeout), _T("all tasks must complete"));
+         Assert::AreEqual(1U, recorder.MaxRunningPerDrive(), _T("only one task may access a drive at a time"));
+      }
+
+      /// tests that the next task for a CD drive starts as soon as the running task has
+      /// released the drive, e.g. when a track was read and is still being encoded
+      TEST_METHOD(TestReleaseCDDrive)
+      {
+         TaskRecorder recorder;
+         TaskManager taskManager(TaskManagerConfig{});
+
+         auto firstTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskEncoding, true, 0);
+         firstTask->SetReleasingCDDrive();
+         auto secondTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskEncoding, true, 0);
+         auto thirdTask = std::make_shared<FakeTask>(recorder, TaskInfo::taskEncoding, false, 0);
+
+         taskManager.AddTask(firstTask);
+         taskManager.AddTask(secondTask);
+
+         Assert::IsTrue(recorder.WaitStarted(2), _T("second task must start when drive was released"));
+
+         // the first task finishing must not release the drive used by the second task
+         firstTask->Release();
+         Assert::IsTrue(recorder.WaitFinished(firstTask->Id()), _T("first task must finish"));
+
+         taskManager.AddTask(thirdTask);
+
+         std::this_thread::sleep_for(c_notStartedDelay);
+         Assert::IsFalse(recorder.IsStarted(thirdTask->Id()), _T("third task must wait for the drive"));
+
+         secondTask->Release();
+
+         Assert::IsTrue(taskManager.WaitAllCompleted(c_waitTimeout), _T("all tasks must complete"));
+         Assert::IsTrue(recorder.IsStartedAfter(thirdTask->Id(), secondTask->Id()),
+            _T("third task must start after second task finished"));
+         Assert::AreEqual(1U, recorder.MaxRunningPerDrive(), _T("only one task may access a drive at a time"));
+      }
+   };
+}
@@ -0,0 +1,187 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2026 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestTranscodeCache.cpp
+/// \brief Tests content hashing and the transcode cache
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "TranscodeCache.hpp"
+#include "SettingsManager.hpp"
+#include "ModuleInterface.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+#include <fstream>
+#include <iterator>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for ContentHasher and TranscodeCache classes
+   TEST_CLASS(TestTranscodeCache)
+   {
+   public:
+      /// tests content hash with the XXH64 reference values
+      TEST_METHOD(TestContentHasher)
+      {
+         Assert::AreEqual(0xef46db3751d8e999ULL, Hash("", 0), _T("hash of empty data must match"));
+         Assert::AreEqual(0x44bc2cf5ad770999ULL, Hash("abc", 3), _T("hash of short data must match"));
+
+         std::vector<unsigned char> data;
+         for (unsigned int index = 0; index < 1024; index++)
+            data.push_back(static_cast<unsigned char>(index));
+
+         Assert::AreEqual(0x6f3914f18fe4df57ULL, Hash(data.data(), data.size()), _T("hash of long data must match"));
+
+         // hashing in parts must give the same hash
+         for (size_t partLength : { 1, 7, 31, 32, 33, 100 })
+         {
+            Encoder::ContentHasher hasher;
+            for (size_t pos = 0; pos < data.size(); pos += partLength)
+               hasher.Update(data.data() + pos, std::min(partLength, data.size() - pos));
+
+            Assert::AreEqual(0x6f3914f18fe4df57ULL, hasher.Finish(), _T("hash in parts must match"));
+         }
+      }
+
+      /// tests hashing output module and settings
+      TEST_METHOD(TestHashSettings)
+      {
+         SettingsManager settingsManager;
+         unsigned long long defaultHash = Encoder::TranscodeCache::HashSettings(ID_OM_LAME, settingsManager);
+
+         // setting the default value explicitly doesn't change the hash
+         VarMgrVariables variables;
+         settingsManager.setValue(LameSimpleBitrate, variables.lookupDefaultValue(LameSimpleBitrate));
+
+         Assert::AreEqual(defaultHash, Encoder::TranscodeCache::HashSettings(ID_OM_LAME, settingsManager),
+            _T("explicit default value must not change hash"));
+
+         // settings of the current encoding run are ignored
+         settingsManager.setValue(LameNoGapInstanceId, 42);
+         settingsManager.setValue(GeneralIsLastFile, 1);
+
+         Assert::AreEqual(defaultHash, Encoder::TranscodeCache::HashSettings(ID_OM_LAME, settingsManager),
+            _T("nogap instance and last file flag must not change hash"));
+
+         Assert::AreNotEqual(defaultHash, Encoder::TranscodeCache::HashSettings(ID_OM_OGGV, settingsManager),
+            _T("other output module must change hash"));
+
+         settingsManager.setValue(LameSimpleBitrate, variables.lookupDefaultValue(LameSimpleBitrate) + 32);
+
+         Assert::AreNotEqual(defaultHash, Encoder::TranscodeCache::HashSettings(ID_OM_LAME, settingsManager),
+            _T("other setting value must change hash"));
+      }
+
+      /// tests adding and finding output files, and reloading the index
+      TEST_METHOD(TestAddFindOutput)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString indexFilename = Path::Combine(folder.FolderName(), _T("cache.txt"));
+         CString inputFilename = Path::Combine(folder.FolderName(), _T("input.wav"));
+         CString outputFilename = Path::Combine(folder.FolderName(), _T("output.mp3"));
+
+         WriteFile(inputFilename, "input data");
+         WriteFile(outputFilename, "output data");
+
+         unsigned long long contentHash = 0;
+         {
+            Encoder::TranscodeCache cache(indexFilename);
+            Assert::IsTrue(cache.Load(), _T("loading missing index must succeed"));
+
+            Assert::IsTrue(cache.GetContentHash(inputFilename, contentHash), _T("content hash must be available"));
+            Assert::AreEqual(Hash("input data", 10), contentHash, _T("content hash must match"));
+
+            CString cachedOutputFilename;
+            Assert::IsFalse(cache.FindOutput(contentHash, 1, cachedOutputFilename), _T("output must not be found before adding"));
+
+            cache.AddOutput(inputFilename, contentHash, 1, outputFilename);
+
+            Assert::IsTrue(cache.FindOutput(contentHash, 1, cachedOutputFilename), _T("output must be found"));
+            Assert::IsTrue(cachedOutputFilename == outputFilename, _T("output filename must match"));
+            Assert::IsFalse(cache.FindOutput(contentHash, 2, cachedOutputFilename), _T("output with other settings must not be found"));
+         }
+
+         // a new cache instance loads the index
+         Encoder::TranscodeCache cache(indexFilename);
+         Assert::IsTrue(cache.Load(), _T("loading index must succeed"));
+         Assert::AreEqual(size_t(1), cache.GetNumOutputFiles(), _T("index must contain output file"));
+
+         unsigned long long loadedContentHash = 0;
+         Assert::IsTrue(cache.GetContentHash(inputFilename, loadedContentHash), _T("content hash must be available"));
+         Assert::AreEqual(contentHash, loadedContentHash, _T("loaded content hash must match"));
+
+         CString cachedOutputFilename;
+         Assert::IsTrue(cache.FindOutput(contentHash, 1, cachedOutputFilename), _T("loaded output must be found"));
+
+         // a modified output file isn't used anymore
+         WriteFile(outputFilename, "modified output data");
+         Assert::IsFalse(cache.FindOutput(contentHash, 1, cachedOutputFilename), _T("modified output must not be found"));
+      }
+
+      /// tests reusing an output file under another filename
+      TEST_METHOD(TestReuseOutputFile)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString cachedFilename = Path::Combine(folder.FolderName(), _T("cached.mp3"));
+         CString outputFilename = Path::Combine(folder.FolderName(), _T("output.mp3"));
+
+         WriteFile(cachedFilename, "output data");
+         WriteFile(outputFilename, "old output data");
+
+         Assert::IsTrue(Encoder::TranscodeCache::ReuseOutputFile(cachedFilename, cachedFilename),
+            _T("reusing file with same name must succeed"));
+
+         Assert::IsTrue(Encoder::TranscodeCache::ReuseOutputFile(cachedFilename, outputFilename),
+            _T("reusing file must succeed"));
+
+         Assert::IsTrue(ReadFile(outputFilename) == "output data", _T("existing output file must be replaced"));
+         Assert::IsTrue(ReadFile(cachedFilename) == "output data", _T("cached file must be unchanged"));
+
+         // tagging the output file must not modify the cached file
+         WriteFile(outputFilename, "tagged output data");
+         Assert::IsTrue(ReadFile(cachedFilename) == "output data", _T("cached file must not be aliased by output file"));
+      }
+
+   private:
+      /// returns content hash of data
+      static unsigned long long Hash(const void* data, size_t length)
+      {
+         Encoder::ContentHasher hasher;
+         hasher.Update(data, length);
+         return hasher.Finish();
+      }
+
+      /// writes a file with given content
+      static void WriteFile(const CString& filename, const std::string& content)
+      {
+         std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+         file << content;
+      }
+
+      /// reads the whole content of a file
+      static std::string ReadFile(const CString& filename)
+      {
+         std::ifstream file(filename, std::ios::binary);
+         return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+      }
+   };
+}